@@ -39,7 +39,9 @@
  *
  *    The builtin_builder::create_builtins() function contains lists of all
  *    built-in function signatures, where they're available, what types they
- *    take, and so on.
+ *    take, and so on.  Initialization only records the names of the
+ *    built-ins; the signatures of a function are generated the first time
+ *    it is looked up.
  *
  * 4. Implementations of built-in function signatures
  *
@@ -57,6 +59,8 @@
 #include <stdio.h>
 #include "main/core.h" /* for struct gl_shader */
 #include "main/shaderobj.h"
+#include "util/hash_table.h"
+#include "util/u_atomic.h"
 #include "ir_builder.h"
 #include "glsl_parser_extras.h"
 #include "program/prog_instruction.h"
@@ -538,14 +542,25 @@ vote(const _mesa_glsl_parse_state *state)
 
 /******************************************************************************/
 
+/**
+ * Serializes initializing, releasing and generating built-in functions.
+ */
+static mtx_t builtins_lock = _MTX_INITIALIZER_NP;
+
 namespace {
 
 /**
  * builtin_builder: A singleton object representing the core of the built-in
  * function module.
  *
- * It generates IR for every built-in function signature, and organizes them
- * into functions.
+ * It generates IR for the built-in function signatures, and organizes them
+ * into functions.  Only the intrinsics are generated up front; the
+ * signatures of the other built-in functions are generated by name, the
+ * first time a shader looks the function up.
+ *
+ * Generated functions are never modified, so they are shared by all the
+ * threads compiling shaders, and looking up a function that has already
+ * been generated doesn't take builtins_lock.
  */
 class builtin_builder {
 public:
@@ -556,19 +571,48 @@ public:
    void release();
    ir_function_signature *find(_mesa_glsl_parse_state *state,
                                const char *name, exec_list *actual_parameters);
+   ir_function *get_function(const char *name);
 
    /**
     * A shader to hold all the built-in signatures; created by this module.
     *
-    * This includes signatures for every built-in, regardless of version or
-    * enabled extensions.  The availability predicate associated with each
-    * signature allows matching_signature() to filter out the irrelevant ones.
+    * This includes signatures for every built-in that has been looked up,
+    * regardless of version or enabled extensions.  The availability
+    * predicate associated with each signature allows matching_signature()
+    * to filter out the irrelevant ones.
     */
    gl_shader *shader;
 
 private:
    void *mem_ctx;
 
+   typedef ir_function *function_slot;
+
+   /**
+    * Names of all the built-in functions and intrinsics, mapped to a
+    * function_slot that holds their ir_function once it has been generated
+    * and NULL until then.
+    *
+    * Only initialize() adds names, so the table can be searched without a
+    * lock afterwards.
+    */
+   struct hash_table *functions;
+
+   /**
+    * Whether create_builtins() should only register the names of the
+    * built-in functions.
+    */
+   bool registering;
+
+   /**
+    * The built-in function create_builtins() should generate, or NULL
+    * for all functions.
+    */
+   const char *generating;
+
+   bool wants_function(const char *name);
+   void publish(ir_function *f);
+
    /** Global variables used by built-in functions. */
    ir_variable *gl_ModelViewProjectionMatrix;
    ir_variable *gl_Vertex;
@@ -890,6 +934,9 @@ enum image_function_flags {
  */
 builtin_builder::builtin_builder()
    : shader(NULL),
+     functions(NULL),
+     registering(false),
+     generating(NULL),
      gl_ModelViewProjectionMatrix(NULL),
      gl_Vertex(NULL)
 {
@@ -914,7 +961,7 @@ builtin_builder::find(_mesa_glsl_parse_state *state,
     */
    state->uses_builtin_functions = true;
 
-   ir_function *f = shader->symbols->get_function(name);
+   ir_function *f = get_function(name);
    if (f == NULL)
       return NULL;
 
@@ -926,6 +973,81 @@ builtin_builder::find(_mesa_glsl_parse_state *state,
    return sig;
 }
 
+/**
+ * Returns the built-in function or intrinsic called \p name, generating
+ * its signatures if nothing has looked it up yet.
+ */
+ir_function *
+builtin_builder::get_function(const char *name)
+{
+   struct hash_entry *entry = _mesa_hash_table_search(functions, name);
+   if (entry == NULL)
+      return NULL;
+
+   function_slot *const slot = (function_slot *) entry->data;
+   ir_function *f = p_atomic_read(slot);
+
+   if (f == NULL) {
+      mtx_lock(&builtins_lock);
+
+      /* Another thread may have generated it while we waited. */
+      f = *slot;
+      if (f == NULL) {
+         generating = name;
+         create_builtins();
+         generating = NULL;
+
+         f = *slot;
+         assert(f != NULL);
+      }
+
+      mtx_unlock(&builtins_lock);
+   }
+
+   return f;
+}
+
+/**
+ * Called by create_builtins() for each built-in function, returns whether
+ * its signatures should be generated.
+ */
+bool
+builtin_builder::wants_function(const char *name)
+{
+   if (registering) {
+      if (_mesa_hash_table_search(functions, name) == NULL) {
+         _mesa_hash_table_insert(functions, name,
+                                 rzalloc(mem_ctx, function_slot));
+      }
+      return false;
+   }
+
+   return generating == NULL || strcmp(name, generating) == 0;
+}
+
+/**
+ * Adds a built-in function or intrinsic to the shader and makes it visible
+ * to get_function().
+ */
+void
+builtin_builder::publish(ir_function *f)
+{
+   shader->symbols->add_function(f);
+
+   struct hash_entry *entry = _mesa_hash_table_search(functions, f->name);
+   if (entry == NULL) {
+      /* Intrinsics are generated by initialize(), before any lookup. */
+      entry = _mesa_hash_table_insert(functions, f->name,
+                                      rzalloc(mem_ctx, function_slot));
+   }
+
+   /* The exchange is a barrier, so the function is complete by the time
+    * get_function() sees it without taking the lock.
+    */
+   function_slot *const slot = (function_slot *) entry->data;
+   (void) p_atomic_cmpxchg(slot, *slot, f);
+}
+
 void
 builtin_builder::initialize()
 {
@@ -934,9 +1056,14 @@ builtin_builder::initialize()
       return;
 
    mem_ctx = ralloc_context(NULL);
+   functions = _mesa_hash_table_create(mem_ctx, _mesa_key_hash_string,
+                                       _mesa_key_string_equal);
    create_shader();
    create_intrinsics();
+
+   registering = true;
    create_builtins();
+   registering = false;
 }
 
 void
@@ -944,6 +1071,7 @@ builtin_builder::release()
 {
    ralloc_free(mem_ctx);
    mem_ctx = NULL;
+   functions = NULL;
 
    ralloc_free(shader);
    shader = NULL;
@@ -1079,183 +1207,196 @@ builtin_builder::create_intrinsics()
 /**
  * Create ir_function and ir_function_signature objects for each built-in.
  *
- * Contains a list of every available built-in.
+ * Contains a list of every available built-in.  Each one checks
+ * wants_function() before evaluating its signatures, so that this can
+ * register every name without generating any IR and later generate the IR
+ * of a single function.
  */
 void
 builtin_builder::create_builtins()
 {
 #define F(NAME)                                 \
-   add_function(#NAME,                          \
-                _##NAME(glsl_type::float_type), \
-                _##NAME(glsl_type::vec2_type),  \
-                _##NAME(glsl_type::vec3_type),  \
-                _##NAME(glsl_type::vec4_type),  \
-                NULL);
+   if (wants_function(#NAME))                   \
+      add_function(#NAME,                       \
+                   _##NAME(glsl_type::float_type), \
+                   _##NAME(glsl_type::vec2_type),  \
+                   _##NAME(glsl_type::vec3_type),  \
+                   _##NAME(glsl_type::vec4_type),  \
+                   NULL);
 
 #define FD(NAME)                                 \
-   add_function(#NAME,                          \
-                _##NAME(always_available, glsl_type::float_type), \
-                _##NAME(always_available, glsl_type::vec2_type),  \
-                _##NAME(always_available, glsl_type::vec3_type),  \
-                _##NAME(always_available, glsl_type::vec4_type),  \
-                _##NAME(fp64, glsl_type::double_type),  \
-                _##NAME(fp64, glsl_type::dvec2_type),    \
-                _##NAME(fp64, glsl_type::dvec3_type),     \
-                _##NAME(fp64, glsl_type::dvec4_type),      \
-                NULL);
+   if (wants_function(#NAME))                   \
+      add_function(#NAME,                       \
+                   _##NAME(always_available, glsl_type::float_type), \
+                   _##NAME(always_available, glsl_type::vec2_type),  \
+                   _##NAME(always_available, glsl_type::vec3_type),  \
+                   _##NAME(always_available, glsl_type::vec4_type),  \
+                   _##NAME(fp64, glsl_type::double_type),  \
+                   _##NAME(fp64, glsl_type::dvec2_type), \
+                   _##NAME(fp64, glsl_type::dvec3_type),  \
+                   _##NAME(fp64, glsl_type::dvec4_type),   \
+                   NULL);
 
 #define FD130(NAME)                                 \
-   add_function(#NAME,                          \
-                _##NAME(v130, glsl_type::float_type), \
-                _##NAME(v130, glsl_type::vec2_type),  \
-                _##NAME(v130, glsl_type::vec3_type),                  \
-                _##NAME(v130, glsl_type::vec4_type),  \
-                _##NAME(fp64, glsl_type::double_type),  \
-                _##NAME(fp64, glsl_type::dvec2_type),    \
-                _##NAME(fp64, glsl_type::dvec3_type),     \
-                _##NAME(fp64, glsl_type::dvec4_type),      \
-                NULL);
+   if (wants_function(#NAME))                   \
+      add_function(#NAME,                       \
+                   _##NAME(v130, glsl_type::float_type), \
+                   _##NAME(v130, glsl_type::vec2_type),  \
+                   _##NAME(v130, glsl_type::vec3_type),               \
+                   _##NAME(v130, glsl_type::vec4_type),  \
+                   _##NAME(fp64, glsl_type::double_type),  \
+                   _##NAME(fp64, glsl_type::dvec2_type), \
+                   _##NAME(fp64, glsl_type::dvec3_type),  \
+                   _##NAME(fp64, glsl_type::dvec4_type),   \
+                   NULL);
 
 #define FDGS5(NAME)                                 \
-   add_function(#NAME,                          \
-                _##NAME(gpu_shader5_es, glsl_type::float_type), \
-                _##NAME(gpu_shader5_es, glsl_type::vec2_type),  \
-                _##NAME(gpu_shader5_es, glsl_type::vec3_type),                  \
-                _##NAME(gpu_shader5_es, glsl_type::vec4_type),  \
-                _##NAME(fp64, glsl_type::double_type),  \
-                _##NAME(fp64, glsl_type::dvec2_type),    \
-                _##NAME(fp64, glsl_type::dvec3_type),     \
-                _##NAME(fp64, glsl_type::dvec4_type),      \
-                NULL);
+   if (wants_function(#NAME))                   \
+      add_function(#NAME,                       \
+                   _##NAME(gpu_shader5_es, glsl_type::float_type), \
+                   _##NAME(gpu_shader5_es, glsl_type::vec2_type),  \
+                   _##NAME(gpu_shader5_es, glsl_type::vec3_type),               \
+                   _##NAME(gpu_shader5_es, glsl_type::vec4_type),  \
+                   _##NAME(fp64, glsl_type::double_type),  \
+                   _##NAME(fp64, glsl_type::dvec2_type), \
+                   _##NAME(fp64, glsl_type::dvec3_type),  \
+                   _##NAME(fp64, glsl_type::dvec4_type),   \
+                   NULL);
 
 #define FI(NAME)                                \
-   add_function(#NAME,                          \
-                _##NAME(glsl_type::float_type), \
-                _##NAME(glsl_type::vec2_type),  \
-                _##NAME(glsl_type::vec3_type),  \
-                _##NAME(glsl_type::vec4_type),  \
-                _##NAME(glsl_type::int_type),   \
-                _##NAME(glsl_type::ivec2_type), \
-                _##NAME(glsl_type::ivec3_type), \
-                _##NAME(glsl_type::ivec4_type), \
-                NULL);
+   if (wants_function(#NAME))                   \
+      add_function(#NAME,                       \
+                   _##NAME(glsl_type::float_type), \
+                   _##NAME(glsl_type::vec2_type),  \
+                   _##NAME(glsl_type::vec3_type),  \
+                   _##NAME(glsl_type::vec4_type),  \
+                   _##NAME(glsl_type::int_type),   \
+                   _##NAME(glsl_type::ivec2_type), \
+                   _##NAME(glsl_type::ivec3_type), \
+                   _##NAME(glsl_type::ivec4_type), \
+                   NULL);
 
 #define FID(NAME)                                \
-   add_function(#NAME,                          \
-                _##NAME(always_available, glsl_type::float_type), \
-                _##NAME(always_available, glsl_type::vec2_type),  \
-                _##NAME(always_available, glsl_type::vec3_type),  \
-                _##NAME(always_available, glsl_type::vec4_type),  \
-                _##NAME(always_available, glsl_type::int_type),   \
-                _##NAME(always_available, glsl_type::ivec2_type), \
-                _##NAME(always_available, glsl_type::ivec3_type), \
-                _##NAME(always_available, glsl_type::ivec4_type), \
-                _##NAME(fp64, glsl_type::double_type), \
-                _##NAME(fp64, glsl_type::dvec2_type),  \
-                _##NAME(fp64, glsl_type::dvec3_type),  \
-                _##NAME(fp64, glsl_type::dvec4_type),  \
-                NULL);
+   if (wants_function(#NAME))                   \
+      add_function(#NAME,                       \
+                   _##NAME(always_available, glsl_type::float_type), \
+                   _##NAME(always_available, glsl_type::vec2_type),  \
+                   _##NAME(always_available, glsl_type::vec3_type),  \
+                   _##NAME(always_available, glsl_type::vec4_type),  \
+                   _##NAME(always_available, glsl_type::int_type),   \
+                   _##NAME(always_available, glsl_type::ivec2_type), \
+                   _##NAME(always_available, glsl_type::ivec3_type), \
+                   _##NAME(always_available, glsl_type::ivec4_type), \
+                   _##NAME(fp64, glsl_type::double_type), \
+                   _##NAME(fp64, glsl_type::dvec2_type),  \
+                   _##NAME(fp64, glsl_type::dvec3_type),  \
+                   _##NAME(fp64, glsl_type::dvec4_type),  \
+                   NULL);
 
 #define FIUD(NAME)                                                 \
-   add_function(#NAME,                                            \
-                _##NAME(always_available, glsl_type::float_type), \
-                _##NAME(always_available, glsl_type::vec2_type),  \
-                _##NAME(always_available, glsl_type::vec3_type),  \
-                _##NAME(always_available, glsl_type::vec4_type),  \
+   if (wants_function(#NAME))                                     \
+      add_function(#NAME,                                         \
+                   _##NAME(always_available, glsl_type::float_type), \
+                   _##NAME(always_available, glsl_type::vec2_type),  \
+                   _##NAME(always_available, glsl_type::vec3_type),  \
+                   _##NAME(always_available, glsl_type::vec4_type),  \
                                                                   \
-                _##NAME(always_available, glsl_type::int_type),   \
-                _##NAME(always_available, glsl_type::ivec2_type), \
-                _##NAME(always_available, glsl_type::ivec3_type), \
-                _##NAME(always_available, glsl_type::ivec4_type), \
+                   _##NAME(always_available, glsl_type::int_type),   \
+                   _##NAME(always_available, glsl_type::ivec2_type), \
+                   _##NAME(always_available, glsl_type::ivec3_type), \
+                   _##NAME(always_available, glsl_type::ivec4_type), \
                                                                   \
-                _##NAME(v130, glsl_type::uint_type),              \
-                _##NAME(v130, glsl_type::uvec2_type),             \
-                _##NAME(v130, glsl_type::uvec3_type),             \
-                _##NAME(v130, glsl_type::uvec4_type),             \
-                _##NAME(fp64, glsl_type::double_type), \
-                _##NAME(fp64, glsl_type::dvec2_type),  \
-                _##NAME(fp64, glsl_type::dvec3_type),  \
-                _##NAME(fp64, glsl_type::dvec4_type),  \
-                NULL);
+                   _##NAME(v130, glsl_type::uint_type),           \
+                   _##NAME(v130, glsl_type::uvec2_type),          \
+                   _##NAME(v130, glsl_type::uvec3_type),          \
+                   _##NAME(v130, glsl_type::uvec4_type),          \
+                   _##NAME(fp64, glsl_type::double_type), \
+                   _##NAME(fp64, glsl_type::dvec2_type),  \
+                   _##NAME(fp64, glsl_type::dvec3_type),  \
+                   _##NAME(fp64, glsl_type::dvec4_type),  \
+                   NULL);
 
 #define IU(NAME)                                \
-   add_function(#NAME,                          \
-                _##NAME(glsl_type::int_type),   \
-                _##NAME(glsl_type::ivec2_type), \
-                _##NAME(glsl_type::ivec3_type), \
-                _##NAME(glsl_type::ivec4_type), \
+   if (wants_function(#NAME))                   \
+      add_function(#NAME,                       \
+                   _##NAME(glsl_type::int_type),   \
+                   _##NAME(glsl_type::ivec2_type), \
+                   _##NAME(glsl_type::ivec3_type), \
+                   _##NAME(glsl_type::ivec4_type), \
                                                 \
-                _##NAME(glsl_type::uint_type),  \
-                _##NAME(glsl_type::uvec2_type), \
-                _##NAME(glsl_type::uvec3_type), \
-                _##NAME(glsl_type::uvec4_type), \
-                NULL);
+                   _##NAME(glsl_type::uint_type),  \
+                   _##NAME(glsl_type::uvec2_type), \
+                   _##NAME(glsl_type::uvec3_type), \
+                   _##NAME(glsl_type::uvec4_type), \
+                   NULL);
 
 #define FIUBD(NAME)                                                \
-   add_function(#NAME,                                            \
-                _##NAME(always_available, glsl_type::float_type), \
-                _##NAME(always_available, glsl_type::vec2_type),  \
-                _##NAME(always_available, glsl_type::vec3_type),  \
-                _##NAME(always_available, glsl_type::vec4_type),  \
+   if (wants_function(#NAME))                                     \
+      add_function(#NAME,                                         \
+                   _##NAME(always_available, glsl_type::float_type), \
+                   _##NAME(always_available, glsl_type::vec2_type),  \
+                   _##NAME(always_available, glsl_type::vec3_type),  \
+                   _##NAME(always_available, glsl_type::vec4_type),  \
                                                                   \
-                _##NAME(always_available, glsl_type::int_type),   \
-                _##NAME(always_available, glsl_type::ivec2_type), \
-                _##NAME(always_available, glsl_type::ivec3_type), \
-                _##NAME(always_available, glsl_type::ivec4_type), \
+                   _##NAME(always_available, glsl_type::int_type),   \
+                   _##NAME(always_available, glsl_type::ivec2_type), \
+                   _##NAME(always_available, glsl_type::ivec3_type), \
+                   _##NAME(always_available, glsl_type::ivec4_type), \
                                                                   \
-                _##NAME(v130, glsl_type::uint_type),              \
-                _##NAME(v130, glsl_type::uvec2_type),             \
-                _##NAME(v130, glsl_type::uvec3_type),             \
-                _##NAME(v130, glsl_type::uvec4_type),             \
+                   _##NAME(v130, glsl_type::uint_type),           \
+                   _##NAME(v130, glsl_type::uvec2_type),          \
+                   _##NAME(v130, glsl_type::uvec3_type),          \
+                   _##NAME(v130, glsl_type::uvec4_type),          \
                                                                   \
-                _##NAME(always_available, glsl_type::bool_type),  \
-                _##NAME(always_available, glsl_type::bvec2_type), \
-                _##NAME(always_available, glsl_type::bvec3_type), \
-                _##NAME(always_available, glsl_type::bvec4_type), \
+                   _##NAME(always_available, glsl_type::bool_type),  \
+                   _##NAME(always_available, glsl_type::bvec2_type), \
+                   _##NAME(always_available, glsl_type::bvec3_type), \
+                   _##NAME(always_available, glsl_type::bvec4_type), \
                                                                   \
-                _##NAME(fp64, glsl_type::double_type),  \
-                _##NAME(fp64, glsl_type::dvec2_type), \
-                _##NAME(fp64, glsl_type::dvec3_type), \
-                _##NAME(fp64, glsl_type::dvec4_type), \
-                NULL);
+                   _##NAME(fp64, glsl_type::double_type),  \
+                   _##NAME(fp64, glsl_type::dvec2_type), \
+                   _##NAME(fp64, glsl_type::dvec3_type), \
+                   _##NAME(fp64, glsl_type::dvec4_type), \
+                   NULL);
 
 #define FIUD2_MIXED(NAME)                                                                 \
-   add_function(#NAME,                                                                   \
-                _##NAME(always_available, glsl_type::float_type, glsl_type::float_type), \
-                _##NAME(always_available, glsl_type::vec2_type,  glsl_type::float_type), \
-                _##NAME(always_available, glsl_type::vec3_type,  glsl_type::float_type), \
-                _##NAME(always_available, glsl_type::vec4_type,  glsl_type::float_type), \
+   if (wants_function(#NAME))                                                            \
+      add_function(#NAME,                                                                \
+                   _##NAME(always_available, glsl_type::float_type, glsl_type::float_type), \
+                   _##NAME(always_available, glsl_type::vec2_type,  glsl_type::float_type), \
+                   _##NAME(always_available, glsl_type::vec3_type,  glsl_type::float_type), \
+                   _##NAME(always_available, glsl_type::vec4_type,  glsl_type::float_type), \
                                                                                          \
-                _##NAME(always_available, glsl_type::vec2_type,  glsl_type::vec2_type),  \
-                _##NAME(always_available, glsl_type::vec3_type,  glsl_type::vec3_type),  \
-                _##NAME(always_available, glsl_type::vec4_type,  glsl_type::vec4_type),  \
+                   _##NAME(always_available, glsl_type::vec2_type,  glsl_type::vec2_type),  \
+                   _##NAME(always_available, glsl_type::vec3_type,  glsl_type::vec3_type),  \
+                   _##NAME(always_available, glsl_type::vec4_type,  glsl_type::vec4_type),  \
                                                                                          \
-                _##NAME(always_available, glsl_type::int_type,   glsl_type::int_type),   \
-                _##NAME(always_available, glsl_type::ivec2_type, glsl_type::int_type),   \
-                _##NAME(always_available, glsl_type::ivec3_type, glsl_type::int_type),   \
-                _##NAME(always_available, glsl_type::ivec4_type, glsl_type::int_type),   \
+                   _##NAME(always_available, glsl_type::int_type,   glsl_type::int_type),   \
+                   _##NAME(always_available, glsl_type::ivec2_type, glsl_type::int_type),   \
+                   _##NAME(always_available, glsl_type::ivec3_type, glsl_type::int_type),   \
+                   _##NAME(always_available, glsl_type::ivec4_type, glsl_type::int_type),   \
                                                                                          \
-                _##NAME(always_available, glsl_type::ivec2_type, glsl_type::ivec2_type), \
-                _##NAME(always_available, glsl_type::ivec3_type, glsl_type::ivec3_type), \
-                _##NAME(always_available, glsl_type::ivec4_type, glsl_type::ivec4_type), \
+                   _##NAME(always_available, glsl_type::ivec2_type, glsl_type::ivec2_type), \
+                   _##NAME(always_available, glsl_type::ivec3_type, glsl_type::ivec3_type), \
+                   _##NAME(always_available, glsl_type::ivec4_type, glsl_type::ivec4_type), \
                                                                                          \
-                _##NAME(v130, glsl_type::uint_type,  glsl_type::uint_type),              \
-                _##NAME(v130, glsl_type::uvec2_type, glsl_type::uint_type),              \
-                _##NAME(v130, glsl_type::uvec3_type, glsl_type::uint_type),              \
-                _##NAME(v130, glsl_type::uvec4_type, glsl_type::uint_type),              \
+                   _##NAME(v130, glsl_type::uint_type,  glsl_type::uint_type),           \
+                   _##NAME(v130, glsl_type::uvec2_type, glsl_type::uint_type),           \
+                   _##NAME(v130, glsl_type::uvec3_type, glsl_type::uint_type),           \
+                   _##NAME(v130, glsl_type::uvec4_type, glsl_type::uint_type),           \
                                                                                          \
-                _##NAME(v130, glsl_type::uvec2_type, glsl_type::uvec2_type),             \
-                _##NAME(v130, glsl_type::uvec3_type, glsl_type::uvec3_type),             \
-                _##NAME(v130, glsl_type::uvec4_type, glsl_type::uvec4_type),             \
+                   _##NAME(v130, glsl_type::uvec2_type, glsl_type::uvec2_type),          \
+                   _##NAME(v130, glsl_type::uvec3_type, glsl_type::uvec3_type),          \
+                   _##NAME(v130, glsl_type::uvec4_type, glsl_type::uvec4_type),          \
                                                                                          \
-                _##NAME(fp64, glsl_type::double_type, glsl_type::double_type),           \
-                _##NAME(fp64, glsl_type::dvec2_type, glsl_type::double_type),           \
-                _##NAME(fp64, glsl_type::dvec3_type, glsl_type::double_type),           \
-                _##NAME(fp64, glsl_type::dvec4_type, glsl_type::double_type),           \
-                _##NAME(fp64, glsl_type::dvec2_type, glsl_type::dvec2_type),           \
-                _##NAME(fp64, glsl_type::dvec3_type, glsl_type::dvec3_type),           \
-                _##NAME(fp64, glsl_type::dvec4_type, glsl_type::dvec4_type),           \
-                NULL);
+                   _##NAME(fp64, glsl_type::double_type, glsl_type::double_type),        \
+                   _##NAME(fp64, glsl_type::dvec2_type, glsl_type::double_type),        \
+                   _##NAME(fp64, glsl_type::dvec3_type, glsl_type::double_type),        \
+                   _##NAME(fp64, glsl_type::dvec4_type, glsl_type::double_type),        \
+                   _##NAME(fp64, glsl_type::dvec2_type, glsl_type::dvec2_type),        \
+                   _##NAME(fp64, glsl_type::dvec3_type, glsl_type::dvec3_type),        \
+                   _##NAME(fp64, glsl_type::dvec4_type, glsl_type::dvec4_type),        \
+                   NULL);
 
    F(radians)
    F(degrees)
@@ -1265,16 +1406,17 @@ builtin_builder::create_builtins()
    F(asin)
    F(acos)
 
-   add_function("atan",
-                _atan(glsl_type::float_type),
-                _atan(glsl_type::vec2_type),
-                _atan(glsl_type::vec3_type),
-                _atan(glsl_type::vec4_type),
-                _atan2(glsl_type::float_type),
-                _atan2(glsl_type::vec2_type),
-                _atan2(glsl_type::vec3_type),
-                _atan2(glsl_type::vec4_type),
-                NULL);
+   if (wants_function("atan"))
+      add_function("atan",
+                   _atan(glsl_type::float_type),
+                   _atan(glsl_type::vec2_type),
+                   _atan(glsl_type::vec3_type),
+                   _atan(glsl_type::vec4_type),
+                   _atan2(glsl_type::float_type),
+                   _atan2(glsl_type::vec2_type),
+                   _atan2(glsl_type::vec3_type),
+                   _atan2(glsl_type::vec4_type),
+                   NULL);
 
    F(sinh)
    F(cosh)
@@ -1298,25 +1440,26 @@ builtin_builder::create_builtins()
    FD(ceil)
    FD(fract)
 
-   add_function("mod",
-                _mod(always_available, glsl_type::float_type, glsl_type::float_type),
-                _mod(always_available, glsl_type::vec2_type,  glsl_type::float_type),
-                _mod(always_available, glsl_type::vec3_type,  glsl_type::float_type),
-                _mod(always_available, glsl_type::vec4_type,  glsl_type::float_type),
+   if (wants_function("mod"))
+      add_function("mod",
+                   _mod(always_available, glsl_type::float_type, glsl_type::float_type),
+                   _mod(always_available, glsl_type::vec2_type,  glsl_type::float_type),
+                   _mod(always_available, glsl_type::vec3_type,  glsl_type::float_type),
+                   _mod(always_available, glsl_type::vec4_type,  glsl_type::float_type),
 
-                _mod(always_available, glsl_type::vec2_type,  glsl_type::vec2_type),
-                _mod(always_available, glsl_type::vec3_type,  glsl_type::vec3_type),
-                _mod(always_available, glsl_type::vec4_type,  glsl_type::vec4_type),
+                   _mod(always_available, glsl_type::vec2_type,  glsl_type::vec2_type),
+                   _mod(always_available, glsl_type::vec3_type,  glsl_type::vec3_type),
+                   _mod(always_available, glsl_type::vec4_type,  glsl_type::vec4_type),
 
-                _mod(fp64, glsl_type::double_type, glsl_type::double_type),
-                _mod(fp64, glsl_type::dvec2_type,  glsl_type::double_type),
-                _mod(fp64, glsl_type::dvec3_type,  glsl_type::double_type),
-                _mod(fp64, glsl_type::dvec4_type,  glsl_type::double_type),
+                   _mod(fp64, glsl_type::double_type, glsl_type::double_type),
+                   _mod(fp64, glsl_type::dvec2_type,  glsl_type::double_type),
+                   _mod(fp64, glsl_type::dvec3_type,  glsl_type::double_type),
+                   _mod(fp64, glsl_type::dvec4_type,  glsl_type::double_type),
 
-                _mod(fp64, glsl_type::dvec2_type,  glsl_type::dvec2_type),
-                _mod(fp64, glsl_type::dvec3_type,  glsl_type::dvec3_type),
-                _mod(fp64, glsl_type::dvec4_type,  glsl_type::dvec4_type),
-                NULL);
+                   _mod(fp64, glsl_type::dvec2_type,  glsl_type::dvec2_type),
+                   _mod(fp64, glsl_type::dvec3_type,  glsl_type::dvec3_type),
+                   _mod(fp64, glsl_type::dvec4_type,  glsl_type::dvec4_type),
+                   NULL);
 
    FD(modf)
 
@@ -1324,211 +1467,235 @@ builtin_builder::create_builtins()
    FIUD2_MIXED(max)
    FIUD2_MIXED(clamp)
 
-   add_function("mix",
-                _mix_lrp(always_available, glsl_type::float_type, glsl_type::float_type),
-                _mix_lrp(always_available, glsl_type::vec2_type,  glsl_type::float_type),
-                _mix_lrp(always_available, glsl_type::vec3_type,  glsl_type::float_type),
-                _mix_lrp(always_available, glsl_type::vec4_type,  glsl_type::float_type),
-
-                _mix_lrp(always_available, glsl_type::vec2_type,  glsl_type::vec2_type),
-                _mix_lrp(always_available, glsl_type::vec3_type,  glsl_type::vec3_type),
-                _mix_lrp(always_available, glsl_type::vec4_type,  glsl_type::vec4_type),
-
-                _mix_lrp(fp64, glsl_type::double_type, glsl_type::double_type),
-                _mix_lrp(fp64, glsl_type::dvec2_type,  glsl_type::double_type),
-                _mix_lrp(fp64, glsl_type::dvec3_type,  glsl_type::double_type),
-                _mix_lrp(fp64, glsl_type::dvec4_type,  glsl_type::double_type),
-
-                _mix_lrp(fp64, glsl_type::dvec2_type,  glsl_type::dvec2_type),
-                _mix_lrp(fp64, glsl_type::dvec3_type,  glsl_type::dvec3_type),
-                _mix_lrp(fp64, glsl_type::dvec4_type,  glsl_type::dvec4_type),
-
-                _mix_sel(v130, glsl_type::float_type, glsl_type::bool_type),
-                _mix_sel(v130, glsl_type::vec2_type,  glsl_type::bvec2_type),
-                _mix_sel(v130, glsl_type::vec3_type,  glsl_type::bvec3_type),
-                _mix_sel(v130, glsl_type::vec4_type,  glsl_type::bvec4_type),
-
-                _mix_sel(fp64, glsl_type::double_type, glsl_type::bool_type),
-                _mix_sel(fp64, glsl_type::dvec2_type,  glsl_type::bvec2_type),
-                _mix_sel(fp64, glsl_type::dvec3_type,  glsl_type::bvec3_type),
-                _mix_sel(fp64, glsl_type::dvec4_type,  glsl_type::bvec4_type),
-
-                _mix_sel(shader_integer_mix, glsl_type::int_type,   glsl_type::bool_type),
-                _mix_sel(shader_integer_mix, glsl_type::ivec2_type, glsl_type::bvec2_type),
-                _mix_sel(shader_integer_mix, glsl_type::ivec3_type, glsl_type::bvec3_type),
-                _mix_sel(shader_integer_mix, glsl_type::ivec4_type, glsl_type::bvec4_type),
-
-                _mix_sel(shader_integer_mix, glsl_type::uint_type,  glsl_type::bool_type),
-                _mix_sel(shader_integer_mix, glsl_type::uvec2_type, glsl_type::bvec2_type),
-                _mix_sel(shader_integer_mix, glsl_type::uvec3_type, glsl_type::bvec3_type),
-                _mix_sel(shader_integer_mix, glsl_type::uvec4_type, glsl_type::bvec4_type),
-
-                _mix_sel(shader_integer_mix, glsl_type::bool_type,  glsl_type::bool_type),
-                _mix_sel(shader_integer_mix, glsl_type::bvec2_type, glsl_type::bvec2_type),
-                _mix_sel(shader_integer_mix, glsl_type::bvec3_type, glsl_type::bvec3_type),
-                _mix_sel(shader_integer_mix, glsl_type::bvec4_type, glsl_type::bvec4_type),
-                NULL);
-
-   add_function("step",
-                _step(always_available, glsl_type::float_type, glsl_type::float_type),
-                _step(always_available, glsl_type::float_type, glsl_type::vec2_type),
-                _step(always_available, glsl_type::float_type, glsl_type::vec3_type),
-                _step(always_available, glsl_type::float_type, glsl_type::vec4_type),
-
-                _step(always_available, glsl_type::vec2_type,  glsl_type::vec2_type),
-                _step(always_available, glsl_type::vec3_type,  glsl_type::vec3_type),
-                _step(always_available, glsl_type::vec4_type,  glsl_type::vec4_type),
-                _step(fp64, glsl_type::double_type, glsl_type::double_type),
-                _step(fp64, glsl_type::double_type, glsl_type::dvec2_type),
-                _step(fp64, glsl_type::double_type, glsl_type::dvec3_type),
-                _step(fp64, glsl_type::double_type, glsl_type::dvec4_type),
-
-                _step(fp64, glsl_type::dvec2_type,  glsl_type::dvec2_type),
-                _step(fp64, glsl_type::dvec3_type,  glsl_type::dvec3_type),
-                _step(fp64, glsl_type::dvec4_type,  glsl_type::dvec4_type),
-                NULL);
-
-   add_function("smoothstep",
-                _smoothstep(always_available, glsl_type::float_type, glsl_type::float_type),
-                _smoothstep(always_available, glsl_type::float_type, glsl_type::vec2_type),
-                _smoothstep(always_available, glsl_type::float_type, glsl_type::vec3_type),
-                _smoothstep(always_available, glsl_type::float_type, glsl_type::vec4_type),
-
-                _smoothstep(always_available, glsl_type::vec2_type,  glsl_type::vec2_type),
-                _smoothstep(always_available, glsl_type::vec3_type,  glsl_type::vec3_type),
-                _smoothstep(always_available, glsl_type::vec4_type,  glsl_type::vec4_type),
-                _smoothstep(fp64, glsl_type::double_type, glsl_type::double_type),
-                _smoothstep(fp64, glsl_type::double_type, glsl_type::dvec2_type),
-                _smoothstep(fp64, glsl_type::double_type, glsl_type::dvec3_type),
-                _smoothstep(fp64, glsl_type::double_type, glsl_type::dvec4_type),
-
-                _smoothstep(fp64, glsl_type::dvec2_type,  glsl_type::dvec2_type),
-                _smoothstep(fp64, glsl_type::dvec3_type,  glsl_type::dvec3_type),
-                _smoothstep(fp64, glsl_type::dvec4_type,  glsl_type::dvec4_type),
-                NULL);
+   if (wants_function("mix"))
+      add_function("mix",
+                   _mix_lrp(always_available, glsl_type::float_type, glsl_type::float_type),
+                   _mix_lrp(always_available, glsl_type::vec2_type,  glsl_type::float_type),
+                   _mix_lrp(always_available, glsl_type::vec3_type,  glsl_type::float_type),
+                   _mix_lrp(always_available, glsl_type::vec4_type,  glsl_type::float_type),
+
+                   _mix_lrp(always_available, glsl_type::vec2_type,  glsl_type::vec2_type),
+                   _mix_lrp(always_available, glsl_type::vec3_type,  glsl_type::vec3_type),
+                   _mix_lrp(always_available, glsl_type::vec4_type,  glsl_type::vec4_type),
+
+                   _mix_lrp(fp64, glsl_type::double_type, glsl_type::double_type),
+                   _mix_lrp(fp64, glsl_type::dvec2_type,  glsl_type::double_type),
+                   _mix_lrp(fp64, glsl_type::dvec3_type,  glsl_type::double_type),
+                   _mix_lrp(fp64, glsl_type::dvec4_type,  glsl_type::double_type),
+
+                   _mix_lrp(fp64, glsl_type::dvec2_type,  glsl_type::dvec2_type),
+                   _mix_lrp(fp64, glsl_type::dvec3_type,  glsl_type::dvec3_type),
+                   _mix_lrp(fp64, glsl_type::dvec4_type,  glsl_type::dvec4_type),
+
+                   _mix_sel(v130, glsl_type::float_type, glsl_type::bool_type),
+                   _mix_sel(v130, glsl_type::vec2_type,  glsl_type::bvec2_type),
+                   _mix_sel(v130, glsl_type::vec3_type,  glsl_type::bvec3_type),
+                   _mix_sel(v130, glsl_type::vec4_type,  glsl_type::bvec4_type),
+
+                   _mix_sel(fp64, glsl_type::double_type, glsl_type::bool_type),
+                   _mix_sel(fp64, glsl_type::dvec2_type,  glsl_type::bvec2_type),
+                   _mix_sel(fp64, glsl_type::dvec3_type,  glsl_type::bvec3_type),
+                   _mix_sel(fp64, glsl_type::dvec4_type,  glsl_type::bvec4_type),
+
+                   _mix_sel(shader_integer_mix, glsl_type::int_type,   glsl_type::bool_type),
+                   _mix_sel(shader_integer_mix, glsl_type::ivec2_type, glsl_type::bvec2_type),
+                   _mix_sel(shader_integer_mix, glsl_type::ivec3_type, glsl_type::bvec3_type),
+                   _mix_sel(shader_integer_mix, glsl_type::ivec4_type, glsl_type::bvec4_type),
+
+                   _mix_sel(shader_integer_mix, glsl_type::uint_type,  glsl_type::bool_type),
+                   _mix_sel(shader_integer_mix, glsl_type::uvec2_type, glsl_type::bvec2_type),
+                   _mix_sel(shader_integer_mix, glsl_type::uvec3_type, glsl_type::bvec3_type),
+                   _mix_sel(shader_integer_mix, glsl_type::uvec4_type, glsl_type::bvec4_type),
+
+                   _mix_sel(shader_integer_mix, glsl_type::bool_type,  glsl_type::bool_type),
+                   _mix_sel(shader_integer_mix, glsl_type::bvec2_type, glsl_type::bvec2_type),
+                   _mix_sel(shader_integer_mix, glsl_type::bvec3_type, glsl_type::bvec3_type),
+                   _mix_sel(shader_integer_mix, glsl_type::bvec4_type, glsl_type::bvec4_type),
+                   NULL);
+
+   if (wants_function("step"))
+      add_function("step",
+                   _step(always_available, glsl_type::float_type, glsl_type::float_type),
+                   _step(always_available, glsl_type::float_type, glsl_type::vec2_type),
+                   _step(always_available, glsl_type::float_type, glsl_type::vec3_type),
+                   _step(always_available, glsl_type::float_type, glsl_type::vec4_type),
+
+                   _step(always_available, glsl_type::vec2_type,  glsl_type::vec2_type),
+                   _step(always_available, glsl_type::vec3_type,  glsl_type::vec3_type),
+                   _step(always_available, glsl_type::vec4_type,  glsl_type::vec4_type),
+                   _step(fp64, glsl_type::double_type, glsl_type::double_type),
+                   _step(fp64, glsl_type::double_type, glsl_type::dvec2_type),
+                   _step(fp64, glsl_type::double_type, glsl_type::dvec3_type),
+                   _step(fp64, glsl_type::double_type, glsl_type::dvec4_type),
+
+                   _step(fp64, glsl_type::dvec2_type,  glsl_type::dvec2_type),
+                   _step(fp64, glsl_type::dvec3_type,  glsl_type::dvec3_type),
+                   _step(fp64, glsl_type::dvec4_type,  glsl_type::dvec4_type),
+                   NULL);
+
+   if (wants_function("smoothstep"))
+      add_function("smoothstep",
+                   _smoothstep(always_available, glsl_type::float_type, glsl_type::float_type),
+                   _smoothstep(always_available, glsl_type::float_type, glsl_type::vec2_type),
+                   _smoothstep(always_available, glsl_type::float_type, glsl_type::vec3_type),
+                   _smoothstep(always_available, glsl_type::float_type, glsl_type::vec4_type),
+
+                   _smoothstep(always_available, glsl_type::vec2_type,  glsl_type::vec2_type),
+                   _smoothstep(always_available, glsl_type::vec3_type,  glsl_type::vec3_type),
+                   _smoothstep(always_available, glsl_type::vec4_type,  glsl_type::vec4_type),
+                   _smoothstep(fp64, glsl_type::double_type, glsl_type::double_type),
+                   _smoothstep(fp64, glsl_type::double_type, glsl_type::dvec2_type),
+                   _smoothstep(fp64, glsl_type::double_type, glsl_type::dvec3_type),
+                   _smoothstep(fp64, glsl_type::double_type, glsl_type::dvec4_type),
+
+                   _smoothstep(fp64, glsl_type::dvec2_type,  glsl_type::dvec2_type),
+                   _smoothstep(fp64, glsl_type::dvec3_type,  glsl_type::dvec3_type),
+                   _smoothstep(fp64, glsl_type::dvec4_type,  glsl_type::dvec4_type),
+                   NULL);
 
    FD130(isnan)
    FD130(isinf)
 
    F(floatBitsToInt)
    F(floatBitsToUint)
-   add_function("intBitsToFloat",
-                _intBitsToFloat(glsl_type::int_type),
-                _intBitsToFloat(glsl_type::ivec2_type),
-                _intBitsToFloat(glsl_type::ivec3_type),
-                _intBitsToFloat(glsl_type::ivec4_type),
-                NULL);
-   add_function("uintBitsToFloat",
-                _uintBitsToFloat(glsl_type::uint_type),
-                _uintBitsToFloat(glsl_type::uvec2_type),
-                _uintBitsToFloat(glsl_type::uvec3_type),
-                _uintBitsToFloat(glsl_type::uvec4_type),
-                NULL);
-
-   add_function("packUnorm2x16",   _packUnorm2x16(shader_packing_or_es3_or_gpu_shader5),   NULL);
-   add_function("packSnorm2x16",   _packSnorm2x16(shader_packing_or_es3),                  NULL);
-   add_function("packUnorm4x8",    _packUnorm4x8(shader_packing_or_es31_or_gpu_shader5),   NULL);
-   add_function("packSnorm4x8",    _packSnorm4x8(shader_packing_or_es31_or_gpu_shader5),   NULL);
-   add_function("unpackUnorm2x16", _unpackUnorm2x16(shader_packing_or_es3_or_gpu_shader5), NULL);
-   add_function("unpackSnorm2x16", _unpackSnorm2x16(shader_packing_or_es3),                NULL);
-   add_function("unpackUnorm4x8",  _unpackUnorm4x8(shader_packing_or_es31_or_gpu_shader5), NULL);
-   add_function("unpackSnorm4x8",  _unpackSnorm4x8(shader_packing_or_es31_or_gpu_shader5), NULL);
-   add_function("packHalf2x16",    _packHalf2x16(shader_packing_or_es3),                   NULL);
-   add_function("unpackHalf2x16",  _unpackHalf2x16(shader_packing_or_es3),                 NULL);
-   add_function("packDouble2x32",    _packDouble2x32(fp64),                   NULL);
-   add_function("unpackDouble2x32",  _unpackDouble2x32(fp64),                 NULL);
+   if (wants_function("intBitsToFloat"))
+      add_function("intBitsToFloat",
+                   _intBitsToFloat(glsl_type::int_type),
+                   _intBitsToFloat(glsl_type::ivec2_type),
+                   _intBitsToFloat(glsl_type::ivec3_type),
+                   _intBitsToFloat(glsl_type::ivec4_type),
+                   NULL);
+   if (wants_function("uintBitsToFloat"))
+      add_function("uintBitsToFloat",
+                   _uintBitsToFloat(glsl_type::uint_type),
+                   _uintBitsToFloat(glsl_type::uvec2_type),
+                   _uintBitsToFloat(glsl_type::uvec3_type),
+                   _uintBitsToFloat(glsl_type::uvec4_type),
+                   NULL);
+
+   if (wants_function("packUnorm2x16"))
+      add_function("packUnorm2x16",   _packUnorm2x16(shader_packing_or_es3_or_gpu_shader5),   NULL);
+   if (wants_function("packSnorm2x16"))
+      add_function("packSnorm2x16",   _packSnorm2x16(shader_packing_or_es3),                  NULL);
+   if (wants_function("packUnorm4x8"))
+      add_function("packUnorm4x8",    _packUnorm4x8(shader_packing_or_es31_or_gpu_shader5),   NULL);
+   if (wants_function("packSnorm4x8"))
+      add_function("packSnorm4x8",    _packSnorm4x8(shader_packing_or_es31_or_gpu_shader5),   NULL);
+   if (wants_function("unpackUnorm2x16"))
+      add_function("unpackUnorm2x16", _unpackUnorm2x16(shader_packing_or_es3_or_gpu_shader5), NULL);
+   if (wants_function("unpackSnorm2x16"))
+      add_function("unpackSnorm2x16", _unpackSnorm2x16(shader_packing_or_es3),                NULL);
+   if (wants_function("unpackUnorm4x8"))
+      add_function("unpackUnorm4x8",  _unpackUnorm4x8(shader_packing_or_es31_or_gpu_shader5), NULL);
+   if (wants_function("unpackSnorm4x8"))
+      add_function("unpackSnorm4x8",  _unpackSnorm4x8(shader_packing_or_es31_or_gpu_shader5), NULL);
+   if (wants_function("packHalf2x16"))
+      add_function("packHalf2x16",    _packHalf2x16(shader_packing_or_es3),                   NULL);
+   if (wants_function("unpackHalf2x16"))
+      add_function("unpackHalf2x16",  _unpackHalf2x16(shader_packing_or_es3),                 NULL);
+   if (wants_function("packDouble2x32"))
+      add_function("packDouble2x32",    _packDouble2x32(fp64),                   NULL);
+   if (wants_function("unpackDouble2x32"))
+      add_function("unpackDouble2x32",  _unpackDouble2x32(fp64),                 NULL);
 
 
    FD(length)
    FD(distance)
    FD(dot)
 
-   add_function("cross", _cross(always_available, glsl_type::vec3_type),
-                _cross(fp64, glsl_type::dvec3_type), NULL);
+   if (wants_function("cross"))
+      add_function("cross", _cross(always_available, glsl_type::vec3_type),
+                   _cross(fp64, glsl_type::dvec3_type), NULL);
 
    FD(normalize)
-   add_function("ftransform", _ftransform(), NULL);
+   if (wants_function("ftransform"))
+      add_function("ftransform", _ftransform(), NULL);
    FD(faceforward)
    FD(reflect)
    FD(refract)
    // ...
-   add_function("matrixCompMult",
-                _matrixCompMult(always_available, glsl_type::mat2_type),
-                _matrixCompMult(always_available, glsl_type::mat3_type),
-                _matrixCompMult(always_available, glsl_type::mat4_type),
-                _matrixCompMult(always_available, glsl_type::mat2x3_type),
-                _matrixCompMult(always_available, glsl_type::mat2x4_type),
-                _matrixCompMult(always_available, glsl_type::mat3x2_type),
-                _matrixCompMult(always_available, glsl_type::mat3x4_type),
-                _matrixCompMult(always_available, glsl_type::mat4x2_type),
-                _matrixCompMult(always_available, glsl_type::mat4x3_type),
-                _matrixCompMult(fp64, glsl_type::dmat2_type),
-                _matrixCompMult(fp64, glsl_type::dmat3_type),
-                _matrixCompMult(fp64, glsl_type::dmat4_type),
-                _matrixCompMult(fp64, glsl_type::dmat2x3_type),
-                _matrixCompMult(fp64, glsl_type::dmat2x4_type),
-                _matrixCompMult(fp64, glsl_type::dmat3x2_type),
-                _matrixCompMult(fp64, glsl_type::dmat3x4_type),
-                _matrixCompMult(fp64, glsl_type::dmat4x2_type),
-                _matrixCompMult(fp64, glsl_type::dmat4x3_type),
-                NULL);
-   add_function("outerProduct",
-                _outerProduct(v120, glsl_type::mat2_type),
-                _outerProduct(v120, glsl_type::mat3_type),
-                _outerProduct(v120, glsl_type::mat4_type),
-                _outerProduct(v120, glsl_type::mat2x3_type),
-                _outerProduct(v120, glsl_type::mat2x4_type),
-                _outerProduct(v120, glsl_type::mat3x2_type),
-                _outerProduct(v120, glsl_type::mat3x4_type),
-                _outerProduct(v120, glsl_type::mat4x2_type),
-                _outerProduct(v120, glsl_type::mat4x3_type),
-                _outerProduct(fp64, glsl_type::dmat2_type),
-                _outerProduct(fp64, glsl_type::dmat3_type),
-                _outerProduct(fp64, glsl_type::dmat4_type),
-                _outerProduct(fp64, glsl_type::dmat2x3_type),
-                _outerProduct(fp64, glsl_type::dmat2x4_type),
-                _outerProduct(fp64, glsl_type::dmat3x2_type),
-                _outerProduct(fp64, glsl_type::dmat3x4_type),
-                _outerProduct(fp64, glsl_type::dmat4x2_type),
-                _outerProduct(fp64, glsl_type::dmat4x3_type),
-                NULL);
-   add_function("determinant",
-                _determinant_mat2(v120, glsl_type::mat2_type),
-                _determinant_mat3(v120, glsl_type::mat3_type),
-                _determinant_mat4(v120, glsl_type::mat4_type),
-                _determinant_mat2(fp64, glsl_type::dmat2_type),
-                _determinant_mat3(fp64, glsl_type::dmat3_type),
-                _determinant_mat4(fp64, glsl_type::dmat4_type),
-
-                NULL);
-   add_function("inverse",
-                _inverse_mat2(v140_or_es3, glsl_type::mat2_type),
-                _inverse_mat3(v140_or_es3, glsl_type::mat3_type),
-                _inverse_mat4(v140_or_es3, glsl_type::mat4_type),
-                _inverse_mat2(fp64, glsl_type::dmat2_type),
-                _inverse_mat3(fp64, glsl_type::dmat3_type),
-                _inverse_mat4(fp64, glsl_type::dmat4_type),
-                NULL);
-   add_function("transpose",
-                _transpose(v120, glsl_type::mat2_type),
-                _transpose(v120, glsl_type::mat3_type),
-                _transpose(v120, glsl_type::mat4_type),
-                _transpose(v120, glsl_type::mat2x3_type),
-                _transpose(v120, glsl_type::mat2x4_type),
-                _transpose(v120, glsl_type::mat3x2_type),
-                _transpose(v120, glsl_type::mat3x4_type),
-                _transpose(v120, glsl_type::mat4x2_type),
-                _transpose(v120, glsl_type::mat4x3_type),
-                _transpose(fp64, glsl_type::dmat2_type),
-                _transpose(fp64, glsl_type::dmat3_type),
-                _transpose(fp64, glsl_type::dmat4_type),
-                _transpose(fp64, glsl_type::dmat2x3_type),
-                _transpose(fp64, glsl_type::dmat2x4_type),
-                _transpose(fp64, glsl_type::dmat3x2_type),
-                _transpose(fp64, glsl_type::dmat3x4_type),
-                _transpose(fp64, glsl_type::dmat4x2_type),
-                _transpose(fp64, glsl_type::dmat4x3_type),
-                NULL);
+   if (wants_function("matrixCompMult"))
+      add_function("matrixCompMult",
+                   _matrixCompMult(always_available, glsl_type::mat2_type),
+                   _matrixCompMult(always_available, glsl_type::mat3_type),
+                   _matrixCompMult(always_available, glsl_type::mat4_type),
+                   _matrixCompMult(always_available, glsl_type::mat2x3_type),
+                   _matrixCompMult(always_available, glsl_type::mat2x4_type),
+                   _matrixCompMult(always_available, glsl_type::mat3x2_type),
+                   _matrixCompMult(always_available, glsl_type::mat3x4_type),
+                   _matrixCompMult(always_available, glsl_type::mat4x2_type),
+                   _matrixCompMult(always_available, glsl_type::mat4x3_type),
+                   _matrixCompMult(fp64, glsl_type::dmat2_type),
+                   _matrixCompMult(fp64, glsl_type::dmat3_type),
+                   _matrixCompMult(fp64, glsl_type::dmat4_type),
+                   _matrixCompMult(fp64, glsl_type::dmat2x3_type),
+                   _matrixCompMult(fp64, glsl_type::dmat2x4_type),
+                   _matrixCompMult(fp64, glsl_type::dmat3x2_type),
+                   _matrixCompMult(fp64, glsl_type::dmat3x4_type),
+                   _matrixCompMult(fp64, glsl_type::dmat4x2_type),
+                   _matrixCompMult(fp64, glsl_type::dmat4x3_type),
+                   NULL);
+   if (wants_function("outerProduct"))
+      add_function("outerProduct",
+                   _outerProduct(v120, glsl_type::mat2_type),
+                   _outerProduct(v120, glsl_type::mat3_type),
+                   _outerProduct(v120, glsl_type::mat4_type),
+                   _outerProduct(v120, glsl_type::mat2x3_type),
+                   _outerProduct(v120, glsl_type::mat2x4_type),
+                   _outerProduct(v120, glsl_type::mat3x2_type),
+                   _outerProduct(v120, glsl_type::mat3x4_type),
+                   _outerProduct(v120, glsl_type::mat4x2_type),
+                   _outerProduct(v120, glsl_type::mat4x3_type),
+                   _outerProduct(fp64, glsl_type::dmat2_type),
+                   _outerProduct(fp64, glsl_type::dmat3_type),
+                   _outerProduct(fp64, glsl_type::dmat4_type),
+                   _outerProduct(fp64, glsl_type::dmat2x3_type),
+                   _outerProduct(fp64, glsl_type::dmat2x4_type),
+                   _outerProduct(fp64, glsl_type::dmat3x2_type),
+                   _outerProduct(fp64, glsl_type::dmat3x4_type),
+                   _outerProduct(fp64, glsl_type::dmat4x2_type),
+                   _outerProduct(fp64, glsl_type::dmat4x3_type),
+                   NULL);
+   if (wants_function("determinant"))
+      add_function("determinant",
+                   _determinant_mat2(v120, glsl_type::mat2_type),
+                   _determinant_mat3(v120, glsl_type::mat3_type),
+                   _determinant_mat4(v120, glsl_type::mat4_type),
+                   _determinant_mat2(fp64, glsl_type::dmat2_type),
+                   _determinant_mat3(fp64, glsl_type::dmat3_type),
+                   _determinant_mat4(fp64, glsl_type::dmat4_type),
+
+                   NULL);
+   if (wants_function("inverse"))
+      add_function("inverse",
+                   _inverse_mat2(v140_or_es3, glsl_type::mat2_type),
+                   _inverse_mat3(v140_or_es3, glsl_type::mat3_type),
+                   _inverse_mat4(v140_or_es3, glsl_type::mat4_type),
+                   _inverse_mat2(fp64, glsl_type::dmat2_type),
+                   _inverse_mat3(fp64, glsl_type::dmat3_type),
+                   _inverse_mat4(fp64, glsl_type::dmat4_type),
+                   NULL);
+   if (wants_function("transpose"))
+      add_function("transpose",
+                   _transpose(v120, glsl_type::mat2_type),
+                   _transpose(v120, glsl_type::mat3_type),
+                   _transpose(v120, glsl_type::mat4_type),
+                   _transpose(v120, glsl_type::mat2x3_type),
+                   _transpose(v120, glsl_type::mat2x4_type),
+                   _transpose(v120, glsl_type::mat3x2_type),
+                   _transpose(v120, glsl_type::mat3x4_type),
+                   _transpose(v120, glsl_type::mat4x2_type),
+                   _transpose(v120, glsl_type::mat4x3_type),
+                   _transpose(fp64, glsl_type::dmat2_type),
+                   _transpose(fp64, glsl_type::dmat3_type),
+                   _transpose(fp64, glsl_type::dmat4_type),
+                   _transpose(fp64, glsl_type::dmat2x3_type),
+                   _transpose(fp64, glsl_type::dmat2x4_type),
+                   _transpose(fp64, glsl_type::dmat3x2_type),
+                   _transpose(fp64, glsl_type::dmat3x4_type),
+                   _transpose(fp64, glsl_type::dmat4x2_type),
+                   _transpose(fp64, glsl_type::dmat4x3_type),
+                   NULL);
    FIUD(lessThan)
    FIUD(lessThanEqual)
    FIUD(greaterThan)
@@ -1536,1128 +1703,1207 @@ builtin_builder::create_builtins()
    FIUBD(notEqual)
    FIUBD(equal)
 
-   add_function("any",
-                _any(glsl_type::bvec2_type),
-                _any(glsl_type::bvec3_type),
-                _any(glsl_type::bvec4_type),
-                NULL);
-
-   add_function("all",
-                _all(glsl_type::bvec2_type),
-                _all(glsl_type::bvec3_type),
-                _all(glsl_type::bvec4_type),
-                NULL);
-
-   add_function("not",
-                _not(glsl_type::bvec2_type),
-                _not(glsl_type::bvec3_type),
-                _not(glsl_type::bvec4_type),
-                NULL);
-
-   add_function("textureSize",
-                _textureSize(v130, glsl_type::int_type,   glsl_type::sampler1D_type),
-                _textureSize(v130, glsl_type::int_type,   glsl_type::isampler1D_type),
-                _textureSize(v130, glsl_type::int_type,   glsl_type::usampler1D_type),
-
-                _textureSize(v130, glsl_type::ivec2_type, glsl_type::sampler2D_type),
-                _textureSize(v130, glsl_type::ivec2_type, glsl_type::isampler2D_type),
-                _textureSize(v130, glsl_type::ivec2_type, glsl_type::usampler2D_type),
-
-                _textureSize(v130, glsl_type::ivec3_type, glsl_type::sampler3D_type),
-                _textureSize(v130, glsl_type::ivec3_type, glsl_type::isampler3D_type),
-                _textureSize(v130, glsl_type::ivec3_type, glsl_type::usampler3D_type),
-
-                _textureSize(v130, glsl_type::ivec2_type, glsl_type::samplerCube_type),
-                _textureSize(v130, glsl_type::ivec2_type, glsl_type::isamplerCube_type),
-                _textureSize(v130, glsl_type::ivec2_type, glsl_type::usamplerCube_type),
-
-                _textureSize(v130, glsl_type::int_type,   glsl_type::sampler1DShadow_type),
-                _textureSize(v130, glsl_type::ivec2_type, glsl_type::sampler2DShadow_type),
-                _textureSize(v130, glsl_type::ivec2_type, glsl_type::samplerCubeShadow_type),
-
-                _textureSize(v130, glsl_type::ivec2_type, glsl_type::sampler1DArray_type),
-                _textureSize(v130, glsl_type::ivec2_type, glsl_type::isampler1DArray_type),
-                _textureSize(v130, glsl_type::ivec2_type, glsl_type::usampler1DArray_type),
-                _textureSize(v130, glsl_type::ivec3_type, glsl_type::sampler2DArray_type),
-                _textureSize(v130, glsl_type::ivec3_type, glsl_type::isampler2DArray_type),
-                _textureSize(v130, glsl_type::ivec3_type, glsl_type::usampler2DArray_type),
-
-                _textureSize(v130, glsl_type::ivec2_type, glsl_type::sampler1DArrayShadow_type),
-                _textureSize(v130, glsl_type::ivec3_type, glsl_type::sampler2DArrayShadow_type),
-
-                _textureSize(texture_cube_map_array, glsl_type::ivec3_type, glsl_type::samplerCubeArray_type),
-                _textureSize(texture_cube_map_array, glsl_type::ivec3_type, glsl_type::isamplerCubeArray_type),
-                _textureSize(texture_cube_map_array, glsl_type::ivec3_type, glsl_type::usamplerCubeArray_type),
-                _textureSize(texture_cube_map_array, glsl_type::ivec3_type, glsl_type::samplerCubeArrayShadow_type),
-
-                _textureSize(v130, glsl_type::ivec2_type, glsl_type::sampler2DRect_type),
-                _textureSize(v130, glsl_type::ivec2_type, glsl_type::isampler2DRect_type),
-                _textureSize(v130, glsl_type::ivec2_type, glsl_type::usampler2DRect_type),
-                _textureSize(v130, glsl_type::ivec2_type, glsl_type::sampler2DRectShadow_type),
-
-                _textureSize(texture_buffer, glsl_type::int_type,   glsl_type::samplerBuffer_type),
-                _textureSize(texture_buffer, glsl_type::int_type,   glsl_type::isamplerBuffer_type),
-                _textureSize(texture_buffer, glsl_type::int_type,   glsl_type::usamplerBuffer_type),
-                _textureSize(texture_multisample, glsl_type::ivec2_type, glsl_type::sampler2DMS_type),
-                _textureSize(texture_multisample, glsl_type::ivec2_type, glsl_type::isampler2DMS_type),
-                _textureSize(texture_multisample, glsl_type::ivec2_type, glsl_type::usampler2DMS_type),
-
-                _textureSize(texture_multisample_array, glsl_type::ivec3_type, glsl_type::sampler2DMSArray_type),
-                _textureSize(texture_multisample_array, glsl_type::ivec3_type, glsl_type::isampler2DMSArray_type),
-                _textureSize(texture_multisample_array, glsl_type::ivec3_type, glsl_type::usampler2DMSArray_type),
-                NULL);
-
-   add_function("textureSamples",
-                _textureSamples(glsl_type::sampler2DMS_type),
-                _textureSamples(glsl_type::isampler2DMS_type),
-                _textureSamples(glsl_type::usampler2DMS_type),
-
-                _textureSamples(glsl_type::sampler2DMSArray_type),
-                _textureSamples(glsl_type::isampler2DMSArray_type),
-                _textureSamples(glsl_type::usampler2DMSArray_type),
-                NULL);
-
-   add_function("texture",
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::float_type),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::float_type),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::float_type),
-
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec2_type),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type),
-
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec3_type),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec3_type),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec3_type),
-
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::samplerCube_type,  glsl_type::vec3_type),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isamplerCube_type, glsl_type::vec3_type),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usamplerCube_type, glsl_type::vec3_type),
-
-                _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type,   glsl_type::vec3_type),
-                _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type,   glsl_type::vec3_type),
-                _texture(ir_tex, v130, glsl_type::float_type, glsl_type::samplerCubeShadow_type, glsl_type::vec4_type),
-
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::vec2_type),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::vec2_type),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::vec2_type),
-
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::vec3_type),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type),
-
-                _texture(ir_tex, texture_cube_map_array, glsl_type::vec4_type,  glsl_type::samplerCubeArray_type,  glsl_type::vec4_type),
-                _texture(ir_tex, texture_cube_map_array, glsl_type::ivec4_type, glsl_type::isamplerCubeArray_type, glsl_type::vec4_type),
-                _texture(ir_tex, texture_cube_map_array, glsl_type::uvec4_type, glsl_type::usamplerCubeArray_type, glsl_type::vec4_type),
-
-                _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type),
-                _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DArrayShadow_type, glsl_type::vec4_type),
-                /* samplerCubeArrayShadow is special; it has an extra parameter
-                 * for the shadow comparitor since there is no vec5 type.
-                 */
-                _textureCubeArrayShadow(),
-
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec2_type),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type),
-
-                _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec3_type),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::float_type),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::float_type),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::float_type),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec2_type),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec3_type),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec3_type),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec3_type),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::samplerCube_type,  glsl_type::vec3_type),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isamplerCube_type, glsl_type::vec3_type),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usamplerCube_type, glsl_type::vec3_type),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler1DShadow_type,   glsl_type::vec3_type),
-                _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler2DShadow_type,   glsl_type::vec3_type),
-                _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::samplerCubeShadow_type, glsl_type::vec4_type),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::vec2_type),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::vec2_type),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::vec2_type),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::vec3_type),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type),
-
-                _texture(ir_txb, fs_texture_cube_map_array, glsl_type::vec4_type,  glsl_type::samplerCubeArray_type,  glsl_type::vec4_type),
-                _texture(ir_txb, fs_texture_cube_map_array, glsl_type::ivec4_type, glsl_type::isamplerCubeArray_type, glsl_type::vec4_type),
-                _texture(ir_txb, fs_texture_cube_map_array, glsl_type::uvec4_type, glsl_type::usamplerCubeArray_type, glsl_type::vec4_type),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("textureLod",
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::float_type),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::float_type),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::float_type),
-
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec2_type),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type),
-
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec3_type),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec3_type),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec3_type),
-
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::samplerCube_type,  glsl_type::vec3_type),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isamplerCube_type, glsl_type::vec3_type),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usamplerCube_type, glsl_type::vec3_type),
-
-                _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec3_type),
-                _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec3_type),
-
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::vec2_type),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::vec2_type),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::vec2_type),
-
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::vec3_type),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type),
-
-                _texture(ir_txl, texture_cube_map_array, glsl_type::vec4_type,  glsl_type::samplerCubeArray_type,  glsl_type::vec4_type),
-                _texture(ir_txl, texture_cube_map_array, glsl_type::ivec4_type, glsl_type::isamplerCubeArray_type, glsl_type::vec4_type),
-                _texture(ir_txl, texture_cube_map_array, glsl_type::uvec4_type, glsl_type::usamplerCubeArray_type, glsl_type::vec4_type),
-
-                _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("textureOffset",
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::float_type, TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::float_type, TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::float_type, TEX_OFFSET),
-
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
-
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec3_type, TEX_OFFSET),
-
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET),
-
-                _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec3_type, TEX_OFFSET),
-
-                _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec3_type, TEX_OFFSET),
-
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::vec2_type, TEX_OFFSET),
-
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
-
-                _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type, TEX_OFFSET),
-                /* The next one was forgotten in GLSL 1.30 spec. It's from
-                 * EXT_gpu_shader4 originally. It was added in 4.30 with the
-                 * wrong syntax. This was corrected in 4.40. 4.30 indicates
-                 * that it was intended to be included previously, so allow it
-                 * in 1.30.
-                 */
-                _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DArrayShadow_type, glsl_type::vec4_type, TEX_OFFSET),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::float_type, TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::float_type, TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::float_type, TEX_OFFSET),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec3_type, TEX_OFFSET),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec3_type, TEX_OFFSET),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::vec2_type, TEX_OFFSET),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type, TEX_OFFSET),
-                NULL);
-
-   add_function("textureProj",
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec2_type, TEX_PROJECT),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
-
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
-
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
-
-                _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT),
-
-                _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec2_type, TEX_PROJECT),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("texelFetch",
-                _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::int_type),
-                _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::int_type),
-                _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::int_type),
-
-                _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::ivec2_type),
-                _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::ivec2_type),
-                _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::ivec2_type),
-
-                _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::ivec3_type),
-                _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::ivec3_type),
-                _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::ivec3_type),
-
-                _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::ivec2_type),
-                _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::ivec2_type),
-                _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::ivec2_type),
-
-                _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::ivec2_type),
-                _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::ivec2_type),
-                _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::ivec2_type),
-
-                _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::ivec3_type),
-                _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::ivec3_type),
-                _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::ivec3_type),
-
-                _texelFetch(texture_buffer, glsl_type::vec4_type,  glsl_type::samplerBuffer_type,  glsl_type::int_type),
-                _texelFetch(texture_buffer, glsl_type::ivec4_type, glsl_type::isamplerBuffer_type, glsl_type::int_type),
-                _texelFetch(texture_buffer, glsl_type::uvec4_type, glsl_type::usamplerBuffer_type, glsl_type::int_type),
-
-                _texelFetch(texture_multisample, glsl_type::vec4_type,  glsl_type::sampler2DMS_type,  glsl_type::ivec2_type),
-                _texelFetch(texture_multisample, glsl_type::ivec4_type, glsl_type::isampler2DMS_type, glsl_type::ivec2_type),
-                _texelFetch(texture_multisample, glsl_type::uvec4_type, glsl_type::usampler2DMS_type, glsl_type::ivec2_type),
-
-                _texelFetch(texture_multisample_array, glsl_type::vec4_type,  glsl_type::sampler2DMSArray_type,  glsl_type::ivec3_type),
-                _texelFetch(texture_multisample_array, glsl_type::ivec4_type, glsl_type::isampler2DMSArray_type, glsl_type::ivec3_type),
-                _texelFetch(texture_multisample_array, glsl_type::uvec4_type, glsl_type::usampler2DMSArray_type, glsl_type::ivec3_type),
-                NULL);
-
-   add_function("texelFetchOffset",
-                _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::int_type, glsl_type::int_type),
-                _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::int_type, glsl_type::int_type),
-                _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::int_type, glsl_type::int_type),
-
-                _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::ivec2_type, glsl_type::ivec2_type),
-                _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::ivec2_type, glsl_type::ivec2_type),
-                _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::ivec2_type, glsl_type::ivec2_type),
-
-                _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::ivec3_type, glsl_type::ivec3_type),
-                _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::ivec3_type, glsl_type::ivec3_type),
-                _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::ivec3_type, glsl_type::ivec3_type),
-
-                _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::ivec2_type, glsl_type::ivec2_type),
-                _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::ivec2_type, glsl_type::ivec2_type),
-                _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::ivec2_type, glsl_type::ivec2_type),
-
-                _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::ivec2_type, glsl_type::int_type),
-                _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::ivec2_type, glsl_type::int_type),
-                _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::ivec2_type, glsl_type::int_type),
-
-                _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::ivec3_type, glsl_type::ivec2_type),
-                _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::ivec3_type, glsl_type::ivec2_type),
-                _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::ivec3_type, glsl_type::ivec2_type),
-
-                NULL);
-
-   add_function("textureProjOffset",
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-
-                _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-
-                _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-
-                _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                NULL);
-
-   add_function("textureLodOffset",
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::float_type, TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::float_type, TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::float_type, TEX_OFFSET),
-
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
-
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec3_type, TEX_OFFSET),
-
-                _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec3_type, TEX_OFFSET),
-
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::vec2_type, TEX_OFFSET),
-
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
-
-                _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type, TEX_OFFSET),
-                NULL);
-
-   add_function("textureProjLod",
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec2_type, TEX_PROJECT),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
-
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
-
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
-
-                _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("textureProjLodOffset",
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-
-                _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-
-                _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                NULL);
-
-   add_function("textureGrad",
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::float_type),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::float_type),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::float_type),
-
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec2_type),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type),
-
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec3_type),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec3_type),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec3_type),
-
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::samplerCube_type,  glsl_type::vec3_type),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isamplerCube_type, glsl_type::vec3_type),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usamplerCube_type, glsl_type::vec3_type),
-
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec2_type),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type),
-
-                _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec3_type),
-
-                _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type,   glsl_type::vec3_type),
-                _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type,   glsl_type::vec3_type),
-                _texture(ir_txd, v130, glsl_type::float_type, glsl_type::samplerCubeShadow_type, glsl_type::vec4_type),
-
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::vec2_type),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::vec2_type),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::vec2_type),
-
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::vec3_type),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type),
-
-                _texture(ir_txd, texture_cube_map_array, glsl_type::vec4_type,  glsl_type::samplerCubeArray_type,  glsl_type::vec4_type),
-                _texture(ir_txd, texture_cube_map_array, glsl_type::ivec4_type, glsl_type::isamplerCubeArray_type, glsl_type::vec4_type),
-                _texture(ir_txd, texture_cube_map_array, glsl_type::uvec4_type, glsl_type::usamplerCubeArray_type, glsl_type::vec4_type),
-
-                _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type),
-                _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DArrayShadow_type, glsl_type::vec4_type),
-                NULL);
-
-   add_function("textureGradOffset",
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::float_type, TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::float_type, TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::float_type, TEX_OFFSET),
-
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
-
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec3_type, TEX_OFFSET),
-
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET),
-
-                _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec3_type, TEX_OFFSET),
-
-                _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec3_type, TEX_OFFSET),
-
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::vec2_type, TEX_OFFSET),
-
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
-
-                _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DArrayShadow_type, glsl_type::vec4_type, TEX_OFFSET),
-                NULL);
-
-   add_function("textureProjGrad",
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec2_type, TEX_PROJECT),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
-
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
-
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
-
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT),
-
-                _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-
-                _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("textureProjGradOffset",
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-
-                _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-
-                _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
-                NULL);
-
-   add_function("EmitVertex",   _EmitVertex(),   NULL);
-   add_function("EndPrimitive", _EndPrimitive(), NULL);
-   add_function("EmitStreamVertex",
-                _EmitStreamVertex(gs_streams, glsl_type::uint_type),
-                _EmitStreamVertex(gs_streams, glsl_type::int_type),
-                NULL);
-   add_function("EndStreamPrimitive",
-                _EndStreamPrimitive(gs_streams, glsl_type::uint_type),
-                _EndStreamPrimitive(gs_streams, glsl_type::int_type),
-                NULL);
-   add_function("barrier", _barrier(), NULL);
-
-   add_function("textureQueryLOD",
-                _textureQueryLod(texture_query_lod, glsl_type::sampler1D_type,  glsl_type::float_type),
-                _textureQueryLod(texture_query_lod, glsl_type::isampler1D_type, glsl_type::float_type),
-                _textureQueryLod(texture_query_lod, glsl_type::usampler1D_type, glsl_type::float_type),
-
-                _textureQueryLod(texture_query_lod, glsl_type::sampler2D_type,  glsl_type::vec2_type),
-                _textureQueryLod(texture_query_lod, glsl_type::isampler2D_type, glsl_type::vec2_type),
-                _textureQueryLod(texture_query_lod, glsl_type::usampler2D_type, glsl_type::vec2_type),
-
-                _textureQueryLod(texture_query_lod, glsl_type::sampler3D_type,  glsl_type::vec3_type),
-                _textureQueryLod(texture_query_lod, glsl_type::isampler3D_type, glsl_type::vec3_type),
-                _textureQueryLod(texture_query_lod, glsl_type::usampler3D_type, glsl_type::vec3_type),
-
-                _textureQueryLod(texture_query_lod, glsl_type::samplerCube_type,  glsl_type::vec3_type),
-                _textureQueryLod(texture_query_lod, glsl_type::isamplerCube_type, glsl_type::vec3_type),
-                _textureQueryLod(texture_query_lod, glsl_type::usamplerCube_type, glsl_type::vec3_type),
-
-                _textureQueryLod(texture_query_lod, glsl_type::sampler1DArray_type,  glsl_type::float_type),
-                _textureQueryLod(texture_query_lod, glsl_type::isampler1DArray_type, glsl_type::float_type),
-                _textureQueryLod(texture_query_lod, glsl_type::usampler1DArray_type, glsl_type::float_type),
-
-                _textureQueryLod(texture_query_lod, glsl_type::sampler2DArray_type,  glsl_type::vec2_type),
-                _textureQueryLod(texture_query_lod, glsl_type::isampler2DArray_type, glsl_type::vec2_type),
-                _textureQueryLod(texture_query_lod, glsl_type::usampler2DArray_type, glsl_type::vec2_type),
-
-                _textureQueryLod(texture_query_lod, glsl_type::samplerCubeArray_type,  glsl_type::vec3_type),
-                _textureQueryLod(texture_query_lod, glsl_type::isamplerCubeArray_type, glsl_type::vec3_type),
-                _textureQueryLod(texture_query_lod, glsl_type::usamplerCubeArray_type, glsl_type::vec3_type),
-
-                _textureQueryLod(texture_query_lod, glsl_type::sampler1DShadow_type, glsl_type::float_type),
-                _textureQueryLod(texture_query_lod, glsl_type::sampler2DShadow_type, glsl_type::vec2_type),
-                _textureQueryLod(texture_query_lod, glsl_type::samplerCubeShadow_type, glsl_type::vec3_type),
-                _textureQueryLod(texture_query_lod, glsl_type::sampler1DArrayShadow_type, glsl_type::float_type),
-                _textureQueryLod(texture_query_lod, glsl_type::sampler2DArrayShadow_type, glsl_type::vec2_type),
-                _textureQueryLod(texture_query_lod, glsl_type::samplerCubeArrayShadow_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("textureQueryLod",
-                _textureQueryLod(v400_fs_only, glsl_type::sampler1D_type,  glsl_type::float_type),
-                _textureQueryLod(v400_fs_only, glsl_type::isampler1D_type, glsl_type::float_type),
-                _textureQueryLod(v400_fs_only, glsl_type::usampler1D_type, glsl_type::float_type),
-
-                _textureQueryLod(v400_fs_only, glsl_type::sampler2D_type,  glsl_type::vec2_type),
-                _textureQueryLod(v400_fs_only, glsl_type::isampler2D_type, glsl_type::vec2_type),
-                _textureQueryLod(v400_fs_only, glsl_type::usampler2D_type, glsl_type::vec2_type),
-
-                _textureQueryLod(v400_fs_only, glsl_type::sampler3D_type,  glsl_type::vec3_type),
-                _textureQueryLod(v400_fs_only, glsl_type::isampler3D_type, glsl_type::vec3_type),
-                _textureQueryLod(v400_fs_only, glsl_type::usampler3D_type, glsl_type::vec3_type),
-
-                _textureQueryLod(v400_fs_only, glsl_type::samplerCube_type,  glsl_type::vec3_type),
-                _textureQueryLod(v400_fs_only, glsl_type::isamplerCube_type, glsl_type::vec3_type),
-                _textureQueryLod(v400_fs_only, glsl_type::usamplerCube_type, glsl_type::vec3_type),
-
-                _textureQueryLod(v400_fs_only, glsl_type::sampler1DArray_type,  glsl_type::float_type),
-                _textureQueryLod(v400_fs_only, glsl_type::isampler1DArray_type, glsl_type::float_type),
-                _textureQueryLod(v400_fs_only, glsl_type::usampler1DArray_type, glsl_type::float_type),
-
-                _textureQueryLod(v400_fs_only, glsl_type::sampler2DArray_type,  glsl_type::vec2_type),
-                _textureQueryLod(v400_fs_only, glsl_type::isampler2DArray_type, glsl_type::vec2_type),
-                _textureQueryLod(v400_fs_only, glsl_type::usampler2DArray_type, glsl_type::vec2_type),
-
-                _textureQueryLod(v400_fs_only, glsl_type::samplerCubeArray_type,  glsl_type::vec3_type),
-                _textureQueryLod(v400_fs_only, glsl_type::isamplerCubeArray_type, glsl_type::vec3_type),
-                _textureQueryLod(v400_fs_only, glsl_type::usamplerCubeArray_type, glsl_type::vec3_type),
-
-                _textureQueryLod(v400_fs_only, glsl_type::sampler1DShadow_type, glsl_type::float_type),
-                _textureQueryLod(v400_fs_only, glsl_type::sampler2DShadow_type, glsl_type::vec2_type),
-                _textureQueryLod(v400_fs_only, glsl_type::samplerCubeShadow_type, glsl_type::vec3_type),
-                _textureQueryLod(v400_fs_only, glsl_type::sampler1DArrayShadow_type, glsl_type::float_type),
-                _textureQueryLod(v400_fs_only, glsl_type::sampler2DArrayShadow_type, glsl_type::vec2_type),
-                _textureQueryLod(v400_fs_only, glsl_type::samplerCubeArrayShadow_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("textureQueryLevels",
-                _textureQueryLevels(glsl_type::sampler1D_type),
-                _textureQueryLevels(glsl_type::sampler2D_type),
-                _textureQueryLevels(glsl_type::sampler3D_type),
-                _textureQueryLevels(glsl_type::samplerCube_type),
-                _textureQueryLevels(glsl_type::sampler1DArray_type),
-                _textureQueryLevels(glsl_type::sampler2DArray_type),
-                _textureQueryLevels(glsl_type::samplerCubeArray_type),
-                _textureQueryLevels(glsl_type::sampler1DShadow_type),
-                _textureQueryLevels(glsl_type::sampler2DShadow_type),
-                _textureQueryLevels(glsl_type::samplerCubeShadow_type),
-                _textureQueryLevels(glsl_type::sampler1DArrayShadow_type),
-                _textureQueryLevels(glsl_type::sampler2DArrayShadow_type),
-                _textureQueryLevels(glsl_type::samplerCubeArrayShadow_type),
-
-                _textureQueryLevels(glsl_type::isampler1D_type),
-                _textureQueryLevels(glsl_type::isampler2D_type),
-                _textureQueryLevels(glsl_type::isampler3D_type),
-                _textureQueryLevels(glsl_type::isamplerCube_type),
-                _textureQueryLevels(glsl_type::isampler1DArray_type),
-                _textureQueryLevels(glsl_type::isampler2DArray_type),
-                _textureQueryLevels(glsl_type::isamplerCubeArray_type),
-
-                _textureQueryLevels(glsl_type::usampler1D_type),
-                _textureQueryLevels(glsl_type::usampler2D_type),
-                _textureQueryLevels(glsl_type::usampler3D_type),
-                _textureQueryLevels(glsl_type::usamplerCube_type),
-                _textureQueryLevels(glsl_type::usampler1DArray_type),
-                _textureQueryLevels(glsl_type::usampler2DArray_type),
-                _textureQueryLevels(glsl_type::usamplerCubeArray_type),
-
-                NULL);
-
-   add_function("textureSamplesIdenticalEXT",
-                _textureSamplesIdentical(texture_samples_identical, glsl_type::sampler2DMS_type,  glsl_type::ivec2_type),
-                _textureSamplesIdentical(texture_samples_identical, glsl_type::isampler2DMS_type, glsl_type::ivec2_type),
-                _textureSamplesIdentical(texture_samples_identical, glsl_type::usampler2DMS_type, glsl_type::ivec2_type),
-
-                _textureSamplesIdentical(texture_samples_identical_array, glsl_type::sampler2DMSArray_type,  glsl_type::ivec3_type),
-                _textureSamplesIdentical(texture_samples_identical_array, glsl_type::isampler2DMSArray_type, glsl_type::ivec3_type),
-                _textureSamplesIdentical(texture_samples_identical_array, glsl_type::usampler2DMSArray_type, glsl_type::ivec3_type),
-                NULL);
-
-   add_function("texture1D",
-                _texture(ir_tex, v110,         glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::float_type),
-                _texture(ir_txb, v110_fs_only, glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::float_type),
-                NULL);
-
-   add_function("texture1DArray",
-                _texture(ir_tex, texture_array,    glsl_type::vec4_type, glsl_type::sampler1DArray_type, glsl_type::vec2_type),
-                _texture(ir_txb, fs_texture_array, glsl_type::vec4_type, glsl_type::sampler1DArray_type, glsl_type::vec2_type),
-                NULL);
-
-   add_function("texture1DProj",
-                _texture(ir_tex, v110,         glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
-                _texture(ir_tex, v110,         glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txb, v110_fs_only, glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
-                _texture(ir_txb, v110_fs_only, glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("texture1DLod",
-                _texture(ir_txl, tex1d_lod, glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::float_type),
-                NULL);
-
-   add_function("texture1DArrayLod",
-                _texture(ir_txl, texture_array_lod, glsl_type::vec4_type, glsl_type::sampler1DArray_type, glsl_type::vec2_type),
-                NULL);
-
-   add_function("texture1DProjLod",
-                _texture(ir_txl, tex1d_lod, glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
-                _texture(ir_txl, tex1d_lod, glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("texture2D",
-                _texture(ir_tex, always_available, glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec2_type),
-                _texture(ir_txb, fs_only,          glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec2_type),
-                _texture(ir_tex, texture_external, glsl_type::vec4_type,  glsl_type::samplerExternalOES_type, glsl_type::vec2_type),
-                NULL);
-
-   add_function("texture2DArray",
-                _texture(ir_tex, texture_array,    glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type),
-                _texture(ir_txb, fs_texture_array, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("texture2DProj",
-                _texture(ir_tex, always_available, glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_tex, always_available, glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txb, fs_only,          glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_txb, fs_only,          glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_tex, texture_external, glsl_type::vec4_type,  glsl_type::samplerExternalOES_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_tex, texture_external, glsl_type::vec4_type,  glsl_type::samplerExternalOES_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("texture2DLod",
-                _texture(ir_txl, lod_exists_in_stage, glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec2_type),
-                NULL);
-
-   add_function("texture2DArrayLod",
-                _texture(ir_txl, texture_array_lod, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("texture2DProjLod",
-                _texture(ir_txl, lod_exists_in_stage, glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_txl, lod_exists_in_stage, glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("texture3D",
-                _texture(ir_tex, tex3d,    glsl_type::vec4_type,  glsl_type::sampler3D_type, glsl_type::vec3_type),
-                _texture(ir_txb, fs_tex3d, glsl_type::vec4_type,  glsl_type::sampler3D_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("texture3DProj",
-                _texture(ir_tex, tex3d,    glsl_type::vec4_type,  glsl_type::sampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txb, fs_tex3d, glsl_type::vec4_type,  glsl_type::sampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("texture3DLod",
-                _texture(ir_txl, tex3d_lod, glsl_type::vec4_type,  glsl_type::sampler3D_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("texture3DProjLod",
-                _texture(ir_txl, tex3d_lod, glsl_type::vec4_type,  glsl_type::sampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("textureCube",
-                _texture(ir_tex, always_available, glsl_type::vec4_type,  glsl_type::samplerCube_type, glsl_type::vec3_type),
-                _texture(ir_txb, fs_only,          glsl_type::vec4_type,  glsl_type::samplerCube_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("textureCubeLod",
-                _texture(ir_txl, lod_exists_in_stage, glsl_type::vec4_type,  glsl_type::samplerCube_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("texture2DRect",
-                _texture(ir_tex, texture_rectangle, glsl_type::vec4_type,  glsl_type::sampler2DRect_type, glsl_type::vec2_type),
-                NULL);
-
-   add_function("texture2DRectProj",
-                _texture(ir_tex, texture_rectangle, glsl_type::vec4_type,  glsl_type::sampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_tex, texture_rectangle, glsl_type::vec4_type,  glsl_type::sampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("shadow1D",
-                _texture(ir_tex, v110,         glsl_type::vec4_type,  glsl_type::sampler1DShadow_type, glsl_type::vec3_type),
-                _texture(ir_txb, v110_fs_only, glsl_type::vec4_type,  glsl_type::sampler1DShadow_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("shadow1DArray",
-                _texture(ir_tex, texture_array,    glsl_type::vec4_type,  glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type),
-                _texture(ir_txb, fs_texture_array, glsl_type::vec4_type,  glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("shadow2D",
-                _texture(ir_tex, v110,         glsl_type::vec4_type,  glsl_type::sampler2DShadow_type, glsl_type::vec3_type),
-                _texture(ir_txb, v110_fs_only, glsl_type::vec4_type,  glsl_type::sampler2DShadow_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("shadow2DArray",
-                _texture(ir_tex, texture_array,    glsl_type::vec4_type,  glsl_type::sampler2DArrayShadow_type, glsl_type::vec4_type),
-                _texture(ir_txb, fs_texture_array, glsl_type::vec4_type,  glsl_type::sampler2DArrayShadow_type, glsl_type::vec4_type),
-                NULL);
-
-   add_function("shadow1DProj",
-                _texture(ir_tex, v110,         glsl_type::vec4_type,  glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txb, v110_fs_only, glsl_type::vec4_type,  glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("shadow2DProj",
-                _texture(ir_tex, v110,         glsl_type::vec4_type,  glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-                _texture(ir_txb, v110_fs_only, glsl_type::vec4_type,  glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("shadow1DLod",
-                _texture(ir_txl, v110_lod, glsl_type::vec4_type,  glsl_type::sampler1DShadow_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("shadow2DLod",
-                _texture(ir_txl, v110_lod, glsl_type::vec4_type,  glsl_type::sampler2DShadow_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("shadow1DArrayLod",
-                _texture(ir_txl, texture_array_lod, glsl_type::vec4_type, glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("shadow1DProjLod",
-                _texture(ir_txl, v110_lod, glsl_type::vec4_type,  glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("shadow2DProjLod",
-                _texture(ir_txl, v110_lod, glsl_type::vec4_type,  glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("shadow2DRect",
-                _texture(ir_tex, texture_rectangle, glsl_type::vec4_type,  glsl_type::sampler2DRectShadow_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("shadow2DRectProj",
-                _texture(ir_tex, texture_rectangle, glsl_type::vec4_type,  glsl_type::sampler2DRectShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("texture1DGradARB",
-                _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::float_type),
-                NULL);
-
-   add_function("texture1DProjGradARB",
-                _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
-                _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("texture2DGradARB",
-                _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec2_type),
-                NULL);
-
-   add_function("texture2DProjGradARB",
-                _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("texture3DGradARB",
-                _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler3D_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("texture3DProjGradARB",
-                _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("textureCubeGradARB",
-                _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::samplerCube_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("shadow1DGradARB",
-                _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler1DShadow_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("shadow1DProjGradARB",
-                _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("shadow2DGradARB",
-                _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler2DShadow_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("shadow2DProjGradARB",
-                _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("texture2DRectGradARB",
-                _texture(ir_txd, shader_texture_lod_and_rect, glsl_type::vec4_type,  glsl_type::sampler2DRect_type, glsl_type::vec2_type),
-                NULL);
-
-   add_function("texture2DRectProjGradARB",
-                _texture(ir_txd, shader_texture_lod_and_rect, glsl_type::vec4_type,  glsl_type::sampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT),
-                _texture(ir_txd, shader_texture_lod_and_rect, glsl_type::vec4_type,  glsl_type::sampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("shadow2DRectGradARB",
-                _texture(ir_txd, shader_texture_lod_and_rect, glsl_type::vec4_type,  glsl_type::sampler2DRectShadow_type, glsl_type::vec3_type),
-                NULL);
-
-   add_function("shadow2DRectProjGradARB",
-                _texture(ir_txd, shader_texture_lod_and_rect, glsl_type::vec4_type,  glsl_type::sampler2DRectShadow_type, glsl_type::vec4_type, TEX_PROJECT),
-                NULL);
-
-   add_function("textureGather",
-                _texture(ir_tg4, texture_gather_or_es31, glsl_type::vec4_type, glsl_type::sampler2D_type, glsl_type::vec2_type),
-                _texture(ir_tg4, texture_gather_or_es31, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type),
-                _texture(ir_tg4, texture_gather_or_es31, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type),
-
-                _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::sampler2DRect_type, glsl_type::vec2_type),
-                _texture(ir_tg4, gpu_shader5, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type),
-                _texture(ir_tg4, gpu_shader5, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type),
-
-                _texture(ir_tg4, texture_gather_or_es31, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type),
-                _texture(ir_tg4, texture_gather_or_es31, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type),
-                _texture(ir_tg4, texture_gather_or_es31, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type),
-
-                _texture(ir_tg4, texture_gather_or_es31, glsl_type::vec4_type, glsl_type::samplerCube_type, glsl_type::vec3_type),
-                _texture(ir_tg4, texture_gather_or_es31, glsl_type::ivec4_type, glsl_type::isamplerCube_type, glsl_type::vec3_type),
-                _texture(ir_tg4, texture_gather_or_es31, glsl_type::uvec4_type, glsl_type::usamplerCube_type, glsl_type::vec3_type),
-
-                _texture(ir_tg4, texture_gather, glsl_type::vec4_type, glsl_type::samplerCubeArray_type, glsl_type::vec4_type),
-                _texture(ir_tg4, texture_gather, glsl_type::ivec4_type, glsl_type::isamplerCubeArray_type, glsl_type::vec4_type),
-                _texture(ir_tg4, texture_gather, glsl_type::uvec4_type, glsl_type::usamplerCubeArray_type, glsl_type::vec4_type),
-
-                _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::vec4_type, glsl_type::sampler2D_type, glsl_type::vec2_type, TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_COMPONENT),
-
-                _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::sampler2DRect_type, glsl_type::vec2_type, TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type, TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type, TEX_COMPONENT),
-
-                _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type, TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_COMPONENT),
-
-                _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::vec4_type, glsl_type::samplerCube_type, glsl_type::vec3_type, TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::ivec4_type, glsl_type::isamplerCube_type, glsl_type::vec3_type, TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::uvec4_type, glsl_type::usamplerCube_type, glsl_type::vec3_type, TEX_COMPONENT),
-
-                _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::samplerCubeArray_type, glsl_type::vec4_type, TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5, glsl_type::ivec4_type, glsl_type::isamplerCubeArray_type, glsl_type::vec4_type, TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5, glsl_type::uvec4_type, glsl_type::usamplerCubeArray_type, glsl_type::vec4_type, TEX_COMPONENT),
-
-                _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::vec4_type, glsl_type::sampler2DShadow_type, glsl_type::vec2_type),
-                _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::vec4_type, glsl_type::sampler2DArrayShadow_type, glsl_type::vec3_type),
-                _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::vec4_type, glsl_type::samplerCubeShadow_type, glsl_type::vec3_type),
-                _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::samplerCubeArrayShadow_type, glsl_type::vec4_type),
-                _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec2_type),
-                NULL);
-
-   add_function("textureGatherOffset",
-                _texture(ir_tg4, texture_gather_only_or_es31, glsl_type::vec4_type, glsl_type::sampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_tg4, texture_gather_only_or_es31, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_tg4, texture_gather_only_or_es31, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
-
-                _texture(ir_tg4, texture_gather_only_or_es31, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_tg4, texture_gather_only_or_es31, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
-                _texture(ir_tg4, texture_gather_only_or_es31, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
-
-                _texture(ir_tg4, es31_not_gs5, glsl_type::vec4_type, glsl_type::sampler2D_type, glsl_type::vec2_type, TEX_OFFSET | TEX_COMPONENT),
-                _texture(ir_tg4, es31_not_gs5, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET | TEX_COMPONENT),
-                _texture(ir_tg4, es31_not_gs5, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET | TEX_COMPONENT),
-
-                _texture(ir_tg4, es31_not_gs5, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET | TEX_COMPONENT),
-                _texture(ir_tg4, es31_not_gs5, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET | TEX_COMPONENT),
-                _texture(ir_tg4, es31_not_gs5, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET | TEX_COMPONENT),
-
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2D_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST),
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST),
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST),
-
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_NONCONST),
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_NONCONST),
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_NONCONST),
-
-                _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::sampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST),
-                _texture(ir_tg4, gpu_shader5, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST),
-                _texture(ir_tg4, gpu_shader5, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST),
-
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2D_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST | TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST | TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST | TEX_COMPONENT),
-
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_NONCONST | TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_NONCONST | TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_NONCONST | TEX_COMPONENT),
-
-                _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::sampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST | TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST | TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST | TEX_COMPONENT),
-
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2DShadow_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST),
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2DArrayShadow_type, glsl_type::vec3_type, TEX_OFFSET_NONCONST),
-                _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST),
-
-                _texture(ir_tg4, es31_not_gs5, glsl_type::vec4_type, glsl_type::sampler2DShadow_type, glsl_type::vec2_type, TEX_OFFSET),
-                _texture(ir_tg4, es31_not_gs5, glsl_type::vec4_type, glsl_type::sampler2DArrayShadow_type, glsl_type::vec3_type, TEX_OFFSET),
-                NULL);
-
-   add_function("textureGatherOffsets",
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2D_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY),
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY),
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY),
-
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2D_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY | TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY | TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY | TEX_COMPONENT),
-
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_ARRAY),
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_ARRAY),
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_ARRAY),
-
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_ARRAY | TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_ARRAY | TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_ARRAY | TEX_COMPONENT),
-
-                _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::sampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY),
-                _texture(ir_tg4, gpu_shader5, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY),
-                _texture(ir_tg4, gpu_shader5, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY),
-
-                _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::sampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY | TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY | TEX_COMPONENT),
-                _texture(ir_tg4, gpu_shader5, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY | TEX_COMPONENT),
-
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2DShadow_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY),
-                _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2DArrayShadow_type, glsl_type::vec3_type, TEX_OFFSET_ARRAY),
-                _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY),
-                NULL);
+   if (wants_function("any"))
+      add_function("any",
+                   _any(glsl_type::bvec2_type),
+                   _any(glsl_type::bvec3_type),
+                   _any(glsl_type::bvec4_type),
+                   NULL);
+
+   if (wants_function("all"))
+      add_function("all",
+                   _all(glsl_type::bvec2_type),
+                   _all(glsl_type::bvec3_type),
+                   _all(glsl_type::bvec4_type),
+                   NULL);
+
+   if (wants_function("not"))
+      add_function("not",
+                   _not(glsl_type::bvec2_type),
+                   _not(glsl_type::bvec3_type),
+                   _not(glsl_type::bvec4_type),
+                   NULL);
+
+   if (wants_function("textureSize"))
+      add_function("textureSize",
+                   _textureSize(v130, glsl_type::int_type,   glsl_type::sampler1D_type),
+                   _textureSize(v130, glsl_type::int_type,   glsl_type::isampler1D_type),
+                   _textureSize(v130, glsl_type::int_type,   glsl_type::usampler1D_type),
+
+                   _textureSize(v130, glsl_type::ivec2_type, glsl_type::sampler2D_type),
+                   _textureSize(v130, glsl_type::ivec2_type, glsl_type::isampler2D_type),
+                   _textureSize(v130, glsl_type::ivec2_type, glsl_type::usampler2D_type),
+
+                   _textureSize(v130, glsl_type::ivec3_type, glsl_type::sampler3D_type),
+                   _textureSize(v130, glsl_type::ivec3_type, glsl_type::isampler3D_type),
+                   _textureSize(v130, glsl_type::ivec3_type, glsl_type::usampler3D_type),
+
+                   _textureSize(v130, glsl_type::ivec2_type, glsl_type::samplerCube_type),
+                   _textureSize(v130, glsl_type::ivec2_type, glsl_type::isamplerCube_type),
+                   _textureSize(v130, glsl_type::ivec2_type, glsl_type::usamplerCube_type),
+
+                   _textureSize(v130, glsl_type::int_type,   glsl_type::sampler1DShadow_type),
+                   _textureSize(v130, glsl_type::ivec2_type, glsl_type::sampler2DShadow_type),
+                   _textureSize(v130, glsl_type::ivec2_type, glsl_type::samplerCubeShadow_type),
+
+                   _textureSize(v130, glsl_type::ivec2_type, glsl_type::sampler1DArray_type),
+                   _textureSize(v130, glsl_type::ivec2_type, glsl_type::isampler1DArray_type),
+                   _textureSize(v130, glsl_type::ivec2_type, glsl_type::usampler1DArray_type),
+                   _textureSize(v130, glsl_type::ivec3_type, glsl_type::sampler2DArray_type),
+                   _textureSize(v130, glsl_type::ivec3_type, glsl_type::isampler2DArray_type),
+                   _textureSize(v130, glsl_type::ivec3_type, glsl_type::usampler2DArray_type),
+
+                   _textureSize(v130, glsl_type::ivec2_type, glsl_type::sampler1DArrayShadow_type),
+                   _textureSize(v130, glsl_type::ivec3_type, glsl_type::sampler2DArrayShadow_type),
+
+                   _textureSize(texture_cube_map_array, glsl_type::ivec3_type, glsl_type::samplerCubeArray_type),
+                   _textureSize(texture_cube_map_array, glsl_type::ivec3_type, glsl_type::isamplerCubeArray_type),
+                   _textureSize(texture_cube_map_array, glsl_type::ivec3_type, glsl_type::usamplerCubeArray_type),
+                   _textureSize(texture_cube_map_array, glsl_type::ivec3_type, glsl_type::samplerCubeArrayShadow_type),
+
+                   _textureSize(v130, glsl_type::ivec2_type, glsl_type::sampler2DRect_type),
+                   _textureSize(v130, glsl_type::ivec2_type, glsl_type::isampler2DRect_type),
+                   _textureSize(v130, glsl_type::ivec2_type, glsl_type::usampler2DRect_type),
+                   _textureSize(v130, glsl_type::ivec2_type, glsl_type::sampler2DRectShadow_type),
+
+                   _textureSize(texture_buffer, glsl_type::int_type,   glsl_type::samplerBuffer_type),
+                   _textureSize(texture_buffer, glsl_type::int_type,   glsl_type::isamplerBuffer_type),
+                   _textureSize(texture_buffer, glsl_type::int_type,   glsl_type::usamplerBuffer_type),
+                   _textureSize(texture_multisample, glsl_type::ivec2_type, glsl_type::sampler2DMS_type),
+                   _textureSize(texture_multisample, glsl_type::ivec2_type, glsl_type::isampler2DMS_type),
+                   _textureSize(texture_multisample, glsl_type::ivec2_type, glsl_type::usampler2DMS_type),
+
+                   _textureSize(texture_multisample_array, glsl_type::ivec3_type, glsl_type::sampler2DMSArray_type),
+                   _textureSize(texture_multisample_array, glsl_type::ivec3_type, glsl_type::isampler2DMSArray_type),
+                   _textureSize(texture_multisample_array, glsl_type::ivec3_type, glsl_type::usampler2DMSArray_type),
+                   NULL);
+
+   if (wants_function("textureSamples"))
+      add_function("textureSamples",
+                   _textureSamples(glsl_type::sampler2DMS_type),
+                   _textureSamples(glsl_type::isampler2DMS_type),
+                   _textureSamples(glsl_type::usampler2DMS_type),
+
+                   _textureSamples(glsl_type::sampler2DMSArray_type),
+                   _textureSamples(glsl_type::isampler2DMSArray_type),
+                   _textureSamples(glsl_type::usampler2DMSArray_type),
+                   NULL);
+
+   if (wants_function("texture"))
+      add_function("texture",
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::float_type),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::float_type),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::float_type),
+
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec2_type),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type),
+
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec3_type),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec3_type),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec3_type),
+
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::samplerCube_type,  glsl_type::vec3_type),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isamplerCube_type, glsl_type::vec3_type),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usamplerCube_type, glsl_type::vec3_type),
+
+                   _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type,   glsl_type::vec3_type),
+                   _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type,   glsl_type::vec3_type),
+                   _texture(ir_tex, v130, glsl_type::float_type, glsl_type::samplerCubeShadow_type, glsl_type::vec4_type),
+
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::vec2_type),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::vec2_type),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::vec2_type),
+
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::vec3_type),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type),
+
+                   _texture(ir_tex, texture_cube_map_array, glsl_type::vec4_type,  glsl_type::samplerCubeArray_type,  glsl_type::vec4_type),
+                   _texture(ir_tex, texture_cube_map_array, glsl_type::ivec4_type, glsl_type::isamplerCubeArray_type, glsl_type::vec4_type),
+                   _texture(ir_tex, texture_cube_map_array, glsl_type::uvec4_type, glsl_type::usamplerCubeArray_type, glsl_type::vec4_type),
+
+                   _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type),
+                   _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DArrayShadow_type, glsl_type::vec4_type),
+                   /* samplerCubeArrayShadow is special; it has an extra parameter
+                    * for the shadow comparitor since there is no vec5 type.
+                    */
+                   _textureCubeArrayShadow(),
+
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec2_type),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type),
+
+                   _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec3_type),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::float_type),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::float_type),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::float_type),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec2_type),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec3_type),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec3_type),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec3_type),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::samplerCube_type,  glsl_type::vec3_type),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isamplerCube_type, glsl_type::vec3_type),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usamplerCube_type, glsl_type::vec3_type),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler1DShadow_type,   glsl_type::vec3_type),
+                   _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler2DShadow_type,   glsl_type::vec3_type),
+                   _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::samplerCubeShadow_type, glsl_type::vec4_type),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::vec2_type),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::vec2_type),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::vec2_type),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::vec3_type),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type),
+
+                   _texture(ir_txb, fs_texture_cube_map_array, glsl_type::vec4_type,  glsl_type::samplerCubeArray_type,  glsl_type::vec4_type),
+                   _texture(ir_txb, fs_texture_cube_map_array, glsl_type::ivec4_type, glsl_type::isamplerCubeArray_type, glsl_type::vec4_type),
+                   _texture(ir_txb, fs_texture_cube_map_array, glsl_type::uvec4_type, glsl_type::usamplerCubeArray_type, glsl_type::vec4_type),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("textureLod"))
+      add_function("textureLod",
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::float_type),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::float_type),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::float_type),
+
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec2_type),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type),
+
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec3_type),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec3_type),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec3_type),
+
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::samplerCube_type,  glsl_type::vec3_type),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isamplerCube_type, glsl_type::vec3_type),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usamplerCube_type, glsl_type::vec3_type),
+
+                   _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec3_type),
+                   _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec3_type),
+
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::vec2_type),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::vec2_type),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::vec2_type),
+
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::vec3_type),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type),
+
+                   _texture(ir_txl, texture_cube_map_array, glsl_type::vec4_type,  glsl_type::samplerCubeArray_type,  glsl_type::vec4_type),
+                   _texture(ir_txl, texture_cube_map_array, glsl_type::ivec4_type, glsl_type::isamplerCubeArray_type, glsl_type::vec4_type),
+                   _texture(ir_txl, texture_cube_map_array, glsl_type::uvec4_type, glsl_type::usamplerCubeArray_type, glsl_type::vec4_type),
+
+                   _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("textureOffset"))
+      add_function("textureOffset",
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::float_type, TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::float_type, TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::float_type, TEX_OFFSET),
+
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
+
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec3_type, TEX_OFFSET),
+
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET),
+
+                   _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec3_type, TEX_OFFSET),
+
+                   _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec3_type, TEX_OFFSET),
+
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::vec2_type, TEX_OFFSET),
+
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
+
+                   _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type, TEX_OFFSET),
+                   /* The next one was forgotten in GLSL 1.30 spec. It's from
+                    * EXT_gpu_shader4 originally. It was added in 4.30 with the
+                    * wrong syntax. This was corrected in 4.40. 4.30 indicates
+                    * that it was intended to be included previously, so allow it
+                    * in 1.30.
+                    */
+                   _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DArrayShadow_type, glsl_type::vec4_type, TEX_OFFSET),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::float_type, TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::float_type, TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::float_type, TEX_OFFSET),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec3_type, TEX_OFFSET),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec3_type, TEX_OFFSET),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::vec2_type, TEX_OFFSET),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type, TEX_OFFSET),
+                   NULL);
+
+   if (wants_function("textureProj"))
+      add_function("textureProj",
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec2_type, TEX_PROJECT),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
+
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
+
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
+
+                   _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT),
+
+                   _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec2_type, TEX_PROJECT),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("texelFetch"))
+      add_function("texelFetch",
+                   _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::int_type),
+                   _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::int_type),
+                   _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::int_type),
+
+                   _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::ivec2_type),
+                   _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::ivec2_type),
+                   _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::ivec2_type),
+
+                   _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::ivec3_type),
+                   _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::ivec3_type),
+                   _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::ivec3_type),
+
+                   _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::ivec2_type),
+                   _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::ivec2_type),
+                   _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::ivec2_type),
+
+                   _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::ivec2_type),
+                   _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::ivec2_type),
+                   _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::ivec2_type),
+
+                   _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::ivec3_type),
+                   _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::ivec3_type),
+                   _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::ivec3_type),
+
+                   _texelFetch(texture_buffer, glsl_type::vec4_type,  glsl_type::samplerBuffer_type,  glsl_type::int_type),
+                   _texelFetch(texture_buffer, glsl_type::ivec4_type, glsl_type::isamplerBuffer_type, glsl_type::int_type),
+                   _texelFetch(texture_buffer, glsl_type::uvec4_type, glsl_type::usamplerBuffer_type, glsl_type::int_type),
+
+                   _texelFetch(texture_multisample, glsl_type::vec4_type,  glsl_type::sampler2DMS_type,  glsl_type::ivec2_type),
+                   _texelFetch(texture_multisample, glsl_type::ivec4_type, glsl_type::isampler2DMS_type, glsl_type::ivec2_type),
+                   _texelFetch(texture_multisample, glsl_type::uvec4_type, glsl_type::usampler2DMS_type, glsl_type::ivec2_type),
+
+                   _texelFetch(texture_multisample_array, glsl_type::vec4_type,  glsl_type::sampler2DMSArray_type,  glsl_type::ivec3_type),
+                   _texelFetch(texture_multisample_array, glsl_type::ivec4_type, glsl_type::isampler2DMSArray_type, glsl_type::ivec3_type),
+                   _texelFetch(texture_multisample_array, glsl_type::uvec4_type, glsl_type::usampler2DMSArray_type, glsl_type::ivec3_type),
+                   NULL);
+
+   if (wants_function("texelFetchOffset"))
+      add_function("texelFetchOffset",
+                   _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::int_type, glsl_type::int_type),
+                   _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::int_type, glsl_type::int_type),
+                   _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::int_type, glsl_type::int_type),
+
+                   _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::ivec2_type, glsl_type::ivec2_type),
+                   _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::ivec2_type, glsl_type::ivec2_type),
+                   _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::ivec2_type, glsl_type::ivec2_type),
+
+                   _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::ivec3_type, glsl_type::ivec3_type),
+                   _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::ivec3_type, glsl_type::ivec3_type),
+                   _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::ivec3_type, glsl_type::ivec3_type),
+
+                   _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::ivec2_type, glsl_type::ivec2_type),
+                   _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::ivec2_type, glsl_type::ivec2_type),
+                   _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::ivec2_type, glsl_type::ivec2_type),
+
+                   _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::ivec2_type, glsl_type::int_type),
+                   _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::ivec2_type, glsl_type::int_type),
+                   _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::ivec2_type, glsl_type::int_type),
+
+                   _texelFetch(v130, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::ivec3_type, glsl_type::ivec2_type),
+                   _texelFetch(v130, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::ivec3_type, glsl_type::ivec2_type),
+                   _texelFetch(v130, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::ivec3_type, glsl_type::ivec2_type),
+
+                   NULL);
+
+   if (wants_function("textureProjOffset"))
+      add_function("textureProjOffset",
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+
+                   _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_tex, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+
+                   _texture(ir_tex, v130, glsl_type::float_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+
+                   _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txb, v130_fs_only, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   NULL);
+
+   if (wants_function("textureLodOffset"))
+      add_function("textureLodOffset",
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::float_type, TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::float_type, TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::float_type, TEX_OFFSET),
+
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
+
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec3_type, TEX_OFFSET),
+
+                   _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec3_type, TEX_OFFSET),
+
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::vec2_type, TEX_OFFSET),
+
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
+
+                   _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type, TEX_OFFSET),
+                   NULL);
+
+   if (wants_function("textureProjLod"))
+      add_function("textureProjLod",
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec2_type, TEX_PROJECT),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
+
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
+
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
+
+                   _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("textureProjLodOffset"))
+      add_function("textureProjLodOffset",
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+
+                   _texture(ir_txl, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+
+                   _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txl, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   NULL);
+
+   if (wants_function("textureGrad"))
+      add_function("textureGrad",
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::float_type),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::float_type),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::float_type),
+
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec2_type),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type),
+
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec3_type),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec3_type),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec3_type),
+
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::samplerCube_type,  glsl_type::vec3_type),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isamplerCube_type, glsl_type::vec3_type),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usamplerCube_type, glsl_type::vec3_type),
+
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec2_type),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type),
+
+                   _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec3_type),
+
+                   _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type,   glsl_type::vec3_type),
+                   _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type,   glsl_type::vec3_type),
+                   _texture(ir_txd, v130, glsl_type::float_type, glsl_type::samplerCubeShadow_type, glsl_type::vec4_type),
+
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::vec2_type),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::vec2_type),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::vec2_type),
+
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::vec3_type),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type),
+
+                   _texture(ir_txd, texture_cube_map_array, glsl_type::vec4_type,  glsl_type::samplerCubeArray_type,  glsl_type::vec4_type),
+                   _texture(ir_txd, texture_cube_map_array, glsl_type::ivec4_type, glsl_type::isamplerCubeArray_type, glsl_type::vec4_type),
+                   _texture(ir_txd, texture_cube_map_array, glsl_type::uvec4_type, glsl_type::usamplerCubeArray_type, glsl_type::vec4_type),
+
+                   _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type),
+                   _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DArrayShadow_type, glsl_type::vec4_type),
+                   NULL);
+
+   if (wants_function("textureGradOffset"))
+      add_function("textureGradOffset",
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::float_type, TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::float_type, TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::float_type, TEX_OFFSET),
+
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
+
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec3_type, TEX_OFFSET),
+
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET),
+
+                   _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec3_type, TEX_OFFSET),
+
+                   _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec3_type, TEX_OFFSET),
+
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler1DArray_type,  glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler1DArray_type, glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler1DArray_type, glsl_type::vec2_type, TEX_OFFSET),
+
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2DArray_type,  glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
+
+                   _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DArrayShadow_type, glsl_type::vec4_type, TEX_OFFSET),
+                   NULL);
+
+   if (wants_function("textureProjGrad"))
+      add_function("textureProjGrad",
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec2_type, TEX_PROJECT),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
+
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
+
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
+
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT),
+
+                   _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+
+                   _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("textureProjGradOffset"))
+      add_function("textureProjGradOffset",
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec2_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler1D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler1D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler1D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler3D_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler3D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler3D_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::vec4_type,  glsl_type::sampler2DRect_type,  glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+
+                   _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+
+                   _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   _texture(ir_txd, v130, glsl_type::float_type, glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT | TEX_OFFSET),
+                   NULL);
+
+   if (wants_function("EmitVertex"))
+      add_function("EmitVertex",   _EmitVertex(),   NULL);
+   if (wants_function("EndPrimitive"))
+      add_function("EndPrimitive", _EndPrimitive(), NULL);
+   if (wants_function("EmitStreamVertex"))
+      add_function("EmitStreamVertex",
+                   _EmitStreamVertex(gs_streams, glsl_type::uint_type),
+                   _EmitStreamVertex(gs_streams, glsl_type::int_type),
+                   NULL);
+   if (wants_function("EndStreamPrimitive"))
+      add_function("EndStreamPrimitive",
+                   _EndStreamPrimitive(gs_streams, glsl_type::uint_type),
+                   _EndStreamPrimitive(gs_streams, glsl_type::int_type),
+                   NULL);
+   if (wants_function("barrier"))
+      add_function("barrier", _barrier(), NULL);
+
+   if (wants_function("textureQueryLOD"))
+      add_function("textureQueryLOD",
+                   _textureQueryLod(texture_query_lod, glsl_type::sampler1D_type,  glsl_type::float_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::isampler1D_type, glsl_type::float_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::usampler1D_type, glsl_type::float_type),
+
+                   _textureQueryLod(texture_query_lod, glsl_type::sampler2D_type,  glsl_type::vec2_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::isampler2D_type, glsl_type::vec2_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::usampler2D_type, glsl_type::vec2_type),
+
+                   _textureQueryLod(texture_query_lod, glsl_type::sampler3D_type,  glsl_type::vec3_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::isampler3D_type, glsl_type::vec3_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::usampler3D_type, glsl_type::vec3_type),
+
+                   _textureQueryLod(texture_query_lod, glsl_type::samplerCube_type,  glsl_type::vec3_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::isamplerCube_type, glsl_type::vec3_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::usamplerCube_type, glsl_type::vec3_type),
+
+                   _textureQueryLod(texture_query_lod, glsl_type::sampler1DArray_type,  glsl_type::float_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::isampler1DArray_type, glsl_type::float_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::usampler1DArray_type, glsl_type::float_type),
+
+                   _textureQueryLod(texture_query_lod, glsl_type::sampler2DArray_type,  glsl_type::vec2_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::isampler2DArray_type, glsl_type::vec2_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::usampler2DArray_type, glsl_type::vec2_type),
+
+                   _textureQueryLod(texture_query_lod, glsl_type::samplerCubeArray_type,  glsl_type::vec3_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::isamplerCubeArray_type, glsl_type::vec3_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::usamplerCubeArray_type, glsl_type::vec3_type),
+
+                   _textureQueryLod(texture_query_lod, glsl_type::sampler1DShadow_type, glsl_type::float_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::sampler2DShadow_type, glsl_type::vec2_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::samplerCubeShadow_type, glsl_type::vec3_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::sampler1DArrayShadow_type, glsl_type::float_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::sampler2DArrayShadow_type, glsl_type::vec2_type),
+                   _textureQueryLod(texture_query_lod, glsl_type::samplerCubeArrayShadow_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("textureQueryLod"))
+      add_function("textureQueryLod",
+                   _textureQueryLod(v400_fs_only, glsl_type::sampler1D_type,  glsl_type::float_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::isampler1D_type, glsl_type::float_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::usampler1D_type, glsl_type::float_type),
+
+                   _textureQueryLod(v400_fs_only, glsl_type::sampler2D_type,  glsl_type::vec2_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::isampler2D_type, glsl_type::vec2_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::usampler2D_type, glsl_type::vec2_type),
+
+                   _textureQueryLod(v400_fs_only, glsl_type::sampler3D_type,  glsl_type::vec3_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::isampler3D_type, glsl_type::vec3_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::usampler3D_type, glsl_type::vec3_type),
+
+                   _textureQueryLod(v400_fs_only, glsl_type::samplerCube_type,  glsl_type::vec3_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::isamplerCube_type, glsl_type::vec3_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::usamplerCube_type, glsl_type::vec3_type),
+
+                   _textureQueryLod(v400_fs_only, glsl_type::sampler1DArray_type,  glsl_type::float_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::isampler1DArray_type, glsl_type::float_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::usampler1DArray_type, glsl_type::float_type),
+
+                   _textureQueryLod(v400_fs_only, glsl_type::sampler2DArray_type,  glsl_type::vec2_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::isampler2DArray_type, glsl_type::vec2_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::usampler2DArray_type, glsl_type::vec2_type),
+
+                   _textureQueryLod(v400_fs_only, glsl_type::samplerCubeArray_type,  glsl_type::vec3_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::isamplerCubeArray_type, glsl_type::vec3_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::usamplerCubeArray_type, glsl_type::vec3_type),
+
+                   _textureQueryLod(v400_fs_only, glsl_type::sampler1DShadow_type, glsl_type::float_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::sampler2DShadow_type, glsl_type::vec2_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::samplerCubeShadow_type, glsl_type::vec3_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::sampler1DArrayShadow_type, glsl_type::float_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::sampler2DArrayShadow_type, glsl_type::vec2_type),
+                   _textureQueryLod(v400_fs_only, glsl_type::samplerCubeArrayShadow_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("textureQueryLevels"))
+      add_function("textureQueryLevels",
+                   _textureQueryLevels(glsl_type::sampler1D_type),
+                   _textureQueryLevels(glsl_type::sampler2D_type),
+                   _textureQueryLevels(glsl_type::sampler3D_type),
+                   _textureQueryLevels(glsl_type::samplerCube_type),
+                   _textureQueryLevels(glsl_type::sampler1DArray_type),
+                   _textureQueryLevels(glsl_type::sampler2DArray_type),
+                   _textureQueryLevels(glsl_type::samplerCubeArray_type),
+                   _textureQueryLevels(glsl_type::sampler1DShadow_type),
+                   _textureQueryLevels(glsl_type::sampler2DShadow_type),
+                   _textureQueryLevels(glsl_type::samplerCubeShadow_type),
+                   _textureQueryLevels(glsl_type::sampler1DArrayShadow_type),
+                   _textureQueryLevels(glsl_type::sampler2DArrayShadow_type),
+                   _textureQueryLevels(glsl_type::samplerCubeArrayShadow_type),
+
+                   _textureQueryLevels(glsl_type::isampler1D_type),
+                   _textureQueryLevels(glsl_type::isampler2D_type),
+                   _textureQueryLevels(glsl_type::isampler3D_type),
+                   _textureQueryLevels(glsl_type::isamplerCube_type),
+                   _textureQueryLevels(glsl_type::isampler1DArray_type),
+                   _textureQueryLevels(glsl_type::isampler2DArray_type),
+                   _textureQueryLevels(glsl_type::isamplerCubeArray_type),
+
+                   _textureQueryLevels(glsl_type::usampler1D_type),
+                   _textureQueryLevels(glsl_type::usampler2D_type),
+                   _textureQueryLevels(glsl_type::usampler3D_type),
+                   _textureQueryLevels(glsl_type::usamplerCube_type),
+                   _textureQueryLevels(glsl_type::usampler1DArray_type),
+                   _textureQueryLevels(glsl_type::usampler2DArray_type),
+                   _textureQueryLevels(glsl_type::usamplerCubeArray_type),
+
+                   NULL);
+
+   if (wants_function("textureSamplesIdenticalEXT"))
+      add_function("textureSamplesIdenticalEXT",
+                   _textureSamplesIdentical(texture_samples_identical, glsl_type::sampler2DMS_type,  glsl_type::ivec2_type),
+                   _textureSamplesIdentical(texture_samples_identical, glsl_type::isampler2DMS_type, glsl_type::ivec2_type),
+                   _textureSamplesIdentical(texture_samples_identical, glsl_type::usampler2DMS_type, glsl_type::ivec2_type),
+
+                   _textureSamplesIdentical(texture_samples_identical_array, glsl_type::sampler2DMSArray_type,  glsl_type::ivec3_type),
+                   _textureSamplesIdentical(texture_samples_identical_array, glsl_type::isampler2DMSArray_type, glsl_type::ivec3_type),
+                   _textureSamplesIdentical(texture_samples_identical_array, glsl_type::usampler2DMSArray_type, glsl_type::ivec3_type),
+                   NULL);
+
+   if (wants_function("texture1D"))
+      add_function("texture1D",
+                   _texture(ir_tex, v110,         glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::float_type),
+                   _texture(ir_txb, v110_fs_only, glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::float_type),
+                   NULL);
+
+   if (wants_function("texture1DArray"))
+      add_function("texture1DArray",
+                   _texture(ir_tex, texture_array,    glsl_type::vec4_type, glsl_type::sampler1DArray_type, glsl_type::vec2_type),
+                   _texture(ir_txb, fs_texture_array, glsl_type::vec4_type, glsl_type::sampler1DArray_type, glsl_type::vec2_type),
+                   NULL);
+
+   if (wants_function("texture1DProj"))
+      add_function("texture1DProj",
+                   _texture(ir_tex, v110,         glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
+                   _texture(ir_tex, v110,         glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txb, v110_fs_only, glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
+                   _texture(ir_txb, v110_fs_only, glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("texture1DLod"))
+      add_function("texture1DLod",
+                   _texture(ir_txl, tex1d_lod, glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::float_type),
+                   NULL);
+
+   if (wants_function("texture1DArrayLod"))
+      add_function("texture1DArrayLod",
+                   _texture(ir_txl, texture_array_lod, glsl_type::vec4_type, glsl_type::sampler1DArray_type, glsl_type::vec2_type),
+                   NULL);
+
+   if (wants_function("texture1DProjLod"))
+      add_function("texture1DProjLod",
+                   _texture(ir_txl, tex1d_lod, glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
+                   _texture(ir_txl, tex1d_lod, glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("texture2D"))
+      add_function("texture2D",
+                   _texture(ir_tex, always_available, glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec2_type),
+                   _texture(ir_txb, fs_only,          glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec2_type),
+                   _texture(ir_tex, texture_external, glsl_type::vec4_type,  glsl_type::samplerExternalOES_type, glsl_type::vec2_type),
+                   NULL);
+
+   if (wants_function("texture2DArray"))
+      add_function("texture2DArray",
+                   _texture(ir_tex, texture_array,    glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type),
+                   _texture(ir_txb, fs_texture_array, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("texture2DProj"))
+      add_function("texture2DProj",
+                   _texture(ir_tex, always_available, glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_tex, always_available, glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txb, fs_only,          glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_txb, fs_only,          glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_tex, texture_external, glsl_type::vec4_type,  glsl_type::samplerExternalOES_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_tex, texture_external, glsl_type::vec4_type,  glsl_type::samplerExternalOES_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("texture2DLod"))
+      add_function("texture2DLod",
+                   _texture(ir_txl, lod_exists_in_stage, glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec2_type),
+                   NULL);
+
+   if (wants_function("texture2DArrayLod"))
+      add_function("texture2DArrayLod",
+                   _texture(ir_txl, texture_array_lod, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("texture2DProjLod"))
+      add_function("texture2DProjLod",
+                   _texture(ir_txl, lod_exists_in_stage, glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_txl, lod_exists_in_stage, glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("texture3D"))
+      add_function("texture3D",
+                   _texture(ir_tex, tex3d,    glsl_type::vec4_type,  glsl_type::sampler3D_type, glsl_type::vec3_type),
+                   _texture(ir_txb, fs_tex3d, glsl_type::vec4_type,  glsl_type::sampler3D_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("texture3DProj"))
+      add_function("texture3DProj",
+                   _texture(ir_tex, tex3d,    glsl_type::vec4_type,  glsl_type::sampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txb, fs_tex3d, glsl_type::vec4_type,  glsl_type::sampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("texture3DLod"))
+      add_function("texture3DLod",
+                   _texture(ir_txl, tex3d_lod, glsl_type::vec4_type,  glsl_type::sampler3D_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("texture3DProjLod"))
+      add_function("texture3DProjLod",
+                   _texture(ir_txl, tex3d_lod, glsl_type::vec4_type,  glsl_type::sampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("textureCube"))
+      add_function("textureCube",
+                   _texture(ir_tex, always_available, glsl_type::vec4_type,  glsl_type::samplerCube_type, glsl_type::vec3_type),
+                   _texture(ir_txb, fs_only,          glsl_type::vec4_type,  glsl_type::samplerCube_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("textureCubeLod"))
+      add_function("textureCubeLod",
+                   _texture(ir_txl, lod_exists_in_stage, glsl_type::vec4_type,  glsl_type::samplerCube_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("texture2DRect"))
+      add_function("texture2DRect",
+                   _texture(ir_tex, texture_rectangle, glsl_type::vec4_type,  glsl_type::sampler2DRect_type, glsl_type::vec2_type),
+                   NULL);
+
+   if (wants_function("texture2DRectProj"))
+      add_function("texture2DRectProj",
+                   _texture(ir_tex, texture_rectangle, glsl_type::vec4_type,  glsl_type::sampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_tex, texture_rectangle, glsl_type::vec4_type,  glsl_type::sampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("shadow1D"))
+      add_function("shadow1D",
+                   _texture(ir_tex, v110,         glsl_type::vec4_type,  glsl_type::sampler1DShadow_type, glsl_type::vec3_type),
+                   _texture(ir_txb, v110_fs_only, glsl_type::vec4_type,  glsl_type::sampler1DShadow_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("shadow1DArray"))
+      add_function("shadow1DArray",
+                   _texture(ir_tex, texture_array,    glsl_type::vec4_type,  glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type),
+                   _texture(ir_txb, fs_texture_array, glsl_type::vec4_type,  glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("shadow2D"))
+      add_function("shadow2D",
+                   _texture(ir_tex, v110,         glsl_type::vec4_type,  glsl_type::sampler2DShadow_type, glsl_type::vec3_type),
+                   _texture(ir_txb, v110_fs_only, glsl_type::vec4_type,  glsl_type::sampler2DShadow_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("shadow2DArray"))
+      add_function("shadow2DArray",
+                   _texture(ir_tex, texture_array,    glsl_type::vec4_type,  glsl_type::sampler2DArrayShadow_type, glsl_type::vec4_type),
+                   _texture(ir_txb, fs_texture_array, glsl_type::vec4_type,  glsl_type::sampler2DArrayShadow_type, glsl_type::vec4_type),
+                   NULL);
+
+   if (wants_function("shadow1DProj"))
+      add_function("shadow1DProj",
+                   _texture(ir_tex, v110,         glsl_type::vec4_type,  glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txb, v110_fs_only, glsl_type::vec4_type,  glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("shadow2DProj"))
+      add_function("shadow2DProj",
+                   _texture(ir_tex, v110,         glsl_type::vec4_type,  glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+                   _texture(ir_txb, v110_fs_only, glsl_type::vec4_type,  glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("shadow1DLod"))
+      add_function("shadow1DLod",
+                   _texture(ir_txl, v110_lod, glsl_type::vec4_type,  glsl_type::sampler1DShadow_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("shadow2DLod"))
+      add_function("shadow2DLod",
+                   _texture(ir_txl, v110_lod, glsl_type::vec4_type,  glsl_type::sampler2DShadow_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("shadow1DArrayLod"))
+      add_function("shadow1DArrayLod",
+                   _texture(ir_txl, texture_array_lod, glsl_type::vec4_type, glsl_type::sampler1DArrayShadow_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("shadow1DProjLod"))
+      add_function("shadow1DProjLod",
+                   _texture(ir_txl, v110_lod, glsl_type::vec4_type,  glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("shadow2DProjLod"))
+      add_function("shadow2DProjLod",
+                   _texture(ir_txl, v110_lod, glsl_type::vec4_type,  glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("shadow2DRect"))
+      add_function("shadow2DRect",
+                   _texture(ir_tex, texture_rectangle, glsl_type::vec4_type,  glsl_type::sampler2DRectShadow_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("shadow2DRectProj"))
+      add_function("shadow2DRectProj",
+                   _texture(ir_tex, texture_rectangle, glsl_type::vec4_type,  glsl_type::sampler2DRectShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("texture1DGradARB"))
+      add_function("texture1DGradARB",
+                   _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::float_type),
+                   NULL);
+
+   if (wants_function("texture1DProjGradARB"))
+      add_function("texture1DProjGradARB",
+                   _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::vec2_type, TEX_PROJECT),
+                   _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler1D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("texture2DGradARB"))
+      add_function("texture2DGradARB",
+                   _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec2_type),
+                   NULL);
+
+   if (wants_function("texture2DProjGradARB"))
+      add_function("texture2DProjGradARB",
+                   _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler2D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("texture3DGradARB"))
+      add_function("texture3DGradARB",
+                   _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler3D_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("texture3DProjGradARB"))
+      add_function("texture3DProjGradARB",
+                   _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler3D_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("textureCubeGradARB"))
+      add_function("textureCubeGradARB",
+                   _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::samplerCube_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("shadow1DGradARB"))
+      add_function("shadow1DGradARB",
+                   _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler1DShadow_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("shadow1DProjGradARB"))
+      add_function("shadow1DProjGradARB",
+                   _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler1DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("shadow2DGradARB"))
+      add_function("shadow2DGradARB",
+                   _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler2DShadow_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("shadow2DProjGradARB"))
+      add_function("shadow2DProjGradARB",
+                   _texture(ir_txd, shader_texture_lod, glsl_type::vec4_type,  glsl_type::sampler2DShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("texture2DRectGradARB"))
+      add_function("texture2DRectGradARB",
+                   _texture(ir_txd, shader_texture_lod_and_rect, glsl_type::vec4_type,  glsl_type::sampler2DRect_type, glsl_type::vec2_type),
+                   NULL);
+
+   if (wants_function("texture2DRectProjGradARB"))
+      add_function("texture2DRectProjGradARB",
+                   _texture(ir_txd, shader_texture_lod_and_rect, glsl_type::vec4_type,  glsl_type::sampler2DRect_type, glsl_type::vec3_type, TEX_PROJECT),
+                   _texture(ir_txd, shader_texture_lod_and_rect, glsl_type::vec4_type,  glsl_type::sampler2DRect_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("shadow2DRectGradARB"))
+      add_function("shadow2DRectGradARB",
+                   _texture(ir_txd, shader_texture_lod_and_rect, glsl_type::vec4_type,  glsl_type::sampler2DRectShadow_type, glsl_type::vec3_type),
+                   NULL);
+
+   if (wants_function("shadow2DRectProjGradARB"))
+      add_function("shadow2DRectProjGradARB",
+                   _texture(ir_txd, shader_texture_lod_and_rect, glsl_type::vec4_type,  glsl_type::sampler2DRectShadow_type, glsl_type::vec4_type, TEX_PROJECT),
+                   NULL);
+
+   if (wants_function("textureGather"))
+      add_function("textureGather",
+                   _texture(ir_tg4, texture_gather_or_es31, glsl_type::vec4_type, glsl_type::sampler2D_type, glsl_type::vec2_type),
+                   _texture(ir_tg4, texture_gather_or_es31, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type),
+                   _texture(ir_tg4, texture_gather_or_es31, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type),
+
+                   _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::sampler2DRect_type, glsl_type::vec2_type),
+                   _texture(ir_tg4, gpu_shader5, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type),
+                   _texture(ir_tg4, gpu_shader5, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type),
+
+                   _texture(ir_tg4, texture_gather_or_es31, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type),
+                   _texture(ir_tg4, texture_gather_or_es31, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type),
+                   _texture(ir_tg4, texture_gather_or_es31, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type),
+
+                   _texture(ir_tg4, texture_gather_or_es31, glsl_type::vec4_type, glsl_type::samplerCube_type, glsl_type::vec3_type),
+                   _texture(ir_tg4, texture_gather_or_es31, glsl_type::ivec4_type, glsl_type::isamplerCube_type, glsl_type::vec3_type),
+                   _texture(ir_tg4, texture_gather_or_es31, glsl_type::uvec4_type, glsl_type::usamplerCube_type, glsl_type::vec3_type),
+
+                   _texture(ir_tg4, texture_gather, glsl_type::vec4_type, glsl_type::samplerCubeArray_type, glsl_type::vec4_type),
+                   _texture(ir_tg4, texture_gather, glsl_type::ivec4_type, glsl_type::isamplerCubeArray_type, glsl_type::vec4_type),
+                   _texture(ir_tg4, texture_gather, glsl_type::uvec4_type, glsl_type::usamplerCubeArray_type, glsl_type::vec4_type),
+
+                   _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::vec4_type, glsl_type::sampler2D_type, glsl_type::vec2_type, TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_COMPONENT),
+
+                   _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::sampler2DRect_type, glsl_type::vec2_type, TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type, TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type, TEX_COMPONENT),
+
+                   _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type, TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_COMPONENT),
+
+                   _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::vec4_type, glsl_type::samplerCube_type, glsl_type::vec3_type, TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::ivec4_type, glsl_type::isamplerCube_type, glsl_type::vec3_type, TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::uvec4_type, glsl_type::usamplerCube_type, glsl_type::vec3_type, TEX_COMPONENT),
+
+                   _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::samplerCubeArray_type, glsl_type::vec4_type, TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5, glsl_type::ivec4_type, glsl_type::isamplerCubeArray_type, glsl_type::vec4_type, TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5, glsl_type::uvec4_type, glsl_type::usamplerCubeArray_type, glsl_type::vec4_type, TEX_COMPONENT),
+
+                   _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::vec4_type, glsl_type::sampler2DShadow_type, glsl_type::vec2_type),
+                   _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::vec4_type, glsl_type::sampler2DArrayShadow_type, glsl_type::vec3_type),
+                   _texture(ir_tg4, gpu_shader5_or_es31, glsl_type::vec4_type, glsl_type::samplerCubeShadow_type, glsl_type::vec3_type),
+                   _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::samplerCubeArrayShadow_type, glsl_type::vec4_type),
+                   _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec2_type),
+                   NULL);
+
+   if (wants_function("textureGatherOffset"))
+      add_function("textureGatherOffset",
+                   _texture(ir_tg4, texture_gather_only_or_es31, glsl_type::vec4_type, glsl_type::sampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_tg4, texture_gather_only_or_es31, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_tg4, texture_gather_only_or_es31, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET),
+
+                   _texture(ir_tg4, texture_gather_only_or_es31, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_tg4, texture_gather_only_or_es31, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
+                   _texture(ir_tg4, texture_gather_only_or_es31, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET),
+
+                   _texture(ir_tg4, es31_not_gs5, glsl_type::vec4_type, glsl_type::sampler2D_type, glsl_type::vec2_type, TEX_OFFSET | TEX_COMPONENT),
+                   _texture(ir_tg4, es31_not_gs5, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET | TEX_COMPONENT),
+                   _texture(ir_tg4, es31_not_gs5, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET | TEX_COMPONENT),
+
+                   _texture(ir_tg4, es31_not_gs5, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET | TEX_COMPONENT),
+                   _texture(ir_tg4, es31_not_gs5, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET | TEX_COMPONENT),
+                   _texture(ir_tg4, es31_not_gs5, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET | TEX_COMPONENT),
+
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2D_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST),
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST),
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST),
+
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_NONCONST),
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_NONCONST),
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_NONCONST),
+
+                   _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::sampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST),
+                   _texture(ir_tg4, gpu_shader5, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST),
+                   _texture(ir_tg4, gpu_shader5, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST),
+
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2D_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST | TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST | TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST | TEX_COMPONENT),
+
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_NONCONST | TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_NONCONST | TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_NONCONST | TEX_COMPONENT),
+
+                   _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::sampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST | TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST | TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST | TEX_COMPONENT),
+
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2DShadow_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST),
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2DArrayShadow_type, glsl_type::vec3_type, TEX_OFFSET_NONCONST),
+                   _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec2_type, TEX_OFFSET_NONCONST),
+
+                   _texture(ir_tg4, es31_not_gs5, glsl_type::vec4_type, glsl_type::sampler2DShadow_type, glsl_type::vec2_type, TEX_OFFSET),
+                   _texture(ir_tg4, es31_not_gs5, glsl_type::vec4_type, glsl_type::sampler2DArrayShadow_type, glsl_type::vec3_type, TEX_OFFSET),
+                   NULL);
+
+   if (wants_function("textureGatherOffsets"))
+      add_function("textureGatherOffsets",
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2D_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY),
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY),
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY),
+
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2D_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY | TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::ivec4_type, glsl_type::isampler2D_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY | TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::uvec4_type, glsl_type::usampler2D_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY | TEX_COMPONENT),
+
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_ARRAY),
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_ARRAY),
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_ARRAY),
+
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_ARRAY | TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::ivec4_type, glsl_type::isampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_ARRAY | TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::uvec4_type, glsl_type::usampler2DArray_type, glsl_type::vec3_type, TEX_OFFSET_ARRAY | TEX_COMPONENT),
+
+                   _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::sampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY),
+                   _texture(ir_tg4, gpu_shader5, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY),
+                   _texture(ir_tg4, gpu_shader5, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY),
+
+                   _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::sampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY | TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5, glsl_type::ivec4_type, glsl_type::isampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY | TEX_COMPONENT),
+                   _texture(ir_tg4, gpu_shader5, glsl_type::uvec4_type, glsl_type::usampler2DRect_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY | TEX_COMPONENT),
+
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2DShadow_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY),
+                   _texture(ir_tg4, gpu_shader5_es, glsl_type::vec4_type, glsl_type::sampler2DArrayShadow_type, glsl_type::vec3_type, TEX_OFFSET_ARRAY),
+                   _texture(ir_tg4, gpu_shader5, glsl_type::vec4_type, glsl_type::sampler2DRectShadow_type, glsl_type::vec2_type, TEX_OFFSET_ARRAY),
+                   NULL);
 
    F(dFdx)
    F(dFdy)
@@ -2681,271 +2927,313 @@ builtin_builder::create_builtins()
    IU(findMSB)
    FDGS5(fma)
 
-   add_function("ldexp",
-                _ldexp(glsl_type::float_type, glsl_type::int_type),
-                _ldexp(glsl_type::vec2_type,  glsl_type::ivec2_type),
-                _ldexp(glsl_type::vec3_type,  glsl_type::ivec3_type),
-                _ldexp(glsl_type::vec4_type,  glsl_type::ivec4_type),
-                _ldexp(glsl_type::double_type, glsl_type::int_type),
-                _ldexp(glsl_type::dvec2_type,  glsl_type::ivec2_type),
-                _ldexp(glsl_type::dvec3_type,  glsl_type::ivec3_type),
-                _ldexp(glsl_type::dvec4_type,  glsl_type::ivec4_type),
-                NULL);
-
-   add_function("frexp",
-                _frexp(glsl_type::float_type, glsl_type::int_type),
-                _frexp(glsl_type::vec2_type,  glsl_type::ivec2_type),
-                _frexp(glsl_type::vec3_type,  glsl_type::ivec3_type),
-                _frexp(glsl_type::vec4_type,  glsl_type::ivec4_type),
-                _dfrexp(glsl_type::double_type, glsl_type::int_type),
-                _dfrexp(glsl_type::dvec2_type,  glsl_type::ivec2_type),
-                _dfrexp(glsl_type::dvec3_type,  glsl_type::ivec3_type),
-                _dfrexp(glsl_type::dvec4_type,  glsl_type::ivec4_type),
-                NULL);
-   add_function("uaddCarry",
-                _uaddCarry(glsl_type::uint_type),
-                _uaddCarry(glsl_type::uvec2_type),
-                _uaddCarry(glsl_type::uvec3_type),
-                _uaddCarry(glsl_type::uvec4_type),
-                NULL);
-   add_function("usubBorrow",
-                _usubBorrow(glsl_type::uint_type),
-                _usubBorrow(glsl_type::uvec2_type),
-                _usubBorrow(glsl_type::uvec3_type),
-                _usubBorrow(glsl_type::uvec4_type),
-                NULL);
-   add_function("imulExtended",
-                _mulExtended(glsl_type::int_type),
-                _mulExtended(glsl_type::ivec2_type),
-                _mulExtended(glsl_type::ivec3_type),
-                _mulExtended(glsl_type::ivec4_type),
-                NULL);
-   add_function("umulExtended",
-                _mulExtended(glsl_type::uint_type),
-                _mulExtended(glsl_type::uvec2_type),
-                _mulExtended(glsl_type::uvec3_type),
-                _mulExtended(glsl_type::uvec4_type),
-                NULL);
-   add_function("interpolateAtCentroid",
-                _interpolateAtCentroid(glsl_type::float_type),
-                _interpolateAtCentroid(glsl_type::vec2_type),
-                _interpolateAtCentroid(glsl_type::vec3_type),
-                _interpolateAtCentroid(glsl_type::vec4_type),
-                NULL);
-   add_function("interpolateAtOffset",
-                _interpolateAtOffset(glsl_type::float_type),
-                _interpolateAtOffset(glsl_type::vec2_type),
-                _interpolateAtOffset(glsl_type::vec3_type),
-                _interpolateAtOffset(glsl_type::vec4_type),
-                NULL);
-   add_function("interpolateAtSample",
-                _interpolateAtSample(glsl_type::float_type),
-                _interpolateAtSample(glsl_type::vec2_type),
-                _interpolateAtSample(glsl_type::vec3_type),
-                _interpolateAtSample(glsl_type::vec4_type),
-                NULL);
-
-   add_function("atomicCounter",
-                _atomic_counter_op("__intrinsic_atomic_read",
-                                   shader_atomic_counters),
-                NULL);
-   add_function("atomicCounterIncrement",
-                _atomic_counter_op("__intrinsic_atomic_increment",
-                                   shader_atomic_counters),
-                NULL);
-   add_function("atomicCounterDecrement",
-                _atomic_counter_op("__intrinsic_atomic_predecrement",
-                                   shader_atomic_counters),
-                NULL);
-
-   add_function("atomicCounterAddARB",
-                _atomic_counter_op1("__intrinsic_atomic_add",
-                                    shader_atomic_counter_ops),
-                NULL);
-   add_function("atomicCounterSubtractARB",
-                _atomic_counter_op1("__intrinsic_atomic_sub",
-                                    shader_atomic_counter_ops),
-                NULL);
-   add_function("atomicCounterMinARB",
-                _atomic_counter_op1("__intrinsic_atomic_min",
-                                    shader_atomic_counter_ops),
-                NULL);
-   add_function("atomicCounterMaxARB",
-                _atomic_counter_op1("__intrinsic_atomic_max",
-                                    shader_atomic_counter_ops),
-                NULL);
-   add_function("atomicCounterAndARB",
-                _atomic_counter_op1("__intrinsic_atomic_and",
-                                    shader_atomic_counter_ops),
-                NULL);
-   add_function("atomicCounterOrARB",
-                _atomic_counter_op1("__intrinsic_atomic_or",
-                                    shader_atomic_counter_ops),
-                NULL);
-   add_function("atomicCounterXorARB",
-                _atomic_counter_op1("__intrinsic_atomic_xor",
-                                    shader_atomic_counter_ops),
-                NULL);
-   add_function("atomicCounterExchangeARB",
-                _atomic_counter_op1("__intrinsic_atomic_exchange",
-                                    shader_atomic_counter_ops),
-                NULL);
-   add_function("atomicCounterCompSwapARB",
-                _atomic_counter_op2("__intrinsic_atomic_comp_swap",
-                                    shader_atomic_counter_ops),
-                NULL);
-
-   add_function("atomicAdd",
-                _atomic_op2("__intrinsic_atomic_add",
-                            buffer_atomics_supported,
-                            glsl_type::uint_type),
-                _atomic_op2("__intrinsic_atomic_add",
-                            buffer_atomics_supported,
-                            glsl_type::int_type),
-                NULL);
-   add_function("atomicMin",
-                _atomic_op2("__intrinsic_atomic_min",
-                            buffer_atomics_supported,
-                            glsl_type::uint_type),
-                _atomic_op2("__intrinsic_atomic_min",
-                            buffer_atomics_supported,
-                            glsl_type::int_type),
-                NULL);
-   add_function("atomicMax",
-                _atomic_op2("__intrinsic_atomic_max",
-                            buffer_atomics_supported,
-                            glsl_type::uint_type),
-                _atomic_op2("__intrinsic_atomic_max",
-                            buffer_atomics_supported,
-                            glsl_type::int_type),
-                NULL);
-   add_function("atomicAnd",
-                _atomic_op2("__intrinsic_atomic_and",
-                            buffer_atomics_supported,
-                            glsl_type::uint_type),
-                _atomic_op2("__intrinsic_atomic_and",
-                            buffer_atomics_supported,
-                            glsl_type::int_type),
-                NULL);
-   add_function("atomicOr",
-                _atomic_op2("__intrinsic_atomic_or",
-                            buffer_atomics_supported,
-                            glsl_type::uint_type),
-                _atomic_op2("__intrinsic_atomic_or",
-                            buffer_atomics_supported,
-                            glsl_type::int_type),
-                NULL);
-   add_function("atomicXor",
-                _atomic_op2("__intrinsic_atomic_xor",
-                            buffer_atomics_supported,
-                            glsl_type::uint_type),
-                _atomic_op2("__intrinsic_atomic_xor",
-                            buffer_atomics_supported,
-                            glsl_type::int_type),
-                NULL);
-   add_function("atomicExchange",
-                _atomic_op2("__intrinsic_atomic_exchange",
-                            buffer_atomics_supported,
-                            glsl_type::uint_type),
-                _atomic_op2("__intrinsic_atomic_exchange",
-                            buffer_atomics_supported,
-                            glsl_type::int_type),
-                NULL);
-   add_function("atomicCompSwap",
-                _atomic_op3("__intrinsic_atomic_comp_swap",
-                            buffer_atomics_supported,
-                            glsl_type::uint_type),
-                _atomic_op3("__intrinsic_atomic_comp_swap",
-                            buffer_atomics_supported,
-                            glsl_type::int_type),
-                NULL);
-
-   add_function("min3",
-                _min3(glsl_type::float_type),
-                _min3(glsl_type::vec2_type),
-                _min3(glsl_type::vec3_type),
-                _min3(glsl_type::vec4_type),
-
-                _min3(glsl_type::int_type),
-                _min3(glsl_type::ivec2_type),
-                _min3(glsl_type::ivec3_type),
-                _min3(glsl_type::ivec4_type),
-
-                _min3(glsl_type::uint_type),
-                _min3(glsl_type::uvec2_type),
-                _min3(glsl_type::uvec3_type),
-                _min3(glsl_type::uvec4_type),
-                NULL);
-
-   add_function("max3",
-                _max3(glsl_type::float_type),
-                _max3(glsl_type::vec2_type),
-                _max3(glsl_type::vec3_type),
-                _max3(glsl_type::vec4_type),
-
-                _max3(glsl_type::int_type),
-                _max3(glsl_type::ivec2_type),
-                _max3(glsl_type::ivec3_type),
-                _max3(glsl_type::ivec4_type),
-
-                _max3(glsl_type::uint_type),
-                _max3(glsl_type::uvec2_type),
-                _max3(glsl_type::uvec3_type),
-                _max3(glsl_type::uvec4_type),
-                NULL);
-
-   add_function("mid3",
-                _mid3(glsl_type::float_type),
-                _mid3(glsl_type::vec2_type),
-                _mid3(glsl_type::vec3_type),
-                _mid3(glsl_type::vec4_type),
-
-                _mid3(glsl_type::int_type),
-                _mid3(glsl_type::ivec2_type),
-                _mid3(glsl_type::ivec3_type),
-                _mid3(glsl_type::ivec4_type),
-
-                _mid3(glsl_type::uint_type),
-                _mid3(glsl_type::uvec2_type),
-                _mid3(glsl_type::uvec3_type),
-                _mid3(glsl_type::uvec4_type),
-                NULL);
+   if (wants_function("ldexp"))
+      add_function("ldexp",
+                   _ldexp(glsl_type::float_type, glsl_type::int_type),
+                   _ldexp(glsl_type::vec2_type,  glsl_type::ivec2_type),
+                   _ldexp(glsl_type::vec3_type,  glsl_type::ivec3_type),
+                   _ldexp(glsl_type::vec4_type,  glsl_type::ivec4_type),
+                   _ldexp(glsl_type::double_type, glsl_type::int_type),
+                   _ldexp(glsl_type::dvec2_type,  glsl_type::ivec2_type),
+                   _ldexp(glsl_type::dvec3_type,  glsl_type::ivec3_type),
+                   _ldexp(glsl_type::dvec4_type,  glsl_type::ivec4_type),
+                   NULL);
+
+   if (wants_function("frexp"))
+      add_function("frexp",
+                   _frexp(glsl_type::float_type, glsl_type::int_type),
+                   _frexp(glsl_type::vec2_type,  glsl_type::ivec2_type),
+                   _frexp(glsl_type::vec3_type,  glsl_type::ivec3_type),
+                   _frexp(glsl_type::vec4_type,  glsl_type::ivec4_type),
+                   _dfrexp(glsl_type::double_type, glsl_type::int_type),
+                   _dfrexp(glsl_type::dvec2_type,  glsl_type::ivec2_type),
+                   _dfrexp(glsl_type::dvec3_type,  glsl_type::ivec3_type),
+                   _dfrexp(glsl_type::dvec4_type,  glsl_type::ivec4_type),
+                   NULL);
+   if (wants_function("uaddCarry"))
+      add_function("uaddCarry",
+                   _uaddCarry(glsl_type::uint_type),
+                   _uaddCarry(glsl_type::uvec2_type),
+                   _uaddCarry(glsl_type::uvec3_type),
+                   _uaddCarry(glsl_type::uvec4_type),
+                   NULL);
+   if (wants_function("usubBorrow"))
+      add_function("usubBorrow",
+                   _usubBorrow(glsl_type::uint_type),
+                   _usubBorrow(glsl_type::uvec2_type),
+                   _usubBorrow(glsl_type::uvec3_type),
+                   _usubBorrow(glsl_type::uvec4_type),
+                   NULL);
+   if (wants_function("imulExtended"))
+      add_function("imulExtended",
+                   _mulExtended(glsl_type::int_type),
+                   _mulExtended(glsl_type::ivec2_type),
+                   _mulExtended(glsl_type::ivec3_type),
+                   _mulExtended(glsl_type::ivec4_type),
+                   NULL);
+   if (wants_function("umulExtended"))
+      add_function("umulExtended",
+                   _mulExtended(glsl_type::uint_type),
+                   _mulExtended(glsl_type::uvec2_type),
+                   _mulExtended(glsl_type::uvec3_type),
+                   _mulExtended(glsl_type::uvec4_type),
+                   NULL);
+   if (wants_function("interpolateAtCentroid"))
+      add_function("interpolateAtCentroid",
+                   _interpolateAtCentroid(glsl_type::float_type),
+                   _interpolateAtCentroid(glsl_type::vec2_type),
+                   _interpolateAtCentroid(glsl_type::vec3_type),
+                   _interpolateAtCentroid(glsl_type::vec4_type),
+                   NULL);
+   if (wants_function("interpolateAtOffset"))
+      add_function("interpolateAtOffset",
+                   _interpolateAtOffset(glsl_type::float_type),
+                   _interpolateAtOffset(glsl_type::vec2_type),
+                   _interpolateAtOffset(glsl_type::vec3_type),
+                   _interpolateAtOffset(glsl_type::vec4_type),
+                   NULL);
+   if (wants_function("interpolateAtSample"))
+      add_function("interpolateAtSample",
+                   _interpolateAtSample(glsl_type::float_type),
+                   _interpolateAtSample(glsl_type::vec2_type),
+                   _interpolateAtSample(glsl_type::vec3_type),
+                   _interpolateAtSample(glsl_type::vec4_type),
+                   NULL);
+
+   if (wants_function("atomicCounter"))
+      add_function("atomicCounter",
+                   _atomic_counter_op("__intrinsic_atomic_read",
+                                      shader_atomic_counters),
+                   NULL);
+   if (wants_function("atomicCounterIncrement"))
+      add_function("atomicCounterIncrement",
+                   _atomic_counter_op("__intrinsic_atomic_increment",
+                                      shader_atomic_counters),
+                   NULL);
+   if (wants_function("atomicCounterDecrement"))
+      add_function("atomicCounterDecrement",
+                   _atomic_counter_op("__intrinsic_atomic_predecrement",
+                                      shader_atomic_counters),
+                   NULL);
+
+   if (wants_function("atomicCounterAddARB"))
+      add_function("atomicCounterAddARB",
+                   _atomic_counter_op1("__intrinsic_atomic_add",
+                                       shader_atomic_counter_ops),
+                   NULL);
+   if (wants_function("atomicCounterSubtractARB"))
+      add_function("atomicCounterSubtractARB",
+                   _atomic_counter_op1("__intrinsic_atomic_sub",
+                                       shader_atomic_counter_ops),
+                   NULL);
+   if (wants_function("atomicCounterMinARB"))
+      add_function("atomicCounterMinARB",
+                   _atomic_counter_op1("__intrinsic_atomic_min",
+                                       shader_atomic_counter_ops),
+                   NULL);
+   if (wants_function("atomicCounterMaxARB"))
+      add_function("atomicCounterMaxARB",
+                   _atomic_counter_op1("__intrinsic_atomic_max",
+                                       shader_atomic_counter_ops),
+                   NULL);
+   if (wants_function("atomicCounterAndARB"))
+      add_function("atomicCounterAndARB",
+                   _atomic_counter_op1("__intrinsic_atomic_and",
+                                       shader_atomic_counter_ops),
+                   NULL);
+   if (wants_function("atomicCounterOrARB"))
+      add_function("atomicCounterOrARB",
+                   _atomic_counter_op1("__intrinsic_atomic_or",
+                                       shader_atomic_counter_ops),
+                   NULL);
+   if (wants_function("atomicCounterXorARB"))
+      add_function("atomicCounterXorARB",
+                   _atomic_counter_op1("__intrinsic_atomic_xor",
+                                       shader_atomic_counter_ops),
+                   NULL);
+   if (wants_function("atomicCounterExchangeARB"))
+      add_function("atomicCounterExchangeARB",
+                   _atomic_counter_op1("__intrinsic_atomic_exchange",
+                                       shader_atomic_counter_ops),
+                   NULL);
+   if (wants_function("atomicCounterCompSwapARB"))
+      add_function("atomicCounterCompSwapARB",
+                   _atomic_counter_op2("__intrinsic_atomic_comp_swap",
+                                       shader_atomic_counter_ops),
+                   NULL);
+
+   if (wants_function("atomicAdd"))
+      add_function("atomicAdd",
+                   _atomic_op2("__intrinsic_atomic_add",
+                               buffer_atomics_supported,
+                               glsl_type::uint_type),
+                   _atomic_op2("__intrinsic_atomic_add",
+                               buffer_atomics_supported,
+                               glsl_type::int_type),
+                   NULL);
+   if (wants_function("atomicMin"))
+      add_function("atomicMin",
+                   _atomic_op2("__intrinsic_atomic_min",
+                               buffer_atomics_supported,
+                               glsl_type::uint_type),
+                   _atomic_op2("__intrinsic_atomic_min",
+                               buffer_atomics_supported,
+                               glsl_type::int_type),
+                   NULL);
+   if (wants_function("atomicMax"))
+      add_function("atomicMax",
+                   _atomic_op2("__intrinsic_atomic_max",
+                               buffer_atomics_supported,
+                               glsl_type::uint_type),
+                   _atomic_op2("__intrinsic_atomic_max",
+                               buffer_atomics_supported,
+                               glsl_type::int_type),
+                   NULL);
+   if (wants_function("atomicAnd"))
+      add_function("atomicAnd",
+                   _atomic_op2("__intrinsic_atomic_and",
+                               buffer_atomics_supported,
+                               glsl_type::uint_type),
+                   _atomic_op2("__intrinsic_atomic_and",
+                               buffer_atomics_supported,
+                               glsl_type::int_type),
+                   NULL);
+   if (wants_function("atomicOr"))
+      add_function("atomicOr",
+                   _atomic_op2("__intrinsic_atomic_or",
+                               buffer_atomics_supported,
+                               glsl_type::uint_type),
+                   _atomic_op2("__intrinsic_atomic_or",
+                               buffer_atomics_supported,
+                               glsl_type::int_type),
+                   NULL);
+   if (wants_function("atomicXor"))
+      add_function("atomicXor",
+                   _atomic_op2("__intrinsic_atomic_xor",
+                               buffer_atomics_supported,
+                               glsl_type::uint_type),
+                   _atomic_op2("__intrinsic_atomic_xor",
+                               buffer_atomics_supported,
+                               glsl_type::int_type),
+                   NULL);
+   if (wants_function("atomicExchange"))
+      add_function("atomicExchange",
+                   _atomic_op2("__intrinsic_atomic_exchange",
+                               buffer_atomics_supported,
+                               glsl_type::uint_type),
+                   _atomic_op2("__intrinsic_atomic_exchange",
+                               buffer_atomics_supported,
+                               glsl_type::int_type),
+                   NULL);
+   if (wants_function("atomicCompSwap"))
+      add_function("atomicCompSwap",
+                   _atomic_op3("__intrinsic_atomic_comp_swap",
+                               buffer_atomics_supported,
+                               glsl_type::uint_type),
+                   _atomic_op3("__intrinsic_atomic_comp_swap",
+                               buffer_atomics_supported,
+                               glsl_type::int_type),
+                   NULL);
+
+   if (wants_function("min3"))
+      add_function("min3",
+                   _min3(glsl_type::float_type),
+                   _min3(glsl_type::vec2_type),
+                   _min3(glsl_type::vec3_type),
+                   _min3(glsl_type::vec4_type),
+
+                   _min3(glsl_type::int_type),
+                   _min3(glsl_type::ivec2_type),
+                   _min3(glsl_type::ivec3_type),
+                   _min3(glsl_type::ivec4_type),
+
+                   _min3(glsl_type::uint_type),
+                   _min3(glsl_type::uvec2_type),
+                   _min3(glsl_type::uvec3_type),
+                   _min3(glsl_type::uvec4_type),
+                   NULL);
+
+   if (wants_function("max3"))
+      add_function("max3",
+                   _max3(glsl_type::float_type),
+                   _max3(glsl_type::vec2_type),
+                   _max3(glsl_type::vec3_type),
+                   _max3(glsl_type::vec4_type),
+
+                   _max3(glsl_type::int_type),
+                   _max3(glsl_type::ivec2_type),
+                   _max3(glsl_type::ivec3_type),
+                   _max3(glsl_type::ivec4_type),
+
+                   _max3(glsl_type::uint_type),
+                   _max3(glsl_type::uvec2_type),
+                   _max3(glsl_type::uvec3_type),
+                   _max3(glsl_type::uvec4_type),
+                   NULL);
+
+   if (wants_function("mid3"))
+      add_function("mid3",
+                   _mid3(glsl_type::float_type),
+                   _mid3(glsl_type::vec2_type),
+                   _mid3(glsl_type::vec3_type),
+                   _mid3(glsl_type::vec4_type),
+
+                   _mid3(glsl_type::int_type),
+                   _mid3(glsl_type::ivec2_type),
+                   _mid3(glsl_type::ivec3_type),
+                   _mid3(glsl_type::ivec4_type),
+
+                   _mid3(glsl_type::uint_type),
+                   _mid3(glsl_type::uvec2_type),
+                   _mid3(glsl_type::uvec3_type),
+                   _mid3(glsl_type::uvec4_type),
+                   NULL);
 
    add_image_functions(true);
 
-   add_function("memoryBarrier",
-                _memory_barrier("__intrinsic_memory_barrier",
-                                shader_image_load_store),
-                NULL);
-   add_function("groupMemoryBarrier",
-                _memory_barrier("__intrinsic_group_memory_barrier",
-                                compute_shader),
-                NULL);
-   add_function("memoryBarrierAtomicCounter",
-                _memory_barrier("__intrinsic_memory_barrier_atomic_counter",
-                                compute_shader),
-                NULL);
-   add_function("memoryBarrierBuffer",
-                _memory_barrier("__intrinsic_memory_barrier_buffer",
-                                compute_shader),
-                NULL);
-   add_function("memoryBarrierImage",
-                _memory_barrier("__intrinsic_memory_barrier_image",
-                                compute_shader),
-                NULL);
-   add_function("memoryBarrierShared",
-                _memory_barrier("__intrinsic_memory_barrier_shared",
-                                compute_shader),
-                NULL);
-
-   add_function("clock2x32ARB",
-                _shader_clock(shader_clock,
-                              glsl_type::uvec2_type),
-                NULL);
-
-   add_function("anyInvocationARB", _vote(ir_unop_vote_any), NULL);
-   add_function("allInvocationsARB", _vote(ir_unop_vote_all), NULL);
-   add_function("allInvocationsEqualARB", _vote(ir_unop_vote_eq), NULL);
+   if (wants_function("memoryBarrier"))
+      add_function("memoryBarrier",
+                   _memory_barrier("__intrinsic_memory_barrier",
+                                   shader_image_load_store),
+                   NULL);
+   if (wants_function("groupMemoryBarrier"))
+      add_function("groupMemoryBarrier",
+                   _memory_barrier("__intrinsic_group_memory_barrier",
+                                   compute_shader),
+                   NULL);
+   if (wants_function("memoryBarrierAtomicCounter"))
+      add_function("memoryBarrierAtomicCounter",
+                   _memory_barrier("__intrinsic_memory_barrier_atomic_counter",
+                                   compute_shader),
+                   NULL);
+   if (wants_function("memoryBarrierBuffer"))
+      add_function("memoryBarrierBuffer",
+                   _memory_barrier("__intrinsic_memory_barrier_buffer",
+                                   compute_shader),
+                   NULL);
+   if (wants_function("memoryBarrierImage"))
+      add_function("memoryBarrierImage",
+                   _memory_barrier("__intrinsic_memory_barrier_image",
+                                   compute_shader),
+                   NULL);
+   if (wants_function("memoryBarrierShared"))
+      add_function("memoryBarrierShared",
+                   _memory_barrier("__intrinsic_memory_barrier_shared",
+                                   compute_shader),
+                   NULL);
+
+   if (wants_function("clock2x32ARB"))
+      add_function("clock2x32ARB",
+                   _shader_clock(shader_clock,
+                                 glsl_type::uvec2_type),
+                   NULL);
+
+   if (wants_function("anyInvocationARB"))
+      add_function("anyInvocationARB", _vote(ir_unop_vote_any), NULL);
+   if (wants_function("allInvocationsARB"))
+      add_function("allInvocationsARB", _vote(ir_unop_vote_all), NULL);
+   if (wants_function("allInvocationsEqualARB"))
+      add_function("allInvocationsEqualARB", _vote(ir_unop_vote_eq), NULL);
 
 #undef F
 #undef FI
@@ -2977,7 +3265,7 @@ builtin_builder::add_function(const char *name, ...)
    }
    va_end(ap);
 
-   shader->symbols->add_function(f);
+   publish(f);
 }
 
 void
@@ -3023,6 +3311,9 @@ builtin_builder::add_image_function(const char *name,
       glsl_type::uimage2DMSArray_type
    };
 
+   if (!wants_function(name))
+      return;
+
    ir_function *f = new(mem_ctx) ir_function(name);
 
    for (unsigned i = 0; i < ARRAY_SIZE(types); ++i) {
@@ -3034,7 +3325,7 @@ builtin_builder::add_image_function(const char *name,
                                  num_arguments, flags));
    }
 
-   shader->symbols->add_function(f);
+   publish(f);
 }
 
 void
@@ -5604,7 +5895,7 @@ builtin_builder::_vote(enum ir_expression_operation opcode)
 
 /* The singleton instance of builtin_builder. */
 static builtin_builder builtins;
-static mtx_t builtins_lock = _MTX_INITIALIZER_NP;
+static bool builtins_initialized;
 
 /**
  * External API (exposing the built-in module to the rest of the compiler):
@@ -5613,8 +5904,12 @@ static mtx_t builtins_lock = _MTX_INITIALIZER_NP;
 void
 _mesa_glsl_initialize_builtin_functions()
 {
+   if (p_atomic_read(&builtins_initialized))
+      return;
+
    mtx_lock(&builtins_lock);
    builtins.initialize();
+   (void) p_atomic_cmpxchg(&builtins_initialized, false, true);
    mtx_unlock(&builtins_lock);
 }
 
@@ -5622,6 +5917,7 @@ void
 _mesa_glsl_release_builtin_functions()
 {
    mtx_lock(&builtins_lock);
+   builtins_initialized = false;
    builtins.release();
    mtx_unlock(&builtins_lock);
 }
@@ -5630,21 +5926,13 @@ ir_function_signature *
 _mesa_glsl_find_builtin_function(_mesa_glsl_parse_state *state,
                                  const char *name, exec_list *actual_parameters)
 {
-   ir_function_signature * s;
-   mtx_lock(&builtins_lock);
-   s = builtins.find(state, name, actual_parameters);
-   mtx_unlock(&builtins_lock);
-   return s;
+   return builtins.find(state, name, actual_parameters);
 }
 
 ir_function *
 _mesa_glsl_find_builtin_function_by_name(const char *name)
 {
-   ir_function *f;
-   mtx_lock(&builtins_lock);
-   f = builtins.shader->symbols->get_function(name);
-   mtx_unlock(&builtins_lock);
-   return f;
+   return builtins.get_function(name);
 }
 
 gl_shader *
@@ -49,10 +49,11 @@ _define_function_macro(glcpp_parser_t *parser,
                        token_list_t *replacements);
 
 static string_list_t *
-_string_list_create(void *ctx);
+_string_list_create(glcpp_parser_t *parser);
 
 static void
-_string_list_append_item(string_list_t *list, const char *str);
+_string_list_append_item(glcpp_parser_t *parser, string_list_t *list,
+                         const char *str);
 
 static int
 _string_list_contains(string_list_t *list, const char *member, int *index);
@@ -67,10 +68,11 @@ static int
 _string_list_equal(string_list_t *a, string_list_t *b);
 
 static argument_list_t *
-_argument_list_create(void *ctx);
+_argument_list_create(glcpp_parser_t *parser);
 
 static void
-_argument_list_append(argument_list_t *list, token_list_t *argument);
+_argument_list_append(glcpp_parser_t *parser, argument_list_t *list,
+                      token_list_t *argument);
 
 static int
 _argument_list_length(argument_list_t *list);
@@ -78,18 +80,17 @@ _argument_list_length(argument_list_t *list);
 static token_list_t *
 _argument_list_member_at(argument_list_t *list, int index);
 
-/* Note: This function ralloc_steal()s the str pointer. */
 static token_t *
-_token_create_str(void *ctx, int type, char *str);
+_token_create_str(glcpp_parser_t *parser, int type, char *str);
 
 static token_t *
-_token_create_ival(void *ctx, int type, int ival);
+_token_create_ival(glcpp_parser_t *parser, int type, int ival);
 
 static token_list_t *
-_token_list_create(void *ctx);
+_token_list_create(glcpp_parser_t *parser);
 
 static void
-_token_list_append(token_list_t *list, token_t *token);
+_token_list_append(glcpp_parser_t *parser, token_list_t *list, token_t *token);
 
 static void
 _token_list_append_list(token_list_t *list, token_list_t *tail);
@@ -208,8 +209,7 @@ line:
 |	SPACE control_line
 |	text_line {
 		_glcpp_parser_print_expanded_token_list (parser, $1);
-		ralloc_asprintf_rewrite_tail (&parser->output, &parser->output_length, "\n");
-		ralloc_free ($1);
+		_mesa_string_buffer_append_char (parser->output, '\n');
 	}
 |	expanded_line
 ;
@@ -228,20 +228,18 @@ expanded_line:
 |	LINE_EXPANDED integer_constant NEWLINE {
 		parser->has_new_line_number = 1;
 		parser->new_line_number = $2;
-		ralloc_asprintf_rewrite_tail (&parser->output,
-					      &parser->output_length,
-					      "#line %" PRIiMAX "\n",
-					      $2);
+		_mesa_string_buffer_printf (parser->output,
+					    "#line %" PRIiMAX "\n",
+					    $2);
 	}
 |	LINE_EXPANDED integer_constant integer_constant NEWLINE {
 		parser->has_new_line_number = 1;
 		parser->new_line_number = $2;
 		parser->has_new_source_number = 1;
 		parser->new_source_number = $3;
-		ralloc_asprintf_rewrite_tail (&parser->output,
-					      &parser->output_length,
-					      "#line %" PRIiMAX " %" PRIiMAX "\n",
-					      $2, $3);
+		_mesa_string_buffer_printf (parser->output,
+					    "#line %" PRIiMAX " %" PRIiMAX "\n",
+					    $2, $3);
 	}
 ;
 
@@ -259,7 +257,7 @@ define:
 
 control_line:
 	control_line_success {
-		ralloc_asprintf_rewrite_tail (&parser->output, &parser->output_length, "\n");
+		_mesa_string_buffer_append_char (parser->output, '\n');
 	}
 |	control_line_error
 |	HASH_TOKEN LINE pp_tokens NEWLINE {
@@ -288,9 +286,8 @@ control_line_success:
 		macro = hash_table_find (parser->defines, $3);
 		if (macro) {
 			hash_table_remove (parser->defines, $3);
-			ralloc_free (macro);
+			parser->define_generation++;
 		}
-		ralloc_free ($3);
 	}
 |	HASH_TOKEN IF pp_tokens NEWLINE {
 		/* Be careful to only evaluate the 'if' expression if
@@ -325,12 +322,10 @@ control_line_success:
 	}
 |	HASH_TOKEN IFDEF IDENTIFIER junk NEWLINE {
 		macro_t *macro = hash_table_find (parser->defines, $3);
-		ralloc_free ($3);
 		_glcpp_parser_skip_stack_push_if (parser, & @1, macro != NULL);
 	}
 |	HASH_TOKEN IFNDEF IDENTIFIER junk NEWLINE {
 		macro_t *macro = hash_table_find (parser->defines, $3);
-		ralloc_free ($3);
 		_glcpp_parser_skip_stack_push_if (parser, & @3, macro == NULL);
 	}
 |	HASH_TOKEN ELIF pp_tokens NEWLINE {
@@ -411,7 +406,7 @@ control_line_success:
 		glcpp_parser_resolve_implicit_version(parser);
 	}
 |	HASH_TOKEN PRAGMA NEWLINE {
-		ralloc_asprintf_rewrite_tail (&parser->output, &parser->output_length, "#%s", $2);
+		_mesa_string_buffer_printf (parser->output, "#%s", $2);
 	}
 ;
 
@@ -621,13 +616,11 @@ expression:
 identifier_list:
 	IDENTIFIER {
 		$$ = _string_list_create (parser);
-		_string_list_append_item ($$, $1);
-		ralloc_steal ($$, $1);
+		_string_list_append_item (parser, $$, $1);
 	}
 |	identifier_list ',' IDENTIFIER {
 		$$ = $1;	
-		_string_list_append_item ($$, $3);
-		ralloc_steal ($$, $3);
+		_string_list_append_item (parser, $$, $3);
 	}
 ;
 
@@ -652,11 +645,11 @@ pp_tokens:
 	preprocessing_token {
 		parser->space_tokens = 1;
 		$$ = _token_list_create (parser);
-		_token_list_append ($$, $1);
+		_token_list_append (parser, $$, $1);
 	}
 |	pp_tokens preprocessing_token {
 		$$ = $1;
-		_token_list_append ($$, $2);
+		_token_list_append (parser, $$, $2);
 	}
 ;
 
@@ -726,11 +719,11 @@ operator:
 %%
 
 string_list_t *
-_string_list_create(void *ctx)
+_string_list_create(glcpp_parser_t *parser)
 {
    string_list_t *list;
 
-   list = ralloc (ctx, string_list_t);
+   list = linear_alloc_child(parser->linalloc, sizeof(string_list_t));
    list->head = NULL;
    list->tail = NULL;
 
@@ -738,12 +731,13 @@ _string_list_create(void *ctx)
 }
 
 void
-_string_list_append_item(string_list_t *list, const char *str)
+_string_list_append_item(glcpp_parser_t *parser, string_list_t *list,
+                         const char *str)
 {
    string_node_t *node;
 
-   node = ralloc (list, string_node_t);
-   node->str = ralloc_strdup (node, str);
+   node = linear_alloc_child(parser->linalloc, sizeof(string_node_t));
+   node->str = linear_strdup(parser->linalloc, str);
 
    node->next = NULL;
 
@@ -836,11 +830,11 @@ _string_list_equal(string_list_t *a, string_list_t *b)
 }
 
 argument_list_t *
-_argument_list_create(void *ctx)
+_argument_list_create(glcpp_parser_t *parser)
 {
    argument_list_t *list;
 
-   list = ralloc (ctx, argument_list_t);
+   list = linear_alloc_child(parser->linalloc, sizeof(argument_list_t));
    list->head = NULL;
    list->tail = NULL;
 
@@ -848,11 +842,12 @@ _argument_list_create(void *ctx)
 }
 
 void
-_argument_list_append(argument_list_t *list, token_list_t *argument)
+_argument_list_append(glcpp_parser_t *parser,
+                      argument_list_t *list, token_list_t *argument)
 {
    argument_node_t *node;
 
-   node = ralloc (list, argument_node_t);
+   node = linear_alloc_child(parser->linalloc, sizeof(argument_node_t));
    node->argument = argument;
 
    node->next = NULL;
@@ -903,27 +898,24 @@ _argument_list_member_at(argument_list_t *list, int index)
    return NULL;
 }
 
-/* Note: This function ralloc_steal()s the str pointer. */
 token_t *
-_token_create_str(void *ctx, int type, char *str)
+_token_create_str(glcpp_parser_t *parser, int type, char *str)
 {
    token_t *token;
 
-   token = ralloc (ctx, token_t);
+   token = linear_alloc_child(parser->linalloc, sizeof(token_t));
    token->type = type;
    token->value.str = str;
 
-   ralloc_steal (token, str);
-
    return token;
 }
 
 token_t *
-_token_create_ival(void *ctx, int type, int ival)
+_token_create_ival(glcpp_parser_t *parser, int type, int ival)
 {
    token_t *token;
 
-   token = ralloc (ctx, token_t);
+   token = linear_alloc_child(parser->linalloc, sizeof(token_t));
    token->type = type;
    token->value.ival = ival;
 
@@ -931,11 +923,11 @@ _token_create_ival(void *ctx, int type, int ival)
 }
 
 token_list_t *
-_token_list_create(void *ctx)
+_token_list_create(glcpp_parser_t *parser)
 {
    token_list_t *list;
 
-   list = ralloc (ctx, token_list_t);
+   list = linear_alloc_child(parser->linalloc, sizeof(token_list_t));
    list->head = NULL;
    list->tail = NULL;
    list->non_space_tail = NULL;
@@ -944,11 +936,11 @@ _token_list_create(void *ctx)
 }
 
 void
-_token_list_append(token_list_t *list, token_t *token)
+_token_list_append(glcpp_parser_t *parser, token_list_t *list, token_t *token)
 {
    token_node_t *node;
 
-   node = ralloc (list, token_node_t);
+   node = linear_alloc_child(parser->linalloc, sizeof(token_node_t));
    node->token = token;
    node->next = NULL;
 
@@ -980,7 +972,7 @@ _token_list_append_list(token_list_t *list, token_list_t *tail)
 }
 
 static token_list_t *
-_token_list_copy(void *ctx, token_list_t *other)
+_token_list_copy(glcpp_parser_t *parser, token_list_t *other)
 {
    token_list_t *copy;
    token_node_t *node;
@@ -988,11 +980,11 @@ _token_list_copy(void *ctx, token_list_t *other)
    if (other == NULL)
       return NULL;
 
-   copy = _token_list_create (ctx);
+   copy = _token_list_create (parser);
    for (node = other->head; node; node = node->next) {
-      token_t *new_token = ralloc (copy, token_t);
+      token_t *new_token = linear_alloc_child(parser->linalloc, sizeof(token_t));
       *new_token = *node->token;
-      _token_list_append (copy, new_token);
+      _token_list_append (parser, copy, new_token);
    }
 
    return copy;
@@ -1001,18 +993,9 @@ _token_list_copy(void *ctx, token_list_t *other)
 static void
 _token_list_trim_trailing_space(token_list_t *list)
 {
-   token_node_t *tail, *next;
-
    if (list->non_space_tail) {
-      tail = list->non_space_tail->next;
       list->non_space_tail->next = NULL;
       list->tail = list->non_space_tail;
-
-      while (tail) {
-         next = tail->next;
-         ralloc_free (tail);
-         tail = next;
-      }
    }
 }
 
@@ -1090,60 +1073,60 @@ _token_list_equal_ignoring_space(token_list_t *a, token_list_t *b)
 }
 
 static void
-_token_print(char **out, size_t *len, token_t *token)
+_token_print(struct _mesa_string_buffer *out, token_t *token)
 {
    if (token->type < 256) {
-      ralloc_asprintf_rewrite_tail (out, len, "%c", token->type);
+      _mesa_string_buffer_append_char (out, token->type);
       return;
    }
 
    switch (token->type) {
    case INTEGER:
-      ralloc_asprintf_rewrite_tail (out, len, "%" PRIiMAX, token->value.ival);
+      _mesa_string_buffer_printf (out, "%" PRIiMAX, token->value.ival);
       break;
    case IDENTIFIER:
    case INTEGER_STRING:
    case OTHER:
-      ralloc_asprintf_rewrite_tail (out, len, "%s", token->value.str);
+      _mesa_string_buffer_append (out, token->value.str);
       break;
    case SPACE:
-      ralloc_asprintf_rewrite_tail (out, len, " ");
+      _mesa_string_buffer_append_char (out, ' ');
       break;
    case LEFT_SHIFT:
-      ralloc_asprintf_rewrite_tail (out, len, "<<");
+      _mesa_string_buffer_append (out, "<<");
       break;
    case RIGHT_SHIFT:
-      ralloc_asprintf_rewrite_tail (out, len, ">>");
+      _mesa_string_buffer_append (out, ">>");
       break;
    case LESS_OR_EQUAL:
-      ralloc_asprintf_rewrite_tail (out, len, "<=");
+      _mesa_string_buffer_append (out, "<=");
       break;
    case GREATER_OR_EQUAL:
-      ralloc_asprintf_rewrite_tail (out, len, ">=");
+      _mesa_string_buffer_append (out, ">=");
       break;
    case EQUAL:
-      ralloc_asprintf_rewrite_tail (out, len, "==");
+      _mesa_string_buffer_append (out, "==");
       break;
    case NOT_EQUAL:
-      ralloc_asprintf_rewrite_tail (out, len, "!=");
+      _mesa_string_buffer_append (out, "!=");
       break;
    case AND:
-      ralloc_asprintf_rewrite_tail (out, len, "&&");
+      _mesa_string_buffer_append (out, "&&");
       break;
    case OR:
-      ralloc_asprintf_rewrite_tail (out, len, "||");
+      _mesa_string_buffer_append (out, "||");
       break;
    case PASTE:
-      ralloc_asprintf_rewrite_tail (out, len, "##");
+      _mesa_string_buffer_append (out, "##");
       break;
    case PLUS_PLUS:
-      ralloc_asprintf_rewrite_tail (out, len, "++");
+      _mesa_string_buffer_append (out, "++");
       break;
    case MINUS_MINUS:
-      ralloc_asprintf_rewrite_tail (out, len, "--");
+      _mesa_string_buffer_append (out, "--");
       break;
    case DEFINED:
-      ralloc_asprintf_rewrite_tail (out, len, "defined");
+      _mesa_string_buffer_append (out, "defined");
       break;
    case PLACEHOLDER:
       /* Nothing to print. */
@@ -1155,7 +1138,7 @@ _token_print(char **out, size_t *len, token_t *token)
    }
 }
 
-/* Return a new token (ralloc()ed off of 'token') formed by pasting
+/* Return a new token formed by pasting
  * 'token' and 'other'. Note that this function may return 'token' or
  * 'other' directly rather than allocating anything new.
  *
@@ -1179,31 +1162,31 @@ _token_paste(glcpp_parser_t *parser, token_t *token, token_t *other)
    switch (token->type) {
    case '<':
       if (other->type == '<')
-         combined = _token_create_ival (token, LEFT_SHIFT, LEFT_SHIFT);
+         combined = _token_create_ival (parser, LEFT_SHIFT, LEFT_SHIFT);
       else if (other->type == '=')
-         combined = _token_create_ival (token, LESS_OR_EQUAL, LESS_OR_EQUAL);
+         combined = _token_create_ival (parser, LESS_OR_EQUAL, LESS_OR_EQUAL);
       break;
    case '>':
       if (other->type == '>')
-         combined = _token_create_ival (token, RIGHT_SHIFT, RIGHT_SHIFT);
+         combined = _token_create_ival (parser, RIGHT_SHIFT, RIGHT_SHIFT);
       else if (other->type == '=')
-         combined = _token_create_ival (token, GREATER_OR_EQUAL, GREATER_OR_EQUAL);
+         combined = _token_create_ival (parser, GREATER_OR_EQUAL, GREATER_OR_EQUAL);
       break;
    case '=':
       if (other->type == '=')
-         combined = _token_create_ival (token, EQUAL, EQUAL);
+         combined = _token_create_ival (parser, EQUAL, EQUAL);
       break;
    case '!':
       if (other->type == '=')
-         combined = _token_create_ival (token, NOT_EQUAL, NOT_EQUAL);
+         combined = _token_create_ival (parser, NOT_EQUAL, NOT_EQUAL);
       break;
    case '&':
       if (other->type == '&')
-         combined = _token_create_ival (token, AND, AND);
+         combined = _token_create_ival (parser, AND, AND);
       break;
    case '|':
       if (other->type == '|')
-         combined = _token_create_ival (token, OR, OR);
+         combined = _token_create_ival (parser, OR, OR);
       break;
    }
 
@@ -1247,14 +1230,16 @@ _token_paste(glcpp_parser_t *parser, token_t *token, token_t *other)
       }
 
       if (token->type == INTEGER)
-         str = ralloc_asprintf (token, "%" PRIiMAX, token->value.ival);
+         str = linear_asprintf(parser->linalloc, "%" PRIiMAX,
+                               token->value.ival);
       else
-         str = ralloc_strdup (token, token->value.str);
+         str = linear_strdup(parser->linalloc, token->value.str);
 
       if (other->type == INTEGER)
-         ralloc_asprintf_append (&str, "%" PRIiMAX, other->value.ival);
+         linear_asprintf_append(parser->linalloc, &str, "%" PRIiMAX,
+                                other->value.ival);
       else
-         ralloc_strcat (&str, other->value.str);
+         linear_strcat(parser->linalloc, &str, other->value.str);
 
       /* New token is same type as original token, unless we
        * started with an integer, in which case we will be
@@ -1263,18 +1248,18 @@ _token_paste(glcpp_parser_t *parser, token_t *token, token_t *other)
       if (combined_type == INTEGER)
          combined_type = INTEGER_STRING;
 
-      combined = _token_create_str (token, combined_type, str);
+      combined = _token_create_str (parser, combined_type, str);
       combined->location = token->location;
       return combined;
    }
 
     FAIL:
    glcpp_error (&token->location, parser, "");
-   ralloc_asprintf_rewrite_tail (&parser->info_log, &parser->info_log_length, "Pasting \"");
-   _token_print (&parser->info_log, &parser->info_log_length, token);
-   ralloc_asprintf_rewrite_tail (&parser->info_log, &parser->info_log_length, "\" and \"");
-   _token_print (&parser->info_log, &parser->info_log_length, other);
-   ralloc_asprintf_rewrite_tail (&parser->info_log, &parser->info_log_length, "\" does not give a valid preprocessing token.\n");
+   _mesa_string_buffer_append (parser->info_log, "Pasting \"");
+   _token_print (parser->info_log, token);
+   _mesa_string_buffer_append (parser->info_log, "\" and \"");
+   _token_print (parser->info_log, other);
+   _mesa_string_buffer_append (parser->info_log, "\" does not give a valid preprocessing token.\n");
 
    return token;
 }
@@ -1288,7 +1273,7 @@ _token_list_print(glcpp_parser_t *parser, token_list_t *list)
       return;
 
    for (node = list->head; node; node = node->next)
-      _token_print (&parser->output, &parser->output_length, node->token);
+      _token_print (parser->output, node->token);
 }
 
 void
@@ -1306,10 +1291,15 @@ add_builtin_define(glcpp_parser_t *parser, const char *name, int value)
    tok = _token_create_ival (parser, INTEGER, value);
 
    list = _token_list_create(parser);
-   _token_list_append(list, tok);
+   _token_list_append(parser, list, tok);
    _define_object_macro(parser, NULL, name, list);
 }
 
+/* Initial size of the output and info log buffers, 4096 minus the ralloc()
+ * header, which is enough for most shaders without growing.
+ */
+#define INITIAL_PP_OUTPUT_BUF_SIZE 4048
+
 glcpp_parser_t *
 glcpp_parser_create(const struct gl_extensions *extensions, gl_api api)
 {
@@ -1317,9 +1307,12 @@ glcpp_parser_create(const struct gl_extensions *extensions, gl_api api)
 
    parser = ralloc (NULL, glcpp_parser_t);
 
+   parser->linalloc = linear_alloc_parent(parser, 0);
    glcpp_lex_init_extra (parser, &parser->scanner);
    parser->defines = hash_table_ctor(32, hash_table_string_hash,
                                      hash_table_string_compare);
+   parser->define_generation = 1;
+   parser->line_file_expansions = 0;
    parser->active = NULL;
    parser->lexing_directive = 0;
    parser->space_tokens = 1;
@@ -1337,10 +1330,10 @@ glcpp_parser_create(const struct gl_extensions *extensions, gl_api api)
    parser->lex_from_list = NULL;
    parser->lex_from_node = NULL;
 
-   parser->output = ralloc_strdup(parser, "");
-   parser->output_length = 0;
-   parser->info_log = ralloc_strdup(parser, "");
-   parser->info_log_length = 0;
+   parser->output = _mesa_string_buffer_create(parser,
+                                               INITIAL_PP_OUTPUT_BUF_SIZE);
+   parser->info_log = _mesa_string_buffer_create(parser,
+                                                 INITIAL_PP_OUTPUT_BUF_SIZE);
    parser->error = 0;
 
    parser->extensions = extensions;
@@ -1394,7 +1387,8 @@ typedef enum function_status
  *      Macro name is not followed by a balanced set of parentheses.
  */
 static function_status_t
-_arguments_parse(argument_list_t *arguments, token_node_t *node,
+_arguments_parse(glcpp_parser_t *parser,
+                 argument_list_t *arguments, token_node_t *node,
                  token_node_t **last)
 {
    token_list_t *argument;
@@ -1411,8 +1405,8 @@ _arguments_parse(argument_list_t *arguments, token_node_t *node,
 
    node = node->next;
 
-   argument = _token_list_create (arguments);
-   _argument_list_append (arguments, argument);
+   argument = _token_list_create (parser);
+   _argument_list_append (parser, arguments, argument);
 
    for (paren_count = 1; node; node = node->next) {
       if (node->token->type == '(') {
@@ -1425,15 +1419,15 @@ _arguments_parse(argument_list_t *arguments, token_node_t *node,
 
       if (node->token->type == ',' && paren_count == 1) {
          _token_list_trim_trailing_space (argument);
-         argument = _token_list_create (arguments);
-         _argument_list_append (arguments, argument);
+         argument = _token_list_create (parser);
+         _argument_list_append (parser, arguments, argument);
       } else {
          if (argument->head == NULL) {
             /* Don't treat initial whitespace as part of the argument. */
             if (node->token->type == SPACE)
                continue;
          }
-         _token_list_append (argument, node->token);
+         _token_list_append (parser, argument, node->token);
       }
    }
 
@@ -1446,28 +1440,28 @@ _arguments_parse(argument_list_t *arguments, token_node_t *node,
 }
 
 static token_list_t *
-_token_list_create_with_one_ival(void *ctx, int type, int ival)
+_token_list_create_with_one_ival(glcpp_parser_t *parser, int type, int ival)
 {
    token_list_t *list;
    token_t *node;
 
-   list = _token_list_create(ctx);
-   node = _token_create_ival(list, type, ival);
-   _token_list_append(list, node);
+   list = _token_list_create(parser);
+   node = _token_create_ival(parser, type, ival);
+   _token_list_append(parser, list, node);
 
    return list;
 }
 
 static token_list_t *
-_token_list_create_with_one_space(void *ctx)
+_token_list_create_with_one_space(glcpp_parser_t *parser)
 {
-   return _token_list_create_with_one_ival(ctx, SPACE, SPACE);
+   return _token_list_create_with_one_ival(parser, SPACE, SPACE);
 }
 
 static token_list_t *
-_token_list_create_with_one_integer(void *ctx, int ival)
+_token_list_create_with_one_integer(glcpp_parser_t *parser, int ival)
 {
-   return _token_list_create_with_one_ival(ctx, INTEGER, ival);
+   return _token_list_create_with_one_ival(parser, INTEGER, ival);
 }
 
 /* Evaluate a DEFINED token node (based on subsequent tokens in the list).
@@ -1571,8 +1565,8 @@ _glcpp_parser_evaluate_defined_in_list(glcpp_parser_t *parser,
       if (value == -1)
          goto NEXT;
 
-      replacement = ralloc (list, token_node_t);
-      replacement->token = _token_create_ival (list, INTEGER, value);
+      replacement = linear_alloc_child(parser->linalloc, sizeof(token_node_t));
+      replacement->token = _token_create_ival (parser, INTEGER, value);
 
       /* Splice replacement node into list, replacing from "node"
        * through "last". */
@@ -1609,7 +1603,7 @@ _glcpp_parser_expand_and_lex_from(glcpp_parser_t *parser, int head_token_type,
 
    expanded = _token_list_create (parser);
    token = _token_create_ival (parser, head_token_type, head_token_type);
-   _token_list_append (expanded, token);
+   _token_list_append (parser, expanded, token);
    _glcpp_parser_expand_token_list (parser, list, mode);
    _token_list_append_list (expanded, list);
    glcpp_parser_lex_from (parser, expanded);
@@ -1694,7 +1688,7 @@ _glcpp_parser_expand_function(glcpp_parser_t *parser, token_node_t *node,
    assert(macro->is_function);
 
    arguments = _argument_list_create(parser);
-   status = _arguments_parse(arguments, node, last);
+   status = _arguments_parse(parser, arguments, node, last);
 
    switch (status) {
    case FUNCTION_STATUS_SUCCESS:
@@ -1708,7 +1702,6 @@ _glcpp_parser_expand_function(glcpp_parser_t *parser, token_node_t *node,
 
    /* Replace a macro defined as empty with a SPACE token. */
    if (macro->replacements == NULL) {
-      ralloc_free(arguments);
       return _token_list_create_with_one_space(parser);
    }
 
@@ -1725,7 +1718,7 @@ _glcpp_parser_expand_function(glcpp_parser_t *parser, token_node_t *node,
    }
 
    /* Perform argument substitution on the replacement list. */
-   substituted = _token_list_create(arguments);
+   substituted = _token_list_create(parser);
 
    for (node = macro->replacements->head; node; node = node->next) {
       if (node->token->type == IDENTIFIER &&
@@ -1743,12 +1736,12 @@ _glcpp_parser_expand_function(glcpp_parser_t *parser, token_node_t *node,
          } else {
             token_t *new_token;
 
-            new_token = _token_create_ival(substituted, PLACEHOLDER,
+            new_token = _token_create_ival(parser, PLACEHOLDER,
                                            PLACEHOLDER);
-            _token_list_append(substituted, new_token);
+            _token_list_append(parser, substituted, new_token);
          }
       } else {
-         _token_list_append(substituted, node->token);
+         _token_list_append(parser, substituted, node->token);
       }
    }
 
@@ -1798,11 +1791,15 @@ _glcpp_parser_expand_node(glcpp_parser_t *parser, token_node_t *node,
 
    /* Special handling for __LINE__ and __FILE__, (not through
     * the hash table). */
-   if (strcmp(identifier, "__LINE__") == 0)
+   if (strcmp(identifier, "__LINE__") == 0) {
+      parser->line_file_expansions++;
       return _token_list_create_with_one_integer(parser, node->token->location.first_line);
+   }
 
-   if (strcmp(identifier, "__FILE__") == 0)
+   if (strcmp(identifier, "__FILE__") == 0) {
+      parser->line_file_expansions++;
       return _token_list_create_with_one_integer(parser, node->token->location.source);
+   }
 
    /* Look up this identifier in the hash table. */
    macro = hash_table_find(parser->defines, identifier);
@@ -1820,10 +1817,10 @@ _glcpp_parser_expand_node(glcpp_parser_t *parser, token_node_t *node,
       token_list_t *expansion;
       token_t *final;
 
-      str = ralloc_strdup(parser, token->value.str);
+      str = linear_strdup(parser->linalloc, token->value.str);
       final = _token_create_str(parser, OTHER, str);
       expansion = _token_list_create(parser);
-      _token_list_append(expansion, final);
+      _token_list_append(parser, expansion, final);
       return expansion;
    }
 
@@ -1894,6 +1891,83 @@ _parser_active_list_contains(glcpp_parser_t *parser, const char *identifier)
    return 0;
 }
 
+/* Return a copy of the complete expansion of 'node' if it names an
+ * object-like macro whose expansion can be reused, NULL otherwise.
+ *
+ * The expansion is computed on its own, outside of the list containing
+ * 'node', and kept in the macro until the next #define or #undef. It
+ * can only be reused when it doesn't depend on its surroundings, that is
+ * when no macro name is left in it (such as a function-like macro
+ * waiting for its arguments after the expansion), when it doesn't use
+ * __LINE__ or __FILE__, and when expanding it reports nothing.
+ *
+ * This must only be called when no macro is being expanded.
+ */
+static token_list_t *
+_glcpp_parser_expand_object_macro_cached(glcpp_parser_t *parser,
+                                         token_node_t *node)
+{
+   token_list_t *expansion;
+   token_node_t *n, *last;
+   macro_t *macro;
+   uint32_t info_log_length;
+   unsigned line_file_expansions;
+   int error;
+
+   if (node->token->type != IDENTIFIER)
+      return NULL;
+
+   macro = hash_table_find(parser->defines, node->token->value.str);
+   if (macro == NULL || macro->is_function)
+      return NULL;
+
+   if (macro->expansion_generation == parser->define_generation) {
+      if (macro->expansion == NULL)
+         return NULL;
+      return _token_list_copy(parser, macro->expansion);
+   }
+
+   macro->expansion = NULL;
+   macro->expansion_generation = parser->define_generation;
+
+   info_log_length = parser->info_log->length;
+   line_file_expansions = parser->line_file_expansions;
+   error = parser->error;
+
+   expansion = _glcpp_parser_expand_node(parser, node, &last,
+                                         EXPANSION_MODE_IGNORE_DEFINED);
+
+   /* Trailing space would be trimmed below but not in the list. */
+   if (expansion->tail != expansion->non_space_tail)
+      goto UNCACHEABLE;
+
+   _parser_active_list_push(parser, node->token->value.str, NULL);
+   _glcpp_parser_expand_token_list(parser, expansion,
+                                   EXPANSION_MODE_IGNORE_DEFINED);
+   _parser_active_list_pop(parser);
+
+   if (expansion->head == NULL ||
+       parser->info_log->length != info_log_length ||
+       parser->line_file_expansions != line_file_expansions)
+      goto UNCACHEABLE;
+
+   for (n = expansion->head; n; n = n->next) {
+      if (n->token->type == IDENTIFIER &&
+          hash_table_find(parser->defines, n->token->value.str))
+         goto UNCACHEABLE;
+   }
+
+   macro->expansion = expansion;
+   return _token_list_copy(parser, expansion);
+
+ UNCACHEABLE:
+   /* The caller expands the macro again in place, drop any diagnostics
+    * so that they aren't reported twice. */
+   _mesa_string_buffer_truncate(parser->info_log, info_log_length);
+   parser->error = error;
+   return NULL;
+}
+
 /* Walk over the token list replacing nodes with their expansion.
  * Whenever nodes are expanded the walking will walk over the new
  * nodes, continuing to expand as necessary. The results are placed in
@@ -1940,6 +2014,24 @@ _glcpp_parser_expand_token_list(glcpp_parser_t *parser, token_list_t *list,
       while (parser->active && parser->active->marker == node)
          _parser_active_list_pop (parser);
 
+      /* Splice in a reusable expansion, there is nothing left to
+       * expand in it. */
+      if (mode == EXPANSION_MODE_IGNORE_DEFINED && parser->active == NULL) {
+         expansion = _glcpp_parser_expand_object_macro_cached (parser, node);
+         if (expansion) {
+            if (node_prev)
+               node_prev->next = expansion->head;
+            else
+               list->head = expansion->head;
+            expansion->tail->next = node->next;
+            if (node == list->tail)
+               list->tail = expansion->tail;
+            node_prev = expansion->tail;
+            node = node_prev->next;
+            continue;
+         }
+      }
+
       expansion = _glcpp_parser_expand_node (parser, node, &last, mode);
       if (expansion) {
          token_node_t *n;
@@ -2062,24 +2154,24 @@ _define_object_macro(glcpp_parser_t *parser, YYLTYPE *loc,
    if (loc != NULL)
       _check_for_reserved_macro_name(parser, loc, identifier);
 
-   macro = ralloc (parser, macro_t);
+   macro = linear_alloc_child(parser->linalloc, sizeof(macro_t));
 
    macro->is_function = 0;
    macro->parameters = NULL;
-   macro->identifier = ralloc_strdup (macro, identifier);
+   macro->identifier = linear_strdup(parser->linalloc, identifier);
    macro->replacements = replacements;
-   ralloc_steal (macro, replacements);
+   macro->expansion = NULL;
+   macro->expansion_generation = 0;
 
    previous = hash_table_find (parser->defines, identifier);
    if (previous) {
-      if (_macro_equal (macro, previous)) {
-         ralloc_free (macro);
+      if (_macro_equal (macro, previous))
          return;
-      }
       glcpp_error (loc, parser, "Redefinition of macro %s\n",  identifier);
    }
 
    hash_table_insert (parser->defines, macro, identifier);
+   parser->define_generation++;
 }
 
 void
@@ -2097,24 +2189,23 @@ _define_function_macro(glcpp_parser_t *parser, YYLTYPE *loc,
       glcpp_error (loc, parser, "Duplicate macro parameter \"%s\"", dup);
    }
 
-   macro = ralloc (parser, macro_t);
-   ralloc_steal (macro, parameters);
-   ralloc_steal (macro, replacements);
+   macro = linear_alloc_child(parser->linalloc, sizeof(macro_t));
 
    macro->is_function = 1;
    macro->parameters = parameters;
-   macro->identifier = ralloc_strdup (macro, identifier);
+   macro->identifier = linear_strdup(parser->linalloc, identifier);
    macro->replacements = replacements;
+   macro->expansion = NULL;
+   macro->expansion_generation = 0;
    previous = hash_table_find (parser->defines, identifier);
    if (previous) {
-      if (_macro_equal (macro, previous)) {
-         ralloc_free (macro);
+      if (_macro_equal (macro, previous))
          return;
-      }
       glcpp_error (loc, parser, "Redefinition of macro %s\n", identifier);
    }
 
    hash_table_insert(parser->defines, macro, identifier);
+   parser->define_generation++;
 }
 
 static int
@@ -2175,7 +2266,6 @@ glcpp_parser_lex(YYSTYPE *yylval, YYLTYPE *yylloc, glcpp_parser_t *parser)
    node = parser->lex_from_node;
 
    if (node == NULL) {
-      ralloc_free (parser->lex_from_list);
       parser->lex_from_list = NULL;
       return NEWLINE;
    }
@@ -2201,16 +2291,13 @@ glcpp_parser_lex_from(glcpp_parser_t *parser, token_list_t *list)
    for (node = list->head; node; node = node->next) {
       if (node->token->type == SPACE)
          continue;
-      _token_list_append (parser->lex_from_list, node->token);
+      _token_list_append (parser, parser->lex_from_list, node->token);
    }
 
-   ralloc_free (list);
-
    parser->lex_from_node = parser->lex_from_list->head;
 
    /* It's possible the list consisted of nothing but whitespace. */
    if (parser->lex_from_node == NULL) {
-      ralloc_free (parser->lex_from_list);
       parser->lex_from_list = NULL;
    }
 }
@@ -2493,10 +2580,10 @@ _glcpp_parser_handle_version_declaration(glcpp_parser_t *parser, intmax_t versio
       add_builtin_define (parser, "GL_FRAGMENT_PRECISION_HIGH", 1);
 
    if (explicitly_set) {
-      ralloc_asprintf_rewrite_tail(&parser->output, &parser->output_length,
-                                   "#version %" PRIiMAX "%s%s", version,
-                                   es_identifier ? " " : "",
-                                   es_identifier ? es_identifier : "");
+      _mesa_string_buffer_printf(parser->output,
+                                 "#version %" PRIiMAX "%s%s", version,
+                                 es_identifier ? " " : "",
+                                 es_identifier ? es_identifier : "");
    }
 }
 
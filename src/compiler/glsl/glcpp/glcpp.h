@@ -30,6 +30,7 @@
 #include "main/mtypes.h"
 
 #include "util/ralloc.h"
+#include "util/string_buffer.h"
 
 #include "program/hash_table.h"
 
@@ -144,6 +145,13 @@ typedef struct {
 	string_list_t *parameters;
 	const char *identifier;
 	token_list_t *replacements;
+
+	/* Complete expansion of an object-like macro, see
+	 * _glcpp_parser_expand_object_macro_cached(). It is valid while
+	 * expansion_generation matches the parser's define_generation,
+	 * and NULL then means that the expansion can't be reused. */
+	token_list_t *expansion;
+	unsigned expansion_generation;
 } macro_t;
 
 typedef struct expansion_node {
@@ -172,8 +180,11 @@ typedef struct active_list {
 } active_list_t;
 
 struct glcpp_parser {
+	void *linalloc;
 	yyscan_t scanner;
 	struct hash_table *defines;
+	unsigned define_generation;
+	unsigned line_file_expansions;
 	active_list_t *active;
 	int lexing_directive;
 	int lexing_version_directive;
@@ -189,10 +200,8 @@ struct glcpp_parser {
 	int skipping;
 	token_list_t *lex_from_list;
 	token_node_t *lex_from_node;
-	char *output;
-	char *info_log;
-	size_t output_length;
-	size_t info_log_length;
+	struct _mesa_string_buffer *output;
+	struct _mesa_string_buffer *info_log;
 	int error;
 	const struct gl_extensions *extensions;
 	gl_api api;
@@ -32,20 +32,16 @@ glcpp_error (YYLTYPE *locp, glcpp_parser_t *parser, const char *fmt, ...)
 	va_list ap;
 
 	parser->error = 1;
-	ralloc_asprintf_rewrite_tail(&parser->info_log,
-				     &parser->info_log_length,
-				     "%u:%u(%u): "
-				     "preprocessor error: ",
-				     locp->source,
-				     locp->first_line,
-				     locp->first_column);
+	_mesa_string_buffer_printf(parser->info_log,
+				   "%u:%u(%u): "
+				   "preprocessor error: ",
+				   locp->source,
+				   locp->first_line,
+				   locp->first_column);
 	va_start(ap, fmt);
-	ralloc_vasprintf_rewrite_tail(&parser->info_log,
-				      &parser->info_log_length,
-				      fmt, ap);
+	_mesa_string_buffer_vprintf(parser->info_log, fmt, ap);
 	va_end(ap);
-	ralloc_asprintf_rewrite_tail(&parser->info_log,
-				     &parser->info_log_length, "\n");
+	_mesa_string_buffer_append(parser->info_log, "\n");
 }
 
 void
@@ -53,20 +49,16 @@ glcpp_warning (YYLTYPE *locp, glcpp_parser_t *parser, const char *fmt, ...)
 {
 	va_list ap;
 
-	ralloc_asprintf_rewrite_tail(&parser->info_log,
-				     &parser->info_log_length,
-				     "%u:%u(%u): "
-				     "preprocessor warning: ",
-				     locp->source,
-				     locp->first_line,
-				     locp->first_column);
+	_mesa_string_buffer_printf(parser->info_log,
+				   "%u:%u(%u): "
+				   "preprocessor warning: ",
+				   locp->source,
+				   locp->first_line,
+				   locp->first_column);
 	va_start(ap, fmt);
-	ralloc_vasprintf_rewrite_tail(&parser->info_log,
-				      &parser->info_log_length,
-				      fmt, ap);
+	_mesa_string_buffer_vprintf(parser->info_log, fmt, ap);
 	va_end(ap);
-	ralloc_asprintf_rewrite_tail(&parser->info_log,
-				     &parser->info_log_length, "\n");
+	_mesa_string_buffer_append(parser->info_log, "\n");
 }
 
 /* Given str, (that's expected to start with a newline terminator of some
@@ -107,16 +99,22 @@ skip_newline (const char *str)
 
 /* Remove any line continuation characters in the shader, (whether in
  * preprocessing directives or in GLSL code).
+ *
+ * A shader without any backslash is returned as is, without a copy.
  */
-static char *
+static const char *
 remove_line_continuations(glcpp_parser_t *ctx, const char *shader)
 {
-	char *clean = ralloc_strdup(ctx, "");
+	struct _mesa_string_buffer *clean;
 	const char *backslash, *newline, *search_start;
         const char *cr, *lf;
         char newline_separator[3];
 	int collapsed_newlines = 0;
 
+	if (strchr(shader, '\\') == NULL)
+		return shader;
+
+	clean = _mesa_string_buffer_create(ctx, strlen(shader));
 	search_start = shader;
 
 	/* Determine what flavor of newlines this shader is using. GLSL
@@ -165,21 +163,15 @@ remove_line_continuations(glcpp_parser_t *ctx, const char *shader)
 		 * line numbers.
 		 */
 		if (collapsed_newlines) {
-			cr = strchr (search_start, '\r');
-			lf = strchr (search_start, '\n');
-			if (cr && lf)
-				newline = cr < lf ? cr : lf;
-			else if (cr)
-				newline = cr;
-			else
-				newline = lf;
-			if (newline &&
+			newline = search_start + strcspn(search_start, "\r\n");
+			if (*newline &&
 			    (backslash == NULL || newline < backslash))
 			{
-				ralloc_strncat(&clean, shader,
-					       newline - shader + 1);
+				_mesa_string_buffer_append_len(clean, shader,
+							       newline - shader + 1);
 				while (collapsed_newlines) {
-					ralloc_strcat(&clean, newline_separator);
+					_mesa_string_buffer_append(clean,
+								   newline_separator);
 					collapsed_newlines--;
 				}
 				shader = skip_newline (newline);
@@ -200,15 +192,16 @@ remove_line_continuations(glcpp_parser_t *ctx, const char *shader)
 		if (backslash[1] == '\r' || backslash[1] == '\n')
 		{
 			collapsed_newlines++;
-			ralloc_strncat(&clean, shader, backslash - shader);
+			_mesa_string_buffer_append_len(clean, shader,
+						       backslash - shader);
 			shader = skip_newline (backslash + 1);
 			search_start = shader;
 		}
 	}
 
-	ralloc_strcat(&clean, shader);
+	_mesa_string_buffer_append(clean, shader);
 
-	return clean;
+	return clean->buf;
 }
 
 int
@@ -230,10 +223,10 @@ glcpp_preprocess(void *ralloc_ctx, const char **shader, char **info_log,
 
 	glcpp_parser_resolve_implicit_version(parser);
 
-	ralloc_strcat(info_log, parser->info_log);
+	ralloc_strcat(info_log, parser->info_log->buf);
 
-	ralloc_steal(ralloc_ctx, parser->output);
-	*shader = parser->output;
+	ralloc_steal(ralloc_ctx, parser->output->buf);
+	*shader = parser->output->buf;
 
 	errors = parser->error;
 	glcpp_parser_destroy (parser);
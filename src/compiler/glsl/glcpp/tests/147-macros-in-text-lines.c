@@ -0,0 +1,15 @@
+#define FOO 1
+  int   a = FOO ;	 
+float b = 1e+FOO;
+   
+int c = __LINE__;
+#define F(x) (x + FOO)
+int d = F
+(2);
+int e = BAR;
+#define BAR FOO * 2
+int f = BAR, g = BAR;
+#undef FOO
+int h = BAR;
+#define FOO 3
+int i = BAR;
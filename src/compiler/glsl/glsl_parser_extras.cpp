@@ -29,13 +29,16 @@
 #include "main/context.h"
 #include "main/debug_output.h"
 #include "main/shaderobj.h"
-#include "util/u_atomic.h" /* for p_atomic_cmpxchg */
+#include "util/u_atomic.h" /* for p_atomic_cmpxchg, p_atomic_inc_return */
 #include "util/ralloc.h"
+#include "util/debug.h"
+#include "util/os_time.h"
 #include "ast.h"
 #include "glsl_parser_extras.h"
 #include "glsl_parser.h"
 #include "ir_optimization.h"
 #include "loop_analysis.h"
+#include "shader_cache.h"
 
 /**
  * Format a short human-readable description of the given GLSL version.
@@ -62,6 +65,7 @@ _mesa_glsl_parse_state::_mesa_glsl_parse_state(struct gl_context *_ctx,
    this->stage = stage;
 
    this->scanner = NULL;
+   this->linalloc = linear_alloc_parent(this, 0);
    this->translation_unit.make_empty();
    this->symbols = new(mem_ctx) glsl_symbol_table;
 
@@ -260,12 +264,12 @@ _mesa_glsl_parse_state::_mesa_glsl_parse_state(struct gl_context *_ctx,
    if (ctx->Const.ForceGLSLExtensionsWarn)
       _mesa_glsl_process_extension("all", NULL, "warn", NULL, this);
 
-   this->default_uniform_qualifier = new(this) ast_type_qualifier();
+   this->default_uniform_qualifier = new(this->linalloc) ast_type_qualifier();
    this->default_uniform_qualifier->flags.q.shared = 1;
    this->default_uniform_qualifier->flags.q.column_major = 1;
    this->default_uniform_qualifier->is_default_qualifier = true;
 
-   this->default_shader_storage_qualifier = new(this) ast_type_qualifier();
+   this->default_shader_storage_qualifier = new(this->linalloc) ast_type_qualifier();
    this->default_shader_storage_qualifier->flags.q.shared = 1;
    this->default_shader_storage_qualifier->flags.q.column_major = 1;
    this->default_shader_storage_qualifier->is_default_qualifier = true;
@@ -279,8 +283,8 @@ _mesa_glsl_parse_state::_mesa_glsl_parse_state(struct gl_context *_ctx,
    this->gs_input_prim_type_specified = false;
    this->tcs_output_vertices_specified = false;
    this->gs_input_size = 0;
-   this->in_qualifier = new(this) ast_type_qualifier();
-   this->out_qualifier = new(this) ast_type_qualifier();
+   this->in_qualifier = new(this->linalloc) ast_type_qualifier();
+   this->out_qualifier = new(this->linalloc) ast_type_qualifier();
    this->fs_early_fragment_tests = false;
    memset(this->atomic_counter_offsets, 0,
           sizeof(this->atomic_counter_offsets));
@@ -1586,19 +1590,15 @@ ast_struct_specifier::print(void) const
 }
 
 
-ast_struct_specifier::ast_struct_specifier(const char *identifier,
+ast_struct_specifier::ast_struct_specifier(void *lin_ctx,
+					   const char *identifier,
 					   ast_declarator_list *declarator_list)
 {
    if (identifier == NULL) {
-      static mtx_t mutex = _MTX_INITIALIZER_NP;
-      static unsigned anon_count = 1;
-      unsigned count;
+      static unsigned anon_count = 0;
+      const unsigned count = p_atomic_inc_return(&anon_count);
 
-      mtx_lock(&mutex);
-      count = anon_count++;
-      mtx_unlock(&mutex);
-
-      identifier = ralloc_asprintf(this, "#anon_struct_%04x", count);
+      identifier = linear_asprintf(lin_ctx, "#anon_struct_%04x", count);
    }
    name = identifier;
    this->declarations.push_degenerate_list_at_head(&declarator_list->link);
@@ -1789,12 +1789,30 @@ assign_subroutine_indexes(struct gl_shader *sh,
 
 void
 _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
-                          bool dump_ast, bool dump_hir)
+                          bool dump_ast, bool dump_hir, bool force_recompile)
 {
+   if (!force_recompile && shader_cache_lookup_shader(ctx, shader)) {
+      /* The shader compiled and linked before.  Defer compiling it until
+       * its program misses the shader cache, which usually never happens.
+       */
+      ralloc_free(shader->ir);
+      shader->ir = NULL;
+      shader->symbols = NULL;
+
+      ralloc_free(shader->InfoLog);
+      shader->InfoLog = ralloc_strdup(shader, "");
+
+      shader->CompileStatus = true;
+      shader->CompileSkipped = true;
+      return;
+   }
+
    struct _mesa_glsl_parse_state *state =
       new(shader) _mesa_glsl_parse_state(ctx, shader->Stage, shader);
    const char *source = shader->Source;
 
+   shader->CompileSkipped = false;
+
    if (ctx->Const.GenerateTemporaryNames)
       (void) p_atomic_cmpxchg(&ir_variable::temporaries_allocate_names,
                               false, true);
@@ -1839,8 +1857,9 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
       /* Do some optimization at compile time to reduce shader IR size
        * and reduce later work if the same shader is linked multiple times
        */
+      opt_pass_manager pm;
       while (do_common_optimization(shader->ir, false, false, options,
-                                    ctx->Const.NativeIntegers))
+                                    ctx->Const.NativeIntegers, &pm))
          ;
 
       validate_ir_tree(shader->ir);
@@ -1916,6 +1935,104 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
 }
 
 } /* extern "C" */
+
+static bool opt_stats;
+static once_flag opt_stats_once = ONCE_FLAG_INIT;
+
+static void
+read_opt_stats(void)
+{
+   opt_stats = env_var_as_boolean("GLSL_OPT_STATS", false);
+}
+
+opt_pass_manager::opt_pass_manager()
+   : rounds(0), generation(1), num_passes(0)
+{
+   call_once(&opt_stats_once, read_opt_stats);
+   this->stats = opt_stats;
+   memset(this->passes, 0, sizeof(this->passes));
+}
+
+opt_pass_manager::~opt_pass_manager()
+{
+   if (!this->stats || this->num_passes == 0)
+      return;
+
+   fprintf(stderr, "GLSL optimization statistics, %u rounds:\n", this->rounds);
+   fprintf(stderr, "   %-32s %6s %6s %8s %10s\n",
+           "pass", "runs", "skips", "progress", "time (us)");
+
+   uint64_t total = 0;
+   for (unsigned i = 0; i < this->num_passes; i++) {
+      fprintf(stderr, "   %-32s %6u %6u %8u %10.1f\n",
+              this->passes[i].name, this->passes[i].runs,
+              this->passes[i].skips, this->passes[i].progress,
+              this->passes[i].nsecs / 1000.0);
+      total += this->passes[i].nsecs;
+   }
+   fprintf(stderr, "   %-32s %33.1f\n", "total", total / 1000.0);
+}
+
+/**
+ * Returns whether \c pass has to run, or whether it is known to make no
+ * progress because it didn't the last time and the IR hasn't changed since.
+ *
+ * Passes are numbered in the order do_common_optimization() calls them,
+ * which is the same for every call with the same arguments.
+ */
+bool
+opt_pass_manager::should_run(unsigned pass, const char *name)
+{
+   assert(pass < MAX_PASSES);
+
+   if (pass >= this->num_passes) {
+      assert(pass == this->num_passes);
+      this->passes[pass].name = name;
+      this->num_passes++;
+   }
+   assert(strcmp(this->passes[pass].name, name) == 0);
+
+   if (this->passes[pass].clean_generation == this->generation) {
+      this->passes[pass].skips++;
+      return false;
+   }
+
+   return true;
+}
+
+void
+opt_pass_manager::ran(unsigned pass, bool progress, uint64_t nsecs)
+{
+   this->passes[pass].runs++;
+   this->passes[pass].nsecs += nsecs;
+
+   if (progress) {
+      this->passes[pass].progress++;
+      this->generation++;
+   } else {
+      this->passes[pass].clean_generation = this->generation;
+   }
+}
+
+/**
+ * Loop analysis is only used by these two passes, run it along with them.
+ */
+static bool
+do_loop_optimizations(exec_list *ir,
+                      const struct gl_shader_compiler_options *options)
+{
+   bool progress = false;
+
+   loop_state *ls = analyze_loop_variables(ir);
+   if (ls->loop_found) {
+      progress = set_loop_controls(ir, ls) || progress;
+      progress = unroll_loops(ir, ls, options) || progress;
+   }
+   delete ls;
+
+   return progress;
+}
+
 /**
  * Do the set of common optimizations passes
  *
@@ -1933,30 +2050,52 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
  *                                    unrolled.  Setting to 0 disables loop
  *                                    unrolling.
  * \param options                     The driver's preferred shader options.
+ * \param pm                          Pass manager shared by the calls of an
+ *                                    optimization loop, or \c NULL to run
+ *                                    every pass.
  */
 bool
 do_common_optimization(exec_list *ir, bool linked,
 		       bool uniform_locations_assigned,
                        const struct gl_shader_compiler_options *options,
-                       bool native_integers)
+                       bool native_integers,
+                       opt_pass_manager *pm)
 {
    const bool debug = false;
    GLboolean progress = GL_FALSE;
+   unsigned pass_index = 0;
 
-#define OPT(PASS, ...) do {                                             \
-      if (debug) {                                                      \
+   if (pm)
+      pm->rounds++;
+
+   /* Changes made by passes that don't count as progress still have to be
+    * reported to the pass manager, so that it doesn't skip the passes that
+    * they enable.
+    */
+#define RUN_PASS(IS_PROGRESS, PASS, ...) do {                           \
+      const unsigned pass = pass_index++;                               \
+      if (pm && !pm->should_run(pass, #PASS))                           \
+         break;                                                         \
+      const int64_t start = pm && pm->stats ? os_time_get_nano() : 0;   \
+      if (debug)                                                        \
          fprintf(stderr, "START GLSL optimization %s\n", #PASS);        \
-         const bool opt_progress = PASS(__VA_ARGS__);                   \
+      const bool opt_progress = PASS(__VA_ARGS__);                      \
+      if (IS_PROGRESS)                                                  \
          progress = opt_progress || progress;                           \
+      if (debug) {                                                      \
          if (opt_progress)                                              \
             _mesa_print_ir(stderr, ir, NULL);                           \
          fprintf(stderr, "GLSL optimization %s: %s progress\n",         \
                  #PASS, opt_progress ? "made" : "no");                  \
-      } else {                                                          \
-         progress = PASS(__VA_ARGS__) || progress;                      \
+      }                                                                 \
+      if (pm) {                                                         \
+         pm->ran(pass, opt_progress,                                    \
+                 pm->stats ? os_time_get_nano() - start : 0);           \
       }                                                                 \
    } while (false)
 
+#define OPT(PASS, ...) RUN_PASS(true, PASS, __VA_ARGS__)
+
    OPT(lower_instructions, ir, SUB_TO_ADD_NEG);
 
    if (linked) {
@@ -1964,7 +2103,7 @@ do_common_optimization(exec_list *ir, bool linked,
       OPT(do_dead_functions, ir);
       OPT(do_structure_splitting, ir);
    }
-   propagate_invariance(ir);
+   RUN_PASS(false, propagate_invariance, ir);
    OPT(do_if_simplification, ir);
    OPT(opt_flatten_nested_if_blocks, ir);
    OPT(opt_conditional_discard, ir);
@@ -2002,14 +2141,10 @@ do_common_optimization(exec_list *ir, bool linked,
    OPT(optimize_split_arrays, ir, linked);
    OPT(optimize_redundant_jumps, ir);
 
-   loop_state *ls = analyze_loop_variables(ir);
-   if (ls->loop_found) {
-      OPT(set_loop_controls, ir, ls);
-      OPT(unroll_loops, ir, ls, options);
-   }
-   delete ls;
+   OPT(do_loop_optimizations, ir, options);
 
 #undef OPT
+#undef RUN_PASS
 
    return progress;
 }
@@ -294,6 +294,12 @@ struct _mesa_glsl_parse_state {
 
    struct gl_context *const ctx;
    void *scanner;
+
+   /**
+    * Linear allocator used for the AST and for the strings returned by the
+    * lexer.  Everything allocated from it is released with the parse state.
+    */
+   void *linalloc;
    exec_list translation_unit;
    glsl_symbol_table *symbols;
 
@@ -592,7 +592,8 @@ public:
 
    inline bool is_name_ralloced() const
    {
-      return this->name != ir_variable::tmp_name;
+      return this->name != ir_variable::tmp_name &&
+             this->name != this->name_storage;
    }
 
    /**
@@ -972,6 +973,13 @@ private:
     */
    static const char tmp_name[];
 
+   /**
+    * Inline storage for short variable names
+    *
+    * Most names fit here, which saves a ralloc allocation per variable.
+    */
+   char name_storage[16];
+
 public:
    /**
     * Should the construct keep names for ir_var_temporary variables?
@@ -28,6 +28,11 @@
  * Prototypes for optimization passes to be called by the compiler and drivers.
  */
 
+#ifndef GLSL_IR_OPTIMIZATION_H
+#define GLSL_IR_OPTIMIZATION_H
+
+#include <stdint.h>
+
 /* Operations for lower_instructions() */
 #define SUB_TO_ADD_NEG     0x01
 #define DIV_TO_MUL_RCP     0x02
@@ -68,10 +73,76 @@ enum lower_packing_builtins_op {
    LOWER_PACK_USE_BFE                   = 0x0800,
 };
 
+/**
+ * Schedules the passes of do_common_optimization() across calls.
+ *
+ * Most passes find nothing to do after the first round of the
+ * \c while (do_common_optimization(...)) loops, but each round still walks
+ * the whole IR once per pass.  The pass manager keeps a generation number
+ * that is bumped whenever any pass changes the IR, and remembers the
+ * generation at which each pass last ran without making progress.  A pass
+ * is skipped as long as the IR hasn't changed since then, which yields
+ * exactly the same IR as running it.  This relies on every pass returning
+ * true whenever it changes the IR, so new passes have to be careful about
+ * that too.
+ *
+ * Passes run by the caller between two calls of do_common_optimization()
+ * must report their progress through track().
+ *
+ * Setting the GLSL_OPT_STATS environment variable prints the number of
+ * runs, skips and progress and the time spent per pass when the manager is
+ * destroyed.
+ */
+class opt_pass_manager {
+public:
+   opt_pass_manager();
+   ~opt_pass_manager();
+
+   /**
+    * Notes the progress of a pass that isn't run by
+    * do_common_optimization() and returns it.
+    */
+   bool track(bool progress)
+   {
+      if (progress)
+         generation++;
+      return progress;
+   }
+
+   bool should_run(unsigned pass, const char *name);
+   void ran(unsigned pass, bool progress, uint64_t nsecs);
+
+   /** Whether per-pass timing should be collected. */
+   bool stats;
+
+   /** Number of do_common_optimization() calls. */
+   unsigned rounds;
+
+private:
+   enum { MAX_PASSES = 32 };
+
+   unsigned generation;
+
+   struct {
+      const char *name;
+
+      /** Generation of the last run that made no progress, 0 if none. */
+      unsigned clean_generation;
+
+      unsigned runs;
+      unsigned skips;
+      unsigned progress;
+      uint64_t nsecs;
+   } passes[MAX_PASSES];
+
+   unsigned num_passes;
+};
+
 bool do_common_optimization(exec_list *ir, bool linked,
 			    bool uniform_locations_assigned,
                             const struct gl_shader_compiler_options *options,
-                            bool native_integers);
+                            bool native_integers,
+                            opt_pass_manager *pm = NULL);
 
 bool ir_constant_fold(ir_rvalue **rvalue);
 
@@ -141,8 +212,10 @@ bool lower_tess_level(gl_shader *shader);
 bool lower_vertex_id(gl_shader *shader);
 
 bool lower_subroutine(exec_list *instructions, struct _mesa_glsl_parse_state *state);
-void propagate_invariance(exec_list *instructions);
+bool propagate_invariance(exec_list *instructions);
 
 ir_rvalue *
 compare_index_block(exec_list *instructions, ir_variable *index,
 		    unsigned base, unsigned components, void *mem_ctx);
+
+#endif /* GLSL_IR_OPTIMIZATION_H */
@@ -310,8 +310,15 @@ find_matching_signature(const char *name, const exec_list *actual_parameters,
 			gl_shader **shader_list, unsigned num_shaders,
 			bool use_builtin)
 {
+   gl_shader *const builtins = _mesa_glsl_get_builtin_function_shader();
+
    for (unsigned i = 0; i < num_shaders; i++) {
-      ir_function *const f = shader_list[i]->symbols->get_function(name);
+      /* Built-in functions are generated on demand, look them up under the
+       * built-in module's lock.
+       */
+      ir_function *const f = shader_list[i] == builtins ?
+         _mesa_glsl_find_builtin_function_by_name(name) :
+         shader_list[i]->symbols->get_function(name);
 
       if (f == NULL)
 	 continue;
@@ -1005,6 +1005,8 @@ link_assign_uniform_locations(struct gl_shader_program *prog,
    ralloc_free(prog->UniformStorage);
    prog->UniformStorage = NULL;
    prog->NumUniformStorage = 0;
+   prog->UniformDataSlots = NULL;
+   prog->NumUniformDataSlots = 0;
 
    if (prog->UniformHash != NULL) {
       prog->UniformHash->clear();
@@ -1266,6 +1268,8 @@ link_assign_uniform_locations(struct gl_shader_program *prog,
    prog->NumUniformStorage = num_uniforms;
    prog->NumHiddenUniforms = hidden_uniforms;
    prog->UniformStorage = uniforms;
+   prog->NumUniformDataSlots = num_data_slots;
+   prog->UniformDataSlots = data;
 
    link_set_uniform_initializers(prog, boolean_true);
 
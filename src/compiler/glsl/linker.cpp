@@ -4762,9 +4762,10 @@ link_shaders(struct gl_context *ctx, struct gl_shader_program *prog)
          lower_tess_level(prog->_LinkedShaders[i]);
       }
 
+      opt_pass_manager pm;
       while (do_common_optimization(prog->_LinkedShaders[i]->ir, true, false,
                                     &ctx->Const.ShaderCompilerOptions[i],
-                                    ctx->Const.NativeIntegers))
+                                    ctx->Const.NativeIntegers, &pm))
 	 ;
 
       lower_const_arrays_to_uniforms(prog->_LinkedShaders[i]->ir);
@@ -346,6 +346,7 @@ struct ir_lower_jumps_visitor : public ir_control_flow_visitor {
       }
       insert_lowered_return((ir_return*)ir);
       ir->replace_with(new(ir) ir_loop_jump(ir_loop_jump::jump_break));
+      this->progress = true;
    }
 
    /**
@@ -373,6 +374,7 @@ struct ir_lower_jumps_visitor : public ir_control_flow_visitor {
          return;
       }
       ir->replace_with(create_lowered_break());
+      this->progress = true;
    }
 
    /**
@@ -869,6 +871,7 @@ lower_continue:
          = (ir_instruction *) ir->body_instructions.get_tail();
       if (get_jump_strength(ir_last) == strength_continue) {
          ir_last->remove();
+         this->progress = true;
       }
 
       /* If the loop ends in an unconditional return, and we are
@@ -984,6 +987,7 @@ lower_continue:
          ir_jump *jump = (ir_jump *) ir->body.get_tail();
          assert (jump->ir_type == ir_type_return);
          jump->remove();
+         this->progress = true;
       }
 
       if(this->function.return_value)
@@ -195,6 +195,7 @@ ir_constant_folding_visitor::visit_enter(ir_call *ir)
       ir_assignment *assignment =
 	 new(ralloc_parent(ir)) ir_assignment(ir->return_deref, const_val);
       ir->replace_with(assignment);
+      this->progress = true;
    }
 
    return visit_continue_with_parent;
@@ -425,6 +425,10 @@ ir_minmax_visitor::prune_expression(ir_expression *expr, minmax_range baserange)
             limits[1 - i].high = NULL;
          minmax_range base = range_intersection(limits[1 - i], baserange);
          expr->operands[i] = prune_expression(op_expr, base);
+
+         /* Constants combined below the root don't replace it. */
+         if (expr->operands[i] != op_expr)
+            progress = true;
       }
    }
 
@@ -146,6 +146,12 @@ struct is_reduction_data {
    bool contains_constant;
 };
 
+struct tree_shape {
+   ir_expression **exprs;
+   ir_rvalue **operands;
+   unsigned num_expr;
+};
+
 } /* anonymous namespace */
 
 ir_visitor_status
@@ -256,8 +262,36 @@ is_reduction(ir_instruction *ir, void *data)
    }
 }
 
+static void
+save_shape(ir_instruction *ir, void *data)
+{
+   struct tree_shape *shape = (struct tree_shape *)data;
+   ir_expression *expr = ir->as_expression();
+   if (!expr)
+      return;
+
+   shape->exprs[shape->num_expr] = expr;
+   shape->operands[2 * shape->num_expr] = expr->operands[0];
+   shape->operands[2 * shape->num_expr + 1] = expr->operands[1];
+   shape->num_expr++;
+}
+
+/* Rebalancing reuses the nodes of the tree, so it changed the tree iff it
+ * changed the operands of one of them.
+ */
+static bool
+shape_changed(const struct tree_shape *shape)
+{
+   for (unsigned i = 0; i < shape->num_expr; i++) {
+      if (shape->exprs[i]->operands[0] != shape->operands[2 * i] ||
+          shape->exprs[i]->operands[1] != shape->operands[2 * i + 1])
+         return true;
+   }
+   return false;
+}
+
 static ir_rvalue *
-handle_expression(ir_expression *expr)
+handle_expression(ir_expression *expr, bool *progress)
 {
    struct is_reduction_data ird;
    ird.operation = (ir_expression_operation)0;
@@ -271,11 +305,20 @@ handle_expression(ir_expression *expr)
    if (ird.is_reduction && ird.num_expr > 2) {
       ir_constant z = ir_constant(0.0f);
       ir_expression pseudo_root = ir_expression(ir_binop_add, &z, expr);
+      struct tree_shape shape;
+
+      shape.exprs = ralloc_array(NULL, ir_expression *, ird.num_expr);
+      shape.operands = ralloc_array(shape.exprs, ir_rvalue *,
+                                    2 * ird.num_expr);
+      shape.num_expr = 0;
+      visit_tree(expr, save_shape, &shape);
 
       unsigned size = tree_to_vine(&pseudo_root);
       vine_to_tree(&pseudo_root, size);
 
       expr = (ir_expression *)pseudo_root.operands[1];
+      *progress = shape_changed(&shape);
+      ralloc_free(shape.exprs);
    }
    return expr;
 }
@@ -306,18 +349,18 @@ ir_rebalance_visitor::handle_rvalue(ir_rvalue **rvalue)
    if (!expr || !is_reduction_operation(expr->operation))
       return;
 
-   ir_rvalue *new_rvalue = handle_expression(expr);
+   bool changed = false;
+   ir_rvalue *new_rvalue = handle_expression(expr, &changed);
 
    /* If we failed to rebalance the tree (e.g., because it wasn't a reduction,
-    * or some other set of cases) new_rvalue will point to the same root as
-    * before.
+    * or some other set of cases) nothing changed.
     *
     * Similarly, if the tree rooted at *rvalue was a reduction and was already
     * balanced, the algorithm will rearrange the tree but will ultimately
-    * return an identical tree, so this check will handle that as well and
-    * will not set progress = true.
+    * return an identical tree.  Rebalancing can also keep the root but
+    * reshape the subtrees below it, which is progress all the same.
     */
-   if (new_rvalue == *rvalue)
+   if (!changed)
       return;
 
    visit_tree(new_rvalue, NULL, NULL, update_types);
@@ -338,7 +338,10 @@ try_tree_grafting(ir_assignment *start,
 	 return v.progress;
    }
 
-   return false;
+   /* ir_expression::accept() doesn't pass visit_stop on from its operands,
+    * so a graft into a nested expression ends up here.
+    */
+   return v.progress;
 }
 
 static void
@@ -113,13 +113,21 @@ ir_invariance_propagation_visitor::visit(ir_dereference_variable *ir)
    return visit_continue;
 }
 
-void
+/**
+ * \return
+ * Whether any variable was made invariant or precise.
+ */
+bool
 propagate_invariance(exec_list *instructions)
 {
    ir_invariance_propagation_visitor visitor;
+   bool progress = false;
 
    do {
       visitor.progress = false;
       visit_list_elements(&visitor, instructions);
+      progress = visitor.progress || progress;
    } while (visitor.progress);
+
+   return progress;
 }
@@ -0,0 +1,1715 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file serialize.cpp
+ *
+ * Serialization of linked GLSL programs.
+ *
+ * The encoding mirrors the in-memory data structures closely and contains
+ * raw copies of some of them, so it can only be read back by the build of
+ * Mesa that wrote it.  Users such as the shader cache must make sure of that.
+ */
+
+#include "main/core.h"
+#include "main/shaderobj.h"
+#include "ir.h"
+#include "ir_hierarchical_visitor.h"
+#include "ir_uniform.h"
+#include "blob.h"
+#include "serialize.h"
+#include "program/hash_table.h"
+#include "util/hash_table.h"
+
+/** Marker for a NULL type, instruction or variable reference. */
+#define ENCODED_NULL 0xffffffffu
+
+/** Markers for special entries in the uniform remap tables. */
+#define REMAP_NULL     0xffffffffu
+#define REMAP_INACTIVE 0xfffffffeu
+
+static void
+write_ptr_index(struct blob *blob, const void *ptr, const void *base,
+                size_t size)
+{
+   blob_write_uint32(blob, ((const char *) ptr - (const char *) base) / size);
+}
+
+/**
+ * Built-in function signatures only keep their availability predicate for
+ * the benefit of the compiler.  After linking it only matters whether a
+ * signature is a built-in at all.
+ */
+static bool
+builtin_always_available(const _mesa_glsl_parse_state *)
+{
+   return true;
+}
+
+namespace {
+
+enum signature_flags {
+   SIGNATURE_DEFINED   = 1 << 0,
+   SIGNATURE_INTRINSIC = 1 << 1,
+   SIGNATURE_BUILTIN   = 1 << 2,
+};
+
+/**
+ * Collects every function that a list of IR depends on: the functions
+ * declared at the top level and the callees of all ir_calls, which can
+ * belong to functions that are not in the list (intrinsics, for instance).
+ */
+class function_collector : public ir_hierarchical_visitor {
+public:
+   function_collector(void *mem_ctx, struct hash_table *ids)
+      : mem_ctx(mem_ctx), ids(ids), functions(NULL), num_functions(0)
+   {
+   }
+
+   void add(ir_function *f)
+   {
+      if (_mesa_hash_table_search(ids, f) != NULL)
+         return;
+
+      _mesa_hash_table_insert(ids, f, (void *) (intptr_t) num_functions);
+      functions = reralloc(mem_ctx, functions, ir_function *,
+                           num_functions + 1);
+      functions[num_functions++] = f;
+
+      /* Callees may themselves contain calls. */
+      f->accept(this);
+   }
+
+   virtual ir_visitor_status visit_enter(ir_call *ir)
+   {
+      add((ir_function *) ir->callee->function());
+      return visit_continue;
+   }
+
+   void *mem_ctx;
+   struct hash_table *ids;
+   ir_function **functions;
+   unsigned num_functions;
+};
+
+class ir_serializer {
+public:
+   ir_serializer(struct blob *blob);
+   ~ir_serializer();
+
+   void write_shader_ir(exec_list *ir);
+   void write_ir_list(exec_list *list);
+
+private:
+   void write_ir(ir_instruction *ir);
+   void write_variable_ref(ir_variable *var);
+   void write_variable(ir_variable *var);
+   void write_signature_ref(const ir_function_signature *sig);
+   uint32_t function_id(ir_function *f);
+
+   struct blob *blob;
+   void *mem_ctx;
+   struct hash_table *variables;
+   struct hash_table *signatures;
+   struct hash_table *functions;
+   uint32_t num_variables;
+};
+
+ir_serializer::ir_serializer(struct blob *blob)
+   : blob(blob), num_variables(0)
+{
+   mem_ctx = ralloc_context(NULL);
+   variables = _mesa_hash_table_create(mem_ctx, _mesa_hash_pointer,
+                                       _mesa_key_pointer_equal);
+   signatures = _mesa_hash_table_create(mem_ctx, _mesa_hash_pointer,
+                                        _mesa_key_pointer_equal);
+   functions = _mesa_hash_table_create(mem_ctx, _mesa_hash_pointer,
+                                       _mesa_key_pointer_equal);
+}
+
+ir_serializer::~ir_serializer()
+{
+   ralloc_free(mem_ctx);
+}
+
+/**
+ * Variables are identified by the order in which they are first referenced.
+ * The first reference to a variable is followed by its definition.
+ */
+void
+ir_serializer::write_variable_ref(ir_variable *var)
+{
+   if (var == NULL) {
+      blob_write_uint32(blob, ENCODED_NULL);
+      return;
+   }
+
+   struct hash_entry *entry = _mesa_hash_table_search(variables, var);
+   if (entry != NULL) {
+      blob_write_uint32(blob, (uint32_t) (intptr_t) entry->data);
+      return;
+   }
+
+   _mesa_hash_table_insert(variables, var, (void *) (intptr_t) num_variables);
+   blob_write_uint32(blob, num_variables++);
+   write_variable(var);
+}
+
+void
+ir_serializer::write_variable(ir_variable *var)
+{
+   encode_type_to_blob(blob, var->type);
+
+   /* Unnamed temporaries share a static name, which the ir_variable
+    * constructor picks again for temporaries.
+    */
+   blob_write_uint32(blob, var->name != NULL);
+   if (var->name != NULL)
+      blob_write_string(blob, var->name);
+
+   blob_write_bytes(blob, &var->data, sizeof(var->data));
+
+   const glsl_type *interface_type = var->get_interface_type();
+   encode_type_to_blob(blob, interface_type);
+
+   if (var->is_interface_instance()) {
+      blob_write_bytes(blob, var->get_max_ifc_array_access(),
+                       interface_type->length * sizeof(int));
+   } else if (var->get_num_state_slots() > 0) {
+      blob_write_bytes(blob, var->get_state_slots(),
+                       var->get_num_state_slots() * sizeof(ir_state_slot));
+   }
+
+   write_ir(var->constant_value);
+   write_ir(var->constant_initializer);
+}
+
+void
+ir_serializer::write_signature_ref(const ir_function_signature *sig)
+{
+   struct hash_entry *entry = _mesa_hash_table_search(signatures, sig);
+   assert(entry != NULL);
+   blob_write_uint32(blob, (uint32_t) (intptr_t) entry->data);
+}
+
+uint32_t
+ir_serializer::function_id(ir_function *f)
+{
+   struct hash_entry *entry = _mesa_hash_table_search(functions, f);
+   assert(entry != NULL);
+   return (uint32_t) (intptr_t) entry->data;
+}
+
+void
+ir_serializer::write_ir_list(exec_list *list)
+{
+   blob_write_uint32(blob, list->length());
+
+   foreach_in_list(ir_instruction, ir, list)
+      write_ir(ir);
+}
+
+void
+ir_serializer::write_ir(ir_instruction *ir)
+{
+   if (ir == NULL) {
+      blob_write_uint32(blob, ENCODED_NULL);
+      return;
+   }
+
+   blob_write_uint32(blob, ir->ir_type);
+
+   ir_rvalue *rvalue = ir->as_rvalue();
+   if (rvalue != NULL)
+      encode_type_to_blob(blob, rvalue->type);
+
+   switch (ir->ir_type) {
+   case ir_type_variable:
+      write_variable_ref((ir_variable *) ir);
+      break;
+
+   case ir_type_function:
+      blob_write_uint32(blob, function_id((ir_function *) ir));
+      break;
+
+   case ir_type_dereference_variable:
+      write_variable_ref(((ir_dereference_variable *) ir)->var);
+      break;
+
+   case ir_type_dereference_array: {
+      ir_dereference_array *deref = (ir_dereference_array *) ir;
+      write_ir(deref->array);
+      write_ir(deref->array_index);
+      break;
+   }
+
+   case ir_type_dereference_record: {
+      ir_dereference_record *deref = (ir_dereference_record *) ir;
+      write_ir(deref->record);
+      blob_write_string(blob, deref->field);
+      break;
+   }
+
+   case ir_type_constant: {
+      ir_constant *c = (ir_constant *) ir;
+
+      if (c->type->is_array()) {
+         for (unsigned i = 0; i < c->type->length; i++)
+            write_ir(c->array_elements[i]);
+      } else if (c->type->is_record()) {
+         foreach_in_list(ir_constant, field, &c->components)
+            write_ir(field);
+      } else {
+         blob_write_bytes(blob, &c->value, sizeof(c->value));
+      }
+      break;
+   }
+
+   case ir_type_expression: {
+      ir_expression *expr = (ir_expression *) ir;
+      const unsigned num_operands = expr->get_num_operands();
+
+      blob_write_uint32(blob, expr->operation);
+      blob_write_uint32(blob, num_operands);
+      for (unsigned i = 0; i < num_operands; i++)
+         write_ir(expr->operands[i]);
+      break;
+   }
+
+   case ir_type_swizzle: {
+      ir_swizzle *swiz = (ir_swizzle *) ir;
+      write_ir(swiz->val);
+      blob_write_bytes(blob, &swiz->mask, sizeof(swiz->mask));
+      break;
+   }
+
+   case ir_type_texture: {
+      ir_texture *tex = (ir_texture *) ir;
+
+      blob_write_uint32(blob, tex->op);
+      write_ir(tex->sampler);
+      write_ir(tex->coordinate);
+      write_ir(tex->projector);
+      write_ir(tex->shadow_comparitor);
+      write_ir(tex->offset);
+
+      switch (tex->op) {
+      case ir_tex:
+      case ir_lod:
+      case ir_query_levels:
+      case ir_texture_samples:
+      case ir_samples_identical:
+         break;
+      case ir_txb:
+         write_ir(tex->lod_info.bias);
+         break;
+      case ir_txl:
+      case ir_txf:
+      case ir_txs:
+         write_ir(tex->lod_info.lod);
+         break;
+      case ir_txf_ms:
+         write_ir(tex->lod_info.sample_index);
+         break;
+      case ir_txd:
+         write_ir(tex->lod_info.grad.dPdx);
+         write_ir(tex->lod_info.grad.dPdy);
+         break;
+      case ir_tg4:
+         write_ir(tex->lod_info.component);
+         break;
+      }
+      break;
+   }
+
+   case ir_type_assignment: {
+      ir_assignment *assign = (ir_assignment *) ir;
+      write_ir(assign->lhs);
+      write_ir(assign->rhs);
+      write_ir(assign->condition);
+      blob_write_uint32(blob, assign->write_mask);
+      break;
+   }
+
+   case ir_type_call: {
+      ir_call *call = (ir_call *) ir;
+      write_signature_ref(call->callee);
+      write_ir(call->return_deref);
+      write_ir_list(&call->actual_parameters);
+      write_variable_ref(call->sub_var);
+      write_ir(call->array_idx);
+      blob_write_uint32(blob, call->use_builtin);
+      break;
+   }
+
+   case ir_type_if: {
+      ir_if *if_stmt = (ir_if *) ir;
+      write_ir(if_stmt->condition);
+      write_ir_list(&if_stmt->then_instructions);
+      write_ir_list(&if_stmt->else_instructions);
+      break;
+   }
+
+   case ir_type_loop:
+      write_ir_list(&((ir_loop *) ir)->body_instructions);
+      break;
+
+   case ir_type_loop_jump:
+      blob_write_uint32(blob, ((ir_loop_jump *) ir)->mode);
+      break;
+
+   case ir_type_return:
+      write_ir(((ir_return *) ir)->value);
+      break;
+
+   case ir_type_discard:
+      write_ir(((ir_discard *) ir)->condition);
+      break;
+
+   case ir_type_emit_vertex:
+      write_ir(((ir_emit_vertex *) ir)->stream);
+      break;
+
+   case ir_type_end_primitive:
+      write_ir(((ir_end_primitive *) ir)->stream);
+      break;
+
+   case ir_type_barrier:
+      break;
+
+   case ir_type_function_signature:
+   case ir_type_unset:
+      unreachable("Unexpected IR node");
+   }
+}
+
+/**
+ * Write the IR of a shader
+ *
+ * Functions are written up front, as a table of prototypes, so that calls
+ * can refer to signatures that are defined later in the shader or not part
+ * of it at all.  The bodies of the signatures follow the instruction list.
+ */
+void
+ir_serializer::write_shader_ir(exec_list *ir)
+{
+   function_collector collector(mem_ctx, functions);
+
+   foreach_in_list(ir_instruction, node, ir) {
+      ir_function *f = node->as_function();
+      if (f != NULL)
+         collector.add(f);
+   }
+
+   uint32_t num_signatures = 0;
+
+   blob_write_uint32(blob, collector.num_functions);
+   for (unsigned i = 0; i < collector.num_functions; i++) {
+      ir_function *f = collector.functions[i];
+
+      blob_write_string(blob, f->name);
+      blob_write_uint32(blob, f->is_subroutine);
+      blob_write_uint32(blob, f->subroutine_index);
+      blob_write_uint32(blob, f->num_subroutine_types);
+      for (int j = 0; j < f->num_subroutine_types; j++)
+         encode_type_to_blob(blob, f->subroutine_types[j]);
+
+      blob_write_uint32(blob, f->signatures.length());
+      foreach_in_list(ir_function_signature, sig, &f->signatures) {
+         _mesa_hash_table_insert(signatures, sig,
+                                 (void *) (intptr_t) num_signatures++);
+
+         encode_type_to_blob(blob, sig->return_type);
+         blob_write_uint32(blob,
+                           (sig->is_defined ? SIGNATURE_DEFINED : 0) |
+                           (sig->is_intrinsic ? SIGNATURE_INTRINSIC : 0) |
+                           (sig->is_builtin() ? SIGNATURE_BUILTIN : 0));
+
+         blob_write_uint32(blob, sig->parameters.length());
+         foreach_in_list(ir_variable, param, &sig->parameters)
+            write_variable_ref(param);
+      }
+   }
+
+   write_ir_list(ir);
+
+   for (unsigned i = 0; i < collector.num_functions; i++) {
+      foreach_in_list(ir_function_signature, sig,
+                      &collector.functions[i]->signatures)
+         write_ir_list(&sig->body);
+   }
+}
+
+class ir_deserializer {
+public:
+   ir_deserializer(struct blob_reader *blob, void *mem_ctx);
+   ~ir_deserializer();
+
+   bool read_shader_ir(exec_list *ir);
+   bool read_ir_list(exec_list *list);
+
+private:
+   ir_instruction *read_ir();
+   ir_rvalue *read_rvalue();
+   ir_variable *read_variable_ref();
+   ir_variable *read_variable();
+
+   struct blob_reader *blob;
+   void *mem_ctx;
+   bool failed;
+
+   ir_variable **variables;
+   uint32_t num_variables;
+
+   ir_function **functions;
+   uint32_t num_functions;
+
+   ir_function_signature **signatures;
+   uint32_t num_signatures;
+};
+
+ir_deserializer::ir_deserializer(struct blob_reader *blob, void *mem_ctx)
+   : blob(blob), mem_ctx(mem_ctx), failed(false),
+     variables(NULL), num_variables(0),
+     functions(NULL), num_functions(0),
+     signatures(NULL), num_signatures(0)
+{
+}
+
+ir_deserializer::~ir_deserializer()
+{
+   free(variables);
+   free(functions);
+   free(signatures);
+}
+
+ir_variable *
+ir_deserializer::read_variable_ref()
+{
+   uint32_t id = blob_read_uint32(blob);
+
+   if (id == ENCODED_NULL)
+      return NULL;
+
+   if (id < num_variables)
+      return variables[id];
+
+   if (id != num_variables || blob->overrun) {
+      failed = true;
+      return NULL;
+   }
+
+   ir_variable *var = read_variable();
+   if (var == NULL) {
+      failed = true;
+      return NULL;
+   }
+
+   ir_variable **grown = (ir_variable **)
+      realloc(variables, (num_variables + 1) * sizeof(ir_variable *));
+   if (grown == NULL) {
+      failed = true;
+      return NULL;
+   }
+
+   variables = grown;
+   variables[num_variables++] = var;
+   return var;
+}
+
+ir_variable *
+ir_deserializer::read_variable()
+{
+   const glsl_type *type = decode_type_from_blob(blob);
+   bool has_name = blob_read_uint32(blob);
+   const char *name = NULL;
+
+   if (has_name)
+      name = blob_read_string(blob);
+
+   ir_variable::ir_variable_data data;
+   blob_copy_bytes(blob, (uint8_t *) &data, sizeof(data));
+
+   if (type == NULL || blob->overrun ||
+       (has_name && name == NULL))
+      return NULL;
+
+   ir_variable *var =
+      new(mem_ctx) ir_variable(type, name, (ir_variable_mode) data.mode);
+   memcpy(&var->data, &data, sizeof(data));
+
+   const glsl_type *interface_type = decode_type_from_blob(blob);
+   if (interface_type != NULL)
+      var->init_interface_type(interface_type);
+
+   if (var->is_interface_instance()) {
+      blob_copy_bytes(blob, (uint8_t *) var->get_max_ifc_array_access(),
+                      interface_type->length * sizeof(int));
+   } else if (var->get_num_state_slots() > 0) {
+      unsigned num_slots = var->get_num_state_slots();
+      ir_state_slot *slots = var->allocate_state_slots(num_slots);
+
+      blob_copy_bytes(blob, (uint8_t *) slots,
+                      num_slots * sizeof(ir_state_slot));
+   }
+
+   ir_instruction *value = read_ir();
+   ir_instruction *initializer = read_ir();
+   var->constant_value = value ? value->as_constant() : NULL;
+   var->constant_initializer = initializer ? initializer->as_constant() : NULL;
+
+   return var;
+}
+
+ir_rvalue *
+ir_deserializer::read_rvalue()
+{
+   ir_instruction *ir = read_ir();
+   return ir ? ir->as_rvalue() : NULL;
+}
+
+bool
+ir_deserializer::read_ir_list(exec_list *list)
+{
+   uint32_t count = blob_read_uint32(blob);
+
+   for (uint32_t i = 0; i < count && !failed && !blob->overrun; i++) {
+      ir_instruction *ir = read_ir();
+      if (ir == NULL) {
+         failed = true;
+         break;
+      }
+      list->push_tail(ir);
+   }
+
+   return !failed && !blob->overrun;
+}
+
+ir_instruction *
+ir_deserializer::read_ir()
+{
+   uint32_t ir_type = blob_read_uint32(blob);
+
+   if (ir_type == ENCODED_NULL || failed || blob->overrun)
+      return NULL;
+
+   const glsl_type *type = NULL;
+   switch (ir_type) {
+   case ir_type_dereference_array:
+   case ir_type_dereference_record:
+   case ir_type_dereference_variable:
+   case ir_type_constant:
+   case ir_type_expression:
+   case ir_type_swizzle:
+   case ir_type_texture:
+      type = decode_type_from_blob(blob);
+      if (type == NULL || blob->overrun) {
+         failed = true;
+         return NULL;
+      }
+      break;
+   default:
+      break;
+   }
+
+   ir_rvalue *rvalue = NULL;
+
+   switch (ir_type) {
+   case ir_type_variable:
+      return read_variable_ref();
+
+   case ir_type_function: {
+      uint32_t id = blob_read_uint32(blob);
+      if (id >= num_functions) {
+         failed = true;
+         return NULL;
+      }
+      return functions[id];
+   }
+
+   case ir_type_dereference_variable: {
+      ir_variable *var = read_variable_ref();
+      if (var == NULL)
+         return NULL;
+      rvalue = new(mem_ctx) ir_dereference_variable(var);
+      break;
+   }
+
+   case ir_type_dereference_array: {
+      ir_rvalue *array = read_rvalue();
+      ir_rvalue *index = read_rvalue();
+      if (array == NULL || index == NULL)
+         return NULL;
+      rvalue = new(mem_ctx) ir_dereference_array(array, index);
+      break;
+   }
+
+   case ir_type_dereference_record: {
+      ir_rvalue *record = read_rvalue();
+      const char *field = blob_read_string(blob);
+      if (record == NULL || field == NULL)
+         return NULL;
+      rvalue = new(mem_ctx) ir_dereference_record(record, field);
+      break;
+   }
+
+   case ir_type_constant: {
+      if (type->is_array() || type->is_record()) {
+         exec_list values;
+
+         for (unsigned i = 0; i < type->length; i++) {
+            ir_rvalue *value = read_rvalue();
+            if (value == NULL || value->as_constant() == NULL) {
+               failed = true;
+               return NULL;
+            }
+            values.push_tail(value);
+         }
+         rvalue = new(mem_ctx) ir_constant(type, &values);
+      } else if (type->base_type <= GLSL_TYPE_BOOL) {
+         ir_constant_data data;
+         blob_copy_bytes(blob, (uint8_t *) &data, sizeof(data));
+         if (blob->overrun) {
+            failed = true;
+            return NULL;
+         }
+         rvalue = new(mem_ctx) ir_constant(type, &data);
+      } else {
+         failed = true;
+         return NULL;
+      }
+      break;
+   }
+
+   case ir_type_expression: {
+      ir_expression_operation op =
+         (ir_expression_operation) blob_read_uint32(blob);
+      uint32_t num_operands = blob_read_uint32(blob);
+      ir_rvalue *operands[4] = { NULL, NULL, NULL, NULL };
+
+      if (num_operands > 4 || op > ir_last_opcode || blob->overrun) {
+         failed = true;
+         return NULL;
+      }
+
+      for (unsigned i = 0; i < num_operands; i++) {
+         operands[i] = read_rvalue();
+         if (operands[i] == NULL) {
+            failed = true;
+            return NULL;
+         }
+      }
+
+      rvalue = new(mem_ctx) ir_expression(op, type, operands[0], operands[1],
+                                          operands[2], operands[3]);
+      break;
+   }
+
+   case ir_type_swizzle: {
+      ir_rvalue *val = read_rvalue();
+      ir_swizzle_mask mask;
+      blob_copy_bytes(blob, (uint8_t *) &mask, sizeof(mask));
+      if (val == NULL || blob->overrun) {
+         failed = true;
+         return NULL;
+      }
+      rvalue = new(mem_ctx) ir_swizzle(val, mask);
+      break;
+   }
+
+   case ir_type_texture: {
+      ir_texture *tex =
+         new(mem_ctx) ir_texture((ir_texture_opcode) blob_read_uint32(blob));
+
+      ir_rvalue *sampler = read_rvalue();
+      if (sampler == NULL || sampler->as_dereference() == NULL) {
+         failed = true;
+         return NULL;
+      }
+
+      tex->set_sampler(sampler->as_dereference(), type);
+      tex->coordinate = read_rvalue();
+      tex->projector = read_rvalue();
+      tex->shadow_comparitor = read_rvalue();
+      tex->offset = read_rvalue();
+
+      switch (tex->op) {
+      case ir_tex:
+      case ir_lod:
+      case ir_query_levels:
+      case ir_texture_samples:
+      case ir_samples_identical:
+         break;
+      case ir_txb:
+         tex->lod_info.bias = read_rvalue();
+         break;
+      case ir_txl:
+      case ir_txf:
+      case ir_txs:
+         tex->lod_info.lod = read_rvalue();
+         break;
+      case ir_txf_ms:
+         tex->lod_info.sample_index = read_rvalue();
+         break;
+      case ir_txd:
+         tex->lod_info.grad.dPdx = read_rvalue();
+         tex->lod_info.grad.dPdy = read_rvalue();
+         break;
+      case ir_tg4:
+         tex->lod_info.component = read_rvalue();
+         break;
+      }
+
+      rvalue = tex;
+      break;
+   }
+
+   case ir_type_assignment: {
+      ir_rvalue *lhs = read_rvalue();
+      ir_rvalue *rhs = read_rvalue();
+      ir_rvalue *condition = read_rvalue();
+      unsigned write_mask = blob_read_uint32(blob);
+
+      if (lhs == NULL || lhs->as_dereference() == NULL || rhs == NULL ||
+          blob->overrun) {
+         failed = true;
+         return NULL;
+      }
+
+      return new(mem_ctx) ir_assignment(lhs->as_dereference(), rhs, condition,
+                                        write_mask);
+   }
+
+   case ir_type_call: {
+      uint32_t id = blob_read_uint32(blob);
+      if (id >= num_signatures) {
+         failed = true;
+         return NULL;
+      }
+
+      ir_function_signature *callee = signatures[id];
+      ir_rvalue *return_deref = read_rvalue();
+
+      exec_list actual_parameters;
+      if (!read_ir_list(&actual_parameters))
+         return NULL;
+
+      ir_variable *sub_var = read_variable_ref();
+      ir_rvalue *array_idx = read_rvalue();
+      bool use_builtin = blob_read_uint32(blob);
+
+      ir_dereference_variable *ret =
+         return_deref ? return_deref->as_dereference_variable() : NULL;
+
+      ir_call *call;
+      if (sub_var != NULL) {
+         call = new(mem_ctx) ir_call(callee, ret, &actual_parameters,
+                                     sub_var, array_idx);
+      } else {
+         call = new(mem_ctx) ir_call(callee, ret, &actual_parameters);
+      }
+      call->use_builtin = use_builtin;
+      return call;
+   }
+
+   case ir_type_if: {
+      ir_rvalue *condition = read_rvalue();
+      if (condition == NULL) {
+         failed = true;
+         return NULL;
+      }
+
+      ir_if *if_stmt = new(mem_ctx) ir_if(condition);
+      read_ir_list(&if_stmt->then_instructions);
+      read_ir_list(&if_stmt->else_instructions);
+      return if_stmt;
+   }
+
+   case ir_type_loop: {
+      ir_loop *loop = new(mem_ctx) ir_loop();
+      read_ir_list(&loop->body_instructions);
+      return loop;
+   }
+
+   case ir_type_loop_jump:
+      return new(mem_ctx)
+         ir_loop_jump((ir_loop_jump::jump_mode) blob_read_uint32(blob));
+
+   case ir_type_return:
+      return new(mem_ctx) ir_return(read_rvalue());
+
+   case ir_type_discard:
+      return new(mem_ctx) ir_discard(read_rvalue());
+
+   case ir_type_emit_vertex:
+      return new(mem_ctx) ir_emit_vertex(read_rvalue());
+
+   case ir_type_end_primitive:
+      return new(mem_ctx) ir_end_primitive(read_rvalue());
+
+   case ir_type_barrier:
+      return new(mem_ctx) ir_barrier();
+
+   default:
+      failed = true;
+      return NULL;
+   }
+
+   rvalue->type = type;
+   return rvalue;
+}
+
+bool
+ir_deserializer::read_shader_ir(exec_list *ir)
+{
+   num_functions = blob_read_uint32(blob);
+   if (blob->overrun)
+      return false;
+
+   functions = (ir_function **)
+      calloc(MAX2(num_functions, 1), sizeof(ir_function *));
+   if (functions == NULL)
+      return false;
+
+   for (unsigned i = 0; i < num_functions; i++) {
+      const char *name = blob_read_string(blob);
+      if (name == NULL)
+         return false;
+
+      ir_function *f = new(mem_ctx) ir_function(name);
+      f->is_subroutine = blob_read_uint32(blob);
+      f->subroutine_index = blob_read_uint32(blob);
+      f->num_subroutine_types = blob_read_uint32(blob);
+      f->subroutine_types = NULL;
+
+      if (f->num_subroutine_types > 0) {
+         f->subroutine_types = ralloc_array(f, const struct glsl_type *,
+                                            f->num_subroutine_types);
+         for (int j = 0; j < f->num_subroutine_types; j++)
+            f->subroutine_types[j] = decode_type_from_blob(blob);
+      }
+
+      uint32_t count = blob_read_uint32(blob);
+      if (blob->overrun)
+         return false;
+
+      for (unsigned j = 0; j < count; j++) {
+         const glsl_type *return_type = decode_type_from_blob(blob);
+         uint32_t flags = blob_read_uint32(blob);
+
+         if (return_type == NULL)
+            return false;
+
+         ir_function_signature *sig =
+            new(mem_ctx) ir_function_signature(return_type,
+               (flags & SIGNATURE_BUILTIN) ? builtin_always_available : NULL);
+         sig->is_defined = (flags & SIGNATURE_DEFINED) != 0;
+         sig->is_intrinsic = (flags & SIGNATURE_INTRINSIC) != 0;
+
+         uint32_t num_params = blob_read_uint32(blob);
+         for (unsigned k = 0; k < num_params; k++) {
+            ir_variable *param = read_variable_ref();
+            if (param == NULL)
+               return false;
+            sig->parameters.push_tail(param);
+         }
+
+         f->add_signature(sig);
+
+         ir_function_signature **grown = (ir_function_signature **)
+            realloc(signatures,
+                    (num_signatures + 1) * sizeof(ir_function_signature *));
+         if (grown == NULL)
+            return false;
+
+         signatures = grown;
+         signatures[num_signatures++] = sig;
+      }
+
+      functions[i] = f;
+   }
+
+   if (!read_ir_list(ir))
+      return false;
+
+   for (unsigned i = 0; i < num_functions; i++) {
+      foreach_in_list(ir_function_signature, sig, &functions[i]->signatures) {
+         if (!read_ir_list(&sig->body))
+            return false;
+      }
+   }
+
+   return !failed && !blob->overrun;
+}
+
+} /* anonymous namespace */
+
+static void
+write_uniform_blocks(struct blob *blob, const struct gl_uniform_block *blocks,
+                     unsigned num_blocks)
+{
+   blob_write_uint32(blob, num_blocks);
+
+   for (unsigned i = 0; i < num_blocks; i++) {
+      const struct gl_uniform_block *b = &blocks[i];
+
+      blob_write_string(blob, b->Name);
+      blob_write_uint32(blob, b->NumUniforms);
+      blob_write_uint32(blob, b->Binding);
+      blob_write_uint32(blob, b->UniformBufferSize);
+      blob_write_uint32(blob, b->stageref);
+      blob_write_uint32(blob, b->_Packing);
+
+      for (unsigned j = 0; j < b->NumUniforms; j++) {
+         const struct gl_uniform_buffer_variable *u = &b->Uniforms[j];
+
+         blob_write_string(blob, u->Name);
+         blob_write_uint32(blob, u->IndexName == u->Name);
+         if (u->IndexName != u->Name)
+            blob_write_string(blob, u->IndexName);
+         encode_type_to_blob(blob, u->Type);
+         blob_write_uint32(blob, u->Offset);
+         blob_write_uint32(blob, u->RowMajor);
+      }
+   }
+}
+
+static bool
+read_uniform_blocks(struct blob_reader *blob, struct gl_shader_program *prog,
+                    struct gl_uniform_block **out_blocks,
+                    unsigned *out_num_blocks)
+{
+   unsigned num_blocks = blob_read_uint32(blob);
+
+   *out_blocks = NULL;
+   *out_num_blocks = 0;
+
+   if (num_blocks == 0 || blob->overrun)
+      return !blob->overrun;
+
+   struct gl_uniform_block *blocks =
+      rzalloc_array(prog, struct gl_uniform_block, num_blocks);
+
+   *out_blocks = blocks;
+   *out_num_blocks = num_blocks;
+
+   for (unsigned i = 0; i < num_blocks; i++) {
+      struct gl_uniform_block *b = &blocks[i];
+      const char *name = blob_read_string(blob);
+
+      if (name == NULL)
+         return false;
+
+      b->Name = ralloc_strdup(blocks, name);
+      b->NumUniforms = blob_read_uint32(blob);
+      b->Binding = blob_read_uint32(blob);
+      b->UniformBufferSize = blob_read_uint32(blob);
+      b->stageref = blob_read_uint32(blob);
+      b->_Packing = (enum gl_uniform_block_packing) blob_read_uint32(blob);
+
+      if (blob->overrun)
+         return false;
+
+      b->Uniforms = rzalloc_array(blocks, struct gl_uniform_buffer_variable,
+                                  b->NumUniforms);
+
+      for (unsigned j = 0; j < b->NumUniforms; j++) {
+         struct gl_uniform_buffer_variable *u = &b->Uniforms[j];
+         const char *var_name = blob_read_string(blob);
+
+         if (var_name == NULL)
+            return false;
+
+         u->Name = ralloc_strdup(blocks, var_name);
+
+         if (blob_read_uint32(blob)) {
+            u->IndexName = u->Name;
+         } else {
+            const char *index_name = blob_read_string(blob);
+            if (index_name == NULL)
+               return false;
+            u->IndexName = ralloc_strdup(blocks, index_name);
+         }
+
+         u->Type = decode_type_from_blob(blob);
+         u->Offset = blob_read_uint32(blob);
+         u->RowMajor = blob_read_uint32(blob);
+      }
+   }
+
+   return !blob->overrun;
+}
+
+static void
+write_atomic_buffers(struct blob *blob, struct gl_shader_program *prog)
+{
+   blob_write_uint32(blob, prog->NumAtomicBuffers);
+
+   for (unsigned i = 0; i < prog->NumAtomicBuffers; i++) {
+      const struct gl_active_atomic_buffer *ab = &prog->AtomicBuffers[i];
+
+      blob_write_uint32(blob, ab->NumUniforms);
+      blob_write_bytes(blob, ab->Uniforms, ab->NumUniforms * sizeof(GLuint));
+      blob_write_uint32(blob, ab->Binding);
+      blob_write_uint32(blob, ab->MinimumSize);
+      blob_write_bytes(blob, ab->StageReferences,
+                       sizeof(ab->StageReferences));
+   }
+}
+
+static bool
+read_atomic_buffers(struct blob_reader *blob, struct gl_shader_program *prog)
+{
+   prog->NumAtomicBuffers = blob_read_uint32(blob);
+   if (prog->NumAtomicBuffers == 0 || blob->overrun)
+      return !blob->overrun;
+
+   prog->AtomicBuffers = rzalloc_array(prog, struct gl_active_atomic_buffer,
+                                       prog->NumAtomicBuffers);
+
+   for (unsigned i = 0; i < prog->NumAtomicBuffers; i++) {
+      struct gl_active_atomic_buffer *ab = &prog->AtomicBuffers[i];
+
+      ab->NumUniforms = blob_read_uint32(blob);
+      if (blob->overrun)
+         return false;
+
+      ab->Uniforms = rzalloc_array(prog->AtomicBuffers, GLuint,
+                                   ab->NumUniforms);
+      blob_copy_bytes(blob, (uint8_t *) ab->Uniforms,
+                      ab->NumUniforms * sizeof(GLuint));
+      ab->Binding = blob_read_uint32(blob);
+      ab->MinimumSize = blob_read_uint32(blob);
+      blob_copy_bytes(blob, (uint8_t *) ab->StageReferences,
+                      sizeof(ab->StageReferences));
+   }
+
+   return !blob->overrun;
+}
+
+static void
+count_uniform_hash_entry(const char *, unsigned, void *closure)
+{
+   (*(uint32_t *) closure)++;
+}
+
+static void
+write_uniform_hash_entry(const char *name, unsigned value, void *closure)
+{
+   struct blob *blob = (struct blob *) closure;
+
+   blob_write_string(blob, name);
+   blob_write_uint32(blob, value);
+}
+
+static void
+write_uniform_remap_table(struct blob *blob, struct gl_shader_program *prog,
+                          struct gl_uniform_storage **table,
+                          unsigned num_entries)
+{
+   blob_write_uint32(blob, num_entries);
+
+   for (unsigned i = 0; i < num_entries; i++) {
+      if (table[i] == NULL) {
+         blob_write_uint32(blob, REMAP_NULL);
+      } else if (table[i] == INACTIVE_UNIFORM_EXPLICIT_LOCATION) {
+         blob_write_uint32(blob, REMAP_INACTIVE);
+      } else {
+         write_ptr_index(blob, table[i], prog->UniformStorage,
+                         sizeof(struct gl_uniform_storage));
+      }
+   }
+}
+
+static bool
+read_uniform_remap_table(struct blob_reader *blob,
+                         struct gl_shader_program *prog, void *mem_ctx,
+                         struct gl_uniform_storage ***out_table,
+                         unsigned *out_num_entries)
+{
+   unsigned num_entries = blob_read_uint32(blob);
+   if (num_entries == 0 || blob->overrun)
+      return !blob->overrun;
+
+   struct gl_uniform_storage **table =
+      rzalloc_array(mem_ctx, struct gl_uniform_storage *, num_entries);
+
+   for (unsigned i = 0; i < num_entries; i++) {
+      uint32_t index = blob_read_uint32(blob);
+
+      if (index == REMAP_NULL) {
+         table[i] = NULL;
+      } else if (index == REMAP_INACTIVE) {
+         table[i] = INACTIVE_UNIFORM_EXPLICIT_LOCATION;
+      } else if (index < prog->NumUniformStorage) {
+         table[i] = &prog->UniformStorage[index];
+      } else {
+         return false;
+      }
+   }
+
+   *out_table = table;
+   *out_num_entries = num_entries;
+   return !blob->overrun;
+}
+
+static void
+write_uniforms(struct blob *blob, struct gl_shader_program *prog)
+{
+   blob_write_uint32(blob, prog->NumUniformStorage);
+   blob_write_uint32(blob, prog->NumHiddenUniforms);
+   blob_write_uint32(blob, prog->NumUniformDataSlots);
+
+   for (unsigned i = 0; i < prog->NumUniformStorage; i++) {
+      const struct gl_uniform_storage *u = &prog->UniformStorage[i];
+
+      blob_write_string(blob, u->name);
+      encode_type_to_blob(blob, u->type);
+      blob_write_uint32(blob, u->array_elements);
+      blob_write_bytes(blob, u->opaque, sizeof(u->opaque));
+      blob_write_uint32(blob, u->block_index);
+      blob_write_uint32(blob, u->offset);
+      blob_write_uint32(blob, u->matrix_stride);
+      blob_write_uint32(blob, u->array_stride);
+      blob_write_uint32(blob, u->row_major);
+      blob_write_uint32(blob, u->hidden);
+      blob_write_uint32(blob, u->builtin);
+      blob_write_uint32(blob, u->is_shader_storage);
+      blob_write_uint32(blob, u->atomic_buffer_index);
+      blob_write_uint32(blob, u->remap_location);
+      blob_write_uint32(blob, u->num_compatible_subroutines);
+      blob_write_uint32(blob, u->top_level_array_size);
+      blob_write_uint32(blob, u->top_level_array_stride);
+
+      if (u->storage != NULL) {
+         write_ptr_index(blob, u->storage, prog->UniformDataSlots,
+                         sizeof(union gl_constant_value));
+      } else {
+         blob_write_uint32(blob, ENCODED_NULL);
+      }
+   }
+
+   /* The uniform values at this point are the link-time initializers. */
+   blob_write_bytes(blob, prog->UniformDataSlots,
+                    prog->NumUniformDataSlots *
+                    sizeof(union gl_constant_value));
+
+   uint32_t num_names = 0;
+   if (prog->UniformHash != NULL)
+      prog->UniformHash->iterate(count_uniform_hash_entry, &num_names);
+   blob_write_uint32(blob, num_names);
+   if (prog->UniformHash != NULL)
+      prog->UniformHash->iterate(write_uniform_hash_entry, blob);
+
+   write_uniform_remap_table(blob, prog, prog->UniformRemapTable,
+                             prog->NumUniformRemapTable);
+}
+
+static bool
+read_uniforms(struct blob_reader *blob, struct gl_shader_program *prog)
+{
+   unsigned num_uniforms = blob_read_uint32(blob);
+   prog->NumHiddenUniforms = blob_read_uint32(blob);
+   unsigned num_data_slots = blob_read_uint32(blob);
+
+   if (blob->overrun)
+      return false;
+
+   if (num_uniforms > 0) {
+      prog->UniformStorage =
+         rzalloc_array(prog, struct gl_uniform_storage, num_uniforms);
+      prog->UniformDataSlots =
+         rzalloc_array(prog->UniformStorage, union gl_constant_value,
+                       num_data_slots);
+      prog->NumUniformStorage = num_uniforms;
+      prog->NumUniformDataSlots = num_data_slots;
+   }
+
+   for (unsigned i = 0; i < num_uniforms; i++) {
+      struct gl_uniform_storage *u = &prog->UniformStorage[i];
+      const char *name = blob_read_string(blob);
+
+      if (name == NULL)
+         return false;
+
+      u->name = ralloc_strdup(prog->UniformStorage, name);
+      u->type = decode_type_from_blob(blob);
+      u->array_elements = blob_read_uint32(blob);
+      blob_copy_bytes(blob, (uint8_t *) u->opaque, sizeof(u->opaque));
+      u->block_index = blob_read_uint32(blob);
+      u->offset = blob_read_uint32(blob);
+      u->matrix_stride = blob_read_uint32(blob);
+      u->array_stride = blob_read_uint32(blob);
+      u->row_major = blob_read_uint32(blob);
+      u->hidden = blob_read_uint32(blob);
+      u->builtin = blob_read_uint32(blob);
+      u->is_shader_storage = blob_read_uint32(blob);
+      u->atomic_buffer_index = blob_read_uint32(blob);
+      u->remap_location = blob_read_uint32(blob);
+      u->num_compatible_subroutines = blob_read_uint32(blob);
+      u->top_level_array_size = blob_read_uint32(blob);
+      u->top_level_array_stride = blob_read_uint32(blob);
+
+      uint32_t storage = blob_read_uint32(blob);
+      if (storage != ENCODED_NULL) {
+         if (storage >= num_data_slots)
+            return false;
+         u->storage = &prog->UniformDataSlots[storage];
+      }
+
+      if (u->type == NULL)
+         return false;
+   }
+
+   blob_copy_bytes(blob, (uint8_t *) prog->UniformDataSlots,
+                   num_data_slots * sizeof(union gl_constant_value));
+
+   prog->UniformHash = new string_to_uint_map;
+
+   unsigned num_names = blob_read_uint32(blob);
+   for (unsigned i = 0; i < num_names && !blob->overrun; i++) {
+      const char *name = blob_read_string(blob);
+      unsigned value = blob_read_uint32(blob);
+
+      if (name == NULL)
+         return false;
+
+      prog->UniformHash->put(value, name);
+   }
+
+   return read_uniform_remap_table(blob, prog, prog,
+                                   &prog->UniformRemapTable,
+                                   &prog->NumUniformRemapTable);
+}
+
+static void
+write_xfb(struct blob *blob, struct gl_shader_program *prog)
+{
+   const struct gl_transform_feedback_info *info =
+      &prog->LinkedTransformFeedback;
+
+   blob_write_uint32(blob, info->NumOutputs);
+   blob_write_uint32(blob, info->ActiveBuffers);
+   blob_write_bytes(blob, info->Outputs,
+                    info->NumOutputs * sizeof(info->Outputs[0]));
+
+   blob_write_uint32(blob, info->NumVarying);
+   for (int i = 0; i < info->NumVarying; i++) {
+      const struct gl_transform_feedback_varying_info *v = &info->Varyings[i];
+
+      blob_write_string(blob, v->Name);
+      blob_write_uint32(blob, v->Type);
+      blob_write_uint32(blob, v->BufferIndex);
+      blob_write_uint32(blob, v->Size);
+      blob_write_uint32(blob, v->Offset);
+   }
+
+   blob_write_bytes(blob, info->Buffers, sizeof(info->Buffers));
+}
+
+static bool
+read_xfb(struct blob_reader *blob, struct gl_shader_program *prog)
+{
+   struct gl_transform_feedback_info *info = &prog->LinkedTransformFeedback;
+
+   ralloc_free(info->Varyings);
+   ralloc_free(info->Outputs);
+   memset(info, 0, sizeof(*info));
+
+   info->NumOutputs = blob_read_uint32(blob);
+   info->ActiveBuffers = blob_read_uint32(blob);
+   if (blob->overrun)
+      return false;
+
+   info->Outputs = rzalloc_array(prog, struct gl_transform_feedback_output,
+                                 info->NumOutputs);
+   blob_copy_bytes(blob, (uint8_t *) info->Outputs,
+                   info->NumOutputs * sizeof(info->Outputs[0]));
+
+   info->NumVarying = blob_read_uint32(blob);
+   if (blob->overrun)
+      return false;
+
+   info->Varyings = rzalloc_array(prog,
+                                  struct gl_transform_feedback_varying_info,
+                                  info->NumVarying);
+
+   for (int i = 0; i < info->NumVarying; i++) {
+      struct gl_transform_feedback_varying_info *v = &info->Varyings[i];
+      const char *name = blob_read_string(blob);
+
+      if (name == NULL)
+         return false;
+
+      v->Name = ralloc_strdup(prog, name);
+      v->Type = blob_read_uint32(blob);
+      v->BufferIndex = blob_read_uint32(blob);
+      v->Size = blob_read_uint32(blob);
+      v->Offset = blob_read_uint32(blob);
+   }
+
+   blob_copy_bytes(blob, (uint8_t *) info->Buffers, sizeof(info->Buffers));
+
+   return !blob->overrun;
+}
+
+static void
+write_block_pointers(struct blob *blob, struct gl_uniform_block **blocks,
+                     unsigned num_blocks, struct gl_uniform_block *base)
+{
+   blob_write_uint32(blob, num_blocks);
+   for (unsigned i = 0; i < num_blocks; i++)
+      write_ptr_index(blob, blocks[i], base, sizeof(*base));
+}
+
+static bool
+read_block_pointers(struct blob_reader *blob, void *mem_ctx,
+                    struct gl_uniform_block ***out_blocks,
+                    unsigned *out_num_blocks,
+                    struct gl_uniform_block *base, unsigned num_base)
+{
+   unsigned num_blocks = blob_read_uint32(blob);
+   if (num_blocks == 0 || blob->overrun)
+      return !blob->overrun;
+
+   struct gl_uniform_block **blocks =
+      ralloc_array(mem_ctx, struct gl_uniform_block *, num_blocks);
+
+   for (unsigned i = 0; i < num_blocks; i++) {
+      uint32_t index = blob_read_uint32(blob);
+      if (index >= num_base)
+         return false;
+      blocks[i] = &base[index];
+   }
+
+   *out_blocks = blocks;
+   *out_num_blocks = num_blocks;
+   return true;
+}
+
+static void
+write_linked_shader(struct blob *blob, struct gl_shader_program *prog,
+                    struct gl_shader *sh)
+{
+   blob_write_uint32(blob, sh->Version);
+   blob_write_uint32(blob, sh->IsES);
+   blob_write_uint32(blob, sh->uses_builtin_functions);
+   blob_write_uint32(blob, sh->uses_gl_fragcoord);
+   blob_write_uint32(blob, sh->redeclares_gl_fragcoord);
+   blob_write_uint32(blob, sh->ARB_fragment_coord_conventions_enable);
+   blob_write_uint32(blob, sh->origin_upper_left);
+   blob_write_uint32(blob, sh->pixel_center_integer);
+   blob_write_uint32(blob, sh->EarlyFragmentTests);
+
+   blob_write_uint32(blob, sh->num_samplers);
+   blob_write_uint32(blob, sh->active_samplers);
+   blob_write_uint32(blob, sh->shadow_samplers);
+   blob_write_bytes(blob, sh->SamplerUnits, sizeof(sh->SamplerUnits));
+   blob_write_bytes(blob, sh->SamplerTargets, sizeof(sh->SamplerTargets));
+   blob_write_uint32(blob, sh->num_uniform_components);
+   blob_write_uint32(blob, sh->num_combined_uniform_components);
+
+   write_block_pointers(blob, sh->UniformBlocks, sh->NumUniformBlocks,
+                        prog->UniformBlocks);
+   write_block_pointers(blob, sh->ShaderStorageBlocks,
+                        sh->NumShaderStorageBlocks,
+                        prog->ShaderStorageBlocks);
+
+   blob_write_bytes(blob, &sh->TransformFeedback,
+                    sizeof(sh->TransformFeedback));
+   blob_write_bytes(blob, &sh->TessCtrl, sizeof(sh->TessCtrl));
+   blob_write_bytes(blob, &sh->TessEval, sizeof(sh->TessEval));
+   blob_write_bytes(blob, &sh->Geom, sizeof(sh->Geom));
+   blob_write_bytes(blob, &sh->Comp, sizeof(sh->Comp));
+
+   blob_write_bytes(blob, sh->ImageUnits, sizeof(sh->ImageUnits));
+   blob_write_bytes(blob, sh->ImageAccess, sizeof(sh->ImageAccess));
+   blob_write_uint32(blob, sh->NumImages);
+
+   blob_write_uint32(blob, sh->NumAtomicBuffers);
+   for (unsigned i = 0; i < sh->NumAtomicBuffers; i++) {
+      write_ptr_index(blob, sh->AtomicBuffers[i], prog->AtomicBuffers,
+                      sizeof(struct gl_active_atomic_buffer));
+   }
+
+   blob_write_uint32(blob, sh->NumSubroutineUniformTypes);
+   blob_write_uint32(blob, sh->NumSubroutineUniforms);
+   write_uniform_remap_table(blob, prog, sh->SubroutineUniformRemapTable,
+                             sh->NumSubroutineUniformRemapTable);
+
+   blob_write_uint32(blob, sh->NumSubroutineFunctions);
+   blob_write_uint32(blob, sh->MaxSubroutineFunctionIndex);
+   for (unsigned i = 0; i < sh->NumSubroutineFunctions; i++) {
+      const struct gl_subroutine_function *fn = &sh->SubroutineFunctions[i];
+
+      blob_write_string(blob, fn->name);
+      blob_write_uint32(blob, fn->index);
+      blob_write_uint32(blob, fn->num_compat_types);
+      for (int j = 0; j < fn->num_compat_types; j++)
+         encode_type_to_blob(blob, fn->types[j]);
+   }
+
+   ir_serializer s(blob);
+   s.write_shader_ir(sh->ir);
+
+   blob_write_uint32(blob, sh->packed_varyings != NULL);
+   if (sh->packed_varyings)
+      s.write_ir_list(sh->packed_varyings);
+
+   blob_write_uint32(blob, sh->fragdata_arrays != NULL);
+   if (sh->fragdata_arrays)
+      s.write_ir_list(sh->fragdata_arrays);
+}
+
+static bool
+read_linked_shader(struct blob_reader *blob, struct gl_shader_program *prog,
+                   struct gl_shader *sh)
+{
+   sh->Version = blob_read_uint32(blob);
+   sh->IsES = blob_read_uint32(blob);
+   sh->uses_builtin_functions = blob_read_uint32(blob);
+   sh->uses_gl_fragcoord = blob_read_uint32(blob);
+   sh->redeclares_gl_fragcoord = blob_read_uint32(blob);
+   sh->ARB_fragment_coord_conventions_enable = blob_read_uint32(blob);
+   sh->origin_upper_left = blob_read_uint32(blob);
+   sh->pixel_center_integer = blob_read_uint32(blob);
+   sh->EarlyFragmentTests = blob_read_uint32(blob);
+
+   sh->num_samplers = blob_read_uint32(blob);
+   sh->active_samplers = blob_read_uint32(blob);
+   sh->shadow_samplers = blob_read_uint32(blob);
+   blob_copy_bytes(blob, (uint8_t *) sh->SamplerUnits,
+                   sizeof(sh->SamplerUnits));
+   blob_copy_bytes(blob, (uint8_t *) sh->SamplerTargets,
+                   sizeof(sh->SamplerTargets));
+   sh->num_uniform_components = blob_read_uint32(blob);
+   sh->num_combined_uniform_components = blob_read_uint32(blob);
+
+   if (!read_block_pointers(blob, sh, &sh->UniformBlocks,
+                            &sh->NumUniformBlocks,
+                            prog->UniformBlocks, prog->NumUniformBlocks))
+      return false;
+
+   if (!read_block_pointers(blob, sh, &sh->ShaderStorageBlocks,
+                            &sh->NumShaderStorageBlocks,
+                            prog->ShaderStorageBlocks,
+                            prog->NumShaderStorageBlocks))
+      return false;
+
+   blob_copy_bytes(blob, (uint8_t *) &sh->TransformFeedback,
+                   sizeof(sh->TransformFeedback));
+   blob_copy_bytes(blob, (uint8_t *) &sh->TessCtrl, sizeof(sh->TessCtrl));
+   blob_copy_bytes(blob, (uint8_t *) &sh->TessEval, sizeof(sh->TessEval));
+   blob_copy_bytes(blob, (uint8_t *) &sh->Geom, sizeof(sh->Geom));
+   blob_copy_bytes(blob, (uint8_t *) &sh->Comp, sizeof(sh->Comp));
+
+   blob_copy_bytes(blob, (uint8_t *) sh->ImageUnits, sizeof(sh->ImageUnits));
+   blob_copy_bytes(blob, (uint8_t *) sh->ImageAccess,
+                   sizeof(sh->ImageAccess));
+   sh->NumImages = blob_read_uint32(blob);
+
+   sh->NumAtomicBuffers = blob_read_uint32(blob);
+   if (blob->overrun)
+      return false;
+
+   if (sh->NumAtomicBuffers > 0) {
+      sh->AtomicBuffers = rzalloc_array(sh, gl_active_atomic_buffer *,
+                                        sh->NumAtomicBuffers);
+      for (unsigned i = 0; i < sh->NumAtomicBuffers; i++) {
+         uint32_t index = blob_read_uint32(blob);
+         if (index >= prog->NumAtomicBuffers)
+            return false;
+         sh->AtomicBuffers[i] = &prog->AtomicBuffers[index];
+      }
+   }
+
+   sh->NumSubroutineUniformTypes = blob_read_uint32(blob);
+   sh->NumSubroutineUniforms = blob_read_uint32(blob);
+   if (!read_uniform_remap_table(blob, prog, sh,
+                                 &sh->SubroutineUniformRemapTable,
+                                 &sh->NumSubroutineUniformRemapTable))
+      return false;
+
+   sh->NumSubroutineFunctions = blob_read_uint32(blob);
+   sh->MaxSubroutineFunctionIndex = blob_read_uint32(blob);
+   if (blob->overrun)
+      return false;
+
+   if (sh->NumSubroutineFunctions > 0) {
+      sh->SubroutineFunctions = rzalloc_array(sh, struct gl_subroutine_function,
+                                              sh->NumSubroutineFunctions);
+   }
+
+   for (unsigned i = 0; i < sh->NumSubroutineFunctions; i++) {
+      struct gl_subroutine_function *fn = &sh->SubroutineFunctions[i];
+      const char *name = blob_read_string(blob);
+
+      if (name == NULL)
+         return false;
+
+      fn->name = ralloc_strdup(sh, name);
+      fn->index = blob_read_uint32(blob);
+      fn->num_compat_types = blob_read_uint32(blob);
+      if (blob->overrun)
+         return false;
+
+      fn->types = ralloc_array(sh, const struct glsl_type *,
+                               fn->num_compat_types);
+      for (int j = 0; j < fn->num_compat_types; j++)
+         fn->types[j] = decode_type_from_blob(blob);
+   }
+
+   ir_deserializer d(blob, sh);
+
+   sh->ir = new(sh) exec_list;
+   if (!d.read_shader_ir(sh->ir))
+      return false;
+
+   if (blob_read_uint32(blob)) {
+      sh->packed_varyings = new(sh) exec_list;
+      if (!d.read_ir_list(sh->packed_varyings))
+         return false;
+   }
+
+   if (blob_read_uint32(blob)) {
+      sh->fragdata_arrays = new(sh) exec_list;
+      if (!d.read_ir_list(sh->fragdata_arrays))
+         return false;
+   }
+
+   return !blob->overrun;
+}
+
+extern "C" void
+serialize_glsl_program(struct blob *blob, struct gl_context *ctx,
+                       struct gl_shader_program *prog)
+{
+   blob_write_uint32(blob, prog->Version);
+   blob_write_uint32(blob, prog->IsES);
+   blob_write_uint32(blob, prog->ARB_fragment_coord_conventions_enable);
+   blob_write_string(blob, prog->InfoLog ? prog->InfoLog : "");
+
+   blob_write_bytes(blob, prog->TransformFeedback.BufferStride,
+                    sizeof(prog->TransformFeedback.BufferStride));
+   blob_write_bytes(blob, &prog->TessCtrl, sizeof(prog->TessCtrl));
+   blob_write_bytes(blob, &prog->TessEval, sizeof(prog->TessEval));
+   blob_write_bytes(blob, &prog->Geom, sizeof(prog->Geom));
+   blob_write_bytes(blob, &prog->Vert, sizeof(prog->Vert));
+   blob_write_bytes(blob, &prog->Comp, sizeof(prog->Comp));
+   blob_write_uint32(blob, prog->FragDepthLayout);
+   blob_write_uint32(blob, prog->LastClipDistanceArraySize);
+   blob_write_uint32(blob, prog->LastCullDistanceArraySize);
+
+   write_uniform_blocks(blob, prog->UniformBlocks, prog->NumUniformBlocks);
+   write_uniform_blocks(blob, prog->ShaderStorageBlocks,
+                        prog->NumShaderStorageBlocks);
+   write_atomic_buffers(blob, prog);
+   write_uniforms(blob, prog);
+   write_xfb(blob, prog);
+
+   for (unsigned i = 0; i < MESA_SHADER_STAGES; i++) {
+      struct gl_shader *sh = prog->_LinkedShaders[i];
+
+      blob_write_uint32(blob, sh != NULL);
+      if (sh != NULL)
+         write_linked_shader(blob, prog, sh);
+   }
+}
+
+extern "C" bool
+deserialize_glsl_program(struct blob_reader *blob, struct gl_context *ctx,
+                         struct gl_shader_program *prog)
+{
+   bool ok = false;
+
+   /* Same as the beginning of link_shaders(). */
+   prog->LinkStatus = true;
+   prog->Validated = false;
+   prog->_Used = false;
+
+   for (unsigned i = 0; i < MESA_SHADER_STAGES; i++) {
+      if (prog->_LinkedShaders[i] != NULL)
+         _mesa_delete_shader(ctx, prog->_LinkedShaders[i]);
+
+      prog->_LinkedShaders[i] = NULL;
+   }
+
+   prog->Version = blob_read_uint32(blob);
+   prog->IsES = blob_read_uint32(blob);
+   prog->ARB_fragment_coord_conventions_enable = blob_read_uint32(blob);
+
+   const char *info_log = blob_read_string(blob);
+   if (info_log == NULL)
+      goto fail;
+
+   ralloc_free(prog->InfoLog);
+   prog->InfoLog = ralloc_strdup(prog, info_log);
+
+   blob_copy_bytes(blob, (uint8_t *) prog->TransformFeedback.BufferStride,
+                   sizeof(prog->TransformFeedback.BufferStride));
+   blob_copy_bytes(blob, (uint8_t *) &prog->TessCtrl, sizeof(prog->TessCtrl));
+   blob_copy_bytes(blob, (uint8_t *) &prog->TessEval, sizeof(prog->TessEval));
+   blob_copy_bytes(blob, (uint8_t *) &prog->Geom, sizeof(prog->Geom));
+   blob_copy_bytes(blob, (uint8_t *) &prog->Vert, sizeof(prog->Vert));
+   blob_copy_bytes(blob, (uint8_t *) &prog->Comp, sizeof(prog->Comp));
+   prog->FragDepthLayout = (enum gl_frag_depth_layout) blob_read_uint32(blob);
+   prog->LastClipDistanceArraySize = blob_read_uint32(blob);
+   prog->LastCullDistanceArraySize = blob_read_uint32(blob);
+
+   if (!read_uniform_blocks(blob, prog, &prog->UniformBlocks,
+                            &prog->NumUniformBlocks) ||
+       !read_uniform_blocks(blob, prog, &prog->ShaderStorageBlocks,
+                            &prog->NumShaderStorageBlocks) ||
+       !read_atomic_buffers(blob, prog) ||
+       !read_uniforms(blob, prog) ||
+       !read_xfb(blob, prog))
+      goto fail;
+
+   for (unsigned i = 0; i < MESA_SHADER_STAGES; i++) {
+      if (!blob_read_uint32(blob))
+         continue;
+
+      struct gl_shader *sh = ctx->Driver.NewShader(NULL, 0, (gl_shader_stage) i);
+      prog->_LinkedShaders[i] = sh;
+
+      if (!read_linked_shader(blob, prog, sh))
+         goto fail;
+   }
+
+   ok = !blob->overrun && blob->current == blob->end;
+
+ fail:
+   if (!ok) {
+      for (unsigned i = 0; i < MESA_SHADER_STAGES; i++) {
+         if (prog->_LinkedShaders[i] != NULL)
+            _mesa_delete_shader(ctx, prog->_LinkedShaders[i]);
+
+         prog->_LinkedShaders[i] = NULL;
+      }
+
+      _mesa_clear_shader_program_data(prog);
+      prog->LinkStatus = false;
+   }
+
+   return ok;
+}
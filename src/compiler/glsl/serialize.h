@@ -0,0 +1,71 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#ifndef GLSL_SERIALIZE_H
+#define GLSL_SERIALIZE_H
+
+#include <stdbool.h>
+
+struct blob;
+struct blob_reader;
+struct gl_context;
+struct gl_shader_program;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Write the result of link_shaders() to \p blob
+ *
+ * This captures the state the GLSL linker leaves in \p prog and its linked
+ * shaders: the linked IR of each stage, the uniform storage (including the
+ * initial uniform values), uniform and shader storage blocks, atomic counter
+ * buffers, transform feedback and subroutine information, and the layout
+ * qualifier state.  It must be called before the driver's LinkShader hook,
+ * which lowers the linked IR in place.
+ *
+ * The encoding is only meant to be read back by the same build of Mesa.
+ */
+void
+serialize_glsl_program(struct blob *blob, struct gl_context *ctx,
+                       struct gl_shader_program *prog);
+
+/**
+ * Restore the state written by serialize_glsl_program() into \p prog
+ *
+ * On success \p prog is in the same state as after a successful call to
+ * link_shaders(), and the caller is expected to continue with the driver's
+ * LinkShader hook.  On failure the linked state of \p prog is cleared again
+ * and \c false is returned.
+ */
+bool
+deserialize_glsl_program(struct blob_reader *blob, struct gl_context *ctx,
+                         struct gl_shader_program *prog);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* GLSL_SERIALIZE_H */
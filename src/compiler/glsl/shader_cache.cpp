@@ -0,0 +1,399 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file shader_cache.cpp
+ *
+ * GLSL glue for the on-disk shader cache.
+ *
+ * A shader whose key is in the cache is known to have compiled and linked
+ * successfully before, so glCompileShader only records its key.  At link
+ * time the program key, made of the shader keys and the link-time API state,
+ * is looked up and on a hit the program is restored to the state the linker
+ * would have left it in.  Only the driver's LinkShader hook runs in that
+ * case.  On a miss the skipped shaders are compiled and the program is
+ * linked as usual.
+ */
+
+#include <stdio.h>
+
+#include "main/core.h"
+#include "main/mtypes.h"
+#include "blob.h"
+#include "program.h"
+#include "serialize.h"
+#include "shader_cache.h"
+#include "program/hash_table.h"
+
+extern "C" void
+shader_cache_init(struct gl_context *ctx)
+{
+   if (ctx->CacheInitialized)
+      return;
+
+   ctx->CacheInitialized = GL_TRUE;
+
+   /* Dumping and logging shaders need the full compile to happen. */
+   if (ctx->_Shader->Flags & (GLSL_DUMP | GLSL_LOG))
+      return;
+
+   uint32_t timestamp;
+   if (!disk_cache_get_function_timestamp((void *) shader_cache_init,
+                                          &timestamp))
+      return;
+
+   char timestamp_str[16];
+   snprintf(timestamp_str, sizeof(timestamp_str), "%u", timestamp);
+
+   const char *renderer = NULL;
+   if (ctx->Driver.GetString)
+      renderer = (const char *) ctx->Driver.GetString(ctx, GL_RENDERER);
+
+   ctx->Cache = disk_cache_create(renderer ? renderer : "mesa",
+                                  timestamp_str);
+}
+
+static void
+write_program_constants(struct blob *blob,
+                        const struct gl_program_constants *consts)
+{
+   blob_write_uint32(blob, consts->MaxAttribs);
+   blob_write_uint32(blob, consts->MaxUniformComponents);
+   blob_write_uint32(blob, consts->MaxInputComponents);
+   blob_write_uint32(blob, consts->MaxOutputComponents);
+   blob_write_uint32(blob, consts->MaxUniformBlocks);
+   blob_write_uint32(blob, consts->MaxCombinedUniformComponents);
+   blob_write_uint32(blob, consts->MaxTextureImageUnits);
+   blob_write_uint32(blob, consts->MaxAtomicBuffers);
+   blob_write_uint32(blob, consts->MaxAtomicCounters);
+   blob_write_uint32(blob, consts->MaxImageUniforms);
+   blob_write_uint32(blob, consts->MaxShaderStorageBlocks);
+}
+
+static void
+write_compiler_options(struct blob *blob,
+                       const struct gl_shader_compiler_options *options)
+{
+   /* NirOptions is a pointer, and what it points to only matters to the
+    * driver's backend, which runs again on a cache hit anyway.
+    */
+   blob_write_uint32(blob, options->EmitNoLoops);
+   blob_write_uint32(blob, options->EmitNoFunctions);
+   blob_write_uint32(blob, options->EmitNoCont);
+   blob_write_uint32(blob, options->EmitNoMainReturn);
+   blob_write_uint32(blob, options->EmitNoNoise);
+   blob_write_uint32(blob, options->EmitNoPow);
+   blob_write_uint32(blob, options->EmitNoSat);
+   blob_write_uint32(blob, options->LowerCombinedClipCullDistance);
+   blob_write_uint32(blob, options->EmitNoIndirectInput);
+   blob_write_uint32(blob, options->EmitNoIndirectOutput);
+   blob_write_uint32(blob, options->EmitNoIndirectTemp);
+   blob_write_uint32(blob, options->EmitNoIndirectUniform);
+   blob_write_uint32(blob, options->EmitNoIndirectSampler);
+   blob_write_uint32(blob, options->MaxIfDepth);
+   blob_write_uint32(blob, options->MaxUnrollIterations);
+   blob_write_uint32(blob, options->OptimizeForAOS);
+   blob_write_uint32(blob, options->LowerBufferInterfaceBlocks);
+   blob_write_uint32(blob, options->ClampBlockIndicesToArrayBounds);
+   blob_write_uint32(blob, options->LowerShaderSharedVariables);
+}
+
+/**
+ * Write the limits and options in gl_constants that the compiler and linker
+ * read.  The fields are written one by one rather than as a copy of the
+ * struct, which would also hash its padding and pointers.
+ */
+static void
+write_constants(struct blob *blob, const struct gl_constants *consts)
+{
+   for (unsigned i = 0; i < MESA_SHADER_STAGES; i++) {
+      write_program_constants(blob, &consts->Program[i]);
+      write_compiler_options(blob, &consts->ShaderCompilerOptions[i]);
+   }
+
+   blob_write_uint32(blob, consts->MaxLights);
+   blob_write_uint32(blob, consts->MaxClipPlanes);
+   blob_write_uint32(blob, consts->MaxTextureUnits);
+   blob_write_uint32(blob, consts->MaxTextureCoordUnits);
+   blob_write_uint32(blob, consts->MaxCombinedTextureImageUnits);
+   blob_write_uint32(blob, consts->MaxDrawBuffers);
+   blob_write_uint32(blob, consts->MaxDualSourceDrawBuffers);
+   blob_write_uint32(blob, consts->MaxSamples);
+   blob_write_uint32(blob, consts->MaxViewports);
+   blob_write_uint32(blob, consts->MaxVarying);
+   blob_write_uint32(blob, consts->MinProgramTexelOffset);
+   blob_write_uint32(blob, consts->MaxProgramTexelOffset);
+
+   blob_write_uint32(blob, consts->MaxCombinedUniformBlocks);
+   blob_write_uint32(blob, consts->MaxUniformBufferBindings);
+   blob_write_uint32(blob, consts->MaxUniformBlockSize);
+   blob_write_uint32(blob, consts->MaxCombinedShaderStorageBlocks);
+   blob_write_uint32(blob, consts->MaxShaderStorageBufferBindings);
+   blob_write_uint32(blob, consts->MaxShaderStorageBlockSize);
+   blob_write_uint32(blob, consts->MaxUserAssignableUniformLocations);
+
+   blob_write_uint32(blob, consts->MaxGeometryOutputVertices);
+   blob_write_uint32(blob, consts->MaxGeometryTotalOutputComponents);
+   blob_write_uint32(blob, consts->MaxVertexStreams);
+   blob_write_uint32(blob, consts->MaxTransformFeedbackBuffers);
+   blob_write_uint32(blob, consts->MaxTransformFeedbackSeparateComponents);
+   blob_write_uint32(blob, consts->MaxTransformFeedbackInterleavedComponents);
+
+   blob_write_uint32(blob, consts->MaxAtomicBufferBindings);
+   blob_write_uint32(blob, consts->MaxAtomicBufferSize);
+   blob_write_uint32(blob, consts->MaxCombinedAtomicBuffers);
+   blob_write_uint32(blob, consts->MaxCombinedAtomicCounters);
+   blob_write_uint32(blob, consts->MaxImageUnits);
+   blob_write_uint32(blob, consts->MaxCombinedShaderOutputResources);
+   blob_write_uint32(blob, consts->MaxImageSamples);
+   blob_write_uint32(blob, consts->MaxCombinedImageUniforms);
+
+   for (unsigned i = 0; i < 3; i++) {
+      blob_write_uint32(blob, consts->MaxComputeWorkGroupCount[i]);
+      blob_write_uint32(blob, consts->MaxComputeWorkGroupSize[i]);
+   }
+   blob_write_uint32(blob, consts->MaxComputeWorkGroupInvocations);
+   blob_write_uint32(blob, consts->MaxComputeSharedMemorySize);
+
+   blob_write_uint32(blob, consts->MaxPatchVertices);
+   blob_write_uint32(blob, consts->MaxTessGenLevel);
+   blob_write_uint32(blob, consts->MaxTessPatchComponents);
+   blob_write_uint32(blob, consts->MaxTessControlTotalOutputComponents);
+
+   blob_write_uint32(blob, consts->GLSLVersion);
+   blob_write_uint32(blob, consts->ForceGLSLVersion);
+   blob_write_uint32(blob, consts->ForceGLSLExtensionsWarn);
+   blob_write_uint32(blob, consts->AllowGLSLExtensionDirectiveMidShader);
+   blob_write_uint32(blob, consts->DisableGLSLLineContinuations);
+   blob_write_uint32(blob, consts->GLSLSkipStrictMaxUniformLimitCheck);
+   blob_write_uint32(blob, consts->GLSLFragCoordIsSysVal);
+   blob_write_uint32(blob, consts->GLSLFrontFacingIsSysVal);
+   blob_write_uint32(blob, consts->NativeIntegers);
+   blob_write_uint32(blob, consts->VertexID_is_zero_based);
+   blob_write_uint32(blob, consts->UniformBooleanTrue);
+   blob_write_uint32(blob, consts->DisableVaryingPacking);
+   blob_write_uint32(blob, consts->GenerateTemporaryNames);
+   blob_write_uint32(blob, consts->LowerTessLevel);
+   blob_write_uint32(blob, consts->LowerTCSPatchVerticesIn);
+   blob_write_uint32(blob, consts->LowerTESPatchVerticesIn);
+   blob_write_uint32(blob, consts->LowerCsDerivedVariables);
+}
+
+/**
+ * Write all context state that the result of compiling or linking depends
+ * on.
+ */
+static void
+write_compile_state(struct blob *blob, struct gl_context *ctx)
+{
+   blob_write_uint32(blob, ctx->API);
+   blob_write_uint32(blob, ctx->Version);
+   blob_write_uint32(blob, ctx->_Shader->Flags);
+   blob_write_bytes(blob, &ctx->Extensions,
+                    offsetof(struct gl_extensions, extension_sentinel));
+   write_constants(blob, &ctx->Const);
+}
+
+struct binding {
+   const char *name;
+   unsigned value;
+};
+
+struct binding_list {
+   void *mem_ctx;
+   struct binding *bindings;
+   unsigned count;
+};
+
+static void
+collect_binding(const char *name, unsigned value, void *closure)
+{
+   struct binding_list *list = (struct binding_list *) closure;
+
+   list->bindings = reralloc(list->mem_ctx, list->bindings, struct binding,
+                             list->count + 1);
+   list->bindings[list->count].name = name;
+   list->bindings[list->count].value = value;
+   list->count++;
+}
+
+static int
+compare_bindings(const void *a, const void *b)
+{
+   return strcmp(((const struct binding *) a)->name,
+                 ((const struct binding *) b)->name);
+}
+
+/**
+ * Write the contents of \p map sorted by name, so that the same bindings
+ * made in a different order give the same key.
+ */
+static void
+write_bindings(struct blob *blob, struct string_to_uint_map *map)
+{
+   struct binding_list list = { blob, NULL, 0 };
+
+   if (map != NULL)
+      map->iterate(collect_binding, &list);
+
+   if (list.count > 1)
+      qsort(list.bindings, list.count, sizeof(struct binding),
+            compare_bindings);
+
+   blob_write_uint32(blob, list.count);
+   for (unsigned i = 0; i < list.count; i++) {
+      blob_write_string(blob, list.bindings[i].name);
+      blob_write_uint32(blob, list.bindings[i].value);
+   }
+
+   ralloc_free(list.bindings);
+}
+
+static void
+compute_program_key(struct gl_context *ctx, struct gl_shader_program *prog,
+                    cache_key key)
+{
+   struct blob *blob = blob_create(NULL);
+
+   write_compile_state(blob, ctx);
+
+   blob_write_uint32(blob, prog->NumShaders);
+   for (unsigned i = 0; i < prog->NumShaders; i++) {
+      blob_write_uint32(blob, prog->Shaders[i]->Stage);
+      blob_write_bytes(blob, prog->Shaders[i]->sha1,
+                       sizeof(prog->Shaders[i]->sha1));
+   }
+
+   write_bindings(blob, prog->AttributeBindings);
+   write_bindings(blob, prog->FragDataBindings);
+   write_bindings(blob, prog->FragDataIndexBindings);
+
+   blob_write_uint32(blob, prog->TransformFeedback.BufferMode);
+   blob_write_uint32(blob, prog->TransformFeedback.NumVarying);
+   for (unsigned i = 0; i < prog->TransformFeedback.NumVarying; i++)
+      blob_write_string(blob, prog->TransformFeedback.VaryingNames[i]);
+
+   blob_write_uint32(blob, prog->SeparateShader);
+
+   disk_cache_compute_key(ctx->Cache, blob->data, blob->size, key);
+   ralloc_free(blob);
+}
+
+extern "C" bool
+shader_cache_lookup_shader(struct gl_context *ctx, struct gl_shader *sh)
+{
+   shader_cache_init(ctx);
+
+   if (ctx->Cache == NULL)
+      return false;
+
+   struct blob *blob = blob_create(NULL);
+
+   write_compile_state(blob, ctx);
+   blob_write_uint32(blob, sh->Stage);
+   blob_write_string(blob, sh->Source);
+
+   disk_cache_compute_key(ctx->Cache, blob->data, blob->size, sh->sha1);
+   ralloc_free(blob);
+
+   return disk_cache_has_key(ctx->Cache, sh->sha1);
+}
+
+extern "C" bool
+shader_cache_compile_skipped_shaders(struct gl_context *ctx,
+                                     struct gl_shader_program *prog)
+{
+   for (unsigned i = 0; i < prog->NumShaders; i++) {
+      struct gl_shader *sh = prog->Shaders[i];
+
+      if (!sh->CompileSkipped)
+         continue;
+
+      /* The source may have been replaced since the skipped compile. */
+      const GLchar *source = sh->Source;
+      if (sh->FallbackSource != NULL)
+         sh->Source = sh->FallbackSource;
+
+      _mesa_glsl_compile_shader(ctx, sh, false, false, true);
+
+      sh->Source = source;
+      if (sh->FallbackSource != NULL) {
+         free((void *) sh->FallbackSource);
+         sh->FallbackSource = NULL;
+      }
+
+      if (!sh->CompileStatus) {
+         linker_error(prog, "%s shader failed to compile after a shader "
+                      "cache miss:\n%s\n",
+                      _mesa_shader_stage_to_string(sh->Stage), sh->InfoLog);
+         return false;
+      }
+   }
+
+   return true;
+}
+
+extern "C" bool
+shader_cache_read_program(struct gl_context *ctx,
+                          struct gl_shader_program *prog, cache_key key)
+{
+   shader_cache_init(ctx);
+
+   if (ctx->Cache == NULL)
+      return false;
+
+   compute_program_key(ctx, prog, key);
+
+   size_t size;
+   uint8_t *buffer = (uint8_t *) disk_cache_get(ctx->Cache, key, &size);
+   if (buffer == NULL)
+      return false;
+
+   struct blob_reader blob;
+   blob_reader_init(&blob, buffer, size);
+
+   bool ok = deserialize_glsl_program(&blob, ctx, prog);
+   free(buffer);
+
+   if (!ok) {
+      /* The entry is unusable, so let a regular link replace it. */
+      disk_cache_remove(ctx->Cache, key);
+      prog->LinkStatus = GL_TRUE;
+   }
+
+   return ok;
+}
+
+extern "C" void
+shader_cache_write_program(struct gl_context *ctx,
+                           struct gl_shader_program *prog,
+                           const cache_key key, const struct blob *blob)
+{
+   if (ctx->Cache == NULL)
+      return;
+
+   disk_cache_put(ctx->Cache, key, blob->data, blob->size);
+
+   for (unsigned i = 0; i < prog->NumShaders; i++)
+      disk_cache_put_key(ctx->Cache, prog->Shaders[i]->sha1);
+}
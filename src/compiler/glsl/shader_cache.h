@@ -0,0 +1,94 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+#ifndef GLSL_SHADER_CACHE_H
+#define GLSL_SHADER_CACHE_H
+
+#include "util/disk_cache.h"
+
+struct blob;
+struct gl_context;
+struct gl_shader;
+struct gl_shader_program;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Open the cache of \p ctx if that was not attempted yet
+ *
+ * This happens on the first compile or link.  Callers that go on to compile
+ * on other threads must call it first.
+ */
+void
+shader_cache_init(struct gl_context *ctx);
+
+/**
+ * Compute the cache key of \p sh and check whether it is known to compile
+ *
+ * The key covers the source, the stage and all context state that affects
+ * compilation.  It is stored in \c gl_shader::sha1.
+ *
+ * \return \c true if the shader was part of a program that linked
+ * successfully before, in which case compiling it can be deferred until the
+ * program misses the cache.
+ */
+bool
+shader_cache_lookup_shader(struct gl_context *ctx, struct gl_shader *sh);
+
+/**
+ * Compile the attached shaders whose compilation was skipped
+ *
+ * Must be called before linking a program that missed the cache.  On
+ * failure a linker error is recorded in \p prog.
+ */
+bool
+shader_cache_compile_skipped_shaders(struct gl_context *ctx,
+                                     struct gl_shader_program *prog);
+
+/**
+ * Compute the cache key of \p prog and try to restore it from the cache
+ *
+ * \return \c true if \p prog was restored to the state after link_shaders().
+ * \p key is set in any case.
+ */
+bool
+shader_cache_read_program(struct gl_context *ctx,
+                          struct gl_shader_program *prog, cache_key key);
+
+/**
+ * Store a program serialized by serialize_glsl_program() under \p key and
+ * remember its shaders as successfully compiled.
+ */
+void
+shader_cache_write_program(struct gl_context *ctx,
+                           struct gl_shader_program *prog,
+                           const cache_key key, const struct blob *blob);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* GLSL_SHADER_CACHE_H */
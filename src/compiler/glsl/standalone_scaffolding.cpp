@@ -88,6 +88,7 @@ void
 _mesa_delete_shader(struct gl_context *ctx, struct gl_shader *sh)
 {
    free((void *)sh->Source);
+   free((void *)sh->FallbackSource);
    free(sh->Label);
    ralloc_free(sh);
 }
@@ -97,6 +98,8 @@ _mesa_clear_shader_program_data(struct gl_shader_program *shProg)
 {
    shProg->NumUniformStorage = 0;
    shProg->UniformStorage = NULL;
+   shProg->NumUniformDataSlots = 0;
+   shProg->UniformDataSlots = NULL;
    shProg->NumUniformRemapTable = 0;
    shProg->UniformRemapTable = NULL;
    shProg->UniformHash = NULL;
@@ -115,6 +118,9 @@ _mesa_clear_shader_program_data(struct gl_shader_program *shProg)
    ralloc_free(shProg->AtomicBuffers);
    shProg->AtomicBuffers = NULL;
    shProg->NumAtomicBuffers = 0;
+
+   ralloc_free(shProg->Binary);
+   shProg->Binary = NULL;
 }
 
 void initialize_context_to_defaults(struct gl_context *ctx, gl_api api)
@@ -0,0 +1,240 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include <gtest/gtest.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <map>
+#include <string>
+#include "main/compiler.h"
+#include "main/mtypes.h"
+#include "main/macros.h"
+#include "ir.h"
+#include "ir_optimization.h"
+#include "program.h"
+
+/**
+ * \file opt_pass_manager_test.cpp
+ *
+ * Optimizes the IR of some built-in functions with and without an
+ * opt_pass_manager, which must not change the result.  That only holds if
+ * every pass reports all of its changes as progress, which is checked for
+ * the passes that used to miss some.
+ */
+
+namespace {
+
+class opt_pass_manager_test : public ::testing::Test {
+public:
+   virtual void SetUp();
+   virtual void TearDown();
+
+   void check(const char *name, bool linked, bool aos, bool native_integers);
+
+   void *mem_ctx;
+};
+
+void
+opt_pass_manager_test::SetUp()
+{
+   this->mem_ctx = ralloc_context(NULL);
+   _mesa_glsl_initialize_builtin_functions();
+}
+
+void
+opt_pass_manager_test::TearDown()
+{
+   ralloc_free(this->mem_ctx);
+   this->mem_ctx = NULL;
+}
+
+/**
+ * Prints the IR, numbering conflicting variable names from 1 in each
+ * printout instead of with the printer's global counters.
+ */
+std::string
+print(exec_list *ir)
+{
+   char *buf;
+   size_t size;
+   FILE *f = open_memstream(&buf, &size);
+
+   _mesa_print_ir(f, ir, NULL);
+   fclose(f);
+
+   const std::string s(buf, size);
+   std::map<std::string, unsigned> ids;
+   std::string out;
+
+   free(buf);
+
+   for (size_t i = 0; i < s.size(); i++) {
+      out += s[i];
+      if (s[i] != '@')
+         continue;
+
+      size_t j = i + 1;
+      while (j < s.size() && isdigit(s[j]))
+         j++;
+
+      const std::string num = s.substr(i + 1, j - i - 1);
+      if (ids.find(num) == ids.end()) {
+         const unsigned id = ids.size() + 1;
+         ids[num] = id;
+      }
+      char id[16];
+      snprintf(id, sizeof(id), "%u", ids[num]);
+      out += id;
+      i = j - 1;
+   }
+
+   return out;
+}
+
+void
+opt_pass_manager_test::check(const char *name, bool linked, bool aos,
+                             bool native_integers)
+{
+   ir_function *f = _mesa_glsl_find_builtin_function_by_name(name);
+   ASSERT_TRUE(f != NULL) << name;
+
+   gl_shader_compiler_options options;
+   memset(&options, 0, sizeof(options));
+   options.MaxUnrollIterations = 32;
+   options.MaxIfDepth = UINT_MAX;
+   options.OptimizeForAOS = aos;
+
+   exec_list a, b;
+   a.push_tail(f->clone(this->mem_ctx, NULL));
+   b.push_tail(f->clone(this->mem_ctx, NULL));
+
+   /* Linked shaders keep nothing but main and what it calls. */
+   if (linked) {
+      ((ir_function *) a.get_head())->name = "main";
+      ((ir_function *) b.get_head())->name = "main";
+   }
+
+   while (do_common_optimization(&a, linked, false, &options,
+                                 native_integers))
+      ;
+
+   opt_pass_manager pm;
+   while (do_common_optimization(&b, linked, false, &options,
+                                 native_integers, &pm))
+      ;
+
+   EXPECT_EQ(print(&a), print(&b))
+      << name << (linked ? " linked" : " unlinked")
+      << (aos ? " AOS" : "")
+      << (native_integers ? " native integers" : "");
+}
+
+/**
+ * Builds a sum of \c n of the \c leaves, in the shape selected by \c code.
+ */
+ir_rvalue *
+sum_tree(void *mem_ctx, ir_variable **leaves, unsigned n, unsigned &code)
+{
+   if (n == 1)
+      return new(mem_ctx) ir_dereference_variable(leaves[0]);
+
+   const unsigned left = 1 + code % (n - 1);
+   code /= n - 1;
+
+   ir_rvalue *const a = sum_tree(mem_ctx, leaves, left, code);
+   ir_rvalue *const b = sum_tree(mem_ctx, leaves + left, n - left, code);
+   return new(mem_ctx) ir_expression(ir_binop_add, a, b);
+}
+
+} /* anonymous namespace */
+
+TEST_F(opt_pass_manager_test, same_ir)
+{
+   static const char *const names[] = {
+      "smoothstep", "refract", "faceforward", "mix", "clamp", "atan",
+      "frexp", "ldexp", "packHalf2x16", "unpackHalf2x16", "bitfieldReverse",
+      "findMSB", "uaddCarry", "umulExtended", "modf", "length",
+   };
+
+   for (unsigned i = 0; i < ARRAY_SIZE(names); i++) {
+      for (unsigned variant = 0; variant < 8; variant++)
+         check(names[i], variant & 1, variant & 2, variant & 4);
+   }
+}
+
+/**
+ * Rebalancing can keep the root of a sum and reshape what's below it.
+ */
+TEST_F(opt_pass_manager_test, rebalance_reports_reshaping)
+{
+   const unsigned n = 6;
+   ir_variable *leaves[n];
+
+   /* Every shape of a sum of n leaves, and then some duplicates. */
+   for (unsigned shape = 0; shape < 120; shape++) {
+      exec_list ir;
+
+      for (unsigned i = 0; i < n; i++) {
+         leaves[i] = new(this->mem_ctx) ir_variable(glsl_type::float_type,
+                                                    "v", ir_var_auto);
+         ir.push_tail(leaves[i]);
+      }
+
+      ir_variable *const out =
+         new(this->mem_ctx) ir_variable(glsl_type::float_type, "out",
+                                        ir_var_auto);
+      ir.push_tail(out);
+
+      unsigned code = shape;
+      ir_rvalue *const sum = sum_tree(this->mem_ctx, leaves, n, code);
+      ir.push_tail(new(this->mem_ctx)
+                   ir_assignment(new(this->mem_ctx)
+                                 ir_dereference_variable(out), sum));
+
+      for (unsigned round = 0; round < 3; round++) {
+         const std::string before = print(&ir);
+         if (!do_rebalance_tree(&ir))
+            EXPECT_EQ(before, print(&ir)) << "shape " << shape;
+      }
+   }
+}
+
+/**
+ * Removing the redundant return at the end of a void function is progress.
+ */
+TEST_F(opt_pass_manager_test, lower_jumps_reports_final_return)
+{
+   ir_function *f = new(this->mem_ctx) ir_function("main");
+   ir_function_signature *sig =
+      new(this->mem_ctx) ir_function_signature(glsl_type::void_type);
+   sig->is_defined = true;
+   sig->body.push_tail(new(this->mem_ctx) ir_return);
+   f->add_signature(sig);
+
+   exec_list ir;
+   ir.push_tail(f);
+
+   EXPECT_TRUE(do_lower_jumps(&ir));
+   EXPECT_TRUE(sig->body.is_empty());
+   EXPECT_FALSE(do_lower_jumps(&ir));
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "c11/threads.h"
+#include "main/compiler.h"
+#include "main/mtypes.h"
+#include "main/macros.h"
+#include "ir.h"
+
+/**
+ * \file type_instance_test.cpp
+ *
+ * Test that the glsl_type::get_*_instance() functions and the built-in
+ * function lookups return a single object per key, also when they are
+ * called from several threads at once.
+ */
+
+namespace {
+
+const unsigned num_threads = 8;
+const unsigned num_keys = 200;
+
+struct lookups {
+   const glsl_type *arrays[num_keys];
+   const glsl_type *records[num_keys];
+   const glsl_type *interfaces[num_keys];
+   const glsl_type *subroutines[num_keys];
+   const glsl_type *functions[num_keys];
+   ir_function *builtins[4];
+};
+
+glsl_struct_field
+field(const glsl_type *type, const char *name)
+{
+   /* The glsl_struct_field constructor leaves some members uninitialized. */
+   glsl_struct_field f;
+   memset(&f, 0, sizeof(f));
+   f.type = type;
+   f.name = name;
+   f.location = -1;
+   return f;
+}
+
+void
+get_instances(lookups *l)
+{
+   static const char *const builtin_names[ARRAY_SIZE(l->builtins)] = {
+      "smoothstep", "texture", "packHalf2x16", "frexp",
+   };
+
+   for (unsigned i = 0; i < num_keys; i++) {
+      char name[32];
+      snprintf(name, sizeof(name), "s%u", i);
+
+      l->arrays[i] = glsl_type::get_array_instance(glsl_type::vec4_type, i);
+
+      const glsl_struct_field fields[2] = {
+         field(glsl_type::float_type, "a"),
+         field(l->arrays[i], "b"),
+      };
+      l->records[i] = glsl_type::get_record_instance(fields, 2, name);
+      l->interfaces[i] =
+         glsl_type::get_interface_instance(fields, 2,
+                                           GLSL_INTERFACE_PACKING_STD430,
+                                           name);
+      l->subroutines[i] = glsl_type::get_subroutine_instance(name);
+
+      glsl_function_param param;
+      param.type = l->arrays[i];
+      param.in = true;
+      param.out = false;
+      l->functions[i] =
+         glsl_type::get_function_instance(glsl_type::void_type, &param, 1);
+   }
+
+   for (unsigned i = 0; i < ARRAY_SIZE(l->builtins); i++)
+      l->builtins[i] = _mesa_glsl_find_builtin_function_by_name(builtin_names[i]);
+}
+
+int
+get_instances_thread(void *data)
+{
+   get_instances((lookups *) data);
+   return 0;
+}
+
+} /* anonymous namespace */
+
+TEST(type_instance, distinct_keys)
+{
+   glsl_struct_field fields[1] = { field(glsl_type::float_type, "a") };
+   const glsl_type *const record =
+      glsl_type::get_record_instance(fields, 1, "distinct");
+
+   EXPECT_EQ(record, glsl_type::get_record_instance(fields, 1, "distinct"));
+   EXPECT_NE(record, glsl_type::get_record_instance(fields, 1, "other"));
+   EXPECT_NE(record,
+             glsl_type::get_interface_instance(fields, 1,
+                                               GLSL_INTERFACE_PACKING_STD140,
+                                               "distinct"));
+
+   fields[0].location = 3;
+   EXPECT_NE(record, glsl_type::get_record_instance(fields, 1, "distinct"));
+
+   glsl_function_param param;
+   param.type = glsl_type::int_type;
+   param.in = true;
+   param.out = false;
+   const glsl_type *const in =
+      glsl_type::get_function_instance(glsl_type::void_type, &param, 1);
+
+   param.out = true;
+   const glsl_type *const inout =
+      glsl_type::get_function_instance(glsl_type::void_type, &param, 1);
+
+   EXPECT_NE(in, inout);
+   EXPECT_NE(in, glsl_type::get_function_instance(glsl_type::void_type,
+                                                  &param, 0));
+   EXPECT_EQ(inout, glsl_type::get_function_instance(glsl_type::void_type,
+                                                     &param, 1));
+}
+
+TEST(type_instance, concurrent_lookups)
+{
+   _mesa_glsl_initialize_builtin_functions();
+
+   std::vector<lookups> results(num_threads);
+   thrd_t threads[num_threads];
+
+   for (unsigned i = 0; i < num_threads; i++) {
+      ASSERT_EQ(thrd_success,
+                thrd_create(&threads[i], get_instances_thread, &results[i]));
+   }
+
+   for (unsigned i = 0; i < num_threads; i++)
+      thrd_join(threads[i], NULL);
+
+   for (unsigned i = 0; i < ARRAY_SIZE(results[0].builtins); i++)
+      EXPECT_TRUE(results[0].builtins[i] != NULL);
+
+   for (unsigned i = 1; i < num_threads; i++) {
+      EXPECT_EQ(0, memcmp(&results[0], &results[i], sizeof(lookups)))
+         << "thread " << i << " got different objects";
+   }
+
+   /* Once created, the types are found again. */
+   lookups again;
+   get_instances(&again);
+   EXPECT_EQ(0, memcmp(&results[0], &again, sizeof(lookups)));
+}
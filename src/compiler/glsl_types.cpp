@@ -26,16 +26,160 @@
 #include "compiler/glsl/glsl_parser_extras.h"
 #include "glsl_types.h"
 #include "util/hash_table.h"
+#include "util/u_atomic.h"
+#include "glsl/blob.h"
 
 
 mtx_t glsl_type::mutex = _MTX_INITIALIZER_NP;
-hash_table *glsl_type::array_types = NULL;
-hash_table *glsl_type::record_types = NULL;
-hash_table *glsl_type::interface_types = NULL;
-hash_table *glsl_type::function_types = NULL;
-hash_table *glsl_type::subroutine_types = NULL;
 void *glsl_type::mem_ctx = NULL;
 
+namespace {
+
+/**
+ * Insert-only hash table of the types created at run time.
+ *
+ * Types never change once created, so lookups probe the table without
+ * taking glsl_type::mutex, which only serializes insertions.  Types and
+ * tables are published with p_atomic_cmpxchg(), a full barrier, once
+ * everything they point to has been written, and readers only get to that
+ * through the published pointer.  The hash of a slot is read without such
+ * a dependency, so a reader may see a stale hash and miss a type that was
+ * just added.  That only sends it to type_table_insert(), which searches
+ * again under the mutex.  A table that fills up is replaced by a bigger
+ * copy rather than rehashed in place, so an entry never moves under a
+ * reader, and replaced tables stay allocated until
+ * _mesa_glsl_release_types() because readers may still be probing them.
+ */
+struct type_table {
+   /** Number of slots, a power of two at least twice \c entries. */
+   unsigned size;
+   unsigned entries;
+
+   /** The table this one replaced. */
+   type_table *prev;
+
+   struct slot {
+      uint32_t hash;
+      const glsl_type *type;
+   } slots[1];
+};
+
+typedef type_table *type_table_ptr;
+
+type_table_ptr array_types;
+type_table_ptr record_types;
+type_table_ptr interface_types;
+type_table_ptr subroutine_types;
+type_table_ptr function_types;
+
+/**
+ * Returns the type in \p table that \p key matches, or NULL.  Safe to
+ * call concurrently with type_table_insert().
+ */
+template<typename Key> const glsl_type *
+type_table_search(const type_table_ptr &table, uint32_t hash, const Key &key)
+{
+   const type_table *const t = p_atomic_read(&table);
+
+   if (t == NULL)
+      return NULL;
+
+   const unsigned mask = t->size - 1;
+
+   for (unsigned i = hash & mask; ; i = (i + 1) & mask) {
+      const glsl_type *const type = p_atomic_read(&t->slots[i].type);
+
+      if (type == NULL)
+         return NULL;
+
+      if (t->slots[i].hash == hash && key.matches(type))
+         return type;
+   }
+}
+
+void
+type_table_add(type_table *t, uint32_t hash, const glsl_type *type)
+{
+   const unsigned mask = t->size - 1;
+   unsigned i = hash & mask;
+
+   while (t->slots[i].type != NULL)
+      i = (i + 1) & mask;
+
+   t->slots[i].hash = hash;
+   (void) p_atomic_cmpxchg(&t->slots[i].type, (const glsl_type *) NULL, type);
+   t->entries++;
+}
+
+/**
+ * Adds \p type, which \p key matches, to \p table unless another thread
+ * added a matching type first.  Returns the type that is in the table.
+ */
+template<typename Key> const glsl_type *
+type_table_insert(type_table_ptr &table, mtx_t *mutex, uint32_t hash,
+                  const Key &key, glsl_type *type)
+{
+   mtx_lock(mutex);
+
+   const glsl_type *const existing = type_table_search(table, hash, key);
+   if (existing != NULL) {
+      mtx_unlock(mutex);
+      delete type;
+      return existing;
+   }
+
+   type_table *t = table;
+
+   if (t == NULL || 2 * (t->entries + 1) > t->size) {
+      const unsigned size = t != NULL ? 2 * t->size : 64;
+      type_table *const bigger = (type_table *)
+         calloc(1, sizeof(type_table) + (size - 1) * sizeof(t->slots[0]));
+
+      if (bigger == NULL) {
+         /* Out of memory.  Keep filling the old table while searches still
+          * find an empty slot to stop at, otherwise hand out the type
+          * without adding it.
+          */
+         if (t == NULL || t->entries + 1 >= t->size) {
+            mtx_unlock(mutex);
+            return type;
+         }
+      } else {
+         bigger->size = size;
+         bigger->prev = t;
+
+         for (unsigned i = 0; t != NULL && i < t->size; i++) {
+            if (t->slots[i].type != NULL)
+               type_table_add(bigger, t->slots[i].hash, t->slots[i].type);
+         }
+
+         (void) p_atomic_cmpxchg(&table, t, bigger);
+         t = bigger;
+      }
+   }
+
+   type_table_add(t, hash, type);
+
+   mtx_unlock(mutex);
+
+   return type;
+}
+
+void
+type_table_destroy(type_table_ptr &table)
+{
+   type_table *t = table;
+   table = NULL;
+
+   while (t != NULL) {
+      type_table *const prev = t->prev;
+      free(t);
+      t = prev;
+   }
+}
+
+} /* anonymous namespace */
+
 void
 glsl_type::init_ralloc_type_ctx(void)
 {
@@ -418,20 +562,11 @@ _mesa_glsl_release_types(void)
     * object, or if process terminates), so no mutex-locking should be
     * necessary.
     */
-   if (glsl_type::array_types != NULL) {
-      _mesa_hash_table_destroy(glsl_type::array_types, NULL);
-      glsl_type::array_types = NULL;
-   }
-
-   if (glsl_type::record_types != NULL) {
-      _mesa_hash_table_destroy(glsl_type::record_types, NULL);
-      glsl_type::record_types = NULL;
-   }
-
-   if (glsl_type::interface_types != NULL) {
-      _mesa_hash_table_destroy(glsl_type::interface_types, NULL);
-      glsl_type::interface_types = NULL;
-   }
+   type_table_destroy(array_types);
+   type_table_destroy(record_types);
+   type_table_destroy(interface_types);
+   type_table_destroy(subroutine_types);
+   type_table_destroy(function_types);
 }
 
 
@@ -816,121 +951,92 @@ glsl_type::get_image_instance(enum glsl_sampler_dim dim,
    unreachable("switch statement above should be complete");
 }
 
-const glsl_type *
-glsl_type::get_array_instance(const glsl_type *base, unsigned array_size)
-{
-   /* Generate a name using the base type pointer in the key.  This is
-    * done because the name of the base type may not be unique across
-    * shaders.  For example, two shaders may have different record types
-    * named 'foo'.
-    */
-   char key[128];
-   snprintf(key, sizeof(key), "%p[%u]", (void *) base, array_size);
+namespace {
 
-   mtx_lock(&glsl_type::mutex);
+struct array_key {
+   const glsl_type *base;
+   unsigned array_size;
 
-   if (array_types == NULL) {
-      array_types = _mesa_hash_table_create(NULL, _mesa_key_hash_string,
-                                            _mesa_key_string_equal);
+   uint32_t hash() const
+   {
+      uint32_t hash = _mesa_fnv32_1a_offset_bias;
+      hash = _mesa_fnv32_1a_accumulate(hash, base);
+      hash = _mesa_fnv32_1a_accumulate(hash, array_size);
+      return hash;
    }
 
-   const struct hash_entry *entry = _mesa_hash_table_search(array_types, key);
-   if (entry == NULL) {
-      mtx_unlock(&glsl_type::mutex);
-      const glsl_type *t = new glsl_type(base, array_size);
-      mtx_lock(&glsl_type::mutex);
-
-      entry = _mesa_hash_table_insert(array_types,
-                                      ralloc_strdup(mem_ctx, key),
-                                      (void *) t);
+   bool matches(const glsl_type *t) const
+   {
+      /* Compare with the base type pointer rather than its name, because
+       * the name of the base type may not be unique across shaders.  For
+       * example, two shaders may have different record types named 'foo'.
+       */
+      return t->fields.array == base && t->length == array_size;
    }
+};
 
-   assert(((glsl_type *) entry->data)->base_type == GLSL_TYPE_ARRAY);
-   assert(((glsl_type *) entry->data)->length == array_size);
-   assert(((glsl_type *) entry->data)->fields.array == base);
+} /* anonymous namespace */
 
-   mtx_unlock(&glsl_type::mutex);
+const glsl_type *
+glsl_type::get_array_instance(const glsl_type *base, unsigned array_size)
+{
+   const array_key key = { base, array_size };
+   const uint32_t hash = key.hash();
+   const glsl_type *t = type_table_search(array_types, hash, key);
 
-   return (glsl_type *) entry->data;
-}
+   if (t == NULL) {
+      t = type_table_insert(array_types, &mutex, hash, key,
+                            new glsl_type(base, array_size));
+   }
 
+   assert(t->base_type == GLSL_TYPE_ARRAY);
+   assert(t->length == array_size);
+   assert(t->fields.array == base);
 
-bool
-glsl_type::record_compare(const glsl_type *b, bool match_locations) const
-{
-   if (this->length != b->length)
-      return false;
+   return t;
+}
 
-   if (this->interface_packing != b->interface_packing)
-      return false;
 
-   /* From the GLSL 4.20 specification (Sec 4.2):
-    *
-    *     "Structures must have the same name, sequence of type names, and
-    *     type definitions, and field names to be considered the same type."
-    *
-    * GLSL ES behaves the same (Ver 1.00 Sec 4.2.4, Ver 3.00 Sec 4.2.5).
-    *
-    * Note that we cannot force type name check when comparing unnamed
-    * structure types, these have a unique name assigned during parsing.
-    */
-   if (!this->is_anonymous() && !b->is_anonymous())
-      if (strcmp(this->name, b->name) != 0)
+static bool
+record_fields_equal(const glsl_struct_field *a, const glsl_struct_field *b,
+                    unsigned length, bool match_locations)
+{
+   for (unsigned i = 0; i < length; i++) {
+      if (a[i].type != b[i].type)
          return false;
-
-   for (unsigned i = 0; i < this->length; i++) {
-      if (this->fields.structure[i].type != b->fields.structure[i].type)
+      if (strcmp(a[i].name, b[i].name) != 0)
          return false;
-      if (strcmp(this->fields.structure[i].name,
-                 b->fields.structure[i].name) != 0)
+      if (a[i].matrix_layout != b[i].matrix_layout)
          return false;
-      if (this->fields.structure[i].matrix_layout
-         != b->fields.structure[i].matrix_layout)
-        return false;
-      if (match_locations && this->fields.structure[i].location
-          != b->fields.structure[i].location)
+      if (match_locations && a[i].location != b[i].location)
          return false;
-      if (this->fields.structure[i].offset
-          != b->fields.structure[i].offset)
+      if (a[i].offset != b[i].offset)
          return false;
-      if (this->fields.structure[i].interpolation
-          != b->fields.structure[i].interpolation)
+      if (a[i].interpolation != b[i].interpolation)
          return false;
-      if (this->fields.structure[i].centroid
-          != b->fields.structure[i].centroid)
+      if (a[i].centroid != b[i].centroid)
          return false;
-      if (this->fields.structure[i].sample
-          != b->fields.structure[i].sample)
+      if (a[i].sample != b[i].sample)
          return false;
-      if (this->fields.structure[i].patch
-          != b->fields.structure[i].patch)
+      if (a[i].patch != b[i].patch)
          return false;
-      if (this->fields.structure[i].image_read_only
-          != b->fields.structure[i].image_read_only)
+      if (a[i].image_read_only != b[i].image_read_only)
          return false;
-      if (this->fields.structure[i].image_write_only
-          != b->fields.structure[i].image_write_only)
+      if (a[i].image_write_only != b[i].image_write_only)
          return false;
-      if (this->fields.structure[i].image_coherent
-          != b->fields.structure[i].image_coherent)
+      if (a[i].image_coherent != b[i].image_coherent)
          return false;
-      if (this->fields.structure[i].image_volatile
-          != b->fields.structure[i].image_volatile)
+      if (a[i].image_volatile != b[i].image_volatile)
          return false;
-      if (this->fields.structure[i].image_restrict
-          != b->fields.structure[i].image_restrict)
+      if (a[i].image_restrict != b[i].image_restrict)
          return false;
-      if (this->fields.structure[i].precision
-          != b->fields.structure[i].precision)
+      if (a[i].precision != b[i].precision)
          return false;
-      if (this->fields.structure[i].explicit_xfb_buffer
-          != b->fields.structure[i].explicit_xfb_buffer)
+      if (a[i].explicit_xfb_buffer != b[i].explicit_xfb_buffer)
          return false;
-      if (this->fields.structure[i].xfb_buffer
-          != b->fields.structure[i].xfb_buffer)
+      if (a[i].xfb_buffer != b[i].xfb_buffer)
          return false;
-      if (this->fields.structure[i].xfb_stride
-          != b->fields.structure[i].xfb_stride)
+      if (a[i].xfb_stride != b[i].xfb_stride)
          return false;
    }
 
@@ -939,70 +1045,98 @@ glsl_type::record_compare(const glsl_type *b, bool match_locations) const
 
 
 bool
-glsl_type::record_key_compare(const void *a, const void *b)
+glsl_type::record_compare(const glsl_type *b, bool match_locations) const
 {
-   const glsl_type *const key1 = (glsl_type *) a;
-   const glsl_type *const key2 = (glsl_type *) b;
+   if (this->length != b->length)
+      return false;
+
+   if (this->interface_packing != b->interface_packing)
+      return false;
+
+   /* From the GLSL 4.20 specification (Sec 4.2):
+    *
+    *     "Structures must have the same name, sequence of type names, and
+    *     type definitions, and field names to be considered the same type."
+    *
+    * GLSL ES behaves the same (Ver 1.00 Sec 4.2.4, Ver 3.00 Sec 4.2.5).
+    *
+    * Note that we cannot force type name check when comparing unnamed
+    * structure types, these have a unique name assigned during parsing.
+    */
+   if (!this->is_anonymous() && !b->is_anonymous())
+      if (strcmp(this->name, b->name) != 0)
+         return false;
 
-   return strcmp(key1->name, key2->name) == 0 && key1->record_compare(key2);
+   return record_fields_equal(this->fields.structure, b->fields.structure,
+                              this->length, match_locations);
 }
 
 
-/**
- * Generate an integer hash value for a glsl_type structure type.
- */
-unsigned
-glsl_type::record_key_hash(const void *a)
-{
-   const glsl_type *const key = (glsl_type *) a;
-   uintptr_t hash = key->length;
-   unsigned retval;
+namespace {
+
+/** Key of the record and interface types. */
+struct record_key {
+   const glsl_struct_field *fields;
+   unsigned num_fields;
+   enum glsl_interface_packing packing;
+   const char *name;
+
+   uint32_t hash() const
+   {
+      uint32_t hash = _mesa_fnv32_1a_offset_bias;
+      hash = _mesa_fnv32_1a_accumulate(hash, num_fields);
+      for (unsigned i = 0; i < num_fields; i++)
+         hash = _mesa_fnv32_1a_accumulate(hash, fields[i].type);
+      return hash;
+   }
 
-   for (unsigned i = 0; i < key->length; i++) {
-      /* casting pointer to uintptr_t */
-      hash = (hash * 13 ) + (uintptr_t) key->fields.structure[i].type;
+   bool matches(const glsl_type *t) const
+   {
+      return t->length == num_fields &&
+             t->interface_packing == (unsigned) packing &&
+             strcmp(t->name, name) == 0 &&
+             record_fields_equal(t->fields.structure, fields, num_fields,
+                                 true);
    }
+};
 
-   if (sizeof(hash) == 8)
-      retval = (hash & 0xffffffff) ^ ((uint64_t) hash >> 32);
-   else
-      retval = hash;
+struct subroutine_key {
+   const char *name;
 
-   return retval;
-}
+   uint32_t hash() const
+   {
+      return _mesa_hash_string(name);
+   }
 
+   bool matches(const glsl_type *t) const
+   {
+      return strcmp(t->name, name) == 0;
+   }
+};
+
+} /* anonymous namespace */
 
 const glsl_type *
 glsl_type::get_record_instance(const glsl_struct_field *fields,
                                unsigned num_fields,
                                const char *name)
 {
-   const glsl_type key(fields, num_fields, name);
-
-   mtx_lock(&glsl_type::mutex);
-
-   if (record_types == NULL) {
-      record_types = _mesa_hash_table_create(NULL, record_key_hash,
-                                             record_key_compare);
-   }
-
-   const struct hash_entry *entry = _mesa_hash_table_search(record_types,
-                                                            &key);
-   if (entry == NULL) {
-      mtx_unlock(&glsl_type::mutex);
-      const glsl_type *t = new glsl_type(fields, num_fields, name);
-      mtx_lock(&glsl_type::mutex);
+   const record_key key = {
+      fields, num_fields, GLSL_INTERFACE_PACKING_STD140, name
+   };
+   const uint32_t hash = key.hash();
+   const glsl_type *t = type_table_search(record_types, hash, key);
 
-      entry = _mesa_hash_table_insert(record_types, t, (void *) t);
+   if (t == NULL) {
+      t = type_table_insert(record_types, &mutex, hash, key,
+                            new glsl_type(fields, num_fields, name));
    }
 
-   assert(((glsl_type *) entry->data)->base_type == GLSL_TYPE_STRUCT);
-   assert(((glsl_type *) entry->data)->length == num_fields);
-   assert(strcmp(((glsl_type *) entry->data)->name, name) == 0);
+   assert(t->base_type == GLSL_TYPE_STRUCT);
+   assert(t->length == num_fields);
+   assert(strcmp(t->name, name) == 0);
 
-   mtx_unlock(&glsl_type::mutex);
-
-   return (glsl_type *) entry->data;
+   return t;
 }
 
 
@@ -1012,130 +1146,97 @@ glsl_type::get_interface_instance(const glsl_struct_field *fields,
                                   enum glsl_interface_packing packing,
                                   const char *block_name)
 {
-   const glsl_type key(fields, num_fields, packing, block_name);
-
-   mtx_lock(&glsl_type::mutex);
-
-   if (interface_types == NULL) {
-      interface_types = _mesa_hash_table_create(NULL, record_key_hash,
-                                                record_key_compare);
+   const record_key key = { fields, num_fields, packing, block_name };
+   const uint32_t hash = key.hash();
+   const glsl_type *t = type_table_search(interface_types, hash, key);
+
+   if (t == NULL) {
+      t = type_table_insert(interface_types, &mutex, hash, key,
+                            new glsl_type(fields, num_fields,
+                                          packing, block_name));
    }
 
-   const struct hash_entry *entry = _mesa_hash_table_search(interface_types,
-                                                            &key);
-   if (entry == NULL) {
-      mtx_unlock(&glsl_type::mutex);
-      const glsl_type *t = new glsl_type(fields, num_fields,
-                                         packing, block_name);
-      mtx_lock(&glsl_type::mutex);
-
-      entry = _mesa_hash_table_insert(interface_types, t, (void *) t);
-   }
+   assert(t->base_type == GLSL_TYPE_INTERFACE);
+   assert(t->length == num_fields);
+   assert(strcmp(t->name, block_name) == 0);
 
-   assert(((glsl_type *) entry->data)->base_type == GLSL_TYPE_INTERFACE);
-   assert(((glsl_type *) entry->data)->length == num_fields);
-   assert(strcmp(((glsl_type *) entry->data)->name, block_name) == 0);
-
-   mtx_unlock(&glsl_type::mutex);
-
-   return (glsl_type *) entry->data;
+   return t;
 }
 
 const glsl_type *
 glsl_type::get_subroutine_instance(const char *subroutine_name)
 {
-   const glsl_type key(subroutine_name);
-
-   mtx_lock(&glsl_type::mutex);
-
-   if (subroutine_types == NULL) {
-      subroutine_types = _mesa_hash_table_create(NULL, record_key_hash,
-                                                 record_key_compare);
-   }
-
-   const struct hash_entry *entry = _mesa_hash_table_search(subroutine_types,
-                                                            &key);
-   if (entry == NULL) {
-      mtx_unlock(&glsl_type::mutex);
-      const glsl_type *t = new glsl_type(subroutine_name);
-      mtx_lock(&glsl_type::mutex);
+   const subroutine_key key = { subroutine_name };
+   const uint32_t hash = key.hash();
+   const glsl_type *t = type_table_search(subroutine_types, hash, key);
 
-      entry = _mesa_hash_table_insert(subroutine_types, t, (void *) t);
+   if (t == NULL) {
+      t = type_table_insert(subroutine_types, &mutex, hash, key,
+                            new glsl_type(subroutine_name));
    }
 
-   assert(((glsl_type *) entry->data)->base_type == GLSL_TYPE_SUBROUTINE);
-   assert(strcmp(((glsl_type *) entry->data)->name, subroutine_name) == 0);
-
-   mtx_unlock(&glsl_type::mutex);
+   assert(t->base_type == GLSL_TYPE_SUBROUTINE);
+   assert(strcmp(t->name, subroutine_name) == 0);
 
-   return (glsl_type *) entry->data;
+   return t;
 }
 
 
-static bool
-function_key_compare(const void *a, const void *b)
-{
-   const glsl_type *const key1 = (glsl_type *) a;
-   const glsl_type *const key2 = (glsl_type *) b;
+namespace {
 
-   if (key1->length != key2->length)
-      return 1;
-
-   return memcmp(key1->fields.parameters, key2->fields.parameters,
-                 (key1->length + 1) * sizeof(*key1->fields.parameters)) == 0;
-}
+struct function_key {
+   const glsl_type *return_type;
+   const glsl_function_param *params;
+   unsigned num_params;
 
+   uint32_t hash() const
+   {
+      uint32_t hash = _mesa_fnv32_1a_offset_bias;
+      hash = _mesa_fnv32_1a_accumulate(hash, num_params);
+      hash = _mesa_fnv32_1a_accumulate(hash, return_type);
+      for (unsigned i = 0; i < num_params; i++)
+         hash = _mesa_fnv32_1a_accumulate(hash, params[i].type);
+      return hash;
+   }
 
-static uint32_t
-function_key_hash(const void *a)
-{
-   const glsl_type *const key = (glsl_type *) a;
-   char hash_key[128];
-   unsigned size = 0;
+   bool matches(const glsl_type *t) const
+   {
+      /* The return type is stored as the first parameter. */
+      if (t->length != num_params ||
+          t->fields.parameters[0].type != return_type)
+         return false;
 
-   size = snprintf(hash_key, sizeof(hash_key), "%08x", key->length);
+      for (unsigned i = 0; i < num_params; i++) {
+         const glsl_function_param *const p = &t->fields.parameters[i + 1];
 
-   for (unsigned i = 0; i < key->length; i++) {
-      if (size >= sizeof(hash_key))
-	 break;
+         if (p->type != params[i].type || p->in != params[i].in ||
+             p->out != params[i].out)
+            return false;
+      }
 
-      size += snprintf(& hash_key[size], sizeof(hash_key) - size,
-		       "%p", (void *) key->fields.structure[i].type);
+      return true;
    }
+};
 
-   return _mesa_hash_string(hash_key);
-}
+} /* anonymous namespace */
 
 const glsl_type *
 glsl_type::get_function_instance(const glsl_type *return_type,
                                  const glsl_function_param *params,
                                  unsigned num_params)
 {
-   const glsl_type key(return_type, params, num_params);
-
-   mtx_lock(&glsl_type::mutex);
+   const function_key key = { return_type, params, num_params };
+   const uint32_t hash = key.hash();
+   const glsl_type *t = type_table_search(function_types, hash, key);
 
-   if (function_types == NULL) {
-      function_types = _mesa_hash_table_create(NULL, function_key_hash,
-                                               function_key_compare);
+   if (t == NULL) {
+      t = type_table_insert(function_types, &mutex, hash, key,
+                            new glsl_type(return_type, params, num_params));
    }
 
-   struct hash_entry *entry = _mesa_hash_table_search(function_types, &key);
-   if (entry == NULL) {
-      mtx_unlock(&glsl_type::mutex);
-      const glsl_type *t = new glsl_type(return_type, params, num_params);
-      mtx_lock(&glsl_type::mutex);
-
-      entry = _mesa_hash_table_insert(function_types, t, (void *) t);
-   }
-
-   const glsl_type *t = (const glsl_type *)entry->data;
-
    assert(t->base_type == GLSL_TYPE_FUNCTION);
    assert(t->length == num_params);
 
-   mtx_unlock(&glsl_type::mutex);
-
    return t;
 }
 
@@ -2014,3 +2115,166 @@ glsl_type::coordinate_components() const
 
 #include "compiler/builtin_type_macros.h"
 /** @} */
+
+void
+encode_type_to_blob(struct blob *blob, const glsl_type *type)
+{
+   if (type == NULL) {
+      /* Not a valid base type, so it decodes to NULL. */
+      blob_write_uint32(blob, 0xffffffffu);
+      return;
+   }
+
+   blob_write_uint32(blob, type->base_type);
+
+   switch (type->base_type) {
+   case GLSL_TYPE_UINT:
+   case GLSL_TYPE_INT:
+   case GLSL_TYPE_FLOAT:
+   case GLSL_TYPE_DOUBLE:
+   case GLSL_TYPE_BOOL:
+      blob_write_uint32(blob, type->vector_elements);
+      blob_write_uint32(blob, type->matrix_columns);
+      return;
+   case GLSL_TYPE_SAMPLER:
+      blob_write_uint32(blob, type->sampler_dimensionality);
+      blob_write_uint32(blob, type->sampler_shadow);
+      blob_write_uint32(blob, type->sampler_array);
+      blob_write_uint32(blob, type->sampled_type);
+      return;
+   case GLSL_TYPE_IMAGE:
+      blob_write_uint32(blob, type->sampler_dimensionality);
+      blob_write_uint32(blob, type->sampler_array);
+      blob_write_uint32(blob, type->sampled_type);
+      return;
+   case GLSL_TYPE_ATOMIC_UINT:
+   case GLSL_TYPE_VOID:
+   case GLSL_TYPE_ERROR:
+      return;
+   case GLSL_TYPE_SUBROUTINE:
+      blob_write_string(blob, type->name);
+      return;
+   case GLSL_TYPE_ARRAY:
+      blob_write_uint32(blob, type->length);
+      encode_type_to_blob(blob, type->fields.array);
+      return;
+   case GLSL_TYPE_STRUCT:
+   case GLSL_TYPE_INTERFACE:
+      blob_write_string(blob, type->name);
+      blob_write_uint32(blob, type->length);
+      blob_write_uint32(blob, type->interface_packing);
+
+      for (unsigned i = 0; i < type->length; i++) {
+         glsl_struct_field field = type->fields.structure[i];
+
+         encode_type_to_blob(blob, field.type);
+         blob_write_string(blob, field.name);
+
+         /* The remaining members are plain data. */
+         field.type = NULL;
+         field.name = NULL;
+         blob_write_bytes(blob, &field, sizeof(field));
+      }
+      return;
+   case GLSL_TYPE_FUNCTION:
+      break;
+   }
+
+   unreachable("Cannot encode type");
+}
+
+const glsl_type *
+decode_type_from_blob(struct blob_reader *blob)
+{
+   uint32_t base_type = blob_read_uint32(blob);
+
+   switch (base_type) {
+   case GLSL_TYPE_UINT:
+   case GLSL_TYPE_INT:
+   case GLSL_TYPE_FLOAT:
+   case GLSL_TYPE_DOUBLE:
+   case GLSL_TYPE_BOOL: {
+      unsigned rows = blob_read_uint32(blob);
+      unsigned columns = blob_read_uint32(blob);
+      return glsl_type::get_instance(base_type, rows, columns);
+   }
+   case GLSL_TYPE_SAMPLER: {
+      enum glsl_sampler_dim dim = (enum glsl_sampler_dim) blob_read_uint32(blob);
+      bool shadow = blob_read_uint32(blob);
+      bool array = blob_read_uint32(blob);
+      glsl_base_type sampled_type = (glsl_base_type) blob_read_uint32(blob);
+      return glsl_type::get_sampler_instance(dim, shadow, array, sampled_type);
+   }
+   case GLSL_TYPE_IMAGE: {
+      enum glsl_sampler_dim dim = (enum glsl_sampler_dim) blob_read_uint32(blob);
+      bool array = blob_read_uint32(blob);
+      glsl_base_type sampled_type = (glsl_base_type) blob_read_uint32(blob);
+      return glsl_type::get_image_instance(dim, array, sampled_type);
+   }
+   case GLSL_TYPE_ATOMIC_UINT:
+      return glsl_type::atomic_uint_type;
+   case GLSL_TYPE_VOID:
+      return glsl_type::void_type;
+   case GLSL_TYPE_ERROR:
+      return glsl_type::error_type;
+   case GLSL_TYPE_SUBROUTINE: {
+      const char *name = blob_read_string(blob);
+      return name ? glsl_type::get_subroutine_instance(name) : NULL;
+   }
+   case GLSL_TYPE_ARRAY: {
+      unsigned length = blob_read_uint32(blob);
+      const glsl_type *element = decode_type_from_blob(blob);
+      return element ? glsl_type::get_array_instance(element, length) : NULL;
+   }
+   case GLSL_TYPE_STRUCT:
+   case GLSL_TYPE_INTERFACE: {
+      const char *name = blob_read_string(blob);
+      unsigned num_fields = blob_read_uint32(blob);
+      enum glsl_interface_packing packing =
+         (enum glsl_interface_packing) blob_read_uint32(blob);
+
+      if (name == NULL || blob->overrun)
+         return NULL;
+
+      /* Don't trust a corrupted blob with the size of the allocation. */
+      if (packing > GLSL_INTERFACE_PACKING_STD430 ||
+          num_fields > (size_t) (blob->end - blob->current) /
+                       sizeof(glsl_struct_field)) {
+         blob->overrun = true;
+         return NULL;
+      }
+
+      glsl_struct_field *fields = (glsl_struct_field *)
+         malloc(sizeof(glsl_struct_field) * MAX2(num_fields, 1));
+      if (fields == NULL)
+         return NULL;
+
+      for (unsigned i = 0; i < num_fields; i++) {
+         const glsl_type *field_type = decode_type_from_blob(blob);
+         const char *field_name = blob_read_string(blob);
+
+         blob_copy_bytes(blob, (uint8_t *) &fields[i], sizeof(fields[i]));
+         fields[i].type = field_type;
+         fields[i].name = field_name;
+
+         if (field_type == NULL || field_name == NULL) {
+            free(fields);
+            return NULL;
+         }
+      }
+
+      const glsl_type *type;
+      if (base_type == GLSL_TYPE_INTERFACE) {
+         type = glsl_type::get_interface_instance(fields, num_fields,
+                                                  packing, name);
+      } else {
+         type = glsl_type::get_record_instance(fields, num_fields, name);
+      }
+
+      free(fields);
+      return type;
+   }
+   default:
+      return NULL;
+   }
+}
@@ -42,6 +42,28 @@ _mesa_glsl_initialize_types(struct _mesa_glsl_parse_state *state);
 extern void
 _mesa_glsl_release_types(void);
 
+struct glsl_type;
+struct blob;
+struct blob_reader;
+
+/**
+ * Write \p type, or NULL, to \p blob.
+ *
+ * Like the rest of the shader serialization, the encoding can only be read
+ * back by the same build of Mesa.
+ */
+void
+encode_type_to_blob(struct blob *blob, const struct glsl_type *type);
+
+/**
+ * Read back a type written by encode_type_to_blob()
+ *
+ * Returns NULL for an encoded NULL type and for data that doesn't describe
+ * a type.
+ */
+const struct glsl_type *
+decode_type_from_blob(struct blob_reader *blob);
+
 #ifdef __cplusplus
 }
 #endif
@@ -768,6 +790,10 @@ struct glsl_type {
 
 private:
 
+   /**
+    * Serializes the creation of types.  Looking up an existing type doesn't
+    * take it, see \c type_table in glsl_types.cpp.
+    */
    static mtx_t mutex;
 
    /**
@@ -807,24 +833,6 @@ private:
    /** Constructor for subroutine types */
    glsl_type(const char *name);
 
-   /** Hash table containing the known array types. */
-   static struct hash_table *array_types;
-
-   /** Hash table containing the known record types. */
-   static struct hash_table *record_types;
-
-   /** Hash table containing the known interface types. */
-   static struct hash_table *interface_types;
-
-   /** Hash table containing the known subroutine types. */
-   static struct hash_table *subroutine_types;
-
-   /** Hash table containing the known function types. */
-   static struct hash_table *function_types;
-
-   static bool record_key_compare(const void *a, const void *b);
-   static unsigned record_key_hash(const void *key);
-
    /**
     * \name Built-in type flyweights
     */
@@ -342,6 +342,8 @@ nir_block_create(nir_shader *shader)
    block->predecessors = _mesa_set_create(block, _mesa_hash_pointer,
                                           _mesa_key_pointer_equal);
    block->imm_dom = NULL;
+   block->num_dom_children = 0;
+   block->dom_children = NULL;
    /* XXX maybe it would be worth it to defer allocation?  This
     * way it doesn't get allocated for shader ref's that never run
     * nir_calc_dominance?  For example, state-tracker creates an
@@ -352,6 +354,8 @@ nir_block_create(nir_shader *shader)
     */
    block->dom_frontier = _mesa_set_create(block, _mesa_hash_pointer,
                                           _mesa_key_pointer_equal);
+   block->live_in = NULL;
+   block->live_out = NULL;
 
    exec_list_make_empty(&block->instr_list);
 
@@ -494,37 +494,220 @@ class SearchAndReplace(object):
 
       BitSizeValidator(varset).validate(self.search, self.replace)
 
-_algebraic_pass_template = mako.template.Template("""
-#include "nir.h"
-#include "nir_search.h"
+class TreeAutomaton(object):
+   """A bottom-up tree automaton that matches the search expressions of a
+   pass against the SSA values of a shader.
+
+   Every search expression, and every expression inside of it, is an
+   "item".  Variables and constants are replaced by the wildcard item "_",
+   which matches anything, and equal items are merged, so ('fadd', a, 0.0)
+   and ('fadd', b, c) are the same item ('fadd', _, _).  The state of an
+   SSA value is the set of items that it may match.  Values which aren't
+   computed by an ALU instruction are in state 0, which is just { _ }.
+
+   The state of an ALU instruction only depends on its opcode and on the
+   states of its sources.  It is computed at build time for all possible
+   combinations, so at run time it takes one table lookup per source.  To
+   keep the tables small, the states of the sources are first mapped
+   through a per-opcode "filter", which only keeps the items that appear as
+   a source of an item of that opcode.
+
+   nir_search still has the final word on whether a search expression
+   matches; the automaton only rules out the ones which can't, so that a
+   pass doesn't need to try all of the search expressions of an opcode on
+   every instruction.  The items ignore bit sizes, the inexact flag,
+   variable conditions and the values of constants, which makes the states
+   a superset of what actually matches.
+   """
 
-#ifndef NIR_OPT_ALGEBRAIC_STRUCT_DEFS
-#define NIR_OPT_ALGEBRAIC_STRUCT_DEFS
+   class Item(object):
+      def __init__(self, opcode, children, index):
+         self.opcode = opcode
+         self.children = children
+         self.index = index
+
+      def __str__(self):
+         if self.opcode is None:
+            return '_'
+         return '(' + ', '.join([self.opcode] +
+                                [str(c) for c in self.children]) + ')'
+
+   class OpcodeTable(object):
+      def __init__(self, opcode):
+         self.opcode = opcode
+         self.items = []
+         self.num_inputs = opcodes[opcode].num_inputs
+         self.commutative = \
+            'commutative' in opcodes[opcode].algebraic_properties
+         # The items that are relevant to the sources of this opcode
+         self.src_items = set()
+         # Filtered states, and the filtered state of every state
+         self.filtered_states = []
+         self.filtered_state_index = {}
+         self.filter = []
+         # The state for each combination of filtered source states
+         self.table = {}
+
+   def __init__(self, transforms):
+      self._items = {}
+      self.opcodes = {}
+      self.wildcard = self._get_item(None, ())
 
-struct transform {
-   const nir_search_expression *search;
-   const nir_search_value *replace;
-   unsigned condition_offset;
-};
+      for xform in transforms:
+         xform.item = self._build_item(xform.search)
+
+      for table in self.opcodes.itervalues():
+         for item in table.items:
+            table.src_items.update(item.children)
+
+      self.states = [frozenset([self.wildcard])]
+      self._state_index = { self.states[0]: 0 }
+      self._compute_states()
 
-#endif
+      assert len(self.states) < 2**16, "Too many states for a uint16_t"
+
+      # Sanity check: every search expression must be in the state that
+      # the automaton computes for it, with any values for the variables.
+      for xform in transforms:
+         assert xform.item in self.states[self._state_of(xform.item)], \
+            "automaton doesn't match " + str(xform.item)
+
+   def _get_item(self, opcode, children):
+      key = (opcode, tuple(c.index for c in children))
+      if key not in self._items:
+         item = TreeAutomaton.Item(opcode, children, len(self._items))
+         self._items[key] = item
+         if opcode is not None:
+            if opcode not in self.opcodes:
+               self.opcodes[opcode] = TreeAutomaton.OpcodeTable(opcode)
+            self.opcodes[opcode].items.append(item)
+      return self._items[key]
+
+   def _build_item(self, val):
+      if not isinstance(val, Expression):
+         return self.wildcard
+      return self._get_item(val.opcode,
+                            tuple(self._build_item(src)
+                                  for src in val.sources))
+
+   def _add_state(self, state):
+      if state not in self._state_index:
+         self._state_index[state] = len(self.states)
+         self.states.append(state)
+      return self._state_index[state]
+
+   def _transition(self, table, srcs):
+      """The state of an instruction whose sources are in the filtered
+      states srcs."""
+      state = set([self.wildcard])
+      for item in table.items:
+         if all(c in s for (c, s) in zip(item.children, srcs)):
+            state.add(item)
+         elif table.commutative and \
+              item.children[0] in srcs[1] and item.children[1] in srcs[0]:
+            state.add(item)
+      return self._add_state(frozenset(state))
+
+   def _compute_states(self):
+      # New states may add filtered states, whose transitions may add new
+      # states, so iterate until nothing changes.
+      changed = True
+      while changed:
+         changed = False
+         for opcode in sorted(self.opcodes.keys()):
+            table = self.opcodes[opcode]
+            while len(table.filter) < len(self.states):
+               filtered = self.states[len(table.filter)] & table.src_items
+               if filtered not in table.filtered_state_index:
+                  table.filtered_state_index[filtered] = \
+                     len(table.filtered_states)
+                  table.filtered_states.append(filtered)
+               table.filter.append(table.filtered_state_index[filtered])
+
+            num_filtered = len(table.filtered_states)
+            for srcs in itertools.product(range(num_filtered),
+                                          repeat=table.num_inputs):
+               if srcs not in table.table:
+                  table.table[srcs] = self._transition(
+                     table, [table.filtered_states[s] for s in srcs])
+                  changed = True
+
+   def _state_of(self, item):
+      """Run the automaton on an item, standing for an instruction tree."""
+      if item.opcode is None:
+         return 0
+      table = self.opcodes[item.opcode]
+      return table.table[tuple(table.filter[self._state_of(c)]
+                               for c in item.children)]
+
+   def flat_table(self, opcode):
+      """The transition table of an opcode as a row-major array."""
+      table = self.opcodes[opcode]
+      return [table.table[srcs] for srcs in
+              itertools.product(range(len(table.filtered_states)),
+                                repeat=table.num_inputs)]
 
-% for (opcode, xform_list) in xform_dict.iteritems():
+_algebraic_pass_template = mako.template.Template("""
+#include "nir.h"
+#include "nir_search.h"
+
+% for (opcode, xform_list) in sorted(xform_dict.items()):
 % for xform in xform_list:
    ${xform.search.render()}
    ${xform.replace.render()}
 % endfor
+% endfor
 
-static const struct transform ${pass_name}_${opcode}_xforms[] = {
-% for xform in xform_list:
+% for state_id, xforms in enumerate(state_xforms):
+% if xforms:
+static const struct transform ${pass_name}_state${state_id}_xforms[] = {
+% for xform in xforms:
    { &${xform.search.name}, ${xform.replace.c_ptr}, ${xform.condition_index} },
 % endfor
 };
+% endif
+% endfor
+
+static const struct {
+   const struct transform *xforms;
+   uint16_t num_xforms;
+} ${pass_name}_transforms[] = {
+% for state_id, xforms in enumerate(state_xforms):
+% if xforms:
+   { ${pass_name}_state${state_id}_xforms, ${len(xforms)} },
+% else:
+   { NULL, 0 },
+% endif
+% endfor
+};
+
+% for opcode in sorted(automaton.opcodes.keys()):
+static const uint16_t ${pass_name}_${opcode}_filter[] = {
+% for f in automaton.opcodes[opcode].filter:
+   ${f},
+% endfor
+};
+
+static const uint16_t ${pass_name}_${opcode}_table[] = {
+% for s in automaton.flat_table(opcode):
+   ${s},
 % endfor
+};
+
+% endfor
+static const struct per_op_table ${pass_name}_table[nir_num_opcodes] = {
+% for opcode in sorted(automaton.opcodes.keys()):
+   [nir_op_${opcode}] = {
+      ${pass_name}_${opcode}_filter,
+      ${len(automaton.opcodes[opcode].filtered_states)},
+      ${pass_name}_${opcode}_table,
+   },
+% endfor
+};
 
 static bool
 ${pass_name}_block(nir_block *block, const bool *condition_flags,
-                   void *mem_ctx)
+                   const uint16_t *states, void *mem_ctx)
 {
    bool progress = false;
 
@@ -536,22 +719,20 @@ ${pass_name}_block(nir_block *block, const bool *condition_flags,
       if (!alu->dest.dest.is_ssa)
          continue;
 
-      switch (alu->op) {
-      % for opcode in xform_dict.keys():
-      case nir_op_${opcode}:
-         for (unsigned i = 0; i < ARRAY_SIZE(${pass_name}_${opcode}_xforms); i++) {
-            const struct transform *xform = &${pass_name}_${opcode}_xforms[i];
-            if (condition_flags[xform->condition_offset] &&
-                nir_replace_instr(alu, xform->search, xform->replace,
-                                  mem_ctx)) {
-               progress = true;
-               break;
-            }
+      /* Only try the search expressions that the automaton found to be
+       * possible matches.  The instructions inserted by nir_replace_instr()
+       * are before this one, so none of them is visited by this loop and
+       * the states of all the instructions it visits are still right.
+       */
+      const uint16_t state = states[alu->dest.dest.ssa.index];
+      for (unsigned i = 0; i < ${pass_name}_transforms[state].num_xforms; i++) {
+         const struct transform *xform = &${pass_name}_transforms[state].xforms[i];
+         if (condition_flags[xform->condition_offset] &&
+             nir_replace_instr(alu, xform->search, xform->replace,
+                               mem_ctx)) {
+            progress = true;
+            break;
          }
-         break;
-      % endfor
-      default:
-         break;
       }
    }
 
@@ -564,10 +745,30 @@ ${pass_name}_impl(nir_function_impl *impl, const bool *condition_flags)
    void *mem_ctx = ralloc_parent(impl);
    bool progress = false;
 
+   /* The states are indexed by SSA def, and the instructions inserted by
+    * earlier passes may not have an index yet.
+    */
+   nir_index_ssa_defs(impl);
+
+   /* Zeroed, because state 0 is the state of anything that isn't an ALU
+    * instruction.
+    */
+   uint16_t *states = rzalloc_array(NULL, uint16_t, impl->ssa_alloc);
+
+   nir_foreach_block(block, impl) {
+      nir_foreach_instr(instr, block) {
+         if (instr->type == nir_instr_type_alu)
+            nir_algebraic_automaton(nir_instr_as_alu(instr), states,
+                                    ${pass_name}_table);
+      }
+   }
+
    nir_foreach_block_reverse(block, impl) {
-      progress |= ${pass_name}_block(block, condition_flags, mem_ctx);
+      progress |= ${pass_name}_block(block, condition_flags, states, mem_ctx);
    }
 
+   ralloc_free(states);
+
    if (progress)
       nir_metadata_preserve(impl, nir_metadata_block_index |
                                   nir_metadata_dominance);
@@ -603,6 +804,7 @@ class AlgebraicPass(object):
       self.pass_name = pass_name
 
       error = False
+      xforms = []
 
       for xform in transforms:
          if not isinstance(xform, SearchAndReplace):
@@ -620,11 +822,30 @@ class AlgebraicPass(object):
             self.xform_dict[xform.search.opcode] = []
 
          self.xform_dict[xform.search.opcode].append(xform)
+         xforms.append(xform)
 
       if error:
          sys.exit(1)
 
+      self.automaton = TreeAutomaton(xforms)
+
+      # The search expressions to try for each state, in the order in which
+      # they were given.
+      item_xforms = {}
+      for xform in xforms:
+         item_xforms.setdefault(xform.item, []).append(xform)
+
+      self.state_xforms = []
+      for state in self.automaton.states:
+         state_xforms = []
+         for item in state:
+            state_xforms += item_xforms.get(item, [])
+         state_xforms.sort(key=lambda xform: xform.id)
+         self.state_xforms.append(state_xforms)
+
    def render(self):
       return _algebraic_pass_template.render(pass_name=self.pass_name,
                                              xform_dict=self.xform_dict,
-                                             condition_list=condition_list)
+                                             condition_list=condition_list,
+                                             automaton=self.automaton,
+                                             state_xforms=self.state_xforms)
@@ -42,10 +42,7 @@ init_block(nir_block *block, nir_function_impl *impl)
       block->imm_dom = NULL;
    block->num_dom_children = 0;
 
-   struct set_entry *entry;
-   set_foreach(block->dom_frontier, entry) {
-      _mesa_set_remove(block->dom_frontier, entry);
-   }
+   _mesa_set_clear(block->dom_frontier, NULL);
 
    return true;
 }
@@ -128,16 +125,17 @@ calc_dom_frontier(nir_block *block)
 static void
 calc_dom_children(nir_function_impl* impl)
 {
-   void *mem_ctx = ralloc_parent(impl);
-
    nir_foreach_block(block, impl) {
       if (block->imm_dom)
          block->imm_dom->num_dom_children++;
    }
 
+   /* Reuse the arrays from the last time dominance was computed instead of
+    * leaking a new set of them into the shader every time.
+    */
    nir_foreach_block(block, impl) {
-      block->dom_children = ralloc_array(mem_ctx, nir_block *,
-                                         block->num_dom_children);
+      block->dom_children = reralloc(block, block->dom_children, nir_block *,
+                                     block->num_dom_children);
       block->num_dom_children = 0;
    }
 
@@ -204,6 +202,58 @@ nir_calc_dominance(nir_shader *shader)
    }
 }
 
+/**
+ * Updates the dominance information for an if which is about to be removed
+ * along with its then and else blocks, merging the block after it into the
+ * block before it.  Each side of the if must be a single block which falls
+ * through to the block after the if.
+ *
+ * This saves recomputing dominance for the whole function after a local
+ * change like the one made by nir_opt_peephole_select().  Afterwards the
+ * dominance tree and frontiers of the remaining blocks are the same as
+ * nir_calc_dominance_impl() would give, but the blocks need to be indexed
+ * again.
+ */
+void
+nir_dominance_remove_if(nir_if *if_stmt)
+{
+   nir_block *before =
+      nir_cf_node_as_block(nir_cf_node_prev(&if_stmt->cf_node));
+   nir_block *after =
+      nir_cf_node_as_block(nir_cf_node_next(&if_stmt->cf_node));
+
+   assert(nir_cf_node_get_function(&before->cf_node)->valid_metadata &
+          nir_metadata_dominance);
+   assert(nir_if_first_then_node(if_stmt) == nir_if_last_then_node(if_stmt));
+   assert(nir_if_first_else_node(if_stmt) == nir_if_last_else_node(if_stmt));
+
+   /* Every path out of the block before the if goes through the block
+    * after it, so the then, else and after blocks are its only children.
+    */
+   assert(before->num_dom_children == 3);
+   assert(after->imm_dom == before);
+
+   before->dom_children = reralloc(before, before->dom_children, nir_block *,
+                                   after->num_dom_children);
+   for (unsigned i = 0; i < after->num_dom_children; i++) {
+      before->dom_children[i] = after->dom_children[i];
+      before->dom_children[i]->imm_dom = before;
+   }
+   before->num_dom_children = after->num_dom_children;
+
+   /* Only the then and else blocks have the block after the if in their
+    * frontiers, and nothing has the then or else block in its frontier, so
+    * the only frontier that changes is that of the block before the if.
+    */
+   struct set_entry *entry;
+   set_foreach(after->dom_frontier, entry)
+      _mesa_set_add(before->dom_frontier, entry->key);
+
+   /* The dom_pre_index and dom_post_index of the remaining blocks are still
+    * properly nested, so nir_block_dominates() keeps working.
+    */
+}
+
 /**
  * Computes the least common anscestor of two blocks.  If one of the blocks
  * is null, the other block is returned.
@@ -39,6 +39,7 @@ struct from_ssa_state {
    void *dead_ctx;
    bool phi_webs_only;
    struct hash_table *merge_node_table;
+   nir_ssa_liveness *live;
    nir_instr *instr;
    nir_function_impl *impl;
 };
@@ -140,9 +141,10 @@ get_merge_node(nir_ssa_def *def, struct from_ssa_state *state)
 }
 
 static bool
-merge_nodes_interfere(merge_node *a, merge_node *b)
+merge_nodes_interfere(merge_node *a, merge_node *b,
+                      struct from_ssa_state *state)
 {
-   return nir_ssa_defs_interfere(a->def, b->def);
+   return nir_ssa_liveness_defs_interfere(state->live, a->def, b->def);
 }
 
 /* Merges b into a */
@@ -180,7 +182,8 @@ merge_merge_sets(merge_set *a, merge_set *b)
  * Boissinot et. al.
  */
 static bool
-merge_sets_interfere(merge_set *a, merge_set *b)
+merge_sets_interfere(merge_set *a, merge_set *b,
+                     struct from_ssa_state *state)
 {
    NIR_VLA(merge_node *, dom, a->size + b->size);
    int dom_idx = -1;
@@ -214,7 +217,7 @@ merge_sets_interfere(merge_set *a, merge_set *b)
              !ssa_def_dominates(dom[dom_idx]->def, current->def))
          dom_idx--;
 
-      if (dom_idx >= 0 && merge_nodes_interfere(current, dom[dom_idx]))
+      if (dom_idx >= 0 && merge_nodes_interfere(current, dom[dom_idx], state))
          return true;
 
       dom[++dom_idx] = current;
@@ -415,7 +418,7 @@ aggressive_coalesce_parallel_copy(nir_parallel_copy_instr *pcopy,
       if (src_node->set == dest_node->set)
          continue;
 
-      if (!merge_sets_interfere(src_node->set, dest_node->set))
+      if (!merge_sets_interfere(src_node->set, dest_node->set, state))
          merge_merge_sets(src_node->set, dest_node->set);
    }
 }
@@ -775,8 +778,13 @@ nir_convert_from_ssa_impl(nir_function_impl *impl, bool phi_webs_only)
    nir_metadata_preserve(impl, nir_metadata_block_index |
                                nir_metadata_dominance);
 
-   nir_metadata_require(impl, nir_metadata_live_ssa_defs |
-                              nir_metadata_dominance);
+   nir_metadata_require(impl, nir_metadata_dominance);
+
+   /* Only the values in phi webs and parallel copies are ever checked for
+    * interference, so compute their liveness on demand rather than for the
+    * whole function.
+    */
+   state.live = nir_ssa_liveness_create(state.dead_ctx, impl);
 
    nir_foreach_block(block, impl) {
       coalesce_phi_nodes_block(block, &state);
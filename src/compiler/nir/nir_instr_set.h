@@ -52,6 +52,14 @@ void nir_instr_set_destroy(struct set *instr_set);
  */
 bool nir_instr_set_add_or_rewrite(struct set *instr_set, nir_instr *instr);
 
+/**
+ * Returns the instruction in an instruction set that the given instruction
+ * is a duplicate of, or NULL if there is none.  Unlike
+ * nir_instr_set_add_or_rewrite(), this leaves both the set and the
+ * instruction alone.
+ */
+nir_instr *nir_instr_set_search(struct set *instr_set, nir_instr *instr);
+
 /**
  * Removes an instruction from an instruction set, so that other instructions
  * won't be merged with it.
@@ -250,19 +250,20 @@ search_for_use_after_instr(nir_instr *start, nir_ssa_def *def)
 }
 
 /* Returns true if def is live at instr assuming that def comes before
- * instr in a pre DFS search of the dominance tree.
+ * instr in a pre DFS search of the dominance tree.  live_in and live_out
+ * say whether def is live coming into and going out of instr's block.
  */
 static bool
-nir_ssa_def_is_live_at(nir_ssa_def *def, nir_instr *instr)
+ssa_def_is_live_at(nir_ssa_def *def, nir_instr *instr,
+                   bool live_in, bool live_out)
 {
-   if (BITSET_TEST(instr->block->live_out, def->live_index)) {
+   if (live_out) {
       /* Since def dominates instr, if def is in the liveout of the block,
        * it's live at instr
        */
       return true;
    } else {
-      if (BITSET_TEST(instr->block->live_in, def->live_index) ||
-          def->parent_instr->block == instr->block) {
+      if (live_in || def->parent_instr->block == instr->block) {
          /* In this case it is either live coming into instr's block or it
           * is defined in the same block.  In this case, we simply need to
           * see if it is used after instr.
@@ -274,6 +275,16 @@ nir_ssa_def_is_live_at(nir_ssa_def *def, nir_instr *instr)
    }
 }
 
+static bool
+nir_ssa_def_is_live_at(nir_ssa_def *def, nir_instr *instr)
+{
+   return ssa_def_is_live_at(def, instr,
+                             BITSET_TEST(instr->block->live_in,
+                                         def->live_index),
+                             BITSET_TEST(instr->block->live_out,
+                                         def->live_index));
+}
+
 bool
 nir_ssa_defs_interfere(nir_ssa_def *a, nir_ssa_def *b)
 {
@@ -291,3 +302,168 @@ nir_ssa_defs_interfere(nir_ssa_def *a, nir_ssa_def *b)
       return nir_ssa_def_is_live_at(b, a->parent_instr);
    }
 }
+
+/*
+ * On-demand liveness.
+ *
+ * nir_live_ssa_defs_impl() computes live-in and live-out sets for every
+ * block, which takes time and memory proportional to the number of SSA
+ * values times the number of blocks.  Passes such as out-of-SSA only ever
+ * ask about a small fraction of the values, so this instead computes the
+ * blocks a single value is live in the first time the value is asked
+ * about.  Starting at the uses, it walks backwards through the predecessors
+ * until it reaches the block containing the definition, so the cost is
+ * proportional to the size of the live range.  The results match those of
+ * nir_live_ssa_defs_impl(), including its treatment of phi nodes.
+ */
+
+struct ssa_def_live_range {
+   BITSET_WORD *live_in;
+   BITSET_WORD *live_out;
+};
+
+struct nir_ssa_liveness {
+   nir_function_impl *impl;
+
+   unsigned num_ssa_defs;
+   unsigned bitset_words;
+
+   /* Indexed by live_index; NULL until the value is first asked about */
+   struct ssa_def_live_range **ranges;
+
+   /* Blocks whose predecessors still need to be visited */
+   nir_block **stack;
+   unsigned stack_size;
+};
+
+nir_ssa_liveness *
+nir_ssa_liveness_create(void *mem_ctx, nir_function_impl *impl)
+{
+   nir_metadata_require(impl, nir_metadata_block_index);
+
+   nir_ssa_liveness *live = ralloc(mem_ctx, nir_ssa_liveness);
+   live->impl = impl;
+
+   /* Index the SSA values the same way nir_live_ssa_defs_impl() does, so
+    * that live_index orders them in a pre DFS search of the dominance tree.
+    */
+   struct live_ssa_defs_state state;
+   state.num_ssa_defs = 1;
+   nir_foreach_block(block, impl) {
+      nir_foreach_instr(instr, block)
+         nir_foreach_ssa_def(instr, index_ssa_def, &state);
+   }
+
+   live->num_ssa_defs = state.num_ssa_defs;
+   live->bitset_words = BITSET_WORDS(impl->num_blocks);
+   live->ranges = rzalloc_array(live, struct ssa_def_live_range *,
+                                live->num_ssa_defs);
+   live->stack = ralloc_array(live, nir_block *, impl->num_blocks);
+   live->stack_size = 0;
+
+   return live;
+}
+
+static void
+mark_live_in(nir_ssa_liveness *live, struct ssa_def_live_range *range,
+             nir_block *block)
+{
+   if (BITSET_TEST(range->live_in, block->index))
+      return;
+
+   BITSET_SET(range->live_in, block->index);
+   live->stack[live->stack_size++] = block;
+}
+
+/* Marks the value as live at the end of block, and coming into it as well
+ * unless it is defined there.
+ */
+static void
+mark_live_out(nir_ssa_liveness *live, struct ssa_def_live_range *range,
+              nir_block *block, nir_block *def_block)
+{
+   BITSET_SET(range->live_out, block->index);
+   if (block != def_block)
+      mark_live_in(live, range, block);
+}
+
+static struct ssa_def_live_range *
+get_live_range(nir_ssa_liveness *live, nir_ssa_def *def)
+{
+   assert(def->live_index > 0 && def->live_index < live->num_ssa_defs);
+
+   if (live->ranges[def->live_index])
+      return live->ranges[def->live_index];
+
+   struct ssa_def_live_range *range =
+      ralloc(live->ranges, struct ssa_def_live_range);
+   range->live_in = rzalloc_array(range, BITSET_WORD,
+                                  2 * live->bitset_words);
+   range->live_out = range->live_in + live->bitset_words;
+   live->ranges[def->live_index] = range;
+
+   nir_block *def_block = def->parent_instr->block;
+
+   nir_foreach_use(use, def) {
+      nir_instr *instr = use->parent_instr;
+      if (instr->type == nir_instr_type_phi) {
+         /* Phi sources are live at the end of the corresponding
+          * predecessor rather than in the block containing the phi.
+          */
+         nir_phi_src *phi_src = exec_node_data(nir_phi_src, use, src);
+         mark_live_out(live, range, phi_src->pred, def_block);
+      } else if (instr->block != def_block) {
+         mark_live_in(live, range, instr->block);
+      }
+   }
+
+   nir_foreach_if_use(use, def) {
+      nir_block *block =
+         nir_cf_node_as_block(nir_cf_node_prev(&use->parent_if->cf_node));
+      if (block != def_block)
+         mark_live_in(live, range, block);
+   }
+
+   while (live->stack_size > 0) {
+      nir_block *block = live->stack[--live->stack_size];
+
+      struct set_entry *entry;
+      set_foreach(block->predecessors, entry) {
+         nir_block *pred = (nir_block *)entry->key;
+         mark_live_out(live, range, pred, def_block);
+      }
+   }
+
+   return range;
+}
+
+static bool
+ssa_liveness_def_is_live_at(nir_ssa_liveness *live, nir_ssa_def *def,
+                            nir_instr *instr)
+{
+   struct ssa_def_live_range *range = get_live_range(live, def);
+
+   return ssa_def_is_live_at(def, instr,
+                             BITSET_TEST(range->live_in, instr->block->index),
+                             BITSET_TEST(range->live_out,
+                                         instr->block->index));
+}
+
+/**
+ * Same as nir_ssa_defs_interfere() except that it computes the liveness of
+ * a and b as needed instead of relying on nir_metadata_live_ssa_defs.
+ */
+bool
+nir_ssa_liveness_defs_interfere(nir_ssa_liveness *live,
+                                nir_ssa_def *a, nir_ssa_def *b)
+{
+   if (a->parent_instr == b->parent_instr) {
+      return true;
+   } else if (a->live_index == 0 || b->live_index == 0) {
+      return false;
+   } else if (a->live_index < b->live_index) {
+      return ssa_liveness_def_is_live_at(live, a, b->parent_instr);
+   } else {
+      return ssa_liveness_def_is_live_at(live, b, a->parent_instr);
+   }
+}
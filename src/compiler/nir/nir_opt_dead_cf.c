@@ -165,11 +165,32 @@ cf_node_has_side_effects(nir_cf_node *node)
 }
 
 static bool
-def_not_live_out(nir_ssa_def *def, void *state)
+cf_node_contains(nir_cf_node *node, nir_cf_node *child)
 {
-   nir_block *after = state;
+   for (; child != NULL; child = child->parent) {
+      if (child == node)
+         return true;
+   }
 
-   return !BITSET_TEST(after->live_in, def->live_index);
+   return false;
+}
+
+static bool
+def_only_used_in_cf_node(nir_ssa_def *def, void *_node)
+{
+   nir_cf_node *node = _node;
+
+   nir_foreach_use(use, def) {
+      if (!cf_node_contains(node, &use->parent_instr->block->cf_node))
+         return false;
+   }
+
+   nir_foreach_if_use(use, def) {
+      if (!cf_node_contains(node, &use->parent_if->cf_node))
+         return false;
+   }
+
+   return true;
 }
 
 /*
@@ -184,15 +205,19 @@ def_not_live_out(nir_ssa_def *def, void *state)
  *
  * 3) If there are no phi nodes after the loop, then the only way a value
  * defined inside the loop can be used outside the loop is if its definition
- * dominates the block after the loop. If none of the definitions that
- * dominate the loop exit are used outside the loop, then the loop is dead
- * and it can be deleted.
+ * dominates the block after the loop, and that value is live after the loop
+ * exactly when it has a use outside of the loop. If none of the definitions
+ * inside the loop are used outside of it, then the loop is dead and it can
+ * be deleted.
+ *
+ * Checking the uses of each definition directly means that we don't need
+ * liveness or dominance information, both of which would have to be
+ * recomputed after every if or loop this pass deletes.
  */
 
 static bool
 loop_is_dead(nir_loop *loop)
 {
-   nir_block *before = nir_cf_node_as_block(nir_cf_node_prev(&loop->cf_node));
    nir_block *after = nir_cf_node_as_block(nir_cf_node_next(&loop->cf_node));
 
    if (!exec_list_is_empty(&after->instr_list) &&
@@ -202,13 +227,10 @@ loop_is_dead(nir_loop *loop)
    if (cf_node_has_side_effects(&loop->cf_node))
       return false;
 
-   nir_function_impl *impl = nir_cf_node_get_function(&loop->cf_node);
-   nir_metadata_require(impl, nir_metadata_live_ssa_defs |
-                              nir_metadata_dominance);
-
-   for (nir_block *cur = after->imm_dom; cur != before; cur = cur->imm_dom) {
-      nir_foreach_instr(instr, cur) {
-         if (!nir_foreach_ssa_def(instr, def_not_live_out, after))
+   nir_foreach_block_in_cf_node(block, &loop->cf_node) {
+      nir_foreach_instr(instr, block) {
+         if (!nir_foreach_ssa_def(instr, def_only_used_in_cf_node,
+                                  &loop->cf_node))
             return false;
       }
    }
@@ -0,0 +1,358 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "nir_instr_set.h"
+
+/*
+ * Implements global value numbering along with two kinds of code motion
+ * which expose more redundancies to it:
+ *
+ * 1) Loop-invariant code motion.  ALU instructions whose sources are all
+ * defined outside of a loop are moved to the block before the loop, as are
+ * reorderable intrinsics such as UBO loads if they are in the first block
+ * of the loop, which runs whenever the loop does.
+ *
+ * 2) Hoisting of instructions computed on both sides of an if.  If the
+ * first block of the then side and the first block of the else side compute
+ * the same value from sources defined before the if, it is computed once
+ * before the if instead.  This is the form of partial redundancy
+ * elimination which never makes any path through the shader longer.
+ *
+ * Inner control flow is handled before outer control flow, so values can
+ * move out of several levels of loops and ifs in one go.  Finally the
+ * instructions are value numbered in dominance order the same way
+ * nir_opt_cse() does, which removes the redundancies that the moved
+ * instructions now have with the code before the loop or after the if.
+ *
+ * None of this changes the control flow, so the block indices and the
+ * dominance information stay valid.  Unlike nir_opt_gcm(), instructions
+ * which are not redundant or loop-invariant are left where they are.
+ */
+
+struct gvn_state {
+   struct set *instr_set;
+
+   /* The range of block indices covered by the loop or if being processed */
+   unsigned first_block, last_block;
+
+   /* The block before the loop being processed */
+   nir_block *preheader;
+
+   bool progress;
+};
+
+static bool
+def_is_outside(nir_ssa_def *def, struct gvn_state *state)
+{
+   unsigned index = def->parent_instr->block->index;
+   return index < state->first_block || index > state->last_block;
+}
+
+static bool
+src_is_outside(nir_src *src, void *state)
+{
+   return src->is_ssa && def_is_outside(src->ssa, state);
+}
+
+/* Constants and undefs can be moved anywhere, so they don't make an
+ * instruction loop-variant.
+ */
+static bool
+src_is_invariant(nir_src *src, void *state)
+{
+   if (!src->is_ssa)
+      return false;
+
+   nir_instr *parent = src->ssa->parent_instr;
+   return parent->type == nir_instr_type_load_const ||
+          parent->type == nir_instr_type_ssa_undef ||
+          def_is_outside(src->ssa, state);
+}
+
+static void
+move_instr_to_end_of_block(nir_instr *instr, nir_block *block)
+{
+   nir_instr_remove(instr);
+   nir_instr_insert(nir_after_block_before_jump(block), instr);
+}
+
+static bool
+move_src_def_out_of_loop(nir_src *src, void *_state)
+{
+   struct gvn_state *state = _state;
+
+   /* Only constants and undefs can still be inside the loop at this point.
+    * Other instructions in the loop may use them as well, but the block
+    * before the loop dominates all of those uses.
+    */
+   if (!def_is_outside(src->ssa, state))
+      move_instr_to_end_of_block(src->ssa->parent_instr, state->preheader);
+
+   return true;
+}
+
+static bool
+instr_can_move_out_of_loop(nir_instr *instr, nir_block *first_block,
+                           struct gvn_state *state)
+{
+   switch (instr->type) {
+   case nir_instr_type_alu: {
+      nir_alu_instr *alu = nir_instr_as_alu(instr);
+
+      if (!alu->dest.dest.is_ssa)
+         return false;
+
+      /* Derivatives depend on which invocations are active, which may be
+       * different before the loop.
+       */
+      switch (alu->op) {
+      case nir_op_fddx:
+      case nir_op_fddy:
+      case nir_op_fddx_fine:
+      case nir_op_fddy_fine:
+      case nir_op_fddx_coarse:
+      case nir_op_fddy_coarse:
+         return false;
+      default:
+         break;
+      }
+      break;
+   }
+
+   case nir_instr_type_intrinsic: {
+      nir_intrinsic_instr *intrin = nir_instr_as_intrinsic(instr);
+      const nir_intrinsic_info *info = &nir_intrinsic_infos[intrin->intrinsic];
+
+      /* Only move loads which would run anyway, so that we never load
+       * something the shader wouldn't have.
+       */
+      if (instr->block != first_block ||
+          !(info->flags & NIR_INTRINSIC_CAN_ELIMINATE) ||
+          !(info->flags & NIR_INTRINSIC_CAN_REORDER) ||
+          info->num_variables != 0 ||
+          !info->has_dest || !intrin->dest.is_ssa)
+         return false;
+      break;
+   }
+
+   default:
+      return false;
+   }
+
+   return nir_foreach_src(instr, src_is_invariant, state);
+}
+
+static void
+move_invariants_out_of_loop(nir_loop *loop, struct gvn_state *state)
+{
+   nir_block *first_block =
+      nir_cf_node_as_block(nir_loop_first_cf_node(loop));
+   nir_block *last_block =
+      nir_cf_node_as_block(nir_loop_last_cf_node(loop));
+
+   state->preheader = nir_cf_node_as_block(nir_cf_node_prev(&loop->cf_node));
+   state->first_block = first_block->index;
+   state->last_block = last_block->index;
+
+   /* Sources are defined before they're used, so a single walk catches
+    * whole chains of invariant instructions as each one moves out.
+    */
+   nir_foreach_block_in_cf_node(block, &loop->cf_node) {
+      nir_foreach_instr_safe(instr, block) {
+         if (!instr_can_move_out_of_loop(instr, first_block, state))
+            continue;
+
+         nir_foreach_src(instr, move_src_def_out_of_loop, state);
+         move_instr_to_end_of_block(instr, state->preheader);
+         state->progress = true;
+      }
+   }
+}
+
+static bool
+get_ssa_def(nir_ssa_def *def, void *_def)
+{
+   *(nir_ssa_def **)_def = def;
+   return true;
+}
+
+/* Adds the instructions of the block which only use values defined before
+ * the if to the instruction set.
+ */
+static void
+add_available_instr(nir_instr *instr, nir_block *block,
+                    struct gvn_state *state)
+{
+   if (instr->block != block || instr->type == nir_instr_type_phi ||
+       !nir_foreach_src(instr, src_is_outside, state))
+      return;
+
+   /* Instructions reached through the uses of a hoisted value aren't in
+    * block order, so the copy already in the set may come after this one.
+    * Leave duplicates within the block to gvn_block().
+    */
+   if (!nir_instr_set_search(state->instr_set, instr))
+      nir_instr_set_add_or_rewrite(state->instr_set, instr);
+}
+
+static void
+hoist_common_instrs_out_of_if(nir_if *if_stmt, struct gvn_state *state)
+{
+   nir_block *before =
+      nir_cf_node_as_block(nir_cf_node_prev(&if_stmt->cf_node));
+   nir_block *then_block =
+      nir_cf_node_as_block(nir_if_first_then_node(if_stmt));
+   nir_block *else_block =
+      nir_cf_node_as_block(nir_if_first_else_node(if_stmt));
+   nir_block *last_block =
+      nir_cf_node_as_block(nir_if_last_else_node(if_stmt));
+
+   if (exec_list_is_empty(&then_block->instr_list) ||
+       exec_list_is_empty(&else_block->instr_list))
+      return;
+
+   state->first_block = then_block->index;
+   state->last_block = last_block->index;
+
+   _mesa_set_clear(state->instr_set, NULL);
+   nir_foreach_instr_safe(instr, else_block)
+      add_available_instr(instr, else_block, state);
+
+   nir_foreach_instr_safe(instr, then_block) {
+      if (instr->type == nir_instr_type_phi ||
+          !nir_foreach_src(instr, src_is_outside, state))
+         continue;
+
+      nir_instr *match = nir_instr_set_search(state->instr_set, instr);
+      if (!match)
+         continue;
+
+      /* Use the copy from the else side for both sides and move it before
+       * the if.  Anything on either side which used the value may now only
+       * use values from before the if as well.
+       */
+      nir_instr_set_add_or_rewrite(state->instr_set, instr);
+      nir_instr_set_remove(state->instr_set, match);
+      nir_instr_remove(instr);
+      move_instr_to_end_of_block(match, before);
+      state->progress = true;
+
+      nir_ssa_def *def = NULL;
+      nir_foreach_ssa_def(match, get_ssa_def, &def);
+      nir_foreach_use_safe(use, def)
+         add_available_instr(use->parent_instr, else_block, state);
+   }
+}
+
+static void
+gvn_cf_list(struct exec_list *cf_list, struct gvn_state *state)
+{
+   foreach_list_typed(nir_cf_node, node, node, cf_list) {
+      switch (node->type) {
+      case nir_cf_node_block:
+         break;
+
+      case nir_cf_node_if: {
+         nir_if *if_stmt = nir_cf_node_as_if(node);
+         gvn_cf_list(&if_stmt->then_list, state);
+         gvn_cf_list(&if_stmt->else_list, state);
+         hoist_common_instrs_out_of_if(if_stmt, state);
+         break;
+      }
+
+      case nir_cf_node_loop: {
+         nir_loop *loop = nir_cf_node_as_loop(node);
+         gvn_cf_list(&loop->body, state);
+         move_invariants_out_of_loop(loop, state);
+         break;
+      }
+
+      default:
+         unreachable("Invalid CF node type");
+      }
+   }
+}
+
+/*
+ * Visits and value numbers the given block and all its descendants in the
+ * dominance tree recursively, like cse_block() in nir_opt_cse.c.
+ */
+static bool
+gvn_block(nir_block *block, struct set *instr_set)
+{
+   bool progress = false;
+
+   nir_foreach_instr_safe(instr, block) {
+      if (nir_instr_set_add_or_rewrite(instr_set, instr)) {
+         progress = true;
+         nir_instr_remove(instr);
+      }
+   }
+
+   for (unsigned i = 0; i < block->num_dom_children; i++) {
+      nir_block *child = block->dom_children[i];
+      progress |= gvn_block(child, instr_set);
+   }
+
+   nir_foreach_instr(instr, block)
+     nir_instr_set_remove(instr_set, instr);
+
+   return progress;
+}
+
+static bool
+nir_opt_gvn_impl(nir_function_impl *impl)
+{
+   struct gvn_state state;
+
+   nir_metadata_require(impl, nir_metadata_block_index |
+                              nir_metadata_dominance);
+
+   state.instr_set = nir_instr_set_create(NULL);
+   state.progress = false;
+
+   gvn_cf_list(&impl->body, &state);
+
+   _mesa_set_clear(state.instr_set, NULL);
+   state.progress |= gvn_block(nir_start_block(impl), state.instr_set);
+
+   if (state.progress)
+      nir_metadata_preserve(impl, nir_metadata_block_index |
+                                  nir_metadata_dominance);
+
+   nir_instr_set_destroy(state.instr_set);
+   return state.progress;
+}
+
+bool
+nir_opt_gvn(nir_shader *shader)
+{
+   bool progress = false;
+
+   nir_foreach_function(function, shader) {
+      if (function->impl)
+         progress |= nir_opt_gvn_impl(function->impl);
+   }
+
+   return progress;
+}
@@ -214,7 +214,20 @@ nir_opt_peephole_select_block(nir_block *block, void *mem_ctx)
       nir_instr_remove(&phi->instr);
    }
 
+   /* Collapsing the if is simple enough that we can keep the dominance
+    * information up to date rather than having the next pass that needs it
+    * recompute it for the whole function.
+    */
+   nir_function_impl *impl = nir_cf_node_get_function(&block->cf_node);
+   bool dominance = impl->valid_metadata & nir_metadata_dominance;
+   if (dominance)
+      nir_dominance_remove_if(if_stmt);
+
    nir_cf_node_remove(&if_stmt->cf_node);
+
+   if (dominance)
+      impl->valid_metadata |= nir_metadata_dominance;
+
    return true;
 }
 
@@ -229,7 +242,7 @@ nir_opt_peephole_select_impl(nir_function_impl *impl)
    }
 
    if (progress)
-      nir_metadata_preserve(impl, nir_metadata_none);
+      nir_metadata_preserve(impl, nir_metadata_dominance);
 
    return progress;
 }
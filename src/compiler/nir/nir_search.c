@@ -563,6 +563,37 @@ construct_value(const nir_search_value *value,
    }
 }
 
+/**
+ * Compute the state of an ALU instruction in the tree automaton of an
+ * algebraic pass from the states of its sources.  \p states is indexed by
+ * SSA def, and the states of the sources must already be in it.
+ */
+void
+nir_algebraic_automaton(nir_alu_instr *instr, uint16_t *states,
+                        const struct per_op_table *pass_op_table)
+{
+   const struct per_op_table *tbl = &pass_op_table[instr->op];
+   uint16_t state = 0;
+
+   if (!instr->dest.dest.is_ssa)
+      return;
+
+   if (tbl->table) {
+      unsigned index = 0;
+
+      for (unsigned i = 0; i < nir_op_infos[instr->op].num_inputs; i++) {
+         const nir_src *src = &instr->src[i].src;
+         const uint16_t src_state = src->is_ssa ? states[src->ssa->index] : 0;
+
+         index = index * tbl->num_filtered_states + tbl->filter[src_state];
+      }
+
+      state = tbl->table[index];
+   }
+
+   states[instr->dest.dest.ssa.index] = state;
+}
+
 nir_alu_instr *
 nir_replace_instr(nir_alu_instr *instr, const nir_search_expression *search,
                   const nir_search_value *replace, void *mem_ctx)
@@ -112,6 +112,33 @@ NIR_DEFINE_CAST(nir_search_value_as_constant, nir_search_value,
 NIR_DEFINE_CAST(nir_search_value_as_expression, nir_search_value,
                 nir_search_expression, value)
 
+/** A search and replace rule of an algebraic pass */
+struct transform {
+   const nir_search_expression *search;
+   const nir_search_value *replace;
+   unsigned condition_offset;
+};
+
+/**
+ * Transitions of the tree automaton of an algebraic pass for one opcode,
+ * see TreeAutomaton in nir_algebraic.py.
+ */
+struct per_op_table {
+   /** Maps the state of each source to a filtered state */
+   const uint16_t *filter;
+   unsigned num_filtered_states;
+   /**
+    * The state of the instruction, indexed by the filtered states of the
+    * sources in row-major order, or NULL if no search expression has this
+    * opcode.
+    */
+   const uint16_t *table;
+};
+
+void
+nir_algebraic_automaton(nir_alu_instr *instr, uint16_t *states,
+                        const struct per_op_table *pass_op_table);
+
 nir_alu_instr *
 nir_replace_instr(nir_alu_instr *instr, const nir_search_expression *search,
                   const nir_search_value *replace, void *mem_ctx);
@@ -0,0 +1,1283 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "nir_serialize.h"
+#include "nir_control_flow_private.h"
+
+/* The encoding follows the structure of nir_clone.c: write_foo() writes a
+ * foo and read_foo() creates a new one from what write_foo() wrote.
+ *
+ * Variables, registers, SSA values, blocks and functions are referred to by
+ * an index.  The writer hands out indices the first time it sees an object,
+ * whether that is where the object is defined or, for the sources of phis,
+ * a use that comes before the definition.  The reader keeps a table from
+ * indices to the objects it has created so far, and fixes up phi sources
+ * once a whole function implementation has been read, like nir_clone.c.
+ *
+ * The reader must not crash on a corrupted blob, so every index it looks up
+ * has to refer to an object of the expected kind that has already been
+ * read, and every count is checked against what is left of the blob before
+ * anything is allocated for it.  Any failure sets the overrun flag of the
+ * blob reader, and nir_deserialize() then throws the shader away.
+ */
+
+typedef struct {
+   struct blob *blob;
+
+   /* maps pointer -> index + 1 */
+   struct hash_table *remap_table;
+
+   /* the next index to hand out */
+   uint32_t next_idx;
+} write_ctx;
+
+typedef enum {
+   read_obj_none = 0,
+   read_obj_variable,
+   read_obj_register,
+   read_obj_ssa_def,
+   read_obj_block,
+   read_obj_function,
+} read_obj_type;
+
+typedef struct {
+   void *obj;
+   read_obj_type type;
+} read_obj;
+
+typedef struct {
+   nir_shader *nir;
+
+   struct blob_reader *blob;
+
+   /* maps index -> pointer and the kind of object it points to */
+   uint32_t idx_table_len;
+   read_obj *idx_table;
+
+   /* List of phi sources that still refer to indices. */
+   struct list_head phi_srcs;
+} read_ctx;
+
+static uint32_t
+write_lookup_object(write_ctx *ctx, const void *obj)
+{
+   struct hash_entry *entry = _mesa_hash_table_search(ctx->remap_table, obj);
+   if (entry)
+      return (uint32_t)(uintptr_t) entry->data - 1;
+
+   uint32_t idx = ctx->next_idx++;
+   _mesa_hash_table_insert(ctx->remap_table, obj,
+                           (void *)(uintptr_t) (idx + 1));
+   return idx;
+}
+
+static void
+write_object(write_ctx *ctx, const void *obj)
+{
+   blob_write_uint32(ctx->blob, write_lookup_object(ctx, obj));
+}
+
+static void
+read_add_object(read_ctx *ctx, uint32_t idx, read_obj_type type, void *obj)
+{
+   /* Each index is defined exactly once. */
+   if (idx >= ctx->idx_table_len ||
+       ctx->idx_table[idx].type != read_obj_none) {
+      ctx->blob->overrun = true;
+      return;
+   }
+
+   ctx->idx_table[idx].obj = obj;
+   ctx->idx_table[idx].type = type;
+}
+
+static void *
+read_lookup_object(read_ctx *ctx, uint32_t idx, read_obj_type type)
+{
+   if (idx >= ctx->idx_table_len || ctx->idx_table[idx].type != type) {
+      ctx->blob->overrun = true;
+      return NULL;
+   }
+
+   return ctx->idx_table[idx].obj;
+}
+
+static void *
+read_object(read_ctx *ctx, read_obj_type type)
+{
+   return read_lookup_object(ctx, blob_read_uint32(ctx->blob), type);
+}
+
+/* Reads the number of items that follow, each of which takes at least
+ * min_size bytes of the blob, so that a corrupted count can't make us
+ * allocate or recurse more than the blob could possibly describe.
+ */
+static uint32_t
+read_count(read_ctx *ctx, size_t min_size)
+{
+   uint32_t count = blob_read_uint32(ctx->blob);
+   if (ctx->blob->overrun ||
+       count > (size_t)(ctx->blob->end - ctx->blob->current) / min_size) {
+      ctx->blob->overrun = true;
+      return 0;
+   }
+
+   return count;
+}
+
+static void
+write_string_or_null(write_ctx *ctx, const char *str)
+{
+   blob_write_uint32(ctx->blob, str != NULL);
+   if (str)
+      blob_write_string(ctx->blob, str);
+}
+
+static char *
+read_string_or_null(read_ctx *ctx, void *mem_ctx)
+{
+   if (!blob_read_uint32(ctx->blob))
+      return NULL;
+
+   const char *str = blob_read_string(ctx->blob);
+   return str ? ralloc_strdup(mem_ctx, str) : NULL;
+}
+
+static void
+write_constant(write_ctx *ctx, const nir_constant *c)
+{
+   blob_write_bytes(ctx->blob, &c->value, sizeof(c->value));
+   blob_write_uint32(ctx->blob, c->num_elements);
+   for (unsigned i = 0; i < c->num_elements; i++)
+      write_constant(ctx, c->elements[i]);
+}
+
+static nir_constant *
+read_constant(read_ctx *ctx, nir_variable *nvar)
+{
+   nir_constant *c = ralloc(nvar, nir_constant);
+
+   blob_copy_bytes(ctx->blob, (uint8_t *) &c->value, sizeof(c->value));
+   c->num_elements = read_count(ctx, sizeof(c->value) + sizeof(uint32_t));
+   c->elements = ralloc_array(nvar, nir_constant *, c->num_elements);
+   for (unsigned i = 0; i < c->num_elements; i++)
+      c->elements[i] = read_constant(ctx, nvar);
+
+   return c;
+}
+
+static void
+write_variable(write_ctx *ctx, const nir_variable *var)
+{
+   write_object(ctx, var);
+   encode_type_to_blob(ctx->blob, var->type);
+   write_string_or_null(ctx, var->name);
+   blob_write_bytes(ctx->blob, &var->data, sizeof(var->data));
+   blob_write_uint32(ctx->blob, var->num_state_slots);
+   if (var->num_state_slots) {
+      blob_write_bytes(ctx->blob, var->state_slots,
+                       var->num_state_slots * sizeof(nir_state_slot));
+   }
+   blob_write_uint32(ctx->blob, var->constant_initializer != NULL);
+   if (var->constant_initializer)
+      write_constant(ctx, var->constant_initializer);
+   encode_type_to_blob(ctx->blob, var->interface_type);
+}
+
+/* Like nir_variable_clone(), this bypasses nir_variable_create() to avoid
+ * having to deal with locals and globals separately.
+ */
+static nir_variable *
+read_variable(read_ctx *ctx)
+{
+   nir_variable *var = rzalloc(ctx->nir, nir_variable);
+   read_add_object(ctx, blob_read_uint32(ctx->blob), read_obj_variable, var);
+
+   var->type = decode_type_from_blob(ctx->blob);
+   var->name = read_string_or_null(ctx, var);
+   blob_copy_bytes(ctx->blob, (uint8_t *) &var->data, sizeof(var->data));
+   var->num_state_slots = read_count(ctx, sizeof(nir_state_slot));
+   var->state_slots = ralloc_array(var, nir_state_slot, var->num_state_slots);
+   blob_copy_bytes(ctx->blob, (uint8_t *) var->state_slots,
+                   var->num_state_slots * sizeof(nir_state_slot));
+   if (blob_read_uint32(ctx->blob))
+      var->constant_initializer = read_constant(ctx, var);
+   var->interface_type = decode_type_from_blob(ctx->blob);
+
+   return var;
+}
+
+static void
+write_var_list(write_ctx *ctx, const struct exec_list *src)
+{
+   blob_write_uint32(ctx->blob, exec_list_length(src));
+   foreach_list_typed(nir_variable, var, node, src)
+      write_variable(ctx, var);
+}
+
+static void
+read_var_list(read_ctx *ctx, struct exec_list *dst)
+{
+   exec_list_make_empty(dst);
+   unsigned num_vars = blob_read_uint32(ctx->blob);
+   for (unsigned i = 0; i < num_vars && !ctx->blob->overrun; i++) {
+      nir_variable *var = read_variable(ctx);
+      exec_list_push_tail(dst, &var->node);
+   }
+}
+
+static void
+write_register(write_ctx *ctx, const nir_register *reg)
+{
+   write_object(ctx, reg);
+   blob_write_uint32(ctx->blob, reg->num_components);
+   blob_write_uint32(ctx->blob, reg->bit_size);
+   blob_write_uint32(ctx->blob, reg->num_array_elems);
+   blob_write_uint32(ctx->blob, reg->index);
+   write_string_or_null(ctx, reg->name);
+   blob_write_uint32(ctx->blob, reg->is_global << 1 | reg->is_packed);
+}
+
+/* Like clone_register(), this bypasses nir_global/local_reg_create(). */
+static nir_register *
+read_register(read_ctx *ctx)
+{
+   nir_register *reg = ralloc(ctx->nir, nir_register);
+   read_add_object(ctx, blob_read_uint32(ctx->blob), read_obj_register, reg);
+
+   reg->num_components = blob_read_uint32(ctx->blob);
+   reg->bit_size = blob_read_uint32(ctx->blob);
+   reg->num_array_elems = blob_read_uint32(ctx->blob);
+   reg->index = blob_read_uint32(ctx->blob);
+   reg->name = read_string_or_null(ctx, reg);
+   uint32_t flags = blob_read_uint32(ctx->blob);
+   reg->is_global = (flags >> 1) & 1;
+   reg->is_packed = flags & 1;
+
+   /* uses/defs/if_uses are set up by nir_instr_insert() */
+   list_inithead(&reg->uses);
+   list_inithead(&reg->defs);
+   list_inithead(&reg->if_uses);
+
+   return reg;
+}
+
+static void
+write_reg_list(write_ctx *ctx, const struct exec_list *src)
+{
+   blob_write_uint32(ctx->blob, exec_list_length(src));
+   foreach_list_typed(nir_register, reg, node, src)
+      write_register(ctx, reg);
+}
+
+static void
+read_reg_list(read_ctx *ctx, struct exec_list *dst)
+{
+   exec_list_make_empty(dst);
+   unsigned num_regs = blob_read_uint32(ctx->blob);
+   for (unsigned i = 0; i < num_regs && !ctx->blob->overrun; i++) {
+      nir_register *reg = read_register(ctx);
+      exec_list_push_tail(dst, &reg->node);
+   }
+}
+
+/* Sources and destinations start with a word of flags. */
+#define SRC_IS_SSA         (1 << 0)
+#define SRC_HAS_INDIRECT   (1 << 1)
+
+static void
+write_src(write_ctx *ctx, const nir_src *src)
+{
+   if (src->is_ssa) {
+      blob_write_uint32(ctx->blob, SRC_IS_SSA);
+      write_object(ctx, src->ssa);
+   } else {
+      blob_write_uint32(ctx->blob,
+                        src->reg.indirect ? SRC_HAS_INDIRECT : 0);
+      write_object(ctx, src->reg.reg);
+      blob_write_uint32(ctx->blob, src->reg.base_offset);
+      if (src->reg.indirect)
+         write_src(ctx, src->reg.indirect);
+   }
+}
+
+static void
+read_src(read_ctx *ctx, nir_src *src, void *mem_ctx)
+{
+   uint32_t flags = blob_read_uint32(ctx->blob);
+
+   if (flags & SRC_IS_SSA) {
+      src->is_ssa = true;
+      src->ssa = read_object(ctx, read_obj_ssa_def);
+   } else {
+      src->is_ssa = false;
+      src->reg.reg = read_object(ctx, read_obj_register);
+      src->reg.base_offset = blob_read_uint32(ctx->blob);
+      if (flags & SRC_HAS_INDIRECT) {
+         src->reg.indirect = ralloc(mem_ctx, nir_src);
+         read_src(ctx, src->reg.indirect, mem_ctx);
+      } else {
+         src->reg.indirect = NULL;
+      }
+   }
+}
+
+#define DEST_IS_SSA        (1 << 0)
+#define DEST_HAS_INDIRECT  (1 << 1)
+#define DEST_HAS_NAME      (1 << 2)
+
+static void
+write_dest(write_ctx *ctx, const nir_dest *dst)
+{
+   if (dst->is_ssa) {
+      blob_write_uint32(ctx->blob, DEST_IS_SSA |
+                        (dst->ssa.name ? DEST_HAS_NAME : 0) |
+                        dst->ssa.num_components << 8 |
+                        dst->ssa.bit_size << 16);
+      write_object(ctx, &dst->ssa);
+      blob_write_uint32(ctx->blob, dst->ssa.index);
+      if (dst->ssa.name)
+         blob_write_string(ctx->blob, dst->ssa.name);
+   } else {
+      blob_write_uint32(ctx->blob,
+                        dst->reg.indirect ? DEST_HAS_INDIRECT : 0);
+      write_object(ctx, dst->reg.reg);
+      blob_write_uint32(ctx->blob, dst->reg.base_offset);
+      if (dst->reg.indirect)
+         write_src(ctx, dst->reg.indirect);
+   }
+}
+
+static void
+read_dest(read_ctx *ctx, nir_dest *dst, nir_instr *instr)
+{
+   uint32_t flags = blob_read_uint32(ctx->blob);
+
+   if (flags & DEST_IS_SSA) {
+      uint32_t idx = blob_read_uint32(ctx->blob);
+      uint32_t index = blob_read_uint32(ctx->blob);
+      const char *name = NULL;
+      if (flags & DEST_HAS_NAME)
+         name = blob_read_string(ctx->blob);
+
+      nir_ssa_dest_init(instr, dst, (flags >> 8) & 0xff,
+                        (flags >> 16) & 0xff, name);
+      read_add_object(ctx, idx, read_obj_ssa_def, &dst->ssa);
+
+      /* Keep the original index, nir_instr_insert() only hands out new
+       * indices to values that don't have one yet.
+       */
+      dst->ssa.index = index;
+   } else {
+      dst->is_ssa = false;
+      dst->reg.reg = read_object(ctx, read_obj_register);
+      dst->reg.base_offset = blob_read_uint32(ctx->blob);
+      if (flags & DEST_HAS_INDIRECT) {
+         dst->reg.indirect = ralloc(instr, nir_src);
+         read_src(ctx, dst->reg.indirect, instr);
+      } else {
+         dst->reg.indirect = NULL;
+      }
+   }
+}
+
+static void
+write_deref_chain(write_ctx *ctx, const nir_deref_var *deref_var)
+{
+   write_object(ctx, deref_var->var);
+
+   uint32_t len = 0;
+   for (const nir_deref *d = deref_var->deref.child; d; d = d->child)
+      len++;
+   blob_write_uint32(ctx->blob, len);
+
+   for (const nir_deref *d = deref_var->deref.child; d; d = d->child) {
+      blob_write_uint32(ctx->blob, d->deref_type);
+      switch (d->deref_type) {
+      case nir_deref_type_array: {
+         const nir_deref_array *deref_array = nir_deref_as_array(d);
+         blob_write_uint32(ctx->blob, deref_array->deref_array_type);
+         blob_write_uint32(ctx->blob, deref_array->base_offset);
+         if (deref_array->deref_array_type == nir_deref_array_type_indirect)
+            write_src(ctx, &deref_array->indirect);
+         break;
+      }
+      case nir_deref_type_struct:
+         blob_write_uint32(ctx->blob, nir_deref_as_struct(d)->index);
+         break;
+      case nir_deref_type_var:
+         unreachable("Invalid deref type");
+      }
+
+      encode_type_to_blob(ctx->blob, d->type);
+   }
+}
+
+static nir_deref_var *
+read_deref_chain(read_ctx *ctx, nir_instr *instr)
+{
+   nir_variable *var = read_object(ctx, read_obj_variable);
+   if (var == NULL)
+      return NULL;
+
+   nir_deref_var *deref_var = nir_deref_var_create(instr, var);
+
+   uint32_t len = blob_read_uint32(ctx->blob);
+
+   nir_deref *tail = &deref_var->deref;
+   for (uint32_t i = 0; i < len && !ctx->blob->overrun; i++) {
+      nir_deref_type deref_type = blob_read_uint32(ctx->blob);
+      nir_deref *deref = NULL;
+      switch (deref_type) {
+      case nir_deref_type_array: {
+         nir_deref_array *deref_array = nir_deref_array_create(tail);
+         deref_array->deref_array_type = blob_read_uint32(ctx->blob);
+         deref_array->base_offset = blob_read_uint32(ctx->blob);
+         if (deref_array->deref_array_type == nir_deref_array_type_indirect)
+            read_src(ctx, &deref_array->indirect, instr);
+         deref = &deref_array->deref;
+         break;
+      }
+      case nir_deref_type_struct: {
+         uint32_t index = blob_read_uint32(ctx->blob);
+         deref = &nir_deref_struct_create(tail, index)->deref;
+         break;
+      }
+      default:
+         ctx->blob->overrun = true;
+         return deref_var;
+      }
+
+      deref->type = decode_type_from_blob(ctx->blob);
+      tail->child = deref;
+      tail = deref;
+   }
+
+   return deref_var;
+}
+
+static void
+write_alu(write_ctx *ctx, const nir_alu_instr *alu)
+{
+   blob_write_uint32(ctx->blob, alu->op);
+   blob_write_uint32(ctx->blob, alu->exact |
+                     alu->dest.saturate << 1 |
+                     alu->dest.write_mask << 2);
+
+   write_dest(ctx, &alu->dest.dest);
+
+   for (unsigned i = 0; i < nir_op_infos[alu->op].num_inputs; i++) {
+      const nir_alu_src *src = &alu->src[i];
+      write_src(ctx, &src->src);
+      blob_write_uint32(ctx->blob, src->negate |
+                        src->abs << 1 |
+                        src->swizzle[0] << 2 |
+                        src->swizzle[1] << 4 |
+                        src->swizzle[2] << 6 |
+                        src->swizzle[3] << 8);
+   }
+}
+
+static nir_alu_instr *
+read_alu(read_ctx *ctx)
+{
+   nir_op op = blob_read_uint32(ctx->blob);
+   if (op >= nir_num_opcodes) {
+      ctx->blob->overrun = true;
+      return NULL;
+   }
+
+   nir_alu_instr *alu = nir_alu_instr_create(ctx->nir, op);
+
+   uint32_t flags = blob_read_uint32(ctx->blob);
+   alu->exact = flags & 1;
+   alu->dest.saturate = (flags >> 1) & 1;
+   alu->dest.write_mask = (flags >> 2) & 0xf;
+
+   read_dest(ctx, &alu->dest.dest, &alu->instr);
+
+   for (unsigned i = 0; i < nir_op_infos[op].num_inputs; i++) {
+      nir_alu_src *src = &alu->src[i];
+      read_src(ctx, &src->src, &alu->instr);
+      uint32_t packed = blob_read_uint32(ctx->blob);
+      src->negate = packed & 1;
+      src->abs = (packed >> 1) & 1;
+      for (unsigned c = 0; c < 4; c++)
+         src->swizzle[c] = (packed >> (2 + 2 * c)) & 3;
+   }
+
+   return alu;
+}
+
+static void
+write_intrinsic(write_ctx *ctx, const nir_intrinsic_instr *intrin)
+{
+   const nir_intrinsic_info *info = &nir_intrinsic_infos[intrin->intrinsic];
+
+   blob_write_uint32(ctx->blob, intrin->intrinsic);
+   blob_write_uint32(ctx->blob, intrin->num_components);
+
+   if (info->has_dest)
+      write_dest(ctx, &intrin->dest);
+
+   for (unsigned i = 0; i < info->num_variables; i++)
+      write_deref_chain(ctx, intrin->variables[i]);
+
+   for (unsigned i = 0; i < info->num_srcs; i++)
+      write_src(ctx, &intrin->src[i]);
+
+   blob_write_bytes(ctx->blob, intrin->const_index,
+                    info->num_indices * sizeof(intrin->const_index[0]));
+}
+
+static nir_intrinsic_instr *
+read_intrinsic(read_ctx *ctx)
+{
+   nir_intrinsic_op op = blob_read_uint32(ctx->blob);
+   if (op >= nir_num_intrinsics) {
+      ctx->blob->overrun = true;
+      return NULL;
+   }
+
+   const nir_intrinsic_info *info = &nir_intrinsic_infos[op];
+   nir_intrinsic_instr *intrin = nir_intrinsic_instr_create(ctx->nir, op);
+
+   intrin->num_components = blob_read_uint32(ctx->blob);
+
+   if (info->has_dest)
+      read_dest(ctx, &intrin->dest, &intrin->instr);
+
+   for (unsigned i = 0; i < info->num_variables; i++)
+      intrin->variables[i] = read_deref_chain(ctx, &intrin->instr);
+
+   for (unsigned i = 0; i < info->num_srcs; i++)
+      read_src(ctx, &intrin->src[i], &intrin->instr);
+
+   blob_copy_bytes(ctx->blob, (uint8_t *) intrin->const_index,
+                   info->num_indices * sizeof(intrin->const_index[0]));
+
+   return intrin;
+}
+
+static void
+write_load_const(write_ctx *ctx, const nir_load_const_instr *lc)
+{
+   blob_write_uint32(ctx->blob, lc->def.num_components |
+                     lc->def.bit_size << 8);
+   blob_write_bytes(ctx->blob, &lc->value, sizeof(lc->value));
+   write_object(ctx, &lc->def);
+   blob_write_uint32(ctx->blob, lc->def.index);
+}
+
+static nir_load_const_instr *
+read_load_const(read_ctx *ctx)
+{
+   uint32_t packed = blob_read_uint32(ctx->blob);
+   nir_load_const_instr *lc =
+      nir_load_const_instr_create(ctx->nir, packed & 0xff,
+                                  (packed >> 8) & 0xff);
+
+   blob_copy_bytes(ctx->blob, (uint8_t *) &lc->value, sizeof(lc->value));
+   read_add_object(ctx, blob_read_uint32(ctx->blob), read_obj_ssa_def,
+                   &lc->def);
+   lc->def.index = blob_read_uint32(ctx->blob);
+
+   return lc;
+}
+
+static void
+write_ssa_undef(write_ctx *ctx, const nir_ssa_undef_instr *undef)
+{
+   blob_write_uint32(ctx->blob, undef->def.num_components |
+                     undef->def.bit_size << 8);
+   write_object(ctx, &undef->def);
+   blob_write_uint32(ctx->blob, undef->def.index);
+}
+
+static nir_ssa_undef_instr *
+read_ssa_undef(read_ctx *ctx)
+{
+   uint32_t packed = blob_read_uint32(ctx->blob);
+   nir_ssa_undef_instr *undef =
+      nir_ssa_undef_instr_create(ctx->nir, packed & 0xff,
+                                 (packed >> 8) & 0xff);
+
+   read_add_object(ctx, blob_read_uint32(ctx->blob), read_obj_ssa_def,
+                   &undef->def);
+   undef->def.index = blob_read_uint32(ctx->blob);
+
+   return undef;
+}
+
+static void
+write_tex(write_ctx *ctx, const nir_tex_instr *tex)
+{
+   blob_write_uint32(ctx->blob, tex->num_srcs);
+   blob_write_uint32(ctx->blob, tex->op);
+   blob_write_uint32(ctx->blob, tex->sampler_dim);
+   blob_write_uint32(ctx->blob, tex->dest_type);
+   blob_write_uint32(ctx->blob, tex->coord_components);
+   blob_write_uint32(ctx->blob, tex->is_array |
+                     tex->is_shadow << 1 |
+                     tex->is_new_style_shadow << 2 |
+                     tex->component << 3 |
+                     (tex->texture != NULL) << 5 |
+                     (tex->sampler != NULL) << 6);
+   blob_write_uint32(ctx->blob, tex->texture_index);
+   blob_write_uint32(ctx->blob, tex->texture_array_size);
+   blob_write_uint32(ctx->blob, tex->sampler_index);
+
+   write_dest(ctx, &tex->dest);
+   for (unsigned i = 0; i < tex->num_srcs; i++) {
+      blob_write_uint32(ctx->blob, tex->src[i].src_type);
+      write_src(ctx, &tex->src[i].src);
+   }
+
+   if (tex->texture)
+      write_deref_chain(ctx, tex->texture);
+   if (tex->sampler)
+      write_deref_chain(ctx, tex->sampler);
+}
+
+static nir_tex_instr *
+read_tex(read_ctx *ctx)
+{
+   /* Each source is at least a type, flags and an index. */
+   unsigned num_srcs = read_count(ctx, 3 * sizeof(uint32_t));
+   if (ctx->blob->overrun)
+      return NULL;
+
+   nir_tex_instr *tex = nir_tex_instr_create(ctx->nir, num_srcs);
+
+   tex->op = blob_read_uint32(ctx->blob);
+   tex->sampler_dim = blob_read_uint32(ctx->blob);
+   tex->dest_type = blob_read_uint32(ctx->blob);
+   tex->coord_components = blob_read_uint32(ctx->blob);
+   uint32_t flags = blob_read_uint32(ctx->blob);
+   tex->is_array = flags & 1;
+   tex->is_shadow = (flags >> 1) & 1;
+   tex->is_new_style_shadow = (flags >> 2) & 1;
+   tex->component = (flags >> 3) & 3;
+   tex->texture_index = blob_read_uint32(ctx->blob);
+   tex->texture_array_size = blob_read_uint32(ctx->blob);
+   tex->sampler_index = blob_read_uint32(ctx->blob);
+
+   read_dest(ctx, &tex->dest, &tex->instr);
+   for (unsigned i = 0; i < tex->num_srcs; i++) {
+      tex->src[i].src_type = blob_read_uint32(ctx->blob);
+      read_src(ctx, &tex->src[i].src, &tex->instr);
+   }
+
+   if (flags & (1 << 5))
+      tex->texture = read_deref_chain(ctx, &tex->instr);
+   if (flags & (1 << 6))
+      tex->sampler = read_deref_chain(ctx, &tex->instr);
+
+   return tex;
+}
+
+static void
+write_phi(write_ctx *ctx, const nir_phi_instr *phi)
+{
+   /* The sources of a phi may come from blocks and SSA values that haven't
+    * been written yet.  That is fine, write_object() hands out their
+    * indices now and the definitions will use the same ones.
+    */
+   write_dest(ctx, &phi->dest);
+
+   blob_write_uint32(ctx->blob, exec_list_length(&phi->srcs));
+
+   nir_foreach_phi_src(src, phi) {
+      assert(src->src.is_ssa);
+      write_object(ctx, src->src.ssa);
+      write_object(ctx, src->pred);
+   }
+}
+
+static void
+read_phi(read_ctx *ctx, nir_block *blk)
+{
+   nir_phi_instr *phi = nir_phi_instr_create(ctx->nir);
+
+   read_dest(ctx, &phi->dest, &phi->instr);
+   if (!phi->dest.is_ssa)
+      ctx->blob->overrun = true;
+   if (ctx->blob->overrun)
+      return;
+
+   /* As in clone_phi(), insert the phi before its sources are set up, so
+    * that nir_instr_insert() doesn't touch the use lists of sources that
+    * may not exist yet.
+    */
+   nir_instr_insert_after_block(blk, &phi->instr);
+
+   unsigned num_srcs = blob_read_uint32(ctx->blob);
+   for (unsigned i = 0; i < num_srcs && !ctx->blob->overrun; i++) {
+      nir_phi_src *src = ralloc(phi, nir_phi_src);
+
+      /* Stash the indices in the pointers, read_function_impl() looks them
+       * up once the whole implementation has been read.
+       */
+      src->src.is_ssa = true;
+      src->src.ssa = (nir_ssa_def *)(uintptr_t) blob_read_uint32(ctx->blob);
+      src->pred = (nir_block *)(uintptr_t) blob_read_uint32(ctx->blob);
+      src->src.parent_instr = &phi->instr;
+
+      list_add(&src->src.use_link, &ctx->phi_srcs);
+
+      exec_list_push_tail(&phi->srcs, &src->node);
+   }
+}
+
+static void
+write_jump(write_ctx *ctx, const nir_jump_instr *jmp)
+{
+   blob_write_uint32(ctx->blob, jmp->type);
+}
+
+static nir_jump_instr *
+read_jump(read_ctx *ctx, nir_block *blk)
+{
+   nir_jump_type type = blob_read_uint32(ctx->blob);
+
+   /* nir_handle_add_jump() expects breaks and continues to be in a loop. */
+   bool valid = type == nir_jump_return;
+   if (type == nir_jump_break || type == nir_jump_continue) {
+      for (nir_cf_node *node = blk->cf_node.parent; node; node = node->parent) {
+         if (node->type == nir_cf_node_loop)
+            valid = true;
+      }
+   }
+
+   if (!valid) {
+      ctx->blob->overrun = true;
+      return NULL;
+   }
+
+   return nir_jump_instr_create(ctx->nir, type);
+}
+
+static void
+write_call(write_ctx *ctx, const nir_call_instr *call)
+{
+   write_object(ctx, call->callee);
+
+   for (unsigned i = 0; i < call->num_params; i++)
+      write_deref_chain(ctx, call->params[i]);
+
+   blob_write_uint32(ctx->blob, call->return_deref != NULL);
+   if (call->return_deref)
+      write_deref_chain(ctx, call->return_deref);
+}
+
+static nir_call_instr *
+read_call(read_ctx *ctx)
+{
+   nir_function *callee = read_object(ctx, read_obj_function);
+   if (callee == NULL)
+      return NULL;
+
+   nir_call_instr *call = nir_call_instr_create(ctx->nir, callee);
+
+   for (unsigned i = 0; i < call->num_params; i++)
+      call->params[i] = read_deref_chain(ctx, &call->instr);
+
+   if (blob_read_uint32(ctx->blob))
+      call->return_deref = read_deref_chain(ctx, &call->instr);
+
+   return call;
+}
+
+static void
+write_instr(write_ctx *ctx, const nir_instr *instr)
+{
+   blob_write_uint32(ctx->blob, instr->type);
+
+   switch (instr->type) {
+   case nir_instr_type_alu:
+      write_alu(ctx, nir_instr_as_alu(instr));
+      break;
+   case nir_instr_type_intrinsic:
+      write_intrinsic(ctx, nir_instr_as_intrinsic(instr));
+      break;
+   case nir_instr_type_load_const:
+      write_load_const(ctx, nir_instr_as_load_const(instr));
+      break;
+   case nir_instr_type_ssa_undef:
+      write_ssa_undef(ctx, nir_instr_as_ssa_undef(instr));
+      break;
+   case nir_instr_type_tex:
+      write_tex(ctx, nir_instr_as_tex(instr));
+      break;
+   case nir_instr_type_phi:
+      write_phi(ctx, nir_instr_as_phi(instr));
+      break;
+   case nir_instr_type_jump:
+      write_jump(ctx, nir_instr_as_jump(instr));
+      break;
+   case nir_instr_type_call:
+      write_call(ctx, nir_instr_as_call(instr));
+      break;
+   case nir_instr_type_parallel_copy:
+      unreachable("Cannot write parallel copies");
+   default:
+      unreachable("bad instr type");
+   }
+}
+
+static void
+read_instr(read_ctx *ctx, nir_block *blk)
+{
+   nir_instr_type type = blob_read_uint32(ctx->blob);
+   nir_instr *instr;
+
+   switch (type) {
+   case nir_instr_type_alu: {
+      nir_alu_instr *alu = read_alu(ctx);
+      instr = alu ? &alu->instr : NULL;
+      break;
+   }
+   case nir_instr_type_intrinsic: {
+      nir_intrinsic_instr *intrin = read_intrinsic(ctx);
+      instr = intrin ? &intrin->instr : NULL;
+      break;
+   }
+   case nir_instr_type_load_const:
+      instr = &read_load_const(ctx)->instr;
+      break;
+   case nir_instr_type_ssa_undef:
+      instr = &read_ssa_undef(ctx)->instr;
+      break;
+   case nir_instr_type_tex: {
+      nir_tex_instr *tex = read_tex(ctx);
+      instr = tex ? &tex->instr : NULL;
+      break;
+   }
+   case nir_instr_type_phi:
+      /* Phis insert themselves, see read_phi(). */
+      read_phi(ctx, blk);
+      return;
+   case nir_instr_type_jump: {
+      nir_jump_instr *jump = read_jump(ctx, blk);
+      instr = jump ? &jump->instr : NULL;
+      break;
+   }
+   case nir_instr_type_call: {
+      nir_call_instr *call = read_call(ctx);
+      instr = call ? &call->instr : NULL;
+      break;
+   }
+   default:
+      ctx->blob->overrun = true;
+      return;
+   }
+
+   /* Don't insert anything that refers to objects we failed to read. */
+   if (instr == NULL || ctx->blob->overrun)
+      return;
+
+   /* A jump has to be the last instruction of its block. */
+   nir_instr *last = nir_block_last_instr(blk);
+   if (last && last->type == nir_instr_type_jump) {
+      ctx->blob->overrun = true;
+      return;
+   }
+
+   nir_instr_insert_after_block(blk, instr);
+}
+
+static void
+write_block(write_ctx *ctx, const nir_block *block)
+{
+   write_object(ctx, block);
+   blob_write_uint32(ctx->blob, exec_list_length(&block->instr_list));
+   nir_foreach_instr(instr, block)
+      write_instr(ctx, instr);
+}
+
+static void
+read_block(read_ctx *ctx, struct exec_list *cf_list)
+{
+   /* Like clone_block(), don't create a new block and use the one at the
+    * tail of the list, which NIR guarantees to be an empty block.
+    */
+   nir_block *blk =
+      exec_node_data(nir_block, exec_list_get_tail(cf_list), cf_node.node);
+   assert(blk->cf_node.type == nir_cf_node_block);
+
+   read_add_object(ctx, blob_read_uint32(ctx->blob), read_obj_block, blk);
+
+   unsigned num_instrs = blob_read_uint32(ctx->blob);
+   for (unsigned i = 0; i < num_instrs && !ctx->blob->overrun; i++)
+      read_instr(ctx, blk);
+}
+
+static void
+write_cf_list(write_ctx *ctx, const struct exec_list *cf_list);
+
+static void
+read_cf_list(read_ctx *ctx, struct exec_list *cf_list);
+
+static void
+write_if(write_ctx *ctx, nir_if *nif)
+{
+   write_src(ctx, &nif->condition);
+
+   write_cf_list(ctx, &nif->then_list);
+   write_cf_list(ctx, &nif->else_list);
+}
+
+static void
+read_if(read_ctx *ctx, struct exec_list *cf_list)
+{
+   nir_if *nif = nir_if_create(ctx->nir);
+
+   read_src(ctx, &nif->condition, nif);
+   if (ctx->blob->overrun)
+      return;
+
+   nir_cf_node_insert_end(cf_list, &nif->cf_node);
+
+   read_cf_list(ctx, &nif->then_list);
+   read_cf_list(ctx, &nif->else_list);
+}
+
+static void
+write_loop(write_ctx *ctx, nir_loop *loop)
+{
+   write_cf_list(ctx, &loop->body);
+}
+
+static void
+read_loop(read_ctx *ctx, struct exec_list *cf_list)
+{
+   nir_loop *loop = nir_loop_create(ctx->nir);
+
+   nir_cf_node_insert_end(cf_list, &loop->cf_node);
+
+   read_cf_list(ctx, &loop->body);
+}
+
+static void
+write_cf_node(write_ctx *ctx, nir_cf_node *cf)
+{
+   blob_write_uint32(ctx->blob, cf->type);
+
+   switch (cf->type) {
+   case nir_cf_node_block:
+      write_block(ctx, nir_cf_node_as_block(cf));
+      break;
+   case nir_cf_node_if:
+      write_if(ctx, nir_cf_node_as_if(cf));
+      break;
+   case nir_cf_node_loop:
+      write_loop(ctx, nir_cf_node_as_loop(cf));
+      break;
+   default:
+      unreachable("bad cf type");
+   }
+}
+
+static void
+read_cf_node(read_ctx *ctx, struct exec_list *list)
+{
+   nir_cf_node_type type = blob_read_uint32(ctx->blob);
+
+   switch (type) {
+   case nir_cf_node_block:
+      read_block(ctx, list);
+      break;
+   case nir_cf_node_if:
+      read_if(ctx, list);
+      break;
+   case nir_cf_node_loop:
+      read_loop(ctx, list);
+      break;
+   default:
+      ctx->blob->overrun = true;
+   }
+}
+
+static void
+write_cf_list(write_ctx *ctx, const struct exec_list *cf_list)
+{
+   blob_write_uint32(ctx->blob, exec_list_length(cf_list));
+   foreach_list_typed(nir_cf_node, cf, node, cf_list)
+      write_cf_node(ctx, cf);
+}
+
+static void
+read_cf_list(read_ctx *ctx, struct exec_list *cf_list)
+{
+   uint32_t num_cf_nodes = blob_read_uint32(ctx->blob);
+   for (unsigned i = 0; i < num_cf_nodes && !ctx->blob->overrun; i++)
+      read_cf_node(ctx, cf_list);
+}
+
+static void
+write_function_impl(write_ctx *ctx, const nir_function_impl *fi)
+{
+   write_var_list(ctx, &fi->locals);
+   write_reg_list(ctx, &fi->registers);
+   blob_write_uint32(ctx->blob, fi->reg_alloc);
+
+   blob_write_uint32(ctx->blob, fi->num_params);
+   for (unsigned i = 0; i < fi->num_params; i++)
+      write_variable(ctx, fi->params[i]);
+
+   blob_write_uint32(ctx->blob, fi->return_var != NULL);
+   if (fi->return_var)
+      write_variable(ctx, fi->return_var);
+
+   write_cf_list(ctx, &fi->body);
+
+   blob_write_uint32(ctx->blob, fi->ssa_alloc);
+}
+
+static nir_function_impl *
+read_function_impl(read_ctx *ctx, nir_function *fxn)
+{
+   nir_function_impl *fi = nir_function_impl_create_bare(ctx->nir);
+   fi->function = fxn;
+
+   read_var_list(ctx, &fi->locals);
+   read_reg_list(ctx, &fi->registers);
+   fi->reg_alloc = blob_read_uint32(ctx->blob);
+
+   fi->num_params = read_count(ctx, sizeof(uint32_t));
+   fi->params = ralloc_array(ctx->nir, nir_variable *, fi->num_params);
+   for (unsigned i = 0; i < fi->num_params; i++)
+      fi->params[i] = read_variable(ctx);
+
+   if (blob_read_uint32(ctx->blob))
+      fi->return_var = read_variable(ctx);
+
+   assert(list_empty(&ctx->phi_srcs));
+
+   read_cf_list(ctx, &fi->body);
+
+   /* Now that every block and SSA value of the implementation exists, look
+    * up the sources of the phis and put them in the use lists.
+    */
+   list_for_each_entry_safe(nir_phi_src, src, &ctx->phi_srcs, src.use_link) {
+      src->src.ssa = read_lookup_object(ctx, (uintptr_t) src->src.ssa,
+                                        read_obj_ssa_def);
+      src->pred = read_lookup_object(ctx, (uintptr_t) src->pred,
+                                     read_obj_block);
+
+      list_del(&src->src.use_link);
+      if (src->src.ssa == NULL || src->pred == NULL)
+         continue;
+      list_addtail(&src->src.use_link, &src->src.ssa->uses);
+   }
+   assert(list_empty(&ctx->phi_srcs));
+
+   fi->ssa_alloc = blob_read_uint32(ctx->blob);
+
+   /* No metadata is kept. */
+   fi->valid_metadata = nir_metadata_none;
+
+   return fi;
+}
+
+static void
+write_function(write_ctx *ctx, const nir_function *fxn)
+{
+   write_object(ctx, fxn);
+   write_string_or_null(ctx, fxn->name);
+
+   blob_write_uint32(ctx->blob, fxn->num_params);
+   for (unsigned i = 0; i < fxn->num_params; i++) {
+      blob_write_uint32(ctx->blob, fxn->params[i].param_type);
+      encode_type_to_blob(ctx->blob, fxn->params[i].type);
+   }
+
+   encode_type_to_blob(ctx->blob, fxn->return_type);
+
+   /* As in nir_shader_clone(), the implementations are written in a second
+    * pass, after all the functions that call instructions may refer to.
+    */
+}
+
+static void
+read_function(read_ctx *ctx)
+{
+   uint32_t idx = blob_read_uint32(ctx->blob);
+   char *name = read_string_or_null(ctx, NULL);
+   nir_function *fxn = nir_function_create(ctx->nir, name);
+   ralloc_free(name);
+
+   read_add_object(ctx, idx, read_obj_function, fxn);
+
+   fxn->num_params = read_count(ctx, 2 * sizeof(uint32_t));
+   fxn->params = ralloc_array(ctx->nir, nir_parameter, fxn->num_params);
+   for (unsigned i = 0; i < fxn->num_params; i++) {
+      fxn->params[i].param_type = blob_read_uint32(ctx->blob);
+      fxn->params[i].type = decode_type_from_blob(ctx->blob);
+   }
+
+   fxn->return_type = decode_type_from_blob(ctx->blob);
+}
+
+void
+nir_serialize(struct blob *blob, const nir_shader *nir)
+{
+   write_ctx ctx;
+   ctx.blob = blob;
+   ctx.remap_table = _mesa_hash_table_create(NULL, _mesa_hash_pointer,
+                                             _mesa_key_pointer_equal);
+   ctx.next_idx = 0;
+
+   /* The number of indices is only known at the end. */
+   size_t idx_size_offset = blob->size;
+   blob_write_uint32(blob, 0);
+
+   blob_write_uint32(blob, nir->stage);
+
+   struct nir_shader_info info = nir->info;
+   uint32_t strings = (info.name != NULL) | (info.label != NULL) << 1;
+   blob_write_uint32(blob, strings);
+   if (info.name)
+      blob_write_string(blob, info.name);
+   if (info.label)
+      blob_write_string(blob, info.label);
+   info.name = info.label = NULL;
+   blob_write_bytes(blob, &info, sizeof(info));
+
+   write_var_list(&ctx, &nir->uniforms);
+   write_var_list(&ctx, &nir->inputs);
+   write_var_list(&ctx, &nir->outputs);
+   write_var_list(&ctx, &nir->shared);
+   write_var_list(&ctx, &nir->globals);
+   write_var_list(&ctx, &nir->system_values);
+
+   /* Global registers go before the functions that use them. */
+   write_reg_list(&ctx, &nir->registers);
+   blob_write_uint32(blob, nir->reg_alloc);
+
+   blob_write_uint32(blob, nir->num_inputs);
+   blob_write_uint32(blob, nir->num_uniforms);
+   blob_write_uint32(blob, nir->num_outputs);
+   blob_write_uint32(blob, nir->num_shared);
+
+   blob_write_uint32(blob, exec_list_length(&nir->functions));
+   nir_foreach_function(fxn, nir)
+      write_function(&ctx, fxn);
+
+   nir_foreach_function(fxn, nir) {
+      blob_write_uint32(blob, fxn->impl != NULL);
+      if (fxn->impl)
+         write_function_impl(&ctx, fxn->impl);
+   }
+
+   blob_overwrite_uint32(blob, idx_size_offset, ctx.next_idx);
+
+   _mesa_hash_table_destroy(ctx.remap_table, NULL);
+}
+
+nir_shader *
+nir_deserialize(void *mem_ctx,
+                const struct nir_shader_compiler_options *options,
+                struct blob_reader *blob)
+{
+   read_ctx ctx;
+   ctx.blob = blob;
+   list_inithead(&ctx.phi_srcs);
+   /* Every index is written at least once. */
+   ctx.idx_table_len = read_count(&ctx, sizeof(uint32_t));
+   ctx.idx_table = calloc(MAX2(ctx.idx_table_len, 1), sizeof(read_obj));
+   if (blob->overrun || ctx.idx_table == NULL) {
+      free(ctx.idx_table);
+      return NULL;
+   }
+
+   gl_shader_stage stage = blob_read_uint32(blob);
+   if (stage >= MESA_SHADER_STAGES) {
+      blob->overrun = true;
+      free(ctx.idx_table);
+      return NULL;
+   }
+
+   ctx.nir = nir_shader_create(mem_ctx, stage, options);
+
+   uint32_t strings = blob_read_uint32(blob);
+   char *name = (strings & 1) ? blob_read_string(blob) : NULL;
+   char *label = (strings & 2) ? blob_read_string(blob) : NULL;
+   blob_copy_bytes(blob, (uint8_t *) &ctx.nir->info, sizeof(ctx.nir->info));
+   ctx.nir->info.name = name ? ralloc_strdup(ctx.nir, name) : NULL;
+   ctx.nir->info.label = label ? ralloc_strdup(ctx.nir, label) : NULL;
+
+   read_var_list(&ctx, &ctx.nir->uniforms);
+   read_var_list(&ctx, &ctx.nir->inputs);
+   read_var_list(&ctx, &ctx.nir->outputs);
+   read_var_list(&ctx, &ctx.nir->shared);
+   read_var_list(&ctx, &ctx.nir->globals);
+   read_var_list(&ctx, &ctx.nir->system_values);
+
+   read_reg_list(&ctx, &ctx.nir->registers);
+   ctx.nir->reg_alloc = blob_read_uint32(blob);
+
+   ctx.nir->num_inputs = blob_read_uint32(blob);
+   ctx.nir->num_uniforms = blob_read_uint32(blob);
+   ctx.nir->num_outputs = blob_read_uint32(blob);
+   ctx.nir->num_shared = blob_read_uint32(blob);
+
+   unsigned num_functions = blob_read_uint32(blob);
+   for (unsigned i = 0; i < num_functions && !blob->overrun; i++)
+      read_function(&ctx);
+
+   nir_foreach_function(fxn, ctx.nir) {
+      if (blob->overrun)
+         break;
+      if (blob_read_uint32(blob))
+         fxn->impl = read_function_impl(&ctx, fxn);
+   }
+
+   free(ctx.idx_table);
+
+   if (blob->overrun) {
+      ralloc_free(ctx.nir);
+      return NULL;
+   }
+
+   return ctx.nir;
+}
+
+nir_shader *
+nir_shader_serialize_deserialize(void *mem_ctx, nir_shader *s)
+{
+   const struct nir_shader_compiler_options *options = s->options;
+
+   struct blob *writer = blob_create(NULL);
+   nir_serialize(writer, s);
+   ralloc_free(s);
+
+   struct blob_reader reader;
+   blob_reader_init(&reader, writer->data, writer->size);
+   nir_shader *ns = nir_deserialize(mem_ctx, options, &reader);
+   assert(ns != NULL && reader.current == reader.end);
+
+   ralloc_free(writer);
+
+   return ns;
+}
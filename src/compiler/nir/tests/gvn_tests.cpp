@@ -0,0 +1,512 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include <gtest/gtest.h>
+#include <vector>
+#include "nir.h"
+#include "nir_builder.h"
+#include "nir_control_flow.h"
+
+class nir_gvn_test : public ::testing::Test {
+protected:
+   nir_gvn_test();
+   ~nir_gvn_test();
+
+   nir_ssa_def *load_input(const char *name);
+   void store_output(nir_ssa_def *value);
+   nir_ssa_def *load(nir_intrinsic_op op, int index, int offset);
+   nir_intrinsic_instr *store_ssbo(nir_ssa_def *value, int index, int offset);
+
+   nir_if *push_if(nir_ssa_def *condition);
+   void push_else(nir_if *if_stmt);
+   void pop_if(nir_if *if_stmt);
+   nir_loop *push_loop();
+   void pop_loop(nir_loop *loop);
+
+   unsigned count_alu(nir_op op);
+
+   nir_builder b;
+   nir_variable *out;
+};
+
+nir_gvn_test::nir_gvn_test()
+{
+   static const nir_shader_compiler_options options = { };
+   nir_builder_init_simple_shader(&b, NULL, MESA_SHADER_FRAGMENT, &options);
+
+   out = nir_variable_create(b.shader, nir_var_shader_out,
+                             glsl_float_type(), "out");
+}
+
+nir_gvn_test::~nir_gvn_test()
+{
+   ralloc_free(b.shader);
+}
+
+nir_ssa_def *
+nir_gvn_test::load_input(const char *name)
+{
+   nir_variable *var = nir_variable_create(b.shader, nir_var_shader_in,
+                                           glsl_float_type(), name);
+   return nir_load_var(&b, var);
+}
+
+void
+nir_gvn_test::store_output(nir_ssa_def *value)
+{
+   nir_store_var(&b, out, value, 0x1);
+}
+
+/** Builds a load_ubo or load_ssbo of one float */
+nir_ssa_def *
+nir_gvn_test::load(nir_intrinsic_op op, int index, int offset)
+{
+   nir_intrinsic_instr *load = nir_intrinsic_instr_create(b.shader, op);
+   load->num_components = 1;
+   load->src[0] = nir_src_for_ssa(nir_imm_int(&b, index));
+   load->src[1] = nir_src_for_ssa(nir_imm_int(&b, offset));
+   nir_ssa_dest_init(&load->instr, &load->dest, 1, 32, NULL);
+   nir_builder_instr_insert(&b, &load->instr);
+   return &load->dest.ssa;
+}
+
+nir_intrinsic_instr *
+nir_gvn_test::store_ssbo(nir_ssa_def *value, int index, int offset)
+{
+   nir_intrinsic_instr *store =
+      nir_intrinsic_instr_create(b.shader, nir_intrinsic_store_ssbo);
+   store->num_components = 1;
+   store->src[0] = nir_src_for_ssa(value);
+   store->src[1] = nir_src_for_ssa(nir_imm_int(&b, index));
+   store->src[2] = nir_src_for_ssa(nir_imm_int(&b, offset));
+   nir_intrinsic_set_write_mask(store, 0x1);
+   nir_builder_instr_insert(&b, &store->instr);
+   return store;
+}
+
+nir_if *
+nir_gvn_test::push_if(nir_ssa_def *condition)
+{
+   nir_if *if_stmt = nir_if_create(b.shader);
+   if_stmt->condition = nir_src_for_ssa(condition);
+   nir_cf_node_insert(b.cursor, &if_stmt->cf_node);
+   b.cursor = nir_after_cf_list(&if_stmt->then_list);
+   return if_stmt;
+}
+
+void
+nir_gvn_test::push_else(nir_if *if_stmt)
+{
+   b.cursor = nir_after_cf_list(&if_stmt->else_list);
+}
+
+void
+nir_gvn_test::pop_if(nir_if *if_stmt)
+{
+   b.cursor = nir_after_cf_node(&if_stmt->cf_node);
+}
+
+nir_loop *
+nir_gvn_test::push_loop()
+{
+   nir_loop *loop = nir_loop_create(b.shader);
+   nir_cf_node_insert(b.cursor, &loop->cf_node);
+   b.cursor = nir_after_cf_list(&loop->body);
+   return loop;
+}
+
+void
+nir_gvn_test::pop_loop(nir_loop *loop)
+{
+   b.cursor = nir_after_cf_node(&loop->cf_node);
+}
+
+unsigned
+nir_gvn_test::count_alu(nir_op op)
+{
+   unsigned count = 0;
+
+   nir_foreach_block(block, b.impl) {
+      nir_foreach_instr(instr, block) {
+         if (instr->type == nir_instr_type_alu &&
+             nir_instr_as_alu(instr)->op == op)
+            count++;
+      }
+   }
+
+   return count;
+}
+
+static nir_block *
+block_before(nir_cf_node *node)
+{
+   return nir_cf_node_as_block(nir_cf_node_prev(node));
+}
+
+static nir_ssa_def *
+stored_value(nir_intrinsic_instr *store)
+{
+   return store->src[0].ssa;
+}
+
+TEST_F(nir_gvn_test, cse_across_dominating_blocks)
+{
+   /* Create IR:
+    *
+    * a = x + y;
+    * if (x < y) {
+    *    out = x + y;
+    * } else {
+    *    out = x;
+    * }
+    * out = x + y;
+    *
+    * Both of the later additions are dominated by the first one.
+    */
+   nir_ssa_def *x = load_input("x");
+   nir_ssa_def *y = load_input("y");
+   nir_ssa_def *a = nir_fadd(&b, x, y);
+   store_output(a);
+
+   nir_if *if_stmt = push_if(nir_flt(&b, x, y));
+   store_output(nir_fadd(&b, x, y));
+   push_else(if_stmt);
+   store_output(x);
+   pop_if(if_stmt);
+
+   store_output(nir_fadd(&b, x, y));
+
+   EXPECT_TRUE(nir_opt_gvn(b.shader));
+   EXPECT_EQ(1u, count_alu(nir_op_fadd));
+   EXPECT_EQ(3u, list_length(&a->uses));
+}
+
+TEST_F(nir_gvn_test, no_cse_from_non_dominating_block)
+{
+   /* Create IR:
+    *
+    * if (x < y) {
+    *    out = x * y;
+    * }
+    * out = x * y;
+    *
+    * The multiplication in the if doesn't run on every path to the one after
+    * it, and there is no copy on the else side to hoist with it.
+    */
+   nir_ssa_def *x = load_input("x");
+   nir_ssa_def *y = load_input("y");
+
+   nir_if *if_stmt = push_if(nir_flt(&b, x, y));
+   store_output(nir_fmul(&b, x, y));
+   pop_if(if_stmt);
+
+   store_output(nir_fmul(&b, x, y));
+
+   EXPECT_FALSE(nir_opt_gvn(b.shader));
+   EXPECT_EQ(2u, count_alu(nir_op_fmul));
+}
+
+TEST_F(nir_gvn_test, hoist_common_instrs_out_of_if)
+{
+   /* Create IR:
+    *
+    * if (x < y) {
+    *    out = x * y;
+    * } else {
+    *    out = -(x * y);
+    * }
+    * out = x * y;
+    */
+   nir_ssa_def *x = load_input("x");
+   nir_ssa_def *y = load_input("y");
+
+   nir_if *if_stmt = push_if(nir_flt(&b, x, y));
+   store_output(nir_fmul(&b, x, y));
+   push_else(if_stmt);
+   store_output(nir_fneg(&b, nir_fmul(&b, x, y)));
+   pop_if(if_stmt);
+
+   store_output(nir_fmul(&b, x, y));
+
+   EXPECT_TRUE(nir_opt_gvn(b.shader));
+   EXPECT_EQ(1u, count_alu(nir_op_fmul));
+
+   nir_foreach_block(block, b.impl) {
+      nir_foreach_instr(instr, block) {
+         if (instr->type == nir_instr_type_alu &&
+             nir_instr_as_alu(instr)->op == nir_op_fmul) {
+            EXPECT_EQ(block_before(&if_stmt->cf_node), block);
+         }
+      }
+   }
+}
+
+static bool
+check_src_defined_before(nir_src *src, void *instr)
+{
+   EXPECT_LT(src->ssa->parent_instr->index, ((nir_instr *) instr)->index);
+   return true;
+}
+
+TEST_F(nir_gvn_test, duplicates_after_hoisting)
+{
+   /* Create IR:
+    *
+    * if (x < y) {
+    *    out = x * y;
+    * } else {
+    *    a = x * y;
+    *    b = a + z;
+    *    d = b * b;
+    *    c = a + z;
+    *    out = d + c;
+    * }
+    *
+    * with c before b in the uses of a.  Once a is hoisted, b and c only use
+    * values from before the if and are found in that order, but c may not
+    * replace b, which comes first.
+    */
+   nir_ssa_def *x = load_input("x");
+   nir_ssa_def *y = load_input("y");
+   nir_ssa_def *z = load_input("z");
+
+   nir_if *if_stmt = push_if(nir_flt(&b, x, y));
+   store_output(nir_fmul(&b, x, y));
+   push_else(if_stmt);
+   nir_ssa_def *a = nir_fmul(&b, x, y);
+   nir_ssa_def *c = nir_fadd(&b, a, z);
+   nir_cursor after_c = b.cursor;
+   b.cursor = nir_before_instr(c->parent_instr);
+   nir_ssa_def *bb = nir_fadd(&b, a, z);
+   nir_ssa_def *d = nir_fmul(&b, bb, bb);
+   b.cursor = after_c;
+   store_output(nir_fadd(&b, d, c));
+   pop_if(if_stmt);
+
+   ASSERT_EQ(c->parent_instr->block, bb->parent_instr->block);
+   ASSERT_EQ(c->parent_instr,
+             list_first_entry(&a->uses, nir_src, use_link)->parent_instr);
+
+   EXPECT_TRUE(nir_opt_gvn(b.shader));
+   EXPECT_EQ(2u, count_alu(nir_op_fmul));
+   EXPECT_EQ(2u, count_alu(nir_op_fadd));
+
+   nir_index_instrs(b.impl);
+   nir_foreach_block(block, b.impl) {
+      nir_foreach_instr(instr, block)
+         nir_foreach_src(instr, check_src_defined_before, instr);
+   }
+}
+
+TEST_F(nir_gvn_test, loop_invariants)
+{
+   /* Create IR:
+    *
+    * while (true) {
+    *    a = ubo[0][0];
+    *    s = x + y;
+    *    if (a < s) break;
+    *    b = ubo[0][4];
+    *    c = ssbo[0][0];
+    *    ssbo[0][4] = c + x;
+    *    out = a + b;
+    * }
+    *
+    * Only the first UBO load and the addition of x and y can be moved out of
+    * the loop.  The second UBO load may not run at all, the SSBO load can't
+    * be reordered with the store, and the store has a side effect.
+    */
+   nir_ssa_def *x = load_input("x");
+   nir_ssa_def *y = load_input("y");
+
+   nir_loop *loop = push_loop();
+   nir_ssa_def *ubo0, *sum, *ubo1, *ssbo, *ssbo_sum, *ubo_sum;
+   nir_intrinsic_instr *store;
+   {
+      ubo0 = load(nir_intrinsic_load_ubo, 0, 0);
+      sum = nir_fadd(&b, x, y);
+
+      nir_if *if_stmt = push_if(nir_flt(&b, ubo0, sum));
+      nir_jump(&b, nir_jump_break);
+      pop_if(if_stmt);
+
+      ubo1 = load(nir_intrinsic_load_ubo, 0, 4);
+      ssbo = load(nir_intrinsic_load_ssbo, 0, 0);
+      ssbo_sum = nir_fadd(&b, ssbo, x);
+      store = store_ssbo(ssbo_sum, 0, 4);
+      ubo_sum = nir_fadd(&b, ubo0, ubo1);
+      store_output(ubo_sum);
+   }
+   pop_loop(loop);
+
+   nir_block *preheader = block_before(&loop->cf_node);
+   nir_block *first_block =
+      nir_cf_node_as_block(nir_loop_first_cf_node(loop));
+   nir_block *later_block = ubo1->parent_instr->block;
+
+   EXPECT_TRUE(nir_opt_gvn(b.shader));
+
+   EXPECT_EQ(preheader, ubo0->parent_instr->block);
+   EXPECT_EQ(preheader, sum->parent_instr->block);
+
+   /* The constant sources of the UBO load move along with it */
+   nir_intrinsic_instr *ubo0_load = nir_instr_as_intrinsic(ubo0->parent_instr);
+   EXPECT_EQ(preheader, ubo0_load->src[0].ssa->parent_instr->block);
+   EXPECT_EQ(preheader, ubo0_load->src[1].ssa->parent_instr->block);
+
+   EXPECT_NE(first_block, later_block);
+   EXPECT_EQ(later_block, ubo1->parent_instr->block);
+   EXPECT_EQ(later_block, ssbo->parent_instr->block);
+   EXPECT_EQ(later_block, ssbo_sum->parent_instr->block);
+   EXPECT_EQ(later_block, store->instr.block);
+   EXPECT_EQ(later_block, ubo_sum->parent_instr->block);
+   EXPECT_EQ(ssbo_sum, stored_value(store));
+}
+
+TEST_F(nir_gvn_test, no_reordering_in_first_block)
+{
+   /* Create IR:
+    *
+    * while (true) {
+    *    a = ssbo[0][0];
+    *    ssbo[0][0] = a + x;
+    *    if (a < x) break;
+    * }
+    *
+    * Even in the first block of the loop, SSBO loads and stores stay where
+    * they are.
+    */
+   nir_ssa_def *x = load_input("x");
+
+   nir_loop *loop = push_loop();
+   nir_ssa_def *ssbo;
+   nir_intrinsic_instr *store;
+   {
+      ssbo = load(nir_intrinsic_load_ssbo, 0, 0);
+      store = store_ssbo(nir_fadd(&b, ssbo, x), 0, 0);
+
+      nir_if *if_stmt = push_if(nir_flt(&b, ssbo, x));
+      nir_jump(&b, nir_jump_break);
+      pop_if(if_stmt);
+   }
+   pop_loop(loop);
+
+   nir_block *first_block =
+      nir_cf_node_as_block(nir_loop_first_cf_node(loop));
+
+   nir_opt_gvn(b.shader);
+
+   EXPECT_EQ(first_block, ssbo->parent_instr->block);
+   EXPECT_EQ(first_block, store->instr.block);
+   EXPECT_EQ(first_block, stored_value(store)->parent_instr->block);
+}
+
+static bool
+add_ssa_def(nir_ssa_def *def, void *defs)
+{
+   ((std::vector<nir_ssa_def *> *) defs)->push_back(def);
+   return true;
+}
+
+TEST_F(nir_gvn_test, liveness_after_if_removal)
+{
+   /* Create IR:
+    *
+    * i = 0;
+    * while (true) {
+    *    if (i >= x) break;
+    *    w = (i < y) ? -y : y;
+    *    i = i + w + (x + y);
+    * }
+    * out = i + (x + y);
+    *
+    * nir_opt_peephole_select() collapses the if in the loop and patches up
+    * the dominance information, which nir_opt_gvn() then uses as it is to
+    * move x + y out of the loop and merge it with the one after the loop.
+    * The liveness computed afterwards must still agree with
+    * nir_live_ssa_defs_impl().
+    */
+   nir_variable *w = nir_local_variable_create(b.impl, glsl_float_type(), "w");
+   nir_variable *i = nir_local_variable_create(b.impl, glsl_float_type(), "i");
+   nir_ssa_def *x = load_input("x");
+   nir_ssa_def *y = load_input("y");
+   nir_store_var(&b, i, nir_imm_float(&b, 0.0f), 0x1);
+
+   nir_loop *loop = push_loop();
+   {
+      nir_ssa_def *i_val = nir_load_var(&b, i);
+      nir_if *break_if = push_if(nir_fge(&b, i_val, x));
+      nir_jump(&b, nir_jump_break);
+      pop_if(break_if);
+
+      nir_if *if_stmt = push_if(nir_flt(&b, i_val, y));
+      nir_store_var(&b, w, nir_fneg(&b, y), 0x1);
+      push_else(if_stmt);
+      nir_store_var(&b, w, nir_fmov(&b, y), 0x1);
+      pop_if(if_stmt);
+
+      nir_ssa_def *step = nir_fadd(&b, nir_load_var(&b, w), nir_fadd(&b, x, y));
+      nir_store_var(&b, i, nir_fadd(&b, i_val, step), 0x1);
+   }
+   pop_loop(loop);
+
+   store_output(nir_fadd(&b, nir_load_var(&b, i), nir_fadd(&b, x, y)));
+
+   nir_lower_vars_to_ssa(b.shader);
+   nir_copy_prop(b.shader);
+   nir_opt_dce(b.shader);
+
+   nir_metadata_require(b.impl, nir_metadata_dominance);
+   ASSERT_TRUE(nir_opt_peephole_select(b.shader));
+   ASSERT_TRUE(b.impl->valid_metadata & nir_metadata_dominance);
+
+   EXPECT_TRUE(nir_opt_gvn(b.shader));
+   EXPECT_EQ(4u, count_alu(nir_op_fadd));
+
+   std::vector<nir_ssa_def *> defs;
+   nir_foreach_block(block, b.impl) {
+      nir_foreach_instr(instr, block)
+         nir_foreach_ssa_def(instr, add_ssa_def, &defs);
+   }
+
+   nir_ssa_liveness *live = nir_ssa_liveness_create(NULL, b.impl);
+   std::vector<bool> interfere;
+   for (unsigned j = 0; j < defs.size(); j++) {
+      for (unsigned k = 0; k < defs.size(); k++)
+         interfere.push_back(nir_ssa_liveness_defs_interfere(live, defs[j],
+                                                             defs[k]));
+   }
+   ralloc_free(live);
+
+   nir_metadata_preserve(b.impl, nir_metadata_none);
+   nir_metadata_require(b.impl, (nir_metadata)
+                        (nir_metadata_block_index |
+                         nir_metadata_live_ssa_defs));
+
+   for (unsigned j = 0; j < defs.size(); j++) {
+      for (unsigned k = 0; k < defs.size(); k++) {
+         EXPECT_EQ(nir_ssa_defs_interfere(defs[j], defs[k]),
+                   interfere[j * defs.size() + k])
+            << "ssa_" << defs[j]->index << " and ssa_" << defs[k]->index;
+      }
+   }
+}
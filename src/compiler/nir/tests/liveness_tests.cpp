@@ -0,0 +1,487 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include "nir.h"
+#include "nir_builder.h"
+#include "nir_control_flow.h"
+
+/*
+ * Checks the on-demand liveness of nir_ssa_liveness against
+ * nir_live_ssa_defs_impl(), and the dominance left behind by
+ * nir_dominance_remove_if() against nir_calc_dominance_impl().  The shaders
+ * are built with local variables and lowered to SSA, so that they have the
+ * phis a front-end would produce.
+ */
+
+class nir_liveness_test : public ::testing::Test {
+protected:
+   nir_liveness_test();
+   ~nir_liveness_test();
+
+   nir_ssa_def *load_input(const char *name);
+   void store_output(nir_ssa_def *value);
+
+   nir_if *push_if(nir_ssa_def *condition);
+   void push_else(nir_if *if_stmt);
+   void pop_if(nir_if *if_stmt);
+   nir_loop *push_loop();
+   void pop_loop(nir_loop *loop);
+
+   unsigned check_interference();
+
+   nir_builder b;
+   nir_variable *out;
+};
+
+nir_liveness_test::nir_liveness_test()
+{
+   static const nir_shader_compiler_options options = { };
+   nir_builder_init_simple_shader(&b, NULL, MESA_SHADER_VERTEX, &options);
+
+   out = nir_variable_create(b.shader, nir_var_shader_out,
+                             glsl_float_type(), "out");
+}
+
+nir_liveness_test::~nir_liveness_test()
+{
+   ralloc_free(b.shader);
+}
+
+nir_ssa_def *
+nir_liveness_test::load_input(const char *name)
+{
+   nir_variable *var = nir_variable_create(b.shader, nir_var_shader_in,
+                                           glsl_float_type(), name);
+   return nir_load_var(&b, var);
+}
+
+void
+nir_liveness_test::store_output(nir_ssa_def *value)
+{
+   nir_store_var(&b, out, value, 0x1);
+}
+
+nir_if *
+nir_liveness_test::push_if(nir_ssa_def *condition)
+{
+   nir_if *if_stmt = nir_if_create(b.shader);
+   if_stmt->condition = nir_src_for_ssa(condition);
+   nir_cf_node_insert(b.cursor, &if_stmt->cf_node);
+   b.cursor = nir_after_cf_list(&if_stmt->then_list);
+   return if_stmt;
+}
+
+void
+nir_liveness_test::push_else(nir_if *if_stmt)
+{
+   b.cursor = nir_after_cf_list(&if_stmt->else_list);
+}
+
+void
+nir_liveness_test::pop_if(nir_if *if_stmt)
+{
+   b.cursor = nir_after_cf_node(&if_stmt->cf_node);
+}
+
+nir_loop *
+nir_liveness_test::push_loop()
+{
+   nir_loop *loop = nir_loop_create(b.shader);
+   nir_cf_node_insert(b.cursor, &loop->cf_node);
+   b.cursor = nir_after_cf_list(&loop->body);
+   return loop;
+}
+
+void
+nir_liveness_test::pop_loop(nir_loop *loop)
+{
+   b.cursor = nir_after_cf_node(&loop->cf_node);
+}
+
+static bool
+add_ssa_def(nir_ssa_def *def, void *defs)
+{
+   ((std::vector<nir_ssa_def *> *) defs)->push_back(def);
+   return true;
+}
+
+/**
+ * Lowers the shader to SSA, then compares nir_ssa_liveness_defs_interfere()
+ * with nir_ssa_defs_interfere() for every pair of SSA values and returns the
+ * number of pairs which interfere.
+ */
+unsigned
+nir_liveness_test::check_interference()
+{
+   nir_lower_vars_to_ssa(b.shader);
+
+   std::vector<nir_ssa_def *> defs;
+   nir_foreach_block(block, b.impl) {
+      nir_foreach_instr(instr, block)
+         nir_foreach_ssa_def(instr, add_ssa_def, &defs);
+   }
+
+   nir_metadata_preserve(b.impl, nir_metadata_none);
+   nir_metadata_require(b.impl, (nir_metadata)
+                        (nir_metadata_block_index |
+                         nir_metadata_live_ssa_defs));
+
+   std::vector<bool> expected;
+   for (unsigned i = 0; i < defs.size(); i++) {
+      for (unsigned j = 0; j < defs.size(); j++)
+         expected.push_back(nir_ssa_defs_interfere(defs[i], defs[j]));
+   }
+
+   nir_ssa_liveness *live = nir_ssa_liveness_create(NULL, b.impl);
+
+   unsigned interfering = 0;
+   for (unsigned i = 0; i < defs.size(); i++) {
+      for (unsigned j = 0; j < defs.size(); j++) {
+         const bool interfere =
+            nir_ssa_liveness_defs_interfere(live, defs[i], defs[j]);
+
+         EXPECT_EQ(expected[i * defs.size() + j], interfere)
+            << "ssa_" << defs[i]->index << " and ssa_" << defs[j]->index;
+         interfering += interfere;
+      }
+   }
+
+   ralloc_free(live);
+   return interfering;
+}
+
+TEST_F(nir_liveness_test, if_else_phi)
+{
+   /* Create IR:
+    *
+    * v = (x < y) ? -x : y * 2;
+    * out = v + x;
+    */
+   nir_variable *v = nir_local_variable_create(b.impl, glsl_float_type(), "v");
+   nir_ssa_def *x = load_input("x");
+   nir_ssa_def *y = load_input("y");
+
+   nir_if *if_stmt = push_if(nir_flt(&b, x, y));
+   nir_store_var(&b, v, nir_fneg(&b, x), 0x1);
+   push_else(if_stmt);
+   nir_store_var(&b, v, nir_fmul(&b, y, nir_imm_float(&b, 2.0f)), 0x1);
+   pop_if(if_stmt);
+
+   store_output(nir_fadd(&b, nir_load_var(&b, v), x));
+
+   EXPECT_GT(check_interference(), 0u);
+}
+
+TEST_F(nir_liveness_test, loop)
+{
+   /* Create IR:
+    *
+    * v = x; i = 0;
+    * while (true) {
+    *    if (i >= y) break;
+    *    v = v * x + y;
+    *    i = i + 1;
+    * }
+    * out = v;
+    */
+   nir_variable *v = nir_local_variable_create(b.impl, glsl_float_type(), "v");
+   nir_variable *i = nir_local_variable_create(b.impl, glsl_float_type(), "i");
+   nir_ssa_def *x = load_input("x");
+   nir_ssa_def *y = load_input("y");
+   nir_store_var(&b, v, x, 0x1);
+   nir_store_var(&b, i, nir_imm_float(&b, 0.0f), 0x1);
+
+   nir_loop *loop = push_loop();
+   {
+      nir_if *if_stmt = push_if(nir_fge(&b, nir_load_var(&b, i), y));
+      nir_jump(&b, nir_jump_break);
+      pop_if(if_stmt);
+
+      nir_store_var(&b, v, nir_fadd(&b, nir_fmul(&b, nir_load_var(&b, v), x),
+                                    y), 0x1);
+      nir_store_var(&b, i, nir_fadd(&b, nir_load_var(&b, i),
+                                    nir_imm_float(&b, 1.0f)), 0x1);
+   }
+   pop_loop(loop);
+
+   store_output(nir_load_var(&b, v));
+
+   EXPECT_GT(check_interference(), 0u);
+}
+
+TEST_F(nir_liveness_test, nested_loops_with_continue)
+{
+   /* Create IR:
+    *
+    * v = x;
+    * while (true) {
+    *    if (v >= y) break;
+    *    w = v;
+    *    while (true) {
+    *       w = w + x;
+    *       if (w < z) continue;
+    *       break;
+    *    }
+    *    if (w > x) {
+    *       v = w;
+    *       continue;
+    *    }
+    *    v = v + z;
+    * }
+    * out = v + y;
+    */
+   nir_variable *v = nir_local_variable_create(b.impl, glsl_float_type(), "v");
+   nir_variable *w = nir_local_variable_create(b.impl, glsl_float_type(), "w");
+   nir_ssa_def *x = load_input("x");
+   nir_ssa_def *y = load_input("y");
+   nir_ssa_def *z = load_input("z");
+   nir_store_var(&b, v, x, 0x1);
+
+   nir_loop *outer = push_loop();
+   {
+      nir_if *break_if = push_if(nir_fge(&b, nir_load_var(&b, v), y));
+      nir_jump(&b, nir_jump_break);
+      pop_if(break_if);
+
+      nir_store_var(&b, w, nir_load_var(&b, v), 0x1);
+
+      nir_loop *inner = push_loop();
+      {
+         nir_store_var(&b, w, nir_fadd(&b, nir_load_var(&b, w), x), 0x1);
+         nir_if *continue_if = push_if(nir_flt(&b, nir_load_var(&b, w), z));
+         nir_jump(&b, nir_jump_continue);
+         pop_if(continue_if);
+         nir_jump(&b, nir_jump_break);
+      }
+      pop_loop(inner);
+
+      nir_if *if_stmt = push_if(nir_flt(&b, x, nir_load_var(&b, w)));
+      nir_store_var(&b, v, nir_load_var(&b, w), 0x1);
+      nir_jump(&b, nir_jump_continue);
+      pop_if(if_stmt);
+
+      nir_store_var(&b, v, nir_fadd(&b, nir_load_var(&b, v), z), 0x1);
+   }
+   pop_loop(outer);
+
+   store_output(nir_fadd(&b, nir_load_var(&b, v), y));
+
+   EXPECT_GT(check_interference(), 0u);
+}
+
+TEST_F(nir_liveness_test, if_condition_from_outside_loop)
+{
+   /* Create IR:
+    *
+    * c = x < y; v = x;
+    * while (true) {
+    *    if (v >= y) break;
+    *    v = c ? v + x : v * x;
+    * }
+    * out = v;
+    *
+    * where c is only used as the condition of an if in a later block.
+    */
+   nir_variable *v = nir_local_variable_create(b.impl, glsl_float_type(), "v");
+   nir_ssa_def *x = load_input("x");
+   nir_ssa_def *y = load_input("y");
+   nir_ssa_def *c = nir_flt(&b, x, y);
+   nir_store_var(&b, v, x, 0x1);
+
+   nir_loop *loop = push_loop();
+   {
+      nir_if *break_if = push_if(nir_fge(&b, nir_load_var(&b, v), y));
+      nir_jump(&b, nir_jump_break);
+      pop_if(break_if);
+
+      nir_if *if_stmt = push_if(c);
+      nir_store_var(&b, v, nir_fadd(&b, nir_load_var(&b, v), x), 0x1);
+      push_else(if_stmt);
+      nir_store_var(&b, v, nir_fmul(&b, nir_load_var(&b, v), x), 0x1);
+      pop_if(if_stmt);
+   }
+   pop_loop(loop);
+
+   store_output(nir_load_var(&b, v));
+
+   EXPECT_GT(check_interference(), 0u);
+}
+
+TEST_F(nir_liveness_test, undef)
+{
+   /* Create IR:
+    *
+    * if (x < y) v = x;
+    * out = v;
+    *
+    * where v is undefined on the else side.
+    */
+   nir_variable *v = nir_local_variable_create(b.impl, glsl_float_type(), "v");
+   nir_ssa_def *x = load_input("x");
+   nir_ssa_def *y = load_input("y");
+
+   nir_if *if_stmt = push_if(nir_flt(&b, x, y));
+   nir_store_var(&b, v, x, 0x1);
+   pop_if(if_stmt);
+
+   store_output(nir_load_var(&b, v));
+
+   EXPECT_GT(check_interference(), 0u);
+}
+
+struct block_dominance {
+   nir_block *imm_dom;
+   std::vector<nir_block *> dom_children;
+   std::vector<nir_block *> dom_frontier;
+};
+
+static std::map<nir_block *, block_dominance>
+get_dominance(nir_function_impl *impl)
+{
+   std::map<nir_block *, block_dominance> dominance;
+
+   nir_foreach_block(block, impl) {
+      block_dominance &dom = dominance[block];
+
+      dom.imm_dom = block->imm_dom;
+      dom.dom_children.assign(block->dom_children,
+                              block->dom_children + block->num_dom_children);
+      std::sort(dom.dom_children.begin(), dom.dom_children.end());
+
+      struct set_entry *entry;
+      set_foreach(block->dom_frontier, entry)
+         dom.dom_frontier.push_back((nir_block *) entry->key);
+      std::sort(dom.dom_frontier.begin(), dom.dom_frontier.end());
+   }
+
+   return dominance;
+}
+
+TEST_F(nir_liveness_test, peephole_select_preserves_dominance)
+{
+   /* Create IR with three ifs which nir_opt_peephole_select() turns into
+    * selects, one of them inside a loop:
+    *
+    * v = (x < y) ? -x : y;
+    * i = 0;
+    * while (true) {
+    *    if (i >= v) break;
+    *    w = (i < x) ? -i : x;
+    *    i = i + w;
+    * }
+    * u = (i < y) ? i : -y;
+    * out = u + v;
+    */
+   nir_variable *v = nir_local_variable_create(b.impl, glsl_float_type(), "v");
+   nir_variable *w = nir_local_variable_create(b.impl, glsl_float_type(), "w");
+   nir_variable *u = nir_local_variable_create(b.impl, glsl_float_type(), "u");
+   nir_variable *i = nir_local_variable_create(b.impl, glsl_float_type(), "i");
+   nir_ssa_def *x = load_input("x");
+   nir_ssa_def *y = load_input("y");
+
+   nir_if *if_stmt = push_if(nir_flt(&b, x, y));
+   nir_store_var(&b, v, nir_fneg(&b, x), 0x1);
+   push_else(if_stmt);
+   nir_store_var(&b, v, nir_fmov(&b, y), 0x1);
+   pop_if(if_stmt);
+
+   nir_store_var(&b, i, nir_imm_float(&b, 0.0f), 0x1);
+
+   nir_loop *loop = push_loop();
+   {
+      nir_if *break_if = push_if(nir_fge(&b, nir_load_var(&b, i),
+                                         nir_load_var(&b, v)));
+      nir_jump(&b, nir_jump_break);
+      pop_if(break_if);
+
+      nir_ssa_def *i_val = nir_load_var(&b, i);
+      if_stmt = push_if(nir_flt(&b, i_val, x));
+      nir_store_var(&b, w, nir_fneg(&b, i_val), 0x1);
+      push_else(if_stmt);
+      nir_store_var(&b, w, nir_fmov(&b, x), 0x1);
+      pop_if(if_stmt);
+
+      nir_store_var(&b, i, nir_fadd(&b, i_val, nir_load_var(&b, w)), 0x1);
+   }
+   pop_loop(loop);
+
+   nir_ssa_def *i_val = nir_load_var(&b, i);
+   if_stmt = push_if(nir_flt(&b, i_val, y));
+   nir_store_var(&b, u, nir_fmov(&b, i_val), 0x1);
+   push_else(if_stmt);
+   nir_store_var(&b, u, nir_fneg(&b, y), 0x1);
+   pop_if(if_stmt);
+
+   store_output(nir_fadd(&b, nir_load_var(&b, u), nir_load_var(&b, v)));
+
+   /* Get rid of the moves nir_lower_vars_to_ssa() leaves between the
+    * values and the phis.
+    */
+   nir_lower_vars_to_ssa(b.shader);
+   nir_copy_prop(b.shader);
+   nir_opt_dce(b.shader);
+
+   nir_metadata_require(b.impl, (nir_metadata)
+                        (nir_metadata_block_index | nir_metadata_dominance));
+   const unsigned num_blocks = b.impl->num_blocks;
+
+   ASSERT_TRUE(nir_opt_peephole_select(b.shader));
+   ASSERT_TRUE(b.impl->valid_metadata & nir_metadata_dominance);
+
+   /* Each collapsed if takes its then, else and after blocks with it */
+   nir_index_blocks(b.impl);
+   EXPECT_EQ(num_blocks - 9, b.impl->num_blocks);
+
+   std::map<nir_block *, block_dominance> repaired = get_dominance(b.impl);
+
+   std::vector<bool> dominates;
+   nir_foreach_block(parent, b.impl) {
+      nir_foreach_block(child, b.impl)
+         dominates.push_back(nir_block_dominates(parent, child));
+   }
+
+   nir_metadata_preserve(b.impl, nir_metadata_block_index);
+   nir_metadata_require(b.impl, nir_metadata_dominance);
+
+   std::map<nir_block *, block_dominance> recomputed = get_dominance(b.impl);
+
+   nir_foreach_block(block, b.impl) {
+      const block_dominance &r = repaired[block];
+      const block_dominance &c = recomputed[block];
+
+      EXPECT_EQ(c.imm_dom, r.imm_dom) << "block_" << block->index;
+      EXPECT_EQ(c.dom_children, r.dom_children) << "block_" << block->index;
+      EXPECT_EQ(c.dom_frontier, r.dom_frontier) << "block_" << block->index;
+   }
+
+   unsigned k = 0;
+   nir_foreach_block(parent, b.impl) {
+      nir_foreach_block(child, b.impl) {
+         EXPECT_EQ(nir_block_dominates(parent, child), dominates[k++])
+            << "block_" << parent->index << " and block_" << child->index;
+      }
+   }
+}
@@ -0,0 +1,395 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include "nir.h"
+#include "nir_builder.h"
+#include "nir_serialize.h"
+
+class nir_serialize_test : public ::testing::Test {
+protected:
+   nir_serialize_test();
+   ~nir_serialize_test();
+
+   std::string print(nir_shader *shader);
+   void check_round_trip();
+
+   nir_builder b;
+};
+
+nir_serialize_test::nir_serialize_test()
+{
+   static const nir_shader_compiler_options options = { };
+   nir_builder_init_simple_shader(&b, NULL, MESA_SHADER_FRAGMENT, &options);
+}
+
+nir_serialize_test::~nir_serialize_test()
+{
+   ralloc_free(b.shader);
+}
+
+std::string
+nir_serialize_test::print(nir_shader *shader)
+{
+   char *buf;
+   size_t size;
+   FILE *f = open_memstream(&buf, &size);
+
+   nir_print_shader(shader, f);
+   fclose(f);
+
+   const std::string s(buf, size);
+   free(buf);
+   return s;
+}
+
+/**
+ * Writes the shader, reads it back and checks that the copy prints the same
+ * and that all of the data was used.
+ */
+void
+nir_serialize_test::check_round_trip()
+{
+   nir_validate_shader(b.shader);
+
+   struct blob *blob = blob_create(NULL);
+   nir_serialize(blob, b.shader);
+
+   struct blob_reader reader;
+   blob_reader_init(&reader, blob->data, blob->size);
+   nir_shader *copy = nir_deserialize(NULL, b.shader->options, &reader);
+
+   ASSERT_TRUE(copy != NULL);
+   EXPECT_FALSE(reader.overrun);
+   EXPECT_EQ(reader.end, reader.current);
+
+   nir_validate_shader(copy);
+   EXPECT_EQ(print(b.shader), print(copy));
+
+   /* Serializing the copy gives the same data again. */
+   struct blob *blob2 = blob_create(NULL);
+   nir_serialize(blob2, copy);
+   ASSERT_EQ(blob->size, blob2->size);
+   EXPECT_EQ(0, memcmp(blob->data, blob2->data, blob->size));
+
+   ralloc_free(copy);
+   ralloc_free(blob);
+   ralloc_free(blob2);
+}
+
+TEST_F(nir_serialize_test, alu_and_variables)
+{
+   nir_variable *in = nir_variable_create(b.shader, nir_var_shader_in,
+                                          glsl_vec4_type(), "in");
+   in->data.location = VARYING_SLOT_VAR0;
+   nir_variable *out = nir_variable_create(b.shader, nir_var_shader_out,
+                                           glsl_vec4_type(), "out");
+   out->data.location = FRAG_RESULT_DATA0;
+
+   nir_ssa_def *v = nir_load_var(&b, in);
+   nir_ssa_def *c = nir_imm_vec4(&b, 1.0, 2.0, 3.0, 4.0);
+   static const unsigned wzyx[4] = { 3, 2, 1, 0 };
+   nir_ssa_def *sum = nir_fadd(&b, v, nir_swizzle(&b, c, wzyx, 4, false));
+
+   nir_alu_instr *mul = nir_alu_instr_create(b.shader, nir_op_fmul);
+   mul->src[0].src = nir_src_for_ssa(sum);
+   mul->src[0].negate = true;
+   mul->src[1].src = nir_src_for_ssa(v);
+   mul->src[1].abs = true;
+   for (unsigned i = 0; i < 4; i++) {
+      mul->src[0].swizzle[i] = i;
+      mul->src[1].swizzle[i] = 3 - i;
+   }
+   mul->dest.saturate = true;
+   mul->dest.write_mask = 0xf;
+   mul->exact = true;
+   nir_ssa_dest_init(&mul->instr, &mul->dest.dest, 4, 32, "product");
+   nir_builder_instr_insert(&b, &mul->instr);
+
+   nir_store_var(&b, out, &mul->dest.dest.ssa, 0x7);
+
+   check_round_trip();
+}
+
+TEST_F(nir_serialize_test, derefs_and_constants)
+{
+   const glsl_type *vec4 = glsl_vec4_type();
+   glsl_struct_field fields[2];
+   fields[0] = glsl_struct_field(glsl_array_type(vec4, 4), "colors");
+   fields[1] = glsl_struct_field(glsl_float_type(), "scale");
+   const glsl_type *s = glsl_struct_type(fields, 2, "S");
+
+   nir_variable *uni = nir_variable_create(b.shader, nir_var_uniform, s, "u");
+   nir_variable *table =
+      nir_local_variable_create(b.impl, glsl_array_type(vec4, 2), "table");
+
+   nir_constant *init = rzalloc(table, nir_constant);
+   init->num_elements = 2;
+   init->elements = ralloc_array(table, nir_constant *, 2);
+   for (unsigned i = 0; i < 2; i++) {
+      init->elements[i] = rzalloc(table, nir_constant);
+      init->elements[i]->value.f[0] = i;
+   }
+   table->constant_initializer = init;
+
+   nir_variable *out = nir_variable_create(b.shader, nir_var_shader_out,
+                                           vec4, "out");
+
+   nir_ssa_def *idx = nir_imm_int(&b, 1);
+
+   /* u.colors[idx] */
+   nir_intrinsic_instr *load =
+      nir_intrinsic_instr_create(b.shader, nir_intrinsic_load_var);
+   load->num_components = 4;
+   load->variables[0] = nir_deref_var_create(load, uni);
+   nir_deref_struct *field = nir_deref_struct_create(load->variables[0], 0);
+   field->deref.type = glsl_array_type(vec4, 4);
+   load->variables[0]->deref.child = &field->deref;
+   nir_deref_array *elem = nir_deref_array_create(field);
+   elem->deref.type = vec4;
+   elem->deref_array_type = nir_deref_array_type_indirect;
+   elem->indirect = nir_src_for_ssa(idx);
+   field->deref.child = &elem->deref;
+   nir_ssa_dest_init(&load->instr, &load->dest, 4, 32, NULL);
+   nir_builder_instr_insert(&b, &load->instr);
+
+   /* table[1] */
+   nir_intrinsic_instr *load2 =
+      nir_intrinsic_instr_create(b.shader, nir_intrinsic_load_var);
+   load2->num_components = 4;
+   load2->variables[0] = nir_deref_var_create(load2, table);
+   nir_deref_array *direct = nir_deref_array_create(load2->variables[0]);
+   direct->deref.type = vec4;
+   direct->base_offset = 1;
+   load2->variables[0]->deref.child = &direct->deref;
+   nir_ssa_dest_init(&load2->instr, &load2->dest, 4, 32, NULL);
+   nir_builder_instr_insert(&b, &load2->instr);
+
+   nir_store_var(&b, out, nir_fadd(&b, &load->dest.ssa, &load2->dest.ssa),
+                 0xf);
+
+   check_round_trip();
+}
+
+TEST_F(nir_serialize_test, control_flow_and_phis)
+{
+   nir_variable *in = nir_variable_create(b.shader, nir_var_shader_in,
+                                          glsl_int_type(), "in");
+   nir_variable *out = nir_variable_create(b.shader, nir_var_shader_out,
+                                           glsl_int_type(), "out");
+   nir_variable *i = nir_local_variable_create(b.impl, glsl_int_type(), "i");
+
+   nir_store_var(&b, i, nir_imm_int(&b, 0), 0x1);
+
+   /* Create IR:
+    *
+    * while (true) {
+    *    if (i >= in) break;
+    *    i = i + 1;
+    * }
+    * out = i;
+    */
+   nir_loop *loop = nir_loop_create(b.shader);
+   nir_builder_cf_insert(&b, &loop->cf_node);
+   b.cursor = nir_after_cf_list(&loop->body);
+
+   nir_if *nif = nir_if_create(b.shader);
+   nif->condition = nir_src_for_ssa(nir_ige(&b, nir_load_var(&b, i),
+                                             nir_load_var(&b, in)));
+   nir_builder_cf_insert(&b, &nif->cf_node);
+
+   b.cursor = nir_after_cf_list(&nif->then_list);
+   nir_jump(&b, nir_jump_break);
+
+   b.cursor = nir_after_cf_node(&nif->cf_node);
+   nir_store_var(&b, i, nir_iadd(&b, nir_load_var(&b, i), nir_imm_int(&b, 1)),
+                 0x1);
+
+   b.cursor = nir_after_cf_node(&loop->cf_node);
+   nir_store_var(&b, out, nir_load_var(&b, i), 0x1);
+
+   /* Turn the local variable into phis, one of which uses a value defined
+    * later in the loop.
+    */
+   nir_lower_vars_to_ssa(b.shader);
+
+   check_round_trip();
+
+   /* And again with the phis turned into registers. */
+   nir_convert_from_ssa(b.shader, false);
+
+   check_round_trip();
+}
+
+TEST_F(nir_serialize_test, texture)
+{
+   nir_variable *sampler =
+      nir_variable_create(b.shader, nir_var_uniform,
+                          glsl_sampler_type(GLSL_SAMPLER_DIM_2D, true, true,
+                                            GLSL_TYPE_FLOAT), "tex");
+   nir_variable *out = nir_variable_create(b.shader, nir_var_shader_out,
+                                           glsl_vec4_type(), "out");
+
+   nir_tex_instr *tex = nir_tex_instr_create(b.shader, 2);
+   tex->op = nir_texop_txl;
+   tex->sampler_dim = GLSL_SAMPLER_DIM_2D;
+   tex->dest_type = nir_type_float;
+   tex->is_array = true;
+   tex->is_shadow = true;
+   tex->coord_components = 3;
+   tex->src[0].src_type = nir_tex_src_coord;
+   tex->src[0].src = nir_src_for_ssa(nir_imm_vec4(&b, 0.5, 0.5, 1.0, 0.0));
+   tex->src[1].src_type = nir_tex_src_lod;
+   tex->src[1].src = nir_src_for_ssa(nir_imm_float(&b, 2.0));
+   tex->texture = nir_deref_var_create(tex, sampler);
+   tex->sampler = nir_deref_var_create(tex, sampler);
+   nir_ssa_dest_init(&tex->instr, &tex->dest, 4, 32, NULL);
+   nir_builder_instr_insert(&b, &tex->instr);
+
+   nir_store_var(&b, out, &tex->dest.ssa, 0xf);
+
+   check_round_trip();
+}
+
+TEST_F(nir_serialize_test, truncated)
+{
+   nir_variable *out = nir_variable_create(b.shader, nir_var_shader_out,
+                                           glsl_vec4_type(), "out");
+   nir_store_var(&b, out, nir_imm_vec4(&b, 1.0, 2.0, 3.0, 4.0), 0xf);
+
+   struct blob *blob = blob_create(NULL);
+   nir_serialize(blob, b.shader);
+
+   for (size_t size = 0; size < blob->size; size += 4) {
+      struct blob_reader reader;
+      blob_reader_init(&reader, blob->data, size);
+      EXPECT_EQ(NULL, nir_deserialize(NULL, b.shader->options, &reader))
+         << size;
+   }
+
+   ralloc_free(blob);
+}
+
+TEST_F(nir_serialize_test, corrupted)
+{
+   nir_variable *in = nir_variable_create(b.shader, nir_var_shader_in,
+                                          glsl_int_type(), "in");
+   nir_variable *out = nir_variable_create(b.shader, nir_var_shader_out,
+                                           glsl_vec4_type(), "out");
+   nir_variable *i = nir_local_variable_create(b.impl, glsl_int_type(), "i");
+   nir_variable *table =
+      nir_local_variable_create(b.impl, glsl_array_type(glsl_int_type(), 2),
+                                "table");
+
+   nir_constant *init = rzalloc(table, nir_constant);
+   init->num_elements = 2;
+   init->elements = ralloc_array(table, nir_constant *, 2);
+   for (unsigned j = 0; j < 2; j++) {
+      init->elements[j] = rzalloc(table, nir_constant);
+      init->elements[j]->value.i[0] = j;
+   }
+   table->constant_initializer = init;
+
+   nir_store_var(&b, i, nir_imm_int(&b, 0), 0x1);
+
+   /* Create IR:
+    *
+    * while (true) {
+    *    if (i >= in) break;
+    *    i = i + table[i & 1];
+    * }
+    * out = vec4(i);
+    */
+   nir_loop *loop = nir_loop_create(b.shader);
+   nir_builder_cf_insert(&b, &loop->cf_node);
+   b.cursor = nir_after_cf_list(&loop->body);
+
+   nir_if *nif = nir_if_create(b.shader);
+   nif->condition = nir_src_for_ssa(nir_ige(&b, nir_load_var(&b, i),
+                                             nir_load_var(&b, in)));
+   nir_builder_cf_insert(&b, &nif->cf_node);
+
+   b.cursor = nir_after_cf_list(&nif->then_list);
+   nir_jump(&b, nir_jump_break);
+
+   b.cursor = nir_after_cf_node(&nif->cf_node);
+   nir_intrinsic_instr *load =
+      nir_intrinsic_instr_create(b.shader, nir_intrinsic_load_var);
+   load->num_components = 1;
+   load->variables[0] = nir_deref_var_create(load, table);
+   nir_deref_array *elem = nir_deref_array_create(load->variables[0]);
+   elem->deref.type = glsl_int_type();
+   elem->deref_array_type = nir_deref_array_type_indirect;
+   elem->indirect = nir_src_for_ssa(nir_iand(&b, nir_load_var(&b, i),
+                                             nir_imm_int(&b, 1)));
+   load->variables[0]->deref.child = &elem->deref;
+   nir_ssa_dest_init(&load->instr, &load->dest, 1, 32, NULL);
+   nir_builder_instr_insert(&b, &load->instr);
+   nir_store_var(&b, i, nir_iadd(&b, nir_load_var(&b, i), &load->dest.ssa),
+                 0x1);
+
+   b.cursor = nir_after_cf_node(&loop->cf_node);
+   nir_ssa_def *v = nir_i2f(&b, nir_load_var(&b, i));
+   nir_ssa_def *comps[4] = { v, v, v, v };
+   nir_store_var(&b, out, nir_vec(&b, comps, 4), 0xf);
+
+   nir_lower_vars_to_ssa(b.shader);
+
+   /* Registers as well as SSA values */
+   nir_shader *regs = nir_shader_clone(NULL, b.shader);
+   nir_convert_from_ssa(regs, false);
+
+   nir_shader *shaders[2] = { b.shader, regs };
+   for (unsigned s = 0; s < 2; s++) {
+      struct blob *blob = blob_create(NULL);
+      nir_serialize(blob, shaders[s]);
+
+      /* Replace each word in turn with values which are likely to be valid
+       * indices, counts and enums.  Reading must either fail or give a
+       * shader, without crashing.
+       */
+      uint32_t *words = (uint32_t *) blob->data;
+      for (size_t w = 0; w < blob->size / 4; w++) {
+         const uint32_t orig = words[w];
+
+         for (uint32_t value = 0; value < 48; value++) {
+            words[w] = value;
+
+            struct blob_reader reader;
+            blob_reader_init(&reader, blob->data, blob->size);
+            nir_shader *copy = nir_deserialize(NULL, b.shader->options,
+                                               &reader);
+            EXPECT_EQ(copy == NULL, reader.overrun);
+            ralloc_free(copy);
+         }
+
+         words[w] = orig;
+      }
+
+      ralloc_free(blob);
+   }
+
+   ralloc_free(regs);
+}
@@ -0,0 +1,547 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/*
+ * A standalone executable that converts SPIR-V modules to NIR, optionally
+ * runs the usual lowering and optimization passes on the result, and
+ * reports how long each step took and how many heap allocations it made.
+ * This makes it possible to test and profile spirv_to_nir without a Vulkan
+ * driver.
+ *
+ * Each argument is either a SPIR-V module or a directory, in which case all
+ * of the .spv files in it are converted.
+ */
+
+#include "spirv/nir_spirv.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "spirv/spirv.h"
+
+/* Counting allocations works by interposing the C library's allocator.  Only
+ * glibc exports the underlying functions, and the sanitizers replace the
+ * allocator themselves.
+ */
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+#define HAVE_ALLOC_COUNT 1
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static uint64_t alloc_count;
+
+void *
+malloc(size_t size)
+{
+   alloc_count++;
+   return __libc_malloc(size);
+}
+
+void *
+calloc(size_t nmemb, size_t size)
+{
+   alloc_count++;
+   return __libc_calloc(nmemb, size);
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+   alloc_count++;
+   return __libc_realloc(ptr, size);
+}
+#else
+static const uint64_t alloc_count = 0;
+#endif
+
+enum step {
+   STEP_SPIRV_TO_NIR,
+   STEP_LOWER,
+   STEP_OPTIMIZE,
+   NUM_STEPS,
+};
+
+static const char *step_names[NUM_STEPS] = {
+   [STEP_SPIRV_TO_NIR] = "spirv_to_nir",
+   [STEP_LOWER]        = "lower",
+   [STEP_OPTIMIZE]     = "optimize",
+};
+
+struct step_stats {
+   uint64_t ns;
+   uint64_t allocs;
+};
+
+struct stats {
+   unsigned modules;
+   uint64_t bytes;
+   unsigned instrs;
+   struct step_stats steps[NUM_STEPS];
+};
+
+static gl_shader_stage stage = MESA_SHADER_FRAGMENT;
+static const char *entry_point_name = "main";
+static bool optimize;
+static bool print;
+static bool quiet;
+static unsigned runs = 1;
+
+static const nir_shader_compiler_options nir_options = {
+   .native_integers = true,
+};
+
+static uint64_t
+get_time_ns(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+struct step_timer {
+   uint64_t start_ns;
+   uint64_t start_allocs;
+};
+
+static void
+step_begin(struct step_timer *timer)
+{
+   timer->start_allocs = alloc_count;
+   timer->start_ns = get_time_ns();
+}
+
+static void
+step_end(struct step_stats *step, const struct step_timer *timer)
+{
+   step->ns += get_time_ns() - timer->start_ns;
+   step->allocs += alloc_count - timer->start_allocs;
+}
+
+static void
+lower(nir_shader *nir, nir_function *entry_point)
+{
+   /* This mirrors what the Vulkan driver does right after spirv_to_nir. */
+   if (nir->stage == MESA_SHADER_FRAGMENT)
+      NIR_PASS_V(nir, nir_lower_wpos_center);
+
+   NIR_PASS_V(nir, nir_lower_returns);
+   NIR_PASS_V(nir, nir_inline_functions);
+
+   /* Pick off the single entrypoint that we want */
+   foreach_list_typed_safe(nir_function, func, node, &nir->functions) {
+      if (func != entry_point)
+         exec_node_remove(&func->node);
+   }
+   assert(exec_list_length(&nir->functions) == 1);
+
+   NIR_PASS_V(nir, nir_remove_dead_variables, nir_var_shader_in);
+   NIR_PASS_V(nir, nir_remove_dead_variables, nir_var_shader_out);
+   NIR_PASS_V(nir, nir_remove_dead_variables, nir_var_system_value);
+   NIR_PASS_V(nir, nir_propagate_invariant);
+   NIR_PASS_V(nir, nir_lower_system_values);
+
+   NIR_PASS_V(nir, nir_lower_global_vars_to_local);
+   NIR_PASS_V(nir, nir_split_var_copies);
+   NIR_PASS_V(nir, nir_lower_var_copies);
+}
+
+static void
+run_optimizations(nir_shader *nir)
+{
+   bool progress;
+
+   do {
+      progress = false;
+      NIR_PASS_V(nir, nir_lower_vars_to_ssa);
+      NIR_PASS(progress, nir, nir_copy_prop);
+      NIR_PASS(progress, nir, nir_opt_dce);
+      NIR_PASS(progress, nir, nir_opt_gvn);
+      NIR_PASS(progress, nir, nir_opt_peephole_select);
+      NIR_PASS(progress, nir, nir_opt_algebraic);
+      NIR_PASS(progress, nir, nir_opt_constant_folding);
+      NIR_PASS(progress, nir, nir_opt_dead_cf);
+      NIR_PASS(progress, nir, nir_opt_remove_phis);
+      NIR_PASS(progress, nir, nir_opt_undef);
+   } while (progress);
+}
+
+static unsigned
+count_instrs(nir_shader *nir)
+{
+   unsigned count = 0;
+
+   nir_foreach_function(func, nir) {
+      if (!func->impl)
+         continue;
+
+      nir_foreach_block(block, func->impl) {
+         nir_foreach_instr(instr, block)
+            count++;
+      }
+   }
+
+   return count;
+}
+
+static void
+print_step_stats(const struct step_stats *steps)
+{
+   for (unsigned i = 0; i < NUM_STEPS; i++) {
+      if (i != STEP_SPIRV_TO_NIR && !optimize)
+         break;
+
+      printf("  %-12s %10.3f ms", step_names[i], steps[i].ns / 1e6);
+#ifdef HAVE_ALLOC_COUNT
+      printf(" %10" PRIu64 " allocs", steps[i].allocs);
+#endif
+      printf("\n");
+   }
+}
+
+/**
+ * Maps a module into memory, byte-swapping it if it was written with the
+ * other endianness.
+ *
+ * Returns the words, or NULL after printing an error.
+ */
+static const uint32_t *
+map_module(const char *path, size_t *word_count, void **map, size_t *map_size)
+{
+   int fd = open(path, O_RDONLY);
+   struct stat st;
+
+   if (fd < 0 || fstat(fd, &st) < 0) {
+      fprintf(stderr, "%s: %s\n", path, strerror(errno));
+      if (fd >= 0)
+         close(fd);
+      return NULL;
+   }
+
+   if (st.st_size < 5 * 4 || st.st_size % 4 != 0) {
+      fprintf(stderr, "%s: not a SPIR-V module\n", path);
+      close(fd);
+      return NULL;
+   }
+
+   /* Mapping the file avoids copying modules that are tens of megabytes. */
+   *map_size = st.st_size;
+   *map = mmap(NULL, *map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (*map == MAP_FAILED) {
+      fprintf(stderr, "%s: %s\n", path, strerror(errno));
+      return NULL;
+   }
+
+   const uint32_t *words = *map;
+   *word_count = *map_size / 4;
+
+   if (words[0] == SpvMagicNumber)
+      return words;
+
+   if (words[0] == __builtin_bswap32(SpvMagicNumber)) {
+      uint32_t *swapped = malloc(*map_size);
+      for (size_t i = 0; i < *word_count; i++)
+         swapped[i] = __builtin_bswap32(words[i]);
+      munmap(*map, *map_size);
+      *map = swapped;
+      *map_size = 0;
+      return swapped;
+   }
+
+   fprintf(stderr, "%s: not a SPIR-V module\n", path);
+   munmap(*map, *map_size);
+   return NULL;
+}
+
+static void
+unmap_module(void *map, size_t map_size)
+{
+   if (map_size)
+      munmap(map, map_size);
+   else
+      free(map);
+}
+
+static bool
+convert_module(const char *path, struct stats *totals)
+{
+   struct step_stats steps[NUM_STEPS];
+   size_t word_count, map_size;
+   unsigned instrs = 0;
+   void *map;
+
+   const uint32_t *words = map_module(path, &word_count, &map, &map_size);
+   if (!words)
+      return false;
+
+   memset(steps, 0, sizeof(steps));
+
+   for (unsigned run = 0; run < runs; run++) {
+      struct step_timer timer;
+
+      step_begin(&timer);
+      nir_function *entry_point =
+         spirv_to_nir(words, word_count, NULL, 0, stage, entry_point_name,
+                      &nir_options);
+      step_end(&steps[STEP_SPIRV_TO_NIR], &timer);
+
+      if (!entry_point) {
+         fprintf(stderr, "%s: entry point \"%s\" not found\n",
+                 path, entry_point_name);
+         unmap_module(map, map_size);
+         return false;
+      }
+
+      nir_shader *nir = entry_point->shader;
+      nir_validate_shader(nir);
+
+      if (optimize) {
+         step_begin(&timer);
+         lower(nir, entry_point);
+         step_end(&steps[STEP_LOWER], &timer);
+
+         step_begin(&timer);
+         run_optimizations(nir);
+         step_end(&steps[STEP_OPTIMIZE], &timer);
+      }
+
+      instrs = count_instrs(nir);
+
+      if (print && run == runs - 1)
+         nir_print_shader(nir, stdout);
+
+      ralloc_free(nir);
+   }
+
+   unmap_module(map, map_size);
+
+   if (!quiet) {
+      printf("%s: %zu words, %u instructions\n", path, word_count, instrs);
+      print_step_stats(steps);
+   }
+
+   totals->modules++;
+   totals->bytes += word_count * 4 * runs;
+   totals->instrs += instrs;
+   for (unsigned i = 0; i < NUM_STEPS; i++) {
+      totals->steps[i].ns += steps[i].ns;
+      totals->steps[i].allocs += steps[i].allocs;
+   }
+
+   return true;
+}
+
+static bool
+has_spv_suffix(const char *name)
+{
+   size_t len = strlen(name);
+
+   return len > 4 && strcmp(name + len - 4, ".spv") == 0;
+}
+
+static int
+compare_strings(const void *a, const void *b)
+{
+   return strcmp(*(char * const *) a, *(char * const *) b);
+}
+
+/**
+ * Converts every .spv file in a directory, in name order so that the output
+ * can be compared between runs.
+ */
+static bool
+convert_directory(const char *path, DIR *dir, struct stats *totals)
+{
+   char **names = NULL;
+   unsigned count = 0, size = 0;
+   struct dirent *entry;
+   bool ok = true;
+
+   while ((entry = readdir(dir)) != NULL) {
+      if (!has_spv_suffix(entry->d_name))
+         continue;
+
+      if (count == size) {
+         size = size ? size * 2 : 64;
+         names = realloc(names, size * sizeof(*names));
+      }
+      if (asprintf(&names[count], "%s/%s", path, entry->d_name) < 0)
+         return false;
+      count++;
+   }
+   closedir(dir);
+
+   qsort(names, count, sizeof(*names), compare_strings);
+
+   for (unsigned i = 0; i < count; i++) {
+      ok = convert_module(names[i], totals) && ok;
+      free(names[i]);
+   }
+   free(names);
+
+   return ok;
+}
+
+static bool
+parse_stage(const char *name)
+{
+   static const struct {
+      const char *name;
+      gl_shader_stage stage;
+   } stages[] = {
+      { "vertex",    MESA_SHADER_VERTEX },
+      { "tess-ctrl", MESA_SHADER_TESS_CTRL },
+      { "tess-eval", MESA_SHADER_TESS_EVAL },
+      { "geometry",  MESA_SHADER_GEOMETRY },
+      { "fragment",  MESA_SHADER_FRAGMENT },
+      { "compute",   MESA_SHADER_COMPUTE },
+   };
+
+   for (unsigned i = 0; i < ARRAY_SIZE(stages); i++) {
+      if (strcmp(name, stages[i].name) == 0) {
+         stage = stages[i].stage;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+static void
+usage(const char *argv0)
+{
+   fprintf(stderr,
+           "Usage: %s [options] <module.spv | directory>...\n"
+           "\n"
+           "Convert SPIR-V modules to NIR and time each step.\n"
+           "\n"
+           "Options:\n"
+           "  -s, --stage=STAGE  shader stage of the entry point: vertex,\n"
+           "                     tess-ctrl, tess-eval, geometry, fragment\n"
+           "                     (the default) or compute\n"
+           "  -e, --entry=NAME   name of the entry point (default \"main\")\n"
+           "  -O, --optimize     also run the lowering and optimization\n"
+           "                     passes a driver would\n"
+           "  -r, --runs=N       convert each module N times\n"
+           "  -p, --print        print the resulting NIR\n"
+           "  -q, --quiet        only print the totals\n",
+           argv0);
+}
+
+static const struct option long_options[] = {
+   { "stage",    required_argument, NULL, 's' },
+   { "entry",    required_argument, NULL, 'e' },
+   { "optimize", no_argument,       NULL, 'O' },
+   { "runs",     required_argument, NULL, 'r' },
+   { "print",    no_argument,       NULL, 'p' },
+   { "quiet",    no_argument,       NULL, 'q' },
+   { "help",     no_argument,       NULL, 'h' },
+   { NULL, 0, NULL, 0 }
+};
+
+int
+main(int argc, char **argv)
+{
+   struct stats totals;
+   bool ok = true;
+   int c;
+
+   while ((c = getopt_long(argc, argv, "s:e:Or:pqh", long_options,
+                           NULL)) != -1) {
+      switch (c) {
+      case 's':
+         if (!parse_stage(optarg)) {
+            fprintf(stderr, "Unknown shader stage \"%s\"\n", optarg);
+            return EXIT_FAILURE;
+         }
+         break;
+      case 'e':
+         entry_point_name = optarg;
+         break;
+      case 'O':
+         optimize = true;
+         break;
+      case 'r':
+         runs = atoi(optarg);
+         if (runs == 0)
+            runs = 1;
+         break;
+      case 'p':
+         print = true;
+         break;
+      case 'q':
+         quiet = true;
+         break;
+      case 'h':
+         usage(argv[0]);
+         return EXIT_SUCCESS;
+      default:
+         usage(argv[0]);
+         return EXIT_FAILURE;
+      }
+   }
+
+   if (optind == argc) {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   memset(&totals, 0, sizeof(totals));
+
+   for (int i = optind; i < argc; i++) {
+      DIR *dir = opendir(argv[i]);
+
+      if (dir)
+         ok = convert_directory(argv[i], dir, &totals) && ok;
+      else
+         ok = convert_module(argv[i], &totals) && ok;
+   }
+
+   if (totals.modules > 1 || runs > 1 || quiet) {
+      double s = totals.steps[STEP_SPIRV_TO_NIR].ns / 1e9;
+
+      printf("total: %u modules, %.1f KB, %u instructions\n",
+             totals.modules, totals.bytes / runs / 1024.0, totals.instrs);
+      print_step_stats(totals.steps);
+      if (s > 0)
+         printf("  spirv_to_nir throughput: %.2f MB/s\n",
+                totals.bytes / s / (1024 * 1024));
+   }
+
+   _mesa_glsl_release_types();
+
+   return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
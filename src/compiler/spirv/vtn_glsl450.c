@@ -641,7 +641,7 @@ vtn_handle_glsl450_instruction(struct vtn_builder *b, uint32_t ext_opcode,
    switch ((enum GLSLstd450)ext_opcode) {
    case GLSLstd450Determinant: {
       struct vtn_value *val = vtn_push_value(b, w[2], vtn_value_type_ssa);
-      val->ssa = rzalloc(b, struct vtn_ssa_value);
+      val->ssa = vtn_zalloc(b, struct vtn_ssa_value);
       val->ssa->type = vtn_value(b, w[1], vtn_value_type_type)->type->type;
       val->ssa->def = build_mat_det(b, vtn_ssa_value(b, w[5]));
       break;
@@ -344,6 +344,12 @@ struct vtn_decoration {
 struct vtn_builder {
    nir_builder nb;
 
+   /* Linear allocator for the data that only lives as long as the builder,
+    * like SSA values, decorations and names.  A large module has millions of
+    * these, and they are all freed together with the builder.
+    */
+   void *lin_ctx;
+
    nir_shader *shader;
    nir_function_impl *impl;
    struct vtn_block *block;
@@ -389,6 +395,13 @@ struct vtn_builder {
    bool has_loop_continue;
 };
 
+#define vtn_zalloc(b, type) \
+   ((type *) linear_zalloc_child((b)->lin_ctx, sizeof(type)))
+#define vtn_alloc_array(b, type, count) \
+   linear_alloc_child_array((b)->lin_ctx, type, count)
+#define vtn_zalloc_array(b, type, count) \
+   ((type *) linear_zalloc_child((b)->lin_ctx, sizeof(type) * (count)))
+
 static inline struct vtn_value *
 vtn_push_value(struct vtn_builder *b, uint32_t value_id,
                enum vtn_value_type value_type)
@@ -660,9 +660,9 @@ _vtn_variable_load_store(struct vtn_builder *b, bool load,
       unsigned elems = glsl_get_length(tail_type->type);
       if (load) {
          assert(*inout == NULL);
-         *inout = rzalloc(b, struct vtn_ssa_value);
+         *inout = vtn_zalloc(b, struct vtn_ssa_value);
          (*inout)->type = tail_type->type;
-         (*inout)->elems = rzalloc_array(b, struct vtn_ssa_value *, elems);
+         (*inout)->elems = vtn_zalloc_array(b, struct vtn_ssa_value *, elems);
       }
       for (unsigned i = 0; i < elems; i++) {
          new_chain->link[chain->length].id = i;
@@ -751,7 +751,7 @@ generate_fetch(struct gallivm_state *gallivm,
                                     FALSE,
                                     map_ptr,
                                     zero, zero, zero,
-                                    NULL);
+                                    NULL, NULL);
       LLVMBuildStore(builder, val, temp_ptr);
    }
    lp_build_endif(&if_ctx);
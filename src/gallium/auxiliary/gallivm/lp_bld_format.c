@@ -26,31 +26,89 @@
  **************************************************************************/
 
 
+#include "util/u_format.h"
+#include "util/u_math.h"
+#include "util/u_memory.h"
+
 #include "lp_bld_format.h"
 
 
+/**
+ * Allocate a block cache holding about \p size bytes of decoded texels.
+ *
+ * Returns NULL if the size is too small for a single set, in which case
+ * the cached fetch code decodes every texel.
+ */
+struct lp_build_format_cache *
+lp_build_format_cache_create(unsigned size)
+{
+   struct lp_build_format_cache *cache;
+   unsigned num_entries = size / sizeof cache->data[0];
+
+   if (num_entries < LP_BUILD_FORMAT_CACHE_WAYS)
+      return NULL;
+
+   cache = CALLOC_STRUCT(lp_build_format_cache);
+   if (!cache)
+      return NULL;
+
+   cache->set_bits = util_logbase2(num_entries / LP_BUILD_FORMAT_CACHE_WAYS);
+   num_entries = LP_BUILD_FORMAT_CACHE_WAYS << cache->set_bits;
+
+   cache->tags = CALLOC(num_entries, sizeof cache->tags[0]);
+   cache->data = align_malloc(num_entries * sizeof cache->data[0], 64);
+   if (!cache->tags || !cache->data) {
+      lp_build_format_cache_destroy(cache);
+      return NULL;
+   }
+
+   return cache;
+}
+
+
+void
+lp_build_format_cache_destroy(struct lp_build_format_cache *cache)
+{
+   if (!cache)
+      return;
+
+   FREE(cache->tags);
+   align_free(cache->data);
+   FREE(cache);
+}
+
 
-LLVMTypeRef
-lp_build_format_cache_type(struct gallivm_state *gallivm)
+/**
+ * Whether texels of the format may be fetched through the block cache.
+ *
+ * That is the case for compressed formats which have a block decoder and
+ * whose texels fit into RGBA8 (for sRGB formats, once they are decoded with
+ * the linear counterpart).
+ */
+boolean
+lp_build_format_cacheable(const struct util_format_description *format_desc)
 {
-   LLVMTypeRef elem_types[LP_BUILD_FORMAT_CACHE_MEMBER_COUNT];
-   LLVMTypeRef s;
-
-   elem_types[LP_BUILD_FORMAT_CACHE_MEMBER_DATA] =
-         LLVMArrayType(LLVMInt32TypeInContext(gallivm->context),
-                       LP_BUILD_FORMAT_CACHE_SIZE * 16);
-   elem_types[LP_BUILD_FORMAT_CACHE_MEMBER_TAGS] =
-         LLVMArrayType(LLVMInt64TypeInContext(gallivm->context),
-                       LP_BUILD_FORMAT_CACHE_SIZE);
-#if LP_BUILD_FORMAT_CACHE_DEBUG
-   elem_types[LP_BUILD_FORMAT_CACHE_MEMBER_ACCESS_TOTAL] =
-         LLVMInt64TypeInContext(gallivm->context);
-   elem_types[LP_BUILD_FORMAT_CACHE_MEMBER_ACCESS_MISS] =
-         LLVMInt64TypeInContext(gallivm->context);
-#endif
-
-   s = LLVMStructTypeInContext(gallivm->context, elem_types,
-                               LP_BUILD_FORMAT_CACHE_MEMBER_COUNT, 0);
-
-   return s;
+   const struct util_format_description *linear_desc;
+
+   switch (format_desc->layout) {
+   case UTIL_FORMAT_LAYOUT_S3TC:
+   case UTIL_FORMAT_LAYOUT_RGTC:
+   case UTIL_FORMAT_LAYOUT_ETC:
+   case UTIL_FORMAT_LAYOUT_BPTC:
+   case UTIL_FORMAT_LAYOUT_ASTC:
+      break;
+   default:
+      return FALSE;
+   }
+
+   if (format_desc->block.width > LP_BUILD_FORMAT_CACHE_MAX_BLOCK_SIZE ||
+       format_desc->block.height > LP_BUILD_FORMAT_CACHE_MAX_BLOCK_SIZE) {
+      return FALSE;
+   }
+
+   linear_desc = util_format_description(util_format_linear(format_desc->format));
+
+   return format_desc->unpack_rgba_8unorm &&
+          format_desc->fetch_rgba_8unorm &&
+          util_format_fits_8unorm(linear_desc);
 }
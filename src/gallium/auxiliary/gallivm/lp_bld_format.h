@@ -44,43 +44,51 @@ struct lp_type;
 struct lp_build_context;
 
 
-#define LP_BUILD_FORMAT_CACHE_DEBUG 0
 /*
  * Block cache
  *
- * Optional block cache to be used when unpacking big pixel blocks.
- * Must be a power of 2
+ * Optional cache of decoded compressed blocks, see lp_bld_format_cached.c.
+ * The cache is set associative, each entry holds a 4x4 tile of RGBA8
+ * texels.  Blocks larger than 4x4 are stored as several tiles.
  */
 
-#define LP_BUILD_FORMAT_CACHE_SIZE 128
+#define LP_BUILD_FORMAT_CACHE_WAYS 4
+#define LP_BUILD_FORMAT_CACHE_TILE_SIZE 4
+#define LP_BUILD_FORMAT_CACHE_MAX_BLOCK_SIZE 12
 
-/*
- * Note: cache_data needs 16 byte alignment.
- */
-struct lp_build_format_cache
+struct lp_build_format_cache_tag
 {
-   PIPE_ALIGN_VAR(16) uint32_t cache_data[LP_BUILD_FORMAT_CACHE_SIZE][4][4];
-   uint64_t cache_tags[LP_BUILD_FORMAT_CACHE_SIZE];
-#if LP_BUILD_FORMAT_CACHE_DEBUG
-   uint64_t cache_access_total;
-   uint64_t cache_access_miss;
-#endif
+   const uint8_t *block;   /**< address of the block, NULL if unused */
+   uint32_t generation;    /**< contents generation of the texture */
+   uint16_t format;        /**< enum pipe_format the block was decoded as */
+   uint16_t tile;          /**< tile index within the block */
+   uint32_t last_use;
 };
 
+struct lp_build_format_cache
+{
+   unsigned set_bits;      /**< log2 of the number of sets */
+   uint32_t clock;
+
+   /* (LP_BUILD_FORMAT_CACHE_WAYS << set_bits) entries */
+   struct lp_build_format_cache_tag *tags;
+   uint32_t (*data)[LP_BUILD_FORMAT_CACHE_TILE_SIZE *
+                    LP_BUILD_FORMAT_CACHE_TILE_SIZE];
 
-enum {
-   LP_BUILD_FORMAT_CACHE_MEMBER_DATA = 0,
-   LP_BUILD_FORMAT_CACHE_MEMBER_TAGS,
-#if LP_BUILD_FORMAT_CACHE_DEBUG
-   LP_BUILD_FORMAT_CACHE_MEMBER_ACCESS_TOTAL,
-   LP_BUILD_FORMAT_CACHE_MEMBER_ACCESS_MISS,
-#endif
-   LP_BUILD_FORMAT_CACHE_MEMBER_COUNT
+   /* fetched texels and decoded blocks, the user may reset these */
+   uint64_t access_total;
+   uint64_t access_miss;
 };
 
 
-LLVMTypeRef
-lp_build_format_cache_type(struct gallivm_state *gallivm);
+struct lp_build_format_cache *
+lp_build_format_cache_create(unsigned size);
+
+void
+lp_build_format_cache_destroy(struct lp_build_format_cache *cache);
+
+boolean
+lp_build_format_cacheable(const struct util_format_description *format_desc);
 
 
 /*
@@ -106,7 +114,8 @@ lp_build_fetch_rgba_aos(struct gallivm_state *gallivm,
                         LLVMValueRef offset,
                         LLVMValueRef i,
                         LLVMValueRef j,
-                        LLVMValueRef cache);
+                        LLVMValueRef cache,
+                        LLVMValueRef cache_generation);
 
 LLVMValueRef
 lp_build_fetch_rgba_aos_array(struct gallivm_state *gallivm,
@@ -148,6 +157,7 @@ lp_build_fetch_rgba_soa(struct gallivm_state *gallivm,
                         LLVMValueRef i,
                         LLVMValueRef j,
                         LLVMValueRef cache,
+                        LLVMValueRef cache_generation,
                         LLVMValueRef rgba_out[4]);
 
 /*
@@ -172,7 +182,8 @@ lp_build_fetch_cached_texels(struct gallivm_state *gallivm,
                              LLVMValueRef offset,
                              LLVMValueRef i,
                              LLVMValueRef j,
-                             LLVMValueRef cache);
+                             LLVMValueRef cache,
+                             LLVMValueRef cache_generation);
 
 
 /*
@@ -360,6 +360,9 @@ lp_build_pack_rgba_aos(struct gallivm_state *gallivm,
  * \param ptr  address of the pixel block (or the texel if uncompressed)
  * \param i, j  the sub-block pixel coordinates.  For non-compressed formats
  *              these will always be (0, 0).
+ * \param cache  optional value pointing to a lp_build_format_cache structure
+ * \param cache_generation  contents generation of the texture, used to tag
+ *                          the cache entries
  * \return  a 4 element vector with the pixel's RGBA values.
  */
 LLVMValueRef
@@ -371,7 +374,8 @@ lp_build_fetch_rgba_aos(struct gallivm_state *gallivm,
                         LLVMValueRef offset,
                         LLVMValueRef i,
                         LLVMValueRef j,
-                        LLVMValueRef cache)
+                        LLVMValueRef cache,
+                        LLVMValueRef cache_generation)
 {
    LLVMBuilderRef builder = gallivm->builder;
    unsigned num_pixels = type.length / 4;
@@ -504,10 +508,10 @@ lp_build_fetch_rgba_aos(struct gallivm_state *gallivm,
    }
 
    /*
-    * s3tc rgb formats
+    * Compressed formats through the block cache
     */
 
-   if (format_desc->layout == UTIL_FORMAT_LAYOUT_S3TC && cache) {
+   if (cache && lp_build_format_cacheable(format_desc)) {
       struct lp_type tmp_type;
       LLVMValueRef tmp;
 
@@ -522,7 +526,7 @@ lp_build_fetch_rgba_aos(struct gallivm_state *gallivm,
                                          base_ptr,
                                          offset,
                                          i, j,
-                                         cache);
+                                         cache, cache_generation);
 
       lp_build_conv(gallivm,
                     tmp_type, type,
@@ -27,12 +27,13 @@
 
 #include "lp_bld_format.h"
 #include "lp_bld_type.h"
-#include "lp_bld_struct.h"
 #include "lp_bld_const.h"
 #include "lp_bld_flow.h"
-#include "lp_bld_swizzle.h"
+#include "lp_bld_struct.h"
 
+#include "util/u_format.h"
 #include "util/u_math.h"
+#include "util/u_pointer.h"
 
 
 /**
@@ -41,203 +42,433 @@
  * so re-decoding of every pixel is not required.
  * Especially for bilinear filtering, texel reuse is very high hence even
  * a small cache helps.
- * The elements in the cache are the decoded blocks - currently things
- * are restricted to formats which are 4x4 block based, and the decoded
- * texels must fit into 4x8 bits.
- * The cache is direct mapped so hitrates aren't all that great and cache
- * thrashing could happen.
+ *
+ * The elements in the cache are 4x4 tiles of decoded RGBA8 texels.  Blocks
+ * larger than that (ASTC) occupy several tiles, all of which are filled when
+ * the block is decoded.  The cache is set associative with LRU replacement.
+ * Entries are tagged with the block address, the format and the contents
+ * generation of the texture, so that they stay valid across scenes as long
+ * as the texture isn't written to.
+ *
+ * The lookup is done in the generated code, only misses call into C, which
+ * decodes the whole block with unpack_rgba_8unorm().
  *
  * @author Roland Scheidegger <sroland@vmware.com>
  */
 
 
-#if LP_BUILD_FORMAT_CACHE_DEBUG
-static void
-update_cache_access(struct gallivm_state *gallivm,
-                    LLVMValueRef ptr,
-                    unsigned count,
-                    unsigned index)
+#define TILE_SIZE LP_BUILD_FORMAT_CACHE_TILE_SIZE
+#define WAYS LP_BUILD_FORMAT_CACHE_WAYS
+
+
+static inline unsigned
+cache_set(const struct lp_build_format_cache *cache,
+          const uint8_t *block, unsigned tile)
 {
-   LLVMBuilderRef builder = gallivm->builder;
-   LLVMValueRef member_ptr, cache_access;
+   /* Blocks are at least 8 bytes, leave room for the tile index. */
+   uint32_t key = (uint32_t)((uintptr_t)block >> 3) * 16 + tile;
+
+   /* Fibonacci hashing, so that rows of blocks spread over all sets. */
+   return (uint32_t)((uint64_t)(key * 2654435769u) >> (32 - cache->set_bits));
+}
+
 
-   assert(index == LP_BUILD_FORMAT_CACHE_MEMBER_ACCESS_TOTAL ||
-          index == LP_BUILD_FORMAT_CACHE_MEMBER_ACCESS_MISS);
+static inline const uint32_t *
+lookup_tile(struct lp_build_format_cache *cache,
+            const struct util_format_description *format_desc,
+            uint32_t generation,
+            const uint8_t *block,
+            unsigned tile)
+{
+   unsigned set = cache_set(cache, block, tile);
+   struct lp_build_format_cache_tag *tags = &cache->tags[set * WAYS];
+   unsigned way;
+
+   for (way = 0; way < WAYS; way++) {
+      if (tags[way].block == block &&
+          tags[way].generation == generation &&
+          tags[way].format == format_desc->format &&
+          tags[way].tile == tile) {
+         tags[way].last_use = ++cache->clock;
+         return cache->data[set * WAYS + way];
+      }
+   }
 
-   member_ptr = lp_build_struct_get_ptr(gallivm, ptr, index, "");
-   cache_access = LLVMBuildLoad(builder, member_ptr, "cache_access");
-   cache_access = LLVMBuildAdd(builder, cache_access,
-                               LLVMConstInt(LLVMInt64TypeInContext(gallivm->context),
-                                                                   count, 0), "");
-   LLVMBuildStore(builder, cache_access, member_ptr);
+   return NULL;
 }
-#endif
 
 
-static void
-store_cached_block(struct gallivm_state *gallivm,
-                   LLVMValueRef *col,
-                   LLVMValueRef tag_value,
-                   LLVMValueRef hash_index,
-                   LLVMValueRef cache)
+static uint32_t *
+alloc_tile(struct lp_build_format_cache *cache,
+           const struct util_format_description *format_desc,
+           uint32_t generation,
+           const uint8_t *block,
+           unsigned tile)
 {
-   LLVMBuilderRef builder = gallivm->builder;
-   LLVMValueRef ptr, indices[3];
-   LLVMTypeRef type_ptr4x32;
-   unsigned count;
+   unsigned set = cache_set(cache, block, tile);
+   struct lp_build_format_cache_tag *tags = &cache->tags[set * WAYS];
+   unsigned way, victim = 0;
 
-   type_ptr4x32 = LLVMPointerType(LLVMVectorType(LLVMInt32TypeInContext(gallivm->context), 4), 0);
-   indices[0] = lp_build_const_int32(gallivm, 0);
-   indices[1] = lp_build_const_int32(gallivm, LP_BUILD_FORMAT_CACHE_MEMBER_TAGS);
-   indices[2] = hash_index;
-   ptr = LLVMBuildGEP(builder, cache, indices, ARRAY_SIZE(indices), "");
-   LLVMBuildStore(builder, tag_value, ptr);
-
-   indices[1] = lp_build_const_int32(gallivm, LP_BUILD_FORMAT_CACHE_MEMBER_DATA);
-   hash_index = LLVMBuildMul(builder, hash_index,
-                             lp_build_const_int32(gallivm, 16), "");
-   for (count = 0; count < 4; count++) {
-      indices[2] = hash_index;
-      ptr = LLVMBuildGEP(builder, cache, indices, ARRAY_SIZE(indices), "");
-      ptr = LLVMBuildBitCast(builder, ptr, type_ptr4x32, "");
-      LLVMBuildStore(builder, col[count], ptr);
-      hash_index = LLVMBuildAdd(builder, hash_index,
-                                lp_build_const_int32(gallivm, 4), "");
+   for (way = 1; way < WAYS; way++) {
+      if ((int32_t)(tags[way].last_use - tags[victim].last_use) < 0)
+         victim = way;
    }
+
+   tags[victim].block = block;
+   tags[victim].generation = generation;
+   tags[victim].format = format_desc->format;
+   tags[victim].tile = tile;
+   tags[victim].last_use = ++cache->clock;
+
+   return cache->data[set * WAYS + victim];
 }
 
 
-static LLVMValueRef
-lookup_cached_pixel(struct gallivm_state *gallivm,
-                    LLVMValueRef ptr,
-                    LLVMValueRef index)
+/**
+ * Decode the block and store all of its tiles which aren't cached yet.
+ * The requested tile is stored last, so it can't get evicted by the others.
+ */
+static const uint32_t *
+update_cached_block(struct lp_build_format_cache *cache,
+                    const struct util_format_description *format_desc,
+                    uint32_t generation,
+                    const uint8_t *block,
+                    unsigned tile)
 {
-   LLVMBuilderRef builder = gallivm->builder;
-   LLVMValueRef member_ptr, indices[3];
+   const unsigned bw = format_desc->block.width;
+   const unsigned bh = format_desc->block.height;
+   const unsigned tiles_x = DIV_ROUND_UP(bw, TILE_SIZE);
+   const unsigned num_tiles = tiles_x * DIV_ROUND_UP(bh, TILE_SIZE);
+   uint32_t texels[LP_BUILD_FORMAT_CACHE_MAX_BLOCK_SIZE *
+                   LP_BUILD_FORMAT_CACHE_MAX_BLOCK_SIZE];
+   uint32_t *data = NULL;
+   unsigned t, x, y;
+
+   format_desc->unpack_rgba_8unorm((uint8_t *)texels, bw * 4, block, 0,
+                                   bw, bh);
+
+   for (t = 0; t < num_tiles; t++) {
+      /* visit the requested tile last */
+      unsigned n = (tile + 1 + t) % num_tiles;
+      unsigned x0 = (n % tiles_x) * TILE_SIZE;
+      unsigned y0 = (n / tiles_x) * TILE_SIZE;
+
+      if (n != tile && lookup_tile(cache, format_desc, generation, block, n))
+         continue;
+
+      data = alloc_tile(cache, format_desc, generation, block, n);
+
+      for (y = 0; y < TILE_SIZE; y++) {
+         for (x = 0; x < TILE_SIZE; x++) {
+            data[y * TILE_SIZE + x] =
+               x0 + x < bw && y0 + y < bh ? texels[(y0 + y) * bw + x0 + x] : 0;
+         }
+      }
+   }
 
-   indices[0] = lp_build_const_int32(gallivm, 0);
-   indices[1] = lp_build_const_int32(gallivm, LP_BUILD_FORMAT_CACHE_MEMBER_DATA);
-   indices[2] = index;
-   member_ptr = LLVMBuildGEP(builder, ptr, indices, ARRAY_SIZE(indices), "");
-   return LLVMBuildLoad(builder, member_ptr, "cache_data");
+   return data;
 }
 
 
-static LLVMValueRef
-lookup_tag_data(struct gallivm_state *gallivm,
-                LLVMValueRef ptr,
-                LLVMValueRef index)
+/**
+ * Fetch texel (i, j) of the block after a cache miss, or without a cache.
+ * Called from the generated code.
+ */
+static uint32_t
+fetch_texel_miss(struct lp_build_format_cache *cache,
+                 const struct util_format_description *format_desc,
+                 uint32_t generation,
+                 const uint8_t *block,
+                 unsigned i,
+                 unsigned j)
 {
-   LLVMBuilderRef builder = gallivm->builder;
-   LLVMValueRef member_ptr, indices[3];
+   const unsigned tiles_x = DIV_ROUND_UP(format_desc->block.width, TILE_SIZE);
+   unsigned tile = (j / TILE_SIZE) * tiles_x + i / TILE_SIZE;
+   const uint32_t *data;
+   uint32_t texel;
+
+   if (!cache) {
+      format_desc->fetch_rgba_8unorm((uint8_t *)&texel, block, i, j);
+      return texel;
+   }
 
-   indices[0] = lp_build_const_int32(gallivm, 0);
-   indices[1] = lp_build_const_int32(gallivm, LP_BUILD_FORMAT_CACHE_MEMBER_TAGS);
-   indices[2] = index;
-   member_ptr = LLVMBuildGEP(builder, ptr, indices, ARRAY_SIZE(indices), "");
-   return LLVMBuildLoad(builder, member_ptr, "tag_data");
+   data = update_cached_block(cache, format_desc, generation, block, tile);
+   cache->access_miss++;
+
+   return data[(j % TILE_SIZE) * TILE_SIZE + i % TILE_SIZE];
 }
 
 
-static void
-update_cached_block(struct gallivm_state *gallivm,
-                    const struct util_format_description *format_desc,
-                    LLVMValueRef ptr_addr,
-                    LLVMValueRef hash_index,
-                    LLVMValueRef cache)
+enum {
+   CACHE_MEMBER_SET_BITS = 0,
+   CACHE_MEMBER_CLOCK,
+   CACHE_MEMBER_TAGS,
+   CACHE_MEMBER_DATA,
+   CACHE_MEMBER_ACCESS_TOTAL,
+   CACHE_MEMBER_ACCESS_MISS,
+   CACHE_MEMBER_COUNT
+};
+
+enum {
+   TAG_MEMBER_BLOCK = 0,
+   TAG_MEMBER_GENERATION,
+   TAG_MEMBER_FORMAT,
+   TAG_MEMBER_TILE,
+   TAG_MEMBER_LAST_USE,
+   TAG_MEMBER_COUNT
+};
+
+
+static LLVMTypeRef
+cache_tag_type(struct gallivm_state *gallivm)
+{
+   LLVMContextRef lc = gallivm->context;
+   LLVMTypeRef elem_types[TAG_MEMBER_COUNT];
+   LLVMTypeRef tag_type;
+
+   elem_types[TAG_MEMBER_BLOCK] = LLVMPointerType(LLVMInt8TypeInContext(lc), 0);
+   elem_types[TAG_MEMBER_GENERATION] = LLVMInt32TypeInContext(lc);
+   elem_types[TAG_MEMBER_FORMAT] = LLVMInt16TypeInContext(lc);
+   elem_types[TAG_MEMBER_TILE] = LLVMInt16TypeInContext(lc);
+   elem_types[TAG_MEMBER_LAST_USE] = LLVMInt32TypeInContext(lc);
+
+   tag_type = LLVMStructTypeInContext(lc, elem_types,
+                                      ARRAY_SIZE(elem_types), 0);
+
+   LP_CHECK_MEMBER_OFFSET(struct lp_build_format_cache_tag, block,
+                          gallivm->target, tag_type, TAG_MEMBER_BLOCK);
+   LP_CHECK_MEMBER_OFFSET(struct lp_build_format_cache_tag, generation,
+                          gallivm->target, tag_type, TAG_MEMBER_GENERATION);
+   LP_CHECK_MEMBER_OFFSET(struct lp_build_format_cache_tag, format,
+                          gallivm->target, tag_type, TAG_MEMBER_FORMAT);
+   LP_CHECK_MEMBER_OFFSET(struct lp_build_format_cache_tag, tile,
+                          gallivm->target, tag_type, TAG_MEMBER_TILE);
+   LP_CHECK_MEMBER_OFFSET(struct lp_build_format_cache_tag, last_use,
+                          gallivm->target, tag_type, TAG_MEMBER_LAST_USE);
+   LP_CHECK_STRUCT_SIZE(struct lp_build_format_cache_tag,
+                        gallivm->target, tag_type);
+
+   return tag_type;
+}
+
 
+static LLVMTypeRef
+cache_type(struct gallivm_state *gallivm)
+{
+   LLVMContextRef lc = gallivm->context;
+   LLVMTypeRef elem_types[CACHE_MEMBER_COUNT];
+   LLVMTypeRef type;
+
+   elem_types[CACHE_MEMBER_SET_BITS] = LLVMInt32TypeInContext(lc);
+   elem_types[CACHE_MEMBER_CLOCK] = LLVMInt32TypeInContext(lc);
+   elem_types[CACHE_MEMBER_TAGS] = LLVMPointerType(cache_tag_type(gallivm), 0);
+   elem_types[CACHE_MEMBER_DATA] =
+      LLVMPointerType(LLVMInt32TypeInContext(lc), 0);
+   elem_types[CACHE_MEMBER_ACCESS_TOTAL] = LLVMInt64TypeInContext(lc);
+   elem_types[CACHE_MEMBER_ACCESS_MISS] = LLVMInt64TypeInContext(lc);
+
+   type = LLVMStructTypeInContext(lc, elem_types, ARRAY_SIZE(elem_types), 0);
+
+   LP_CHECK_MEMBER_OFFSET(struct lp_build_format_cache, set_bits,
+                          gallivm->target, type, CACHE_MEMBER_SET_BITS);
+   LP_CHECK_MEMBER_OFFSET(struct lp_build_format_cache, clock,
+                          gallivm->target, type, CACHE_MEMBER_CLOCK);
+   LP_CHECK_MEMBER_OFFSET(struct lp_build_format_cache, tags,
+                          gallivm->target, type, CACHE_MEMBER_TAGS);
+   LP_CHECK_MEMBER_OFFSET(struct lp_build_format_cache, data,
+                          gallivm->target, type, CACHE_MEMBER_DATA);
+   LP_CHECK_MEMBER_OFFSET(struct lp_build_format_cache, access_total,
+                          gallivm->target, type, CACHE_MEMBER_ACCESS_TOTAL);
+   LP_CHECK_MEMBER_OFFSET(struct lp_build_format_cache, access_miss,
+                          gallivm->target, type, CACHE_MEMBER_ACCESS_MISS);
+   LP_CHECK_STRUCT_SIZE(struct lp_build_format_cache,
+                        gallivm->target, type);
+
+   return type;
+}
+
+
+/**
+ * Call fetch_texel_miss(cache, format_desc, generation, block, i, j).
+ */
+static LLVMValueRef
+call_fetch_texel_miss(struct gallivm_state *gallivm,
+                      const struct util_format_description *format_desc,
+                      LLVMValueRef cache,
+                      LLVMValueRef generation,
+                      LLVMValueRef block,
+                      LLVMValueRef i,
+                      LLVMValueRef j)
 {
    LLVMBuilderRef builder = gallivm->builder;
    LLVMTypeRef i8t = LLVMInt8TypeInContext(gallivm->context);
    LLVMTypeRef pi8t = LLVMPointerType(i8t, 0);
    LLVMTypeRef i32t = LLVMInt32TypeInContext(gallivm->context);
-   LLVMTypeRef i32x4 = LLVMVectorType(LLVMInt32TypeInContext(gallivm->context), 4);
-   LLVMValueRef function;
-   LLVMValueRef tag_value, tmp_ptr;
-   LLVMValueRef col[4];
-   unsigned i, j;
-
-   /*
-    * Use format_desc->fetch_rgba_8unorm() for each pixel in the block.
-    * This doesn't actually make any sense whatsoever, someone would need
-    * to write a function doing this for all pixels in a block (either as
-    * an external c function or with generated code). Don't ask.
-    */
+   LLVMValueRef function, args[6];
 
    {
-      /*
-       * Function to call looks like:
-       *   fetch(uint8_t *dst, const uint8_t *src, unsigned i, unsigned j)
-       */
-      LLVMTypeRef ret_type;
-      LLVMTypeRef arg_types[4];
+      LLVMTypeRef arg_types[6];
       LLVMTypeRef function_type;
 
-      assert(format_desc->fetch_rgba_8unorm);
-
-      ret_type = LLVMVoidTypeInContext(gallivm->context);
       arg_types[0] = pi8t;
       arg_types[1] = pi8t;
       arg_types[2] = i32t;
-      arg_types[3] = i32t;
-      function_type = LLVMFunctionType(ret_type, arg_types,
+      arg_types[3] = pi8t;
+      arg_types[4] = i32t;
+      arg_types[5] = i32t;
+      function_type = LLVMFunctionType(i32t, arg_types,
                                        ARRAY_SIZE(arg_types), 0);
 
-      /* make const pointer for the C fetch_rgba_8unorm function */
       function = lp_build_const_int_pointer(gallivm,
-         func_to_pointer((func_pointer) format_desc->fetch_rgba_8unorm));
+         func_to_pointer((func_pointer) fetch_texel_miss));
 
-      /* cast the callee pointer to the function's type */
       function = LLVMBuildBitCast(builder, function,
                                   LLVMPointerType(function_type, 0),
                                   "cast callee");
    }
 
-   tmp_ptr = lp_build_array_alloca(gallivm, i32x4,
-                                   lp_build_const_int32(gallivm, 16),
-                                   "tmp_decode_store");
-   tmp_ptr = LLVMBuildBitCast(builder, tmp_ptr, pi8t, "");
-
-   /*
-    * Invoke format_desc->fetch_rgba_8unorm() for each pixel.
-    * This is going to be really really slow.
-    * Note: the block store format is actually
-    * x0y0x0y1x0y2x0y3 x1y0x1y1x1y2x1y3 ...
-    */
-   for (i = 0; i < 4; ++i) {
-      for (j = 0; j < 4; ++j) {
-         LLVMValueRef args[4];
-         LLVMValueRef dst_offset = lp_build_const_int32(gallivm, (i * 4 + j) * 4);
-
-         /*
-          * Note we actually supply a pointer to the start of the block,
-          * not the start of the texture.
-          */
-         args[0] = LLVMBuildGEP(gallivm->builder, tmp_ptr, &dst_offset, 1, "");
-         args[1] = ptr_addr;
-         args[2] = LLVMConstInt(i32t, i, 0);
-         args[3] = LLVMConstInt(i32t, j, 0);
-         LLVMBuildCall(builder, function, args, ARRAY_SIZE(args), "");
-      }
+   args[0] = LLVMBuildBitCast(builder, cache, pi8t, "");
+   args[1] = LLVMBuildBitCast(builder,
+                              lp_build_const_int_pointer(gallivm, format_desc),
+                              pi8t, "");
+   args[2] = generation;
+   args[3] = block;
+   args[4] = i;
+   args[5] = j;
+
+   return LLVMBuildCall(builder, function, args, ARRAY_SIZE(args), "");
+}
+
+
+/**
+ * Look up texel (i, j) of the block in the cache, mirroring lookup_tile(),
+ * and only call into C to decode the block on a miss.
+ */
+static LLVMValueRef
+fetch_cached_texel(struct gallivm_state *gallivm,
+                   const struct util_format_description *format_desc,
+                   LLVMValueRef cache,
+                   LLVMValueRef set_bits,
+                   LLVMValueRef tags,
+                   LLVMValueRef data,
+                   LLVMValueRef generation,
+                   LLVMValueRef block,
+                   LLVMValueRef i,
+                   LLVMValueRef j)
+{
+   LLVMBuilderRef builder = gallivm->builder;
+   LLVMTypeRef i16t = LLVMInt16TypeInContext(gallivm->context);
+   LLVMTypeRef i32t = LLVMInt32TypeInContext(gallivm->context);
+   LLVMTypeRef i64t = LLVMInt64TypeInContext(gallivm->context);
+   const unsigned tiles_x = DIV_ROUND_UP(format_desc->block.width, TILE_SIZE);
+   LLVMValueRef tile_size = lp_build_const_int32(gallivm, TILE_SIZE);
+   LLVMValueRef key, set, entry, tile, texel, way, hit, texel_ptr;
+   struct lp_build_if_state if_ctx;
+   unsigned w;
+
+   tile = LLVMBuildMul(builder, LLVMBuildUDiv(builder, j, tile_size, ""),
+                       lp_build_const_int32(gallivm, tiles_x), "");
+   tile = LLVMBuildAdd(builder, tile,
+                       LLVMBuildUDiv(builder, i, tile_size, ""), "tile");
+
+   /* See cache_set(). */
+   key = LLVMBuildPtrToInt(builder, block, i64t, "");
+   key = LLVMBuildLShr(builder, key, LLVMConstInt(i64t, 3, 0), "");
+   key = LLVMBuildTrunc(builder, key, i32t, "");
+   key = LLVMBuildMul(builder, key, lp_build_const_int32(gallivm, 16), "");
+   key = LLVMBuildAdd(builder, key, tile, "");
+   set = LLVMBuildMul(builder, key,
+                      lp_build_const_int32(gallivm, 2654435769u), "");
+   set = LLVMBuildZExt(builder, set, i64t, "");
+   set = LLVMBuildLShr(builder, set,
+                       LLVMBuildZExt(builder,
+                                     LLVMBuildSub(builder,
+                                                  lp_build_const_int32(gallivm, 32),
+                                                  set_bits, ""),
+                                     i64t, ""), "");
+   set = LLVMBuildTrunc(builder, set, i32t, "set");
+   entry = LLVMBuildMul(builder, set, lp_build_const_int32(gallivm, WAYS), "");
+
+   /* Compare all the tags of the set, at most one of them matches. */
+   way = lp_build_const_int32(gallivm, WAYS);
+   for (w = 0; w < WAYS; w++) {
+      LLVMValueRef index, tag, match, tmp;
+
+      index = LLVMBuildAdd(builder, entry, lp_build_const_int32(gallivm, w), "");
+      tag = LLVMBuildGEP(builder, tags, &index, 1, "");
+
+      tmp = lp_build_struct_get(gallivm, tag, TAG_MEMBER_BLOCK, "block");
+      match = LLVMBuildICmp(builder, LLVMIntEQ, tmp, block, "");
+      tmp = lp_build_struct_get(gallivm, tag, TAG_MEMBER_GENERATION,
+                                "generation");
+      tmp = LLVMBuildICmp(builder, LLVMIntEQ, tmp, generation, "");
+      match = LLVMBuildAnd(builder, match, tmp, "");
+      tmp = lp_build_struct_get(gallivm, tag, TAG_MEMBER_FORMAT, "format");
+      tmp = LLVMBuildICmp(builder, LLVMIntEQ, tmp,
+                          LLVMConstInt(i16t, format_desc->format, 0), "");
+      match = LLVMBuildAnd(builder, match, tmp, "");
+      tmp = lp_build_struct_get(gallivm, tag, TAG_MEMBER_TILE, "tile");
+      tmp = LLVMBuildICmp(builder, LLVMIntEQ, tmp,
+                          LLVMBuildTrunc(builder, tile, i16t, ""), "");
+      match = LLVMBuildAnd(builder, match, tmp, "");
+
+      way = LLVMBuildSelect(builder, match,
+                            lp_build_const_int32(gallivm, w), way, "way");
    }
 
-   /* Finally store the block - pointless mem copy + update tag. */
-   tmp_ptr = LLVMBuildBitCast(builder, tmp_ptr, LLVMPointerType(i32x4, 0), "");
-   for (i = 0; i < 4; ++i) {
-      LLVMValueRef tmp_offset = lp_build_const_int32(gallivm, i);
-      LLVMValueRef ptr = LLVMBuildGEP(gallivm->builder, tmp_ptr, &tmp_offset, 1, "");
-      col[i] = LLVMBuildLoad(builder, ptr, "");
+   texel = LLVMBuildURem(builder, j, tile_size, "");
+   texel = LLVMBuildMul(builder, texel, tile_size, "");
+   texel = LLVMBuildAdd(builder, texel,
+                        LLVMBuildURem(builder, i, tile_size, ""), "");
+
+   texel_ptr = lp_build_alloca(gallivm, i32t, "texel");
+   hit = LLVMBuildICmp(builder, LLVMIntNE, way,
+                       lp_build_const_int32(gallivm, WAYS), "hit");
+
+   lp_build_if(&if_ctx, gallivm, hit);
+   {
+      LLVMValueRef index, clock_ptr, clock, tag, tmp;
+
+      index = LLVMBuildAdd(builder, entry, way, "");
+
+      /* tags[index].last_use = ++cache->clock */
+      clock_ptr = lp_build_struct_get_ptr(gallivm, cache, CACHE_MEMBER_CLOCK,
+                                          "clock");
+      clock = LLVMBuildLoad(builder, clock_ptr, "");
+      clock = LLVMBuildAdd(builder, clock, lp_build_const_int32(gallivm, 1), "");
+      LLVMBuildStore(builder, clock, clock_ptr);
+      tag = LLVMBuildGEP(builder, tags, &index, 1, "");
+      LLVMBuildStore(builder, clock,
+                     lp_build_struct_get_ptr(gallivm, tag,
+                                             TAG_MEMBER_LAST_USE,
+                                             "last_use"));
+
+      tmp = LLVMBuildMul(builder, index,
+                         lp_build_const_int32(gallivm, TILE_SIZE * TILE_SIZE),
+                         "");
+      tmp = LLVMBuildAdd(builder, tmp, texel, "");
+      LLVMBuildStore(builder, lp_build_pointer_get(builder, data, tmp),
+                     texel_ptr);
    }
+   lp_build_else(&if_ctx);
+   {
+      LLVMBuildStore(builder,
+                     call_fetch_texel_miss(gallivm, format_desc, cache,
+                                           generation, block, i, j),
+                     texel_ptr);
+   }
+   lp_build_endif(&if_ctx);
 
-   tag_value = LLVMBuildPtrToInt(gallivm->builder, ptr_addr,
-                                 LLVMInt64TypeInContext(gallivm->context), "");
-   store_cached_block(gallivm, col, tag_value, hash_index, cache);
+   return LLVMBuildLoad(builder, texel_ptr, "");
 }
 
 
 /*
  * Do a cached lookup.
  *
+ * The tag compare and the load of a hit are done in the generated code,
+ * only misses call into C to decode the block.
+ *
  * Returns (vectors of) 4x8 rgba aos value
  */
 LLVMValueRef
@@ -248,127 +479,92 @@ lp_build_fetch_cached_texels(struct gallivm_state *gallivm,
                              LLVMValueRef offset,
                              LLVMValueRef i,
                              LLVMValueRef j,
-                             LLVMValueRef cache)
+                             LLVMValueRef cache,
+                             LLVMValueRef cache_generation)
 
 {
    LLVMBuilderRef builder = gallivm->builder;
-   unsigned count, low_bit, log2size;
-   LLVMValueRef color, offset_stored, addr, ptr_addrtrunc, tmp;
-   LLVMValueRef ij_index, hash_index, hash_mask, block_index;
    LLVMTypeRef i8t = LLVMInt8TypeInContext(gallivm->context);
    LLVMTypeRef i32t = LLVMInt32TypeInContext(gallivm->context);
    LLVMTypeRef i64t = LLVMInt64TypeInContext(gallivm->context);
-   struct lp_type type;
-   struct lp_build_context bld32;
-   memset(&type, 0, sizeof type);
-   type.width = 32;
-   type.length = n;
-
-   assert(format_desc->block.width == 4);
-   assert(format_desc->block.height == 4);
-
-   lp_build_context_init(&bld32, gallivm, type);
-
-   /*
-    * compute hash - we use direct mapped cache, the hash function could
-    *                be better but it needs to be simple
-    * per-element:
-    *    compare offset with offset stored at tag (hash)
-    *    if not equal decode/store block, update tag
-    *    extract color from cache
-    *    assemble result vector
-    */
-
-   /* TODO: not ideal with 32bit pointers... */
-
-   low_bit = util_logbase2(format_desc->block.bits / 8);
-   log2size = util_logbase2(LP_BUILD_FORMAT_CACHE_SIZE);
-   addr = LLVMBuildPtrToInt(builder, base_ptr, i64t, "");
-   ptr_addrtrunc = LLVMBuildPtrToInt(builder, base_ptr, i32t, "");
-   ptr_addrtrunc = lp_build_broadcast_scalar(&bld32, ptr_addrtrunc);
-   /* For the hash function, first mask off the unused lowest bits. Then just
-      do some xor with address bits - only use lower 32bits */
-   ptr_addrtrunc = LLVMBuildAdd(builder, offset, ptr_addrtrunc, "");
-   ptr_addrtrunc = LLVMBuildLShr(builder, ptr_addrtrunc,
-                                 lp_build_const_int_vec(gallivm, type, low_bit), "");
-   /* This only really makes sense for size 64,128,256 */
-   hash_index = ptr_addrtrunc;
-   ptr_addrtrunc = LLVMBuildLShr(builder, ptr_addrtrunc,
-                                 lp_build_const_int_vec(gallivm, type, 2*log2size), "");
-   hash_index = LLVMBuildXor(builder, ptr_addrtrunc, hash_index, "");
-   tmp = LLVMBuildLShr(builder, hash_index,
-                       lp_build_const_int_vec(gallivm, type, log2size), "");
-   hash_index = LLVMBuildXor(builder, hash_index, tmp, "");
-
-   hash_mask = lp_build_const_int_vec(gallivm, type, LP_BUILD_FORMAT_CACHE_SIZE - 1);
-   hash_index = LLVMBuildAnd(builder, hash_index, hash_mask, "");
-   ij_index = LLVMBuildShl(builder, i, lp_build_const_int_vec(gallivm, type, 2), "");
-   ij_index = LLVMBuildAdd(builder, ij_index, j, "");
-   block_index = LLVMBuildShl(builder, hash_index,
-                              lp_build_const_int_vec(gallivm, type, 4), "");
-   block_index = LLVMBuildAdd(builder, ij_index, block_index, "");
-
-   if (n > 1) {
-      color = LLVMGetUndef(LLVMVectorType(i32t, n));
-      for (count = 0; count < n; count++) {
-         LLVMValueRef index, cond, colorx;
-         LLVMValueRef block_indexx, hash_indexx, addrx, offsetx, ptr_addrx;
-         struct lp_build_if_state if_ctx;
+   LLVMTypeRef color_type = n > 1 ? LLVMVectorType(i32t, n) : i32t;
+   LLVMValueRef blocks[LP_MAX_VECTOR_LENGTH];
+   LLVMValueRef is[LP_MAX_VECTOR_LENGTH], js[LP_MAX_VECTOR_LENGTH];
+   LLVMValueRef color_ptr, color, cache_ptr;
+   struct lp_build_if_state if_ctx;
+   unsigned count;
 
-         index = lp_build_const_int32(gallivm, count);
+   assert(lp_build_format_cacheable(format_desc));
+   assert(n <= LP_MAX_VECTOR_LENGTH);
+
+   for (count = 0; count < n; count++) {
+      LLVMValueRef offsetx = offset;
+
+      is[count] = i;
+      js[count] = j;
+      if (n > 1) {
+         LLVMValueRef index = lp_build_const_int32(gallivm, count);
          offsetx = LLVMBuildExtractElement(builder, offset, index, "");
-         addrx = LLVMBuildZExt(builder, offsetx, i64t, "");
-         addrx = LLVMBuildAdd(builder, addrx, addr, "");
-         block_indexx = LLVMBuildExtractElement(builder, block_index, index, "");
-         hash_indexx = LLVMBuildLShr(builder, block_indexx,
-                                     lp_build_const_int32(gallivm, 4), "");
-         offset_stored = lookup_tag_data(gallivm, cache, hash_indexx);
-         cond = LLVMBuildICmp(builder, LLVMIntNE, offset_stored, addrx, "");
-
-         lp_build_if(&if_ctx, gallivm, cond);
-         {
-            ptr_addrx = LLVMBuildIntToPtr(builder, addrx,
-                                          LLVMPointerType(i8t, 0), "");
-            update_cached_block(gallivm, format_desc, ptr_addrx, hash_indexx, cache);
-#if LP_BUILD_FORMAT_CACHE_DEBUG
-            update_cache_access(gallivm, cache, 1,
-                                LP_BUILD_FORMAT_CACHE_MEMBER_ACCESS_MISS);
-#endif
-         }
-         lp_build_endif(&if_ctx);
+         is[count] = LLVMBuildExtractElement(builder, i, index, "");
+         js[count] = LLVMBuildExtractElement(builder, j, index, "");
+      }
+      blocks[count] = LLVMBuildGEP(builder, base_ptr, &offsetx, 1, "block");
+   }
 
-         colorx = lookup_cached_pixel(gallivm, cache, block_indexx);
+   color_ptr = lp_build_alloca(gallivm, color_type, "color");
+   cache_ptr = LLVMBuildBitCast(builder, cache,
+                                LLVMPointerType(cache_type(gallivm), 0), "");
 
-         color = LLVMBuildInsertElement(builder, color, colorx,
-                                        lp_build_const_int32(gallivm, count), "");
+   /* Without a cache every texel is decoded on its own. */
+   lp_build_if(&if_ctx, gallivm, LLVMBuildIsNotNull(builder, cache, ""));
+   {
+      LLVMValueRef set_bits, tags, data, total_ptr, total;
+
+      set_bits = lp_build_struct_get(gallivm, cache_ptr,
+                                     CACHE_MEMBER_SET_BITS, "set_bits");
+      tags = lp_build_struct_get(gallivm, cache_ptr, CACHE_MEMBER_TAGS,
+                                 "tags");
+      data = lp_build_struct_get(gallivm, cache_ptr, CACHE_MEMBER_DATA,
+                                 "data");
+
+      color = LLVMGetUndef(color_type);
+      for (count = 0; count < n; count++) {
+         LLVMValueRef texel;
+
+         texel = fetch_cached_texel(gallivm, format_desc, cache_ptr,
+                                    set_bits, tags, data, cache_generation,
+                                    blocks[count], is[count], js[count]);
+         color = n > 1 ? LLVMBuildInsertElement(builder, color, texel,
+                                                lp_build_const_int32(gallivm, count),
+                                                "") : texel;
       }
+      LLVMBuildStore(builder, color, color_ptr);
+
+      total_ptr = lp_build_struct_get_ptr(gallivm, cache_ptr,
+                                          CACHE_MEMBER_ACCESS_TOTAL,
+                                          "access_total");
+      total = LLVMBuildLoad(builder, total_ptr, "");
+      total = LLVMBuildAdd(builder, total, LLVMConstInt(i64t, n, 0), "");
+      LLVMBuildStore(builder, total, total_ptr);
    }
-   else {
-      LLVMValueRef cond;
-      struct lp_build_if_state if_ctx;
-
-      tmp = LLVMBuildZExt(builder, offset, i64t, "");
-      addr = LLVMBuildAdd(builder, tmp, addr, "");
-      offset_stored = lookup_tag_data(gallivm, cache, hash_index);
-      cond = LLVMBuildICmp(builder, LLVMIntNE, offset_stored, addr, "");
-
-      lp_build_if(&if_ctx, gallivm, cond);
-      {
-         tmp = LLVMBuildIntToPtr(builder, addr, LLVMPointerType(i8t, 0), "");
-         update_cached_block(gallivm, format_desc, tmp, hash_index, cache);
-#if LP_BUILD_FORMAT_CACHE_DEBUG
-         update_cache_access(gallivm, cache, 1,
-                             LP_BUILD_FORMAT_CACHE_MEMBER_ACCESS_MISS);
-#endif
+   lp_build_else(&if_ctx);
+   {
+      color = LLVMGetUndef(color_type);
+      for (count = 0; count < n; count++) {
+         LLVMValueRef texel;
+
+         texel = call_fetch_texel_miss(gallivm, format_desc, cache,
+                                       cache_generation, blocks[count],
+                                       is[count], js[count]);
+         color = n > 1 ? LLVMBuildInsertElement(builder, color, texel,
+                                                lp_build_const_int32(gallivm, count),
+                                                "") : texel;
       }
-      lp_build_endif(&if_ctx);
-
-      color = lookup_cached_pixel(gallivm, cache, block_index);
+      LLVMBuildStore(builder, color, color_ptr);
    }
-#if LP_BUILD_FORMAT_CACHE_DEBUG
-   update_cache_access(gallivm, cache, n,
-                       LP_BUILD_FORMAT_CACHE_MEMBER_ACCESS_TOTAL);
-#endif
-   return LLVMBuildBitCast(builder, color, LLVMVectorType(i8t, n * 4), "");
-}
+   lp_build_endif(&if_ctx);
 
+   return LLVMBuildBitCast(builder,
+                           LLVMBuildLoad(builder, color_ptr, ""),
+                           LLVMVectorType(i8t, n * 4), "");
+}
@@ -347,6 +347,8 @@ lp_build_rgba8_to_fi32_soa(struct gallivm_state *gallivm,
  *              these will always be (0,0).  For compressed formats, i will
  *              be in [0, block_width-1] and j will be in [0, block_height-1].
  * \param cache  optional value pointing to a lp_build_format_cache structure
+ * \param cache_generation  contents generation of the texture, used to tag
+ *                          the cache entries
  */
 void
 lp_build_fetch_rgba_soa(struct gallivm_state *gallivm,
@@ -357,6 +359,7 @@ lp_build_fetch_rgba_soa(struct gallivm_state *gallivm,
                         LLVMValueRef i,
                         LLVMValueRef j,
                         LLVMValueRef cache,
+                        LLVMValueRef cache_generation,
                         LLVMValueRef rgba_out[4])
 {
    LLVMBuilderRef builder = gallivm->builder;
@@ -475,7 +478,8 @@ lp_build_fetch_rgba_soa(struct gallivm_state *gallivm,
       tmp_type.norm = TRUE;
 
       tmp = lp_build_fetch_rgba_aos(gallivm, format_desc, tmp_type,
-                                    TRUE, base_ptr, offset, i, j, cache);
+                                    TRUE, base_ptr, offset, i, j,
+                                    cache, cache_generation);
 
       lp_build_rgba8_to_fi32_soa(gallivm,
                                 type,
@@ -485,12 +489,11 @@ lp_build_fetch_rgba_soa(struct gallivm_state *gallivm,
       return;
    }
 
-   if (format_desc->layout == UTIL_FORMAT_LAYOUT_S3TC &&
+   if (cache && lp_build_format_cacheable(format_desc) &&
        /* non-srgb case is already handled above */
        format_desc->colorspace == UTIL_FORMAT_COLORSPACE_SRGB &&
        type.floating && type.width == 32 &&
-       (type.length == 1 || (type.length % 4 == 0)) &&
-       cache) {
+       (type.length == 1 || (type.length % 4 == 0))) {
       const struct util_format_description *format_decompressed;
       const struct util_format_description *flinear_desc;
       LLVMValueRef packed;
@@ -501,7 +504,7 @@ lp_build_fetch_rgba_soa(struct gallivm_state *gallivm,
                                             base_ptr,
                                             offset,
                                             i, j,
-                                            cache);
+                                            cache, cache_generation);
       packed = LLVMBuildBitCast(builder, packed,
                                 lp_build_int_vec_type(gallivm, type), "");
       /*
@@ -559,7 +562,8 @@ lp_build_fetch_rgba_soa(struct gallivm_state *gallivm,
          /* Get a single float[4]={R,G,B,A} pixel */
          tmp = lp_build_fetch_rgba_aos(gallivm, format_desc, tmp_type,
                                        TRUE, base_ptr, offset_elem,
-                                       i_elem, j_elem, cache);
+                                       i_elem, j_elem,
+                                       cache, cache_generation);
 
          /*
           * Insert the AoS tmp value channels into the SoA result vectors at
@@ -1983,6 +1983,13 @@ lp_build_sample_partial_offset(struct lp_build_context *bld,
    if (block_length == 1) {
       subcoord = bld->zero;
    }
+   else if (!util_is_power_of_two(block_length)) {
+      /* ASTC blocks can be 5, 6, 10 or 12 pixels wide. */
+      LLVMValueRef block_width = lp_build_const_int_vec(bld->gallivm, bld->type,
+                                                        block_length);
+      subcoord = LLVMBuildURem(builder, coord, block_width, "");
+      coord    = LLVMBuildUDiv(builder, coord, block_width, "");
+   }
    else {
       /*
        * Pixel blocks have power of two dimensions. LLVM should convert the
@@ -292,6 +292,18 @@ struct lp_sampler_dynamic_state
                 struct gallivm_state *gallivm,
                 LLVMValueRef thread_data_ptr,
                 unsigned unit);
+
+   /**
+    * Obtain texture contents generation (returns int32), which tags the
+    * texture cache entries.
+    *
+    * Must be provided together with cache_ptr.
+    */
+   LLVMValueRef
+   (*generation)(const struct lp_sampler_dynamic_state *state,
+                 struct gallivm_state *gallivm,
+                 LLVMValueRef context_ptr,
+                 unsigned texture_unit);
 };
 
 
@@ -382,6 +394,7 @@ struct lp_build_sample_context
    LLVMValueRef base_ptr;
    LLVMValueRef mip_offsets;
    LLVMValueRef cache;
+   LLVMValueRef cache_generation;
 
    /** Integer vector with texture width, height, depth */
    LLVMValueRef int_size;
@@ -605,7 +605,7 @@ lp_build_sample_fetch_image_nearest(struct lp_build_sample_context *bld,
                                       data_ptr, offset,
                                       x_subcoord,
                                       y_subcoord,
-                                      bld->cache);
+                                      bld->cache, bld->cache_generation);
    }
 
    *colors = rgba8;
@@ -946,7 +946,8 @@ lp_build_sample_fetch_image_linear(struct lp_build_sample_context *bld,
                                                data_ptr, offset[k][j][i],
                                                x_subcoord[i],
                                                y_subcoord[j],
-                                               bld->cache);
+                                               bld->cache,
+                                               bld->cache_generation);
             }
 
             neighbors[k][j][i] = rgba8;
@@ -161,7 +161,7 @@ lp_build_sample_texel_soa(struct lp_build_sample_context *bld,
                            bld->texel_type,
                            data_ptr, offset,
                            i, j,
-                           bld->cache,
+                           bld->cache, bld->cache_generation,
                            texel_out);
 
    /*
@@ -2056,8 +2056,9 @@ lp_build_clamp_border_color(struct lp_build_sample_context *bld,
    }
    else {
       /* cannot figure this out from format description */
-      if (format_desc->layout == UTIL_FORMAT_LAYOUT_S3TC) {
-         /* s3tc formats are always unorm */
+      if (format_desc->layout == UTIL_FORMAT_LAYOUT_S3TC ||
+          format_desc->layout == UTIL_FORMAT_LAYOUT_ASTC) {
+         /* s3tc and astc ldr formats are always unorm */
          min_clamp = vec4_bld.zero;
          max_clamp = vec4_bld.one;
       }
@@ -2408,7 +2409,7 @@ lp_build_fetch_texel(struct lp_build_sample_context *bld,
                            bld->texel_type,
                            bld->base_ptr, offset,
                            i, j,
-                           bld->cache,
+                           bld->cache, bld->cache_generation,
                            colors_out);
 
    if (out_of_bound_ret_zero) {
@@ -2731,6 +2732,9 @@ lp_build_sample_soa_code(struct gallivm_state *gallivm,
    if (dynamic_state->cache_ptr && thread_data_ptr) {
       bld.cache = dynamic_state->cache_ptr(dynamic_state, gallivm,
                                            thread_data_ptr, texture_index);
+      bld.cache_generation = dynamic_state->generation(dynamic_state, gallivm,
+                                                       context_ptr,
+                                                       texture_index);
    }
 
    /* width, height, depth as single int vector */
@@ -2910,6 +2914,7 @@ lp_build_sample_soa_code(struct gallivm_state *gallivm,
          bld4.mip_offsets = bld.mip_offsets;
          bld4.int_size = bld.int_size;
          bld4.cache = bld.cache;
+         bld4.cache_generation = bld.cache_generation;
 
          bld4.vector_width = lp_type_width(type4);
 
@@ -3126,7 +3131,7 @@ lp_build_sample_gen_func(struct gallivm_state *gallivm,
    if (dynamic_state->cache_ptr) {
       const struct util_format_description *format_desc;
       format_desc = util_format_description(static_texture_state->format);
-      if (format_desc && format_desc->layout == UTIL_FORMAT_LAYOUT_S3TC) {
+      if (format_desc && lp_build_format_cacheable(format_desc)) {
          need_cache = TRUE;
       }
    }
@@ -3241,11 +3246,7 @@ lp_build_sample_soa_func(struct gallivm_state *gallivm,
    if (dynamic_state->cache_ptr) {
       const struct util_format_description *format_desc;
       format_desc = util_format_description(static_texture_state->format);
-      if (format_desc && format_desc->layout == UTIL_FORMAT_LAYOUT_S3TC) {
-         /*
-          * This is not 100% correct, if we have cache but the
-          * util_format_s3tc_prefer is true the cache won't get used
-          * regardless (could hook up the block decode there...) */
+      if (format_desc && lp_build_format_cacheable(format_desc)) {
          need_cache = TRUE;
       }
    }
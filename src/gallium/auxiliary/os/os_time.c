@@ -49,38 +49,6 @@
 #include "os_time.h"
 
 
-int64_t
-os_time_get_nano(void)
-{
-#if defined(PIPE_OS_LINUX)
-
-   struct timespec tv;
-   clock_gettime(CLOCK_MONOTONIC, &tv);
-   return tv.tv_nsec + tv.tv_sec*INT64_C(1000000000);
-
-#elif defined(PIPE_OS_UNIX)
-
-   struct timeval tv;
-   gettimeofday(&tv, NULL);
-   return tv.tv_usec*INT64_C(1000) + tv.tv_sec*INT64_C(1000000000);
-
-#elif defined(PIPE_SUBSYSTEM_WINDOWS_USER)
-
-   static LARGE_INTEGER frequency;
-   LARGE_INTEGER counter;
-   if(!frequency.QuadPart)
-      QueryPerformanceFrequency(&frequency);
-   QueryPerformanceCounter(&counter);
-   return counter.QuadPart*INT64_C(1000000000)/frequency.QuadPart;
-
-#else
-
-#error Unsupported OS
-
-#endif
-}
-
-
 #if defined(PIPE_SUBSYSTEM_WINDOWS_USER)
 
 void
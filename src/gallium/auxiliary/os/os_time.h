@@ -43,6 +43,7 @@
 #endif
 
 #include "pipe/p_compiler.h"
+#include "util/os_time.h"
 
 
 #ifdef __cplusplus
@@ -50,13 +51,6 @@ extern "C" {
 #endif
 
 
-/*
- * Get the current time in nanoseconds from an unknown base.
- */
-int64_t
-os_time_get_nano(void);
-
-
 /*
  * Get the current time in microseconds from an unknown base.
  */
@@ -536,6 +536,9 @@ util_format_fits_8unorm(const struct util_format_description *format_desc)
       if (format_desc->format == PIPE_FORMAT_BPTC_RGBA_UNORM)
          return TRUE;
       return FALSE;
+   case UTIL_FORMAT_LAYOUT_ASTC:
+      /* Only the LDR profile is decoded. */
+      return TRUE;
 
    case UTIL_FORMAT_LAYOUT_PLAIN:
       /*
@@ -565,6 +568,7 @@ util_format_fits_8unorm(const struct util_format_description *format_desc)
 
       switch (format_desc->format) {
       case PIPE_FORMAT_R1_UNORM:
+      case PIPE_FORMAT_ETC1_RGB8:
       case PIPE_FORMAT_UYVY:
       case PIPE_FORMAT_YUYV:
       case PIPE_FORMAT_R8G8_B8G8_UNORM:
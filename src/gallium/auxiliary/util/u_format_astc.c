@@ -0,0 +1,222 @@
+/**************************************************************************
+ *
+ * Copyright 2016 Intel Corporation
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDERS, AUTHORS AND/OR ITS SUPPLIERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ **************************************************************************/
+
+
+#include "pipe/p_compiler.h"
+#include "util/u_debug.h"
+#include "util/u_math.h"
+#include "u_format_astc.h"
+#include "util/astc.h"
+#include "util/format_srgb.h"
+
+static inline void
+astc_unpack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride,
+                        const uint8_t *src_row, unsigned src_stride,
+                        unsigned width, unsigned height,
+                        unsigned bw, unsigned bh, boolean srgb)
+{
+   uint8_t tmp[UTIL_ASTC_MAX_BLOCK_HEIGHT][UTIL_ASTC_MAX_BLOCK_WIDTH][4];
+   unsigned x, y, i, j;
+
+   for (y = 0; y < height; y += bh) {
+      const uint8_t *src = src_row;
+
+      for (x = 0; x < width; x += bw) {
+         util_format_astc_decode_block(&tmp[0][0][0], sizeof(tmp[0]), src,
+                                       bw, bh, srgb);
+
+         for (j = 0; j < bh && y + j < height; j++) {
+            uint8_t *dst = dst_row + (y + j) * dst_stride + x * 4;
+
+            for (i = 0; i < bw && x + i < width; i++) {
+               if (srgb) {
+                  dst[0] = util_format_srgb_to_linear_8unorm(tmp[j][i][0]);
+                  dst[1] = util_format_srgb_to_linear_8unorm(tmp[j][i][1]);
+                  dst[2] = util_format_srgb_to_linear_8unorm(tmp[j][i][2]);
+                  dst[3] = tmp[j][i][3];
+               } else {
+                  memcpy(dst, tmp[j][i], 4);
+               }
+               dst += 4;
+            }
+         }
+
+         src += UTIL_ASTC_BLOCK_SIZE;
+      }
+
+      src_row += src_stride;
+   }
+}
+
+static inline void
+astc_unpack_rgba_float(float *dst_row, unsigned dst_stride,
+                       const uint8_t *src_row, unsigned src_stride,
+                       unsigned width, unsigned height,
+                       unsigned bw, unsigned bh, boolean srgb)
+{
+   uint8_t tmp[UTIL_ASTC_MAX_BLOCK_HEIGHT][UTIL_ASTC_MAX_BLOCK_WIDTH][4];
+   unsigned x, y, i, j;
+
+   for (y = 0; y < height; y += bh) {
+      const uint8_t *src = src_row;
+
+      for (x = 0; x < width; x += bw) {
+         util_format_astc_decode_block(&tmp[0][0][0], sizeof(tmp[0]), src,
+                                       bw, bh, srgb);
+
+         for (j = 0; j < bh && y + j < height; j++) {
+            float *dst = dst_row + (y + j) * dst_stride / sizeof(*dst_row) +
+                         x * 4;
+
+            for (i = 0; i < bw && x + i < width; i++) {
+               if (srgb) {
+                  dst[0] = util_format_srgb_8unorm_to_linear_float(tmp[j][i][0]);
+                  dst[1] = util_format_srgb_8unorm_to_linear_float(tmp[j][i][1]);
+                  dst[2] = util_format_srgb_8unorm_to_linear_float(tmp[j][i][2]);
+               } else {
+                  dst[0] = ubyte_to_float(tmp[j][i][0]);
+                  dst[1] = ubyte_to_float(tmp[j][i][1]);
+                  dst[2] = ubyte_to_float(tmp[j][i][2]);
+               }
+               dst[3] = ubyte_to_float(tmp[j][i][3]);
+               dst += 4;
+            }
+         }
+
+         src += UTIL_ASTC_BLOCK_SIZE;
+      }
+
+      src_row += src_stride;
+   }
+}
+
+static inline void
+astc_fetch_rgba_8unorm(uint8_t *dst, const uint8_t *src,
+                       unsigned i, unsigned j,
+                       unsigned bw, unsigned bh, boolean srgb)
+{
+   util_format_astc_fetch_texel(dst, src, bw, bh, srgb, i, j);
+
+   if (srgb) {
+      dst[0] = util_format_srgb_to_linear_8unorm(dst[0]);
+      dst[1] = util_format_srgb_to_linear_8unorm(dst[1]);
+      dst[2] = util_format_srgb_to_linear_8unorm(dst[2]);
+   }
+}
+
+static inline void
+astc_fetch_rgba_float(float *dst, const uint8_t *src,
+                      unsigned i, unsigned j,
+                      unsigned bw, unsigned bh, boolean srgb)
+{
+   uint8_t tmp[4];
+
+   util_format_astc_fetch_texel(tmp, src, bw, bh, srgb, i, j);
+
+   if (srgb) {
+      dst[0] = util_format_srgb_8unorm_to_linear_float(tmp[0]);
+      dst[1] = util_format_srgb_8unorm_to_linear_float(tmp[1]);
+      dst[2] = util_format_srgb_8unorm_to_linear_float(tmp[2]);
+   } else {
+      dst[0] = ubyte_to_float(tmp[0]);
+      dst[1] = ubyte_to_float(tmp[1]);
+      dst[2] = ubyte_to_float(tmp[2]);
+   }
+   dst[3] = ubyte_to_float(tmp[3]);
+}
+
+#define U_FORMAT_ASTC(name, bw, bh, srgb)                                     \
+void                                                                          \
+util_format_##name##_unpack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride, \
+                                        const uint8_t *src_row,               \
+                                        unsigned src_stride,                  \
+                                        unsigned width, unsigned height)      \
+{                                                                             \
+   astc_unpack_rgba_8unorm(dst_row, dst_stride, src_row, src_stride,          \
+                           width, height, bw, bh, srgb);                      \
+}                                                                             \
+                                                                              \
+void                                                                          \
+util_format_##name##_pack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride,  \
+                                      const uint8_t *src_row,                 \
+                                      unsigned src_stride,                    \
+                                      unsigned width, unsigned height)        \
+{                                                                             \
+   assert(0);                                                                 \
+}                                                                             \
+                                                                              \
+void                                                                          \
+util_format_##name##_fetch_rgba_8unorm(uint8_t *dst, const uint8_t *src,      \
+                                       unsigned i, unsigned j)                \
+{                                                                             \
+   astc_fetch_rgba_8unorm(dst, src, i, j, bw, bh, srgb);                      \
+}                                                                             \
+                                                                              \
+void                                                                          \
+util_format_##name##_unpack_rgba_float(float *dst_row, unsigned dst_stride,   \
+                                       const uint8_t *src_row,                \
+                                       unsigned src_stride,                   \
+                                       unsigned width, unsigned height)       \
+{                                                                             \
+   astc_unpack_rgba_float(dst_row, dst_stride, src_row, src_stride,           \
+                          width, height, bw, bh, srgb);                       \
+}                                                                             \
+                                                                              \
+void                                                                          \
+util_format_##name##_pack_rgba_float(uint8_t *dst_row, unsigned dst_stride,   \
+                                     const float *src_row,                    \
+                                     unsigned src_stride,                     \
+                                     unsigned width, unsigned height)         \
+{                                                                             \
+   assert(0);                                                                 \
+}                                                                             \
+                                                                              \
+void                                                                          \
+util_format_##name##_fetch_rgba_float(float *dst, const uint8_t *src,         \
+                                      unsigned i, unsigned j)                 \
+{                                                                             \
+   astc_fetch_rgba_float(dst, src, i, j, bw, bh, srgb);                       \
+}
+
+#define U_FORMAT_ASTC_SIZE(bw, bh)                                 \
+   U_FORMAT_ASTC(astc_##bw##x##bh, bw, bh, FALSE)                  \
+   U_FORMAT_ASTC(astc_##bw##x##bh##_srgb, bw, bh, TRUE)
+
+U_FORMAT_ASTC_SIZE(4, 4)
+U_FORMAT_ASTC_SIZE(5, 4)
+U_FORMAT_ASTC_SIZE(5, 5)
+U_FORMAT_ASTC_SIZE(6, 5)
+U_FORMAT_ASTC_SIZE(6, 6)
+U_FORMAT_ASTC_SIZE(8, 5)
+U_FORMAT_ASTC_SIZE(8, 6)
+U_FORMAT_ASTC_SIZE(8, 8)
+U_FORMAT_ASTC_SIZE(10, 5)
+U_FORMAT_ASTC_SIZE(10, 6)
+U_FORMAT_ASTC_SIZE(10, 8)
+U_FORMAT_ASTC_SIZE(10, 10)
+U_FORMAT_ASTC_SIZE(12, 10)
+U_FORMAT_ASTC_SIZE(12, 12)
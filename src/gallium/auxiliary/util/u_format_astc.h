@@ -0,0 +1,91 @@
+/**************************************************************************
+ *
+ * Copyright 2016 Intel Corporation
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDERS, AUTHORS AND/OR ITS SUPPLIERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ **************************************************************************/
+
+#ifndef U_FORMAT_ASTC_H_
+#define U_FORMAT_ASTC_H_
+
+#include "pipe/p_compiler.h"
+
+/*
+ * Only decoding is supported; the pack functions must not be called.
+ */
+#define U_FORMAT_ASTC_DECLARE(name)                                           \
+void                                                                          \
+util_format_##name##_unpack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride, \
+                                        const uint8_t *src_row,               \
+                                        unsigned src_stride,                  \
+                                        unsigned width, unsigned height);     \
+                                                                              \
+void                                                                          \
+util_format_##name##_pack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride,  \
+                                      const uint8_t *src_row,                 \
+                                      unsigned src_stride,                    \
+                                      unsigned width, unsigned height);       \
+                                                                              \
+void                                                                          \
+util_format_##name##_fetch_rgba_8unorm(uint8_t *dst, const uint8_t *src,      \
+                                       unsigned i, unsigned j);               \
+                                                                              \
+void                                                                          \
+util_format_##name##_unpack_rgba_float(float *dst_row, unsigned dst_stride,   \
+                                       const uint8_t *src_row,                \
+                                       unsigned src_stride,                   \
+                                       unsigned width, unsigned height);      \
+                                                                              \
+void                                                                          \
+util_format_##name##_pack_rgba_float(uint8_t *dst_row, unsigned dst_stride,   \
+                                     const float *src_row,                    \
+                                     unsigned src_stride,                     \
+                                     unsigned width, unsigned height);        \
+                                                                              \
+void                                                                          \
+util_format_##name##_fetch_rgba_float(float *dst, const uint8_t *src,         \
+                                      unsigned i, unsigned j);
+
+#define U_FORMAT_ASTC_DECLARE_SIZE(bw, bh)          \
+   U_FORMAT_ASTC_DECLARE(astc_##bw##x##bh)          \
+   U_FORMAT_ASTC_DECLARE(astc_##bw##x##bh##_srgb)
+
+U_FORMAT_ASTC_DECLARE_SIZE(4, 4)
+U_FORMAT_ASTC_DECLARE_SIZE(5, 4)
+U_FORMAT_ASTC_DECLARE_SIZE(5, 5)
+U_FORMAT_ASTC_DECLARE_SIZE(6, 5)
+U_FORMAT_ASTC_DECLARE_SIZE(6, 6)
+U_FORMAT_ASTC_DECLARE_SIZE(8, 5)
+U_FORMAT_ASTC_DECLARE_SIZE(8, 6)
+U_FORMAT_ASTC_DECLARE_SIZE(8, 8)
+U_FORMAT_ASTC_DECLARE_SIZE(10, 5)
+U_FORMAT_ASTC_DECLARE_SIZE(10, 6)
+U_FORMAT_ASTC_DECLARE_SIZE(10, 8)
+U_FORMAT_ASTC_DECLARE_SIZE(10, 10)
+U_FORMAT_ASTC_DECLARE_SIZE(12, 10)
+U_FORMAT_ASTC_DECLARE_SIZE(12, 12)
+
+#undef U_FORMAT_ASTC_DECLARE_SIZE
+#undef U_FORMAT_ASTC_DECLARE
+
+#endif /* U_FORMAT_ASTC_H_ */
@@ -27,6 +27,7 @@
 #include "u_math.h"
 #include "u_format.h"
 #include "u_format_s3tc.h"
+#include "util/dxtn.h"
 #include "util/format_srgb.h"
 
 
@@ -79,15 +80,39 @@ util_format_dxt5_rgba_fetch_stub(int src_stride,
 }
 
 
+static enum util_dxtn_format
+util_format_dxtn_to_encoder_format(enum util_format_dxtn format)
+{
+   switch (format) {
+   case UTIL_FORMAT_DXT1_RGB:
+      return UTIL_DXTN_DXT1_RGB;
+   case UTIL_FORMAT_DXT1_RGBA:
+      return UTIL_DXTN_DXT1_RGBA;
+   case UTIL_FORMAT_DXT3_RGBA:
+      return UTIL_DXTN_DXT3_RGBA;
+   case UTIL_FORMAT_DXT5_RGBA:
+   default:
+      return UTIL_DXTN_DXT5_RGBA;
+   }
+}
+
+
+/**
+ * Compression doesn't need libtxc_dxtn: it's done by the encoder in
+ * util/dxtn.c.
+ */
 static void
-util_format_dxtn_pack_stub(int src_comps,
-                           int width, int height,
-                           const uint8_t *src,
-                           enum util_format_dxtn dst_format,
-                           uint8_t *dst,
-                           int dst_stride)
+util_format_dxtn_pack_builtin(int src_comps,
+                              int width, int height,
+                              const uint8_t *src,
+                              enum util_format_dxtn dst_format,
+                              uint8_t *dst,
+                              int dst_stride)
 {
-   assert(0);
+   util_format_encode_dxtn(util_format_dxtn_to_encoder_format(dst_format),
+                           util_format_dxtn_quality(),
+                           src, src_comps, width * src_comps,
+                           width, height, dst, dst_stride);
 }
 
 
@@ -98,7 +123,7 @@ util_format_dxtn_fetch_t util_format_dxt1_rgba_fetch = util_format_dxt1_rgba_fet
 util_format_dxtn_fetch_t util_format_dxt3_rgba_fetch = util_format_dxt3_rgba_fetch_stub;
 util_format_dxtn_fetch_t util_format_dxt5_rgba_fetch = util_format_dxt5_rgba_fetch_stub;
 
-util_format_dxtn_pack_t util_format_dxtn_pack = util_format_dxtn_pack_stub;
+util_format_dxtn_pack_t util_format_dxtn_pack = util_format_dxtn_pack_builtin;
 
 
 void
@@ -110,7 +135,6 @@ util_format_s3tc_init(void)
    util_dl_proc fetch_2d_texel_rgba_dxt1;
    util_dl_proc fetch_2d_texel_rgba_dxt3;
    util_dl_proc fetch_2d_texel_rgba_dxt5;
-   util_dl_proc tx_compress_dxtn;
 
    if (!first_time)
       return;
@@ -122,7 +146,7 @@ util_format_s3tc_init(void)
    library = util_dl_open(DXTN_LIBNAME);
    if (!library) {
       debug_printf("couldn't open " DXTN_LIBNAME ", software DXTn "
-                   "compression/decompression unavailable\n");
+                   "decompression unavailable\n");
       return;
    }
 
@@ -134,16 +158,13 @@ util_format_s3tc_init(void)
          util_dl_get_proc_address(library, "fetch_2d_texel_rgba_dxt3");
    fetch_2d_texel_rgba_dxt5 =
          util_dl_get_proc_address(library, "fetch_2d_texel_rgba_dxt5");
-   tx_compress_dxtn =
-         util_dl_get_proc_address(library, "tx_compress_dxtn");
 
    if (!util_format_dxt1_rgb_fetch ||
        !util_format_dxt1_rgba_fetch ||
        !util_format_dxt3_rgba_fetch ||
-       !util_format_dxt5_rgba_fetch ||
-       !util_format_dxtn_pack) {
+       !util_format_dxt5_rgba_fetch) {
       debug_printf("couldn't reference all symbols in " DXTN_LIBNAME
-                   ", software DXTn compression/decompression "
+                   ", software DXTn decompression "
                    "unavailable\n");
       util_dl_close(library);
       return;
@@ -153,7 +174,6 @@ util_format_s3tc_init(void)
    util_format_dxt1_rgba_fetch = (util_format_dxtn_fetch_t)fetch_2d_texel_rgba_dxt1;
    util_format_dxt3_rgba_fetch = (util_format_dxtn_fetch_t)fetch_2d_texel_rgba_dxt3;
    util_format_dxt5_rgba_fetch = (util_format_dxtn_fetch_t)fetch_2d_texel_rgba_dxt5;
-   util_format_dxtn_pack = (util_format_dxtn_pack_t)tx_compress_dxtn;
    util_format_s3tc_enabled = TRUE;
 }
 
@@ -408,6 +428,9 @@ util_format_dxtn_pack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride,
                                   unsigned block_size, boolean srgb)
 {
    const unsigned bw = 4, bh = 4, comps = 4;
+   const enum util_dxtn_format encoder_format =
+      util_format_dxtn_to_encoder_format(format);
+   const unsigned quality = util_format_dxtn_quality();
    unsigned x, y, i, j, k;
    for(y = 0; y < height; y += bh) {
       uint8_t *dst = dst_row;
@@ -429,8 +452,7 @@ util_format_dxtn_pack_rgba_8unorm(uint8_t *dst_row, unsigned dst_stride,
                tmp[j][i][3] = src[(y + j)*src_stride/sizeof(*src) + (x+i)*comps + 3];
             }
          }
-         /* even for dxt1_rgb have 4 src comps */
-         util_format_dxtn_pack(4, 4, 4, &tmp[0][0][0], format, dst, 0);
+         util_format_encode_dxtn_block(dst, tmp, encoder_format, quality);
          dst += block_size;
       }
       dst_row += dst_stride / sizeof(*dst_row);
@@ -485,6 +507,9 @@ util_format_dxtn_pack_rgba_float(uint8_t *dst_row, unsigned dst_stride,
                                  enum util_format_dxtn format,
                                  unsigned block_size, boolean srgb)
 {
+   const enum util_dxtn_format encoder_format =
+      util_format_dxtn_to_encoder_format(format);
+   const unsigned quality = util_format_dxtn_quality();
    unsigned x, y, i, j, k;
    for(y = 0; y < height; y += 4) {
       uint8_t *dst = dst_row;
@@ -507,7 +532,7 @@ util_format_dxtn_pack_rgba_float(uint8_t *dst_row, unsigned dst_stride,
                tmp[j][i][3] = float_to_ubyte(src_tmp);
             }
          }
-         util_format_dxtn_pack(4, 4, 4, &tmp[0][0][0], format, dst, 0);
+         util_format_encode_dxtn_block(dst, tmp, encoder_format, quality);
          dst += block_size;
       }
       dst_row += 4*dst_stride/sizeof(*dst_row);
@@ -38,6 +38,10 @@
 #include "util/u_gen_mipmap.h"
 #include "util/u_format.h"
 #include "util/u_inlines.h"
+#include "util/u_math.h"
+#include "util/u_memory.h"
+#include "util/u_sse.h"
+#include "util/thread_pool.h"
 
 
 /**
@@ -126,3 +130,309 @@ util_gen_mipmap(struct pipe_context *pipe, struct pipe_resource *pt,
    }
    return TRUE;
 }
+
+
+/*
+ * CPU mipmap generation.
+ */
+
+enum cpu_filter {
+   FILTER_UNORM8,    /**< all channels 8-bit unorm, filtered bytewise */
+   FILTER_FLOAT4,    /**< R32G32B32A32_FLOAT, filtered in place */
+   FILTER_GENERIC    /**< unpacked to and packed from RGBA float */
+};
+
+struct cpu_mipmap_level {
+   const struct util_format_description *desc;
+   enum cpu_filter filter;
+   unsigned src_width, src_height, src_depth;
+   unsigned dst_width, dst_height, dst_depth;
+   const uint8_t *src;
+   unsigned src_stride, src_layer_stride;
+   uint8_t *dst;
+   unsigned dst_stride, dst_layer_stride;
+};
+
+
+/**
+ * Average 2 (2D) or 4 (3D) source rows of 8-bit unorm bytes, two texels
+ * of each when the width is halved.  Rounds to nearest.
+ */
+static void
+filter_row_unorm8(const uint8_t *rows[4], unsigned num_rows,
+                  unsigned bpp, unsigned col_step,
+                  unsigned dst_width, uint8_t *dst)
+{
+   const unsigned div = num_rows * 2;
+   unsigned x = 0, i, r;
+
+#if defined(PIPE_ARCH_SSE)
+   if (num_rows == 2 && bpp == 4 && col_step == 2) {
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i two = _mm_set1_epi16(2);
+
+      for (; x + 4 <= dst_width; x += 4) {
+         const uint8_t *a = rows[0] + x * 8, *b = rows[1] + x * 8;
+         const __m128i a0 = _mm_loadu_si128((const __m128i *) a);
+         const __m128i a1 = _mm_loadu_si128((const __m128i *) (a + 16));
+         const __m128i b0 = _mm_loadu_si128((const __m128i *) b);
+         const __m128i b1 = _mm_loadu_si128((const __m128i *) (b + 16));
+         /* vertical sums, two texels per register */
+         const __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero),
+                                          _mm_unpacklo_epi8(b0, zero));
+         const __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero),
+                                          _mm_unpackhi_epi8(b0, zero));
+         const __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero),
+                                          _mm_unpacklo_epi8(b1, zero));
+         const __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero),
+                                          _mm_unpackhi_epi8(b1, zero));
+         /* add horizontally adjacent texels */
+         __m128i d01 = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1),
+                                     _mm_unpackhi_epi64(s0, s1));
+         __m128i d23 = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3),
+                                     _mm_unpackhi_epi64(s2, s3));
+
+         d01 = _mm_srli_epi16(_mm_add_epi16(d01, two), 2);
+         d23 = _mm_srli_epi16(_mm_add_epi16(d23, two), 2);
+         _mm_storeu_si128((__m128i *) (dst + x * 4),
+                          _mm_packus_epi16(d01, d23));
+      }
+   }
+#endif
+
+   for (i = x * bpp; i < dst_width * bpp; i++) {
+      const unsigned j = (i / bpp) * col_step * bpp + i % bpp;
+      const unsigned k = j + (col_step - 1) * bpp;
+      unsigned sum = num_rows;
+
+      for (r = 0; r < num_rows; r++)
+         sum += rows[r][j] + rows[r][k];
+
+      dst[i] = sum / div;
+   }
+}
+
+
+/**
+ * Average 2 or 4 rows of RGBA float texels.
+ */
+static void
+filter_row_float4(const float *rows[4], unsigned num_rows,
+                  unsigned col_step, unsigned dst_width, float *dst)
+{
+   const unsigned k0 = (col_step - 1) * 4;
+   unsigned x, r;
+
+#if defined(PIPE_ARCH_SSE)
+   const __m128 scale = _mm_set1_ps(1.0f / (num_rows * 2));
+
+   for (x = 0; x < dst_width; x++) {
+      const unsigned j = x * col_step * 4;
+      __m128 sum = _mm_add_ps(_mm_loadu_ps(rows[0] + j),
+                              _mm_loadu_ps(rows[0] + j + k0));
+
+      for (r = 1; r < num_rows; r++) {
+         sum = _mm_add_ps(sum, _mm_loadu_ps(rows[r] + j));
+         sum = _mm_add_ps(sum, _mm_loadu_ps(rows[r] + j + k0));
+      }
+
+      _mm_storeu_ps(dst + x * 4, _mm_mul_ps(sum, scale));
+   }
+#else
+   const float scale = 1.0f / (num_rows * 2);
+   unsigned c;
+
+   for (x = 0; x < dst_width; x++) {
+      const unsigned j = x * col_step * 4;
+
+      for (c = 0; c < 4; c++) {
+         float sum = rows[0][j + c] + rows[0][j + k0 + c];
+
+         for (r = 1; r < num_rows; r++)
+            sum += rows[r][j + c] + rows[r][j + k0 + c];
+
+         dst[x * 4 + c] = sum * scale;
+      }
+   }
+#endif
+}
+
+
+static void
+filter_band(void *data, unsigned image, unsigned first_row,
+            unsigned num_band_rows)
+{
+   const struct cpu_mipmap_level *l = data;
+   const unsigned last_row = first_row + num_band_rows;
+   const unsigned row_step = l->src_height > l->dst_height ? 2 : 1;
+   const unsigned col_step = l->src_width > l->dst_width ? 2 : 1;
+   const unsigned z0 = l->src_depth > l->dst_depth ? image * 2 : image;
+   const unsigned z1 = l->src_depth > l->dst_depth ? image * 2 + 1 : image;
+   const unsigned num_rows = z0 != z1 ? 4 : 2;
+   float *tmp = NULL;
+   unsigned y, r;
+
+   if (l->filter == FILTER_GENERIC) {
+      /* four unpacked source rows and the filtered row */
+      tmp = MALLOC((4 * l->src_width + l->dst_width) * 4 * sizeof(float));
+      if (!tmp)
+         return;
+   }
+
+   for (y = first_row; y < last_row; y++) {
+      const unsigned y0 = y * row_step, y1 = y * row_step + row_step - 1;
+      const uint8_t *rows[4];
+      uint8_t *dst = l->dst + image * l->dst_layer_stride + y * l->dst_stride;
+
+      rows[0] = l->src + z0 * l->src_layer_stride + y0 * l->src_stride;
+      rows[1] = l->src + z0 * l->src_layer_stride + y1 * l->src_stride;
+      rows[2] = l->src + z1 * l->src_layer_stride + y0 * l->src_stride;
+      rows[3] = l->src + z1 * l->src_layer_stride + y1 * l->src_stride;
+
+      switch (l->filter) {
+      case FILTER_UNORM8:
+         filter_row_unorm8(rows, num_rows, l->desc->block.bits / 8,
+                           col_step, l->dst_width, dst);
+         break;
+      case FILTER_FLOAT4:
+         filter_row_float4((const float **) rows, num_rows, col_step,
+                           l->dst_width, (float *) dst);
+         break;
+      case FILTER_GENERIC: {
+         const float *unpacked[4];
+         float *filtered = tmp + 4 * l->src_width * 4;
+
+         for (r = 0; r < num_rows; r++) {
+            float *row = tmp + r * l->src_width * 4;
+
+            l->desc->unpack_rgba_float(row, 0, rows[r], 0, l->src_width, 1);
+            unpacked[r] = row;
+         }
+         filter_row_float4(unpacked, num_rows, col_step, l->dst_width,
+                           filtered);
+         l->desc->pack_rgba_float(dst, 0, filtered, 0, l->dst_width, 1);
+         break;
+      }
+      }
+   }
+
+   FREE(tmp);
+}
+
+
+static boolean
+is_unorm8(const struct util_format_description *desc)
+{
+   unsigned i;
+
+   if (!desc->is_array || desc->colorspace != UTIL_FORMAT_COLORSPACE_RGB)
+      return FALSE;
+
+   for (i = 0; i < desc->nr_channels; i++) {
+      if (desc->channel[i].type != UTIL_FORMAT_TYPE_UNSIGNED ||
+          !desc->channel[i].normalized ||
+          desc->channel[i].size != 8)
+         return FALSE;
+   }
+
+   return TRUE;
+}
+
+
+/**
+ * Generate mipmap images with a box filter running on the CPU.  This is
+ * meant for drivers which render in software, where util_gen_mipmap()
+ * sends every level through the whole rendering pipeline.
+ *
+ * The levels are mapped with transfer_map(), so the driver must be able
+ * to map several levels of \p pt at once.  Levels are generated one after
+ * the other, the images of a level are split into bands of rows that are
+ * filtered on the threads of \p pool, which may be NULL.
+ *
+ * sRGB formats are filtered in linear space.
+ *
+ * \return FALSE if the format or target isn't supported, in which case
+ * nothing was done and util_gen_mipmap() should be used instead.
+ */
+boolean
+util_gen_mipmap_cpu(struct pipe_context *pipe, struct pipe_resource *pt,
+                    enum pipe_format format, uint base_level, uint last_level,
+                    uint first_layer, uint last_layer,
+                    struct thread_pool *pool)
+{
+   const struct util_format_description *desc = util_format_description(format);
+   struct cpu_mipmap_level l;
+   uint level;
+
+   if (!desc ||
+       desc->layout != UTIL_FORMAT_LAYOUT_PLAIN ||
+       desc->colorspace == UTIL_FORMAT_COLORSPACE_ZS ||
+       util_format_is_pure_integer(format) ||
+       !desc->unpack_rgba_float || !desc->pack_rgba_float ||
+       pt->nr_samples > 1 ||
+       pt->target == PIPE_BUFFER)
+      return FALSE;
+
+   assert(last_level <= pt->last_level);
+   assert(last_level > base_level);
+
+   memset(&l, 0, sizeof(l));
+   l.desc = desc;
+   if (is_unorm8(desc))
+      l.filter = FILTER_UNORM8;
+   else if (format == PIPE_FORMAT_R32G32B32A32_FLOAT)
+      l.filter = FILTER_FLOAT4;
+   else
+      l.filter = FILTER_GENERIC;
+
+   if (pt->target == PIPE_TEXTURE_3D) {
+      first_layer = 0;
+      last_layer = 0;
+   }
+
+   for (level = base_level + 1; level <= last_level; level++) {
+      struct pipe_transfer *src_transfer, *dst_transfer;
+
+      l.src_width = u_minify(pt->width0, level - 1);
+      l.src_height = u_minify(pt->height0, level - 1);
+      l.dst_width = u_minify(pt->width0, level);
+      l.dst_height = u_minify(pt->height0, level);
+
+      if (pt->target == PIPE_TEXTURE_3D) {
+         l.src_depth = u_minify(pt->depth0, level - 1);
+         l.dst_depth = u_minify(pt->depth0, level);
+      }
+      else {
+         l.src_depth = l.dst_depth = last_layer + 1 - first_layer;
+      }
+
+      l.src = pipe_transfer_map_3d(pipe, pt, level - 1, PIPE_TRANSFER_READ,
+                                   0, 0, first_layer,
+                                   l.src_width, l.src_height, l.src_depth,
+                                   &src_transfer);
+      if (!l.src)
+         return FALSE;
+
+      l.dst = pipe_transfer_map_3d(pipe, pt, level, PIPE_TRANSFER_WRITE,
+                                   0, 0, first_layer,
+                                   l.dst_width, l.dst_height, l.dst_depth,
+                                   &dst_transfer);
+      if (!l.dst) {
+         pipe_transfer_unmap(pipe, src_transfer);
+         return FALSE;
+      }
+
+      l.src_stride = src_transfer->stride;
+      l.src_layer_stride = src_transfer->layer_stride;
+      l.dst_stride = dst_transfer->stride;
+      l.dst_layer_stride = dst_transfer->layer_stride;
+
+      thread_pool_parallel_rows(pool, l.dst_width, l.dst_height, l.dst_depth,
+                                filter_band, &l);
+
+      pipe_transfer_unmap(pipe, dst_transfer);
+      pipe_transfer_unmap(pipe, src_transfer);
+   }
+
+   return TRUE;
+}
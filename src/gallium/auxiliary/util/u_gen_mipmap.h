@@ -37,12 +37,19 @@ extern "C" {
 
 
 struct pipe_context;
+struct thread_pool;
 
 extern boolean
 util_gen_mipmap(struct pipe_context *pipe, struct pipe_resource *pt,
                 enum pipe_format format, uint base_level, uint last_level,
                 uint first_layer, uint last_layer, uint filter);
 
+extern boolean
+util_gen_mipmap_cpu(struct pipe_context *pipe, struct pipe_resource *pt,
+                    enum pipe_format format, uint base_level, uint last_level,
+                    uint first_layer, uint last_layer,
+                    struct thread_pool *pool);
+
 
 #ifdef __cplusplus
 }
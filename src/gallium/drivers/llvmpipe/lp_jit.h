@@ -59,6 +59,7 @@ struct lp_jit_texture
    uint32_t row_stride[LP_MAX_TEXTURE_LEVELS];
    uint32_t img_stride[LP_MAX_TEXTURE_LEVELS];
    uint32_t mip_offsets[LP_MAX_TEXTURE_LEVELS];
+   uint32_t generation;   /* contents generation, for the block cache */
 };
 
 
@@ -88,6 +89,7 @@ enum {
    LP_JIT_TEXTURE_ROW_STRIDE,
    LP_JIT_TEXTURE_IMG_STRIDE,
    LP_JIT_TEXTURE_MIP_OFFSETS,
+   LP_JIT_TEXTURE_GENERATION,
    LP_JIT_TEXTURE_NUM_FIELDS  /* number of fields above */
 };
 
@@ -55,7 +55,9 @@ llvmpipe_create_query(struct pipe_context *pipe,
 {
    struct llvmpipe_query *pq;
 
-   assert(type < PIPE_QUERY_TYPES);
+   assert(type < PIPE_QUERY_TYPES ||
+          type == LP_QUERY_TEXTURE_CACHE_ACCESSES ||
+          type == LP_QUERY_TEXTURE_CACHE_MISSES);
 
    pq = CALLOC_STRUCT( llvmpipe_query );
 
@@ -120,6 +122,8 @@ llvmpipe_get_query_result(struct pipe_context *pipe,
 
    switch (pq->type) {
    case PIPE_QUERY_OCCLUSION_COUNTER:
+   case LP_QUERY_TEXTURE_CACHE_ACCESSES:
+   case LP_QUERY_TEXTURE_CACHE_MISSES:
       for (i = 0; i < num_threads; i++) {
          *result += pq->end[i];
       }
@@ -41,6 +41,14 @@
 struct llvmpipe_context;
 
 
+/*
+ * Driver queries, counting the texels fetched through the rasterizer
+ * threads' block caches and the compressed blocks decoded on misses.
+ */
+#define LP_QUERY_TEXTURE_CACHE_ACCESSES (PIPE_QUERY_DRIVER_SPECIFIC + 0)
+#define LP_QUERY_TEXTURE_CACHE_MISSES   (PIPE_QUERY_DRIVER_SPECIFIC + 1)
+
+
 struct llvmpipe_query {
    uint64_t start[LP_MAX_THREADS];  /* start count value for each thread */
    uint64_t end[LP_MAX_THREADS];    /* end count value for each thread */
@@ -107,6 +107,10 @@ lp_rast_tile_begin(struct lp_rasterizer_task *task,
 
    task->thread_data.vis_counter = 0;
    task->ps_invocations = 0;
+   if (task->thread_data.cache) {
+      task->thread_data.cache->access_total = 0;
+      task->thread_data.cache->access_miss = 0;
+   }
 
    for (i = 0; i < task->scene->fb.nr_cbufs; i++) {
       if (task->scene->fb.cbufs[i]) {
@@ -472,6 +476,19 @@ lp_rast_shade_quads_mask(struct lp_rasterizer_task *task,
 
 
 
+static uint64_t
+texture_cache_counter(const struct lp_rasterizer_task *task, unsigned type)
+{
+   const struct lp_build_format_cache *cache = task->thread_data.cache;
+
+   if (!cache)
+      return 0;
+
+   return type == LP_QUERY_TEXTURE_CACHE_MISSES ?
+          cache->access_miss : cache->access_total;
+}
+
+
 /**
  * Begin a new occlusion query.
  * This is a bin command put in all bins.
@@ -491,6 +508,10 @@ lp_rast_begin_query(struct lp_rasterizer_task *task,
    case PIPE_QUERY_PIPELINE_STATISTICS:
       pq->start[task->thread_index] = task->ps_invocations;
       break;
+   case LP_QUERY_TEXTURE_CACHE_ACCESSES:
+   case LP_QUERY_TEXTURE_CACHE_MISSES:
+      pq->start[task->thread_index] = texture_cache_counter(task, pq->type);
+      break;
    default:
       assert(0);
       break;
@@ -524,6 +545,12 @@ lp_rast_end_query(struct lp_rasterizer_task *task,
          task->ps_invocations - pq->start[task->thread_index];
       pq->start[task->thread_index] = 0;
       break;
+   case LP_QUERY_TEXTURE_CACHE_ACCESSES:
+   case LP_QUERY_TEXTURE_CACHE_MISSES:
+      pq->end[task->thread_index] +=
+         texture_cache_counter(task, pq->type) - pq->start[task->thread_index];
+      pq->start[task->thread_index] = 0;
+      break;
    default:
       assert(0);
       break;
@@ -665,17 +692,6 @@ rasterize_scene(struct lp_rasterizer_task *task,
 {
    task->scene = scene;
 
-   /* Clear the cache tags. This should not always be necessary but
-      simpler for now. */
-#if LP_USE_TEXTURE_CACHE
-   memset(task->thread_data.cache->cache_tags, 0,
-          sizeof(task->thread_data.cache->cache_tags));
-#if LP_BUILD_FORMAT_CACHE_DEBUG
-   task->thread_data.cache->cache_access_total = 0;
-   task->thread_data.cache->cache_access_miss = 0;
-#endif
-#endif
-
    if (!task->rast->no_rast && !scene->discard) {
       /* loop over scene bins, rasterize each */
       {
@@ -690,21 +706,6 @@ rasterize_scene(struct lp_rasterizer_task *task,
       }
    }
 
-
-#if LP_BUILD_FORMAT_CACHE_DEBUG
-   {
-      uint64_t total, miss;
-      total = task->thread_data.cache->cache_access_total;
-      miss = task->thread_data.cache->cache_access_miss;
-      if (total) {
-         debug_printf("thread %d cache access %llu miss %llu hit rate %f\n",
-                 task->thread_index, (long long unsigned)total,
-                 (long long unsigned)miss,
-                 (float)(total - miss)/(float)total);
-      }
-   }
-#endif
-
    if (scene->fence) {
       lp_fence_signal(scene->fence);
    }
@@ -880,6 +881,7 @@ struct lp_rasterizer *
 lp_rast_create( unsigned num_threads )
 {
    struct lp_rasterizer *rast;
+   unsigned cache_size;
    unsigned i;
 
    rast = CALLOC_STRUCT(lp_rasterizer);
@@ -892,15 +894,19 @@ lp_rast_create( unsigned num_threads )
       goto no_full_scenes;
    }
 
+   /*
+    * Size of each thread's cache of decoded compressed blocks, in KB.
+    * The cache persists across scenes, zero disables it.
+    */
+   cache_size = debug_get_num_option("LP_TEXTURE_CACHE_SIZE",
+                                     LP_DEFAULT_TEXTURE_CACHE_SIZE);
+
    for (i = 0; i < MAX2(1, num_threads); i++) {
       struct lp_rasterizer_task *task = &rast->tasks[i];
       task->rast = rast;
       task->thread_index = i;
-      task->thread_data.cache = align_malloc(sizeof(struct lp_build_format_cache),
-                                             16);
-      if (!task->thread_data.cache) {
-         goto no_thread_data_cache;
-      }
+      /* Failing to allocate the cache only makes sampling slower. */
+      task->thread_data.cache = lp_build_format_cache_create(cache_size * 1024);
    }
 
    rast->num_threads = num_threads;
@@ -918,14 +924,6 @@ lp_rast_create( unsigned num_threads )
 
    return rast;
 
-no_thread_data_cache:
-   for (i = 0; i < MAX2(1, rast->num_threads); i++) {
-      if (rast->tasks[i].thread_data.cache) {
-         align_free(rast->tasks[i].thread_data.cache);
-      }
-   }
-
-   lp_scene_queue_destroy(rast->full_scenes);
 no_full_scenes:
    FREE(rast);
 no_rast:
@@ -965,7 +963,7 @@ void lp_rast_destroy( struct lp_rasterizer *rast )
       pipe_semaphore_destroy(&rast->tasks[i].work_done);
    }
    for (i = 0; i < MAX2(1, rast->num_threads); i++) {
-      align_free(rast->tasks[i].thread_data.cache);
+      lp_build_format_cache_destroy(rast->tasks[i].thread_data.cache);
    }
 
    /* for synchronizing rasterization threads */
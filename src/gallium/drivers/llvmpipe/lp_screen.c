@@ -47,9 +47,11 @@
 #include "lp_debug.h"
 #include "lp_public.h"
 #include "lp_limits.h"
+#include "lp_query.h"
 #include "lp_rast.h"
 
 #include "state_tracker/sw_winsys.h"
+#include "util/thread_pool.h"
 
 #ifdef DEBUG
 int LP_DEBUG = 0;
@@ -293,6 +295,8 @@ llvmpipe_get_param(struct pipe_screen *screen, enum pipe_cap param)
       return 1;
    case PIPE_CAP_CULL_DISTANCE:
       return 1;
+   case PIPE_CAP_GENERATE_MIPMAP:
+      return 1;
    case PIPE_CAP_COPY_BETWEEN_COMPRESSED_AND_PLAIN_FORMATS:
       return 1;
    case PIPE_CAP_MULTISAMPLE_Z_RESOLVE:
@@ -312,7 +316,6 @@ llvmpipe_get_param(struct pipe_screen *screen, enum pipe_cap param)
    case PIPE_CAP_TGSI_FS_FACE_IS_INTEGER_SYSVAL:
    case PIPE_CAP_SHADER_BUFFER_OFFSET_ALIGNMENT:
    case PIPE_CAP_INVALIDATE_BUFFER:
-   case PIPE_CAP_GENERATE_MIPMAP:
    case PIPE_CAP_STRING_MARKER:
    case PIPE_CAP_BUFFER_SAMPLER_VIEW_RGBA_ONLY:
    case PIPE_CAP_SURFACE_REINTERPRET_BLOCKS:
@@ -487,8 +490,7 @@ llvmpipe_is_format_supported( struct pipe_screen *_screen,
       }
    }
 
-   if (format_desc->layout == UTIL_FORMAT_LAYOUT_BPTC ||
-       format_desc->layout == UTIL_FORMAT_LAYOUT_ASTC) {
+   if (format_desc->layout == UTIL_FORMAT_LAYOUT_BPTC) {
       /* Software decoding is not hooked up. */
       return FALSE;
    }
@@ -542,7 +544,10 @@ llvmpipe_destroy_screen( struct pipe_screen *_screen )
    if(winsys->destroy)
       winsys->destroy(winsys);
 
+   thread_pool_destroy(screen->worker_pool);
+
    pipe_mutex_destroy(screen->rast_mutex);
+   pipe_mutex_destroy(screen->worker_pool_mutex);
 
    FREE(screen);
 }
@@ -588,6 +593,33 @@ llvmpipe_get_timestamp(struct pipe_screen *_screen)
    return os_time_get_nano();
 }
 
+
+static int
+llvmpipe_get_driver_query_info(struct pipe_screen *screen,
+                               unsigned index,
+                               struct pipe_driver_query_info *info)
+{
+#define QUERY(NAME, ENUM, UNITS) \
+   {NAME, ENUM, {0}, UNITS, PIPE_DRIVER_QUERY_RESULT_TYPE_CUMULATIVE, 0, 0x0}
+
+   static const struct pipe_driver_query_info queries[] = {
+      QUERY("texture-cache-accesses", LP_QUERY_TEXTURE_CACHE_ACCESSES,
+            PIPE_DRIVER_QUERY_TYPE_UINT64),
+      QUERY("texture-cache-misses", LP_QUERY_TEXTURE_CACHE_MISSES,
+            PIPE_DRIVER_QUERY_TYPE_UINT64),
+   };
+#undef QUERY
+
+   if (!info)
+      return ARRAY_SIZE(queries);
+
+   if (index >= ARRAY_SIZE(queries))
+      return 0;
+
+   *info = queries[index];
+   return 1;
+}
+
 /**
  * Create a new pipe_screen object
  * Note: we're not presently subclassing pipe_screen (no llvmpipe_screen).
@@ -632,6 +664,7 @@ llvmpipe_create_screen(struct sw_winsys *winsys)
    screen->base.fence_finish = llvmpipe_fence_finish;
 
    screen->base.get_timestamp = llvmpipe_get_timestamp;
+   screen->base.get_driver_query_info = llvmpipe_get_driver_query_info;
 
    llvmpipe_init_screen_resource_funcs(&screen->base);
 
@@ -649,6 +682,7 @@ llvmpipe_create_screen(struct sw_winsys *winsys)
       return NULL;
    }
    pipe_mutex_init(screen->rast_mutex);
+   pipe_mutex_init(screen->worker_pool_mutex);
 
    util_format_s3tc_init();
 
@@ -41,6 +41,7 @@
 
 
 struct sw_winsys;
+struct thread_pool;
 
 
 struct llvmpipe_screen
@@ -57,6 +58,12 @@ struct llvmpipe_screen
 
    struct lp_rasterizer *rast;
    pipe_mutex rast_mutex;
+
+   /* Worker threads for CPU-side operations like mipmap generation,
+    * created on first use.
+    */
+   struct thread_pool *worker_pool;
+   pipe_mutex worker_pool_mutex;
 };
 
 
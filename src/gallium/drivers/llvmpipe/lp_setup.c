@@ -821,6 +821,8 @@ lp_setup_set_fragment_sampler_views(struct lp_setup_context *setup,
           */
          pipe_resource_reference(&setup->fs.current_tex[i], res);
 
+         jit_tex->generation = lp_tex->generation;
+
          if (!lp_tex->dt) {
             /* regular texture - setup array of mipmap level offsets */
             int j;
@@ -1384,7 +1386,9 @@ lp_setup_begin_query(struct lp_setup_context *setup,
 
    if (!(pq->type == PIPE_QUERY_OCCLUSION_COUNTER ||
          pq->type == PIPE_QUERY_OCCLUSION_PREDICATE ||
-         pq->type == PIPE_QUERY_PIPELINE_STATISTICS))
+         pq->type == PIPE_QUERY_PIPELINE_STATISTICS ||
+         pq->type == LP_QUERY_TEXTURE_CACHE_ACCESSES ||
+         pq->type == LP_QUERY_TEXTURE_CACHE_MISSES))
       return;
 
    /* init the query to its beginning state */
@@ -1435,7 +1439,9 @@ lp_setup_end_query(struct lp_setup_context *setup, struct llvmpipe_query *pq)
       if (pq->type == PIPE_QUERY_OCCLUSION_COUNTER ||
           pq->type == PIPE_QUERY_OCCLUSION_PREDICATE ||
           pq->type == PIPE_QUERY_PIPELINE_STATISTICS ||
-          pq->type == PIPE_QUERY_TIMESTAMP) {
+          pq->type == PIPE_QUERY_TIMESTAMP ||
+          pq->type == LP_QUERY_TEXTURE_CACHE_ACCESSES ||
+          pq->type == LP_QUERY_TEXTURE_CACHE_MISSES) {
          if (pq->type == PIPE_QUERY_TIMESTAMP &&
                !(setup->scene->tiles_x | setup->scene->tiles_y)) {
             /*
@@ -1470,7 +1476,9 @@ fail:
     */
    if (pq->type == PIPE_QUERY_OCCLUSION_COUNTER ||
       pq->type == PIPE_QUERY_OCCLUSION_PREDICATE ||
-      pq->type == PIPE_QUERY_PIPELINE_STATISTICS) {
+      pq->type == PIPE_QUERY_PIPELINE_STATISTICS ||
+      pq->type == LP_QUERY_TEXTURE_CACHE_ACCESSES ||
+      pq->type == LP_QUERY_TEXTURE_CACHE_MISSES) {
       unsigned i;
 
       /* remove from active binned query list */
@@ -25,14 +25,17 @@
  * 
  **************************************************************************/
 
+#include "util/u_gen_mipmap.h"
 #include "util/u_rect.h"
 #include "util/u_surface.h"
+#include "util/thread_pool.h"
 #include "lp_context.h"
 #include "lp_flush.h"
 #include "lp_limits.h"
 #include "lp_surface.h"
 #include "lp_texture.h"
 #include "lp_query.h"
+#include "lp_screen.h"
 
 
 static void
@@ -124,6 +127,34 @@ lp_flush_resource(struct pipe_context *ctx, struct pipe_resource *resource)
 }
 
 
+/**
+ * Filter the mip levels on the CPU rather than rendering them through
+ * the blitter, spreading the work of each level over the screen's worker
+ * threads.
+ */
+static boolean
+lp_generate_mipmap(struct pipe_context *pipe,
+                   struct pipe_resource *resource,
+                   enum pipe_format format,
+                   unsigned base_level,
+                   unsigned last_level,
+                   unsigned first_layer,
+                   unsigned last_layer)
+{
+   struct llvmpipe_screen *screen = llvmpipe_screen(pipe->screen);
+   struct thread_pool *pool;
+
+   pipe_mutex_lock(screen->worker_pool_mutex);
+   if (!screen->worker_pool)
+      screen->worker_pool = thread_pool_create(screen->num_threads);
+   pool = screen->worker_pool;
+   pipe_mutex_unlock(screen->worker_pool_mutex);
+
+   return util_gen_mipmap_cpu(pipe, resource, format, base_level, last_level,
+                              first_layer, last_layer, pool);
+}
+
+
 static struct pipe_surface *
 llvmpipe_create_surface(struct pipe_context *pipe,
                         struct pipe_resource *pt,
@@ -233,4 +264,5 @@ llvmpipe_init_surface_functions(struct llvmpipe_context *lp)
    lp->pipe.resource_copy_region = lp_resource_copy;
    lp->pipe.blit = lp_blit;
    lp->pipe.flush_resource = lp_flush_resource;
+   lp->pipe.generate_mipmap = lp_generate_mipmap;
 }
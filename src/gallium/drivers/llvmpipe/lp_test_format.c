@@ -43,11 +43,15 @@
 #include "gallivm/lp_bld_init.h"
 
 #include "lp_test.h"
+#include "lp_tex_sample.h"
 
 #define USE_TEXTURE_CACHE 1
 
 static struct lp_build_format_cache *cache_ptr;
 
+/* Each test case gets a new generation as the packed data changes. */
+static unsigned cache_generation;
+
 void
 write_tsv_header(FILE *fp)
 {
@@ -74,7 +78,8 @@ write_tsv_row(FILE *fp,
 
 typedef void
 (*fetch_ptr_t)(void *unpacked, const void *packed,
-               unsigned i, unsigned j, struct lp_build_format_cache *cache);
+               unsigned i, unsigned j, struct lp_build_format_cache *cache,
+               unsigned generation);
 
 
 static LLVMValueRef
@@ -86,7 +91,7 @@ add_fetch_rgba_test(struct gallivm_state *gallivm, unsigned verbose,
    LLVMContextRef context = gallivm->context;
    LLVMModuleRef module = gallivm->module;
    LLVMBuilderRef builder = gallivm->builder;
-   LLVMTypeRef args[5];
+   LLVMTypeRef args[6];
    LLVMValueRef func;
    LLVMValueRef packed_ptr;
    LLVMValueRef offset = LLVMConstNull(LLVMInt32TypeInContext(context));
@@ -96,6 +101,7 @@ add_fetch_rgba_test(struct gallivm_state *gallivm, unsigned verbose,
    LLVMBasicBlockRef block;
    LLVMValueRef rgba;
    LLVMValueRef cache = NULL;
+   LLVMValueRef generation = NULL;
 
    util_snprintf(name, sizeof name, "fetch_%s_%s", desc->short_name,
                  type.floating ? "float" : "unorm8");
@@ -103,7 +109,8 @@ add_fetch_rgba_test(struct gallivm_state *gallivm, unsigned verbose,
    args[0] = LLVMPointerType(lp_build_vec_type(gallivm, type), 0);
    args[1] = LLVMPointerType(LLVMInt8TypeInContext(context), 0);
    args[3] = args[2] = LLVMInt32TypeInContext(context);
-   args[4] = LLVMPointerType(lp_build_format_cache_type(gallivm), 0);
+   args[4] = LLVMPointerType(LLVMInt8TypeInContext(context), 0);
+   args[5] = LLVMInt32TypeInContext(context);
 
    func = LLVMAddFunction(module, name,
                           LLVMFunctionType(LLVMVoidTypeInContext(context),
@@ -116,13 +123,15 @@ add_fetch_rgba_test(struct gallivm_state *gallivm, unsigned verbose,
 
    if (cache_ptr) {
       cache = LLVMGetParam(func, 4);
+      generation = LLVMGetParam(func, 5);
    }
 
    block = LLVMAppendBasicBlockInContext(context, func, "entry");
    LLVMPositionBuilderAtEnd(builder, block);
 
    rgba = lp_build_fetch_rgba_aos(gallivm, desc, type, TRUE,
-                                  packed_ptr, offset, i, j, cache);
+                                  packed_ptr, offset, i, j,
+                                  cache, generation);
 
    LLVMBuildStore(builder, rgba, rgba_ptr);
 
@@ -174,6 +183,7 @@ test_format_float(unsigned verbose, FILE *fp,
 
          /* To ensure it's 16-byte aligned */
          memcpy(packed, test->packed, sizeof packed);
+         cache_generation++;
 
          for (i = 0; i < desc->block.height; ++i) {
             for (j = 0; j < desc->block.width; ++j) {
@@ -181,7 +191,8 @@ test_format_float(unsigned verbose, FILE *fp,
 
                memset(unpacked, 0, sizeof unpacked);
 
-               fetch_ptr(unpacked, packed, j, i, cache_ptr);
+               fetch_ptr(unpacked, packed, j, i, cache_ptr,
+                         cache_generation);
 
                for(k = 0; k < 4; ++k) {
                   if (util_double_inf_sign(test->unpacked[i][j][k]) != util_inf_sign(unpacked[k])) {
@@ -273,6 +284,7 @@ test_format_unorm8(unsigned verbose, FILE *fp,
          /* To ensure it's 16-byte aligned */
          /* Could skip this and use unaligned lp_build_fetch_rgba_aos */
          memcpy(packed, test->packed, sizeof packed);
+         cache_generation++;
 
          for (i = 0; i < desc->block.height; ++i) {
             for (j = 0; j < desc->block.width; ++j) {
@@ -280,7 +292,8 @@ test_format_unorm8(unsigned verbose, FILE *fp,
 
                memset(unpacked, 0, sizeof unpacked);
 
-               fetch_ptr(unpacked, packed, j, i, cache_ptr);
+               fetch_ptr(unpacked, packed, j, i, cache_ptr,
+                         cache_generation);
 
                match = TRUE;
                for(k = 0; k < 4; ++k) {
@@ -360,7 +373,7 @@ test_all(unsigned verbose, FILE *fp)
    util_format_s3tc_init();
 
 #if USE_TEXTURE_CACHE
-   cache_ptr = align_malloc(sizeof(struct lp_build_format_cache), 16);
+   cache_ptr = lp_build_format_cache_create(LP_DEFAULT_TEXTURE_CACHE_SIZE * 1024);
 #endif
 
    for (format = 1; format < PIPE_FORMAT_COUNT; ++format) {
@@ -395,8 +408,7 @@ test_all(unsigned verbose, FILE *fp)
       }
 
       /* missing fetch funcs */
-      if (format_desc->layout == UTIL_FORMAT_LAYOUT_BPTC ||
-          format_desc->layout == UTIL_FORMAT_LAYOUT_ASTC) {
+      if (format_desc->layout == UTIL_FORMAT_LAYOUT_BPTC) {
          continue;
       }
 
@@ -405,7 +417,7 @@ test_all(unsigned verbose, FILE *fp)
       }
    }
 #if USE_TEXTURE_CACHE
-   align_free(cache_ptr);
+   lp_build_format_cache_destroy(cache_ptr);
 #endif
 
    return success;
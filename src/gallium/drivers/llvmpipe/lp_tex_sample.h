@@ -35,9 +35,10 @@
 struct lp_sampler_static_state;
 
 /**
- * Whether texture cache is used for s3tc textures.
+ * Default size in KB of each rasterizer thread's cache of decoded
+ * compressed texture blocks, see LP_TEXTURE_CACHE_SIZE.
  */
-#define LP_USE_TEXTURE_CACHE 0
+#define LP_DEFAULT_TEXTURE_CACHE_SIZE 64
 
 /**
  * Pure-LLVM texture sampling code generator.
@@ -35,6 +35,7 @@
 #include "pipe/p_context.h"
 #include "pipe/p_defines.h"
 
+#include "util/u_atomic.h"
 #include "util/u_inlines.h"
 #include "util/u_cpu_detect.h"
 #include "util/u_format.h"
@@ -291,6 +292,7 @@ llvmpipe_resource_create_front(struct pipe_screen *_screen,
       memset(lpr->data, 0, bytes);
    }
 
+   lpr->generation = p_atomic_inc_return(&screen->timestamp);
    lpr->id = id_counter++;
 
 #ifdef DEBUG
@@ -468,6 +470,7 @@ llvmpipe_resource_from_handle(struct pipe_screen *screen,
       goto no_dt;
    }
 
+   lpr->generation = p_atomic_inc_return(&llvmpipe_screen(screen)->timestamp);
    lpr->id = id_counter++;
 
 #ifdef DEBUG
@@ -604,7 +607,7 @@ llvmpipe_transfer_map( struct pipe_context *pipe,
    if (usage & PIPE_TRANSFER_WRITE) {
       /* Do something to notify sharing contexts of a texture change.
        */
-      screen->timestamp++;
+      lpr->generation = p_atomic_inc_return(&screen->timestamp);
    }
 
    map +=
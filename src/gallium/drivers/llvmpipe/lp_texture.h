@@ -86,7 +86,13 @@ struct llvmpipe_resource
    void *data;
 
    boolean userBuffer;  /** Is this a user-space buffer? */
-   unsigned timestamp;
+
+   /**
+    * Changes whenever the contents may have been written through a
+    * transfer, and is unique among all resources of the screen.  Used to
+    * validate the entries of the rasterizer threads' block caches.
+    */
+   unsigned generation;
 
    unsigned id;  /**< temporary, for debugging */
 
@@ -26,6 +26,7 @@
  **************************************************************************/
 
 #include "util/u_format.h"
+#include "util/u_gen_mipmap.h"
 #include "util/u_surface.h"
 #include "sp_context.h"
 #include "sp_surface.h"
@@ -129,6 +130,20 @@ softpipe_clear_depth_stencil(struct pipe_context *pipe,
 }
 
 
+static boolean
+sp_generate_mipmap(struct pipe_context *pipe,
+                   struct pipe_resource *resource,
+                   enum pipe_format format,
+                   unsigned base_level,
+                   unsigned last_level,
+                   unsigned first_layer,
+                   unsigned last_layer)
+{
+   return util_gen_mipmap_cpu(pipe, resource, format, base_level, last_level,
+                              first_layer, last_layer, NULL);
+}
+
+
 void
 sp_init_surface_functions(struct softpipe_context *sp)
 {
@@ -137,4 +152,5 @@ sp_init_surface_functions(struct softpipe_context *sp)
    sp->pipe.clear_depth_stencil = softpipe_clear_depth_stencil;
    sp->pipe.blit = sp_blit;
    sp->pipe.flush_resource = sp_flush_resource;
+   sp->pipe.generate_mipmap = sp_generate_mipmap;
 }
@@ -1337,7 +1337,7 @@ vc4_optimize_nir(struct nir_shader *s)
 
                 NIR_PASS(progress, s, nir_copy_prop);
                 NIR_PASS(progress, s, nir_opt_dce);
-                NIR_PASS(progress, s, nir_opt_cse);
+                NIR_PASS(progress, s, nir_opt_gvn);
                 NIR_PASS(progress, s, nir_opt_peephole_select);
                 NIR_PASS(progress, s, nir_opt_algebraic);
                 NIR_PASS(progress, s, nir_opt_constant_folding);
@@ -0,0 +1,247 @@
+/**************************************************************************
+ *
+ * Copyright 2016 VMware, Inc.
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+
+/*
+ * Compare and time mipmap generation with util_gen_mipmap(), which draws
+ * every level with the blitter, and util_gen_mipmap_cpu(), which filters
+ * mapped memory directly, on softpipe.
+ *
+ * Usage: u_gen_mipmap_test [size]
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "pipe/p_context.h"
+#include "pipe/p_screen.h"
+#include "pipe/p_state.h"
+#include "util/u_cpu_detect.h"
+#include "util/u_format.h"
+#include "util/u_gen_mipmap.h"
+#include "util/u_inlines.h"
+#include "util/u_math.h"
+#include "util/u_memory.h"
+#include "util/thread_pool.h"
+#include "os/os_time.h"
+#include "softpipe/sp_public.h"
+#include "sw/null/null_sw_winsys.h"
+
+
+static struct pipe_resource *
+create_texture(struct pipe_screen *screen, enum pipe_format format,
+               unsigned size)
+{
+   struct pipe_resource templ;
+
+   memset(&templ, 0, sizeof templ);
+   templ.target = PIPE_TEXTURE_2D;
+   templ.format = format;
+   templ.width0 = size;
+   templ.height0 = size;
+   templ.depth0 = 1;
+   templ.array_size = 1;
+   templ.last_level = util_logbase2(size);
+   templ.bind = PIPE_BIND_SAMPLER_VIEW | PIPE_BIND_RENDER_TARGET;
+
+   return screen->resource_create(screen, &templ);
+}
+
+
+static void
+fill_base_level(struct pipe_context *pipe, struct pipe_resource *pt)
+{
+   struct pipe_transfer *transfer;
+   float *texels;
+   uint8_t *map;
+   unsigned i;
+
+   texels = MALLOC(pt->width0 * pt->height0 * 4 * sizeof(float));
+   for (i = 0; i < pt->width0 * pt->height0 * 4; i++)
+      texels[i] = (float) rand() / RAND_MAX;
+
+   map = pipe_transfer_map(pipe, pt, 0, 0, PIPE_TRANSFER_WRITE,
+                           0, 0, pt->width0, pt->height0, &transfer);
+   util_format_write_4f(pt->format, texels, pt->width0 * 4 * sizeof(float),
+                        map, transfer->stride, 0, 0, pt->width0, pt->height0);
+   pipe_transfer_unmap(pipe, transfer);
+
+   FREE(texels);
+}
+
+
+static float *
+read_level(struct pipe_context *pipe, struct pipe_resource *pt,
+           unsigned level)
+{
+   const unsigned w = u_minify(pt->width0, level);
+   const unsigned h = u_minify(pt->height0, level);
+   struct pipe_transfer *transfer;
+   float *texels;
+   uint8_t *map;
+
+   texels = MALLOC(w * h * 4 * sizeof(float));
+   map = pipe_transfer_map(pipe, pt, level, 0, PIPE_TRANSFER_READ,
+                           0, 0, w, h, &transfer);
+   util_format_read_4f(pt->format, texels, w * 4 * sizeof(float),
+                       map, transfer->stride, 0, 0, w, h);
+   pipe_transfer_unmap(pipe, transfer);
+
+   return texels;
+}
+
+
+/**
+ * Largest difference between the levels of two textures.
+ */
+static float
+compare_textures(struct pipe_context *pipe,
+                 struct pipe_resource *a, struct pipe_resource *b)
+{
+   float max_diff = 0.0f;
+   unsigned level, i;
+
+   for (level = 1; level <= a->last_level; level++) {
+      const unsigned n = u_minify(a->width0, level) *
+                         u_minify(a->height0, level) * 4;
+      float *ta = read_level(pipe, a, level);
+      float *tb = read_level(pipe, b, level);
+
+      for (i = 0; i < n; i++)
+         max_diff = MAX2(max_diff, fabsf(ta[i] - tb[i]));
+
+      FREE(ta);
+      FREE(tb);
+   }
+
+   return max_diff;
+}
+
+
+static boolean
+test_format(struct pipe_context *pipe, struct thread_pool *pool,
+            enum pipe_format format, unsigned size, float tolerance)
+{
+   struct pipe_screen *screen = pipe->screen;
+   struct pipe_resource *blit_tex, *cpu_tex;
+   int64_t start;
+   double blit_time, cpu_time, mt_time;
+   float diff;
+   boolean success;
+
+   blit_tex = create_texture(screen, format, size);
+   cpu_tex = create_texture(screen, format, size);
+   if (!blit_tex || !cpu_tex) {
+      printf("%s: couldn't create textures\n", util_format_name(format));
+      pipe_resource_reference(&blit_tex, NULL);
+      pipe_resource_reference(&cpu_tex, NULL);
+      return FALSE;
+   }
+
+   srand(0);
+   fill_base_level(pipe, blit_tex);
+   srand(0);
+   fill_base_level(pipe, cpu_tex);
+
+   start = os_time_get_nano();
+   util_gen_mipmap(pipe, blit_tex, format, 0, blit_tex->last_level,
+                   0, 0, PIPE_TEX_FILTER_LINEAR);
+   pipe->flush(pipe, NULL, 0);
+   blit_time = (os_time_get_nano() - start) * 1e-9;
+
+   start = os_time_get_nano();
+   success = util_gen_mipmap_cpu(pipe, cpu_tex, format, 0,
+                                 cpu_tex->last_level, 0, 0, NULL);
+   cpu_time = (os_time_get_nano() - start) * 1e-9;
+
+   start = os_time_get_nano();
+   success = success &&
+             util_gen_mipmap_cpu(pipe, cpu_tex, format, 0,
+                                 cpu_tex->last_level, 0, 0, pool);
+   mt_time = (os_time_get_nano() - start) * 1e-9;
+
+   if (!success) {
+      printf("%s: util_gen_mipmap_cpu failed\n", util_format_name(format));
+   }
+   else {
+      diff = compare_textures(pipe, blit_tex, cpu_tex);
+      success = diff <= tolerance;
+
+      printf("%s: blit %.1f ms, cpu %.1f ms, cpu threaded %.1f ms, "
+             "max difference %g%s\n",
+             util_format_name(format),
+             blit_time * 1e3, cpu_time * 1e3, mt_time * 1e3, diff,
+             success ? "" : " (FAILED)");
+   }
+
+   pipe_resource_reference(&blit_tex, NULL);
+   pipe_resource_reference(&cpu_tex, NULL);
+
+   return success;
+}
+
+
+int main(int argc, char **argv)
+{
+   struct pipe_screen *screen;
+   struct pipe_context *pipe;
+   struct thread_pool *pool;
+   unsigned size = argc > 1 ? atoi(argv[1]) : 1024;
+   boolean success = TRUE;
+
+   util_cpu_detect();
+
+   screen = softpipe_create_screen(null_sw_create());
+   if (!screen) {
+      printf("couldn't create softpipe screen\n");
+      return 1;
+   }
+
+   pipe = screen->context_create(screen, NULL, 0);
+   pool = thread_pool_create(util_cpu_caps.nr_cpus > 1 ?
+                             util_cpu_caps.nr_cpus : 0);
+
+   /* The blitter samples with 8 bits of subtexel precision, so unorm
+    * results may be one step apart.
+    */
+   success &= test_format(pipe, pool, PIPE_FORMAT_R8G8B8A8_UNORM, size,
+                          1.0f / 255.0f + 1e-6f);
+   success &= test_format(pipe, pool, PIPE_FORMAT_R8G8B8A8_SRGB, size,
+                          1.0f / 255.0f + 1e-6f);
+   success &= test_format(pipe, pool, PIPE_FORMAT_R16G16B16A16_FLOAT, size,
+                          1.0f / 1024.0f);
+   success &= test_format(pipe, pool, PIPE_FORMAT_R32G32B32A32_FLOAT, size,
+                          1e-5f);
+
+   thread_pool_destroy(pool);
+   pipe->destroy(pipe);
+   screen->destroy(screen);
+
+   return success ? 0 : 1;
+}
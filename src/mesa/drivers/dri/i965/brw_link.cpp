@@ -144,6 +144,7 @@ process_glsl_ir(gl_shader_stage stage,
                  _mesa_shader_stage_to_abbrev(shader->Stage));
    }
 
+   opt_pass_manager pm;
    bool progress;
    do {
       progress = false;
@@ -151,18 +152,19 @@ process_glsl_ir(gl_shader_stage stage,
       if (compiler->scalar_stage[shader->Stage]) {
          if (shader->Stage == MESA_SHADER_VERTEX ||
              shader->Stage == MESA_SHADER_FRAGMENT)
-            brw_do_channel_expressions(shader->ir);
-         brw_do_vector_splitting(shader->ir);
+            pm.track(brw_do_channel_expressions(shader->ir));
+         pm.track(brw_do_vector_splitting(shader->ir));
       }
 
-      progress = do_lower_jumps(shader->ir, true, true,
-                                true, /* main return */
-                                false, /* continue */
-                                false /* loops */
-                                ) || progress;
+      progress = pm.track(do_lower_jumps(shader->ir, true, true,
+                                         true, /* main return */
+                                         false, /* continue */
+                                         false /* loops */
+                                         )) || progress;
 
       progress = do_common_optimization(shader->ir, true, true,
-                                        options, ctx->Const.NativeIntegers) || progress;
+                                        options, ctx->Const.NativeIntegers,
+                                        &pm) || progress;
    } while (progress);
 
    validate_ir_tree(shader->ir);
@@ -119,6 +119,7 @@ intel_map_renderbuffer(struct gl_context *ctx,
       GLint rowStride = srb->RowStride;
       *out_map = (GLubyte *) srb->Buffer + y * rowStride + x * bpp;
       *out_stride = rowStride;
+      rb->MapUncached = GL_FALSE;
       return;
    }
 
@@ -168,6 +169,18 @@ intel_map_renderbuffer(struct gl_context *ctx,
    intel_miptree_map(brw, mt, irb->mt_level, irb->mt_layer,
 		     x, y, w, h, mode, &map, &stride);
 
+   /* All the ways to map a miptree except directly go through a temporary
+    * buffer or miptree in cached memory.  A direct map is only uncached
+    * without an LLC shared with the CPU.
+    */
+   if (map) {
+      const struct intel_miptree_map *mt_map =
+         mt->level[irb->mt_level].slice[irb->mt_layer].map;
+
+      rb->MapUncached = !brw->has_llc &&
+                        !mt_map->buffer && !mt_map->linear_mt;
+   }
+
    if (rb->Name == 0) {
       map += (h - 1) * stride;
       stride = -stride;
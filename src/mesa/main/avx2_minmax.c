@@ -0,0 +1,49 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "main/avx2_minmax.h"
+#include <immintrin.h>
+#include <stdint.h>
+
+#define VEC __m256i
+#define VEC_LOAD(p) _mm256_loadu_si256((const __m256i *)(p))
+#define VEC_STORE(p, v) _mm256_storeu_si256((__m256i *)(p), v)
+#define VEC_ZERO _mm256_setzero_si256()
+#define VEC_ONES _mm256_set1_epi32(~0)
+#define VEC_OR _mm256_or_si256
+#define VEC_ANDNOT _mm256_andnot_si256
+#define VEC_SET1_8 _mm256_set1_epi8
+#define VEC_SET1_16 _mm256_set1_epi16
+#define VEC_SET1_32 _mm256_set1_epi32
+#define VEC_CMPEQ_8 _mm256_cmpeq_epi8
+#define VEC_CMPEQ_16 _mm256_cmpeq_epi16
+#define VEC_CMPEQ_32 _mm256_cmpeq_epi32
+#define VEC_MIN_8 _mm256_min_epu8
+#define VEC_MIN_16 _mm256_min_epu16
+#define VEC_MIN_32 _mm256_min_epu32
+#define VEC_MAX_8 _mm256_max_epu8
+#define VEC_MAX_16 _mm256_max_epu16
+#define VEC_MAX_32 _mm256_max_epu32
+#define FUNC_NAME _mesa_avx2_index_min_max
+
+#include "main/minmax_tmp.h"
@@ -120,7 +120,9 @@
 #include "shared.h"
 #include "shaderobj.h"
 #include "shaderimage.h"
+#include "shader_threads.h"
 #include "util/strtod.h"
+#include "util/thread_pool.h"
 #include "state.h"
 #include "stencil.h"
 #include "texcompress_s3tc.h"
@@ -143,6 +145,7 @@
 #endif
 
 #include "compiler/glsl/glsl_parser_extras.h"
+#include "util/disk_cache.h"
 #include <stdbool.h>
 
 
@@ -715,6 +718,9 @@ _mesa_init_constants(struct gl_constants *consts, gl_api api)
    /** GL_KHR_context_flush_control */
    consts->ContextReleaseBehavior = GL_CONTEXT_RELEASE_BEHAVIOR_FLUSH;
 
+   /** GL_ARB_get_program_binary */
+   consts->NumProgramBinaryFormats = 1;
+
    /** GL_ARB_tessellation_shader */
    consts->MaxTessGenLevel = MAX_TESS_GEN_LEVEL;
    consts->MaxPatchVertices = MAX_PATCH_VERTICES;
@@ -1282,6 +1288,11 @@ _mesa_free_context_data( struct gl_context *ctx )
       _mesa_make_current(ctx, NULL, NULL);
    }
 
+   /* The queued compile and link jobs use the context. */
+   _mesa_free_compiler_threads(ctx);
+   thread_pool_destroy(ctx->WorkerThreads);
+   ctx->WorkerThreads = NULL;
+
    /* unreference WinSysDraw/Read buffers */
    _mesa_reference_framebuffer(&ctx->WinSysDrawBuffer, NULL);
    _mesa_reference_framebuffer(&ctx->WinSysReadBuffer, NULL);
@@ -1311,6 +1322,7 @@ _mesa_free_context_data( struct gl_context *ctx )
    _mesa_free_pipeline_data(ctx);
    _mesa_free_program_data(ctx);
    _mesa_free_shader_state(ctx);
+   disk_cache_destroy(ctx->Cache);
    _mesa_free_queryobj_data(ctx);
    _mesa_free_sync_data(ctx);
    _mesa_free_varray_data(ctx);
@@ -1814,6 +1826,61 @@ _mesa_flush(struct gl_context *ctx)
 }
 
 
+/** Upper limit for the default number of worker threads */
+#define MAX_DEFAULT_WORKER_THREADS 7
+
+/**
+ * Return the threads that help the API thread with work that is easily
+ * split up, or NULL if the work should be done on the API thread alone.
+ *
+ * The pool has one thread less than there are CPUs, unless the number is
+ * set with MESA_WORKER_THREADS.  It is shared by all users in the context
+ * and only ever used through thread_pool_parallel_for(), so a user never
+ * waits for another one's jobs.
+ */
+struct thread_pool *
+_mesa_get_worker_threads(struct gl_context *ctx)
+{
+   if (!ctx->WorkerThreadsInitialized) {
+      const char *env = getenv("MESA_WORKER_THREADS");
+      unsigned num_threads;
+
+      if (env) {
+         num_threads = strtoul(env, NULL, 10);
+      } else {
+         num_threads = thread_pool_num_cpus() - 1;
+         num_threads = MIN2(num_threads, MAX_DEFAULT_WORKER_THREADS);
+      }
+
+      ctx->WorkerThreadsInitialized = GL_TRUE;
+      ctx->WorkerThreads = thread_pool_create(num_threads);
+   }
+
+   return ctx->WorkerThreads;
+}
+
+/**
+ * Call \p func for bands of the rows of \p depth images with
+ * thread_pool_parallel_rows(), on the worker threads of \p ctx if the
+ * images are large.  \p ctx may be NULL to do all the work on the calling
+ * thread.
+ */
+void
+_mesa_parallel_image_rows(struct gl_context *ctx,
+                          unsigned width, unsigned height, unsigned depth,
+                          thread_pool_rows_func func, void *data)
+{
+   struct thread_pool *pool = NULL;
+
+   /* Don't start the threads for work that wouldn't be split up anyway. */
+   if (ctx &&
+       (uint64_t) width * height * depth >= THREAD_POOL_MIN_PARALLEL_PIXELS)
+      pool = _mesa_get_worker_threads(ctx);
+
+   thread_pool_parallel_rows(pool, width, height, depth, func, data);
+}
+
+
 
 /**
  * Execute glFinish().
@@ -53,6 +53,7 @@
 #include "extensions.h"
 #include "mtypes.h"
 #include "vbo/vbo.h"
+#include "util/thread_pool.h"
 
 
 #ifdef __cplusplus
@@ -170,6 +171,14 @@ _mesa_finish(struct gl_context *ctx);
 extern void
 _mesa_flush(struct gl_context *ctx);
 
+extern struct thread_pool *
+_mesa_get_worker_threads(struct gl_context *ctx);
+
+extern void
+_mesa_parallel_image_rows(struct gl_context *ctx,
+                          unsigned width, unsigned height, unsigned depth,
+                          thread_pool_rows_func func, void *data);
+
 extern void GLAPIENTRY
 _mesa_Finish( void );
 
@@ -70,6 +70,7 @@
 #include "main/dispatch.h"
 
 #include "vbo/vbo.h"
+#include "util/debug.h"
 
 
 #define USE_BITMAP_ATLAS 1
@@ -86,6 +87,7 @@ struct gl_list_instruction
    void (*Execute)( struct gl_context *ctx, void *data );
    void (*Destroy)( struct gl_context *ctx, void *data );
    void (*Print)( struct gl_context *ctx, void *data, FILE *f );
+   GLuint (*Merge)( struct gl_context *ctx, void **data, GLuint count );
 };
 
 
@@ -492,6 +494,8 @@ typedef enum
    OPCODE_ERROR,                /* raise compiled-in error */
    OPCODE_CONTINUE,
    OPCODE_NOP,                  /* No-op (used for 8-byte alignment */
+   OPCODE_SKIP,                 /* jump n[1].ui nodes ahead, over the
+                                 * instructions removed by optimize_list() */
    OPCODE_END_OF_LIST,
    OPCODE_EXT_0
 } OpCode;
@@ -1102,6 +1106,9 @@ _mesa_delete_list(struct gl_context *ctx, struct gl_display_list *dlist)
             free(block);
             block = n;
             break;
+         case OPCODE_SKIP:
+            n += n[1].ui;
+            break;
          case OPCODE_END_OF_LIST:
             free(block);
             done = GL_TRUE;
@@ -1438,6 +1445,9 @@ _mesa_dlist_alloc_aligned(struct gl_context *ctx, GLuint opcode, GLuint bytes)
  * \param execute  function to execute the new display list command
  * \param destroy  function to destroy the new display list command
  * \param print  function to print the new display list command
+ * \param merge  optional function to combine a run of consecutive
+ *               instructions with this opcode at EndList time, see
+ *               optimize_list()
  * \return  the new opcode number or -1 if error
  */
 GLint
@@ -1445,7 +1455,9 @@ _mesa_dlist_alloc_opcode(struct gl_context *ctx,
                          GLuint size,
                          void (*execute) (struct gl_context *, void *),
                          void (*destroy) (struct gl_context *, void *),
-                         void (*print) (struct gl_context *, void *, FILE *))
+                         void (*print) (struct gl_context *, void *, FILE *),
+                         GLuint (*merge) (struct gl_context *, void **,
+                                          GLuint))
 {
    if (ctx->ListExt->NumOpcodes < MAX_DLIST_EXT_OPCODES) {
       const GLuint i = ctx->ListExt->NumOpcodes++;
@@ -1454,6 +1466,7 @@ _mesa_dlist_alloc_opcode(struct gl_context *ctx,
       ctx->ListExt->Opcode[i].Execute = execute;
       ctx->ListExt->Opcode[i].Destroy = destroy;
       ctx->ListExt->Opcode[i].Print = print;
+      ctx->ListExt->Opcode[i].Merge = merge;
       return i + OPCODE_EXT_0;
    }
    return -1;
@@ -1508,6 +1521,190 @@ trim_list(struct gl_context *ctx)
 
 
 
+/**
+ * Remove the instruction of \p size nodes at \p n from the list being
+ * optimized.  The instruction must have been destroyed already.  If it
+ * directly follows the last removed instruction, the existing SKIP is
+ * extended over it.
+ */
+static void
+remove_instruction(Node *n, GLuint size, Node **last_skip)
+{
+   if (*last_skip) {
+      Node *end = *last_skip + (*last_skip)[1].ui;
+
+      /* step over an alignment NOP */
+      if (end != n && end[0].opcode == OPCODE_NOP)
+         end++;
+
+      if (end == n) {
+         (*last_skip)[1].ui = (n + size) - *last_skip;
+         return;
+      }
+   }
+
+   if (size == 1) {
+      n[0].opcode = OPCODE_NOP;
+   }
+   else {
+      n[0].opcode = OPCODE_SKIP;
+      n[1].ui = size;
+      *last_skip = n;
+   }
+}
+
+
+/**
+ * Let the Merge callback of an extension opcode combine the run of
+ * instructions at run[0..count-1], which follow each other with only
+ * NOPs in between.  The instructions merged into another one are removed.
+ */
+static void
+merge_run(struct gl_context *ctx, Node **run, void **data, GLuint count,
+          Node **last_skip)
+{
+   const struct gl_list_instruction *inst =
+      &ctx->ListExt->Opcode[run[0][0].opcode - OPCODE_EXT_0];
+   GLuint first = 0, i;
+
+   while (count - first > 1) {
+      /* not MAX2(), which would call Merge twice */
+      GLuint merged = inst->Merge(ctx, data + first, count - first);
+
+      if (merged == 0)
+         merged = 1;
+
+      for (i = first + 1; i < first + merged; i++) {
+         inst->Destroy(ctx, data[i]);
+         remove_instruction(run[i], inst->Size, last_skip);
+      }
+
+      first += merged;
+   }
+}
+
+
+/**
+ * Called by EndList to make the list cheaper to execute:
+ *
+ * - Runs of consecutive instructions with an extension opcode that has a
+ *   Merge callback, like the vertex lists of the VBO module, are combined
+ *   so that they can be drawn with one call.
+ *
+ * - Vertex attribute updates which are overwritten by another update of
+ *   the same attribute before anything else happens are removed.
+ *   Position (attribute 0) may emit a vertex, so it ends such a sequence.
+ *
+ * The list isn't compacted: a removed instruction is overwritten with an
+ * OPCODE_SKIP, or a NOP if it is a single node, which stays in the list
+ * and is stepped over whenever the list is executed or printed.
+ */
+static void
+optimize_list(struct gl_context *ctx, struct gl_display_list *dlist)
+{
+   Node *attr_writes[VERT_ATTRIB_MAX];
+   Node **run = NULL, *last_skip = NULL, *n = dlist->Head;
+   void **data = NULL;
+   GLuint run_count = 0, run_size = 0;
+   GLboolean done = GL_FALSE;
+
+   memset(attr_writes, 0, sizeof(attr_writes));
+
+   while (!done) {
+      const OpCode opcode = n[0].opcode;
+      GLuint attr;
+
+      if (is_ext_opcode(opcode)) {
+         const struct gl_list_instruction *inst =
+            &ctx->ListExt->Opcode[opcode - OPCODE_EXT_0];
+
+         if (run_count && (run[0][0].opcode != opcode || !inst->Merge)) {
+            merge_run(ctx, run, data, run_count, &last_skip);
+            run_count = 0;
+         }
+
+         if (inst->Merge) {
+            if (run_count == run_size) {
+               const GLuint new_size = MAX2(2 * run_size, 16);
+               Node **new_run = realloc(run, new_size * sizeof(*run));
+               void **new_data = realloc(data, new_size * sizeof(*data));
+
+               if (new_run)
+                  run = new_run;
+               if (new_data)
+                  data = new_data;
+               if (!new_run || !new_data)
+                  break;
+               run_size = new_size;
+            }
+
+            run[run_count] = n;
+            data[run_count] = n + 1;
+            run_count++;
+         }
+
+         memset(attr_writes, 0, sizeof(attr_writes));
+         n += inst->Size;
+         continue;
+      }
+
+      switch (opcode) {
+      case OPCODE_NOP:
+         break;
+      case OPCODE_SKIP:
+         n += n[1].ui;
+         continue;
+      case OPCODE_CONTINUE:
+         n = (Node *) get_pointer(&n[1]);
+         continue;
+      case OPCODE_ATTR_1F_NV:
+      case OPCODE_ATTR_2F_NV:
+      case OPCODE_ATTR_3F_NV:
+      case OPCODE_ATTR_4F_NV:
+      case OPCODE_ATTR_1F_ARB:
+      case OPCODE_ATTR_2F_ARB:
+      case OPCODE_ATTR_3F_ARB:
+      case OPCODE_ATTR_4F_ARB:
+         if (run_count) {
+            merge_run(ctx, run, data, run_count, &last_skip);
+            run_count = 0;
+         }
+
+         attr = n[1].ui;
+         if (attr == 0) {
+            memset(attr_writes, 0, sizeof(attr_writes));
+            break;
+         }
+         if (opcode >= OPCODE_ATTR_1F_ARB)
+            attr = VERT_ATTRIB_GENERIC(attr);
+
+         if (attr_writes[attr]) {
+            remove_instruction(attr_writes[attr],
+                               InstSize[attr_writes[attr][0].opcode],
+                               &last_skip);
+         }
+         attr_writes[attr] = n;
+         break;
+      case OPCODE_END_OF_LIST:
+         done = GL_TRUE;
+         /* fall-through */
+      default:
+         if (run_count) {
+            merge_run(ctx, run, data, run_count, &last_skip);
+            run_count = 0;
+         }
+         memset(attr_writes, 0, sizeof(attr_writes));
+         break;
+      }
+
+      n += InstSize[opcode];
+   }
+
+   free(run);
+   free(data);
+}
+
+
 /*
  * Display List compilation functions
  */
@@ -9161,6 +9358,9 @@ execute_list(struct gl_context *ctx, GLuint list)
          case OPCODE_NOP:
             /* no-op */
             break;
+         case OPCODE_SKIP:
+            n += n[1].ui;
+            break;
          case OPCODE_END_OF_LIST:
             done = GL_TRUE;
             break;
@@ -9377,6 +9577,9 @@ _mesa_EndList(void)
 
    (void) alloc_instruction(ctx, OPCODE_END_OF_LIST, 0);
 
+   if (ctx->ListState.Optimize)
+      optimize_list(ctx, ctx->ListState.CurrentList);
+
    trim_list(ctx);
 
    /* Destroy old list, if any */
@@ -10357,6 +10560,10 @@ print_list(struct gl_context *ctx, GLuint list, const char *fname)
          case OPCODE_NOP:
             fprintf(f, "NOP\n");
             break;
+         case OPCODE_SKIP:
+            fprintf(f, "SKIP %u\n", n[1].ui);
+            n += n[1].ui;
+            break;
          case OPCODE_END_OF_LIST:
             fprintf(f, "END-LIST %u\n", list);
             done = GL_TRUE;
@@ -10508,6 +10715,8 @@ _mesa_init_display_list(struct gl_context *ctx)
 
    save_vtxfmt_init(&ctx->ListState.ListVtxfmt);
 
+   ctx->ListState.Optimize = !env_var_as_boolean("MESA_NO_DLIST_OPT", false);
+
    InstSize[OPCODE_NOP] = 1;
 }
 
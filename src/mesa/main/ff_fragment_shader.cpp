@@ -1253,8 +1253,9 @@ create_new_program(struct gl_context *ctx, struct state_key *key)
    const struct gl_shader_compiler_options *options =
       &ctx->Const.ShaderCompilerOptions[MESA_SHADER_FRAGMENT];
 
+   opt_pass_manager pm;
    while (do_common_optimization(p.shader->ir, false, false, options,
-                                 ctx->Const.NativeIntegers))
+                                 ctx->Const.NativeIntegers, &pm))
       ;
    reparent_ir(p.shader->ir, p.shader->ir);
 
@@ -26,6 +26,8 @@
 #include "glformats.h"
 #include "format_pack.h"
 #include "format_unpack.h"
+#include "main/sse_swizzle.h"
+#include "x86/common_x86_asm.h"
 
 const mesa_array_format RGBA32_FLOAT =
    MESA_ARRAY_FORMAT(4, 1, 1, 1, 4, 0, 1, 2, 3);
@@ -191,6 +193,27 @@ convert_ubyte_rgba_to_bgra(size_t width, size_t height,
 {
    int row;
 
+#if defined(USE_SSE41)
+   if (cpu_has_sse4_1) {
+      static const uint8_t swizzle[4] = { 2, 1, 0, 3 };
+
+      for (row = 0; row < height; row++) {
+         const int done =
+            _mesa_sse41_swizzle_bytes(dst, 4, src, 4, swizzle, 0, width);
+
+         /* the few pixels at the end of the row */
+         _mesa_swizzle_and_convert(dst + done * 4,
+                                   MESA_ARRAY_FORMAT_TYPE_UBYTE, 4,
+                                   src + done * 4,
+                                   MESA_ARRAY_FORMAT_TYPE_UBYTE, 4,
+                                   swizzle, false, width - done);
+         src += src_stride;
+         dst += dst_stride;
+      }
+      return;
+   }
+#endif
+
    if (sizeof(void *) == 8 &&
        src_stride % 8 == 0 &&
        dst_stride % 8 == 0 &&
@@ -1496,6 +1519,38 @@ _mesa_swizzle_and_convert(void *void_dst, enum mesa_array_format_datatype dst_ty
                                   swizzle, normalized, count))
       return;
 
+#if defined(USE_SSE41)
+   /* Swizzles between 8-bit channels are just byte shuffles. */
+   if (cpu_has_sse4_1 && src_type == dst_type &&
+       (dst_type == MESA_ARRAY_FORMAT_TYPE_UBYTE ||
+        dst_type == MESA_ARRAY_FORMAT_TYPE_BYTE)) {
+      const uint8_t one = !normalized ? 1 :
+         dst_type == MESA_ARRAY_FORMAT_TYPE_UBYTE ? UINT8_MAX : INT8_MAX;
+      const int done =
+         _mesa_sse41_swizzle_bytes(void_dst, num_dst_channels,
+                                   void_src, num_src_channels,
+                                   swizzle, one, count);
+
+      void_dst = (uint8_t *) void_dst + done * num_dst_channels;
+      void_src = (const uint8_t *) void_src + done * num_src_channels;
+      count -= done;
+   }
+
+   /* Float to 8-bit unorm, as when reading back float render targets. */
+   if (cpu_has_sse4_1 && normalized &&
+       src_type == MESA_ARRAY_FORMAT_TYPE_FLOAT &&
+       dst_type == MESA_ARRAY_FORMAT_TYPE_UBYTE) {
+      const int done =
+         _mesa_sse41_pack_float_unorm8(void_dst, num_dst_channels,
+                                       void_src, num_src_channels,
+                                       swizzle, count);
+
+      void_dst = (uint8_t *) void_dst + done * num_dst_channels;
+      void_src = (const float *) void_src + done * num_src_channels;
+      count -= done;
+   }
+#endif
+
    switch (dst_type) {
    case MESA_ARRAY_FORMAT_TYPE_FLOAT:
       convert_float(void_dst, num_dst_channels, void_src, src_type,
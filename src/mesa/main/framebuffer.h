@@ -28,6 +28,10 @@
 
 #include "mtypes.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct gl_config;
 struct gl_context;
 struct gl_renderbuffer;
@@ -149,4 +153,8 @@ _mesa_is_front_buffer_drawing(const struct gl_framebuffer *fb);
 extern bool
 _mesa_is_multisample_enabled(const struct gl_context *ctx);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* FRAMEBUFFER_H */
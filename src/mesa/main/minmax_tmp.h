@@ -0,0 +1,145 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file minmax_tmp.h
+ *
+ * Template for the vectorized index min/max scan, included by
+ * sse_minmax.c and avx2_minmax.c.  Before including it, define
+ *
+ *   VEC                  the vector type
+ *   VEC_LOAD(p)          unaligned load
+ *   VEC_STORE(p, v)      unaligned store
+ *   VEC_ZERO, VEC_ONES   all bits clear / set
+ *   VEC_OR, VEC_ANDNOT   bitwise operations, ANDNOT(a, b) = ~a & b
+ *   VEC_SET1_{8,16,32}   broadcast
+ *   VEC_CMPEQ_{8,16,32}  lane-wise equality
+ *   VEC_MIN_{8,16,32}    unsigned lane-wise minimum
+ *   VEC_MAX_{8,16,32}    unsigned lane-wise maximum
+ *   FUNC_NAME            name of the function to generate
+ */
+
+#define VEC_SIZE sizeof(VEC)
+
+/*
+ * Primitive restart indices are made neutral before they are folded in:
+ * all bits set for the minimum, all bits clear for the maximum.  Two
+ * vectors are processed per iteration to hide the latency of min/max.
+ */
+#define MINMAX_KERNEL(BITS, TYPE)                                            \
+static void                                                                  \
+minmax_##BITS(const TYPE *indices, unsigned count,                           \
+              bool restart, unsigned restart_index,                          \
+              unsigned *min_index, unsigned *max_index)                      \
+{                                                                            \
+   const unsigned lanes = VEC_SIZE / sizeof(TYPE);                           \
+   const VEC restart_vec = VEC_SET1_##BITS(restart_index);                   \
+   VEC min0 = VEC_ONES, min1 = VEC_ONES;                                     \
+   VEC max0 = VEC_ZERO, max1 = VEC_ZERO;                                     \
+   TYPE min_arr[VEC_SIZE / sizeof(TYPE)], max_arr[VEC_SIZE / sizeof(TYPE)];  \
+   unsigned min_val = ~0u, max_val = 0;                                      \
+   unsigned i = 0;                                                           \
+                                                                             \
+   if (restart) {                                                            \
+      for (; i + 2 * lanes <= count; i += 2 * lanes) {                       \
+         const VEC a = VEC_LOAD(indices + i);                                \
+         const VEC b = VEC_LOAD(indices + i + lanes);                        \
+         const VEC ra = VEC_CMPEQ_##BITS(a, restart_vec);                    \
+         const VEC rb = VEC_CMPEQ_##BITS(b, restart_vec);                    \
+         min0 = VEC_MIN_##BITS(min0, VEC_OR(a, ra));                         \
+         min1 = VEC_MIN_##BITS(min1, VEC_OR(b, rb));                         \
+         max0 = VEC_MAX_##BITS(max0, VEC_ANDNOT(ra, a));                     \
+         max1 = VEC_MAX_##BITS(max1, VEC_ANDNOT(rb, b));                     \
+      }                                                                      \
+   } else {                                                                  \
+      for (; i + 2 * lanes <= count; i += 2 * lanes) {                       \
+         const VEC a = VEC_LOAD(indices + i);                                \
+         const VEC b = VEC_LOAD(indices + i + lanes);                        \
+         min0 = VEC_MIN_##BITS(min0, a);                                     \
+         min1 = VEC_MIN_##BITS(min1, b);                                     \
+         max0 = VEC_MAX_##BITS(max0, a);                                     \
+         max1 = VEC_MAX_##BITS(max1, b);                                     \
+      }                                                                      \
+   }                                                                         \
+                                                                             \
+   if (i) {                                                                  \
+      unsigned j;                                                            \
+                                                                             \
+      VEC_STORE(min_arr, VEC_MIN_##BITS(min0, min1));                        \
+      VEC_STORE(max_arr, VEC_MAX_##BITS(max0, max1));                        \
+      for (j = 0; j < lanes; j++) {                                          \
+         if (min_arr[j] < min_val)                                           \
+            min_val = min_arr[j];                                            \
+         if (max_arr[j] > max_val)                                           \
+            max_val = max_arr[j];                                            \
+      }                                                                      \
+   }                                                                         \
+                                                                             \
+   for (; i < count; i++) {                                                  \
+      if (restart && indices[i] == restart_index)                            \
+         continue;                                                           \
+      if (indices[i] < min_val)                                              \
+         min_val = indices[i];                                               \
+      if (indices[i] > max_val)                                              \
+         max_val = indices[i];                                               \
+   }                                                                         \
+                                                                             \
+   /* Only restart indices: the neutral values win, report no indices. */   \
+   if (min_val > max_val) {                                                  \
+      min_val = ~0u;                                                         \
+      max_val = 0;                                                           \
+   }                                                                         \
+                                                                             \
+   *min_index = min_val;                                                     \
+   *max_index = max_val;                                                     \
+}
+
+MINMAX_KERNEL(8, uint8_t)
+MINMAX_KERNEL(16, uint16_t)
+MINMAX_KERNEL(32, uint32_t)
+
+
+void
+FUNC_NAME(const void *indices, unsigned index_size, unsigned count,
+          bool restart, unsigned restart_index,
+          unsigned *min_index, unsigned *max_index)
+{
+   /* A restart index that doesn't fit the index type never matches. */
+   if (index_size < 4 && restart_index >> (index_size * 8))
+      restart = false;
+
+   switch (index_size) {
+   case 1:
+      minmax_8(indices, count, restart, restart_index, min_index, max_index);
+      break;
+   case 2:
+      minmax_16(indices, count, restart, restart_index, min_index, max_index);
+      break;
+   default:
+      minmax_32(indices, count, restart, restart_index, min_index, max_index);
+      break;
+   }
+}
+
+#undef MINMAX_KERNEL
+#undef VEC_SIZE
@@ -28,6 +28,7 @@
  */
 
 #include "imports.h"
+#include "context.h"
 #include "formats.h"
 #include "glformats.h"
 #include "mipmap.h"
@@ -37,10 +38,15 @@
 #include "texstore.h"
 #include "image.h"
 #include "macros.h"
+#include "util/format_srgb.h"
 #include "util/half_float.h"
 #include "../../gallium/auxiliary/util/u_format_rgb9e5.h"
 #include "../../gallium/auxiliary/util/u_format_r11g11b10f.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 
 
 static GLint
@@ -138,6 +144,239 @@ bytes_per_pixel(GLenum datatype, GLuint comps)
 /*@}*/
 
 
+/**
+ * Average sRGB-encoded 8-bit texels in linear space.  The components
+ * whose bit is set in \p srgb are decoded to linear before filtering and
+ * re-encoded afterwards, the others (alpha) are filtered like in do_row()
+ * and do_row_3D().
+ */
+/*@{*/
+static void
+do_row_srgb(GLuint comps, GLbitfield srgb, GLint srcWidth,
+            const GLubyte *rowA, const GLubyte *rowB,
+            GLint dstWidth, GLubyte *dst)
+{
+   const float *lin = util_format_srgb_8unorm_to_linear_float_table;
+   const GLuint k0 = (srcWidth == dstWidth) ? 0 : 1;
+   const GLuint colStride = (srcWidth == dstWidth) ? 1 : 2;
+   GLuint i, j, k, c;
+
+   for (i = j = 0, k = k0; i < (GLuint) dstWidth;
+        i++, j += colStride, k += colStride) {
+      for (c = 0; c < comps; c++) {
+         const GLubyte aj = rowA[j * comps + c], ak = rowA[k * comps + c];
+         const GLubyte bj = rowB[j * comps + c], bk = rowB[k * comps + c];
+
+         if (srgb & (1 << c)) {
+            dst[i * comps + c] = util_format_linear_float_to_srgb_8unorm(
+               (lin[aj] + lin[ak] + lin[bj] + lin[bk]) * 0.25F);
+         }
+         else {
+            dst[i * comps + c] = (aj + ak + bj + bk) / 4;
+         }
+      }
+   }
+}
+
+static void
+do_row_3D_srgb(GLuint comps, GLbitfield srgb, GLint srcWidth,
+               const GLubyte *rowA, const GLubyte *rowB,
+               const GLubyte *rowC, const GLubyte *rowD,
+               GLint dstWidth, GLubyte *dst)
+{
+   const float *lin = util_format_srgb_8unorm_to_linear_float_table;
+   const GLuint k0 = (srcWidth == dstWidth) ? 0 : 1;
+   const GLuint colStride = (srcWidth == dstWidth) ? 1 : 2;
+   GLuint i, j, k, c;
+
+   for (i = j = 0, k = k0; i < (GLuint) dstWidth;
+        i++, j += colStride, k += colStride) {
+      for (c = 0; c < comps; c++) {
+         const GLuint jc = j * comps + c, kc = k * comps + c;
+
+         if (srgb & (1 << c)) {
+            dst[i * comps + c] = util_format_linear_float_to_srgb_8unorm(
+               (lin[rowA[jc]] + lin[rowA[kc]] + lin[rowB[jc]] + lin[rowB[kc]] +
+                lin[rowC[jc]] + lin[rowC[kc]] + lin[rowD[jc]] + lin[rowD[kc]])
+               * 0.125F);
+         }
+         else {
+            dst[i * comps + c] = FILTER_SUM_3D(rowA[jc], rowA[kc],
+                                               rowB[jc], rowB[kc],
+                                               rowC[jc], rowC[kc],
+                                               rowD[jc], rowD[kc]);
+         }
+      }
+   }
+}
+/*@}*/
+
+
+#if defined(__SSE2__)
+
+/**
+ * SSE2 versions of the 4-component cases of do_row().  They produce the
+ * same bits as the C code: the sums are done in the same order and the
+ * half float conversions match _mesa_half_to_float() and
+ * _mesa_float_to_half(), including denormals, infinities and NaNs.
+ */
+/*@{*/
+
+/**
+ * Filter the first dstWidth & ~3 pixels of a 2:1 GLubyte[4] row, the
+ * caller does the rest.
+ */
+static GLuint
+do_row_ubyte4_sse2(const GLubyte *rowA, const GLubyte *rowB,
+                   GLuint dstWidth, GLubyte *dst)
+{
+   const __m128i zero = _mm_setzero_si128();
+   GLuint i;
+
+   for (i = 0; i + 4 <= dstWidth; i += 4) {
+      const __m128i a0 = _mm_loadu_si128((const __m128i *) (rowA + i * 8));
+      const __m128i a1 = _mm_loadu_si128((const __m128i *) (rowA + i * 8 + 16));
+      const __m128i b0 = _mm_loadu_si128((const __m128i *) (rowB + i * 8));
+      const __m128i b1 = _mm_loadu_si128((const __m128i *) (rowB + i * 8 + 16));
+      /* vertical sums of the source pixels, two per register */
+      const __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero),
+                                       _mm_unpacklo_epi8(b0, zero));
+      const __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero),
+                                       _mm_unpackhi_epi8(b0, zero));
+      const __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero),
+                                       _mm_unpacklo_epi8(b1, zero));
+      const __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero),
+                                       _mm_unpackhi_epi8(b1, zero));
+      /* add horizontally adjacent pixels */
+      const __m128i d01 = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1),
+                                        _mm_unpackhi_epi64(s0, s1));
+      const __m128i d23 = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3),
+                                        _mm_unpackhi_epi64(s2, s3));
+
+      _mm_storeu_si128((__m128i *) (dst + i * 4),
+                       _mm_packus_epi16(_mm_srli_epi16(d01, 2),
+                                        _mm_srli_epi16(d23, 2)));
+   }
+
+   return i;
+}
+
+static void
+do_row_float4_sse2(const GLfloat *rowA, const GLfloat *rowB,
+                   GLuint k0, GLuint colStride,
+                   GLuint dstWidth, GLfloat *dst)
+{
+   const __m128 quarter = _mm_set1_ps(0.25F);
+   GLuint i, j, k;
+
+   for (i = j = 0, k = k0; i < dstWidth;
+        i++, j += colStride, k += colStride) {
+      __m128 sum = _mm_add_ps(_mm_loadu_ps(rowA + j * 4),
+                              _mm_loadu_ps(rowA + k * 4));
+      sum = _mm_add_ps(sum, _mm_loadu_ps(rowB + j * 4));
+      sum = _mm_add_ps(sum, _mm_loadu_ps(rowB + k * 4));
+      _mm_storeu_ps(dst + i * 4, _mm_mul_ps(sum, quarter));
+   }
+}
+
+/** Convert the four half floats in the low half of \p h */
+static inline __m128
+half4_to_float4(__m128i h)
+{
+   const __m128i h32 = _mm_unpacklo_epi16(h, _mm_setzero_si128());
+   const __m128i expmant = _mm_and_si128(h32, _mm_set1_epi32(0x7fff));
+   const __m128i sign = _mm_slli_epi32(_mm_xor_si128(h32, expmant), 16);
+   /* rebias the exponent of normal numbers */
+   const __m128i normal = _mm_add_epi32(_mm_slli_epi32(expmant, 13),
+                                        _mm_set1_epi32((127 - 15) << 23));
+   /* denormals and zero: renormalize by subtracting the implicit one */
+   const __m128 one = _mm_castsi128_ps(_mm_set1_epi32(113 << 23));
+   const __m128i denorm = _mm_castps_si128(
+      _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(normal,
+                                                _mm_set1_epi32(1 << 23))),
+                 one));
+   const __m128i small = _mm_cmplt_epi32(expmant, _mm_set1_epi32(0x0400));
+   const __m128i infnan = _mm_cmpgt_epi32(expmant, _mm_set1_epi32(0x7bff));
+   const __m128i nan = _mm_cmpgt_epi32(expmant, _mm_set1_epi32(0x7c00));
+   const __m128i special =
+      _mm_or_si128(_mm_set1_epi32(0x7f800000),
+                   _mm_and_si128(nan, _mm_set1_epi32(1)));
+   __m128i f;
+
+   f = _mm_or_si128(_mm_and_si128(small, denorm),
+                    _mm_andnot_si128(small, normal));
+   f = _mm_or_si128(_mm_and_si128(infnan, special),
+                    _mm_andnot_si128(infnan, f));
+
+   return _mm_castsi128_ps(_mm_or_si128(f, sign));
+}
+
+/**
+ * Convert four floats to half floats, rounding to nearest even.  The
+ * results are returned sign extended to 32 bits, ready for packing.
+ */
+static inline __m128i
+float4_to_half4(__m128 f)
+{
+   const __m128i bits = _mm_castps_si128(f);
+   const __m128i sign = _mm_and_si128(bits, _mm_set1_epi32(0x80000000));
+   const __m128i abs = _mm_xor_si128(bits, sign);
+   /* too large for a half float, infinity or NaN */
+   const __m128i big = _mm_cmpgt_epi32(abs, _mm_set1_epi32((143 << 23) - 1));
+   const __m128i infnan =
+      _mm_or_si128(_mm_set1_epi32(0x7c00),
+                   _mm_and_si128(_mm_cmpgt_epi32(abs,
+                                                 _mm_set1_epi32(0x7f800000)),
+                                 _mm_set1_epi32(1)));
+   /* results that are denormal or zero, let the FPU do the rounding */
+   const __m128i small = _mm_cmplt_epi32(abs, _mm_set1_epi32(113 << 23));
+   const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(126 << 23));
+   const __m128i denorm =
+      _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(abs), magic)),
+                    _mm_castps_si128(magic));
+   /* normal results, rebias and round the mantissa to nearest even */
+   const __m128i rebias = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+   const __m128i odd = _mm_and_si128(_mm_srli_epi32(abs, 13),
+                                     _mm_set1_epi32(1));
+   const __m128i normal =
+      _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(abs, rebias), odd), 13);
+   __m128i h;
+
+   h = _mm_or_si128(_mm_and_si128(small, denorm),
+                    _mm_andnot_si128(small, normal));
+   h = _mm_or_si128(_mm_and_si128(big, infnan), _mm_andnot_si128(big, h));
+   h = _mm_or_si128(h, _mm_srli_epi32(sign, 16));
+
+   return _mm_srai_epi32(_mm_slli_epi32(h, 16), 16);
+}
+
+static void
+do_row_half4_sse2(const GLhalfARB *rowA, const GLhalfARB *rowB,
+                  GLuint k0, GLuint colStride,
+                  GLuint dstWidth, GLhalfARB *dst)
+{
+   const __m128 quarter = _mm_set1_ps(0.25F);
+   GLuint i, j, k;
+
+   for (i = j = 0, k = k0; i < dstWidth;
+        i++, j += colStride, k += colStride) {
+      __m128 sum, aj, ak, bj, bk;
+      __m128i h;
+
+      aj = half4_to_float4(_mm_loadl_epi64((const __m128i *) (rowA + j * 4)));
+      ak = half4_to_float4(_mm_loadl_epi64((const __m128i *) (rowA + k * 4)));
+      bj = half4_to_float4(_mm_loadl_epi64((const __m128i *) (rowB + j * 4)));
+      bk = half4_to_float4(_mm_loadl_epi64((const __m128i *) (rowB + k * 4)));
+      sum = _mm_add_ps(_mm_add_ps(_mm_add_ps(aj, ak), bj), bk);
+      h = float4_to_half4(_mm_mul_ps(sum, quarter));
+      _mm_storel_epi64((__m128i *) (dst + i * 4), _mm_packs_epi32(h, h));
+   }
+}
+/*@}*/
+
+#endif /* __SSE2__ */
+
+
 /**
  * Average together two rows of a source image to produce a single new
  * row in the dest image.  It's legal for the two source rows to point
@@ -145,9 +384,10 @@ bytes_per_pixel(GLenum datatype, GLuint comps)
  * dest width or two times the dest width.
  * \param datatype  GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT, GL_FLOAT, etc.
  * \param comps  number of components per pixel (1..4)
+ * \param srgb  mask of the sRGB-encoded components of GL_UNSIGNED_BYTE data
  */
 static void
-do_row(GLenum datatype, GLuint comps, GLint srcWidth,
+do_row(GLenum datatype, GLuint comps, GLbitfield srgb, GLint srcWidth,
        const GLvoid *srcRowA, const GLvoid *srcRowB,
        GLint dstWidth, GLvoid *dstRow)
 {
@@ -161,12 +401,20 @@ do_row(GLenum datatype, GLuint comps, GLint srcWidth,
    assert(srcWidth == dstWidth || srcWidth == 2 * dstWidth);
    */
 
-   if (datatype == GL_UNSIGNED_BYTE && comps == 4) {
-      GLuint i, j, k;
+   if (srgb) {
+      assert(datatype == GL_UNSIGNED_BYTE);
+      do_row_srgb(comps, srgb, srcWidth, srcRowA, srcRowB, dstWidth, dstRow);
+   }
+   else if (datatype == GL_UNSIGNED_BYTE && comps == 4) {
+      GLuint i = 0, j, k;
       const GLubyte(*rowA)[4] = (const GLubyte(*)[4]) srcRowA;
       const GLubyte(*rowB)[4] = (const GLubyte(*)[4]) srcRowB;
       GLubyte(*dst)[4] = (GLubyte(*)[4]) dstRow;
-      for (i = j = 0, k = k0; i < (GLuint) dstWidth;
+#if defined(__SSE2__)
+      if (colStride == 2)
+         i = do_row_ubyte4_sse2(srcRowA, srcRowB, dstWidth, dstRow);
+#endif
+      for (j = i * colStride, k = j + k0; i < (GLuint) dstWidth;
            i++, j += colStride, k += colStride) {
          dst[i][0] = (rowA[j][0] + rowA[k][0] + rowB[j][0] + rowB[k][0]) / 4;
          dst[i][1] = (rowA[j][1] + rowA[k][1] + rowB[j][1] + rowB[k][1]) / 4;
@@ -350,6 +598,9 @@ do_row(GLenum datatype, GLuint comps, GLint srcWidth,
    }
 
    else if (datatype == GL_FLOAT && comps == 4) {
+#if defined(__SSE2__)
+      do_row_float4_sse2(srcRowA, srcRowB, k0, colStride, dstWidth, dstRow);
+#else
       GLuint i, j, k;
       const GLfloat(*rowA)[4] = (const GLfloat(*)[4]) srcRowA;
       const GLfloat(*rowB)[4] = (const GLfloat(*)[4]) srcRowB;
@@ -365,6 +616,7 @@ do_row(GLenum datatype, GLuint comps, GLint srcWidth,
          dst[i][3] = (rowA[j][3] + rowA[k][3] +
                       rowB[j][3] + rowB[k][3]) * 0.25F;
       }
+#endif
    }
    else if (datatype == GL_FLOAT && comps == 3) {
       GLuint i, j, k;
@@ -406,6 +658,9 @@ do_row(GLenum datatype, GLuint comps, GLint srcWidth,
    }
 
    else if (datatype == GL_HALF_FLOAT_ARB && comps == 4) {
+#if defined(__SSE2__)
+      do_row_half4_sse2(srcRowA, srcRowB, k0, colStride, dstWidth, dstRow);
+#else
       GLuint i, j, k, comp;
       const GLhalfARB(*rowA)[4] = (const GLhalfARB(*)[4]) srcRowA;
       const GLhalfARB(*rowB)[4] = (const GLhalfARB(*)[4]) srcRowB;
@@ -421,6 +676,7 @@ do_row(GLenum datatype, GLuint comps, GLint srcWidth,
             dst[i][comp] = _mesa_float_to_half((aj + ak + bj + bk) * 0.25F);
          }
       }
+#endif
    }
    else if (datatype == GL_HALF_FLOAT_ARB && comps == 3) {
       GLuint i, j, k, comp;
@@ -771,6 +1027,8 @@ do_row(GLenum datatype, GLuint comps, GLint srcWidth,
  * \param datatype  GL pixel type \c GL_UNSIGNED_BYTE, \c GL_UNSIGNED_SHORT,
  *                  \c GL_FLOAT, etc.
  * \param comps     number of components per pixel (1..4)
+ * \param srgb      mask of the sRGB-encoded components of GL_UNSIGNED_BYTE
+ *                  data
  * \param srcWidth  Width of a row in the source data
  * \param srcRowA   Pointer to one of the rows of source data
  * \param srcRowB   Pointer to one of the rows of source data
@@ -780,7 +1038,7 @@ do_row(GLenum datatype, GLuint comps, GLint srcWidth,
  * \param srcRowA   Pointer to the row of destination data
  */
 static void
-do_row_3D(GLenum datatype, GLuint comps, GLint srcWidth,
+do_row_3D(GLenum datatype, GLuint comps, GLbitfield srgb, GLint srcWidth,
           const GLvoid *srcRowA, const GLvoid *srcRowB,
           const GLvoid *srcRowC, const GLvoid *srcRowD,
           GLint dstWidth, GLvoid *dstRow)
@@ -792,7 +1050,12 @@ do_row_3D(GLenum datatype, GLuint comps, GLint srcWidth,
    assert(comps >= 1);
    assert(comps <= 4);
 
-   if ((datatype == GL_UNSIGNED_BYTE) && (comps == 4)) {
+   if (srgb) {
+      assert(datatype == GL_UNSIGNED_BYTE);
+      do_row_3D_srgb(comps, srgb, srcWidth, srcRowA, srcRowB,
+                     srcRowC, srcRowD, dstWidth, dstRow);
+   }
+   else if ((datatype == GL_UNSIGNED_BYTE) && (comps == 4)) {
       DECLARE_ROW_POINTERS(GLubyte, 4);
 
       for (i = j = 0, k = k0; i < (GLuint) dstWidth;
@@ -1413,7 +1676,8 @@ do_row_3D(GLenum datatype, GLuint comps, GLint srcWidth,
  */
 
 static void
-make_1d_mipmap(GLenum datatype, GLuint comps, GLint border,
+make_1d_mipmap(GLenum datatype, GLuint comps, GLbitfield srgb,
+               GLint border,
                GLint srcWidth, const GLubyte *srcPtr,
                GLint dstWidth, GLubyte *dstPtr)
 {
@@ -1426,7 +1690,7 @@ make_1d_mipmap(GLenum datatype, GLuint comps, GLint border,
    dst = dstPtr + border * bpt;
 
    /* we just duplicate the input row, kind of hack, saves code */
-   do_row(datatype, comps, srcWidth - 2 * border, src, src,
+   do_row(datatype, comps, srgb, srcWidth - 2 * border, src, src,
           dstWidth - 2 * border, dst);
 
    if (border) {
@@ -1442,17 +1706,22 @@ make_1d_mipmap(GLenum datatype, GLuint comps, GLint border,
 }
 
 
+/**
+ * Filter the rows [firstRow, firstRow + numRows) of the interior (the
+ * image without its border) of a 2D mipmap image.
+ */
 static void
-make_2d_mipmap(GLenum datatype, GLuint comps, GLint border,
-               GLint srcWidth, GLint srcHeight,
-	       const GLubyte *srcPtr, GLint srcRowStride,
-               GLint dstWidth, GLint dstHeight,
-	       GLubyte *dstPtr, GLint dstRowStride)
+make_2d_mipmap_rows(GLenum datatype, GLuint comps, GLbitfield srgb,
+                    GLint border,
+                    GLint srcWidth, GLint srcHeight,
+                    const GLubyte *srcPtr, GLint srcRowStride,
+                    GLint dstWidth, GLint dstHeight,
+                    GLubyte *dstPtr, GLint dstRowStride,
+                    GLint firstRow, GLint numRows)
 {
    const GLint bpt = bytes_per_pixel(datatype, comps);
    const GLint srcWidthNB = srcWidth - 2 * border;  /* sizes w/out border */
    const GLint dstWidthNB = dstWidth - 2 * border;
-   const GLint dstHeightNB = dstHeight - 2 * border;
    const GLubyte *srcA, *srcB;
    GLubyte *dst;
    GLint row, srcRowStep;
@@ -1472,13 +1741,33 @@ make_2d_mipmap(GLenum datatype, GLuint comps, GLint border,
 
    dst = dstPtr + border * ((dstWidth + 1) * bpt);
 
-   for (row = 0; row < dstHeightNB; row++) {
-      do_row(datatype, comps, srcWidthNB, srcA, srcB,
+   srcA += firstRow * srcRowStep * srcRowStride;
+   srcB += firstRow * srcRowStep * srcRowStride;
+   dst += firstRow * dstRowStride;
+
+   for (row = 0; row < numRows; row++) {
+      do_row(datatype, comps, srgb, srcWidthNB, srcA, srcB,
              dstWidthNB, dst);
       srcA += srcRowStep * srcRowStride;
       srcB += srcRowStep * srcRowStride;
       dst += dstRowStride;
    }
+}
+
+
+static void
+make_2d_mipmap_border(GLenum datatype, GLuint comps, GLbitfield srgb,
+                      GLint border,
+                      GLint srcWidth, GLint srcHeight,
+                      const GLubyte *srcPtr, GLint srcRowStride,
+                      GLint dstWidth, GLint dstHeight,
+                      GLubyte *dstPtr, GLint dstRowStride)
+{
+   const GLint bpt = bytes_per_pixel(datatype, comps);
+   const GLint srcWidthNB = srcWidth - 2 * border;  /* sizes w/out border */
+   const GLint dstWidthNB = dstWidth - 2 * border;
+   const GLint dstHeightNB = dstHeight - 2 * border;
+   GLint row;
 
    /* This is ugly but probably won't be used much */
    if (border > 0) {
@@ -1497,12 +1786,12 @@ make_2d_mipmap(GLenum datatype, GLuint comps, GLint border,
       memcpy(dstPtr + (dstWidth * dstHeight - 1) * bpt,
              srcPtr + (srcWidth * srcHeight - 1) * bpt, bpt);
       /* lower border */
-      do_row(datatype, comps, srcWidthNB,
+      do_row(datatype, comps, srgb, srcWidthNB,
              srcPtr + bpt,
              srcPtr + bpt,
              dstWidthNB, dstPtr + bpt);
       /* upper border */
-      do_row(datatype, comps, srcWidthNB,
+      do_row(datatype, comps, srgb, srcWidthNB,
              srcPtr + (srcWidth * (srcHeight - 1) + 1) * bpt,
              srcPtr + (srcWidth * (srcHeight - 1) + 1) * bpt,
              dstWidthNB,
@@ -1520,11 +1809,11 @@ make_2d_mipmap(GLenum datatype, GLuint comps, GLint border,
       else {
          /* average two src pixels each dest pixel */
          for (row = 0; row < dstHeightNB; row += 2) {
-            do_row(datatype, comps, 1,
+            do_row(datatype, comps, srgb, 1,
                    srcPtr + (srcWidth * (row * 2 + 1)) * bpt,
                    srcPtr + (srcWidth * (row * 2 + 2)) * bpt,
                    1, dstPtr + (dstWidth * row + 1) * bpt);
-            do_row(datatype, comps, 1,
+            do_row(datatype, comps, srgb, 1,
                    srcPtr + (srcWidth * (row * 2 + 1) + srcWidth - 1) * bpt,
                    srcPtr + (srcWidth * (row * 2 + 2) + srcWidth - 1) * bpt,
                    1, dstPtr + (dstWidth * row + 1 + dstWidth - 1) * bpt);
@@ -1535,27 +1824,42 @@ make_2d_mipmap(GLenum datatype, GLuint comps, GLint border,
 
 
 static void
-make_3d_mipmap(GLenum datatype, GLuint comps, GLint border,
-               GLint srcWidth, GLint srcHeight, GLint srcDepth,
-               const GLubyte **srcPtr, GLint srcRowStride,
-               GLint dstWidth, GLint dstHeight, GLint dstDepth,
-               GLubyte **dstPtr, GLint dstRowStride)
+make_2d_mipmap(GLenum datatype, GLuint comps, GLbitfield srgb,
+               GLint border,
+               GLint srcWidth, GLint srcHeight,
+	       const GLubyte *srcPtr, GLint srcRowStride,
+               GLint dstWidth, GLint dstHeight,
+	       GLubyte *dstPtr, GLint dstRowStride)
+{
+   make_2d_mipmap_rows(datatype, comps, srgb, border,
+                       srcWidth, srcHeight, srcPtr, srcRowStride,
+                       dstWidth, dstHeight, dstPtr, dstRowStride,
+                       0, dstHeight - 2 * border);
+   make_2d_mipmap_border(datatype, comps, srgb, border,
+                         srcWidth, srcHeight, srcPtr, srcRowStride,
+                         dstWidth, dstHeight, dstPtr, dstRowStride);
+}
+
+
+/**
+ * Filter the rows [firstRow, firstRow + numRows) of the interior of the
+ * image img (counted without the border) of a 3D mipmap level.
+ */
+static void
+make_3d_mipmap_rows(GLenum datatype, GLuint comps, GLbitfield srgb,
+                    GLint border,
+                    GLint srcWidth, GLint srcHeight, GLint srcDepth,
+                    const GLubyte **srcPtr, GLint srcRowStride,
+                    GLint dstWidth, GLint dstHeight, GLint dstDepth,
+                    GLubyte **dstPtr, GLint dstRowStride,
+                    GLint img, GLint firstRow, GLint numRows)
 {
    const GLint bpt = bytes_per_pixel(datatype, comps);
    const GLint srcWidthNB = srcWidth - 2 * border;  /* sizes w/out border */
-   const GLint srcDepthNB = srcDepth - 2 * border;
    const GLint dstWidthNB = dstWidth - 2 * border;
-   const GLint dstHeightNB = dstHeight - 2 * border;
-   const GLint dstDepthNB = dstDepth - 2 * border;
-   GLint img, row;
-   GLint bytesPerSrcImage, bytesPerDstImage;
+   GLint row;
    GLint srcImageOffset, srcRowOffset;
 
-   (void) srcDepthNB; /* silence warnings */
-
-   bytesPerSrcImage = srcRowStride * srcHeight * bpt;
-   bytesPerDstImage = dstRowStride * dstHeight * bpt;
-
    /* Offset between adjacent src images to be averaged together */
    srcImageOffset = (srcDepth == dstDepth) ? 0 : 1;
 
@@ -1575,7 +1879,7 @@ make_3d_mipmap(GLenum datatype, GLuint comps, GLint border,
           srcWidth, srcHeight, srcDepth, dstWidth, dstHeight, dstDepth);
    */
 
-   for (img = 0; img < dstDepthNB; img++) {
+   {
       /* first source image pointer, skipping border */
       const GLubyte *imgSrcA = srcPtr[img * 2 + border]
          + srcRowStride * border + bpt * border;
@@ -1588,14 +1892,15 @@ make_3d_mipmap(GLenum datatype, GLuint comps, GLint border,
          + dstRowStride * border + bpt * border;
 
       /* setup the four source row pointers and the dest row pointer */
-      const GLubyte *srcImgARowA = imgSrcA;
-      const GLubyte *srcImgARowB = imgSrcA + srcRowOffset;
-      const GLubyte *srcImgBRowA = imgSrcB;
-      const GLubyte *srcImgBRowB = imgSrcB + srcRowOffset;
-      GLubyte *dstImgRow = imgDst;
-
-      for (row = 0; row < dstHeightNB; row++) {
-         do_row_3D(datatype, comps, srcWidthNB, 
+      const GLint srcRowSkip = firstRow * (srcRowStride + srcRowOffset);
+      const GLubyte *srcImgARowA = imgSrcA + srcRowSkip;
+      const GLubyte *srcImgARowB = imgSrcA + srcRowSkip + srcRowOffset;
+      const GLubyte *srcImgBRowA = imgSrcB + srcRowSkip;
+      const GLubyte *srcImgBRowB = imgSrcB + srcRowSkip + srcRowOffset;
+      GLubyte *dstImgRow = imgDst + firstRow * dstRowStride;
+
+      for (row = 0; row < numRows; row++) {
+         do_row_3D(datatype, comps, srgb, srcWidthNB,
                    srcImgARowA, srcImgARowB,
                    srcImgBRowA, srcImgBRowB,
                    dstWidthNB, dstImgRow);
@@ -1608,16 +1913,40 @@ make_3d_mipmap(GLenum datatype, GLuint comps, GLint border,
          dstImgRow += dstRowStride;
       }
    }
+}
 
 
+static void
+make_3d_mipmap_border(GLenum datatype, GLuint comps, GLbitfield srgb,
+                      GLint border,
+                      GLint srcWidth, GLint srcHeight, GLint srcDepth,
+                      const GLubyte **srcPtr, GLint srcRowStride,
+                      GLint dstWidth, GLint dstHeight, GLint dstDepth,
+                      GLubyte **dstPtr, GLint dstRowStride)
+{
+   const GLint bpt = bytes_per_pixel(datatype, comps);
+   const GLint srcDepthNB = srcDepth - 2 * border;
+   const GLint dstDepthNB = dstDepth - 2 * border;
+   GLint img;
+   GLint bytesPerSrcImage, bytesPerDstImage;
+   GLint srcImageOffset;
+
+   (void) srcDepthNB; /* silence warnings */
+
+   bytesPerSrcImage = srcRowStride * srcHeight * bpt;
+   bytesPerDstImage = dstRowStride * dstHeight * bpt;
+
+   /* Offset between adjacent src images to be averaged together */
+   srcImageOffset = (srcDepth == dstDepth) ? 0 : 1;
+
    /* Luckily we can leverage the make_2d_mipmap() function here! */
    if (border > 0) {
       /* do front border image */
-      make_2d_mipmap(datatype, comps, 1,
+      make_2d_mipmap(datatype, comps, srgb, 1,
                      srcWidth, srcHeight, srcPtr[0], srcRowStride,
                      dstWidth, dstHeight, dstPtr[0], dstRowStride);
       /* do back border image */
-      make_2d_mipmap(datatype, comps, 1,
+      make_2d_mipmap(datatype, comps, srgb, 1,
                      srcWidth, srcHeight, srcPtr[srcDepth - 1], srcRowStride,
                      dstWidth, dstHeight, dstPtr[dstDepth - 1], dstRowStride);
 
@@ -1660,7 +1989,7 @@ make_3d_mipmap(GLenum datatype, GLuint comps, GLint border,
             srcA = srcPtr[img * 2 + 0];
             srcB = srcPtr[img * 2 + srcImageOffset];
             dst = dstPtr[img];
-            do_row(datatype, comps, 1, srcA, srcB, 1, dst);
+            do_row(datatype, comps, srgb, 1, srcA, srcB, 1, dst);
 
             /* do border along [img][row=dstHeight-1][col=0] */
             srcA = srcPtr[img * 2 + 0]
@@ -1668,36 +1997,91 @@ make_3d_mipmap(GLenum datatype, GLuint comps, GLint border,
             srcB = srcPtr[img * 2 + srcImageOffset]
                + (srcHeight - 1) * srcRowStride;
             dst = dstPtr[img] + (dstHeight - 1) * dstRowStride;
-            do_row(datatype, comps, 1, srcA, srcB, 1, dst);
+            do_row(datatype, comps, srgb, 1, srcA, srcB, 1, dst);
 
             /* do border along [img][row=0][col=dstWidth-1] */
             srcA = srcPtr[img * 2 + 0] + (srcWidth - 1) * bpt;
             srcB = srcPtr[img * 2 + srcImageOffset] + (srcWidth - 1) * bpt;
             dst = dstPtr[img] + (dstWidth - 1) * bpt;
-            do_row(datatype, comps, 1, srcA, srcB, 1, dst);
+            do_row(datatype, comps, srgb, 1, srcA, srcB, 1, dst);
 
             /* do border along [img][row=dstHeight-1][col=dstWidth-1] */
             srcA = srcPtr[img * 2 + 0] + (bytesPerSrcImage - bpt);
             srcB = srcPtr[img * 2 + srcImageOffset] + (bytesPerSrcImage - bpt);
             dst = dstPtr[img] + (bytesPerDstImage - bpt);
-            do_row(datatype, comps, 1, srcA, srcB, 1, dst);
+            do_row(datatype, comps, srgb, 1, srcA, srcB, 1, dst);
          }
       }
    }
 }
 
 
+struct mipmap_bands {
+   GLenum target;
+   GLenum datatype;
+   GLuint comps;
+   GLbitfield srgb;
+   GLint border;
+   GLint srcWidth, srcHeight, srcDepth;
+   const GLubyte **srcData;
+   GLint srcRowStride;
+   GLint dstWidth, dstHeight, dstDepth;
+   GLubyte **dstData;
+   GLint dstRowStride;
+};
+
+static void
+filter_rows(void *data, unsigned slice, unsigned row, unsigned rows)
+{
+   const struct mipmap_bands *b = data;
+
+   if (b->target == GL_TEXTURE_3D) {
+      make_3d_mipmap_rows(b->datatype, b->comps, b->srgb, b->border,
+                          b->srcWidth, b->srcHeight, b->srcDepth,
+                          b->srcData, b->srcRowStride,
+                          b->dstWidth, b->dstHeight, b->dstDepth,
+                          b->dstData, b->dstRowStride,
+                          slice, row, rows);
+   }
+   else {
+      make_2d_mipmap_rows(b->datatype, b->comps, b->srgb, b->border,
+                          b->srcWidth, b->srcHeight,
+                          b->srcData[slice], b->srcRowStride,
+                          b->dstWidth, b->dstHeight,
+                          b->dstData[slice], b->dstRowStride,
+                          row, rows);
+   }
+}
+
+/**
+ * Filter the interior of all the images of a 2D, 2D array, cube array or
+ * 3D mipmap level, in bands of rows on the worker threads of the context
+ * if the level is large.
+ */
+static void
+filter_level_bands(struct gl_context *ctx, struct mipmap_bands *b,
+                   GLint numImages)
+{
+   _mesa_parallel_image_rows(ctx, b->dstWidth - 2 * b->border,
+                             b->dstHeight - 2 * b->border, numImages,
+                             filter_rows, b);
+}
+
+
 /**
  * Down-sample a texture image to produce the next lower mipmap level.
+ * \param ctx  context whose worker threads may be used, or NULL
  * \param comps  components per texel (1, 2, 3 or 4)
+ * \param srgb  mask of the components of GL_UNSIGNED_BYTE texels which are
+ *              sRGB-encoded and get filtered in linear space
  * \param srcData  array[slice] of pointers to source image slices
  * \param dstData  array[slice] of pointers to dest image slices
  * \param srcRowStride  stride between source rows, in bytes
  * \param dstRowStride  stride between destination rows, in bytes
  */
 void
-_mesa_generate_mipmap_level(GLenum target,
-                            GLenum datatype, GLuint comps,
+_mesa_generate_mipmap_level(struct gl_context *ctx, GLenum target,
+                            GLenum datatype, GLuint comps, GLbitfield srgb,
                             GLint border,
                             GLint srcWidth, GLint srcHeight, GLint srcDepth,
                             const GLubyte **srcData,
@@ -1706,11 +2090,28 @@ _mesa_generate_mipmap_level(GLenum target,
                             GLubyte **dstData,
                             GLint dstRowStride)
 {
+   struct mipmap_bands b;
    int i;
 
+   b.target = target;
+   b.datatype = datatype;
+   b.comps = comps;
+   b.srgb = srgb;
+   b.border = border;
+   b.srcWidth = srcWidth;
+   b.srcHeight = srcHeight;
+   b.srcDepth = srcDepth;
+   b.srcData = srcData;
+   b.srcRowStride = srcRowStride;
+   b.dstWidth = dstWidth;
+   b.dstHeight = dstHeight;
+   b.dstDepth = dstDepth;
+   b.dstData = dstData;
+   b.dstRowStride = dstRowStride;
+
    switch (target) {
    case GL_TEXTURE_1D:
-      make_1d_mipmap(datatype, comps, border,
+      make_1d_mipmap(datatype, comps, srgb, border,
                      srcWidth, srcData[0],
                      dstWidth, dstData[0]);
       break;
@@ -1721,32 +2122,35 @@ _mesa_generate_mipmap_level(GLenum target,
    case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
    case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
    case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
-      make_2d_mipmap(datatype, comps, border,
-                     srcWidth, srcHeight, srcData[0], srcRowStride,
-                     dstWidth, dstHeight, dstData[0], dstRowStride);
+      filter_level_bands(ctx, &b, 1);
+      make_2d_mipmap_border(datatype, comps, srgb, border,
+                            srcWidth, srcHeight, srcData[0], srcRowStride,
+                            dstWidth, dstHeight, dstData[0], dstRowStride);
       break;
    case GL_TEXTURE_3D:
-      make_3d_mipmap(datatype, comps, border,
-                     srcWidth, srcHeight, srcDepth,
-                     srcData, srcRowStride,
-                     dstWidth, dstHeight, dstDepth,
-                     dstData, dstRowStride);
+      filter_level_bands(ctx, &b, dstDepth - 2 * border);
+      make_3d_mipmap_border(datatype, comps, srgb, border,
+                            srcWidth, srcHeight, srcDepth,
+                            srcData, srcRowStride,
+                            dstWidth, dstHeight, dstDepth,
+                            dstData, dstRowStride);
       break;
    case GL_TEXTURE_1D_ARRAY_EXT:
       assert(srcHeight == 1);
       assert(dstHeight == 1);
       for (i = 0; i < dstDepth; i++) {
-	 make_1d_mipmap(datatype, comps, border,
+	 make_1d_mipmap(datatype, comps, srgb, border,
 			srcWidth, srcData[i],
 			dstWidth, dstData[i]);
       }
       break;
    case GL_TEXTURE_2D_ARRAY_EXT:
    case GL_TEXTURE_CUBE_MAP_ARRAY:
+      filter_level_bands(ctx, &b, dstDepth);
       for (i = 0; i < dstDepth; i++) {
-	 make_2d_mipmap(datatype, comps, border,
-			srcWidth, srcHeight, srcData[i], srcRowStride,
-			dstWidth, dstHeight, dstData[i], dstRowStride);
+	 make_2d_mipmap_border(datatype, comps, srgb, border,
+			       srcWidth, srcHeight, srcData[i], srcRowStride,
+			       dstWidth, dstHeight, dstData[i], dstRowStride);
       }
       break;
    case GL_TEXTURE_RECTANGLE_NV:
@@ -1915,6 +2319,34 @@ _mesa_prepare_mipmap_levels(struct gl_context *ctx,
 }
 
 
+/**
+ * Return the mask of the components of the texels of \p format, in memory
+ * order, which are sRGB-encoded and need to be filtered in linear space.
+ * Only 8-bit components are handled, alpha is always linear.
+ */
+static GLbitfield
+srgb_components(mesa_format format, GLenum datatype, GLuint comps)
+{
+   mesa_array_format array_format;
+   GLbitfield mask = (1 << comps) - 1;
+
+   if (datatype != GL_UNSIGNED_BYTE ||
+       _mesa_get_format_color_encoding(format) != GL_SRGB)
+      return 0;
+
+   array_format = _mesa_format_to_array_format(format);
+   if (array_format) {
+      uint8_t swizzle[4];
+
+      _mesa_array_format_get_swizzle(array_format, swizzle);
+      if (swizzle[3] < comps)
+         mask &= ~(1 << swizzle[3]);
+   }
+
+   return mask;
+}
+
+
 static void
 generate_mipmap_uncompressed(struct gl_context *ctx, GLenum target,
 			     struct gl_texture_object *texObj,
@@ -1924,8 +2356,10 @@ generate_mipmap_uncompressed(struct gl_context *ctx, GLenum target,
    GLuint level;
    GLenum datatype;
    GLuint comps;
+   GLbitfield srgb;
 
    _mesa_uncompressed_format_to_type_and_comps(srcImage->TexFormat, &datatype, &comps);
+   srgb = srgb_components(srcImage->TexFormat, datatype, comps);
 
    for (level = texObj->BaseLevel; level < maxLevel; level++) {
       /* generate image[level+1] from image[level] */
@@ -2000,7 +2434,8 @@ generate_mipmap_uncompressed(struct gl_context *ctx, GLenum target,
 
       if (success) {
          /* generate one mipmap level (for 1D/2D/3D/array/etc texture) */
-         _mesa_generate_mipmap_level(target, datatype, comps, border,
+         _mesa_generate_mipmap_level(ctx, target, datatype, comps, srgb,
+                                     border,
                                      srcWidth, srcHeight, srcDepth,
                                      (const GLubyte **) srcMaps, srcRowStride,
                                      dstWidth, dstHeight, dstDepth,
@@ -2048,6 +2483,7 @@ generate_mipmap_compressed(struct gl_context *ctx, GLenum target,
    GLubyte *temp_src = NULL, *temp_dst = NULL;
    GLenum temp_datatype;
    GLenum temp_base_format;
+   GLbitfield srgb = 0;
    GLubyte **temp_src_slices = NULL, **temp_dst_slices = NULL;
 
    /* only two types of compressed textures at this time */
@@ -2079,6 +2515,16 @@ generate_mipmap_compressed(struct gl_context *ctx, GLenum target,
 
    temp_base_format = _mesa_get_format_base_format(temp_format);
 
+   /* The temporary image holds the sRGB-encoded texels, in the component
+    * order of the base format, so alpha, if any, is last.
+    */
+   if (temp_datatype == GL_UNSIGNED_BYTE &&
+       _mesa_get_format_color_encoding(srcImage->TexFormat) == GL_SRGB) {
+      srgb = (1 << components) - 1;
+      if (_mesa_base_format_has_channel(temp_base_format,
+                                        GL_TEXTURE_ALPHA_TYPE))
+         srgb &= ~(1 << (components - 1));
+   }
 
    /* allocate storage for the temporary, uncompressed image */
    temp_src_row_stride = _mesa_format_row_stride(temp_format, srcImage->Width);
@@ -2164,7 +2610,8 @@ generate_mipmap_compressed(struct gl_context *ctx, GLenum target,
       /* Rescale src image to dest image.
        * This will loop over the slices of a 2D array.
        */
-      _mesa_generate_mipmap_level(target, temp_datatype, components, border,
+      _mesa_generate_mipmap_level(ctx, target, temp_datatype, components,
+                                  srgb, border,
                                   srcWidth, srcHeight, srcDepth,
                                   (const GLubyte **) temp_src_slices,
                                   temp_src_row_stride,
@@ -28,10 +28,13 @@
 
 #include "mtypes.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 extern void
-_mesa_generate_mipmap_level(GLenum target,
-                            GLenum datatype, GLuint comps,
+_mesa_generate_mipmap_level(struct gl_context *ctx, GLenum target,
+                            GLenum datatype, GLuint comps, GLbitfield srgb,
                             GLint border,
                             GLint srcWidth, GLint srcHeight, GLint srcDepth,
                             const GLubyte **srcData,
@@ -54,4 +57,8 @@ _mesa_next_mipmap_level_size(GLenum target, GLint border,
                        GLint srcWidth, GLint srcHeight, GLint srcDepth,
                        GLint *dstWidth, GLint *dstHeight, GLint *dstDepth);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* MIPMAP_H */
@@ -82,6 +82,13 @@ struct gl_debug_state;
 struct gl_context;
 struct st_context;
 struct gl_uniform_storage;
+union gl_constant_value;
+struct disk_cache;
+struct blob;
+struct thread_pool;
+struct vbo_minmax_blocks;
+struct gl_shader_fence;
+struct gl_link_job;
 struct prog_instruction;
 struct gl_program_parameter_list;
 struct set;
@@ -1290,6 +1297,8 @@ struct gl_buffer_object
    unsigned MinMaxCacheHitIndices;
    unsigned MinMaxCacheMissIndices;
    bool MinMaxCacheDirty;
+   /** Per-block min/max indices, kept up to date by glBufferSubData */
+   struct vbo_minmax_blocks *MinMaxBlocks;
 };
 
 
@@ -2255,6 +2264,34 @@ struct gl_shader
    GLuint SourceChecksum;       /**< for debug/logging purposes */
    const GLchar *Source;  /**< Source code string */
 
+   /**
+    * \name Shader cache
+    */
+   /*@{*/
+   unsigned char sha1[20]; /**< SHA-1 of the source and compile state */
+
+   /**
+    * Set when compilation was skipped because the shader cache has seen the
+    * same source compile successfully before.  Such a shader has no IR and
+    * is only compiled if its program misses the cache at link time.
+    */
+   bool CompileSkipped;
+
+   /**
+    * Source of a skipped compile that was replaced by glShaderSource.  The
+    * program may still have to compile it if the cache misses at link time.
+    */
+   const GLchar *FallbackSource;
+   /*@}*/
+
+   /**
+    * Tracks the jobs of the compiler threads that use this shader
+    *
+    * Created when the shader is first compiled or linked on the compiler
+    * threads, see main/shader_threads.c.
+    */
+   struct gl_shader_fence *Fence;
+
    struct gl_program *Program;  /**< Post-compile assembly code */
    GLchar *InfoLog;
 
@@ -2662,6 +2699,20 @@ struct gl_shader_program
     */
    GLboolean BinaryRetreivableHint;
 
+   /**
+    * Output of the GLSL linker, serialized before the driver lowered it
+    *
+    * This is the payload of glGetProgramBinary.  It is only kept for programs
+    * linked with PROGRAM_BINARY_RETRIEVABLE_HINT set.
+    */
+   struct blob *Binary;
+
+   /**
+    * Link that was queued on the compiler threads and that has not been
+    * finished by the driver yet, see main/shader_threads.c.
+    */
+   struct gl_link_job *LinkJob;
+
    /**
     * Indicates whether program can be bound for individual pipeline stages
     * using UseProgramStages after it is next linked.
@@ -2802,6 +2853,13 @@ struct gl_shader_program
    unsigned NumHiddenUniforms;
    struct gl_uniform_storage *UniformStorage;
 
+   /**
+    * Backing store of the \c gl_uniform_storage::storage pointers, which
+    * point into this array.
+    */
+   unsigned NumUniformDataSlots;
+   union gl_constant_value *UniformDataSlots;
+
    /**
     * Mapping from GL uniform locations returned by \c glUniformLocation to
     * UniformStorage entries. Arrays will have multiple contiguous slots
@@ -3150,6 +3208,11 @@ struct gl_renderbuffer
     * called without a rb->TexImage.
     */
    GLboolean NeedsFinishRenderTexture;
+   /**
+    * Set by MapRenderbuffer if the mapping it returned is uncached or
+    * write-combined, so that it is read with streaming loads.
+    */
+   GLboolean MapUncached;
    GLubyte NumSamples;
    GLenum InternalFormat; /**< The user-specified format */
    GLenum _BaseFormat;    /**< Either GL_RGB, GL_RGBA, GL_DEPTH_COMPONENT or
@@ -3770,6 +3833,9 @@ struct gl_constants
    bool LowerCsDerivedVariables;    /**< Lower gl_GlobalInvocationID and
                                      *   gl_LocalInvocationIndex based on
                                      *   other builtin variables. */
+
+   /** GL_ARB_get_program_binary */
+   GLuint NumProgramBinaryFormats;
 };
 
 
@@ -4121,6 +4187,8 @@ struct gl_dlist_state
    GLubyte ActiveMaterialSize[MAT_ATTRIB_MAX];
    GLfloat CurrentMaterial[MAT_ATTRIB_MAX][4];
 
+   GLboolean Optimize;          /**< Optimize lists at EndList? */
+
    struct {
       /* State known to have been set by the currently-compiling display
        * list.  Used to eliminate some redundant state changes.
@@ -4481,6 +4549,32 @@ struct gl_context
     */
    struct gl_pipeline_object *_Shader;
 
+   /**
+    * On-disk cache of compiled and linked GLSL programs
+    *
+    * Created on the first shader compile; \c NULL if the cache is disabled.
+    */
+   struct disk_cache *Cache;
+   GLboolean CacheInitialized;
+
+   /**
+    * Threads that glCompileShader and glLinkProgram hand their work to
+    *
+    * Created on the first compile if MESA_GLSL_THREADS is set; \c NULL
+    * otherwise.
+    */
+   struct thread_pool *CompilerThreads;
+   GLboolean CompilerThreadsInitialized;
+
+   /**
+    * Threads that split up CPU-heavy work such as texture format conversion
+    *
+    * Created on first use by _mesa_get_worker_threads(); \c NULL if there
+    * is only one CPU or MESA_WORKER_THREADS is 0.
+    */
+   struct thread_pool *WorkerThreads;
+   GLboolean WorkerThreadsInitialized;
+
    struct gl_query_state Query;  /**< occlusion, timer queries */
 
    struct gl_transform_feedback_state TransformFeedback;
@@ -0,0 +1,237 @@
+/*
+ * Mesa 3-D graphics library
+ *
+ * Copyright (C) 2016 Intel Corporation.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/**
+ * \file program_binary.c
+ *
+ * GL_ARB_get_program_binary / GL_OES_get_program_binary.
+ *
+ * A program binary is a header followed by a string identifying the Mesa
+ * build and the driver, and by the output of serialize_glsl_program() that
+ * was kept in gl_shader_program::Binary when the program was linked.
+ * Loading a binary restores the GLSL linker state and runs the driver's
+ * LinkShader hook on it, so neither the compiler nor the linker run.
+ */
+
+#include "main/context.h"
+#include "main/errors.h"
+#include "main/mtypes.h"
+#include "main/shaderobj.h"
+#include "main/program_binary.h"
+#include "compiler/glsl/blob.h"
+#include "compiler/glsl/serialize.h"
+#include "util/disk_cache.h"
+#include "util/hash_table.h"
+#include "util/ralloc.h"
+#include "git_sha1.h"
+
+#define PROGRAM_BINARY_MAGIC 0x4e42504d /* "MPBN" */
+
+struct program_binary_header {
+   uint32_t magic;
+   uint32_t id_size;        /**< Size of the driver id, including the NUL */
+   uint32_t separate_shader;
+   uint32_t size;           /**< Size of the GLSL linker state */
+   uint32_t checksum;       /**< _mesa_hash_data() of the GLSL linker state */
+};
+
+/**
+ * Return a string identifying the Mesa build and the driver
+ *
+ * The GLSL linker state is only meaningful to the build that wrote it, and
+ * binaries from any other build must be rejected.
+ */
+static char *
+get_driver_id(struct gl_context *ctx)
+{
+   const char *renderer = NULL;
+   uint32_t timestamp = 0;
+
+   if (ctx->Driver.GetString)
+      renderer = (const char *) ctx->Driver.GetString(ctx, GL_RENDERER);
+
+   disk_cache_get_function_timestamp((void *) get_driver_id, &timestamp);
+
+   return ralloc_asprintf(NULL, "Mesa " PACKAGE_VERSION
+#ifdef MESA_GIT_SHA1
+                          " (" MESA_GIT_SHA1 ")"
+#endif
+                          "\n%s\n%u\n%u",
+                          renderer ? renderer : "",
+                          (unsigned) sizeof(void *), timestamp);
+}
+
+GLint
+_mesa_get_program_binary_length(struct gl_context *ctx,
+                                 struct gl_shader_program *sh_prog)
+{
+   if (!sh_prog->LinkStatus || sh_prog->Binary == NULL)
+      return 0;
+
+   char *id = get_driver_id(ctx);
+   GLint length = sizeof(struct program_binary_header) + strlen(id) + 1 +
+                  sh_prog->Binary->size;
+
+   ralloc_free(id);
+   return length;
+}
+
+void
+_mesa_get_program_binary(struct gl_context *ctx,
+                         struct gl_shader_program *sh_prog,
+                         GLsizei buf_size, GLsizei *length,
+                         GLenum *binary_format, GLvoid *binary)
+{
+   struct program_binary_header hdr;
+   const struct blob *payload = sh_prog->Binary;
+   char *id;
+
+   *length = 0;
+
+   if (payload == NULL) {
+      _mesa_error(ctx, GL_INVALID_OPERATION,
+                  "glGetProgramBinary(no binary for program %u)",
+                  sh_prog->Name);
+      return;
+   }
+
+   id = get_driver_id(ctx);
+
+   hdr.magic = PROGRAM_BINARY_MAGIC;
+   hdr.id_size = strlen(id) + 1;
+   hdr.separate_shader = sh_prog->SeparateShader;
+   hdr.size = payload->size;
+   hdr.checksum = _mesa_hash_data(payload->data, payload->size);
+
+   if ((size_t) buf_size < sizeof(hdr) + hdr.id_size + hdr.size) {
+      _mesa_error(ctx, GL_INVALID_OPERATION,
+                  "glGetProgramBinary(bufSize too small)");
+      ralloc_free(id);
+      return;
+   }
+
+   memcpy(binary, &hdr, sizeof(hdr));
+   memcpy((uint8_t *) binary + sizeof(hdr), id, hdr.id_size);
+   memcpy((uint8_t *) binary + sizeof(hdr) + hdr.id_size,
+          payload->data, hdr.size);
+
+   *length = sizeof(hdr) + hdr.id_size + hdr.size;
+   *binary_format = GL_PROGRAM_BINARY_FORMAT_MESA;
+
+   ralloc_free(id);
+}
+
+/**
+ * Check the header and driver id of a program binary
+ *
+ * \return a pointer to the GLSL linker state, or NULL if the binary was not
+ * written by this build and driver.
+ */
+static const uint8_t *
+check_program_binary(struct gl_context *ctx, const GLvoid *binary,
+                     GLsizei length, struct program_binary_header *hdr)
+{
+   const uint8_t *data = binary;
+   const uint8_t *payload = NULL;
+   char *id;
+
+   if ((size_t) length < sizeof(*hdr))
+      return NULL;
+
+   memcpy(hdr, data, sizeof(*hdr));
+   if (hdr->magic != PROGRAM_BINARY_MAGIC)
+      return NULL;
+
+   /* Compare the sizes against what is left of the binary one at a time,
+    * summing them could wrap around on 32-bit.
+    */
+   length -= sizeof(*hdr);
+   if (hdr->id_size > (size_t) length ||
+       hdr->size != (size_t) length - hdr->id_size)
+      return NULL;
+
+   id = get_driver_id(ctx);
+
+   if (hdr->id_size == strlen(id) + 1 &&
+       memcmp(data + sizeof(*hdr), id, hdr->id_size) == 0) {
+      payload = data + sizeof(*hdr) + hdr->id_size;
+
+      if (_mesa_hash_data(payload, hdr->size) != hdr->checksum)
+         payload = NULL;
+   }
+
+   ralloc_free(id);
+   return payload;
+}
+
+void
+_mesa_program_binary(struct gl_context *ctx, struct gl_shader_program *sh_prog,
+                     const GLvoid *binary, GLsizei length)
+{
+   struct program_binary_header hdr;
+   const uint8_t *payload;
+   struct blob *blob;
+   struct blob_reader reader;
+
+   _mesa_clear_shader_program_data(sh_prog);
+   sh_prog->LinkStatus = GL_FALSE;
+
+   payload = check_program_binary(ctx, binary, length, &hdr);
+   if (payload == NULL) {
+      ralloc_strcat(&sh_prog->InfoLog,
+                    "program binary was not created by this driver\n");
+      return;
+   }
+
+   /* Copy the payload so that it is suitably aligned for the reader, and to
+    * return it from glGetProgramBinary later.
+    */
+   blob = blob_create(sh_prog);
+   if (!blob_write_bytes(blob, payload, hdr.size)) {
+      ralloc_free(blob);
+      return;
+   }
+
+   blob_reader_init(&reader, blob->data, blob->size);
+   if (!deserialize_glsl_program(&reader, ctx, sh_prog)) {
+      ralloc_free(blob);
+      ralloc_strcat(&sh_prog->InfoLog, "program binary is invalid\n");
+      return;
+   }
+
+   /* PROGRAM_SEPARABLE is part of the saved program state. */
+   sh_prog->SeparateShader = hdr.separate_shader;
+
+   if (!ctx->Driver.LinkShader(ctx, sh_prog)) {
+      sh_prog->LinkStatus = GL_FALSE;
+      ralloc_free(blob);
+      return;
+   }
+
+   if (sh_prog->BinaryRetreivableHint)
+      sh_prog->Binary = blob;
+   else
+      ralloc_free(blob);
+}
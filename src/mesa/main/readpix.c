@@ -41,6 +41,8 @@
 #include "fbobject.h"
 #include "format_utils.h"
 #include "pixeltransfer.h"
+#include "streaming-load-memcpy.h"
+#include "x86/common_x86_asm.h"
 
 
 /**
@@ -181,6 +183,97 @@ _mesa_readpixels_needs_slow_path(const struct gl_context *ctx, GLenum format,
 }
 
 
+/**
+ * A read of a mapped color renderbuffer into the client's memory.  The
+ * strides are negative for flipped mappings and inverted packing, so the
+ * rows end up in the right order without another pass.
+ */
+struct readpix_bands {
+   GLubyte *map;
+   GLint mapStride;
+   /** Source format, or 0 to copy the rows as they are */
+   uint32_t srcFormat;
+   GLubyte *dst;
+   GLint dstStride;
+   uint32_t dstFormat;
+   uint8_t *rebaseSwizzle;
+   GLsizei width, height;
+   /** Bytes per row of the mapping */
+   GLint rowBytes;
+   /**
+    * The mapping is uncached, so the rows are fetched with streaming loads,
+    * into a temporary buffer if they need to be converted.
+    */
+   bool uncached;
+};
+
+static void
+read_rows(const struct readpix_bands *b, GLubyte *map, GLubyte *dst,
+          GLint rows)
+{
+   if (b->srcFormat)
+      _mesa_format_convert(dst, b->dstFormat, b->dstStride,
+                           map, b->srcFormat, b->mapStride,
+                           b->width, rows, b->rebaseSwizzle);
+   else
+      for (; rows > 0; rows--, map += b->mapStride, dst += b->dstStride)
+         memcpy(dst, map, b->rowBytes);
+}
+
+static void
+read_band(void *data, unsigned img, unsigned y, unsigned rows)
+{
+   const struct readpix_bands *b = data;
+   GLubyte *map = b->map + (ptrdiff_t) y * b->mapStride;
+   GLubyte *dst = b->dst + (ptrdiff_t) y * b->dstStride;
+
+#if defined(USE_SSE41)
+   if (b->uncached && cpu_has_sse4_1) {
+      GLubyte *row = b->srcFormat ? malloc(b->rowBytes) : NULL;
+      unsigned j;
+
+      if (b->srcFormat && !row) {
+         read_rows(b, map, dst, rows);
+         return;
+      }
+
+      for (j = 0; j < rows; j++) {
+         if (row) {
+            _mesa_streaming_load_memcpy(row, map, b->rowBytes);
+            _mesa_format_convert(dst, b->dstFormat, b->dstStride,
+                                 row, b->srcFormat, b->rowBytes,
+                                 b->width, 1, b->rebaseSwizzle);
+         }
+         else {
+            _mesa_streaming_load_memcpy(dst, map, b->rowBytes);
+         }
+         map += b->mapStride;
+         dst += b->dstStride;
+      }
+
+      free(row);
+      return;
+   }
+#endif
+
+   read_rows(b, map, dst, rows);
+}
+
+/**
+ * Copy or convert the rows of a mapped color renderbuffer, in bands of rows
+ * on the worker threads of the context if the image is large.
+ */
+static void
+read_bands(struct gl_context *ctx, struct gl_renderbuffer *rb,
+           struct readpix_bands *b)
+{
+   b->rowBytes = b->width * _mesa_get_format_bytes(rb->Format);
+   b->uncached = rb->MapUncached;
+
+   _mesa_parallel_image_rows(ctx, b->width, b->height, 1, read_band, b);
+}
+
+
 static GLboolean
 readpixels_can_use_memcpy(const struct gl_context *ctx, GLenum format, GLenum type,
                           const struct gl_pixelstore_attrib *packing)
@@ -219,33 +312,28 @@ readpixels_memcpy(struct gl_context *ctx,
 {
    struct gl_renderbuffer *rb =
          _mesa_get_read_renderbuffer_for_format(ctx, format);
-   GLubyte *dst, *map;
-   int dstStride, stride, j, texelBytes;
+   struct readpix_bands b;
 
    /* Fail if memcpy cannot be used. */
    if (!readpixels_can_use_memcpy(ctx, format, type, packing)) {
       return GL_FALSE;
    }
 
-   dstStride = _mesa_image_row_stride(packing, width, format, type);
-   dst = (GLubyte *) _mesa_image_address2d(packing, pixels, width, height,
-					   format, type, 0, 0);
+   memset(&b, 0, sizeof(b));
+   b.dstStride = _mesa_image_row_stride(packing, width, format, type);
+   b.dst = (GLubyte *) _mesa_image_address2d(packing, pixels, width, height,
+                                             format, type, 0, 0);
+   b.width = width;
+   b.height = height;
 
    ctx->Driver.MapRenderbuffer(ctx, rb, x, y, width, height, GL_MAP_READ_BIT,
-			       &map, &stride);
-   if (!map) {
+			       &b.map, &b.mapStride);
+   if (!b.map) {
       _mesa_error(ctx, GL_OUT_OF_MEMORY, "glReadPixels");
       return GL_TRUE;  /* don't bother trying the slow path */
    }
 
-   texelBytes = _mesa_get_format_bytes(rb->Format);
-
-   /* memcpy*/
-   for (j = 0; j < height; j++) {
-      memcpy(dst, map, width * texelBytes);
-      dst += dstStride;
-      map += stride;
-   }
+   read_bands(ctx, rb, &b);
 
    ctx->Driver.UnmapRenderbuffer(ctx, rb);
    return GL_TRUE;
@@ -571,7 +659,20 @@ read_rgba_pixels( struct gl_context *ctx,
     * If the dst format is Luminance, we need to do the conversion by computing
     * L=R+G+B values.
     */
-   if (!convert_rgb_to_lum) {
+   if (!convert_rgb_to_lum && src == map) {
+      struct readpix_bands b;
+
+      b.map = map;
+      b.mapStride = rb_stride;
+      b.srcFormat = src_format;
+      b.dst = dst;
+      b.dstStride = dst_stride;
+      b.dstFormat = dst_format;
+      b.rebaseSwizzle = needs_rebase ? rebase_swizzle : NULL;
+      b.width = width;
+      b.height = height;
+      read_bands(ctx, rb, &b);
+   } else if (!convert_rgb_to_lum) {
       _mesa_format_convert(dst, dst_format, dst_stride,
                            src, src_format, src_stride,
                            width, height,
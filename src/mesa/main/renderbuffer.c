@@ -55,6 +55,7 @@ _mesa_init_renderbuffer(struct gl_renderbuffer *rb, GLuint name)
    rb->Width = 0;
    rb->Height = 0;
    rb->Depth = 0;
+   rb->MapUncached = GL_FALSE;
 
    /* In GL 3, the initial format is GL_RGBA according to Table 6.26
     * on page 302 of the GL 3.3 spec.
@@ -0,0 +1,385 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * \file shader_threads.c
+ *
+ * Compiling and linking GLSL on worker threads.
+ *
+ * If MESA_GLSL_THREADS is set, glCompileShader and glLinkProgram queue their
+ * work on a pool of threads and return immediately.  The GLSL compiler and
+ * linker run on the pool; the driver's LinkShader hook runs on the API
+ * thread the first time the program is looked up after the link, e.g. to
+ * query its link status or to bind it.
+ *
+ * Shader objects are synchronized with a gl_shader_fence.  Querying or
+ * modifying a shader waits for its compile and for the links of the
+ * programs it is attached to.  A link job waits for the compiles of its
+ * shaders, which were always queued before it, and then holds the shaders
+ * for itself: cross-validating the shaders and finishing compiles that
+ * were skipped because of the shader cache write to their IR, and the same
+ * shader may be attached to several programs.
+ *
+ * With GL_DEBUG_OUTPUT_SYNCHRONOUS enabled, messages have to reach the
+ * application on the thread of the GL call, so everything runs there.
+ *
+ * Programs that are bound somewhere are still linked synchronously, because
+ * rendering and glUniform* use them without looking them up.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "main/glheader.h"
+#include "main/context.h"
+#include "main/debug_output.h"
+#include "main/macros.h"
+#include "main/mtypes.h"
+#include "main/shaderapi.h"
+#include "main/shaderobj.h"
+#include "main/shader_threads.h"
+#include "compiler/glsl/program.h"
+#include "compiler/glsl/shader_cache.h"
+#include "program/ir_to_mesa.h"
+#include "util/thread_pool.h"
+
+/** Upper limit for MESA_GLSL_THREADS */
+#define MAX_COMPILER_THREADS 64
+
+struct compile_job {
+   struct gl_context *ctx;
+   struct gl_shader *shader;
+};
+
+struct gl_link_job {
+   struct gl_context *ctx;
+   struct gl_shader_program *prog;
+   struct glsl_link_state state;
+
+   /** prog->Shaders, sorted by the address of their fences */
+   struct gl_shader **shaders;
+
+   mtx_t mutex;
+   cnd_t cond;
+   bool done;
+};
+
+static struct thread_pool *
+get_compiler_threads(struct gl_context *ctx)
+{
+   if (!ctx->CompilerThreadsInitialized) {
+      const char *env = getenv("MESA_GLSL_THREADS");
+      unsigned num_threads = env ? strtoul(env, NULL, 10) : 0;
+
+      ctx->CompilerThreadsInitialized = GL_TRUE;
+
+      /* The MESA_GLSL debug output is meant to come in API order. */
+      if (num_threads == 0 || ctx->_Shader->Flags != 0)
+         return NULL;
+
+      /* The jobs must not race to open the shader cache. */
+      shader_cache_init(ctx);
+
+      ctx->CompilerThreads =
+         thread_pool_create(MIN2(num_threads, MAX_COMPILER_THREADS));
+   }
+
+   if (_mesa_get_debug_state_int(ctx, GL_DEBUG_OUTPUT_SYNCHRONOUS_ARB))
+      return NULL;
+
+   return ctx->CompilerThreads;
+}
+
+static struct gl_shader_fence *
+get_shader_fence(struct gl_shader *sh)
+{
+   if (sh->Fence == NULL) {
+      struct gl_shader_fence *fence = calloc(1, sizeof(*fence));
+
+      if (fence == NULL)
+         return NULL;
+
+      mtx_init(&fence->Mutex, mtx_plain);
+      cnd_init(&fence->Cond);
+      sh->Fence = fence;
+   }
+
+   return sh->Fence;
+}
+
+void
+_mesa_wait_shader_fence(struct gl_shader_fence *fence)
+{
+   mtx_lock(&fence->Mutex);
+   while (fence->Jobs > 0 || fence->Readers > 0)
+      cnd_wait(&fence->Cond, &fence->Mutex);
+   mtx_unlock(&fence->Mutex);
+}
+
+static void
+compile_shader_job(void *data)
+{
+   struct compile_job *job = data;
+   struct gl_shader *sh = job->shader;
+   struct gl_shader_fence *fence = sh->Fence;
+
+   _mesa_compile_shader(job->ctx, sh);
+
+   mtx_lock(&fence->Mutex);
+   fence->Jobs--;
+   cnd_broadcast(&fence->Cond);
+   mtx_unlock(&fence->Mutex);
+
+   free(job);
+}
+
+/**
+ * Queue the compile of \p sh on the compiler threads.
+ *
+ * \return \c false if compiling on threads is disabled, in which case the
+ * caller compiles the shader itself.
+ */
+bool
+_mesa_queue_compile_shader(struct gl_context *ctx, struct gl_shader *sh)
+{
+   struct thread_pool *pool = get_compiler_threads(ctx);
+   struct gl_shader_fence *fence;
+   struct compile_job *job;
+
+   if (pool == NULL || sh->Source == NULL)
+      return false;
+
+   fence = get_shader_fence(sh);
+   job = malloc(sizeof(*job));
+   if (fence == NULL || job == NULL) {
+      free(job);
+      return false;
+   }
+
+   job->ctx = ctx;
+   job->shader = sh;
+
+   _mesa_wait_shader_fence(fence);
+
+   mtx_lock(&fence->Mutex);
+   fence->Jobs++;
+   mtx_unlock(&fence->Mutex);
+
+   if (!thread_pool_add_job(pool, compile_shader_job, job))
+      compile_shader_job(job);
+
+   return true;
+}
+
+static int
+compare_shader_fences(const void *a, const void *b)
+{
+   const struct gl_shader *sh_a = *(struct gl_shader * const *) a;
+   const struct gl_shader *sh_b = *(struct gl_shader * const *) b;
+   uintptr_t fence_a = (uintptr_t) sh_a->Fence;
+   uintptr_t fence_b = (uintptr_t) sh_b->Fence;
+
+   return fence_a < fence_b ? -1 : fence_a > fence_b;
+}
+
+static void
+link_program_job(void *data)
+{
+   struct gl_link_job *job = data;
+   struct gl_shader_program *prog = job->prog;
+   unsigned i;
+
+   /* The shaders are taken in a fixed order, so that two links sharing
+    * some of them can't each hold one the other is waiting for.  Only
+    * running jobs hold shaders, and compiles are queued before the links
+    * that wait for them, so the waits always end.
+    */
+   for (i = 0; i < prog->NumShaders; i++) {
+      struct gl_shader_fence *fence = job->shaders[i]->Fence;
+
+      mtx_lock(&fence->Mutex);
+      while (fence->Jobs > 0 || fence->Linking)
+         cnd_wait(&fence->Cond, &fence->Mutex);
+      fence->Linking = true;
+      mtx_unlock(&fence->Mutex);
+   }
+
+   _mesa_glsl_link_shader_ir(job->ctx, prog, &job->state);
+
+   for (i = 0; i < prog->NumShaders; i++) {
+      struct gl_shader_fence *fence = job->shaders[i]->Fence;
+
+      mtx_lock(&fence->Mutex);
+      fence->Linking = false;
+      fence->Readers--;
+      cnd_broadcast(&fence->Cond);
+      mtx_unlock(&fence->Mutex);
+   }
+
+   mtx_lock(&job->mutex);
+   job->done = true;
+   cnd_broadcast(&job->cond);
+   mtx_unlock(&job->mutex);
+}
+
+/**
+ * Queue the GLSL link of \p shProg on the compiler threads.
+ *
+ * The program data is cleared right away, and the link is finished by
+ * _mesa_wait_shader_program().
+ *
+ * \return \c false if the program has to be linked synchronously.
+ */
+bool
+_mesa_queue_link_program(struct gl_context *ctx,
+                         struct gl_shader_program *shProg)
+{
+   struct thread_pool *pool = get_compiler_threads(ctx);
+   struct gl_link_job *job;
+   unsigned i;
+
+   /* Only the hash table holds a reference to a program that is neither
+    * bound nor part of a pipeline object.
+    */
+   if (pool == NULL || shProg->RefCount > 1)
+      return false;
+
+   for (i = 0; i < shProg->NumShaders; i++) {
+      if (get_shader_fence(shProg->Shaders[i]) == NULL)
+         return false;
+   }
+
+   job = calloc(1, sizeof(*job));
+   if (job == NULL)
+      return false;
+
+   job->shaders = malloc(MAX2(shProg->NumShaders, 1) *
+                         sizeof(job->shaders[0]));
+   if (job->shaders == NULL) {
+      free(job);
+      return false;
+   }
+
+   memcpy(job->shaders, shProg->Shaders,
+          shProg->NumShaders * sizeof(job->shaders[0]));
+   qsort(job->shaders, shProg->NumShaders, sizeof(job->shaders[0]),
+         compare_shader_fences);
+
+   job->ctx = ctx;
+   job->prog = shProg;
+   mtx_init(&job->mutex, mtx_plain);
+   cnd_init(&job->cond);
+
+   _mesa_clear_shader_program_data(shProg);
+   shProg->LinkJob = job;
+
+   for (i = 0; i < shProg->NumShaders; i++) {
+      struct gl_shader_fence *fence = shProg->Shaders[i]->Fence;
+
+      mtx_lock(&fence->Mutex);
+      fence->Readers++;
+      mtx_unlock(&fence->Mutex);
+   }
+
+   if (!thread_pool_add_job(pool, link_program_job, job))
+      link_program_job(job);
+
+   return true;
+}
+
+static void
+wait_link_job(struct gl_link_job *job)
+{
+   mtx_lock(&job->mutex);
+   while (!job->done)
+      cnd_wait(&job->cond, &job->mutex);
+   mtx_unlock(&job->mutex);
+}
+
+static void
+free_link_job(struct gl_link_job *job)
+{
+   cnd_destroy(&job->cond);
+   mtx_destroy(&job->mutex);
+   free(job->shaders);
+   free(job);
+}
+
+void
+_mesa_finish_link_job(struct gl_context *ctx,
+                      struct gl_shader_program *shProg)
+{
+   struct gl_link_job *job = shProg->LinkJob;
+
+   wait_link_job(job);
+   shProg->LinkJob = NULL;
+
+   _mesa_glsl_link_shader_driver(ctx, shProg, &job->state);
+   free_link_job(job);
+
+   _mesa_link_program_done(ctx, shProg);
+}
+
+/**
+ * Free the fence of a shader that is being deleted.
+ */
+void
+_mesa_free_shader_fence(struct gl_shader *sh)
+{
+   struct gl_shader_fence *fence = sh->Fence;
+
+   if (fence == NULL)
+      return;
+
+   _mesa_wait_shader_fence(fence);
+
+   cnd_destroy(&fence->Cond);
+   mtx_destroy(&fence->Mutex);
+   free(fence);
+   sh->Fence = NULL;
+}
+
+/**
+ * Drop the link job of a program that is being deleted without a context,
+ * after the compiler threads were destroyed.
+ */
+void
+_mesa_free_link_job(struct gl_shader_program *shProg)
+{
+   if (shProg->LinkJob == NULL)
+      return;
+
+   wait_link_job(shProg->LinkJob);
+   free_link_job(shProg->LinkJob);
+   shProg->LinkJob = NULL;
+}
+
+/**
+ * Wait for the queued jobs of \p ctx and destroy its compiler threads.
+ */
+void
+_mesa_free_compiler_threads(struct gl_context *ctx)
+{
+   thread_pool_destroy(ctx->CompilerThreads);
+   ctx->CompilerThreads = NULL;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SHADER_THREADS_H
+#define SHADER_THREADS_H
+
+#include "main/glheader.h"
+#include "main/mtypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Jobs of the compiler threads that use a shader
+ */
+struct gl_shader_fence
+{
+   mtx_t Mutex;
+   cnd_t Cond;
+   GLuint Jobs;     /**< Queued compiles of the shader */
+   GLuint Readers;  /**< Queued links of programs the shader is attached to */
+   bool Linking;    /**< A link job is using the shader's IR */
+};
+
+extern bool
+_mesa_queue_compile_shader(struct gl_context *ctx, struct gl_shader *sh);
+
+extern bool
+_mesa_queue_link_program(struct gl_context *ctx,
+                         struct gl_shader_program *shProg);
+
+extern void
+_mesa_wait_shader_fence(struct gl_shader_fence *fence);
+
+extern void
+_mesa_finish_link_job(struct gl_context *ctx,
+                      struct gl_shader_program *shProg);
+
+extern void
+_mesa_free_shader_fence(struct gl_shader *sh);
+
+extern void
+_mesa_free_link_job(struct gl_shader_program *shProg);
+
+extern void
+_mesa_free_compiler_threads(struct gl_context *ctx);
+
+/**
+ * Wait until no job of the compiler threads uses \p sh, so that it can be
+ * queried or modified.
+ */
+static inline void
+_mesa_wait_shader_idle(struct gl_shader *sh)
+{
+   if (sh->Fence)
+      _mesa_wait_shader_fence(sh->Fence);
+}
+
+/**
+ * Wait until a link of \p shProg that was queued on the compiler threads is
+ * done, and let the driver finish it.
+ */
+static inline void
+_mesa_wait_shader_program(struct gl_context *ctx,
+                          struct gl_shader_program *shProg)
+{
+   if (shProg->LinkJob)
+      _mesa_finish_link_job(ctx, shProg);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHADER_THREADS_H */
@@ -45,8 +45,10 @@
 #include "main/hash.h"
 #include "main/mtypes.h"
 #include "main/pipelineobj.h"
+#include "main/program_binary.h"
 #include "main/shaderapi.h"
 #include "main/shaderobj.h"
+#include "main/shader_threads.h"
 #include "main/transformfeedback.h"
 #include "main/uniforms.h"
 #include "compiler/glsl/glsl_parser_extras.h"
@@ -406,6 +408,8 @@ delete_shader(struct gl_context *ctx, GLuint shader)
    if (!sh)
       return;
 
+   _mesa_wait_shader_idle(sh);
+
    if (!sh->DeletePending) {
       sh->DeletePending = GL_TRUE;
 
@@ -790,7 +794,7 @@ get_programiv(struct gl_context *ctx, GLuint program, GLenum pname,
       *params = shProg->BinaryRetreivableHint;
       return;
    case GL_PROGRAM_BINARY_LENGTH:
-      *params = 0;
+      *params = _mesa_get_program_binary_length(ctx, shProg);
       return;
    case GL_ACTIVE_ATOMIC_COUNTER_BUFFERS:
       if (!ctx->Extensions.ARB_shader_atomic_counters)
@@ -874,6 +878,8 @@ get_shaderiv(struct gl_context *ctx, GLuint name, GLenum pname, GLint *params)
       return;
    }
 
+   _mesa_wait_shader_idle(shader);
+
    switch (pname) {
    case GL_SHADER_TYPE:
       *params = shader->Type;
@@ -946,6 +952,8 @@ get_shader_info_log(struct gl_context *ctx, GLuint shader, GLsizei bufSize,
       return;
    }
 
+   _mesa_wait_shader_idle(sh);
+
    _mesa_copy_string(infoLog, bufSize, length, sh->InfoLog);
 }
 
@@ -981,8 +989,17 @@ shader_source(struct gl_shader *sh, const GLchar *source)
 {
    assert(sh);
 
+   _mesa_wait_shader_idle(sh);
+
    /* free old shader source string and install new one */
-   free((void *)sh->Source);
+   if (sh->CompileSkipped && sh->FallbackSource == NULL) {
+      /* The skipped compile may still be needed if the program misses the
+       * shader cache at link time.
+       */
+      sh->FallbackSource = sh->Source;
+   } else {
+      free((void *)sh->Source);
+   }
    sh->Source = source;
 #ifdef DEBUG
    sh->SourceChecksum = _mesa_str_checksum(sh->Source);
@@ -1011,10 +1028,14 @@ _mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh)
          _mesa_log("%s\n", sh->Source);
       }
 
+      /* The source of a previously skipped compile is no longer needed. */
+      free((void *)sh->FallbackSource);
+      sh->FallbackSource = NULL;
+
       /* this call will set the shader->CompileStatus field to indicate if
        * compilation was successful.
        */
-      _mesa_glsl_compile_shader(ctx, sh, false, false);
+      _mesa_glsl_compile_shader(ctx, sh, false, false, false);
 
       if (ctx->_Shader->Flags & GLSL_LOG) {
          _mesa_write_shader_to_file(sh);
@@ -1053,9 +1074,12 @@ _mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh)
 
 /**
  * Link a program's shaders.
+ *
+ * \param threaded  whether the link may be queued on the compiler threads
  */
-void
-_mesa_link_program(struct gl_context *ctx, struct gl_shader_program *shProg)
+static void
+link_program(struct gl_context *ctx, struct gl_shader_program *shProg,
+             bool threaded)
 {
    if (!shProg)
       return;
@@ -1073,8 +1097,34 @@ _mesa_link_program(struct gl_context *ctx, struct gl_shader_program *shProg)
 
    FLUSH_VERTICES(ctx, _NEW_PROGRAM);
 
+   if (threaded && _mesa_queue_link_program(ctx, shProg))
+      return;
+
+   /* Linking writes to the IR of the attached shaders, which may be shared
+    * with programs that are being linked on the compiler threads.
+    */
+   for (unsigned i = 0; i < shProg->NumShaders; i++)
+      _mesa_wait_shader_idle(shProg->Shaders[i]);
+
    _mesa_glsl_link_shader(ctx, shProg);
+   _mesa_link_program_done(ctx, shProg);
+}
+
+
+void
+_mesa_link_program(struct gl_context *ctx, struct gl_shader_program *shProg)
+{
+   link_program(ctx, shProg, false);
+}
 
+
+/**
+ * Capture and report the result of linking a program.
+ */
+void
+_mesa_link_program_done(struct gl_context *ctx,
+                        struct gl_shader_program *shProg)
+{
    /* Capture .shader_test files. */
    const char *capture_path = _mesa_get_shader_capture_path();
    if (shProg->Name != 0 && capture_path != NULL) {
@@ -1327,10 +1377,19 @@ void GLAPIENTRY
 _mesa_CompileShader(GLuint shaderObj)
 {
    GET_CURRENT_CONTEXT(ctx);
+   struct gl_shader *sh;
+
    if (MESA_VERBOSE & VERBOSE_API)
       _mesa_debug(ctx, "glCompileShader %u\n", shaderObj);
-   _mesa_compile_shader(ctx, _mesa_lookup_shader_err(ctx, shaderObj,
-                                                     "glCompileShader"));
+
+   sh = _mesa_lookup_shader_err(ctx, shaderObj, "glCompileShader");
+   if (!sh)
+      return;
+
+   _mesa_wait_shader_idle(sh);
+
+   if (!_mesa_queue_compile_shader(ctx, sh))
+      _mesa_compile_shader(ctx, sh);
 }
 
 
@@ -1577,8 +1636,9 @@ _mesa_LinkProgram(GLuint programObj)
    GET_CURRENT_CONTEXT(ctx);
    if (MESA_VERBOSE & VERBOSE_API)
       _mesa_debug(ctx, "glLinkProgram %u\n", programObj);
-   _mesa_link_program(ctx, _mesa_lookup_shader_program_err(ctx, programObj,
-                                                           "glLinkProgram"));
+   link_program(ctx, _mesa_lookup_shader_program_err(ctx, programObj,
+                                                     "glLinkProgram"),
+                true);
 }
 
 #if defined(HAVE_SHA1)
@@ -1994,12 +2054,15 @@ _mesa_GetProgramBinary(GLuint program, GLsizei bufSize, GLsizei *length,
       return;
    }
 
-   *length = 0;
-   _mesa_error(ctx, GL_INVALID_OPERATION,
-               "glGetProgramBinary(driver supports zero binary formats)");
+   if (ctx->Const.NumProgramBinaryFormats == 0) {
+      *length = 0;
+      _mesa_error(ctx, GL_INVALID_OPERATION,
+                  "glGetProgramBinary(driver supports zero binary formats)");
+      return;
+   }
 
-   (void) binaryFormat;
-   (void) binary;
+   _mesa_get_program_binary(ctx, shProg, bufSize, length, binaryFormat,
+                            binary);
 }
 
 void GLAPIENTRY
@@ -2013,9 +2076,6 @@ _mesa_ProgramBinary(GLuint program, GLenum binaryFormat,
    if (!shProg)
       return;
 
-   (void) binaryFormat;
-   (void) binary;
-
    /* Section 2.3.1 (Errors) of the OpenGL 4.5 spec says:
     *
     *     "If a negative number is provided where an argument of type sizei or
@@ -2035,11 +2095,29 @@ _mesa_ProgramBinary(GLuint program, GLenum binaryFormat,
     *     setting the LINK_STATUS of <program> to FALSE, if these conditions
     *     are not met."
     *
-    * Since any value of binaryFormat passed "is not one of those specified as
-    * allowable for [this] command, an INVALID_ENUM error is generated."
+    * If binaryFormat is not one of the formats we return, it "is not one of
+    * those specified as allowable for [this] command, an INVALID_ENUM error
+    * is generated."
     */
-   shProg->LinkStatus = GL_FALSE;
-   _mesa_error(ctx, GL_INVALID_ENUM, "glProgramBinary");
+   if (ctx->Const.NumProgramBinaryFormats == 0 ||
+       binaryFormat != GL_PROGRAM_BINARY_FORMAT_MESA) {
+      shProg->LinkStatus = GL_FALSE;
+      _mesa_error(ctx, GL_INVALID_ENUM, "glProgramBinary");
+      return;
+   }
+
+   /* Loading a binary replaces the linked program, so the same restriction
+    * as for glLinkProgram applies.
+    */
+   if (_mesa_transform_feedback_is_using_program(ctx, shProg)) {
+      _mesa_error(ctx, GL_INVALID_OPERATION,
+                  "glProgramBinary(transform feedback is using the program)");
+      return;
+   }
+
+   FLUSH_VERTICES(ctx, _NEW_PROGRAM);
+
+   _mesa_program_binary(ctx, shProg, binary, length);
 }
 
 
@@ -36,6 +36,7 @@
 #include "main/mtypes.h"
 #include "main/shaderapi.h"
 #include "main/shaderobj.h"
+#include "main/shader_threads.h"
 #include "main/uniforms.h"
 #include "program/program.h"
 #include "program/prog_parameter.h"
@@ -118,7 +119,9 @@ _mesa_new_shader(struct gl_context *ctx, GLuint name, gl_shader_stage stage)
 void
 _mesa_delete_shader(struct gl_context *ctx, struct gl_shader *sh)
 {
+   _mesa_free_shader_fence(sh);
    free((void *)sh->Source);
+   free((void *)sh->FallbackSource);
    free(sh->Label);
    _mesa_reference_program(ctx, &sh->Program, NULL);
    ralloc_free(sh);
@@ -273,6 +276,8 @@ _mesa_clear_shader_program_data(struct gl_shader_program *shProg)
       ralloc_free(shProg->UniformStorage);
       shProg->NumUniformStorage = 0;
       shProg->UniformStorage = NULL;
+      shProg->NumUniformDataSlots = 0;
+      shProg->UniformDataSlots = NULL;
    }
 
    if (shProg->UniformRemapTable) {
@@ -302,6 +307,9 @@ _mesa_clear_shader_program_data(struct gl_shader_program *shProg)
    shProg->AtomicBuffers = NULL;
    shProg->NumAtomicBuffers = 0;
 
+   ralloc_free(shProg->Binary);
+   shProg->Binary = NULL;
+
    if (shProg->ProgramResourceList) {
       ralloc_free(shProg->ProgramResourceList);
       shProg->ProgramResourceList = NULL;
@@ -377,6 +385,7 @@ void
 _mesa_delete_shader_program(struct gl_context *ctx,
                             struct gl_shader_program *shProg)
 {
+   _mesa_free_link_job(shProg);
    _mesa_free_shader_program_data(ctx, shProg);
 
    ralloc_free(shProg);
@@ -400,6 +409,8 @@ _mesa_lookup_shader_program(struct gl_context *ctx, GLuint name)
       if (shProg && shProg->Type != GL_SHADER_PROGRAM_MESA) {
          return NULL;
       }
+      if (shProg)
+         _mesa_wait_shader_program(ctx, shProg);
       return shProg;
    }
    return NULL;
@@ -428,6 +439,7 @@ _mesa_lookup_shader_program_err(struct gl_context *ctx, GLuint name,
          _mesa_error(ctx, GL_INVALID_OPERATION, "%s", caller);
          return NULL;
       }
+      _mesa_wait_shader_program(ctx, shProg);
       return shProg;
    }
 }
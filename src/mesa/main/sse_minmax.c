@@ -29,66 +29,25 @@
 #include <smmintrin.h>
 #include <stdint.h>
 
-void
-_mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
-                         unsigned *max_index, const unsigned count)
-{
-   unsigned max_ui = 0;
-   unsigned min_ui = ~0U;
-   unsigned i = 0;
-   unsigned aligned_count = count;
-
-   /* handle the first few values without SSE until the pointer is aligned */
-   while (((uintptr_t)ui_indices & 15) && aligned_count) {
-      if (*ui_indices > max_ui)
-         max_ui = *ui_indices;
-      if (*ui_indices < min_ui)
-         min_ui = *ui_indices;
-
-      aligned_count--;
-      ui_indices++;
-   }
-
-   /* TODO: The actual threshold for SSE begin useful may be higher than 8.
-    * Some careful microbenchmarks and measurement are required to
-    * find the actual tipping point.
-    */
-   if (aligned_count >= 8) {
-      unsigned max_arr[4] __attribute__ ((aligned (16)));
-      unsigned min_arr[4] __attribute__ ((aligned (16)));
-      unsigned vec_count;
-      __m128i max_ui4 = _mm_setzero_si128();
-      __m128i min_ui4 = _mm_set1_epi32(~0U);
-      __m128i ui_indices4;
-      __m128i *ui_indices_ptr;
-
-      vec_count = aligned_count & ~0x3;
-      ui_indices_ptr = (__m128i *)ui_indices;
-      for (i = 0; i < vec_count / 4; i++) {
-         ui_indices4 = _mm_load_si128(&ui_indices_ptr[i]);
-         max_ui4 = _mm_max_epu32(ui_indices4, max_ui4);
-         min_ui4 = _mm_min_epu32(ui_indices4, min_ui4);
-      }
-
-      _mm_store_si128((__m128i *)max_arr, max_ui4);
-      _mm_store_si128((__m128i *)min_arr, min_ui4);
-
-      for (i = 0; i < 4; i++) {
-         if (max_arr[i] > max_ui)
-            max_ui = max_arr[i];
-         if (min_arr[i] < min_ui)
-            min_ui = min_arr[i];
-      }
-      i = vec_count;
-   }
-
-   for (; i < aligned_count; i++) {
-      if (ui_indices[i] > max_ui)
-         max_ui = ui_indices[i];
-      if (ui_indices[i] < min_ui)
-         min_ui = ui_indices[i];
-   }
-
-   *min_index = min_ui;
-   *max_index = max_ui;
-}
+#define VEC __m128i
+#define VEC_LOAD(p) _mm_loadu_si128((const __m128i *)(p))
+#define VEC_STORE(p, v) _mm_storeu_si128((__m128i *)(p), v)
+#define VEC_ZERO _mm_setzero_si128()
+#define VEC_ONES _mm_set1_epi32(~0)
+#define VEC_OR _mm_or_si128
+#define VEC_ANDNOT _mm_andnot_si128
+#define VEC_SET1_8 _mm_set1_epi8
+#define VEC_SET1_16 _mm_set1_epi16
+#define VEC_SET1_32 _mm_set1_epi32
+#define VEC_CMPEQ_8 _mm_cmpeq_epi8
+#define VEC_CMPEQ_16 _mm_cmpeq_epi16
+#define VEC_CMPEQ_32 _mm_cmpeq_epi32
+#define VEC_MIN_8 _mm_min_epu8
+#define VEC_MIN_16 _mm_min_epu16
+#define VEC_MIN_32 _mm_min_epu32
+#define VEC_MAX_8 _mm_max_epu8
+#define VEC_MAX_16 _mm_max_epu16
+#define VEC_MAX_32 _mm_max_epu32
+#define FUNC_NAME _mesa_sse41_index_min_max
+
+#include "main/minmax_tmp.h"
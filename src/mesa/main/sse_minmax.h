@@ -25,6 +25,15 @@
  *
  */
 
+#include <stdbool.h>
+
+/**
+ * Compute the smallest and largest of \p count indices of \p index_size
+ * bytes (1, 2 or 4), skipping \p restart_index if \p restart is set.
+ * If there are no indices besides restart indices, the minimum is ~0 and
+ * the maximum 0.
+ */
 void
-_mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
-                         unsigned *max_index, const unsigned count);
+_mesa_sse41_index_min_max(const void *indices, unsigned index_size,
+                          unsigned count, bool restart, unsigned restart_index,
+                          unsigned *min_index, unsigned *max_index);
@@ -0,0 +1,162 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "main/sse_swizzle.h"
+#include "main/formats.h"
+#include <smmintrin.h>
+
+/**
+ * Swizzle pixels of 8-bit channels with PSHUFB.
+ *
+ * Each iteration shuffles as many whole pixels as fit into 16 bytes of both
+ * the source and the destination, e.g. 4 RGBA pixels, or 16 luminance pixels
+ * into 4 RGBA pixels.  The loads and stores are 16 bytes wide, and the
+ * bytes past the last whole pixel are rewritten by the next iteration, so
+ * the loop stops while 16 bytes are left on either side.
+ *
+ * Channels that are MESA_FORMAT_SWIZZLE_ZERO, MESA_FORMAT_SWIZZLE_NONE or
+ * not in the source are set to 0, and MESA_FORMAT_SWIZZLE_ONE is set to
+ * \p one.
+ *
+ * \return the number of pixels that were converted.  The caller converts
+ * the rest, and everything if the source and destination overlap.
+ */
+int
+_mesa_sse41_swizzle_bytes(uint8_t *dst, int num_dst_channels,
+                          const uint8_t *src, int num_src_channels,
+                          const uint8_t swizzle[4], uint8_t one, int count)
+{
+   const int n = num_src_channels, m = num_dst_channels;
+   const int step = 16 / (n > m ? n : m);
+   const int tail = (16 + (n < m ? n : m) - 1) / (n < m ? n : m);
+   uint8_t shuffle[16], ones[16];
+   __m128i shuffle_mask, ones_mask;
+   int i, p, c;
+
+   if (count < tail ||
+       (dst < src + count * n && src < dst + count * m))
+      return 0;
+
+   for (i = 0; i < 16; i++) {
+      shuffle[i] = 0x80;
+      ones[i] = 0;
+   }
+
+   for (p = 0; p < step; p++) {
+      for (c = 0; c < m; c++) {
+         const int b = p * m + c;
+
+         if (swizzle[c] < n)
+            shuffle[b] = p * n + swizzle[c];
+         else if (swizzle[c] == MESA_FORMAT_SWIZZLE_ONE)
+            ones[b] = one;
+      }
+   }
+
+   shuffle_mask = _mm_loadu_si128((const __m128i *) shuffle);
+   ones_mask = _mm_loadu_si128((const __m128i *) ones);
+
+   for (i = 0; count - i >= tail; i += step) {
+      __m128i pixels = _mm_loadu_si128((const __m128i *) src);
+
+      pixels = _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle_mask),
+                            ones_mask);
+      _mm_storeu_si128((__m128i *) dst, pixels);
+
+      src += step * n;
+      dst += step * m;
+   }
+
+   return i;
+}
+
+
+/**
+ * Convert RGBA float pixels to 8-bit unorm channels and swizzle them, as
+ * _mesa_float_to_unorm() does: values are clamped to [0, 1], NaN becomes 0,
+ * and the scaled values are rounded to nearest even.
+ *
+ * Four pixels are converted per iteration and packed into 16 bytes, which
+ * are then swizzled like in _mesa_sse41_swizzle_bytes(), so the same rules
+ * about the bytes past the last pixel and the return value apply.  Only
+ * sources of 4 channels are handled.
+ */
+int
+_mesa_sse41_pack_float_unorm8(uint8_t *dst, int num_dst_channels,
+                              const float *src, int num_src_channels,
+                              const uint8_t swizzle[4], int count)
+{
+   const int m = num_dst_channels;
+   const int tail = m < 4 ? (16 + m - 1) / m : 4;
+   const __m128 zero = _mm_setzero_ps();
+   const __m128 one = _mm_set1_ps(1.0f);
+   const __m128 scale = _mm_set1_ps(255.0f);
+   uint8_t shuffle[16], ones[16];
+   __m128i shuffle_mask, ones_mask;
+   int i, p, c;
+
+   if (num_src_channels != 4 || count < tail ||
+       ((const uint8_t *) src < dst + count * m &&
+        dst < (const uint8_t *) (src + count * 4)))
+      return 0;
+
+   for (i = 0; i < 16; i++) {
+      shuffle[i] = 0x80;
+      ones[i] = 0;
+   }
+
+   for (p = 0; p < 4; p++) {
+      for (c = 0; c < m; c++) {
+         if (swizzle[c] < 4)
+            shuffle[p * m + c] = p * 4 + swizzle[c];
+         else if (swizzle[c] == MESA_FORMAT_SWIZZLE_ONE)
+            ones[p * m + c] = 0xff;
+      }
+   }
+
+   shuffle_mask = _mm_loadu_si128((const __m128i *) shuffle);
+   ones_mask = _mm_loadu_si128((const __m128i *) ones);
+
+   for (i = 0; count - i >= tail; i += 4) {
+      __m128i v[4], pixels;
+
+      for (p = 0; p < 4; p++) {
+         /* MAXPS returns the second operand for NaN */
+         __m128 f = _mm_max_ps(_mm_loadu_ps(src + p * 4), zero);
+
+         f = _mm_mul_ps(_mm_min_ps(f, one), scale);
+         v[p] = _mm_cvtps_epi32(f);
+      }
+
+      pixels = _mm_packus_epi16(_mm_packus_epi32(v[0], v[1]),
+                                _mm_packus_epi32(v[2], v[3]));
+      pixels = _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle_mask),
+                            ones_mask);
+      _mm_storeu_si128((__m128i *) dst, pixels);
+
+      src += 16;
+      dst += 4 * m;
+   }
+
+   return i;
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \name dlist_bench.cpp
+ *
+ * Time glCallList on display lists typical of old CAD and visualization
+ * code, compiled with and without the EndList optimizations.  The lists
+ * are replayed into a driver which doesn't draw anything, so this measures
+ * the cost of walking the list, binding the vertex lists and validating
+ * state in core Mesa, and the number of draw calls a real driver would
+ * get.  This is a tool to run by hand; dlist_optimize.cpp checks that the
+ * optimized lists draw the same thing.
+ *
+ * Usage: dlist-bench [number of primitives per list, default 20000]
+ */
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "GL/gl.h"
+#include "GL/glext.h"
+#include "main/compiler.h"
+#include "main/api_exec.h"
+#include "main/context.h"
+#include "main/framebuffer.h"
+#include "main/vtxfmt.h"
+#include "glapi/glapi.h"
+#include "drivers/common/driverfuncs.h"
+#include "vbo/vbo.h"
+
+#ifndef GLAPIENTRYP
+#define GLAPIENTRYP GL_APIENTRYP
+#endif
+
+#include "main/dispatch.h"
+
+static struct gl_context ctx;
+static unsigned draw_calls;
+static int num_prims = 20000;
+
+static void
+count_draw(struct gl_context *ctx, const struct _mesa_prim *prims,
+           GLuint nr_prims, const struct _mesa_index_buffer *ib,
+           GLboolean index_bounds_valid, GLuint min_index, GLuint max_index,
+           struct gl_transform_feedback_object *tfb, unsigned stream,
+           struct gl_buffer_object *indirect)
+{
+   draw_calls++;
+}
+
+static void
+update_state(struct gl_context *ctx, GLuint new_state)
+{
+}
+
+/** A mesh drawn as one short triangle strip per row */
+static void
+emit_strips(void)
+{
+   const int width = 16;
+
+   for (int p = 0; p < num_prims; p++) {
+      CALL_Begin(ctx.CurrentDispatch, (GL_TRIANGLE_STRIP));
+      for (int x = 0; x <= width; x++) {
+         CALL_Normal3f(ctx.CurrentDispatch, (0, 0, 1));
+         CALL_Vertex3f(ctx.CurrentDispatch, (x, p, 0));
+         CALL_Normal3f(ctx.CurrentDispatch, (0, 0, 1));
+         CALL_Vertex3f(ctx.CurrentDispatch, (x, p + 1, 0));
+      }
+      CALL_End(ctx.CurrentDispatch, ());
+   }
+}
+
+/** Separate quads, each with a color set outside Begin/End */
+static void
+emit_colored_quads(void)
+{
+   for (int p = 0; p < num_prims; p++) {
+      /* the first color is overwritten before it is used */
+      CALL_Color3f(ctx.CurrentDispatch, (1, 1, 1));
+      CALL_Color3f(ctx.CurrentDispatch, (p & 1, p & 2, p & 4));
+      CALL_Begin(ctx.CurrentDispatch, (GL_QUADS));
+      CALL_Vertex2f(ctx.CurrentDispatch, (p, 0));
+      CALL_Vertex2f(ctx.CurrentDispatch, (p + 1, 0));
+      CALL_Vertex2f(ctx.CurrentDispatch, (p + 1, 1));
+      CALL_Vertex2f(ctx.CurrentDispatch, (p, 1));
+      CALL_End(ctx.CurrentDispatch, ());
+   }
+}
+
+/**
+ * Compile a list with \p emit, then replay it until at least half a
+ * second has passed and print the time of the fastest replay.
+ */
+static void
+bench(const char *name, void (*emit)(void), bool optimize)
+{
+   std::chrono::duration<double> total(0), best(1e9);
+
+   ctx.ListState.Optimize = optimize;
+   CALL_NewList(ctx.CurrentDispatch, (1, GL_COMPILE));
+   emit();
+   CALL_EndList(ctx.CurrentDispatch, ());
+
+   while (total.count() < 0.5) {
+      std::chrono::steady_clock::time_point start =
+         std::chrono::steady_clock::now();
+      draw_calls = 0;
+      CALL_CallList(ctx.CurrentDispatch, (1));
+      CALL_Flush(ctx.CurrentDispatch, ());
+      const std::chrono::duration<double> t =
+         std::chrono::steady_clock::now() - start;
+
+      total += t;
+      if (t < best)
+         best = t;
+   }
+
+   printf("%-14s %-9s: %8.1f us per glCallList, %6u draw calls\n", name,
+          optimize ? "optimized" : "plain", best.count() * 1e6, draw_calls);
+
+   CALL_DeleteLists(ctx.CurrentDispatch, (1, 1));
+}
+
+int
+main(int argc, char **argv)
+{
+   struct gl_config visual;
+   struct dd_function_table driver_functions;
+   struct gl_framebuffer *fb;
+
+   if (argc > 1)
+      num_prims = atoi(argv[1]);
+   if (num_prims <= 0) {
+      fprintf(stderr, "usage: %s [primitives]\n", argv[0]);
+      return 1;
+   }
+
+   memset(&visual, 0, sizeof(visual));
+   memset(&driver_functions, 0, sizeof(driver_functions));
+
+   _mesa_init_driver_functions(&driver_functions);
+   driver_functions.UpdateState = update_state;
+   _mesa_initialize_context(&ctx, API_OPENGL_COMPAT, &visual, NULL,
+                            &driver_functions);
+   _vbo_CreateContext(&ctx);
+
+   ctx.Version = 21;
+
+   _mesa_initialize_dispatch_tables(&ctx);
+   _mesa_initialize_vbo_vtxfmt(&ctx);
+   vbo_set_draw_func(&ctx, count_draw);
+
+   fb = _mesa_create_framebuffer(&visual);
+   _mesa_make_current(&ctx, fb, fb);
+
+   for (int optimize = 0; optimize <= 1; optimize++)
+      bench("strips", emit_strips, optimize);
+   for (int optimize = 0; optimize <= 1; optimize++)
+      bench("colored quads", emit_colored_quads, optimize);
+
+   _mesa_make_current(NULL, NULL, NULL);
+   _mesa_reference_framebuffer(&fb, NULL);
+   _vbo_DestroyContext(&ctx);
+   _mesa_free_context_data(&ctx);
+
+   return 0;
+}
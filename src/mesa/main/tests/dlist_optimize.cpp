@@ -0,0 +1,432 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \name dlist_optimize.cpp
+ *
+ * Compile the same commands into a display list with and without the
+ * EndList optimizations (see optimize_list() in dlist.c), replay both and
+ * check that the driver is asked to draw the same points, lines and
+ * triangles, with the same vertex data, in the same order.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+#include "GL/gl.h"
+#include "GL/glext.h"
+#include "main/compiler.h"
+#include "main/api_exec.h"
+#include "main/context.h"
+#include "main/dlist.h"
+#include "main/framebuffer.h"
+#include "main/vtxfmt.h"
+#include "glapi/glapi.h"
+#include "drivers/common/driverfuncs.h"
+#include "vbo/vbo.h"
+
+#ifndef GLAPIENTRYP
+#define GLAPIENTRYP GL_APIENTRYP
+#endif
+
+#include "main/dispatch.h"
+
+namespace {
+
+/** A vertex as the driver sees it: position and primary color */
+struct vertex {
+   GLfloat v[8];
+
+   bool operator==(const vertex &other) const
+   {
+      return memcmp(v, other.v, sizeof(v)) == 0;
+   }
+};
+
+/** Everything the driver was asked to draw, decomposed into points, lines
+ * and triangles so that it doesn't matter how they were grouped into
+ * primitives and draw calls.
+ */
+struct drawing {
+   std::vector<GLenum> modes;
+   std::vector<vertex> vertices;
+   unsigned draw_calls;
+};
+
+drawing *recording;
+
+void
+read_attrib(struct gl_context *ctx, gl_vert_attrib attrib, GLuint index,
+            GLfloat *out)
+{
+   const struct gl_client_array *array = ctx->Array._DrawArrays[attrib];
+   const GLubyte *base = array->BufferObj->Name ?
+      (const GLubyte *) array->BufferObj->Data : NULL;
+   const GLfloat *src = (const GLfloat *)
+      (base + (uintptr_t) array->Ptr + index * array->StrideB);
+   static const GLfloat defaults[4] = { 0, 0, 0, 1 };
+
+   ASSERT_EQ((GLenum) GL_FLOAT, array->Type);
+   for (int c = 0; c < 4; c++)
+      out[c] = c < array->Size ? src[c] : defaults[c];
+}
+
+void
+emit(struct gl_context *ctx, GLenum mode, GLuint start,
+     const GLuint *indices, int count)
+{
+   std::vector<vertex> &vertices = recording->vertices;
+   const size_t first = vertices.size();
+
+   for (int i = 0; i < count; i++) {
+      vertex v;
+      read_attrib(ctx, VERT_ATTRIB_POS, start + indices[i], v.v);
+      read_attrib(ctx, VERT_ATTRIB_COLOR0, start + indices[i], v.v + 4);
+      vertices.push_back(v);
+   }
+
+   /* When a triangle strip is split between two vertex lists after an odd
+    * number of vertices, the second list starts with the last three
+    * vertices of the first to keep the winding, so the triangle they form
+    * is drawn twice.  The merged list draws it once, so skip the repeat.
+    */
+   if (mode == GL_TRIANGLES && !recording->modes.empty() &&
+       recording->modes.back() == GL_TRIANGLES &&
+       std::equal(vertices.begin() + first - 3, vertices.begin() + first,
+                  vertices.begin() + first)) {
+      vertices.resize(first);
+      return;
+   }
+
+   recording->modes.push_back(mode);
+}
+
+void
+record_draw(struct gl_context *ctx, const struct _mesa_prim *prims,
+            GLuint nr_prims, const struct _mesa_index_buffer *ib,
+            GLboolean index_bounds_valid, GLuint min_index,
+            GLuint max_index, struct gl_transform_feedback_object *tfb,
+            unsigned stream, struct gl_buffer_object *indirect)
+{
+   ASSERT_EQ(NULL, ib);
+   recording->draw_calls++;
+
+   for (GLuint p = 0; p < nr_prims; p++) {
+      const GLuint start = prims[p].start;
+      const GLuint n = prims[p].count;
+      GLuint i;
+
+      switch (prims[p].mode) {
+      case GL_POINTS:
+         for (i = 0; i < n; i++) {
+            const GLuint idx[] = { i };
+            emit(ctx, GL_POINTS, start, idx, 1);
+         }
+         break;
+      case GL_LINES:
+         for (i = 0; i + 1 < n; i += 2) {
+            const GLuint idx[] = { i, i + 1 };
+            emit(ctx, GL_LINES, start, idx, 2);
+         }
+         break;
+      case GL_LINE_STRIP:
+         for (i = 0; i + 1 < n; i++) {
+            const GLuint idx[] = { i, i + 1 };
+            emit(ctx, GL_LINES, start, idx, 2);
+         }
+         break;
+      case GL_TRIANGLES:
+         for (i = 0; i + 2 < n; i += 3) {
+            const GLuint idx[] = { i, i + 1, i + 2 };
+            emit(ctx, GL_TRIANGLES, start, idx, 3);
+         }
+         break;
+      case GL_TRIANGLE_STRIP:
+         for (i = 0; i + 2 < n; i++) {
+            const GLuint idx[] = { i + (i & 1), i + 1 - (i & 1), i + 2 };
+            emit(ctx, GL_TRIANGLES, start, idx, 3);
+         }
+         break;
+      case GL_TRIANGLE_FAN:
+      case GL_POLYGON:
+         for (i = 1; i + 1 < n; i++) {
+            const GLuint idx[] = { 0, i, i + 1 };
+            emit(ctx, GL_TRIANGLES, start, idx, 3);
+         }
+         break;
+      case GL_QUADS:
+         for (i = 0; i + 3 < n; i += 4) {
+            const GLuint idx[] = { i, i + 1, i + 2, i, i + 2, i + 3 };
+            emit(ctx, GL_TRIANGLES, start, idx, 3);
+            emit(ctx, GL_TRIANGLES, start, idx + 3, 3);
+         }
+         break;
+      default:
+         ADD_FAILURE() << "unexpected primitive " << prims[p].mode;
+      }
+   }
+}
+
+void
+update_state(struct gl_context *ctx, GLuint new_state)
+{
+}
+
+} /* anonymous namespace */
+
+class DlistOptimize_test : public ::testing::Test {
+public:
+   virtual void SetUp();
+   virtual void TearDown();
+
+   void begin_list(GLuint list, bool optimize);
+   void end_list();
+   drawing replay(GLuint list);
+   void check_same_drawing();
+
+   /* A fixed pseudo-random sequence, so that failures are reproducible */
+   float random();
+
+   struct gl_config visual;
+   struct dd_function_table driver_functions;
+   struct gl_context ctx;
+   struct gl_framebuffer *fb;
+   unsigned seed;
+};
+
+void
+DlistOptimize_test::SetUp()
+{
+   memset(&visual, 0, sizeof(visual));
+   memset(&driver_functions, 0, sizeof(driver_functions));
+   memset(&ctx, 0, sizeof(ctx));
+   seed = 1;
+
+   _mesa_init_driver_functions(&driver_functions);
+   driver_functions.UpdateState = update_state;
+   _mesa_initialize_context(&ctx, API_OPENGL_COMPAT, &visual, NULL,
+                            &driver_functions);
+   _vbo_CreateContext(&ctx);
+
+   ctx.Version = 21;
+
+   _mesa_initialize_dispatch_tables(&ctx);
+   _mesa_initialize_vbo_vtxfmt(&ctx);
+   vbo_set_draw_func(&ctx, record_draw);
+
+   fb = _mesa_create_framebuffer(&visual);
+   _mesa_make_current(&ctx, fb, fb);
+}
+
+void
+DlistOptimize_test::TearDown()
+{
+   _mesa_make_current(NULL, NULL, NULL);
+   _mesa_reference_framebuffer(&fb, NULL);
+   _vbo_DestroyContext(&ctx);
+   _mesa_free_context_data(&ctx);
+}
+
+void
+DlistOptimize_test::begin_list(GLuint list, bool optimize)
+{
+   ctx.ListState.Optimize = optimize;
+   CALL_NewList(ctx.CurrentDispatch, (list, GL_COMPILE));
+}
+
+void
+DlistOptimize_test::end_list()
+{
+   CALL_EndList(ctx.CurrentDispatch, ());
+   EXPECT_EQ((GLenum) GL_NO_ERROR, ctx.ErrorValue);
+}
+
+drawing
+DlistOptimize_test::replay(GLuint list)
+{
+   drawing d;
+
+   /* Lists which don't set all of the attributes draw with the current
+    * values, so start from the same ones each time.
+    */
+   CALL_Color4f(ctx.CurrentDispatch, (0, 0, 0, 0));
+
+   d.draw_calls = 0;
+   recording = &d;
+   CALL_CallList(ctx.CurrentDispatch, (list));
+   CALL_Flush(ctx.CurrentDispatch, ());
+   recording = NULL;
+
+   EXPECT_EQ((GLenum) GL_NO_ERROR, ctx.ErrorValue);
+   return d;
+}
+
+/**
+ * Replay lists 1 (compiled without optimizations) and 2 (with them) and
+ * compare what was drawn.
+ */
+void
+DlistOptimize_test::check_same_drawing()
+{
+   const drawing plain = replay(1);
+   const drawing optimized = replay(2);
+
+   EXPECT_FALSE(plain.modes.empty());
+   EXPECT_LE(optimized.draw_calls, plain.draw_calls);
+   ASSERT_EQ(plain.modes.size(), optimized.modes.size());
+   ASSERT_EQ(plain.vertices.size(), optimized.vertices.size());
+
+   for (unsigned i = 0; i < plain.modes.size(); i++)
+      EXPECT_EQ(plain.modes[i], optimized.modes[i]) << "primitive " << i;
+   for (unsigned i = 0; i < plain.vertices.size(); i++)
+      EXPECT_TRUE(plain.vertices[i] == optimized.vertices[i])
+         << "vertex " << i;
+}
+
+float
+DlistOptimize_test::random()
+{
+   seed = seed * 1103515245 + 12345;
+   return (seed >> 8 & 0xffff) / 65536.0f;
+}
+
+/**
+ * A triangle strip which doesn't fit into one vertex store is split into
+ * several vertex lists, which must be joined again without drawing the
+ * vertices repeated at the split twice.
+ */
+TEST_F(DlistOptimize_test, SplitStrip)
+{
+   for (GLuint list = 1; list <= 2; list++) {
+      seed = 1;
+      begin_list(list, list == 2);
+      CALL_Begin(ctx.CurrentDispatch, (GL_TRIANGLE_STRIP));
+      for (int i = 0; i < 5001; i++) {
+         CALL_Color4f(ctx.CurrentDispatch,
+                      (random(), random(), random(), random()));
+         CALL_Vertex3f(ctx.CurrentDispatch, (random(), random(), i));
+      }
+      CALL_End(ctx.CurrentDispatch, ());
+      end_list();
+   }
+
+   const drawing optimized = replay(2);
+   EXPECT_EQ(1u, optimized.draw_calls);
+   EXPECT_EQ(4999u, optimized.modes.size());
+
+   check_same_drawing();
+}
+
+/**
+ * More Begin/End pairs than fit into one primitive store, with every
+ * primitive type.
+ */
+TEST_F(DlistOptimize_test, ManyPrimitives)
+{
+   static const GLenum modes[] = {
+      GL_POINTS, GL_LINES, GL_LINE_STRIP, GL_TRIANGLES, GL_TRIANGLE_STRIP,
+      GL_TRIANGLE_FAN, GL_QUADS, GL_POLYGON,
+   };
+
+   for (GLuint list = 1; list <= 2; list++) {
+      seed = 1;
+      begin_list(list, list == 2);
+      for (int p = 0; p < 1000; p++) {
+         const int count = 4 + (int) (random() * 60);
+         const GLenum mode = modes[(int) (random() * ARRAY_SIZE(modes))];
+
+         CALL_Begin(ctx.CurrentDispatch, (mode));
+         for (int i = 0; i < count; i++) {
+            CALL_Color3f(ctx.CurrentDispatch, (random(), random(), random()));
+            CALL_Vertex2f(ctx.CurrentDispatch, (random(), random()));
+         }
+         CALL_End(ctx.CurrentDispatch, ());
+      }
+      end_list();
+   }
+
+   check_same_drawing();
+}
+
+/**
+ * Vertex lists with different vertex formats can't be merged, but they
+ * must still be drawn in order.
+ */
+TEST_F(DlistOptimize_test, FormatChanges)
+{
+   for (GLuint list = 1; list <= 2; list++) {
+      seed = 1;
+      begin_list(list, list == 2);
+      for (int p = 0; p < 300; p++) {
+         const bool color = random() < 0.5f;
+
+         CALL_Begin(ctx.CurrentDispatch, (GL_TRIANGLES));
+         for (int i = 0; i < 60; i++) {
+            if (color)
+               CALL_Color4f(ctx.CurrentDispatch,
+                            (random(), random(), random(), 1));
+            CALL_Vertex3f(ctx.CurrentDispatch, (random(), random(), p));
+         }
+         CALL_End(ctx.CurrentDispatch, ());
+      }
+      end_list();
+   }
+
+   check_same_drawing();
+}
+
+/**
+ * Colors set outside Begin/End and overwritten before they are used are
+ * removed; the ones which are used must survive, and so must the last one.
+ */
+TEST_F(DlistOptimize_test, OverwrittenAttributes)
+{
+   GLfloat current[2][4];
+
+   for (GLuint list = 1; list <= 2; list++) {
+      seed = 1;
+      begin_list(list, list == 2);
+      for (int p = 0; p < 50; p++) {
+         CALL_Color3f(ctx.CurrentDispatch, (random(), random(), random()));
+         CALL_Color3f(ctx.CurrentDispatch, (random(), random(), random()));
+         CALL_Begin(ctx.CurrentDispatch, (GL_TRIANGLES));
+         for (int i = 0; i < 3; i++)
+            CALL_Vertex2f(ctx.CurrentDispatch, (random(), random()));
+         CALL_End(ctx.CurrentDispatch, ());
+      }
+      CALL_Color3f(ctx.CurrentDispatch, (random(), random(), random()));
+      CALL_Color3f(ctx.CurrentDispatch, (random(), random(), random()));
+      end_list();
+   }
+
+   check_same_drawing();
+
+   for (GLuint list = 1; list <= 2; list++) {
+      replay(list);
+      memcpy(current[list - 1], ctx.Current.Attrib[VERT_ATTRIB_COLOR0],
+             sizeof(current[0]));
+   }
+   EXPECT_EQ(0, memcmp(current[0], current[1], sizeof(current[0])));
+   EXPECT_NE(0.0f, current[0][0] + current[0][1] + current[0][2]);
+}
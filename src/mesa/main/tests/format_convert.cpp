@@ -0,0 +1,152 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \name format_convert.cpp
+ *
+ * Check the 8-bit swizzles of _mesa_swizzle_and_convert() and
+ * _mesa_format_convert(), which have vectorized paths, against a plain
+ * per-channel loop.
+ */
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include "main/formats.h"
+#include "main/format_utils.h"
+
+#define MAX_PIXELS 80
+
+static void
+reference_swizzle(uint8_t *dst, int num_dst_channels,
+                  const uint8_t *src, int num_src_channels,
+                  const uint8_t swizzle[4], uint8_t one, int count)
+{
+   for (int i = 0; i < count; i++) {
+      for (int c = 0; c < num_dst_channels; c++) {
+         uint8_t value = 0;
+
+         if (swizzle[c] < num_src_channels)
+            value = src[i * num_src_channels + swizzle[c]];
+         else if (swizzle[c] == MESA_FORMAT_SWIZZLE_ONE)
+            value = one;
+
+         dst[i * num_dst_channels + c] = value;
+      }
+   }
+}
+
+TEST(FormatConvertTest, SwizzleBytes)
+{
+   static const uint8_t swizzles[][4] = {
+      { 0, 1, 2, 3 },
+      { 2, 1, 0, 3 },
+      { 3, 2, 1, 0 },
+      { 0, 0, 0, 5 },
+      { 0, 4, 4, 5 },
+      { 1, 0, 5, 4 },
+   };
+   uint8_t src[MAX_PIXELS * 4];
+   uint8_t dst[MAX_PIXELS * 4], expected[MAX_PIXELS * 4];
+
+   for (unsigned i = 0; i < sizeof(src); i++)
+      src[i] = i * 37 + 11;
+
+   for (int n = 1; n <= 4; n++) {
+      for (int m = 1; m <= 4; m++) {
+         for (unsigned s = 0; s < ARRAY_SIZE(swizzles); s++) {
+            uint8_t swizzle[4];
+
+            /* Only use channels that are in the source. */
+            for (int c = 0; c < 4; c++) {
+               swizzle[c] = swizzles[s][c];
+               if (swizzle[c] < 4 && swizzle[c] >= n)
+                  swizzle[c] = MESA_FORMAT_SWIZZLE_ZERO;
+            }
+
+            for (int count = 0; count <= MAX_PIXELS; count++) {
+               SCOPED_TRACE(testing::Message() << n << " to " << m <<
+                            " channels, swizzle " << s <<
+                            ", " << count << " pixels");
+
+               memset(dst, 0xcd, sizeof(dst));
+               memset(expected, 0xcd, sizeof(expected));
+               reference_swizzle(expected, m, src, n, swizzle, 0xff, count);
+               _mesa_swizzle_and_convert(dst, MESA_ARRAY_FORMAT_TYPE_UBYTE, m,
+                                         src, MESA_ARRAY_FORMAT_TYPE_UBYTE, n,
+                                         swizzle, true, count);
+               ASSERT_EQ(0, memcmp(dst, expected, sizeof(dst)));
+
+               memset(dst, 0xcd, sizeof(dst));
+               memset(expected, 0xcd, sizeof(expected));
+               reference_swizzle(expected, m, src, n, swizzle, 0x7f, count);
+               _mesa_swizzle_and_convert(dst, MESA_ARRAY_FORMAT_TYPE_BYTE, m,
+                                         src, MESA_ARRAY_FORMAT_TYPE_BYTE, n,
+                                         swizzle, true, count);
+               ASSERT_EQ(0, memcmp(dst, expected, sizeof(dst)));
+            }
+         }
+      }
+   }
+}
+
+TEST(FormatConvertTest, SwizzleBytesInPlace)
+{
+   static const uint8_t swizzle[4] = { 2, 1, 0, 3 };
+   uint8_t data[MAX_PIXELS * 4], expected[MAX_PIXELS * 4];
+
+   for (unsigned i = 0; i < sizeof(data); i++)
+      data[i] = i;
+
+   reference_swizzle(expected, 4, data, 4, swizzle, 0xff, MAX_PIXELS);
+   _mesa_swizzle_and_convert(data, MESA_ARRAY_FORMAT_TYPE_UBYTE, 4,
+                             data, MESA_ARRAY_FORMAT_TYPE_UBYTE, 4,
+                             swizzle, true, MAX_PIXELS);
+   EXPECT_EQ(0, memcmp(data, expected, sizeof(data)));
+}
+
+TEST(FormatConvertTest, RGBAToBGRA)
+{
+   static const uint8_t swizzle[4] = { 2, 1, 0, 3 };
+   const int stride = MAX_PIXELS * 4 + 4;
+   uint8_t src[stride * 3], dst[stride * 3], expected[stride * 3];
+
+   for (unsigned i = 0; i < sizeof(src); i++)
+      src[i] = i * 13 + 5;
+
+   for (int width = 1; width <= MAX_PIXELS; width++) {
+      SCOPED_TRACE(testing::Message() << width << " pixels wide");
+
+      memset(dst, 0, sizeof(dst));
+      memset(expected, 0, sizeof(expected));
+      for (int row = 0; row < 3; row++) {
+         reference_swizzle(expected + row * stride, 4,
+                           src + row * stride, 4, swizzle, 0xff, width);
+      }
+
+      _mesa_format_convert(dst, MESA_FORMAT_B8G8R8A8_UNORM, stride,
+                           src, MESA_FORMAT_R8G8B8A8_UNORM, stride,
+                           width, 3, NULL);
+      ASSERT_EQ(0, memcmp(dst, expected, sizeof(dst)));
+   }
+}
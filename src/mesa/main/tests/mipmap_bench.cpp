@@ -0,0 +1,152 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \name mipmap_bench.cpp
+ *
+ * Time _mesa_generate_mipmap_level() building a whole mipmap chain of RGBA8,
+ * sRGB8_ALPHA8, RGBA16F and RGBA32F images, on the calling thread.  This is
+ * a tool to run by hand; mipmap_generate.cpp checks the filter.
+ *
+ * Usage: mipmap-bench [size in pixels, default 1024]
+ */
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "main/macros.h"
+#include "main/mipmap.h"
+
+static int size = 1024;
+
+struct level {
+   int width, height;
+   std::vector<uint8_t> data;
+};
+
+static int
+bytes_per_texel(GLenum datatype)
+{
+   return 4 * (datatype == GL_FLOAT ? 4 :
+               datatype == GL_HALF_FLOAT_ARB ? 2 : 1);
+}
+
+static void
+make_chain(GLenum datatype, std::vector<level> &chain)
+{
+   const int bpt = bytes_per_texel(datatype);
+   uint32_t seed = 1;
+
+   chain.resize(1);
+   chain[0].width = chain[0].height = size;
+   chain[0].data.resize(size * size * bpt);
+
+   for (int i = 0; i < size * size * 4; i++) {
+      seed = seed * 1103515245 + 12345;
+
+      switch (datatype) {
+      case GL_UNSIGNED_BYTE:
+         chain[0].data[i] = seed >> 24;
+         break;
+      case GL_HALF_FLOAT_ARB:
+         ((uint16_t *) &chain[0].data[0])[i] = (seed >> 16) & 0x3bff;
+         break;
+      case GL_FLOAT:
+         ((float *) &chain[0].data[0])[i] = (seed >> 8) / 16777216.0f;
+         break;
+      }
+   }
+
+   while (chain.back().width > 1 || chain.back().height > 1) {
+      level next;
+
+      next.width = MAX2(chain.back().width / 2, 1);
+      next.height = MAX2(chain.back().height / 2, 1);
+      next.data.resize(next.width * next.height * bpt);
+      chain.push_back(next);
+   }
+}
+
+static void
+generate_chain(GLenum datatype, GLbitfield srgb, std::vector<level> &chain)
+{
+   const int bpt = bytes_per_texel(datatype);
+
+   for (unsigned l = 1; l < chain.size(); l++) {
+      const GLubyte *src = &chain[l - 1].data[0];
+      GLubyte *dst = &chain[l].data[0];
+
+      _mesa_generate_mipmap_level(NULL, GL_TEXTURE_2D, datatype, 4, srgb, 0,
+                                  chain[l - 1].width, chain[l - 1].height, 1,
+                                  &src, chain[l - 1].width * bpt,
+                                  chain[l].width, chain[l].height, 1,
+                                  &dst, chain[l].width * bpt);
+   }
+}
+
+/**
+ * Build the chain until at least half a second has passed and print the
+ * speed of the fastest run, in base level pixels per second.
+ */
+static void
+bench(const char *name, GLenum datatype, GLbitfield srgb)
+{
+   std::vector<level> chain;
+   std::chrono::duration<double> total(0), best(1e9);
+
+   make_chain(datatype, chain);
+
+   while (total.count() < 0.5) {
+      std::chrono::steady_clock::time_point start =
+         std::chrono::steady_clock::now();
+      generate_chain(datatype, srgb, chain);
+      const std::chrono::duration<double> t =
+         std::chrono::steady_clock::now() - start;
+
+      total += t;
+      if (t < best)
+         best = t;
+   }
+
+   printf("%-16s %8.2f MPix/s\n", name, size * size / best.count() / 1e6);
+}
+
+int
+main(int argc, char **argv)
+{
+   if (argc > 1)
+      size = atoi(argv[1]);
+   if (size <= 0) {
+      fprintf(stderr, "usage: %s [size]\n", argv[0]);
+      return 1;
+   }
+
+   bench("RGBA8", GL_UNSIGNED_BYTE, 0);
+   bench("SRGB8_ALPHA8", GL_UNSIGNED_BYTE, 0x7);
+   bench("RGBA16F", GL_HALF_FLOAT_ARB, 0);
+   bench("RGBA32F", GL_FLOAT, 0);
+
+   return 0;
+}
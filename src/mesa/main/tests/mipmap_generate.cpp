@@ -0,0 +1,263 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \name mipmap_generate.cpp
+ *
+ * Compare the box filter of _mesa_generate_mipmap_level() for RGBA8,
+ * RGBA16F and RGBA32F images with a plain per-component implementation of
+ * the same filter, which must match it bit for bit.  sRGB-encoded images
+ * are checked against an exact linear space average.  mipmap_bench.cpp
+ * measures the speed of the filter.
+ */
+
+#include <gtest/gtest.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#include "main/macros.h"
+#include "main/mipmap.h"
+#include "util/half_float.h"
+
+namespace {
+
+struct image {
+   GLenum datatype;
+   int width, height, layers;
+   std::vector<std::vector<uint8_t> > data;
+
+   int row_stride() const
+   {
+      return width * 4 * (datatype == GL_FLOAT ? 4 :
+                          datatype == GL_HALF_FLOAT_ARB ? 2 : 1);
+   }
+};
+
+image
+make_image(GLenum datatype, int width, int height, int layers)
+{
+   image img;
+   uint32_t seed = 1;
+
+   img.datatype = datatype;
+   img.width = width;
+   img.height = height;
+   img.layers = layers;
+   img.data.resize(layers);
+
+   for (int l = 0; l < layers; l++) {
+      img.data[l].resize(img.row_stride() * height);
+
+      for (int i = 0; i < width * height * 4; i++) {
+         seed = seed * 1103515245 + 12345;
+
+         switch (datatype) {
+         case GL_UNSIGNED_BYTE:
+            img.data[l][i] = seed >> 24;
+            break;
+         case GL_HALF_FLOAT_ARB:
+            /* finite values, including denormals */
+            ((uint16_t *) &img.data[l][0])[i] = (seed >> 16) & 0xfbff;
+            break;
+         case GL_FLOAT:
+            ((float *) &img.data[l][0])[i] = (int32_t) seed / 65536.0f;
+            break;
+         }
+      }
+   }
+
+   return img;
+}
+
+image
+next_level(const image &src)
+{
+   image dst;
+
+   dst.datatype = src.datatype;
+   dst.width = MAX2(src.width / 2, 1);
+   dst.height = MAX2(src.height / 2, 1);
+   dst.layers = src.layers;
+   dst.data.resize(dst.layers);
+   for (int l = 0; l < dst.layers; l++)
+      dst.data[l].resize(dst.row_stride() * dst.height);
+
+   return dst;
+}
+
+void
+generate(const image &src, image &dst, GLbitfield srgb)
+{
+   std::vector<const GLubyte *> src_slices(src.layers);
+   std::vector<GLubyte *> dst_slices(dst.layers);
+
+   for (int l = 0; l < src.layers; l++) {
+      src_slices[l] = &src.data[l][0];
+      dst_slices[l] = &dst.data[l][0];
+   }
+
+   _mesa_generate_mipmap_level(NULL, src.layers > 1 ? GL_TEXTURE_2D_ARRAY :
+                                                      GL_TEXTURE_2D,
+                               src.datatype, 4, srgb, 0,
+                               src.width, src.height, src.layers,
+                               &src_slices[0], src.row_stride(),
+                               dst.width, dst.height, dst.layers,
+                               &dst_slices[0], dst.row_stride());
+}
+
+/**
+ * The filter as it is written in C in mipmap.c, one component at a time.
+ */
+void
+generate_reference(const image &src, image &dst)
+{
+   const int row_step = src.height > dst.height ? 2 : 1;
+   const int col_step = src.width > dst.width ? 2 : 1;
+
+   for (int l = 0; l < src.layers; l++) {
+      for (int y = 0; y < dst.height; y++) {
+         const uint8_t *rowA = &src.data[l][y * row_step * src.row_stride()];
+         const uint8_t *rowB = rowA + (row_step - 1) * src.row_stride();
+         uint8_t *row = &dst.data[l][y * dst.row_stride()];
+
+         for (int x = 0; x < dst.width * 4; x++) {
+            const int j = (x / 4) * col_step * 4 + x % 4;
+            const int k = j + (col_step - 1) * 4;
+
+            switch (src.datatype) {
+            case GL_UNSIGNED_BYTE:
+               row[x] = (rowA[j] + rowA[k] + rowB[j] + rowB[k]) / 4;
+               break;
+            case GL_HALF_FLOAT_ARB: {
+               const uint16_t *a = (const uint16_t *) rowA;
+               const uint16_t *b = (const uint16_t *) rowB;
+
+               ((uint16_t *) row)[x] =
+                  _mesa_float_to_half((_mesa_half_to_float(a[j]) +
+                                       _mesa_half_to_float(a[k]) +
+                                       _mesa_half_to_float(b[j]) +
+                                       _mesa_half_to_float(b[k])) * 0.25F);
+               break;
+            }
+            case GL_FLOAT: {
+               const float *a = (const float *) rowA;
+               const float *b = (const float *) rowB;
+
+               ((float *) row)[x] = (a[j] + a[k] + b[j] + b[k]) * 0.25F;
+               break;
+            }
+            }
+         }
+      }
+   }
+}
+
+void
+test_datatype(GLenum datatype, const char *name)
+{
+   static const int sizes[][3] = {
+      { 256, 256, 1 },
+      { 255, 129, 1 },
+      { 1, 67, 1 },
+      { 67, 1, 1 },
+      { 34, 18, 6 },
+   };
+
+   for (unsigned i = 0; i < ARRAY_SIZE(sizes); i++) {
+      image src = make_image(datatype, sizes[i][0], sizes[i][1], sizes[i][2]);
+      image dst = next_level(src), ref = next_level(src);
+
+      generate(src, dst, 0);
+      generate_reference(src, ref);
+
+      for (int l = 0; l < src.layers; l++) {
+         EXPECT_EQ(0, memcmp(&dst.data[l][0], &ref.data[l][0],
+                             ref.data[l].size()))
+            << name << " " << src.width << "x" << src.height << " layer " << l;
+      }
+   }
+}
+
+double
+srgb_to_linear(double v)
+{
+   return v <= 0.04045 ? v / 12.92 : pow((v + 0.055) / 1.055, 2.4);
+}
+
+double
+linear_to_srgb(double v)
+{
+   return v <= 0.0031308 ? v * 12.92 : 1.055 * pow(v, 1 / 2.4) - 0.055;
+}
+
+} /* anonymous namespace */
+
+TEST(MipmapGenerateTest, RGBA8)
+{
+   test_datatype(GL_UNSIGNED_BYTE, "RGBA8");
+}
+
+TEST(MipmapGenerateTest, RGBA16F)
+{
+   test_datatype(GL_HALF_FLOAT_ARB, "RGBA16F");
+}
+
+TEST(MipmapGenerateTest, RGBA32F)
+{
+   test_datatype(GL_FLOAT, "RGBA32F");
+}
+
+TEST(MipmapGenerateTest, SRGB8Alpha8)
+{
+   image src = make_image(GL_UNSIGNED_BYTE, 64, 64, 1);
+   image dst = next_level(src);
+
+   /* RGB are sRGB-encoded, alpha is linear */
+   generate(src, dst, 0x7);
+
+   for (int y = 0; y < dst.height; y++) {
+      for (int x = 0; x < dst.width; x++) {
+         for (int c = 0; c < 4; c++) {
+            const uint8_t *p = &src.data[0][(y * 2 * src.width + x * 2) * 4 + c];
+            const uint8_t texels[4] = {
+               p[0], p[4], p[src.width * 4], p[src.width * 4 + 4]
+            };
+            int expected;
+
+            if (c < 3) {
+               double sum = 0.0;
+               for (int t = 0; t < 4; t++)
+                  sum += srgb_to_linear(texels[t] / 255.0);
+               expected = lround(linear_to_srgb(sum / 4) * 255.0);
+            }
+            else {
+               expected = (texels[0] + texels[1] + texels[2] + texels[3]) / 4;
+            }
+
+            EXPECT_NEAR(expected, dst.data[0][(y * dst.width + x) * 4 + c],
+                        c < 3 ? 1 : 0);
+         }
+      }
+   }
+}
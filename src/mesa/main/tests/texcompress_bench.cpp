@@ -0,0 +1,217 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \name texcompress_bench.cpp
+ *
+ * Time the built-in S3TC, BPTC and ETC2 encoders at every quality level on
+ * a synthetic image, on the calling thread.  This is a tool to run by hand;
+ * texcompress_encode.cpp checks the quality of the encoders.
+ *
+ * Usage: texcompress-bench [size in pixels, default 1024]
+ */
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "main/formats.h"
+#include "main/texcompress.h"
+#include "main/texcompress_bptc.h"
+#include "main/texcompress_etc.h"
+#include "util/dxtn.h"
+
+static int size = 1024;
+
+static void
+make_image(uint8_t *pixels)
+{
+   for (int y = 0; y < size; y++) {
+      for (int x = 0; x < size; x++) {
+         uint8_t *p = pixels + (y * size + x) * 4;
+         const float fx = x / (float) size, fy = y / (float) size;
+         const float v = 0.5f + 0.25f * sinf(fx * 17 + sinf(fy * 5) * 3) +
+                         0.2f * sinf(fy * 23 + fx * 4);
+
+         p[0] = fminf(fmaxf(v * 255, 0), 255);
+         p[1] = fminf(fmaxf(v * 200 + 30 * sinf(fx * 9), 0), 255);
+         p[2] = fminf(fmaxf((1 - v) * 180, 0), 255);
+         p[3] = fminf(fmaxf(128 + 127 * sinf(fx * 7 + fy * 3), 0), 255);
+      }
+   }
+}
+
+typedef void (*encode_func)(unsigned quality, const void *pixels,
+                            uint8_t *blocks);
+
+/**
+ * Run \p encode until at least half a second has passed and print the
+ * speed of the fastest run.
+ */
+static void
+bench(const char *name, unsigned quality, encode_func encode,
+      const void *pixels)
+{
+   std::vector<uint8_t> blocks(size * size);
+   std::chrono::duration<double> total(0), best(1e9);
+
+   while (total.count() < 0.5) {
+      std::chrono::steady_clock::time_point start =
+         std::chrono::steady_clock::now();
+      encode(quality, pixels, &blocks[0]);
+      const std::chrono::duration<double> t =
+         std::chrono::steady_clock::now() - start;
+
+      total += t;
+      if (t < best)
+         best = t;
+   }
+
+   printf("%-32s quality %u: %8.2f MPix/s\n", name, quality,
+          size * size / best.count() / 1e6);
+}
+
+static void
+encode_dxt1(unsigned quality, const void *pixels, uint8_t *blocks)
+{
+   util_format_encode_dxtn(UTIL_DXTN_DXT1_RGB, quality,
+                           (const uint8_t *) pixels, 4, size * 4,
+                           size, size, blocks, size / 4 * 8);
+}
+
+static void
+encode_dxt5(unsigned quality, const void *pixels, uint8_t *blocks)
+{
+   util_format_encode_dxtn(UTIL_DXTN_DXT5_RGBA, quality,
+                           (const uint8_t *) pixels, 4, size * 4,
+                           size, size, blocks, size / 4 * 16);
+}
+
+static void
+encode_bptc_unorm(unsigned quality, const void *pixels, uint8_t *blocks)
+{
+   _mesa_bptc_compress_rgba_unorm(quality, size, size,
+                                  (const uint8_t *) pixels, size * 4,
+                                  blocks, size / 4 * 16);
+}
+
+static void
+encode_bptc_float(unsigned quality, const void *pixels, uint8_t *blocks)
+{
+   _mesa_bptc_compress_rgb_float(quality, false, size, size,
+                                 (const float *) pixels, size * 12,
+                                 blocks, size / 4 * 16);
+}
+
+static void
+encode_etc2(mesa_format format, unsigned quality, const void *pixels,
+            uint8_t *blocks)
+{
+   _mesa_etc2_compress(format, quality, size, size, pixels, size * 4,
+                       blocks, size / 4 * _mesa_get_format_bytes(format));
+}
+
+static void
+encode_etc2_rgb8(unsigned quality, const void *pixels, uint8_t *blocks)
+{
+   encode_etc2(MESA_FORMAT_ETC2_RGB8, quality, pixels, blocks);
+}
+
+static void
+encode_etc2_rgba8(unsigned quality, const void *pixels, uint8_t *blocks)
+{
+   encode_etc2(MESA_FORMAT_ETC2_RGBA8_EAC, quality, pixels, blocks);
+}
+
+static void
+encode_etc2_punchthrough(unsigned quality, const void *pixels,
+                         uint8_t *blocks)
+{
+   encode_etc2(MESA_FORMAT_ETC2_RGB8_PUNCHTHROUGH_ALPHA1, quality, pixels,
+               blocks);
+}
+
+static void
+encode_eac_rg11(unsigned quality, const void *pixels, uint8_t *blocks)
+{
+   encode_etc2(MESA_FORMAT_ETC2_RG11_EAC, quality, pixels, blocks);
+}
+
+int
+main(int argc, char **argv)
+{
+   static const struct {
+      const char *name;
+      encode_func encode;
+   } rgba8_encoders[] = {
+      { "BPTC_RGBA_UNORM", encode_bptc_unorm },
+      { "ETC2_RGB8", encode_etc2_rgb8 },
+      { "ETC2_RGBA8_EAC", encode_etc2_rgba8 },
+      { "ETC2_RGB8_PUNCHTHROUGH_ALPHA1", encode_etc2_punchthrough },
+   };
+
+   if (argc > 1)
+      size = (atoi(argv[1]) + 3) & ~3;
+   if (size <= 0) {
+      fprintf(stderr, "usage: %s [size]\n", argv[0]);
+      return 1;
+   }
+
+   std::vector<uint8_t> pixels(size * size * 4);
+   std::vector<float> floats(size * size * 3);
+   std::vector<uint16_t> rg16(size * size * 2);
+
+   make_image(&pixels[0]);
+   for (int i = 0; i < size * size; i++) {
+      for (int c = 0; c < 3; c++) {
+         const float v = pixels[i * 4 + c] / 255.0f;
+         floats[i * 3 + c] = v * v * 16.0f;
+      }
+      for (int c = 0; c < 2; c++)
+         rg16[i * 2 + c] = pixels[i * 4 + c] * 257;
+   }
+
+   for (unsigned q = UTIL_DXTN_QUALITY_FAST; q <= UTIL_DXTN_QUALITY_MAX; q++)
+      bench("DXT1_RGB", q, encode_dxt1, &pixels[0]);
+   for (unsigned q = UTIL_DXTN_QUALITY_FAST; q <= UTIL_DXTN_QUALITY_MAX; q++)
+      bench("DXT5_RGBA", q, encode_dxt5, &pixels[0]);
+
+   for (unsigned e = 0; e < ARRAY_SIZE(rgba8_encoders); e++) {
+      for (unsigned q = MESA_TEXCOMPRESS_QUALITY_FAST;
+           q <= MESA_TEXCOMPRESS_QUALITY_BEST; q++) {
+         bench(rgba8_encoders[e].name, q, rgba8_encoders[e].encode,
+               &pixels[0]);
+      }
+   }
+
+   for (unsigned q = MESA_TEXCOMPRESS_QUALITY_FAST;
+        q <= MESA_TEXCOMPRESS_QUALITY_BEST; q++)
+      bench("BPTC_RGB_UNSIGNED_FLOAT", q, encode_bptc_float, &floats[0]);
+   for (unsigned q = MESA_TEXCOMPRESS_QUALITY_FAST;
+        q <= MESA_TEXCOMPRESS_QUALITY_BEST; q++)
+      bench("ETC2_RG11_EAC", q, encode_eac_rg11, &rg16[0]);
+
+   return 0;
+}
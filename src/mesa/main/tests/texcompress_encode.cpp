@@ -0,0 +1,337 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \name texcompress_encode.cpp
+ *
+ * Round-trip a set of synthetic reference images through the BPTC and ETC2
+ * encoders at every quality level, and check the PSNR of the decoded images
+ * against a lower bound.  texcompress_bench.cpp measures the speed.
+ */
+
+#include <gtest/gtest.h>
+#include <math.h>
+#include <vector>
+
+#include "main/formats.h"
+#include "main/texcompress.h"
+#include "main/texcompress_bptc.h"
+#include "main/texcompress_etc.h"
+
+#define WIDTH 128
+#define HEIGHT 96
+
+enum image_kind {
+   IMAGE_GRADIENT,
+   IMAGE_WAVES,
+   IMAGE_EDGES,
+   NUM_IMAGES
+};
+
+static const char *image_names[NUM_IMAGES] = { "gradient", "waves", "edges" };
+
+static void
+make_image(enum image_kind kind, uint8_t *pixels)
+{
+   uint32_t seed = 1;
+
+   for (int y = 0; y < HEIGHT; y++) {
+      for (int x = 0; x < WIDTH; x++) {
+         uint8_t *p = pixels + (y * WIDTH + x) * 4;
+         const float fx = x / (float) WIDTH, fy = y / (float) HEIGHT;
+
+         seed = seed * 1103515245 + 12345;
+
+         switch (kind) {
+         case IMAGE_GRADIENT:
+            p[0] = 255 * fx;
+            p[1] = 255 * fy;
+            p[2] = 255 * (1 - fx) * fy;
+            p[3] = 255 - 128 * fx * fy;
+            break;
+         case IMAGE_WAVES: {
+            const float v = 0.5f + 0.25f * sinf(fx * 17 + sinf(fy * 5) * 3) +
+                            0.2f * sinf(fy * 23 + fx * 4);
+            const int n = (int) ((seed >> 16) % 9) - 4;
+
+            p[0] = fminf(fmaxf(v * 255 + n, 0), 255);
+            p[1] = fminf(fmaxf(v * 200 + 30 * sinf(fx * 9) + n, 0), 255);
+            p[2] = fminf(fmaxf((1 - v) * 180 + n, 0), 255);
+            p[3] = fminf(fmaxf(128 + 127 * sinf(fx * 7 + fy * 3), 0), 255);
+            break;
+         }
+         default:
+            p[0] = ((x / 5 + y / 7) & 1) ? 230 : 20;
+            p[1] = ((x / 11) & 1) ? 200 : 40;
+            p[2] = (x * x + y * y) % 97 < 40 ? 250 : 10;
+            p[3] = ((y / 3) & 1) ? 255 : 0;
+            break;
+         }
+      }
+   }
+}
+
+static double
+psnr(double squared_error, int count, double range)
+{
+   const double mse = squared_error / count;
+
+   return mse == 0.0 ? 99.0 : 10.0 * log10(range * range / mse);
+}
+
+/**
+ * Compress the RGBA8 image, decode it again and return the PSNR of the
+ * first \p comps channels.
+ */
+static double
+round_trip_rgba8(mesa_format format, unsigned quality, const uint8_t *pixels,
+                 int comps)
+{
+   const int block_bytes = _mesa_get_format_bytes(format);
+   const int row_stride = WIDTH / 4 * block_bytes;
+   std::vector<uint8_t> blocks(HEIGHT / 4 * row_stride);
+   const compressed_fetch_func fetch = _mesa_get_compressed_fetch_func(format);
+   double error = 0.0;
+
+   if (_mesa_get_format_layout(format) == MESA_FORMAT_LAYOUT_BPTC)
+      _mesa_bptc_compress_rgba_unorm(quality, WIDTH, HEIGHT, pixels, WIDTH * 4,
+                                     &blocks[0], row_stride);
+   else
+      _mesa_etc2_compress(format, quality, WIDTH, HEIGHT, pixels, WIDTH * 4,
+                          &blocks[0], row_stride);
+
+   for (int y = 0; y < HEIGHT; y++) {
+      for (int x = 0; x < WIDTH; x++) {
+         const uint8_t *p = pixels + (y * WIDTH + x) * 4;
+         float texel[4];
+
+         fetch(&blocks[0], WIDTH, x, y, texel);
+
+         /* The color of transparent punchthrough texels is undefined. */
+         if (format == MESA_FORMAT_ETC2_RGB8_PUNCHTHROUGH_ALPHA1 && p[3] < 128)
+            continue;
+
+         for (int c = 0; c < comps; c++) {
+            const double d = texel[c] * 255.0 - p[c];
+            error += d * d;
+         }
+      }
+   }
+
+   return psnr(error, WIDTH * HEIGHT * comps, 255.0);
+}
+
+struct rgba8_case {
+   mesa_format format;
+   int comps;
+   double min_psnr[NUM_IMAGES];
+};
+
+static void
+test_rgba8_format(const struct rgba8_case *test)
+{
+   std::vector<uint8_t> pixels(WIDTH * HEIGHT * 4);
+
+   for (int kind = 0; kind < NUM_IMAGES; kind++) {
+      double fast_psnr = 0.0;
+
+      make_image((enum image_kind) kind, &pixels[0]);
+
+      /* Punchthrough alpha is one bit. */
+      if (test->format == MESA_FORMAT_ETC2_RGB8_PUNCHTHROUGH_ALPHA1) {
+         for (int i = 0; i < WIDTH * HEIGHT; i++)
+            pixels[i * 4 + 3] = pixels[i * 4 + 3] < 128 ? 0 : 255;
+      }
+
+      for (unsigned q = MESA_TEXCOMPRESS_QUALITY_FAST;
+           q <= MESA_TEXCOMPRESS_QUALITY_BEST; q++) {
+         const double value =
+            round_trip_rgba8(test->format, q, &pixels[0], test->comps);
+
+         EXPECT_GE(value, test->min_psnr[kind])
+            << image_names[kind] << " quality " << q;
+         if (q == MESA_TEXCOMPRESS_QUALITY_FAST)
+            fast_psnr = value;
+         else
+            EXPECT_GE(value, fast_psnr - 0.05)
+               << image_names[kind] << " quality " << q;
+      }
+   }
+}
+
+TEST(TexcompressEncodeTest, BPTCUnorm)
+{
+   const struct rgba8_case test = {
+      MESA_FORMAT_BPTC_RGBA_UNORM, 4, { 44.0, 37.0, 10.0 }
+   };
+
+   test_rgba8_format(&test);
+}
+
+TEST(TexcompressEncodeTest, ETC2RGB8)
+{
+   const struct rgba8_case test = {
+      MESA_FORMAT_ETC2_RGB8, 3, { 39.0, 31.0, 12.0 }
+   };
+
+   test_rgba8_format(&test);
+}
+
+TEST(TexcompressEncodeTest, ETC2RGBA8)
+{
+   const struct rgba8_case test = {
+      MESA_FORMAT_ETC2_RGBA8_EAC, 4, { 40.0, 32.0, 13.0 }
+   };
+
+   test_rgba8_format(&test);
+}
+
+TEST(TexcompressEncodeTest, ETC2Punchthrough)
+{
+   const struct rgba8_case test = {
+      MESA_FORMAT_ETC2_RGB8_PUNCHTHROUGH_ALPHA1, 4, { 40.0, 34.0, 15.0 }
+   };
+
+   test_rgba8_format(&test);
+}
+
+TEST(TexcompressEncodeTest, BPTCFloat)
+{
+   std::vector<uint8_t> pixels(WIDTH * HEIGHT * 4);
+   std::vector<float> values(WIDTH * HEIGHT * 3);
+   std::vector<uint8_t> blocks(WIDTH * HEIGHT);
+
+   make_image(IMAGE_WAVES, &pixels[0]);
+
+   for (int is_signed = 0; is_signed < 2; is_signed++) {
+      const mesa_format format = is_signed ?
+                                 MESA_FORMAT_BPTC_RGB_SIGNED_FLOAT :
+                                 MESA_FORMAT_BPTC_RGB_UNSIGNED_FLOAT;
+      const compressed_fetch_func fetch =
+         _mesa_get_compressed_fetch_func(format);
+
+      for (int i = 0; i < WIDTH * HEIGHT; i++) {
+         for (int c = 0; c < 3; c++) {
+            const float v = pixels[i * 4 + c] / 255.0f;
+            values[i * 3 + c] = is_signed ? (v - 0.5f) * 8.0f : v * v * 16.0f;
+         }
+      }
+
+      for (unsigned q = MESA_TEXCOMPRESS_QUALITY_FAST;
+           q <= MESA_TEXCOMPRESS_QUALITY_BEST; q++) {
+         double error = 0.0, signal = 0.0;
+
+         _mesa_bptc_compress_rgb_float(q, is_signed, WIDTH, HEIGHT,
+                                       &values[0], WIDTH * 12,
+                                       &blocks[0], WIDTH * 4);
+
+         for (int y = 0; y < HEIGHT; y++) {
+            for (int x = 0; x < WIDTH; x++) {
+               float texel[4];
+
+               fetch(&blocks[0], WIDTH, x, y, texel);
+               for (int c = 0; c < 3; c++) {
+                  const double v = values[(y * WIDTH + x) * 3 + c];
+
+                  error += (texel[c] - v) * (texel[c] - v);
+                  signal += v * v;
+               }
+            }
+         }
+
+         /* The encoder minimizes the relative error, so use the SNR. */
+         const double snr = 10.0 * log10(signal / error);
+
+         EXPECT_GE(snr, 17.0)
+            << _mesa_get_format_name(format) << " quality " << q;
+      }
+   }
+}
+
+TEST(TexcompressEncodeTest, EAC)
+{
+   static const mesa_format formats[] = {
+      MESA_FORMAT_ETC2_R11_EAC,
+      MESA_FORMAT_ETC2_SIGNED_R11_EAC,
+      MESA_FORMAT_ETC2_RG11_EAC,
+      MESA_FORMAT_ETC2_SIGNED_RG11_EAC,
+   };
+   std::vector<uint8_t> pixels(WIDTH * HEIGHT * 4);
+   std::vector<int16_t> values(WIDTH * HEIGHT * 2);
+   std::vector<uint8_t> blocks(WIDTH * HEIGHT);
+
+   make_image(IMAGE_WAVES, &pixels[0]);
+
+   for (unsigned f = 0; f < ARRAY_SIZE(formats); f++) {
+      const mesa_format format = formats[f];
+      const bool is_signed = _mesa_get_format_datatype(format) ==
+                             GL_SIGNED_NORMALIZED;
+      const int comps = _mesa_format_num_components(format);
+      const compressed_fetch_func fetch =
+         _mesa_get_compressed_fetch_func(format);
+
+      /* Add some detail below 8 bits from the blue channel. */
+      for (int i = 0; i < WIDTH * HEIGHT; i++) {
+         for (int c = 0; c < comps; c++) {
+            const float v = (pixels[i * 4 + c] +
+                             pixels[i * 4 + 2] / 255.0f) / 256.0f;
+
+            if (is_signed)
+               values[i * comps + c] = (int16_t) ((v * 2.0f - 1.0f) * 32767);
+            else
+               ((uint16_t *) &values[0])[i * comps + c] = v * 65535;
+         }
+      }
+
+      for (unsigned q = MESA_TEXCOMPRESS_QUALITY_FAST;
+           q <= MESA_TEXCOMPRESS_QUALITY_BEST; q++) {
+         double error = 0.0;
+
+         _mesa_etc2_compress(format, q, WIDTH, HEIGHT, &values[0],
+                             WIDTH * 2 * comps, &blocks[0],
+                             WIDTH * 2 * comps);
+
+         for (int y = 0; y < HEIGHT; y++) {
+            for (int x = 0; x < WIDTH; x++) {
+               const int i = (y * WIDTH + x) * comps;
+               float texel[4];
+
+               fetch(&blocks[0], WIDTH, x, y, texel);
+               for (int c = 0; c < comps; c++) {
+                  const double v = is_signed ?
+                     values[i + c] / 32767.0 :
+                     ((uint16_t *) &values[0])[i + c] / 65535.0;
+
+                  error += (texel[c] - v) * (texel[c] - v);
+               }
+            }
+         }
+
+         const double value = psnr(error, WIDTH * HEIGHT * comps,
+                                   is_signed ? 2.0 : 1.0);
+
+         EXPECT_GE(value, 42.0)
+            << _mesa_get_format_name(format) << " quality " << q;
+      }
+   }
+}
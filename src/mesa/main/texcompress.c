@@ -34,6 +34,7 @@
 #include "imports.h"
 #include "context.h"
 #include "formats.h"
+#include "macros.h"
 #include "mtypes.h"
 #include "context.h"
 #include "texcompress.h"
@@ -42,6 +43,7 @@
 #include "texcompress_s3tc.h"
 #include "texcompress_etc.h"
 #include "texcompress_bptc.h"
+#include "texcompress_astc.h"
 
 
 /**
@@ -899,6 +901,8 @@ _mesa_get_compressed_fetch_func(mesa_format format)
       return _mesa_get_etc_fetch_func(format);
    case MESA_FORMAT_LAYOUT_BPTC:
       return _mesa_get_bptc_fetch_func(format);
+   case MESA_FORMAT_LAYOUT_ASTC:
+      return _mesa_get_astc_fetch_func(format);
    default:
       return NULL;
    }
@@ -929,7 +933,8 @@ _mesa_decompress_image(mesa_format format, GLuint width, GLuint height,
       return;
    }
  
-   stride = srcRowStride * bh / bytes;
+   /* The fetch functions take the row stride in texels. */
+   stride = srcRowStride * bw / bytes;
 
    for (j = 0; j < height; j++) {
       for (i = 0; i < width; i++) {
@@ -938,3 +943,22 @@ _mesa_decompress_image(mesa_format format, GLuint width, GLuint height,
       }
    }
 }
+
+
+/**
+ * Return the quality preset of the built-in encoders, which can be set with
+ * MESA_TEXCOMPRESS_QUALITY.
+ */
+unsigned
+_mesa_texcompress_quality(void)
+{
+   const char *env = getenv("MESA_TEXCOMPRESS_QUALITY");
+   unsigned quality;
+
+   if (env == NULL)
+      return MESA_TEXCOMPRESS_QUALITY_DEFAULT;
+
+   quality = strtoul(env, NULL, 10);
+   return MIN2(quality, MESA_TEXCOMPRESS_QUALITY_BEST);
+}
+
@@ -28,6 +28,10 @@
 #include "formats.h"
 #include "glheader.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct gl_context;
 
 extern GLenum
@@ -63,4 +67,19 @@ _mesa_decompress_image(mesa_format format, GLuint width, GLuint height,
                        const GLubyte *src, GLint srcRowStride,
                        GLfloat *dest);
 
+
+/**
+ * Quality presets of the built-in BPTC and ETC2 encoders.
+ */
+#define MESA_TEXCOMPRESS_QUALITY_FAST    0
+#define MESA_TEXCOMPRESS_QUALITY_DEFAULT 1
+#define MESA_TEXCOMPRESS_QUALITY_BEST    2
+
+extern unsigned
+_mesa_texcompress_quality(void);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* TEXCOMPRESS_H */
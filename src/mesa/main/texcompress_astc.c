@@ -0,0 +1,117 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file texcompress_astc.c
+ * GL_KHR_texture_compression_astc_ldr texel fetching.
+ *
+ * Only the 2D block footprints are supported.
+ */
+
+#include <stdbool.h>
+#include "texcompress.h"
+#include "texcompress_astc.h"
+#include "util/astc.h"
+#include "util/format_srgb.h"
+#include "macros.h"
+
+static void
+fetch_astc(const GLubyte *map, GLint rowStride, GLint i, GLint j,
+           GLfloat *texel, unsigned bw, unsigned bh, bool srgb)
+{
+   const GLubyte *block = map + (((rowStride + bw - 1) / bw) * (j / bh) +
+                                 (i / bw)) * UTIL_ASTC_BLOCK_SIZE;
+   GLubyte rgba[4];
+
+   util_format_astc_fetch_texel(rgba, block, bw, bh, srgb, i % bw, j % bh);
+
+   if (srgb) {
+      texel[RCOMP] = util_format_srgb_8unorm_to_linear_float(rgba[0]);
+      texel[GCOMP] = util_format_srgb_8unorm_to_linear_float(rgba[1]);
+      texel[BCOMP] = util_format_srgb_8unorm_to_linear_float(rgba[2]);
+   } else {
+      texel[RCOMP] = UBYTE_TO_FLOAT(rgba[0]);
+      texel[GCOMP] = UBYTE_TO_FLOAT(rgba[1]);
+      texel[BCOMP] = UBYTE_TO_FLOAT(rgba[2]);
+   }
+   texel[ACOMP] = UBYTE_TO_FLOAT(rgba[3]);
+}
+
+#define FETCH_ASTC(bw, bh)                                              \
+static void                                                             \
+fetch_rgba_astc_##bw##x##bh(const GLubyte *map, GLint rowStride,        \
+                            GLint i, GLint j, GLfloat *texel)           \
+{                                                                       \
+   fetch_astc(map, rowStride, i, j, texel, bw, bh, false);              \
+}                                                                       \
+                                                                        \
+static void                                                             \
+fetch_srgb8_alpha8_astc_##bw##x##bh(const GLubyte *map, GLint rowStride,\
+                                    GLint i, GLint j, GLfloat *texel)   \
+{                                                                       \
+   fetch_astc(map, rowStride, i, j, texel, bw, bh, true);               \
+}
+
+FETCH_ASTC(4, 4)
+FETCH_ASTC(5, 4)
+FETCH_ASTC(5, 5)
+FETCH_ASTC(6, 5)
+FETCH_ASTC(6, 6)
+FETCH_ASTC(8, 5)
+FETCH_ASTC(8, 6)
+FETCH_ASTC(8, 8)
+FETCH_ASTC(10, 5)
+FETCH_ASTC(10, 6)
+FETCH_ASTC(10, 8)
+FETCH_ASTC(10, 10)
+FETCH_ASTC(12, 10)
+FETCH_ASTC(12, 12)
+
+#define CASE_ASTC(bw, bh)                                \
+   case MESA_FORMAT_RGBA_ASTC_##bw##x##bh:               \
+      return fetch_rgba_astc_##bw##x##bh;                \
+   case MESA_FORMAT_SRGB8_ALPHA8_ASTC_##bw##x##bh:       \
+      return fetch_srgb8_alpha8_astc_##bw##x##bh
+
+compressed_fetch_func
+_mesa_get_astc_fetch_func(mesa_format format)
+{
+   switch (format) {
+   CASE_ASTC(4, 4);
+   CASE_ASTC(5, 4);
+   CASE_ASTC(5, 5);
+   CASE_ASTC(6, 5);
+   CASE_ASTC(6, 6);
+   CASE_ASTC(8, 5);
+   CASE_ASTC(8, 6);
+   CASE_ASTC(8, 8);
+   CASE_ASTC(10, 5);
+   CASE_ASTC(10, 6);
+   CASE_ASTC(10, 8);
+   CASE_ASTC(10, 10);
+   CASE_ASTC(12, 10);
+   CASE_ASTC(12, 12);
+   default:
+      return NULL;
+   }
+}
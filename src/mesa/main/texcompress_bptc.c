@@ -26,7 +26,16 @@
  * GL_ARB_texture_compression_bptc support.
  */
 
+#include <float.h>
+#include <limits.h>
+#include <math.h>
 #include <stdbool.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "context.h"
 #include "texcompress.h"
 #include "texcompress_bptc.h"
 #include "util/format_srgb.h"
@@ -499,18 +508,19 @@ count_anchors_before_texel(int n_subsets,
    return count;
 }
 
+static const uint8_t weights2[] = { 0, 21, 43, 64 };
+static const uint8_t weights3[] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static const uint8_t weights4[] =
+   { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+static const uint8_t *weights[] = {
+   NULL, NULL, weights2, weights3, weights4
+};
+
 static int32_t
 interpolate(int32_t a, int32_t b,
             int index,
             int index_bits)
 {
-   static const uint8_t weights2[] = { 0, 21, 43, 64 };
-   static const uint8_t weights3[] = { 0, 9, 18, 27, 37, 46, 55, 64 };
-   static const uint8_t weights4[] =
-      { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
-   static const uint8_t *weights[] = {
-      NULL, NULL, weights2, weights3, weights4
-   };
    int weight;
 
    weight = weights[index_bits][index];
@@ -984,272 +994,606 @@ write_bits(struct bit_writer *writer, int n_bits, int value)
    } while (n_bits > 0);
 }
 
+
+/*
+ * The encoder.
+ *
+ * BPTC_RGBA_UNORM blocks are encoded with mode 6, which has a single pair
+ * of RGBA endpoints and 4-bit indices, or with mode 5, which has separate
+ * color and alpha endpoints with 2-bit indices each and can swap alpha with
+ * one of the color channels.  The float formats use mode 3, a single pair of
+ * 10-bit endpoints with 4-bit indices.
+ *
+ * The endpoints start out as the extremes of the pixels along their
+ * principal axis and are then refined with least-squares fits to the
+ * indices they produced, as often as the quality preset asks for.  Finding
+ * the closest palette entry for every pixel is the bulk of the work and is
+ * done four pixels at a time with SSE2 where available.
+ */
+
+/** Pixels of a block, with those outside of the image replicated */
+typedef uint8_t bptc_unorm_pixels[BLOCK_SIZE * BLOCK_SIZE][4];
+
+struct bptc_unorm_encoding {
+   int mode;
+   int rotation;
+   /** Endpoints as stored in the block, without the p-bits */
+   int endpoints[2][4];
+   int pbits[2];
+   /** Color and alpha indices, or only the former for mode 6 */
+   uint8_t indices[2][BLOCK_SIZE * BLOCK_SIZE];
+   uint32_t error;
+};
+
+/**
+ * Clamp the endpoints to the range of the pixels in every channel.  Going
+ * beyond that never helps much, and for the float formats it can produce
+ * values far larger than any of the pixels.
+ */
 static void
-get_average_luminance_alpha_unorm(int width, int height,
-                                  const uint8_t *src, int src_rowstride,
-                                  int *average_luminance, int *average_alpha)
+clamp_endpoints(const float pixels[][4], int first, int count,
+                float endpoints[2][4])
 {
-   int luminance_sum = 0, alpha_sum = 0;
-   int y, x;
+   int i, c;
+
+   for (c = first; c < first + count; c++) {
+      float min = pixels[0][c], max = pixels[0][c];
 
-   for (y = 0; y < height; y++) {
-      for (x = 0; x < width; x++) {
-         luminance_sum += src[0] + src[1] + src[2];
-         alpha_sum += src[3];
-         src += 4;
+      for (i = 1; i < BLOCK_SIZE * BLOCK_SIZE; i++) {
+         min = MIN2(min, pixels[i][c]);
+         max = MAX2(max, pixels[i][c]);
       }
-      src += src_rowstride - width * 4;
-   }
 
-   *average_luminance = luminance_sum / (width * height);
-   *average_alpha = alpha_sum / (width * height);
+      for (i = 0; i < 2; i++)
+         endpoints[i][c] = CLAMP(endpoints[i][c], min, max);
+   }
 }
 
+/**
+ * Find the endpoints of the line through the channels \p first to
+ * \p first + \p count - 1 of the pixels which covers all of them.
+ */
 static void
-get_rgba_endpoints_unorm(int width, int height,
-                         const uint8_t *src, int src_rowstride,
-                         int average_luminance, int average_alpha,
-                         uint8_t endpoints[][4])
+fit_endpoints(const float pixels[][4], int first, int count,
+              float endpoints[2][4])
 {
-   int endpoint_luminances[2];
-   int midpoint;
-   int sums[2][4];
-   int endpoint;
-   int luminance;
-   uint8_t temp[3];
-   const uint8_t *p = src;
-   int rgb_left_endpoint_count = 0;
-   int alpha_left_endpoint_count = 0;
-   int y, x, i;
-
-   memset(sums, 0, sizeof sums);
-
-   for (y = 0; y < height; y++) {
-      for (x = 0; x < width; x++) {
-         luminance = p[0] + p[1] + p[2];
-         if (luminance < average_luminance) {
-            endpoint = 0;
-            rgb_left_endpoint_count++;
-         } else {
-            endpoint = 1;
-         }
-         for (i = 0; i < 3; i++)
-            sums[endpoint][i] += p[i];
-
-         if (p[2] < average_alpha) {
-            endpoint = 0;
-            alpha_left_endpoint_count++;
-         } else {
-            endpoint = 1;
-         }
-         sums[endpoint][3] += p[3];
+   const int n = BLOCK_SIZE * BLOCK_SIZE;
+   float mean[4] = { 0 }, axis[4] = { 0 }, cov[4][4] = { { 0 } };
+   float t, t_min = FLT_MAX, t_max = -FLT_MAX, len;
+   int i, c, d, iter;
+
+   /* The loops go over all four channels so that they can be unrolled, the
+    * others are masked out afterwards.
+    */
+   for (i = 0; i < n; i++) {
+      for (c = 0; c < 4; c++) {
+         mean[c] += pixels[i][c];
+         for (d = c; d < 4; d++)
+            cov[c][d] += pixels[i][c] * pixels[i][d];
+      }
+   }
+
+   for (c = 0; c < 4; c++)
+      mean[c] /= n;
 
-         p += 4;
+   for (c = 0; c < 4; c++) {
+      for (d = c; d < 4; d++) {
+         const bool used = c >= first && d < first + count;
+
+         cov[c][d] = cov[d][c] =
+            used ? cov[c][d] / n - mean[c] * mean[d] : 0.0f;
       }
+   }
 
-      p += src_rowstride - width * 4;
+   /* Power iteration, starting from the channel with the largest variance */
+   c = first;
+   for (d = first; d < first + count; d++) {
+      if (cov[d][d] > cov[c][c])
+         c = d;
    }
+   axis[c] = 1.0f;
 
-   if (rgb_left_endpoint_count == 0 ||
-       rgb_left_endpoint_count == width * height) {
-      for (i = 0; i < 3; i++)
-         endpoints[0][i] = endpoints[1][i] =
-            (sums[0][i] + sums[1][i]) / (width * height);
-   } else {
-      for (i = 0; i < 3; i++) {
-         endpoints[0][i] = sums[0][i] / rgb_left_endpoint_count;
-         endpoints[1][i] = (sums[1][i] /
-                            (width * height - rgb_left_endpoint_count));
+   for (iter = 0; iter < 8; iter++) {
+      float next[4] = { 0 };
+
+      len = 0.0f;
+      for (c = 0; c < 4; c++) {
+         for (d = 0; d < 4; d++)
+            next[c] += cov[c][d] * axis[d];
+         len = MAX2(len, fabsf(next[c]));
       }
+
+      if (len == 0.0f)
+         break;
+
+      for (c = 0; c < 4; c++)
+         axis[c] = next[c] / len;
    }
 
-   if (alpha_left_endpoint_count == 0 ||
-       alpha_left_endpoint_count == width * height) {
-      endpoints[0][3] = endpoints[1][3] =
-         (sums[0][3] + sums[1][3]) / (width * height);
-   } else {
-         endpoints[0][3] = sums[0][3] / alpha_left_endpoint_count;
-         endpoints[1][3] = (sums[1][3] /
-                            (width * height - alpha_left_endpoint_count));
+   for (i = 0; i < n; i++) {
+      t = 0.0f;
+      for (c = 0; c < 4; c++)
+         t += (pixels[i][c] - mean[c]) * axis[c];
+
+      t_min = MIN2(t_min, t);
+      t_max = MAX2(t_max, t);
    }
 
-   /* We may need to swap the endpoints to ensure the most-significant bit of
-    * the first index is zero */
+   len = 0.0f;
+   for (c = 0; c < 4; c++)
+      len += axis[c] * axis[c];
+
+   for (c = first; c < first + count; c++) {
+      endpoints[0][c] = mean[c] + t_min / len * axis[c];
+      endpoints[1][c] = mean[c] + t_max / len * axis[c];
+   }
+
+   clamp_endpoints(pixels, first, count, endpoints);
+}
+
+/**
+ * Replace the endpoints with the least-squares fit to the pixels for the
+ * given indices.
+ *
+ * \return false if the indices don't determine the endpoints
+ */
+static bool
+refine_endpoints(const float pixels[][4], int first, int count,
+                 const uint8_t *indices, int index_bits,
+                 float endpoints[2][4])
+{
+   float aa = 0.0f, ab = 0.0f, bb = 0.0f, det;
+   float ax[4] = { 0 }, bx[4] = { 0 };
+   int i, c;
+
+   for (i = 0; i < BLOCK_SIZE * BLOCK_SIZE; i++) {
+      const float b = weights[index_bits][indices[i]] / 64.0f;
+      const float a = 1.0f - b;
+
+      aa += a * a;
+      ab += a * b;
+      bb += b * b;
+
+      for (c = first; c < first + count; c++) {
+         ax[c] += a * pixels[i][c];
+         bx[c] += b * pixels[i][c];
+      }
+   }
 
-   for (endpoint = 0; endpoint < 2; endpoint++) {
-      endpoint_luminances[endpoint] =
-         endpoints[endpoint][0] +
-         endpoints[endpoint][1] +
-         endpoints[endpoint][2];
+   det = aa * bb - ab * ab;
+   if (fabsf(det) < 1e-6f)
+      return false;
+
+   for (c = first; c < first + count; c++) {
+      endpoints[0][c] = (ax[c] * bb - bx[c] * ab) / det;
+      endpoints[1][c] = (bx[c] * aa - ax[c] * ab) / det;
+   }
+
+   clamp_endpoints(pixels, first, count, endpoints);
+
+   return true;
+}
+
+/**
+ * Find the closest of the \p count palette entries for every pixel, only
+ * looking at the channels set in \p channels.  The palette entries must be
+ * zero in the other channels.
+ *
+ * Ties go to the lower index, in both implementations.
+ */
+#if defined(__SSE2__)
+
+static inline __m128i
+rgba_distance4(__m128i lo, __m128i hi, __m128i color)
+{
+   __m128i dl = _mm_sub_epi16(lo, color);
+   __m128i dh = _mm_sub_epi16(hi, color);
+
+   /* r*r + g*g and b*b + a*a for each pixel, then their sums in lanes 0
+    * and 2
+    */
+   dl = _mm_madd_epi16(dl, dl);
+   dh = _mm_madd_epi16(dh, dh);
+   dl = _mm_add_epi32(dl, _mm_srli_epi64(dl, 32));
+   dh = _mm_add_epi32(dh, _mm_srli_epi64(dh, 32));
+
+   return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(dl),
+                                          _mm_castsi128_ps(dh),
+                                          _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+static uint32_t
+match_unorm(const bptc_unorm_pixels pixels, const int palette[][4],
+            int count, uint32_t channels, uint8_t *indices)
+{
+   const __m128i mask = _mm_set1_epi32(channels);
+   const __m128i zero = _mm_setzero_si128();
+   __m128i colors[16], total = zero;
+   uint32_t error[4];
+   int g, k;
+
+   for (k = 0; k < count; k++) {
+      colors[k] = _mm_set_epi16(palette[k][3], palette[k][2],
+                                palette[k][1], palette[k][0],
+                                palette[k][3], palette[k][2],
+                                palette[k][1], palette[k][0]);
    }
-   midpoint = (endpoint_luminances[0] + endpoint_luminances[1]) / 2;
 
-   if ((src[0] + src[1] + src[2] <= midpoint) !=
-       (endpoint_luminances[0] <= midpoint)) {
-      memcpy(temp, endpoints[0], 3);
-      memcpy(endpoints[0], endpoints[1], 3);
-      memcpy(endpoints[1], temp, 3);
+   for (g = 0; g < 4; g++) {
+      const __m128i px =
+         _mm_and_si128(_mm_loadu_si128((const __m128i *) pixels[4 * g]), mask);
+      const __m128i lo = _mm_unpacklo_epi8(px, zero);
+      const __m128i hi = _mm_unpackhi_epi8(px, zero);
+      __m128i best = rgba_distance4(lo, hi, colors[0]);
+      __m128i best_index = zero;
+      uint32_t index[4];
+
+      for (k = 1; k < count; k++) {
+         const __m128i dist = rgba_distance4(lo, hi, colors[k]);
+         const __m128i closer = _mm_cmplt_epi32(dist, best);
+
+         best = _mm_or_si128(_mm_and_si128(closer, dist),
+                             _mm_andnot_si128(closer, best));
+         best_index = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(k)),
+                                   _mm_andnot_si128(closer, best_index));
+      }
+
+      total = _mm_add_epi32(total, best);
+      _mm_storeu_si128((__m128i *) index, best_index);
+      for (k = 0; k < 4; k++)
+         indices[4 * g + k] = index[k];
    }
 
-   /* Same for the alpha endpoints */
+   _mm_storeu_si128((__m128i *) error, total);
+   return error[0] + error[1] + error[2] + error[3];
+}
+
+#else
+
+static uint32_t
+match_unorm(const bptc_unorm_pixels pixels, const int palette[][4],
+            int count, uint32_t channels, uint8_t *indices)
+{
+   uint32_t total = 0;
+   int i, k, c;
+
+   for (i = 0; i < BLOCK_SIZE * BLOCK_SIZE; i++) {
+      uint32_t best = ~0u;
+
+      for (k = 0; k < count; k++) {
+         uint32_t dist = 0;
+
+         for (c = 0; c < 4; c++) {
+            const int px = (channels >> (8 * c)) & 0xff ? pixels[i][c] : 0;
+            const int d = px - palette[k][c];
 
-   midpoint = (endpoints[0][3] + endpoints[1][3]) / 2;
+            dist += d * d;
+         }
 
-   if ((src[3] <= midpoint) != (endpoints[0][3] <= midpoint)) {
-      temp[0] = endpoints[0][3];
-      endpoints[0][3] = endpoints[1][3];
-      endpoints[1][3] = temp[0];
+         if (dist < best) {
+            best = dist;
+            indices[i] = k;
+         }
+      }
+
+      total += best;
    }
+
+   return total;
 }
 
+#endif
+
+/**
+ * Quantize an endpoint to seven bits and a p-bit per channel.
+ */
 static void
-write_rgb_indices_unorm(struct bit_writer *writer,
-                        int src_width, int src_height,
-                        const uint8_t *src, int src_rowstride,
-                        uint8_t endpoints[][4])
+quantize_pbit_endpoint(const float value[4], int quantized[4], int *pbit)
 {
-   int luminance;
-   int endpoint_luminances[2];
-   int endpoint;
-   int index;
-   int y, x;
+   float best = FLT_MAX;
+   int p, c;
+
+   for (p = 0; p < 2; p++) {
+      float error = 0.0f;
+      int q[4];
+
+      for (c = 0; c < 4; c++) {
+         float d;
 
-   for (endpoint = 0; endpoint < 2; endpoint++) {
-      endpoint_luminances[endpoint] =
-         endpoints[endpoint][0] +
-         endpoints[endpoint][1] +
-         endpoints[endpoint][2];
+         q[c] = CLAMP((int) floorf((value[c] - p) / 2.0f + 0.5f), 0, 127);
+         d = ((q[c] << 1) | p) - value[c];
+         error += d * d;
+      }
+
+      if (error < best) {
+         best = error;
+         memcpy(quantized, q, sizeof(q));
+         *pbit = p;
+      }
    }
+}
 
-   /* If the endpoints have the same luminance then we'll just use index 0 for
-    * all of the texels */
-   if (endpoint_luminances[0] == endpoint_luminances[1]) {
-      write_bits(writer, BLOCK_SIZE * BLOCK_SIZE * 2 - 1, 0);
-      return;
+/**
+ * Quantize a color channel to \p bits bits.
+ */
+static int
+quantize_unorm(float value, int bits)
+{
+   const int max = (1 << bits) - 1;
+   int q = CLAMP((int) floorf(value * max / 255.0f + 0.5f), 0, max);
+   int best = q, i;
+
+   /* The expansion isn't exactly linear, check the neighbours */
+   for (i = MAX2(q - 1, 0); i <= MIN2(q + 1, max); i++) {
+      if (fabsf(expand_component(i, bits) - value) <
+          fabsf(expand_component(best, bits) - value))
+         best = i;
    }
 
-   for (y = 0; y < src_height; y++) {
-      for (x = 0; x < src_width; x++) {
-         luminance = src[0] + src[1] + src[2];
+   return best;
+}
+
+static void
+encode_unorm_mode6(const bptc_unorm_pixels pixels, int n_refinements,
+                   struct bptc_unorm_encoding *enc)
+{
+   float fpixels[BLOCK_SIZE * BLOCK_SIZE][4];
+   float endpoints[2][4];
+   int pass, i, c;
 
-         index = ((luminance - endpoint_luminances[0]) * 3 /
-                  (endpoint_luminances[1] - endpoint_luminances[0]));
-         if (index < 0)
-            index = 0;
-         else if (index > 3)
-            index = 3;
+   for (i = 0; i < BLOCK_SIZE * BLOCK_SIZE; i++)
+      for (c = 0; c < 4; c++)
+         fpixels[i][c] = pixels[i][c];
 
-         assert(x != 0 || y != 0 || index < 2);
+   fit_endpoints(fpixels, 0, 4, endpoints);
 
-         write_bits(writer, (x == 0 && y == 0) ? 1 : 2, index);
+   enc->error = ~0u;
 
-         src += 4;
+   for (pass = 0; pass <= n_refinements; pass++) {
+      struct bptc_unorm_encoding candidate;
+      int palette[16][4];
+
+      candidate.mode = 6;
+      candidate.rotation = 0;
+
+      for (i = 0; i < 2; i++)
+         quantize_pbit_endpoint(endpoints[i], candidate.endpoints[i],
+                                &candidate.pbits[i]);
+
+      for (i = 0; i < 16; i++) {
+         for (c = 0; c < 4; c++) {
+            palette[i][c] =
+               interpolate((candidate.endpoints[0][c] << 1) | candidate.pbits[0],
+                           (candidate.endpoints[1][c] << 1) | candidate.pbits[1],
+                           i, 4);
+         }
       }
 
-      /* Pad the indices out to the block size */
-      if (src_width < BLOCK_SIZE)
-         write_bits(writer, 2 * (BLOCK_SIZE - src_width), 0);
+      candidate.error = match_unorm(pixels, palette, 16, 0xffffffff,
+                              candidate.indices[0]);
 
-      src += src_rowstride - src_width * 4;
+      if (candidate.error >= enc->error)
+         break;
+      *enc = candidate;
+
+      if (candidate.error == 0 ||
+          !refine_endpoints(fpixels, 0, 4, candidate.indices[0], 4, endpoints))
+         break;
    }
 
-   /* Pad the indices out to the block size */
-   if (src_height < BLOCK_SIZE)
-      write_bits(writer, 2 * BLOCK_SIZE * (BLOCK_SIZE - src_height), 0);
+   /* The most-significant bit of the first index is implied to be zero */
+   if (enc->indices[0][0] & 8) {
+      for (c = 0; c < 4; c++) {
+         i = enc->endpoints[0][c];
+         enc->endpoints[0][c] = enc->endpoints[1][c];
+         enc->endpoints[1][c] = i;
+      }
+      i = enc->pbits[0];
+      enc->pbits[0] = enc->pbits[1];
+      enc->pbits[1] = i;
+
+      for (i = 0; i < BLOCK_SIZE * BLOCK_SIZE; i++)
+         enc->indices[0][i] = 15 - enc->indices[0][i];
+   }
 }
 
 static void
-write_alpha_indices_unorm(struct bit_writer *writer,
-                          int src_width, int src_height,
-                          const uint8_t *src, int src_rowstride,
-                          uint8_t endpoints[][4])
+encode_unorm_mode5(const bptc_unorm_pixels src_pixels, int rotation,
+                   int n_refinements, struct bptc_unorm_encoding *enc)
 {
-   int index;
-   int y, x;
+   bptc_unorm_pixels pixels;
+   float fpixels[BLOCK_SIZE * BLOCK_SIZE][4];
+   float endpoints[2][4];
+   int pass, i, c, k;
 
-   /* If the endpoints have the same alpha then we'll just use index 0 for
-    * all of the texels */
-   if (endpoints[0][3] == endpoints[1][3]) {
-      write_bits(writer, BLOCK_SIZE * BLOCK_SIZE * 3 - 1, 0);
-      return;
+   /* The decoder swaps alpha with a color channel after decoding, so do
+    * the same before encoding.
+    */
+   memcpy(pixels, src_pixels, sizeof(pixels));
+   if (rotation > 0) {
+      for (i = 0; i < BLOCK_SIZE * BLOCK_SIZE; i++) {
+         pixels[i][rotation - 1] = src_pixels[i][3];
+         pixels[i][3] = src_pixels[i][rotation - 1];
+      }
    }
 
-   for (y = 0; y < src_height; y++) {
-      for (x = 0; x < src_width; x++) {
-         index = (((int) src[3] - (int) endpoints[0][3]) * 7 /
-                  ((int) endpoints[1][3] - endpoints[0][3]));
-         if (index < 0)
-            index = 0;
-         else if (index > 7)
-            index = 7;
+   for (i = 0; i < BLOCK_SIZE * BLOCK_SIZE; i++)
+      for (c = 0; c < 4; c++)
+         fpixels[i][c] = pixels[i][c];
+
+   fit_endpoints(fpixels, 0, 3, endpoints);
+   fit_endpoints(fpixels, 3, 1, endpoints);
 
-         assert(x != 0 || y != 0 || index < 4);
+   enc->error = ~0u;
 
-         /* The first index has one less bit */
-         write_bits(writer, (x == 0 && y == 0) ? 2 : 3, index);
+   for (pass = 0; pass <= n_refinements; pass++) {
+      struct bptc_unorm_encoding candidate;
+      int color_palette[4][4], alpha_palette[4][4];
+      bool color_refined, alpha_refined;
 
-         src += 4;
+      candidate.mode = 5;
+      candidate.rotation = rotation;
+      candidate.pbits[0] = candidate.pbits[1] = 0;
+
+      for (i = 0; i < 2; i++) {
+         for (c = 0; c < 3; c++)
+            candidate.endpoints[i][c] = quantize_unorm(endpoints[i][c], 7);
+         candidate.endpoints[i][3] =
+            CLAMP((int) floorf(endpoints[i][3] + 0.5f), 0, 255);
       }
 
-      /* Pad the indices out to the block size */
-      if (src_width < BLOCK_SIZE)
-         write_bits(writer, 3 * (BLOCK_SIZE - src_width), 0);
+      for (k = 0; k < 4; k++) {
+         for (c = 0; c < 3; c++) {
+            color_palette[k][c] =
+               interpolate(expand_component(candidate.endpoints[0][c], 7),
+                           expand_component(candidate.endpoints[1][c], 7),
+                           k, 2);
+            alpha_palette[k][c] = 0;
+         }
+         color_palette[k][3] = 0;
+         alpha_palette[k][3] = interpolate(candidate.endpoints[0][3],
+                                           candidate.endpoints[1][3], k, 2);
+      }
 
-      src += src_rowstride - src_width * 4;
+      candidate.error = match_unorm(pixels, color_palette, 4, 0x00ffffff,
+                              candidate.indices[0]);
+      candidate.error += match_unorm(pixels, alpha_palette, 4, 0xff000000,
+                               candidate.indices[1]);
+
+      if (candidate.error >= enc->error)
+         break;
+      *enc = candidate;
+
+      if (candidate.error == 0)
+         break;
+
+      /* A failed fit leaves the endpoints of that part as they were */
+      color_refined = refine_endpoints(fpixels, 0, 3, candidate.indices[0], 2,
+                                       endpoints);
+      alpha_refined = refine_endpoints(fpixels, 3, 1, candidate.indices[1], 2,
+                                       endpoints);
+      if (!color_refined && !alpha_refined)
+         break;
    }
 
-   /* Pad the indices out to the block size */
-   if (src_height < BLOCK_SIZE)
-      write_bits(writer, 3 * BLOCK_SIZE * (BLOCK_SIZE - src_height), 0);
+   /* The most-significant bits of the first indices are implied to be
+    * zero
+    */
+   if (enc->indices[0][0] & 2) {
+      for (c = 0; c < 3; c++) {
+         i = enc->endpoints[0][c];
+         enc->endpoints[0][c] = enc->endpoints[1][c];
+         enc->endpoints[1][c] = i;
+      }
+      for (i = 0; i < BLOCK_SIZE * BLOCK_SIZE; i++)
+         enc->indices[0][i] = 3 - enc->indices[0][i];
+   }
+
+   if (enc->indices[1][0] & 2) {
+      i = enc->endpoints[0][3];
+      enc->endpoints[0][3] = enc->endpoints[1][3];
+      enc->endpoints[1][3] = i;
+      for (i = 0; i < BLOCK_SIZE * BLOCK_SIZE; i++)
+         enc->indices[1][i] = 3 - enc->indices[1][i];
+   }
 }
 
 static void
-compress_rgba_unorm_block(int src_width, int src_height,
-                          const uint8_t *src, int src_rowstride,
-                          uint8_t *dst)
+write_indices(struct bit_writer *writer, const uint8_t *indices,
+              int index_bits)
+{
+   int i;
+
+   /* The first index has one less bit */
+   write_bits(writer, index_bits - 1, indices[0]);
+   for (i = 1; i < BLOCK_SIZE * BLOCK_SIZE; i++)
+      write_bits(writer, index_bits, indices[i]);
+}
+
+static void
+write_unorm_block(const struct bptc_unorm_encoding *enc, uint8_t *dst)
 {
-   int average_luminance, average_alpha;
-   uint8_t endpoints[2][4];
    struct bit_writer writer;
    int component, endpoint;
 
-   get_average_luminance_alpha_unorm(src_width, src_height, src, src_rowstride,
-                                     &average_luminance, &average_alpha);
-   get_rgba_endpoints_unorm(src_width, src_height, src, src_rowstride,
-                            average_luminance, average_alpha,
-                            endpoints);
-
    writer.dst = dst;
    writer.pos = 0;
    writer.buf = 0;
 
-   write_bits(&writer, 5, 0x10); /* mode 4 */
-   write_bits(&writer, 2, 0); /* rotation 0 */
-   write_bits(&writer, 1, 0); /* index selection bit */
+   if (enc->mode == 6) {
+      write_bits(&writer, 7, 0x40); /* mode 6 */
+
+      for (component = 0; component < 4; component++)
+         for (endpoint = 0; endpoint < 2; endpoint++)
+            write_bits(&writer, 7, enc->endpoints[endpoint][component]);
 
-   /* Write the color endpoints */
-   for (component = 0; component < 3; component++)
       for (endpoint = 0; endpoint < 2; endpoint++)
-         write_bits(&writer, 5, endpoints[endpoint][component] >> 3);
+         write_bits(&writer, 1, enc->pbits[endpoint]);
 
-   /* Write the alpha endpoints */
-   for (endpoint = 0; endpoint < 2; endpoint++)
-      write_bits(&writer, 6, endpoints[endpoint][3] >> 2);
-
-   write_rgb_indices_unorm(&writer,
-                           src_width, src_height,
-                           src, src_rowstride,
-                           endpoints);
-   write_alpha_indices_unorm(&writer,
-                             src_width, src_height,
-                             src, src_rowstride,
-                             endpoints);
+      write_indices(&writer, enc->indices[0], 4);
+   } else {
+      write_bits(&writer, 6, 0x20); /* mode 5 */
+      write_bits(&writer, 2, enc->rotation);
+
+      for (component = 0; component < 3; component++)
+         for (endpoint = 0; endpoint < 2; endpoint++)
+            write_bits(&writer, 7, enc->endpoints[endpoint][component]);
+
+      for (endpoint = 0; endpoint < 2; endpoint++)
+         write_bits(&writer, 8, enc->endpoints[endpoint][3]);
+
+      write_indices(&writer, enc->indices[0], 2);
+      write_indices(&writer, enc->indices[1], 2);
+   }
 }
 
 static void
-compress_rgba_unorm(int width, int height,
-                    const uint8_t *src, int src_rowstride,
-                    uint8_t *dst, int dst_rowstride)
+compress_rgba_unorm_block(unsigned quality,
+                          int src_width, int src_height,
+                          const uint8_t *src, int src_rowstride,
+                          uint8_t *dst)
+{
+   const int n_refinements = quality == MESA_TEXCOMPRESS_QUALITY_BEST ? 3 :
+                             quality == MESA_TEXCOMPRESS_QUALITY_DEFAULT;
+   struct bptc_unorm_encoding best, candidate;
+   bptc_unorm_pixels pixels;
+   int x, y, rotation;
+
+   for (y = 0; y < BLOCK_SIZE; y++) {
+      for (x = 0; x < BLOCK_SIZE; x++) {
+         memcpy(pixels[y * BLOCK_SIZE + x],
+                src + MIN2(y, src_height - 1) * src_rowstride +
+                MIN2(x, src_width - 1) * 4, 4);
+      }
+   }
+
+   encode_unorm_mode6(pixels, n_refinements, &best);
+
+   /* Mode 5 does better when alpha, or one of the color channels, doesn't
+    * vary along with the others.
+    */
+   if (quality > MESA_TEXCOMPRESS_QUALITY_FAST && best.error > 0) {
+      for (rotation = 0; rotation < 4; rotation++) {
+         encode_unorm_mode5(pixels, rotation, n_refinements, &candidate);
+         if (candidate.error < best.error)
+            best = candidate;
+
+         if (quality < MESA_TEXCOMPRESS_QUALITY_BEST)
+            break;
+      }
+   }
+
+   write_unorm_block(&best, dst);
+}
+
+/**
+ * Compress an image of RGBA8 pixels to BPTC_RGBA_UNORM blocks.
+ */
+void
+_mesa_bptc_compress_rgba_unorm(unsigned quality,
+                               int width, int height,
+                               const uint8_t *src, int src_rowstride,
+                               uint8_t *dst, int dst_rowstride)
 {
    int dst_row_diff;
    int y, x;
@@ -1261,7 +1605,8 @@ compress_rgba_unorm(int width, int height,
 
    for (y = 0; y < height; y += BLOCK_SIZE) {
       for (x = 0; x < width; x += BLOCK_SIZE) {
-         compress_rgba_unorm_block(MIN2(width - x, BLOCK_SIZE),
+         compress_rgba_unorm_block(quality,
+                                   MIN2(width - x, BLOCK_SIZE),
                                    MIN2(height - y, BLOCK_SIZE),
                                    src + x * 4 + y * src_rowstride,
                                    src_rowstride,
@@ -1272,11 +1617,35 @@ compress_rgba_unorm(int width, int height,
    }
 }
 
+struct bptc_unorm_image {
+   unsigned quality;
+   int width;
+   const GLubyte *pixels;
+   int rowstride;
+   GLubyte *dst;
+   GLint dstRowStride;
+};
+
+static void
+compress_rgba_unorm_rows(void *data, unsigned img, unsigned y,
+                         unsigned height)
+{
+   const struct bptc_unorm_image *image = data;
+
+   _mesa_bptc_compress_rgba_unorm(image->quality, image->width, height,
+                                  image->pixels + y * image->rowstride,
+                                  image->rowstride,
+                                  image->dst +
+                                  y / BLOCK_SIZE * image->dstRowStride,
+                                  image->dstRowStride);
+}
+
 GLboolean
 _mesa_texstore_bptc_rgba_unorm(TEXSTORE_PARAMS)
 {
    const GLubyte *pixels;
    const GLubyte *tempImage = NULL;
+   struct bptc_unorm_image image;
    int rowstride;
 
    if (srcFormat != GL_RGBA ||
@@ -1308,230 +1677,267 @@ _mesa_texstore_bptc_rgba_unorm(TEXSTORE_PARAMS)
                                          srcFormat, srcType);
    }
 
-   compress_rgba_unorm(srcWidth, srcHeight,
-                       pixels, rowstride,
-                       dstSlices[0], dstRowStride);
+   image.quality = _mesa_texcompress_quality();
+   image.width = srcWidth;
+   image.pixels = pixels;
+   image.rowstride = rowstride;
+   image.dst = dstSlices[0];
+   image.dstRowStride = dstRowStride;
+
+   _mesa_parallel_image_rows(ctx, srcWidth, srcHeight, 1,
+                             compress_rgba_unorm_rows, &image);
 
    free((void *) tempImage);
 
    return GL_TRUE;
 }
 
-static float
-get_average_luminance_float(int width, int height,
-                            const float *src, int src_rowstride)
+/*
+ * The float formats are encoded in the domain of the values that the
+ * decoder interpolates, in which the distance between two values is about
+ * that between their half-float bit patterns, so the error is relative to
+ * the magnitude of the values.
+ */
+
+/** Convert a float to the half-float bit pattern, as a signed integer */
+static int
+float_to_signed_half(float value, bool is_signed)
 {
-   float luminance_sum = 0;
-   int y, x;
+   uint16_t half;
 
-   for (y = 0; y < height; y++) {
-      for (x = 0; x < width; x++) {
-         luminance_sum += src[0] + src[1] + src[2];
-         src += 3;
-      }
-      src += (src_rowstride - width * 3 * sizeof (float)) / sizeof (float);
-   }
+   if (!is_signed && !(value > 0.0f))
+      return 0;
+
+   half = _mesa_float_to_half(CLAMP(value, -65504.0f, 65504.0f));
 
-   return luminance_sum / (width * height);
+   return half & 0x8000 ? -(half & 0x7fff) : half;
 }
 
+/** The value before the last step of the decoder yielding \p half */
 static float
-clamp_value(float value, bool is_signed)
+half_to_unquantized(int half, bool is_signed)
 {
-   if (value > 65504.0f)
-      return 65504.0f;
-
-   if (is_signed) {
-      if (value < -65504.0f)
-         return -65504.0f;
-      else
-         return value;
-   }
+   return is_signed ? half * 32.0f / 31.0f : half * 64.0f / 31.0f;
+}
 
-   if (value < 0.0f)
-      return 0.0f;
+/** finish_{un,}signed_unquantize(), with the result as a signed integer */
+static int
+unquantized_to_half(int32_t value, bool is_signed)
+{
+   if (!is_signed)
+      return finish_unsigned_unquantize(value);
 
-   return value;
+   return value < 0 ? -(-value * 31 / 32) : value * 31 / 32;
 }
 
-static void
-get_endpoints_float(int width, int height,
-                    const float *src, int src_rowstride,
-                    float average_luminance, float endpoints[][3],
-                    bool is_signed)
+/**
+ * Quantize an interpolation value to 10 bits, as the encoding would store
+ * it, and return the value the decoder unquantizes that to.
+ */
+static int
+quantize_float_endpoint(float value, bool is_signed, int *unquantized)
 {
-   float endpoint_luminances[2];
-   float midpoint;
-   float sums[2][3];
-   int endpoint, component;
-   float luminance;
-   float temp[3];
-   const float *p = src;
-   int left_endpoint_count = 0;
-   int y, x, i;
-
-   memset(sums, 0, sizeof sums);
-
-   for (y = 0; y < height; y++) {
-      for (x = 0; x < width; x++) {
-         luminance = p[0] + p[1] + p[2];
-         if (luminance < average_luminance) {
-            endpoint = 0;
-            left_endpoint_count++;
-         } else {
-            endpoint = 1;
-         }
-         for (i = 0; i < 3; i++)
-            sums[endpoint][i] += p[i];
+   int q, i, best = 0, best_error = INT_MAX;
 
-         p += 3;
-      }
+   if (is_signed) {
+      q = CLAMP((int) floorf(value / 64.0f + 0.5f), -511, 511);
 
-      p += (src_rowstride - width * 3 * sizeof (float)) / sizeof (float);
-   }
+      for (i = MAX2(q - 1, -511); i <= MIN2(q + 1, 511); i++) {
+         const int u = signed_unquantize(i, 10);
+         const int error = abs(u - (int) value);
 
-   if (left_endpoint_count == 0 ||
-       left_endpoint_count == width * height) {
-      for (i = 0; i < 3; i++)
-         endpoints[0][i] = endpoints[1][i] =
-            (sums[0][i] + sums[1][i]) / (width * height);
-   } else {
-      for (i = 0; i < 3; i++) {
-         endpoints[0][i] = sums[0][i] / left_endpoint_count;
-         endpoints[1][i] = sums[1][i] / (width * height - left_endpoint_count);
+         if (error < best_error) {
+            best_error = error;
+            best = i;
+            *unquantized = u;
+         }
       }
-   }
 
-   /* Clamp the endpoints to the range of a half float and strip out
-    * infinities */
-   for (endpoint = 0; endpoint < 2; endpoint++) {
-      for (component = 0; component < 3; component++) {
-         endpoints[endpoint][component] =
-            clamp_value(endpoints[endpoint][component], is_signed);
-      }
-   }
+      return best & 0x3ff;
+   } else {
+      q = CLAMP((int) floorf(value / 64.0f + 0.5f), 0, 1023);
 
-   /* We may need to swap the endpoints to ensure the most-significant bit of
-    * the first index is zero */
+      for (i = MAX2(q - 1, 0); i <= MIN2(q + 1, 1023); i++) {
+         const int u = unsigned_unquantize(i, 10);
+         const int error = abs(u - (int) value);
 
-   for (endpoint = 0; endpoint < 2; endpoint++) {
-      endpoint_luminances[endpoint] =
-         endpoints[endpoint][0] +
-         endpoints[endpoint][1] +
-         endpoints[endpoint][2];
-   }
-   midpoint = (endpoint_luminances[0] + endpoint_luminances[1]) / 2.0f;
+         if (error < best_error) {
+            best_error = error;
+            best = i;
+            *unquantized = u;
+         }
+      }
 
-   if ((src[0] + src[1] + src[2] <= midpoint) !=
-       (endpoint_luminances[0] <= midpoint)) {
-      memcpy(temp, endpoints[0], sizeof temp);
-      memcpy(endpoints[0], endpoints[1], sizeof temp);
-      memcpy(endpoints[1], temp, sizeof temp);
+      return best;
    }
 }
 
-static void
-write_rgb_indices_float(struct bit_writer *writer,
-                        int src_width, int src_height,
-                        const float *src, int src_rowstride,
-                        float endpoints[][3])
+/**
+ * Find the closest of the 16 palette entries for every pixel, given as
+ * signed half-float bit patterns in one array per channel.
+ */
+#if defined(__SSE2__)
+
+static float
+match_float(const float halves[3][BLOCK_SIZE * BLOCK_SIZE],
+            const float palette[16][3], uint8_t *indices)
 {
-   float luminance;
-   float endpoint_luminances[2];
-   int endpoint;
-   int index;
-   int y, x;
+   __m128 total = _mm_setzero_ps();
+   float error[4];
+   int g, k;
+
+   for (g = 0; g < 4; g++) {
+      const __m128 r = _mm_loadu_ps(&halves[0][4 * g]);
+      const __m128 gr = _mm_loadu_ps(&halves[1][4 * g]);
+      const __m128 b = _mm_loadu_ps(&halves[2][4 * g]);
+      __m128 best = _mm_set1_ps(FLT_MAX);
+      __m128i best_index = _mm_setzero_si128();
+      uint32_t index[4];
+
+      for (k = 0; k < 16; k++) {
+         const __m128 dr = _mm_sub_ps(r, _mm_set1_ps(palette[k][0]));
+         const __m128 dg = _mm_sub_ps(gr, _mm_set1_ps(palette[k][1]));
+         const __m128 db = _mm_sub_ps(b, _mm_set1_ps(palette[k][2]));
+         const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr),
+                                                   _mm_mul_ps(dg, dg)),
+                                        _mm_mul_ps(db, db));
+         const __m128 closer = _mm_cmplt_ps(dist, best);
+
+         best = _mm_min_ps(dist, best);
+         best_index =
+            _mm_or_si128(_mm_and_si128(_mm_castps_si128(closer),
+                                       _mm_set1_epi32(k)),
+                         _mm_andnot_si128(_mm_castps_si128(closer),
+                                          best_index));
+      }
 
-   for (endpoint = 0; endpoint < 2; endpoint++) {
-      endpoint_luminances[endpoint] =
-         endpoints[endpoint][0] +
-         endpoints[endpoint][1] +
-         endpoints[endpoint][2];
+      total = _mm_add_ps(total, best);
+      _mm_storeu_si128((__m128i *) index, best_index);
+      for (k = 0; k < 4; k++)
+         indices[4 * g + k] = index[k];
    }
 
-   /* If the endpoints have the same luminance then we'll just use index 0 for
-    * all of the texels */
-   if (endpoint_luminances[0] == endpoint_luminances[1]) {
-      write_bits(writer, BLOCK_SIZE * BLOCK_SIZE * 4 - 1, 0);
-      return;
-   }
+   _mm_storeu_ps(error, total);
+   return error[0] + error[1] + error[2] + error[3];
+}
 
-   for (y = 0; y < src_height; y++) {
-      for (x = 0; x < src_width; x++) {
-         luminance = src[0] + src[1] + src[2];
+#else
 
-         index = ((luminance - endpoint_luminances[0]) * 15 /
-                  (endpoint_luminances[1] - endpoint_luminances[0]));
-         if (index < 0)
-            index = 0;
-         else if (index > 15)
-            index = 15;
+static float
+match_float(const float halves[3][BLOCK_SIZE * BLOCK_SIZE],
+            const float palette[16][3], uint8_t *indices)
+{
+   float total = 0.0f;
+   int i, k, c;
 
-         assert(x != 0 || y != 0 || index < 8);
+   for (i = 0; i < BLOCK_SIZE * BLOCK_SIZE; i++) {
+      float best = FLT_MAX;
 
-         write_bits(writer, (x == 0 && y == 0) ? 3 : 4, index);
+      for (k = 0; k < 16; k++) {
+         float dist = 0.0f;
 
-         src += 3;
-      }
+         for (c = 0; c < 3; c++) {
+            const float d = halves[c][i] - palette[k][c];
+            dist += d * d;
+         }
 
-      /* Pad the indices out to the block size */
-      if (src_width < BLOCK_SIZE)
-         write_bits(writer, 4 * (BLOCK_SIZE - src_width), 0);
+         if (dist < best) {
+            best = dist;
+            indices[i] = k;
+         }
+      }
 
-      src += (src_rowstride - src_width * 3 * sizeof (float)) / sizeof (float);
+      total += best;
    }
 
-   /* Pad the indices out to the block size */
-   if (src_height < BLOCK_SIZE)
-      write_bits(writer, 4 * BLOCK_SIZE * (BLOCK_SIZE - src_height), 0);
+   return total;
 }
 
-static int
-get_endpoint_value(float value, bool is_signed)
+#endif
+
+static void
+compress_rgb_float_block(unsigned quality,
+                         int src_width, int src_height,
+                         const float *src, int src_rowstride,
+                         uint8_t *dst,
+                         bool is_signed)
 {
-   bool sign = false;
-   int half;
+   const int n_refinements = quality == MESA_TEXCOMPRESS_QUALITY_BEST ? 3 :
+                             quality == MESA_TEXCOMPRESS_QUALITY_DEFAULT;
+   float halves[3][BLOCK_SIZE * BLOCK_SIZE];
+   float values[BLOCK_SIZE * BLOCK_SIZE][4];
+   float endpoints[2][4];
+   float best_error = FLT_MAX;
+   int best_endpoints[2][3];
+   uint8_t best_indices[BLOCK_SIZE * BLOCK_SIZE];
+   struct bit_writer writer;
+   int pass, x, y, i, c, endpoint;
+
+   for (y = 0; y < BLOCK_SIZE; y++) {
+      for (x = 0; x < BLOCK_SIZE; x++) {
+         const float *p = src +
+            (MIN2(y, src_height - 1) * src_rowstride) / sizeof(float) +
+            MIN2(x, src_width - 1) * 3;
+
+         i = y * BLOCK_SIZE + x;
+         for (c = 0; c < 3; c++) {
+            halves[c][i] = float_to_signed_half(p[c], is_signed);
+            values[i][c] = half_to_unquantized(halves[c][i], is_signed);
+         }
+         values[i][3] = 0.0f;
+      }
+   }
 
-   if (is_signed) {
-      half = _mesa_float_to_half(value);
+   fit_endpoints(values, 0, 3, endpoints);
+
+   for (pass = 0; pass <= n_refinements; pass++) {
+      int quantized[2][3], unquantized[2][3];
+      float palette[16][3], error;
+      uint8_t indices[BLOCK_SIZE * BLOCK_SIZE];
 
-      if (half & 0x8000) {
-         half &= 0x7fff;
-         sign = true;
+      for (endpoint = 0; endpoint < 2; endpoint++) {
+         for (c = 0; c < 3; c++) {
+            quantized[endpoint][c] =
+               quantize_float_endpoint(endpoints[endpoint][c], is_signed,
+                                       &unquantized[endpoint][c]);
+         }
       }
 
-      half = (32 * half / 31) >> 6;
+      for (i = 0; i < 16; i++) {
+         for (c = 0; c < 3; c++) {
+            palette[i][c] =
+               unquantized_to_half(interpolate(unquantized[0][c],
+                                             unquantized[1][c], i, 4),
+                                 is_signed);
+         }
+      }
 
-      if (sign)
-         half = -half & ((1 << 10) - 1);
+      error = match_float((const float (*)[BLOCK_SIZE * BLOCK_SIZE]) halves,
+                          (const float (*)[3]) palette, indices);
 
-      return half;
-   } else {
-      if (value <= 0.0f)
-         return 0;
+      if (error >= best_error)
+         break;
 
-      half = _mesa_float_to_half(value);
+      best_error = error;
+      memcpy(best_endpoints, quantized, sizeof(best_endpoints));
+      memcpy(best_indices, indices, sizeof(best_indices));
 
-      return (64 * half / 31) >> 6;
+      if (error == 0.0f ||
+          !refine_endpoints((const float (*)[4]) values, 0, 3, indices, 4,
+                            endpoints))
+         break;
    }
-}
-
-static void
-compress_rgb_float_block(int src_width, int src_height,
-                         const float *src, int src_rowstride,
-                         uint8_t *dst,
-                         bool is_signed)
-{
-   float average_luminance;
-   float endpoints[2][3];
-   struct bit_writer writer;
-   int component, endpoint;
-   int endpoint_value;
 
-   average_luminance =
-      get_average_luminance_float(src_width, src_height, src, src_rowstride);
-   get_endpoints_float(src_width, src_height, src, src_rowstride,
-                       average_luminance, endpoints, is_signed);
+   /* The most-significant bit of the first index is implied to be zero */
+   if (best_indices[0] & 8) {
+      for (c = 0; c < 3; c++) {
+         i = best_endpoints[0][c];
+         best_endpoints[0][c] = best_endpoints[1][c];
+         best_endpoints[1][c] = i;
+      }
+      for (i = 0; i < BLOCK_SIZE * BLOCK_SIZE; i++)
+         best_indices[i] = 15 - best_indices[i];
+   }
 
    writer.dst = dst;
    writer.pos = 0;
@@ -1540,25 +1946,22 @@ compress_rgb_float_block(int src_width, int src_height,
    write_bits(&writer, 5, 3); /* mode 3 */
 
    /* Write the endpoints */
-   for (endpoint = 0; endpoint < 2; endpoint++) {
-      for (component = 0; component < 3; component++) {
-         endpoint_value =
-            get_endpoint_value(endpoints[endpoint][component], is_signed);
-         write_bits(&writer, 10, endpoint_value);
-      }
-   }
+   for (endpoint = 0; endpoint < 2; endpoint++)
+      for (c = 0; c < 3; c++)
+         write_bits(&writer, 10, best_endpoints[endpoint][c]);
 
-   write_rgb_indices_float(&writer,
-                           src_width, src_height,
-                           src, src_rowstride,
-                           endpoints);
+   write_indices(&writer, best_indices, 4);
 }
 
-static void
-compress_rgb_float(int width, int height,
-                   const float *src, int src_rowstride,
-                   uint8_t *dst, int dst_rowstride,
-                   bool is_signed)
+/**
+ * Compress an image of RGB float pixels to BPTC_RGB_{UN,}SIGNED_FLOAT
+ * blocks.
+ */
+void
+_mesa_bptc_compress_rgb_float(unsigned quality, bool is_signed,
+                              int width, int height,
+                              const float *src, int src_rowstride,
+                              uint8_t *dst, int dst_rowstride)
 {
    int dst_row_diff;
    int y, x;
@@ -1570,7 +1973,8 @@ compress_rgb_float(int width, int height,
 
    for (y = 0; y < height; y += BLOCK_SIZE) {
       for (x = 0; x < width; x += BLOCK_SIZE) {
-         compress_rgb_float_block(MIN2(width - x, BLOCK_SIZE),
+         compress_rgb_float_block(quality,
+                                  MIN2(width - x, BLOCK_SIZE),
                                   MIN2(height - y, BLOCK_SIZE),
                                   src + x * 3 +
                                   y * src_rowstride / sizeof (float),
@@ -1583,12 +1987,39 @@ compress_rgb_float(int width, int height,
    }
 }
 
+struct bptc_float_image {
+   unsigned quality;
+   bool is_signed;
+   int width;
+   const float *pixels;
+   int rowstride;
+   GLubyte *dst;
+   GLint dstRowStride;
+};
+
+static void
+compress_rgb_float_rows(void *data, unsigned img, unsigned y,
+                        unsigned height)
+{
+   const struct bptc_float_image *image = data;
+
+   _mesa_bptc_compress_rgb_float(image->quality, image->is_signed,
+                                 image->width, height,
+                                 image->pixels +
+                                 y * image->rowstride / sizeof(float),
+                                 image->rowstride,
+                                 image->dst +
+                                 y / BLOCK_SIZE * image->dstRowStride,
+                                 image->dstRowStride);
+}
+
 static GLboolean
 texstore_bptc_rgb_float(TEXSTORE_PARAMS,
                         bool is_signed)
 {
    const float *pixels;
    const float *tempImage = NULL;
+   struct bptc_float_image image;
    int rowstride;
 
    if (srcFormat != GL_RGB ||
@@ -1619,10 +2050,16 @@ texstore_bptc_rgb_float(TEXSTORE_PARAMS,
                                          srcFormat, srcType);
    }
 
-   compress_rgb_float(srcWidth, srcHeight,
-                      pixels, rowstride,
-                      dstSlices[0], dstRowStride,
-                      is_signed);
+   image.quality = _mesa_texcompress_quality();
+   image.is_signed = is_signed;
+   image.width = srcWidth;
+   image.pixels = pixels;
+   image.rowstride = rowstride;
+   image.dst = dstSlices[0];
+   image.dstRowStride = dstRowStride;
+
+   _mesa_parallel_image_rows(ctx, srcWidth, srcHeight, 1,
+                             compress_rgb_float_rows, &image);
 
    free((void *) tempImage);
 
@@ -29,6 +29,10 @@
 #include "texcompress.h"
 #include "texstore.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 GLboolean
 _mesa_texstore_bptc_rgba_unorm(TEXSTORE_PARAMS);
 
@@ -41,4 +45,20 @@ _mesa_texstore_bptc_rgb_unsigned_float(TEXSTORE_PARAMS);
 compressed_fetch_func
 _mesa_get_bptc_fetch_func(mesa_format format);
 
+void
+_mesa_bptc_compress_rgba_unorm(unsigned quality,
+                               int width, int height,
+                               const uint8_t *src, int src_rowstride,
+                               uint8_t *dst, int dst_rowstride);
+
+void
+_mesa_bptc_compress_rgb_float(unsigned quality, bool is_signed,
+                              int width, int height,
+                              const float *src, int src_rowstride,
+                              uint8_t *dst, int dst_rowstride);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -37,7 +37,17 @@
  * MESA_FORMAT_ETC2_SRGB8_PUNCHTHROUGH_ALPHA1
  */
 
+#include <limits.h>
+#include <math.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "context.h"
 #include "texcompress.h"
 #include "texcompress_etc.h"
 #include "texstore.h"
@@ -1094,89 +1104,980 @@ etc2_unpack_srgb8_punchthrough_alpha1(uint8_t *dst_row,
    }
 }
 
-/* ETC2 texture formats are valid in glCompressedTexImage2D and
- * glCompressedTexSubImage2D functions */
+/*
+ * The encoder.
+ *
+ * Color blocks are encoded in the ETC1 compatible individual and
+ * differential modes: each subblock gets the average of its pixels as base
+ * color and the modifier table that fits it best, and the better of the two
+ * flips is kept.  From quality DEFAULT on the planar mode is fitted to the
+ * block with least squares as well, and more base colors around the
+ * averages are tried.  The T and H modes are never used.
+ *
+ * EAC channels try every modifier table with the base codeword and
+ * multiplier that span the range of the block, and from quality DEFAULT on
+ * their neighbours too.
+ */
+
+typedef uint8_t etc2_pixels[16][4];
+
+struct etc1_subblock {
+   int base[3];
+   int table;
+   uint8_t indices[8];
+   uint32_t error;
+};
+
+enum eac_channel {
+   EAC_ALPHA8,
+   EAC_R11,
+   EAC_SIGNED_R11,
+};
+
+/**
+ * Find the closest of the four palette colors for each of the 8 pixels,
+ * not counting the error of those whose bit is set in \p transparent.
+ * Ties go to the lower index, in both implementations.
+ */
+#if defined(__SSE2__)
+
+static inline __m128i
+rgb_distance4(__m128i lo, __m128i hi, __m128i color)
+{
+   __m128i dl = _mm_sub_epi16(lo, color);
+   __m128i dh = _mm_sub_epi16(hi, color);
+
+   dl = _mm_madd_epi16(dl, dl);
+   dh = _mm_madd_epi16(dh, dh);
+   dl = _mm_add_epi32(dl, _mm_srli_epi64(dl, 32));
+   dh = _mm_add_epi32(dh, _mm_srli_epi64(dh, 32));
+
+   return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(dl),
+                                          _mm_castsi128_ps(dh),
+                                          _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+static uint32_t
+match_rgb(const uint8_t pixels[8][4], const int palette[4][3],
+          unsigned transparent, uint8_t indices[8])
+{
+   const __m128i zero = _mm_setzero_si128();
+   __m128i colors[4], total = zero;
+   uint32_t error[4];
+   int g, k;
+
+   for (k = 0; k < 4; k++) {
+      colors[k] = _mm_set_epi16(0, palette[k][2], palette[k][1], palette[k][0],
+                                0, palette[k][2], palette[k][1], palette[k][0]);
+   }
+
+   for (g = 0; g < 2; g++) {
+      const unsigned t = transparent >> (4 * g);
+      const __m128i px = _mm_loadu_si128((const __m128i *) pixels[4 * g]);
+      const __m128i lo = _mm_unpacklo_epi8(px, zero);
+      const __m128i hi = _mm_unpackhi_epi8(px, zero);
+      const __m128i opaque = _mm_set_epi32((t & 8) ? 0 : ~0, (t & 4) ? 0 : ~0,
+                                           (t & 2) ? 0 : ~0, (t & 1) ? 0 : ~0);
+      __m128i best = rgb_distance4(lo, hi, colors[0]);
+      __m128i best_index = zero;
+      uint32_t index[4];
+
+      for (k = 1; k < 4; k++) {
+         const __m128i dist = rgb_distance4(lo, hi, colors[k]);
+         const __m128i closer = _mm_cmplt_epi32(dist, best);
+
+         best = _mm_or_si128(_mm_and_si128(closer, dist),
+                             _mm_andnot_si128(closer, best));
+         best_index = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(k)),
+                                   _mm_andnot_si128(closer, best_index));
+      }
+
+      total = _mm_add_epi32(total, _mm_and_si128(best, opaque));
+      _mm_storeu_si128((__m128i *) index, best_index);
+      for (k = 0; k < 4; k++)
+         indices[4 * g + k] = index[k];
+   }
+
+   _mm_storeu_si128((__m128i *) error, total);
+   return error[0] + error[1] + error[2] + error[3];
+}
+
+#else
+
+static uint32_t
+match_rgb(const uint8_t pixels[8][4], const int palette[4][3],
+          unsigned transparent, uint8_t indices[8])
+{
+   uint32_t total = 0;
+   int i, k, c;
+
+   for (i = 0; i < 8; i++) {
+      uint32_t best = ~0u;
+
+      for (k = 0; k < 4; k++) {
+         uint32_t dist = 0;
+
+         for (c = 0; c < 3; c++) {
+            const int d = pixels[i][c] - palette[k][c];
+            dist += d * d;
+         }
+
+         if (dist < best) {
+            best = dist;
+            indices[i] = k;
+         }
+      }
+
+      if (!(transparent & (1 << i)))
+         total += best;
+   }
+
+   return total;
+}
+
+#endif
+
+/**
+ * Try all the modifier tables with the quantized base color \p base.
+ */
+static void
+try_subblock_base(const uint8_t pixels[8][4], unsigned transparent,
+                  bool diff, bool non_opaque, const int base[3],
+                  struct etc1_subblock *best)
+{
+   struct etc1_subblock sub;
+   int color[3], palette[4][3];
+   int c, k;
+
+   for (c = 0; c < 3; c++) {
+      color[c] = diff ? etc1_base_color_diff_hi(base[c] << 3) :
+                        etc1_base_color_ind_hi(base[c] << 4);
+      sub.base[c] = base[c];
+   }
+
+   for (sub.table = 0; sub.table < 8; sub.table++) {
+      const int *modifiers = non_opaque ?
+                             etc2_modifier_tables_non_opaque[sub.table] :
+                             etc1_modifier_tables[sub.table];
+
+      for (k = 0; k < 4; k++) {
+         for (c = 0; c < 3; c++)
+            palette[k][c] = etc2_clamp(color[c] + modifiers[k]);
+      }
+
+      sub.error = match_rgb(pixels, palette, transparent, sub.indices);
+      if (sub.error < best->error) {
+         *best = sub;
+         if (sub.error == 0)
+            return;
+      }
+   }
+}
+
+/**
+ * Encode a subblock with 4 bit (individual) or 5 bit (differential) base
+ * colors.  In differential mode, \p ref optionally gives the base color of
+ * the other subblock, which this one has to stay within \p lo..hi of.
+ */
+static void
+encode_subblock(const uint8_t pixels[8][4], unsigned transparent,
+                bool diff, bool non_opaque, const int *ref, int lo, int hi,
+                unsigned quality, struct etc1_subblock *best)
+{
+   /* Offsets from the average color tried at each quality: none at FAST,
+    * the brightness at DEFAULT and single channels as well at BEST.
+    */
+   static const int offsets[][3] = {
+      {  0,  0,  0 },
+      { -1, -1, -1 }, {  1,  1,  1 },
+      { -2, -2, -2 }, {  2,  2,  2 },
+      { -1,  0,  0 }, {  1,  0,  0 },
+      {  0, -1,  0 }, {  0,  1,  0 },
+      {  0,  0, -1 }, {  0,  0,  1 },
+   };
+   const int num_offsets =
+      quality >= MESA_TEXCOMPRESS_QUALITY_BEST ? ARRAY_SIZE(offsets) :
+      quality >= MESA_TEXCOMPRESS_QUALITY_DEFAULT ? 3 : 1;
+   const int max = diff ? 31 : 15;
+   int sum[3] = { 0, 0, 0 }, avg[3], base[3];
+   int n = 0, i, c;
+
+   for (i = 0; i < 8; i++) {
+      if (transparent & (1 << i))
+         continue;
+      for (c = 0; c < 3; c++)
+         sum[c] += pixels[i][c];
+      n++;
+   }
+
+   for (c = 0; c < 3; c++)
+      avg[c] = n ? (sum[c] * max + n * 255 / 2) / (n * 255) : 0;
+
+   best->error = ~0u;
+
+   for (i = 0; i < num_offsets && best->error; i++) {
+      for (c = 0; c < 3; c++) {
+         base[c] = avg[c] + offsets[i][c];
+         if (ref)
+            base[c] = CLAMP(base[c], MAX2(ref[c] + lo, 0),
+                            MIN2(ref[c] + hi, max));
+         else
+            base[c] = CLAMP(base[c], 0, max);
+      }
+
+      try_subblock_base(pixels, transparent, diff, non_opaque, base, best);
+   }
+}
+
+static void
+pack_etc1_block(uint8_t *dst, bool diff, bool flipped,
+                const struct etc1_subblock sub[2], const uint8_t pos[2][8])
+{
+   uint32_t indices = 0;
+   int c, i, k;
+
+   for (c = 0; c < 3; c++) {
+      if (diff)
+         dst[c] = (sub[0].base[c] << 3) |
+                  ((sub[1].base[c] - sub[0].base[c]) & 0x7);
+      else
+         dst[c] = (sub[0].base[c] << 4) | sub[1].base[c];
+   }
+
+   dst[3] = (sub[0].table << 5) | (sub[1].table << 2) | (diff << 1) | flipped;
+
+   for (i = 0; i < 2; i++) {
+      for (k = 0; k < 8; k++) {
+         const int x = pos[i][k] & 3, y = pos[i][k] >> 2;
+         const int bit = y + x * 4;
+
+         indices |= (uint32_t) (sub[i].indices[k] & 1) << bit;
+         indices |= (uint32_t) (sub[i].indices[k] >> 1) << (bit + 16);
+      }
+   }
+
+   dst[4] = indices >> 24;
+   dst[5] = indices >> 16;
+   dst[6] = indices >> 8;
+   dst[7] = indices;
+}
+
+static bool
+diff_in_range(const struct etc1_subblock sub[2])
+{
+   int c;
+
+   for (c = 0; c < 3; c++) {
+      const int d = sub[1].base[c] - sub[0].base[c];
+      if (d < -4 || d > 3)
+         return false;
+   }
+
+   return true;
+}
+
+static int
+planar_expand(int value, int bits)
+{
+   return bits == 7 ? (value << 1) | (value >> 6) : (value << 2) | (value >> 4);
+}
+
+/** Error of one channel of a planar block */
+static uint32_t
+planar_error(const etc2_pixels pixels, int c, int o, int h, int v)
+{
+   uint32_t error = 0;
+   int x, y;
+
+   for (y = 0; y < 4; y++) {
+      for (x = 0; x < 4; x++) {
+         const int value =
+            etc2_clamp((x * (h - o) + y * (v - o) + 4 * o + 2) >> 2);
+         const int d = value - pixels[x + 4 * y][c];
+
+         error += d * d;
+      }
+   }
+
+   return error;
+}
+
+/**
+ * Fit the planar mode to the block, writing it to \p dst and returning its
+ * error.
+ */
+static uint32_t
+encode_planar(const etc2_pixels pixels, unsigned quality, uint8_t *dst)
+{
+   const int range = quality >= MESA_TEXCOMPRESS_QUALITY_BEST ? 1 : 0;
+   int o[3], h[3], v[3];
+   uint32_t total = 0;
+   int c, x, y;
+
+   for (c = 0; c < 3; c++) {
+      const int bits = c == 1 ? 7 : 6;
+      const int max = (1 << bits) - 1;
+      float mean = 0.0f, dx = 0.0f, dy = 0.0f, fo;
+      int qo, qh, qv, i, j, k;
+      uint32_t best = ~0u;
+
+      /* Least squares fit of o + x * (h - o) / 4 + y * (v - o) / 4 */
+      for (y = 0; y < 4; y++) {
+         for (x = 0; x < 4; x++) {
+            const int p = pixels[x + 4 * y][c];
+
+            mean += p;
+            dx += (x - 1.5f) * p;
+            dy += (y - 1.5f) * p;
+         }
+      }
+      mean /= 16.0f;
+      dx /= 20.0f;
+      dy /= 20.0f;
+      fo = mean - 1.5f * (dx + dy);
+
+      qo = CLAMP((int) (fo * max / 255.0f + 0.5f), 0, max);
+      qh = CLAMP((int) ((fo + 4.0f * dx) * max / 255.0f + 0.5f), 0, max);
+      qv = CLAMP((int) ((fo + 4.0f * dy) * max / 255.0f + 0.5f), 0, max);
+
+      for (i = -range; i <= range; i++) {
+         for (j = -range; j <= range; j++) {
+            for (k = -range; k <= range; k++) {
+               const int to = CLAMP(qo + i, 0, max);
+               const int th = CLAMP(qh + j, 0, max);
+               const int tv = CLAMP(qv + k, 0, max);
+               const uint32_t error =
+                  planar_error(pixels, c, planar_expand(to, bits),
+                               planar_expand(th, bits),
+                               planar_expand(tv, bits));
+
+               if (error < best) {
+                  best = error;
+                  o[c] = to;
+                  h[c] = th;
+                  v[c] = tv;
+               }
+            }
+         }
+      }
+
+      total += best;
+   }
+
+   /* The unused high bits of the R and G bytes keep R + dR and G + dG in
+    * range, those of the B byte make B + dB overflow, which selects the
+    * planar mode.
+    */
+   dst[0] = (o[0] << 1) | (o[1] >> 6);
+   if (dst[0] & 0x4)
+      dst[0] |= 0x80;
+   dst[1] = ((o[1] & 0x3f) << 1) | (o[2] >> 5);
+   if (dst[1] & 0x4)
+      dst[1] |= 0x80;
+   dst[2] = (o[2] & 0x18) | ((o[2] >> 1) & 0x3);
+   if (((o[2] >> 3) & 0x3) + ((o[2] >> 1) & 0x3) < 4)
+      dst[2] |= 0x4;
+   else
+      dst[2] |= 0xe0;
+   dst[3] = ((o[2] & 0x1) << 7) | ((h[0] >> 1) << 2) | 0x2 | (h[0] & 0x1);
+   dst[4] = (h[1] << 1) | (h[2] >> 5);
+   dst[5] = ((h[2] & 0x1f) << 3) | (v[0] >> 3);
+   dst[6] = ((v[0] & 0x7) << 5) | (v[1] >> 2);
+   dst[7] = ((v[1] & 0x3) << 6) | v[2];
+
+   return total;
+}
+
+/**
+ * Encode an ETC2 RGB block, or an RGB8_PUNCHTHROUGH_ALPHA1 one, in which
+ * pixels with alpha below 128 become transparent.
+ */
+static void
+encode_etc2_rgb_block(const etc2_pixels pixels, bool punchthrough,
+                      unsigned quality, uint8_t *dst)
+{
+   unsigned transparent = 0;
+   uint32_t best = ~0u;
+   bool non_opaque;
+   int flipped, i, k;
+
+   if (punchthrough) {
+      for (i = 0; i < 16; i++) {
+         if (pixels[i][3] < 128)
+            transparent |= 1 << i;
+      }
+   }
+   non_opaque = transparent != 0;
+
+   for (flipped = 0; flipped < 2; flipped++) {
+      uint8_t sub_pixels[2][8][4], pos[2][8];
+      unsigned sub_transparent[2] = { 0, 0 };
+      struct etc1_subblock sub[2];
+
+      for (i = 0; i < 2; i++) {
+         for (k = 0; k < 8; k++) {
+            const int x = flipped ? k & 3 : 2 * i + (k & 1);
+            const int y = flipped ? 2 * i + (k >> 2) : k >> 1;
+            const int p = x + 4 * y;
+
+            pos[i][k] = p;
+            memcpy(sub_pixels[i][k], pixels[p], 3);
+            sub_pixels[i][k][3] = 0;
+            if (transparent & (1 << p))
+               sub_transparent[i] |= 1 << k;
+         }
+      }
+
+      /* Individual mode doesn't exist with punchthrough alpha. */
+      if (!punchthrough) {
+         for (i = 0; i < 2; i++) {
+            encode_subblock(sub_pixels[i], 0, false, false, NULL, 0, 0,
+                            quality,
+                            &sub[i]);
+         }
+
+         if (sub[0].error + sub[1].error < best) {
+            best = sub[0].error + sub[1].error;
+            pack_etc1_block(dst, false, flipped, sub, pos);
+         }
+      }
+
+      for (i = 0; i < 2; i++) {
+         encode_subblock(sub_pixels[i], sub_transparent[i], true, non_opaque,
+                         NULL, 0, 0, quality, &sub[i]);
+      }
+
+      if (!diff_in_range(sub)) {
+         /* Move one of the base colors towards the other one. */
+         struct etc1_subblock other[2];
+
+         other[0] = sub[0];
+         encode_subblock(sub_pixels[1], sub_transparent[1], true, non_opaque,
+                         sub[0].base, -4, 3, quality, &other[1]);
+         encode_subblock(sub_pixels[0], sub_transparent[0], true, non_opaque,
+                         sub[1].base, -3, 4, quality, &sub[0]);
+
+         if (other[0].error + other[1].error < sub[0].error + sub[1].error) {
+            sub[0] = other[0];
+            sub[1] = other[1];
+         }
+      }
+
+      if (sub[0].error + sub[1].error < best) {
+         best = sub[0].error + sub[1].error;
+
+         for (i = 0; i < 2; i++) {
+            for (k = 0; k < 8; k++) {
+               if (sub_transparent[i] & (1 << k))
+                  sub[i].indices[k] = 2;
+            }
+         }
+
+         pack_etc1_block(dst, true, flipped, sub, pos);
+         if (non_opaque)
+            dst[3] &= ~0x2;
+      }
+
+      if (best == 0)
+         return;
+   }
+
+   if (!non_opaque && quality >= MESA_TEXCOMPRESS_QUALITY_DEFAULT) {
+      uint8_t planar[8];
+
+      if (encode_planar(pixels, quality, planar) < best)
+         memcpy(dst, planar, sizeof(planar));
+   }
+}
+
+static int
+eac_value(enum eac_channel channel, int base, int multiplier, int modifier)
+{
+   switch (channel) {
+   case EAC_ALPHA8:
+      return etc2_clamp(base + modifier * multiplier);
+   case EAC_R11:
+      if (multiplier != 0)
+         modifier *= multiplier * 8;
+      return etc2_clamp2(base * 8 + 4 + modifier);
+   case EAC_SIGNED_R11:
+      if (multiplier != 0)
+         modifier *= multiplier * 8;
+      return etc2_clamp3(base * 8 + modifier);
+   }
+
+   unreachable("bad EAC channel");
+}
+
+/**
+ * Find the closest of the 8 palette values for each of the 16 values and
+ * return the squared error.  Ties go to the lower index.
+ */
+#if defined(__SSE2__)
+
+static uint32_t
+match_eac(const int values[16], const int palette[8], uint8_t indices[16])
+{
+   const __m128i zero = _mm_setzero_si128();
+   __m128i v[2], best[2], best_index[2], error;
+   uint16_t index[16];
+   uint32_t sums[4];
+   int g, k;
+
+   for (g = 0; g < 2; g++) {
+      const int *p = &values[8 * g];
+
+      v[g] = _mm_set_epi16(p[7], p[6], p[5], p[4], p[3], p[2], p[1], p[0]);
+      best[g] = _mm_set1_epi16(INT16_MAX);
+      best_index[g] = zero;
+   }
+
+   for (k = 0; k < 8; k++) {
+      const __m128i value = _mm_set1_epi16(palette[k]);
+
+      for (g = 0; g < 2; g++) {
+         const __m128i d = _mm_sub_epi16(v[g], value);
+         const __m128i dist = _mm_max_epi16(d, _mm_sub_epi16(zero, d));
+         const __m128i closer = _mm_cmplt_epi16(dist, best[g]);
+
+         best[g] = _mm_min_epi16(dist, best[g]);
+         best_index[g] =
+            _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi16(k)),
+                         _mm_andnot_si128(closer, best_index[g]));
+      }
+   }
+
+   error = _mm_add_epi32(_mm_madd_epi16(best[0], best[0]),
+                         _mm_madd_epi16(best[1], best[1]));
+   _mm_storeu_si128((__m128i *) sums, error);
+   _mm_storeu_si128((__m128i *) &index[0], best_index[0]);
+   _mm_storeu_si128((__m128i *) &index[8], best_index[1]);
+   for (k = 0; k < 16; k++)
+      indices[k] = index[k];
+
+   return sums[0] + sums[1] + sums[2] + sums[3];
+}
+
+#else
+
+static uint32_t
+match_eac(const int values[16], const int palette[8], uint8_t indices[16])
+{
+   uint32_t total = 0;
+   int i, k;
+
+   for (i = 0; i < 16; i++) {
+      int best = INT_MAX;
+
+      for (k = 0; k < 8; k++) {
+         const int d = abs(values[i] - palette[k]);
+
+         if (d < best) {
+            best = d;
+            indices[i] = k;
+         }
+      }
+
+      total += best * best;
+   }
+
+   return total;
+}
+
+#endif
+
+/**
+ * Encode 16 values of an EAC channel, in the range of the decoded values,
+ * so 0..255 for alpha, 0..2047 for R11 and -1023..1023 for signed R11.
+ */
+static void
+encode_eac_block(const int values[16], enum eac_channel channel,
+                 unsigned quality, uint8_t *dst)
+{
+   const int scale = channel == EAC_ALPHA8 ? 1 : 8;
+   const int offset = channel == EAC_R11 ? 4 : 0;
+   const int min_base = channel == EAC_SIGNED_R11 ? -127 : 0;
+   const int max_base = channel == EAC_SIGNED_R11 ? 127 : 255;
+   const int range = quality >= MESA_TEXCOMPRESS_QUALITY_BEST ? 2 :
+                     quality >= MESA_TEXCOMPRESS_QUALITY_DEFAULT ? 1 : 0;
+   int vmin = values[0], vmax = values[0], sum = 0;
+   int best_base = 0, best_multiplier = 1, best_table = 0;
+   uint8_t indices[16], best_indices[16];
+   uint32_t best = ~0u;
+   uint64_t bits = 0;
+   int i, k, t, x, y;
+
+   for (i = 0; i < 16; i++) {
+      vmin = MIN2(vmin, values[i]);
+      vmax = MAX2(vmax, values[i]);
+      sum += values[i];
+   }
+
+   for (t = 0; t < 16 && best; t++) {
+      const int *modifiers = etc2_modifier_tables[t];
+      const int span = modifiers[7] - modifiers[3];
+      const int multiplier =
+         CLAMP((vmax - vmin + span * scale / 2) / (span * scale), 1, 15);
+      const float center = (vmin + vmax) * 0.5f - offset -
+                           (modifiers[7] + modifiers[3]) * 0.5f *
+                           multiplier * scale;
+      const int base = (int) floorf(center / scale + 0.5f);
+      int m, b;
+
+      for (m = multiplier - range; m <= multiplier + range; m++) {
+         if (m < 1 || m > 15)
+            continue;
+
+         for (b = base - range; b <= base + range; b++) {
+            const int cb = CLAMP(b, min_base, max_base);
+            int palette[8];
+            uint32_t error;
+
+            for (k = 0; k < 8; k++)
+               palette[k] = eac_value(channel, cb, m, modifiers[k]);
+
+            error = match_eac(values, palette, indices);
+            if (error < best) {
+               best = error;
+               best_base = cb;
+               best_multiplier = m;
+               best_table = t;
+               memcpy(best_indices, indices, sizeof(indices));
+            }
+         }
+      }
+   }
+
+   /* R11 blocks with little variation can use the modifiers unscaled. */
+   if (best && channel != EAC_ALPHA8 && vmax - vmin <= 30) {
+      const float avg = sum / 16.0f - offset;
+      const int base = CLAMP((int) floorf(avg / scale + 0.5f),
+                             min_base, max_base);
+
+      for (t = 0; t < 16; t++) {
+         int palette[8];
+         uint32_t error;
+
+         for (k = 0; k < 8; k++)
+            palette[k] = eac_value(channel, base, 0, etc2_modifier_tables[t][k]);
+
+         error = match_eac(values, palette, indices);
+         if (error < best) {
+            best = error;
+            best_base = base;
+            best_multiplier = 0;
+            best_table = t;
+            memcpy(best_indices, indices, sizeof(indices));
+         }
+      }
+   }
+
+   for (x = 0; x < 4; x++) {
+      for (y = 0; y < 4; y++)
+         bits = (bits << 3) | best_indices[x + 4 * y];
+   }
+
+   dst[0] = (uint8_t) best_base;
+   dst[1] = (best_multiplier << 4) | best_table;
+   for (i = 0; i < 6; i++)
+      dst[2 + i] = bits >> (40 - 8 * i);
+}
+
+static void
+load_rgba_block(etc2_pixels pixels, const uint8_t *src, int rowstride,
+                int x, int w, int h)
+{
+   int i, j;
+
+   for (j = 0; j < 4; j++) {
+      const uint8_t *row = src + MIN2(j, h - 1) * rowstride;
+
+      for (i = 0; i < 4; i++)
+         memcpy(pixels[i + 4 * j], row + 4 * (x + MIN2(i, w - 1)), 4);
+   }
+}
+
+/**
+ * Load channel \p c of a block of 16 bit values with \p comps channels,
+ * rescaled to 11 bits.
+ */
+static void
+load_r11_block(int values[16], bool is_signed, const uint8_t *src,
+               int rowstride, int comps, int c, int x, int w, int h)
+{
+   int i, j;
+
+   for (j = 0; j < 4; j++) {
+      const uint8_t *row = src + MIN2(j, h - 1) * rowstride;
+
+      for (i = 0; i < 4; i++) {
+         const int index = (x + MIN2(i, w - 1)) * comps + c;
+
+         if (is_signed) {
+            const int v = ((const int16_t *) row)[index];
+            values[i + 4 * j] =
+               CLAMP((v * 1023 + (v < 0 ? -16383 : 16383)) / 32767,
+                     -1023, 1023);
+         } else {
+            const int v = ((const uint16_t *) row)[index];
+            values[i + 4 * j] = (v * 2047 + 32767) / 65535;
+         }
+      }
+   }
+}
+
+static void
+compress_etc2_block(mesa_format format, unsigned quality,
+                    const uint8_t *src, int rowstride,
+                    int x, int w, int h, uint8_t *dst)
+{
+   etc2_pixels pixels;
+   int values[16];
+   int i;
+
+   switch (format) {
+   case MESA_FORMAT_ETC2_RGB8:
+   case MESA_FORMAT_ETC2_SRGB8:
+      load_rgba_block(pixels, src, rowstride, x, w, h);
+      encode_etc2_rgb_block(pixels, false, quality, dst);
+      break;
+   case MESA_FORMAT_ETC2_RGBA8_EAC:
+   case MESA_FORMAT_ETC2_SRGB8_ALPHA8_EAC:
+      load_rgba_block(pixels, src, rowstride, x, w, h);
+      for (i = 0; i < 16; i++)
+         values[i] = pixels[i][3];
+      encode_eac_block(values, EAC_ALPHA8, quality, dst);
+      encode_etc2_rgb_block(pixels, false, quality, dst + 8);
+      break;
+   case MESA_FORMAT_ETC2_RGB8_PUNCHTHROUGH_ALPHA1:
+   case MESA_FORMAT_ETC2_SRGB8_PUNCHTHROUGH_ALPHA1:
+      load_rgba_block(pixels, src, rowstride, x, w, h);
+      encode_etc2_rgb_block(pixels, true, quality, dst);
+      break;
+   case MESA_FORMAT_ETC2_R11_EAC:
+      load_r11_block(values, false, src, rowstride, 1, 0, x, w, h);
+      encode_eac_block(values, EAC_R11, quality, dst);
+      break;
+   case MESA_FORMAT_ETC2_SIGNED_R11_EAC:
+      load_r11_block(values, true, src, rowstride, 1, 0, x, w, h);
+      encode_eac_block(values, EAC_SIGNED_R11, quality, dst);
+      break;
+   case MESA_FORMAT_ETC2_RG11_EAC:
+   case MESA_FORMAT_ETC2_SIGNED_RG11_EAC: {
+      const bool is_signed = format == MESA_FORMAT_ETC2_SIGNED_RG11_EAC;
+      const enum eac_channel channel = is_signed ? EAC_SIGNED_R11 : EAC_R11;
+
+      for (i = 0; i < 2; i++) {
+         load_r11_block(values, is_signed, src, rowstride, 2, i, x, w, h);
+         encode_eac_block(values, channel, quality, dst + 8 * i);
+      }
+      break;
+   }
+   default:
+      unreachable("not an ETC2 format");
+   }
+}
+
+/**
+ * Compress an image to one of the ETC2 formats.  The source is RGBA8 for
+ * the color formats and one or two 16 bit unorm or snorm channels for the
+ * (signed) R11 and RG11 ones.
+ */
+void
+_mesa_etc2_compress(mesa_format format, unsigned quality,
+                    int width, int height,
+                    const void *src, int src_rowstride,
+                    uint8_t *dst, int dst_rowstride)
+{
+   const int block_bytes = _mesa_get_format_bytes(format);
+   int x, y;
+
+   for (y = 0; y < height; y += 4) {
+      const uint8_t *src_row = (const uint8_t *) src + y * src_rowstride;
+      uint8_t *block = dst + y / 4 * dst_rowstride;
+
+      for (x = 0; x < width; x += 4) {
+         compress_etc2_block(format, quality, src_row, src_rowstride,
+                             x, MIN2(width - x, 4), MIN2(height - y, 4),
+                             block);
+         block += block_bytes;
+      }
+   }
+}
+
+struct etc2_image {
+   mesa_format format;
+   unsigned quality;
+   int width;
+   const GLubyte *pixels;
+   int rowstride;
+   GLubyte *dst;
+   GLint dstRowStride;
+};
+
+static void
+compress_etc2_rows(void *data, unsigned img, unsigned y, unsigned height)
+{
+   const struct etc2_image *image = data;
+
+   _mesa_etc2_compress(image->format, image->quality, image->width, height,
+                       image->pixels + y * image->rowstride, image->rowstride,
+                       image->dst + y / 4 * image->dstRowStride,
+                       image->dstRowStride);
+}
+
+/**
+ * Convert the source image to the format _mesa_etc2_compress() expects
+ * and compress it, in bands of rows on the worker threads.
+ */
+static GLboolean
+texstore_etc2(TEXSTORE_PARAMS)
+{
+   GLubyte *tempImage, *tempImageSlices[1];
+   struct etc2_image image;
+   mesa_format tempFormat;
+   int tempRowStride;
+
+   switch (dstFormat) {
+   case MESA_FORMAT_ETC2_R11_EAC:
+      tempFormat = MESA_FORMAT_R_UNORM16;
+      break;
+   case MESA_FORMAT_ETC2_SIGNED_R11_EAC:
+      tempFormat = MESA_FORMAT_R_SNORM16;
+      break;
+   case MESA_FORMAT_ETC2_RG11_EAC:
+      tempFormat = _mesa_little_endian() ? MESA_FORMAT_R16G16_UNORM
+                                         : MESA_FORMAT_G16R16_UNORM;
+      break;
+   case MESA_FORMAT_ETC2_SIGNED_RG11_EAC:
+      tempFormat = _mesa_little_endian() ? MESA_FORMAT_R16G16_SNORM
+                                         : MESA_FORMAT_G16R16_SNORM;
+      break;
+   default:
+      tempFormat = _mesa_little_endian() ? MESA_FORMAT_R8G8B8A8_UNORM
+                                         : MESA_FORMAT_A8B8G8R8_UNORM;
+      break;
+   }
+
+   tempRowStride = srcWidth * _mesa_get_format_bytes(tempFormat);
+   tempImage = malloc(tempRowStride * srcHeight);
+   if (!tempImage)
+      return GL_FALSE; /* out of memory */
+   tempImageSlices[0] = tempImage;
+   _mesa_texstore(ctx, dims,
+                  baseInternalFormat,
+                  tempFormat,
+                  tempRowStride, tempImageSlices,
+                  srcWidth, srcHeight, srcDepth,
+                  srcFormat, srcType, srcAddr,
+                  srcPacking);
+
+   image.format = dstFormat;
+   image.quality = _mesa_texcompress_quality();
+   image.width = srcWidth;
+   image.pixels = tempImage;
+   image.rowstride = tempRowStride;
+   image.dst = dstSlices[0];
+   image.dstRowStride = dstRowStride;
+
+   _mesa_parallel_image_rows(ctx, srcWidth, srcHeight, 1,
+                             compress_etc2_rows, &image);
+
+   free(tempImage);
+
+   return GL_TRUE;
+}
+
 GLboolean
 _mesa_texstore_etc2_rgb8(TEXSTORE_PARAMS)
 {
-   assert(0);
-
-   return GL_FALSE;
+   return texstore_etc2(ctx, dims, baseInternalFormat, dstFormat,
+                        dstRowStride, dstSlices,
+                        srcWidth, srcHeight, srcDepth,
+                        srcFormat, srcType, srcAddr, srcPacking);
 }
 
 GLboolean
 _mesa_texstore_etc2_srgb8(TEXSTORE_PARAMS)
 {
-   assert(0);
-
-   return GL_FALSE;
+   return texstore_etc2(ctx, dims, baseInternalFormat, dstFormat,
+                        dstRowStride, dstSlices,
+                        srcWidth, srcHeight, srcDepth,
+                        srcFormat, srcType, srcAddr, srcPacking);
 }
 
 GLboolean
 _mesa_texstore_etc2_rgba8_eac(TEXSTORE_PARAMS)
 {
-   assert(0);
-
-   return GL_FALSE;
+   return texstore_etc2(ctx, dims, baseInternalFormat, dstFormat,
+                        dstRowStride, dstSlices,
+                        srcWidth, srcHeight, srcDepth,
+                        srcFormat, srcType, srcAddr, srcPacking);
 }
 
 GLboolean
 _mesa_texstore_etc2_srgb8_alpha8_eac(TEXSTORE_PARAMS)
 {
-   assert(0);
-
-   return GL_FALSE;
+   return texstore_etc2(ctx, dims, baseInternalFormat, dstFormat,
+                        dstRowStride, dstSlices,
+                        srcWidth, srcHeight, srcDepth,
+                        srcFormat, srcType, srcAddr, srcPacking);
 }
 
 GLboolean
 _mesa_texstore_etc2_r11_eac(TEXSTORE_PARAMS)
 {
-   assert(0);
-
-   return GL_FALSE;
+   return texstore_etc2(ctx, dims, baseInternalFormat, dstFormat,
+                        dstRowStride, dstSlices,
+                        srcWidth, srcHeight, srcDepth,
+                        srcFormat, srcType, srcAddr, srcPacking);
 }
 
 GLboolean
 _mesa_texstore_etc2_signed_r11_eac(TEXSTORE_PARAMS)
 {
-   assert(0);
-
-   return GL_FALSE;
+   return texstore_etc2(ctx, dims, baseInternalFormat, dstFormat,
+                        dstRowStride, dstSlices,
+                        srcWidth, srcHeight, srcDepth,
+                        srcFormat, srcType, srcAddr, srcPacking);
 }
 
 GLboolean
 _mesa_texstore_etc2_rg11_eac(TEXSTORE_PARAMS)
 {
-   assert(0);
-
-   return GL_FALSE;
+   return texstore_etc2(ctx, dims, baseInternalFormat, dstFormat,
+                        dstRowStride, dstSlices,
+                        srcWidth, srcHeight, srcDepth,
+                        srcFormat, srcType, srcAddr, srcPacking);
 }
 
 GLboolean
 _mesa_texstore_etc2_signed_rg11_eac(TEXSTORE_PARAMS)
 {
-   assert(0);
-
-   return GL_FALSE;
+   return texstore_etc2(ctx, dims, baseInternalFormat, dstFormat,
+                        dstRowStride, dstSlices,
+                        srcWidth, srcHeight, srcDepth,
+                        srcFormat, srcType, srcAddr, srcPacking);
 }
 
 GLboolean
 _mesa_texstore_etc2_rgb8_punchthrough_alpha1(TEXSTORE_PARAMS)
 {
-   assert(0);
-
-   return GL_FALSE;
+   return texstore_etc2(ctx, dims, baseInternalFormat, dstFormat,
+                        dstRowStride, dstSlices,
+                        srcWidth, srcHeight, srcDepth,
+                        srcFormat, srcType, srcAddr, srcPacking);
 }
 
 GLboolean
 _mesa_texstore_etc2_srgb8_punchthrough_alpha1(TEXSTORE_PARAMS)
 {
-   assert(0);
-
-   return GL_FALSE;
+   return texstore_etc2(ctx, dims, baseInternalFormat, dstFormat,
+                        dstRowStride, dstSlices,
+                        srcWidth, srcHeight, srcDepth,
+                        srcFormat, srcType, srcAddr, srcPacking);
 }
 
-
 /**
  * Decode texture data in any one of following formats:
  * `MESA_FORMAT_ETC2_RGB8`
@@ -1400,7 +2301,7 @@ fetch_etc2_signed_r11_eac(const GLubyte *map,
                           GLint rowStride, GLint i, GLint j, GLfloat *texel)
 {
    struct etc2_block block;
-   GLushort dst;
+   GLshort dst;
    const uint8_t *src;
 
    src = map + (((rowStride + 3) / 4) * (j / 4) + (i / 4)) * 8;
@@ -1408,7 +2309,7 @@ fetch_etc2_signed_r11_eac(const GLubyte *map,
    etc2_r11_parse_block(&block, src);
    etc2_signed_r11_fetch_texel(&block, i % 4, j % 4, (uint8_t *)&dst);
 
-   texel[RCOMP] = SHORT_TO_FLOAT(dst);
+   texel[RCOMP] = SHORT_TO_FLOAT_TEX(dst);
    texel[GCOMP] = 0.0f;
    texel[BCOMP] = 0.0f;
    texel[ACOMP] = 1.0f;
@@ -1419,7 +2320,7 @@ fetch_etc2_signed_rg11_eac(const GLubyte *map,
                            GLint rowStride, GLint i, GLint j, GLfloat *texel)
 {
    struct etc2_block block;
-   GLushort dst[2];
+   GLshort dst[2];
    const uint8_t *src;
 
    src = map + (((rowStride + 3) / 4) * (j / 4) + (i / 4)) * 16;
@@ -1432,8 +2333,8 @@ fetch_etc2_signed_rg11_eac(const GLubyte *map,
    etc2_r11_parse_block(&block, src + 8);
    etc2_signed_r11_fetch_texel(&block, i % 4, j % 4, (uint8_t *)(dst + 1));
 
-   texel[RCOMP] = SHORT_TO_FLOAT(dst[0]);
-   texel[GCOMP] = SHORT_TO_FLOAT(dst[1]);
+   texel[RCOMP] = SHORT_TO_FLOAT_TEX(dst[0]);
+   texel[GCOMP] = SHORT_TO_FLOAT_TEX(dst[1]);
    texel[BCOMP] = 0.0f;
    texel[ACOMP] = 1.0f;
 }
@@ -29,6 +29,10 @@
 #include "texcompress.h"
 #include "texstore.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 
 GLboolean
 _mesa_texstore_etc1_rgb8(TEXSTORE_PARAMS);
@@ -82,4 +86,14 @@ _mesa_unpack_etc2_format(uint8_t *dst_row,
 compressed_fetch_func
 _mesa_get_etc_fetch_func(mesa_format format);
 
+void
+_mesa_etc2_compress(mesa_format format, unsigned quality,
+                    int width, int height,
+                    const void *src, int src_rowstride,
+                    uint8_t *dst, int dst_rowstride);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -31,6 +31,7 @@
 
 #include "glheader.h"
 #include "imports.h"
+#include "context.h"
 #include "dlopen.h"
 #include "image.h"
 #include "macros.h"
@@ -39,6 +40,7 @@
 #include "texcompress_s3tc.h"
 #include "texstore.h"
 #include "format_unpack.h"
+#include "util/dxtn.h"
 #include "util/format_srgb.h"
 
 
@@ -57,13 +59,6 @@ static dxtFetchTexelFuncExt fetch_ext_rgba_dxt1 = NULL;
 static dxtFetchTexelFuncExt fetch_ext_rgba_dxt3 = NULL;
 static dxtFetchTexelFuncExt fetch_ext_rgba_dxt5 = NULL;
 
-typedef void (*dxtCompressTexFuncExt)(GLint srccomps, GLint width,
-                                      GLint height, const GLubyte *srcPixData,
-                                      GLenum destformat, GLubyte *dest,
-                                      GLint dstRowStride);
-
-static dxtCompressTexFuncExt ext_tx_compress_dxtn = NULL;
-
 static void *dxtlibhandle = NULL;
 
 
@@ -76,7 +71,7 @@ _mesa_init_texture_s3tc( struct gl_context *ctx )
       dxtlibhandle = _mesa_dlopen(DXTN_LIBNAME, 0);
       if (!dxtlibhandle) {
 	 _mesa_warning(ctx, "couldn't open " DXTN_LIBNAME ", software DXTn "
-	    "compression/decompression unavailable");
+	    "decompression unavailable");
       }
       else {
          /* the fetch functions are not per context! Might be problematic... */
@@ -88,22 +83,18 @@ _mesa_init_texture_s3tc( struct gl_context *ctx )
             _mesa_dlsym(dxtlibhandle, "fetch_2d_texel_rgba_dxt3");
          fetch_ext_rgba_dxt5 = (dxtFetchTexelFuncExt)
             _mesa_dlsym(dxtlibhandle, "fetch_2d_texel_rgba_dxt5");
-         ext_tx_compress_dxtn = (dxtCompressTexFuncExt)
-            _mesa_dlsym(dxtlibhandle, "tx_compress_dxtn");
 
          if (!fetch_ext_rgb_dxt1 ||
              !fetch_ext_rgba_dxt1 ||
              !fetch_ext_rgba_dxt3 ||
-             !fetch_ext_rgba_dxt5 ||
-             !ext_tx_compress_dxtn) {
+             !fetch_ext_rgba_dxt5) {
 	    _mesa_warning(ctx, "couldn't reference all symbols in "
-	       DXTN_LIBNAME ", software DXTn compression/decompression "
+	       DXTN_LIBNAME ", software DXTn decompression "
 	       "unavailable");
             fetch_ext_rgb_dxt1 = NULL;
             fetch_ext_rgba_dxt1 = NULL;
             fetch_ext_rgba_dxt3 = NULL;
             fetch_ext_rgba_dxt5 = NULL;
-            ext_tx_compress_dxtn = NULL;
             _mesa_dlclose(dxtlibhandle);
             dxtlibhandle = NULL;
          }
@@ -114,6 +105,52 @@ _mesa_init_texture_s3tc( struct gl_context *ctx )
    }
 }
 
+struct dxtn_image {
+   enum util_dxtn_format format;
+   unsigned quality;
+   GLint comps;
+   GLint width;
+   const GLubyte *pixels;
+   GLubyte *dst;
+   GLint dstRowStride;
+};
+
+static void
+compress_dxtn_rows(void *data, unsigned img, unsigned y, unsigned height)
+{
+   const struct dxtn_image *image = data;
+   const GLint srcRowStride = image->comps * image->width;
+
+   util_format_encode_dxtn(image->format, image->quality,
+                           image->pixels + y * srcRowStride, image->comps,
+                           srcRowStride, image->width, height,
+                           image->dst + y / 4 * image->dstRowStride,
+                           image->dstRowStride);
+}
+
+/**
+ * Compress an image of tightly packed RGB or RGBA pixels.
+ */
+static void
+compress_dxtn(struct gl_context *ctx, enum util_dxtn_format format,
+              GLint comps, GLint width, GLint height, const GLubyte *pixels,
+              GLubyte *dst, GLint dstRowStride)
+{
+   struct dxtn_image image;
+
+   image.format = format;
+   image.quality = util_format_dxtn_quality();
+   image.comps = comps;
+   image.width = width;
+   image.pixels = pixels;
+   image.dst = dst;
+   image.dstRowStride = dstRowStride;
+
+   _mesa_parallel_image_rows(ctx, width, height, 1,
+                             compress_dxtn_rows, &image);
+}
+
+
 /**
  * Store user's image in rgb_dxt1 format.
  */
@@ -156,14 +193,8 @@ _mesa_texstore_rgb_dxt1(TEXSTORE_PARAMS)
 
    dst = dstSlices[0];
 
-   if (ext_tx_compress_dxtn) {
-      (*ext_tx_compress_dxtn)(3, srcWidth, srcHeight, pixels,
-                              GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
-                              dst, dstRowStride);
-   }
-   else {
-      _mesa_warning(ctx, "external dxt library not available: texstore_rgb_dxt1");
-   }
+   compress_dxtn(ctx, UTIL_DXTN_DXT1_RGB, 3, srcWidth, srcHeight, pixels,
+                 dst, dstRowStride);
 
    free((void *) tempImage);
 
@@ -214,14 +245,8 @@ _mesa_texstore_rgba_dxt1(TEXSTORE_PARAMS)
 
    dst = dstSlices[0];
 
-   if (ext_tx_compress_dxtn) {
-      (*ext_tx_compress_dxtn)(4, srcWidth, srcHeight, pixels,
-                              GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
-                              dst, dstRowStride);
-   }
-   else {
-      _mesa_warning(ctx, "external dxt library not available: texstore_rgba_dxt1");
-   }
+   compress_dxtn(ctx, UTIL_DXTN_DXT1_RGBA, 4, srcWidth, srcHeight, pixels,
+                 dst, dstRowStride);
 
    free((void*) tempImage);
 
@@ -271,14 +296,8 @@ _mesa_texstore_rgba_dxt3(TEXSTORE_PARAMS)
 
    dst = dstSlices[0];
 
-   if (ext_tx_compress_dxtn) {
-      (*ext_tx_compress_dxtn)(4, srcWidth, srcHeight, pixels,
-                              GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,
-                              dst, dstRowStride);
-   }
-   else {
-      _mesa_warning(ctx, "external dxt library not available: texstore_rgba_dxt3");
-   }
+   compress_dxtn(ctx, UTIL_DXTN_DXT3_RGBA, 4, srcWidth, srcHeight, pixels,
+                 dst, dstRowStride);
 
    free((void *) tempImage);
 
@@ -328,14 +347,8 @@ _mesa_texstore_rgba_dxt5(TEXSTORE_PARAMS)
 
    dst = dstSlices[0];
 
-   if (ext_tx_compress_dxtn) {
-      (*ext_tx_compress_dxtn)(4, srcWidth, srcHeight, pixels,
-                              GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
-                              dst, dstRowStride);
-   }
-   else {
-      _mesa_warning(ctx, "external dxt library not available: texstore_rgba_dxt5");
-   }
+   compress_dxtn(ctx, UTIL_DXTN_DXT5_RGBA, 4, srcWidth, srcHeight, pixels,
+                 dst, dstRowStride);
 
    free((void *) tempImage);
 
@@ -53,6 +53,7 @@
 
 #include "glheader.h"
 #include "bufferobj.h"
+#include "context.h"
 #include "format_pack.h"
 #include "format_utils.h"
 #include "image.h"
@@ -669,6 +670,59 @@ texstore_compressed(TEXSTORE_PARAMS)
                            srcFormat, srcType, srcAddr, srcPacking);
 }
 
+struct convert_bands {
+   GLubyte **dstSlices;
+   mesa_format dstFormat;
+   GLint dstRowStride;
+   GLubyte *src;
+   uint32_t srcFormat;
+   GLint srcRowStride;
+   GLint width, height;
+   uint8_t *rebaseSwizzle;
+};
+
+static void
+convert_rows(void *data, unsigned img, unsigned row, unsigned rows)
+{
+   const struct convert_bands *b = data;
+   const GLint y = img * b->height + row;
+
+   _mesa_format_convert(b->dstSlices[img] + (GLint) row * b->dstRowStride,
+                        b->dstFormat, b->dstRowStride,
+                        b->src + y * b->srcRowStride,
+                        b->srcFormat, b->srcRowStride,
+                        b->width, rows, b->rebaseSwizzle);
+}
+
+/**
+ * Convert \p depth images with _mesa_format_convert().
+ *
+ * Rows are converted independently, so large images are split into bands of
+ * rows that are converted on the worker threads.
+ */
+static void
+convert_images(struct gl_context *ctx,
+               GLubyte **dstSlices, mesa_format dstFormat, GLint dstRowStride,
+               GLubyte *src, uint32_t srcFormat, GLint srcRowStride,
+               GLint width, GLint height, GLint depth,
+               uint8_t *rebaseSwizzle)
+{
+   struct convert_bands b;
+
+   b.dstSlices = dstSlices;
+   b.dstFormat = dstFormat;
+   b.dstRowStride = dstRowStride;
+   b.src = src;
+   b.srcFormat = srcFormat;
+   b.srcRowStride = srcRowStride;
+   b.width = width;
+   b.height = height;
+   b.rebaseSwizzle = rebaseSwizzle;
+
+   _mesa_parallel_image_rows(ctx, width, height, depth, convert_rows, &b);
+}
+
+
 static GLboolean
 texstore_rgba(TEXSTORE_PARAMS)
 {
@@ -805,13 +859,10 @@ texstore_rgba(TEXSTORE_PARAMS)
       needRebase = false;
    }
 
-   for (img = 0; img < srcDepth; img++) {
-      _mesa_format_convert(dstSlices[img], dstFormat, dstRowStride,
-                           src, srcMesaFormat, srcRowStride,
-                           srcWidth, srcHeight,
-                           needRebase ? rebaseSwizzle : NULL);
-      src += srcHeight * srcRowStride;
-   }
+   convert_images(ctx, dstSlices, dstFormat, dstRowStride,
+                  src, srcMesaFormat, srcRowStride,
+                  srcWidth, srcHeight, srcDepth,
+                  needRebase ? rebaseSwizzle : NULL);
 
    free(tempImage);
    free(tempRGBA);
@@ -794,6 +794,18 @@ _mesa_uniform(struct gl_context *ctx, struct gl_shader_program *shProg,
       count = MIN2(count, (int) (uni->array_elements - offset));
    }
 
+   /* Setting a uniform to the value it already has is common in old
+    * applications.  Skip it, so that the vertices queued by glBegin/glEnd
+    * don't have to be flushed.  Samplers and images also update other
+    * state, so they always go the full way.
+    */
+   if (!uni->type->is_boolean() &&
+       !uni->type->is_sampler() &&
+       !uni->type->is_image() &&
+       memcmp(&uni->storage[size_mul * components * offset], values,
+              sizeof(uni->storage[0]) * components * count * size_mul) == 0)
+      return;
+
    FLUSH_VERTICES(ctx, _NEW_PROGRAM_CONSTANTS);
 
    /* Store the data in the "actual type" backing storage for the uniform.
@@ -988,11 +1000,18 @@ _mesa_uniform_matrix(struct gl_context *ctx, struct gl_shader_program *shProg,
       count = MIN2(count, (int) (uni->array_elements - offset));
    }
 
+   elements = components * vectors;
+
+   /* Skip redundant updates, see _mesa_uniform(). */
+   if (!transpose &&
+       memcmp(&uni->storage[size_mul * elements * offset], values,
+              sizeof(uni->storage[0]) * elements * count * size_mul) == 0)
+      return;
+
    FLUSH_VERTICES(ctx, _NEW_PROGRAM_CONSTANTS);
 
    /* Store the data in the "actual type" backing storage for the uniform.
     */
-   elements = components * vectors;
 
    if (!transpose) {
       memcpy(&uni->storage[size_mul * elements * offset], values,
@@ -46,6 +46,9 @@
 #include "compiler/glsl_types.h"
 #include "compiler/glsl/linker.h"
 #include "compiler/glsl/program.h"
+#include "compiler/glsl/blob.h"
+#include "compiler/glsl/serialize.h"
+#include "compiler/glsl/shader_cache.h"
 #include "program/hash_table.h"
 #include "program/prog_instruction.h"
 #include "program/prog_optimize.h"
@@ -2974,30 +2977,31 @@ _mesa_ir_link_shader(struct gl_context *ctx, struct gl_shader_program *prog)
       const struct gl_shader_compiler_options *options =
             &ctx->Const.ShaderCompilerOptions[prog->_LinkedShaders[i]->Stage];
 
+      opt_pass_manager pm;
       do {
 	 progress = false;
 
 	 /* Lowering */
-	 do_mat_op_to_vec(ir);
-	 lower_instructions(ir, (MOD_TO_FLOOR | DIV_TO_MUL_RCP | EXP_TO_EXP2
-				 | LOG_TO_LOG2 | INT_DIV_TO_MUL_RCP
-				 | ((options->EmitNoPow) ? POW_TO_EXP2 : 0)));
+	 pm.track(do_mat_op_to_vec(ir));
+	 pm.track(lower_instructions(ir, (MOD_TO_FLOOR | DIV_TO_MUL_RCP | EXP_TO_EXP2
+					  | LOG_TO_LOG2 | INT_DIV_TO_MUL_RCP
+					  | ((options->EmitNoPow) ? POW_TO_EXP2 : 0))));
 
-	 progress = do_lower_jumps(ir, true, true, options->EmitNoMainReturn, options->EmitNoCont, options->EmitNoLoops) || progress;
+	 progress = pm.track(do_lower_jumps(ir, true, true, options->EmitNoMainReturn, options->EmitNoCont, options->EmitNoLoops)) || progress;
 
 	 progress = do_common_optimization(ir, true, true,
-                                           options, ctx->Const.NativeIntegers)
+                                           options, ctx->Const.NativeIntegers, &pm)
 	   || progress;
 
-	 progress = lower_quadop_vector(ir, true) || progress;
+	 progress = pm.track(lower_quadop_vector(ir, true)) || progress;
 
 	 if (options->MaxIfDepth == 0)
-	    progress = lower_discard(ir) || progress;
+	    progress = pm.track(lower_discard(ir)) || progress;
 
-	 progress = lower_if_to_cond_assign(ir, options->MaxIfDepth) || progress;
+	 progress = pm.track(lower_if_to_cond_assign(ir, options->MaxIfDepth)) || progress;
 
 	 if (options->EmitNoNoise)
-	    progress = lower_noise(ir) || progress;
+	    progress = pm.track(lower_noise(ir)) || progress;
 
 	 /* If there are forms of indirect addressing that the driver
 	  * cannot handle, perform the lowering pass.
@@ -3005,15 +3009,15 @@ _mesa_ir_link_shader(struct gl_context *ctx, struct gl_shader_program *prog)
 	 if (options->EmitNoIndirectInput || options->EmitNoIndirectOutput
 	     || options->EmitNoIndirectTemp || options->EmitNoIndirectUniform)
 	   progress =
-	     lower_variable_index_to_cond_assign(prog->_LinkedShaders[i]->Stage, ir,
-						 options->EmitNoIndirectInput,
-						 options->EmitNoIndirectOutput,
-						 options->EmitNoIndirectTemp,
-						 options->EmitNoIndirectUniform)
+	     pm.track(lower_variable_index_to_cond_assign(prog->_LinkedShaders[i]->Stage, ir,
+							  options->EmitNoIndirectInput,
+							  options->EmitNoIndirectOutput,
+							  options->EmitNoIndirectTemp,
+							  options->EmitNoIndirectUniform))
 	     || progress;
 
-	 progress = do_vec_index_to_cond_assign(ir) || progress;
-         progress = lower_vector_insert(ir, true) || progress;
+	 progress = pm.track(do_vec_index_to_cond_assign(ir)) || progress;
+         progress = pm.track(lower_vector_insert(ir, true)) || progress;
       } while (progress);
 
       validate_ir_tree(ir);
@@ -3045,14 +3049,26 @@ _mesa_ir_link_shader(struct gl_context *ctx, struct gl_shader_program *prog)
 }
 
 /**
- * Link a GLSL shader program.  Called via glLinkProgram().
+ * Run the GLSL linker on a program whose data was cleared.
+ *
+ * This only touches \p prog and its attached shaders, so it may run on one
+ * of the compiler threads.
  */
 void
-_mesa_glsl_link_shader(struct gl_context *ctx, struct gl_shader_program *prog)
+_mesa_glsl_link_shader_ir(struct gl_context *ctx,
+                          struct gl_shader_program *prog,
+                          struct glsl_link_state *state)
 {
    unsigned int i;
 
-   _mesa_clear_shader_program_data(prog);
+   state->binary = NULL;
+   state->cache_hit = false;
+
+   /* Like the other program parameters, the hint only takes effect when the
+    * program is linked.
+    */
+   state->keep_binary = ctx->Const.NumProgramBinaryFormats &&
+                        prog->BinaryRetreivableHint;
 
    prog->LinkStatus = GL_TRUE;
 
@@ -3063,8 +3079,33 @@ _mesa_glsl_link_shader(struct gl_context *ctx, struct gl_shader_program *prog)
    }
 
    if (prog->LinkStatus) {
-      link_shaders(ctx, prog);
+      state->cache_hit = shader_cache_read_program(ctx, prog, state->key);
+      if (!state->cache_hit &&
+          shader_cache_compile_skipped_shaders(ctx, prog))
+         link_shaders(ctx, prog);
+   }
+
+   /* The driver lowers the linked IR in place, so capture it first for the
+    * shader cache and glGetProgramBinary.  Applications that want a binary
+    * set PROGRAM_BINARY_RETRIEVABLE_HINT, so don't pay for serializing and
+    * keeping it otherwise.
+    */
+   if (prog->LinkStatus &&
+       ((ctx->Cache && !state->cache_hit) || state->keep_binary)) {
+      state->binary = blob_create(prog);
+      serialize_glsl_program(state->binary, ctx, prog);
    }
+}
+
+/**
+ * Hand the output of _mesa_glsl_link_shader_ir() to the driver.
+ */
+void
+_mesa_glsl_link_shader_driver(struct gl_context *ctx,
+                              struct gl_shader_program *prog,
+                              struct glsl_link_state *state)
+{
+   struct blob *binary = state->binary;
 
    if (prog->LinkStatus) {
       if (!ctx->Driver.LinkShader(ctx, prog)) {
@@ -3072,6 +3113,18 @@ _mesa_glsl_link_shader(struct gl_context *ctx, struct gl_shader_program *prog)
       }
    }
 
+   if (binary && prog->LinkStatus) {
+      if (!state->cache_hit)
+         shader_cache_write_program(ctx, prog, state->key, binary);
+
+      if (state->keep_binary)
+         prog->Binary = binary;
+      else
+         ralloc_free(binary);
+   } else {
+      ralloc_free(binary);
+   }
+
    if (ctx->_Shader->Flags & GLSL_DUMP) {
       if (!prog->LinkStatus) {
 	 fprintf(stderr, "GLSL shader program %d failed to link\n", prog->Name);
@@ -3084,4 +3137,18 @@ _mesa_glsl_link_shader(struct gl_context *ctx, struct gl_shader_program *prog)
    }
 }
 
+/**
+ * Link a GLSL shader program.  Called via glLinkProgram().
+ */
+void
+_mesa_glsl_link_shader(struct gl_context *ctx, struct gl_shader_program *prog)
+{
+   struct glsl_link_state state;
+
+   _mesa_clear_shader_program_data(prog);
+
+   _mesa_glsl_link_shader_ir(ctx, prog, &state);
+   _mesa_glsl_link_shader_driver(ctx, prog, &state);
+}
+
 } /* extern "C" */
@@ -24,6 +24,7 @@
 #pragma once
 
 #include "main/glheader.h"
+#include "util/disk_cache.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -32,8 +33,25 @@ extern "C" {
 struct gl_context;
 struct gl_shader;
 struct gl_shader_program;
+struct blob;
+
+/**
+ * State carried from the GLSL linker to the driver side of a link
+ */
+struct glsl_link_state {
+   struct blob *binary;  /**< Serialized linker output, or NULL */
+   bool cache_hit;
+   bool keep_binary;     /**< Whether glGetProgramBinary will need it */
+   cache_key key;
+};
 
 void _mesa_glsl_link_shader(struct gl_context *ctx, struct gl_shader_program *prog);
+void _mesa_glsl_link_shader_ir(struct gl_context *ctx,
+                               struct gl_shader_program *prog,
+                               struct glsl_link_state *state);
+void _mesa_glsl_link_shader_driver(struct gl_context *ctx,
+                                   struct gl_shader_program *prog,
+                                   struct glsl_link_state *state);
 GLboolean _mesa_ir_link_shader(struct gl_context *ctx, struct gl_shader_program *prog);
 
 void
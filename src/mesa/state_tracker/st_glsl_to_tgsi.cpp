@@ -6834,16 +6834,17 @@ st_link_shader(struct gl_context *ctx, struct gl_shader_program *prog)
          lower_discard(ir);
       }
 
+      opt_pass_manager pm;
       do {
          progress = false;
 
-         progress = do_lower_jumps(ir, true, true, options->EmitNoMainReturn, options->EmitNoCont, options->EmitNoLoops) || progress;
+         progress = pm.track(do_lower_jumps(ir, true, true, options->EmitNoMainReturn, options->EmitNoCont, options->EmitNoLoops)) || progress;
 
          progress = do_common_optimization(ir, true, true, options,
-                                           ctx->Const.NativeIntegers)
+                                           ctx->Const.NativeIntegers, &pm)
            || progress;
 
-         progress = lower_if_to_cond_assign(ir, options->MaxIfDepth) || progress;
+         progress = pm.track(lower_if_to_cond_assign(ir, options->MaxIfDepth)) || progress;
 
       } while (progress);
 
@@ -413,34 +413,34 @@ texfetch_funcs[] =
    FETCH_COMPRESSED(BPTC_RGB_UNSIGNED_FLOAT),
 
    /* ASTC compressed formats */
-   FETCH_NULL(RGBA_ASTC_4x4),
-   FETCH_NULL(RGBA_ASTC_5x4),
-   FETCH_NULL(RGBA_ASTC_5x5),
-   FETCH_NULL(RGBA_ASTC_6x5),
-   FETCH_NULL(RGBA_ASTC_6x6),
-   FETCH_NULL(RGBA_ASTC_8x5),
-   FETCH_NULL(RGBA_ASTC_8x6),
-   FETCH_NULL(RGBA_ASTC_8x8),
-   FETCH_NULL(RGBA_ASTC_10x5),
-   FETCH_NULL(RGBA_ASTC_10x6),
-   FETCH_NULL(RGBA_ASTC_10x8),
-   FETCH_NULL(RGBA_ASTC_10x10),
-   FETCH_NULL(RGBA_ASTC_12x10),
-   FETCH_NULL(RGBA_ASTC_12x12),
-   FETCH_NULL(SRGB8_ALPHA8_ASTC_4x4),
-   FETCH_NULL(SRGB8_ALPHA8_ASTC_5x4),
-   FETCH_NULL(SRGB8_ALPHA8_ASTC_5x5),
-   FETCH_NULL(SRGB8_ALPHA8_ASTC_6x5),
-   FETCH_NULL(SRGB8_ALPHA8_ASTC_6x6),
-   FETCH_NULL(SRGB8_ALPHA8_ASTC_8x5),
-   FETCH_NULL(SRGB8_ALPHA8_ASTC_8x6),
-   FETCH_NULL(SRGB8_ALPHA8_ASTC_8x8),
-   FETCH_NULL(SRGB8_ALPHA8_ASTC_10x5),
-   FETCH_NULL(SRGB8_ALPHA8_ASTC_10x6),
-   FETCH_NULL(SRGB8_ALPHA8_ASTC_10x8),
-   FETCH_NULL(SRGB8_ALPHA8_ASTC_10x10),
-   FETCH_NULL(SRGB8_ALPHA8_ASTC_12x10),
-   FETCH_NULL(SRGB8_ALPHA8_ASTC_12x12),
+   FETCH_COMPRESSED(RGBA_ASTC_4x4),
+   FETCH_COMPRESSED(RGBA_ASTC_5x4),
+   FETCH_COMPRESSED(RGBA_ASTC_5x5),
+   FETCH_COMPRESSED(RGBA_ASTC_6x5),
+   FETCH_COMPRESSED(RGBA_ASTC_6x6),
+   FETCH_COMPRESSED(RGBA_ASTC_8x5),
+   FETCH_COMPRESSED(RGBA_ASTC_8x6),
+   FETCH_COMPRESSED(RGBA_ASTC_8x8),
+   FETCH_COMPRESSED(RGBA_ASTC_10x5),
+   FETCH_COMPRESSED(RGBA_ASTC_10x6),
+   FETCH_COMPRESSED(RGBA_ASTC_10x8),
+   FETCH_COMPRESSED(RGBA_ASTC_10x10),
+   FETCH_COMPRESSED(RGBA_ASTC_12x10),
+   FETCH_COMPRESSED(RGBA_ASTC_12x12),
+   FETCH_COMPRESSED(SRGB8_ALPHA8_ASTC_4x4),
+   FETCH_COMPRESSED(SRGB8_ALPHA8_ASTC_5x4),
+   FETCH_COMPRESSED(SRGB8_ALPHA8_ASTC_5x5),
+   FETCH_COMPRESSED(SRGB8_ALPHA8_ASTC_6x5),
+   FETCH_COMPRESSED(SRGB8_ALPHA8_ASTC_6x6),
+   FETCH_COMPRESSED(SRGB8_ALPHA8_ASTC_8x5),
+   FETCH_COMPRESSED(SRGB8_ALPHA8_ASTC_8x6),
+   FETCH_COMPRESSED(SRGB8_ALPHA8_ASTC_8x8),
+   FETCH_COMPRESSED(SRGB8_ALPHA8_ASTC_10x5),
+   FETCH_COMPRESSED(SRGB8_ALPHA8_ASTC_10x6),
+   FETCH_COMPRESSED(SRGB8_ALPHA8_ASTC_10x8),
+   FETCH_COMPRESSED(SRGB8_ALPHA8_ASTC_10x10),
+   FETCH_COMPRESSED(SRGB8_ALPHA8_ASTC_12x10),
+   FETCH_COMPRESSED(SRGB8_ALPHA8_ASTC_12x12),
 
    FETCH_NULL(RGBA_ASTC_3x3x3),
    FETCH_NULL(RGBA_ASTC_4x3x3),
@@ -183,6 +183,12 @@ vbo_sizeof_ib_type(GLenum type)
 void
 vbo_delete_minmax_cache(struct gl_buffer_object *bufferObj);
 
+void
+vbo_minmax_buffer_sub_data(struct gl_context *ctx,
+                           struct gl_buffer_object *bufferObj,
+                           GLintptr offset, GLsizeiptr size,
+                           const GLvoid *data);
+
 void
 vbo_get_minmax_indices(struct gl_context *ctx, const struct _mesa_prim *prim,
                        const struct _mesa_index_buffer *ib,
@@ -203,6 +203,27 @@ vbo_get_default_vals_as_union(GLenum format)
 }
 
 
+/**
+ * Is the immediate mode VBO kept mapped between draws?
+ */
+static inline bool
+vbo_exec_buffer_is_persistent(const struct vbo_exec_context *exec)
+{
+   return (exec->vtx.bufferobj->StorageFlags & GL_MAP_PERSISTENT_BIT) != 0;
+}
+
+
+/**
+ * Size of the immediate mode vertex buffer in bytes.
+ */
+static inline unsigned
+vbo_exec_buffer_size(const struct vbo_exec_context *exec)
+{
+   return vbo_exec_buffer_is_persistent(exec) ?
+      VBO_VERT_BUFFER_SIZE_PERSISTENT : VBO_VERT_BUFFER_SIZE;
+}
+
+
 /**
  * Compute the max number of vertices which can be stored in
  * a vertex buffer, given the current vertex size, and the amount
@@ -211,7 +232,7 @@ vbo_get_default_vals_as_union(GLenum format)
 static inline unsigned
 vbo_compute_max_verts(const struct vbo_exec_context *exec)
 {
-   unsigned n = (VBO_VERT_BUFFER_SIZE - exec->vtx.buffer_used) /
+   unsigned n = (vbo_exec_buffer_size(exec) - exec->vtx.buffer_used) /
       (exec->vtx.vertex_size * sizeof(GLfloat));
    if (n == 0)
       return 0;
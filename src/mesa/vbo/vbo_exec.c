@@ -26,8 +26,10 @@
  */
 
 
+#include <inttypes.h>
 #include "main/api_arrayelt.h"
 #include "main/glheader.h"
+#include "main/imports.h"
 #include "main/mtypes.h"
 #include "main/vtxfmt.h"
 #include "vbo_context.h"
@@ -64,6 +66,13 @@ void vbo_exec_destroy( struct gl_context *ctx )
       ctx->aelt_context = NULL;
    }
 
+   if ((MESA_VERBOSE & VERBOSE_DRAW) && exec->stats.draws) {
+      _mesa_debug(ctx, "immediate mode: %" PRIu64 " draws, %" PRIu64
+                  " primitives, %.1f vertices per draw\n",
+                  exec->stats.draws, exec->stats.prims,
+                  (double) exec->stats.vertices / exec->stats.draws);
+   }
+
    vbo_exec_vtx_destroy( exec );
 }
 
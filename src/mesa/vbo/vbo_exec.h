@@ -43,7 +43,7 @@ USE OR OTHER DEALINGS IN THE SOFTWARE.
 /**
  * Max number of primitives (number of glBegin/End pairs) per VBO.
  */
-#define VBO_MAX_PRIM 64
+#define VBO_MAX_PRIM 256
 
 
 /**
@@ -51,6 +51,13 @@ USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #define VBO_VERT_BUFFER_SIZE (1024*64)	/* bytes */
 
+/**
+ * Size of the VBO when the driver supports persistent mappings.  Such a
+ * buffer stays mapped across draws, so it can be much larger than the
+ * one above without adding to the cost of each flush.
+ */
+#define VBO_VERT_BUFFER_SIZE_PERSISTENT (1024*1024)	/* bytes */
+
 
 /** Current vertex program mode */
 enum vp_mode {
@@ -95,6 +102,7 @@ struct vbo_exec_context
       fi_type *buffer_map;
       fi_type *buffer_ptr;              /* cursor, points into buffer */
       GLuint   buffer_used;             /* in bytes */
+      GLboolean use_persistent;         /**< map the VBO persistently? */
       fi_type vertex[VBO_ATTRIB_MAX*4]; /* current vertex */
 
       GLuint vert_count;   /**< Number of vertices currently in buffer */
@@ -136,6 +144,13 @@ struct vbo_exec_context
    /* Which flags to set in vbo_exec_begin_vertices() */
    GLbitfield begin_vertices_flags;
 
+   /** Immediate mode draw statistics, reported with MESA_VERBOSE=draw */
+   struct {
+      uint64_t draws;
+      uint64_t prims;
+      uint64_t vertices;
+   } stats;
+
 #ifdef DEBUG
    GLint flush_call_depth;
 #endif
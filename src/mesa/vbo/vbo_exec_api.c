@@ -43,6 +43,7 @@ USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "main/api_validate.h"
 #include "main/dispatch.h"
 #include "util/bitscan.h"
+#include "util/debug.h"
 
 #include "vbo_context.h"
 #include "vbo_noop.h"
@@ -1145,6 +1146,8 @@ void vbo_exec_vtx_init( struct vbo_exec_context *exec )
    assert(!exec->vtx.buffer_map);
    exec->vtx.buffer_map = _mesa_align_malloc(VBO_VERT_BUFFER_SIZE, 64);
    exec->vtx.buffer_ptr = exec->vtx.buffer_map;
+   exec->vtx.use_persistent =
+      !env_var_as_boolean("MESA_NO_PERSISTENT_IMMEDIATE", false);
 
    vbo_exec_vtxfmt_init( exec );
    _mesa_noop_vtxfmt_init(&exec->vtxfmt_noop);
@@ -235,11 +235,14 @@ vbo_exec_bind_arrays( struct gl_context *ctx )
          exec->vtx.inputs[attr] = &arrays[attr];
 
          if (_mesa_is_bufferobj(exec->vtx.bufferobj)) {
-            /* a real buffer obj: Ptr is an offset, not a pointer */
+            /* a real buffer obj: Ptr is an offset, not a pointer.  The
+             * vertices start at buffer_used, whether the buffer was mapped
+             * from there or is persistently mapped as a whole.
+             */
             assert(exec->vtx.bufferobj->Mappings[MAP_INTERNAL].Pointer);
             assert(offset >= 0);
             arrays[attr].Ptr = (GLubyte *)
-               exec->vtx.bufferobj->Mappings[MAP_INTERNAL].Offset + offset;
+               (GLintptr) exec->vtx.buffer_used + offset;
          }
          else {
             /* Ptr into ordinary app memory */
@@ -269,14 +272,17 @@ vbo_exec_bind_arrays( struct gl_context *ctx )
 
 /**
  * Unmap the VBO.  This is called before drawing.
+ * A persistent mapping is left in place, only the range holding the
+ * vertices to draw is retired.
  */
 static void
 vbo_exec_vtx_unmap( struct vbo_exec_context *exec )
 {
    if (_mesa_is_bufferobj(exec->vtx.bufferobj)) {
       struct gl_context *ctx = exec->ctx;
+      const bool persistent = vbo_exec_buffer_is_persistent(exec);
 
-      if (ctx->Driver.FlushMappedBufferRange) {
+      if (!persistent && ctx->Driver.FlushMappedBufferRange) {
          GLintptr offset = exec->vtx.buffer_used -
                            exec->vtx.bufferobj->Mappings[MAP_INTERNAL].Offset;
          GLsizeiptr length = (exec->vtx.buffer_ptr - exec->vtx.buffer_map) *
@@ -291,10 +297,11 @@ vbo_exec_vtx_unmap( struct vbo_exec_context *exec )
       exec->vtx.buffer_used += (exec->vtx.buffer_ptr -
                                 exec->vtx.buffer_map) * sizeof(float);
 
-      assert(exec->vtx.buffer_used <= VBO_VERT_BUFFER_SIZE);
+      assert(exec->vtx.buffer_used <= vbo_exec_buffer_size(exec));
       assert(exec->vtx.buffer_ptr != NULL);
 
-      ctx->Driver.UnmapBuffer(ctx, exec->vtx.bufferobj, MAP_INTERNAL);
+      if (!persistent)
+         ctx->Driver.UnmapBuffer(ctx, exec->vtx.bufferobj, MAP_INTERNAL);
       exec->vtx.buffer_map = NULL;
       exec->vtx.buffer_ptr = NULL;
       exec->vtx.max_vert = 0;
@@ -304,6 +311,10 @@ vbo_exec_vtx_unmap( struct vbo_exec_context *exec )
 
 /**
  * Map the vertex buffer to begin storing glVertex, glColor, etc data.
+ *
+ * If the driver supports persistent mappings, the buffer is mapped once
+ * when its storage is allocated and stays mapped until it is full, so
+ * flushing the vertices for a state change doesn't cost a map/unmap pair.
  */
 void
 vbo_exec_vtx_map( struct vbo_exec_context *exec )
@@ -314,7 +325,14 @@ vbo_exec_vtx_map( struct vbo_exec_context *exec )
                               GL_MAP_UNSYNCHRONIZED_BIT |
                               GL_MAP_FLUSH_EXPLICIT_BIT |
                               MESA_MAP_NOWAIT_BIT;
+   const GLenum accessPersistent = GL_MAP_WRITE_BIT |
+                                   GL_MAP_PERSISTENT_BIT |
+                                   GL_MAP_COHERENT_BIT |
+                                   GL_MAP_UNSYNCHRONIZED_BIT;
    const GLenum usage = GL_STREAM_DRAW_ARB;
+   struct gl_buffer_mapping *mapping;
+   GLuint size;
+   bool persistent;
 
    if (!_mesa_is_bufferobj(exec->vtx.bufferobj))
       return;
@@ -322,14 +340,26 @@ vbo_exec_vtx_map( struct vbo_exec_context *exec )
    assert(!exec->vtx.buffer_map);
    assert(!exec->vtx.buffer_ptr);
 
-   if (VBO_VERT_BUFFER_SIZE > exec->vtx.buffer_used + 1024) {
+   mapping = &exec->vtx.bufferobj->Mappings[MAP_INTERNAL];
+   size = vbo_exec_buffer_size(exec);
+   persistent = vbo_exec_buffer_is_persistent(exec);
+
+   if (size > exec->vtx.buffer_used + 1024) {
       /* The VBO exists and there's room for more */
-      if (exec->vtx.bufferobj->Size > 0) {
+      if (mapping->Pointer) {
+         /* still persistently mapped */
+         exec->vtx.buffer_map = (fi_type *)
+            ((GLubyte *) mapping->Pointer +
+             (exec->vtx.buffer_used - mapping->Offset));
+      }
+      else if (exec->vtx.bufferobj->Size > 0) {
          exec->vtx.buffer_map =
             (fi_type *)ctx->Driver.MapBufferRange(ctx,
                                                   exec->vtx.buffer_used,
-                                                  (VBO_VERT_BUFFER_SIZE - 
+                                                  (size -
                                                    exec->vtx.buffer_used),
+                                                  persistent ?
+                                                  accessPersistent :
                                                   accessRange,
                                                   exec->vtx.bufferobj,
                                                   MAP_INTERNAL);
@@ -342,19 +372,33 @@ vbo_exec_vtx_map( struct vbo_exec_context *exec )
 
    if (!exec->vtx.buffer_map) {
       /* Need to allocate a new VBO */
+      persistent = exec->vtx.use_persistent &&
+                   ctx->Extensions.ARB_buffer_storage;
+      size = persistent ? VBO_VERT_BUFFER_SIZE_PERSISTENT :
+                          VBO_VERT_BUFFER_SIZE;
+
+      /* the old storage may still be persistently mapped */
+      if (_mesa_bufferobj_mapped(exec->vtx.bufferobj, MAP_INTERNAL))
+         ctx->Driver.UnmapBuffer(ctx, exec->vtx.bufferobj, MAP_INTERNAL);
+
       exec->vtx.buffer_used = 0;
 
       if (ctx->Driver.BufferData(ctx, GL_ARRAY_BUFFER_ARB,
-                                 VBO_VERT_BUFFER_SIZE,
+                                 size,
                                  NULL, usage,
                                  GL_MAP_WRITE_BIT |
                                  GL_DYNAMIC_STORAGE_BIT |
-                                 GL_CLIENT_STORAGE_BIT,
+                                 GL_CLIENT_STORAGE_BIT |
+                                 (persistent ?
+                                  GL_MAP_PERSISTENT_BIT |
+                                  GL_MAP_COHERENT_BIT : 0),
                                  exec->vtx.bufferobj)) {
          /* buffer allocation worked, now map the buffer */
          exec->vtx.buffer_map =
             (fi_type *)ctx->Driver.MapBufferRange(ctx,
-                                                  0, VBO_VERT_BUFFER_SIZE,
+                                                  0, size,
+                                                  persistent ?
+                                                  accessPersistent :
                                                   accessRange,
                                                   exec->vtx.bufferobj,
                                                   MAP_INTERNAL);
@@ -430,6 +474,10 @@ vbo_exec_vtx_flush(struct vbo_exec_context *exec, GLboolean keepUnmapped)
 				       exec->vtx.vert_count - 1,
 				       NULL, 0, NULL);
 
+         exec->stats.draws++;
+         exec->stats.prims += exec->vtx.prim_count;
+         exec->stats.vertices += exec->vtx.vert_count;
+
 	 /* If using a real VBO, get new storage -- unless asked not to.
           */
          if (_mesa_is_bufferobj(exec->vtx.bufferobj) && !keepUnmapped) {
@@ -31,8 +31,24 @@
 #include "main/varray.h"
 #include "main/macros.h"
 #include "main/sse_minmax.h"
+#include "main/avx2_minmax.h"
 #include "x86/common_x86_asm.h"
 #include "util/hash_table.h"
+#include "util/thread_pool.h"
+#include "vbo.h"
+
+
+/**
+ * Granularity in bytes of the per-block min/max of a buffer object, and of
+ * the pieces that scans are split into.
+ */
+#define MINMAX_BLOCK_SIZE 4096
+
+/** Number of blocks scanned by one job on the worker threads. */
+#define MINMAX_BLOCKS_PER_JOB 64
+
+/** Scans of at least this many bytes are spread over the worker threads. */
+#define MINMAX_THREADED_SIZE (1024 * 1024)
 
 
 struct minmax_cache_key {
@@ -49,6 +65,59 @@ struct minmax_cache_entry {
 };
 
 
+/**
+ * Min/max of every MINMAX_BLOCK_SIZE bytes of a buffer object, for one
+ * index type and primitive restart setting.
+ *
+ * The hash table above only helps when the very same range is drawn again.
+ * The blocks are shared by all draws from the buffer, so a draw only has to
+ * scan the blocks which aren't known yet and its partial first and last
+ * block.  glBufferSubData() recomputes the blocks it overwrites completely
+ * from the new data, instead of throwing everything away.
+ */
+struct vbo_minmax_blocks {
+   GLenum type;
+   bool restart;
+   GLuint restart_index;
+   unsigned num_blocks;
+   GLuint *min;
+   GLuint *max;
+   GLubyte *valid;
+};
+
+
+/**
+ * A scan of the bytes [start, end) of an index buffer, whose mapping
+ * starts at \c map.  Without blocks, start is zero and the offsets are
+ * relative to the first index.
+ */
+struct minmax_scan {
+   const GLubyte *map;
+   GLintptr start;
+   GLintptr end;
+   unsigned index_size;
+   bool restart;
+   GLuint restart_index;
+
+   /** Blocks to look up and fill in, or NULL */
+   struct vbo_minmax_blocks *blocks;
+
+   /**
+    * Don't look up the blocks, but recompute the blocks which are
+    * completely inside the range and invalidate the others.
+    */
+   bool update;
+
+   unsigned first_block;
+   unsigned num_blocks;
+
+   /** Results of each job */
+   GLuint *job_min;
+   GLuint *job_max;
+   GLuint *job_cached_bytes;
+};
+
+
 static uint32_t
 vbo_minmax_cache_hash(const struct minmax_cache_key *key)
 {
@@ -96,6 +165,24 @@ vbo_delete_minmax_cache(struct gl_buffer_object *bufferObj)
 {
    _mesa_hash_table_destroy(bufferObj->MinMaxCache, vbo_minmax_cache_delete_entry);
    bufferObj->MinMaxCache = NULL;
+   free(bufferObj->MinMaxBlocks);
+   bufferObj->MinMaxBlocks = NULL;
+}
+
+
+/**
+ * Forget everything known about the contents of the buffer.
+ * Called with the buffer mutex held.
+ */
+static void
+vbo_minmax_cache_invalidate(struct gl_buffer_object *bufferObj)
+{
+   if (bufferObj->MinMaxCache)
+      _mesa_hash_table_clear(bufferObj->MinMaxCache,
+                             vbo_minmax_cache_delete_entry);
+   if (bufferObj->MinMaxBlocks)
+      memset(bufferObj->MinMaxBlocks->valid, 0,
+             bufferObj->MinMaxBlocks->num_blocks);
 }
 
 
@@ -132,7 +219,7 @@ vbo_get_minmax_cached(struct gl_buffer_object *bufferObj,
          goto out_disable;
       }
 
-      _mesa_hash_table_clear(bufferObj->MinMaxCache, vbo_minmax_cache_delete_entry);
+      vbo_minmax_cache_invalidate(bufferObj);
       bufferObj->MinMaxCacheDirty = false;
       goto out_invalidate;
    }
@@ -226,6 +313,254 @@ out:
 }
 
 
+/**
+ * Return the blocks of the buffer for the given index type and restart
+ * setting, or NULL.  Called with the buffer mutex held.
+ */
+static struct vbo_minmax_blocks *
+vbo_get_minmax_blocks(struct gl_buffer_object *bufferObj, GLenum type,
+                      bool restart, GLuint restart_index)
+{
+   const unsigned num_blocks = DIV_ROUND_UP(bufferObj->Size,
+                                            MINMAX_BLOCK_SIZE);
+   struct vbo_minmax_blocks *blocks = bufferObj->MinMaxBlocks;
+
+   if (!restart)
+      restart_index = 0;
+
+   /* The hash table may not exist yet, so vbo_get_minmax_cached() can't
+    * have cleaned up after a change to the buffer.
+    */
+   if (bufferObj->MinMaxCacheDirty) {
+      vbo_minmax_cache_invalidate(bufferObj);
+      bufferObj->MinMaxCacheDirty = false;
+   }
+
+   if (!blocks || blocks->num_blocks != num_blocks) {
+      free(blocks);
+      blocks = malloc(sizeof(*blocks) +
+                      num_blocks * (2 * sizeof(GLuint) + sizeof(GLubyte)));
+      bufferObj->MinMaxBlocks = blocks;
+      if (!blocks)
+         return NULL;
+
+      blocks->num_blocks = num_blocks;
+      blocks->min = (GLuint *) (blocks + 1);
+      blocks->max = blocks->min + num_blocks;
+      blocks->valid = (GLubyte *) (blocks->max + num_blocks);
+      memset(blocks->valid, 0, num_blocks);
+   }
+   else if (blocks->type != type ||
+            blocks->restart != restart ||
+            blocks->restart_index != restart_index) {
+      memset(blocks->valid, 0, num_blocks);
+   }
+
+   blocks->type = type;
+   blocks->restart = restart;
+   blocks->restart_index = restart_index;
+   return blocks;
+}
+
+
+/**
+ * Compute the min and max of \p count indices of \p index_size bytes.
+ * If \p restart is set, \p restart_index is ignored.
+ */
+static void
+vbo_scan_indices(const void *indices, unsigned index_size, GLuint count,
+                 bool restart, GLuint restart_index,
+                 GLuint *min_index, GLuint *max_index)
+{
+   GLuint min_val = ~0U;
+   GLuint max_val = 0;
+   GLuint i;
+
+#if defined(USE_AVX2)
+   if (cpu_has_avx2) {
+      _mesa_avx2_index_min_max(indices, index_size, count,
+                               restart, restart_index, min_index, max_index);
+      return;
+   }
+#endif
+#if defined(USE_SSE41)
+   if (cpu_has_sse4_1) {
+      _mesa_sse41_index_min_max(indices, index_size, count,
+                                restart, restart_index, min_index, max_index);
+      return;
+   }
+#endif
+
+   switch (index_size) {
+   case 4: {
+      const GLuint *ui_indices = (const GLuint *)indices;
+      for (i = 0; i < count; i++) {
+         if (restart && ui_indices[i] == restart_index)
+            continue;
+         if (ui_indices[i] > max_val) max_val = ui_indices[i];
+         if (ui_indices[i] < min_val) min_val = ui_indices[i];
+      }
+      break;
+   }
+   case 2: {
+      const GLushort *us_indices = (const GLushort *)indices;
+      for (i = 0; i < count; i++) {
+         if (restart && us_indices[i] == restart_index)
+            continue;
+         if (us_indices[i] > max_val) max_val = us_indices[i];
+         if (us_indices[i] < min_val) min_val = us_indices[i];
+      }
+      break;
+   }
+   case 1: {
+      const GLubyte *ub_indices = (const GLubyte *)indices;
+      for (i = 0; i < count; i++) {
+         if (restart && ub_indices[i] == restart_index)
+            continue;
+         if (ub_indices[i] > max_val) max_val = ub_indices[i];
+         if (ub_indices[i] < min_val) min_val = ub_indices[i];
+      }
+      break;
+   }
+   default:
+      unreachable("not reached");
+   }
+
+   *min_index = min_val;
+   *max_index = max_val;
+}
+
+
+/**
+ * Scan the blocks of one job, see vbo_scan_range().
+ */
+static void
+vbo_scan_job(void *data, unsigned job)
+{
+   struct minmax_scan *scan = data;
+   struct vbo_minmax_blocks *blocks = scan->blocks;
+   const unsigned first = scan->first_block + job * MINMAX_BLOCKS_PER_JOB;
+   const unsigned last = MIN2(first + MINMAX_BLOCKS_PER_JOB,
+                              scan->first_block + scan->num_blocks);
+   GLuint min_val = ~0U;
+   GLuint max_val = 0;
+   GLuint cached_bytes = 0;
+   unsigned b;
+
+   for (b = first; b < last; b++) {
+      const GLintptr block_start = (GLintptr) b * MINMAX_BLOCK_SIZE;
+      const GLintptr block_end = block_start + MINMAX_BLOCK_SIZE;
+      const GLintptr lo = MAX2(scan->start, block_start);
+      const GLintptr hi = MIN2(scan->end, block_end);
+      const bool whole = lo == block_start && hi == block_end;
+      GLuint block_min, block_max;
+
+      if (scan->update) {
+         if (whole) {
+            vbo_scan_indices(scan->map + (lo - scan->start),
+                             scan->index_size,
+                             MINMAX_BLOCK_SIZE / scan->index_size,
+                             scan->restart, scan->restart_index,
+                             &blocks->min[b], &blocks->max[b]);
+         }
+         blocks->valid[b] = whole;
+         continue;
+      }
+
+      if (blocks && whole && blocks->valid[b]) {
+         block_min = blocks->min[b];
+         block_max = blocks->max[b];
+         cached_bytes += MINMAX_BLOCK_SIZE;
+      } else {
+         vbo_scan_indices(scan->map + (lo - scan->start), scan->index_size,
+                          (hi - lo) / scan->index_size,
+                          scan->restart, scan->restart_index,
+                          &block_min, &block_max);
+         if (blocks && whole) {
+            blocks->min[b] = block_min;
+            blocks->max[b] = block_max;
+            blocks->valid[b] = 1;
+         }
+      }
+
+      min_val = MIN2(min_val, block_min);
+      max_val = MAX2(max_val, block_max);
+   }
+
+   scan->job_min[job] = min_val;
+   scan->job_max[job] = max_val;
+   scan->job_cached_bytes[job] = cached_bytes;
+}
+
+
+/**
+ * Scan the range described by \p scan block by block, on the worker
+ * threads if the range is large.
+ *
+ * \return the number of bytes whose min/max came from the blocks
+ */
+static GLuint
+vbo_scan_range(struct gl_context *ctx, struct minmax_scan *scan,
+               GLuint *min_index, GLuint *max_index)
+{
+   GLuint job_min[16], job_max[16], job_cached_bytes[16];
+   struct thread_pool *pool = NULL;
+   unsigned num_jobs, j;
+   GLuint cached_bytes = 0;
+
+   *min_index = ~0U;
+   *max_index = 0;
+
+   if (scan->end <= scan->start)
+      return 0;
+
+   scan->first_block = scan->start / MINMAX_BLOCK_SIZE;
+   scan->num_blocks = DIV_ROUND_UP(scan->end, MINMAX_BLOCK_SIZE) -
+                      scan->first_block;
+   num_jobs = DIV_ROUND_UP(scan->num_blocks, MINMAX_BLOCKS_PER_JOB);
+
+   if (num_jobs <= ARRAY_SIZE(job_min)) {
+      scan->job_min = job_min;
+      scan->job_max = job_max;
+      scan->job_cached_bytes = job_cached_bytes;
+   } else {
+      scan->job_min = malloc(3 * num_jobs * sizeof(GLuint));
+      if (!scan->job_min) {
+         /* Do it the simple way, without the blocks. */
+         if (!scan->update) {
+            vbo_scan_indices(scan->map, scan->index_size,
+                             (scan->end - scan->start) / scan->index_size,
+                             scan->restart, scan->restart_index,
+                             min_index, max_index);
+         } else {
+            memset(scan->blocks->valid, 0, scan->blocks->num_blocks);
+         }
+         return 0;
+      }
+      scan->job_max = scan->job_min + num_jobs;
+      scan->job_cached_bytes = scan->job_max + num_jobs;
+   }
+
+   if (ctx && scan->end - scan->start >= MINMAX_THREADED_SIZE)
+      pool = _mesa_get_worker_threads(ctx);
+
+   thread_pool_parallel_for(pool, num_jobs, vbo_scan_job, scan);
+
+   if (!scan->update) {
+      for (j = 0; j < num_jobs; j++) {
+         *min_index = MIN2(*min_index, scan->job_min[j]);
+         *max_index = MAX2(*max_index, scan->job_max[j]);
+         cached_bytes += scan->job_cached_bytes[j];
+      }
+   }
+
+   if (scan->job_min != job_min)
+      free(scan->job_min);
+
+   return cached_bytes;
+}
+
+
 /**
  * Compute min and max elements by scanning the index buffer for
  * glDraw[Range]Elements() calls.
@@ -242,106 +577,123 @@ vbo_get_minmax_index(struct gl_context *ctx,
    const GLboolean restart = ctx->Array._PrimitiveRestart;
    const GLuint restartIndex = _mesa_primitive_restart_index(ctx, ib->type);
    const int index_size = vbo_sizeof_ib_type(ib->type);
+   struct gl_buffer_object *bufferObj = ib->obj;
+   struct minmax_scan scan;
    const char *indices;
-   GLuint i;
+   GLintptr offset = 0;
+
+   memset(&scan, 0, sizeof(scan));
+   scan.index_size = index_size;
+   scan.restart = restart;
+   scan.restart_index = restartIndex;
+   scan.end = (GLintptr) count * index_size;
 
    indices = (char *) ib->ptr + prim->start * index_size;
-   if (_mesa_is_bufferobj(ib->obj)) {
-      GLsizeiptr size = MIN2(count * index_size, ib->obj->Size);
+   if (_mesa_is_bufferobj(bufferObj)) {
+      GLsizeiptr size = MIN2(count * index_size, bufferObj->Size);
 
-      if (vbo_get_minmax_cached(ib->obj, ib->type, (GLintptr) indices, count,
+      offset = (GLintptr) indices;
+      if (vbo_get_minmax_cached(bufferObj, ib->type, offset, count,
                                 min_index, max_index))
          return;
 
-      indices = ctx->Driver.MapBufferRange(ctx, (GLintptr) indices, size,
-                                           GL_MAP_READ_BIT, ib->obj,
+      indices = ctx->Driver.MapBufferRange(ctx, offset, size,
+                                           GL_MAP_READ_BIT, bufferObj,
                                            MAP_INTERNAL);
-   }
 
-   switch (ib->type) {
-   case GL_UNSIGNED_INT: {
-      const GLuint *ui_indices = (const GLuint *)indices;
-      GLuint max_ui = 0;
-      GLuint min_ui = ~0U;
-      if (restart) {
-         for (i = 0; i < count; i++) {
-            if (ui_indices[i] != restartIndex) {
-               if (ui_indices[i] > max_ui) max_ui = ui_indices[i];
-               if (ui_indices[i] < min_ui) min_ui = ui_indices[i];
-            }
-         }
-      }
-      else {
-#if defined(USE_SSE41)
-         if (cpu_has_sse4_1) {
-            _mesa_uint_array_min_max(ui_indices, &min_ui, &max_ui, count);
+      /* Use the blocks if they line up with the indices. */
+      if (offset % index_size == 0 &&
+          offset + scan.end <= bufferObj->Size &&
+          vbo_use_minmax_cache(bufferObj)) {
+         mtx_lock(&bufferObj->Mutex);
+         scan.blocks = vbo_get_minmax_blocks(bufferObj, ib->type,
+                                             restart, restartIndex);
+         if (scan.blocks) {
+            scan.start = offset;
+            scan.end += offset;
+         } else {
+            mtx_unlock(&bufferObj->Mutex);
          }
-         else
-#endif
-            for (i = 0; i < count; i++) {
-               if (ui_indices[i] > max_ui) max_ui = ui_indices[i];
-               if (ui_indices[i] < min_ui) min_ui = ui_indices[i];
-            }
       }
-      *min_index = min_ui;
-      *max_index = max_ui;
-      break;
    }
-   case GL_UNSIGNED_SHORT: {
-      const GLushort *us_indices = (const GLushort *)indices;
-      GLuint max_us = 0;
-      GLuint min_us = ~0U;
-      if (restart) {
-         for (i = 0; i < count; i++) {
-            if (us_indices[i] != restartIndex) {
-               if (us_indices[i] > max_us) max_us = us_indices[i];
-               if (us_indices[i] < min_us) min_us = us_indices[i];
-            }
-         }
-      }
-      else {
-         for (i = 0; i < count; i++) {
-            if (us_indices[i] > max_us) max_us = us_indices[i];
-            if (us_indices[i] < min_us) min_us = us_indices[i];
-         }
-      }
-      *min_index = min_us;
-      *max_index = max_us;
-      break;
+
+   scan.map = (const GLubyte *) indices;
+
+   if (scan.blocks) {
+      const GLuint cached = vbo_scan_range(ctx, &scan, min_index, max_index);
+      unsigned new_hit_count =
+         bufferObj->MinMaxCacheHitIndices + cached / index_size;
+
+      /* Indices found in the blocks count as hits, see
+       * vbo_get_minmax_cached().
+       */
+      if (new_hit_count >= bufferObj->MinMaxCacheHitIndices)
+         bufferObj->MinMaxCacheHitIndices = new_hit_count;
+      else
+         bufferObj->MinMaxCacheHitIndices = ~(unsigned)0;
+
+      mtx_unlock(&bufferObj->Mutex);
+   } else {
+      vbo_scan_range(ctx, &scan, min_index, max_index);
    }
-   case GL_UNSIGNED_BYTE: {
-      const GLubyte *ub_indices = (const GLubyte *)indices;
-      GLuint max_ub = 0;
-      GLuint min_ub = ~0U;
-      if (restart) {
-         for (i = 0; i < count; i++) {
-            if (ub_indices[i] != restartIndex) {
-               if (ub_indices[i] > max_ub) max_ub = ub_indices[i];
-               if (ub_indices[i] < min_ub) min_ub = ub_indices[i];
-            }
-         }
-      }
-      else {
-         for (i = 0; i < count; i++) {
-            if (ub_indices[i] > max_ub) max_ub = ub_indices[i];
-            if (ub_indices[i] < min_ub) min_ub = ub_indices[i];
-         }
-      }
-      *min_index = min_ub;
-      *max_index = max_ub;
-      break;
+
+   if (_mesa_is_bufferobj(bufferObj)) {
+      vbo_minmax_cache_store(ctx, bufferObj, ib->type, offset, count,
+                             *min_index, *max_index);
+      ctx->Driver.UnmapBuffer(ctx, bufferObj, MAP_INTERNAL);
    }
-   default:
-      unreachable("not reached");
+}
+
+
+/**
+ * Called by glBufferSubData() before the new data is written.  The hash
+ * table entries are dropped, and the blocks which are overwritten
+ * completely are computed from \p data, so that the next draw doesn't have
+ * to map and scan them.
+ */
+void
+vbo_minmax_buffer_sub_data(struct gl_context *ctx,
+                           struct gl_buffer_object *bufferObj,
+                           GLintptr offset, GLsizeiptr size,
+                           const GLvoid *data)
+{
+   struct minmax_scan scan;
+   GLuint min_index, max_index;
+
+   if (!bufferObj->MinMaxBlocks || !data) {
+      bufferObj->MinMaxCacheDirty = true;
+      return;
    }
 
-   if (_mesa_is_bufferobj(ib->obj)) {
-      vbo_minmax_cache_store(ctx, ib->obj, ib->type, prim->start, count,
-                             *min_index, *max_index);
-      ctx->Driver.UnmapBuffer(ctx, ib->obj, MAP_INTERNAL);
+   mtx_lock(&bufferObj->Mutex);
+
+   /* Nothing to keep up to date if all of it is going to be thrown away. */
+   if (bufferObj->MinMaxCacheDirty || !bufferObj->MinMaxBlocks ||
+       !vbo_use_minmax_cache(bufferObj)) {
+      bufferObj->MinMaxCacheDirty = true;
+      goto out;
    }
+
+   if (bufferObj->MinMaxCache)
+      _mesa_hash_table_clear(bufferObj->MinMaxCache,
+                             vbo_minmax_cache_delete_entry);
+
+   memset(&scan, 0, sizeof(scan));
+   scan.blocks = bufferObj->MinMaxBlocks;
+   scan.map = data;
+   scan.start = offset;
+   scan.end = offset + size;
+   scan.index_size = vbo_sizeof_ib_type(scan.blocks->type);
+   scan.restart = scan.blocks->restart;
+   scan.restart_index = scan.blocks->restart_index;
+   scan.update = true;
+   vbo_scan_range(ctx, &scan, &min_index, &max_index);
+
+out:
+   mtx_unlock(&bufferObj->Mutex);
 }
 
+
 /**
  * Compute min and max elements for nr_prims
  */
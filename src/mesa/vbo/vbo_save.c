@@ -84,7 +84,7 @@ void vbo_save_destroy( struct gl_context *ctx )
 
    if (save->prim_store) {
       if ( --save->prim_store->refcount == 0 ) {
-         free(save->prim_store);
+         vbo_save_free_prim_store(save->prim_store);
          save->prim_store = NULL;
       }
       if ( --save->vertex_store->refcount == 0 ) {
@@ -98,6 +98,12 @@ struct vbo_save_vertex_list {
  */
 #define VBO_SAVE_BUFFER_SIZE (8*1024) /* dwords */
 #define VBO_SAVE_PRIM_SIZE   128
+
+/* Vertex lists which follow each other are merged into buffers of up to
+ * this size when the display list is finished, see
+ * vbo_merge_vertex_lists().
+ */
+#define VBO_SAVE_MERGED_BUFFER_SIZE (4*1024*1024) /* dwords */
 #define VBO_SAVE_PRIM_MODE_MASK         0x3f
 #define VBO_SAVE_PRIM_WEAK              0x40
 #define VBO_SAVE_PRIM_NO_CURRENT_UPDATE 0x80
@@ -114,7 +120,8 @@ struct vbo_save_vertex_store {
 };
 
 struct vbo_save_primitive_store {
-   struct _mesa_prim buffer[VBO_SAVE_PRIM_SIZE];
+   struct _mesa_prim *buffer;
+   GLuint size;
    GLuint used;
    GLuint refcount;
 };
@@ -181,6 +188,9 @@ void vbo_save_playback_vertex_list( struct gl_context *ctx, void *data );
 
 void vbo_save_api_init( struct vbo_save_context *save );
 
+void
+vbo_save_free_prim_store(struct vbo_save_primitive_store *prim_store);
+
 fi_type *
 vbo_save_map_vertex_store(struct gl_context *ctx,
                           struct vbo_save_vertex_store *vertex_store);
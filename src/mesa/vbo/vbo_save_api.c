@@ -293,17 +293,33 @@ vbo_save_unmap_vertex_store(struct gl_context *ctx,
 
 
 static struct vbo_save_primitive_store *
-alloc_prim_store(struct gl_context *ctx)
+alloc_prim_store(struct gl_context *ctx, GLuint size)
 {
    struct vbo_save_primitive_store *store =
       CALLOC_STRUCT(vbo_save_primitive_store);
    (void) ctx;
+   if (!store)
+      return NULL;
+   store->buffer = calloc(size, sizeof(struct _mesa_prim));
+   if (!store->buffer) {
+      free(store);
+      return NULL;
+   }
+   store->size = size;
    store->used = 0;
    store->refcount = 1;
    return store;
 }
 
 
+void
+vbo_save_free_prim_store(struct vbo_save_primitive_store *prim_store)
+{
+   free(prim_store->buffer);
+   free(prim_store);
+}
+
+
 static void
 _save_reset_counters(struct gl_context *ctx)
 {
@@ -541,7 +557,7 @@ _save_compile_vertex_list(struct gl_context *ctx)
    if (save->prim_store->used > VBO_SAVE_PRIM_SIZE - 6) {
       save->prim_store->refcount--;
       assert(save->prim_store->refcount != 0);
-      save->prim_store = alloc_prim_store(ctx);
+      save->prim_store = alloc_prim_store(ctx, VBO_SAVE_PRIM_SIZE);
    }
 
    /* Reset our structures for the next run of vertices:
@@ -1509,7 +1525,7 @@ vbo_save_NewList(struct gl_context *ctx, GLuint list, GLenum mode)
    (void) mode;
 
    if (!save->prim_store)
-      save->prim_store = alloc_prim_store(ctx);
+      save->prim_store = alloc_prim_store(ctx, VBO_SAVE_PRIM_SIZE);
 
    if (!save->vertex_store)
       save->vertex_store = alloc_vertex_store(ctx);
@@ -1588,13 +1604,200 @@ vbo_destroy_vertex_list(struct gl_context *ctx, void *data)
       free_vertex_store(ctx, node->vertex_store);
 
    if (--node->prim_store->refcount == 0)
-      free(node->prim_store);
+      vbo_save_free_prim_store(node->prim_store);
 
    free(node->current_data);
    node->current_data = NULL;
 }
 
 
+/**
+ * Can vertex list b, which directly follows a in a display list, be drawn
+ * together with a?  If so, return the number of vertices at the start of
+ * b which repeat the end of a primitive that was split between the two
+ * lists, and which must be dropped to join the parts again.
+ *
+ * \return ~0 if the lists can't be merged
+ */
+static GLuint
+vertex_list_join(const struct vbo_save_vertex_list *a,
+                 const struct vbo_save_vertex_list *b)
+{
+   const struct _mesa_prim *pa, *pb;
+   GLuint i;
+
+   if (a->enabled != b->enabled ||
+       a->vertex_size != b->vertex_size ||
+       a->current_size != b->current_size ||
+       memcmp(a->attrsz, b->attrsz, sizeof(a->attrsz)) != 0 ||
+       memcmp(a->attrtype, b->attrtype, sizeof(a->attrtype)) != 0)
+      return ~0u;
+
+   /* Lists with dangling references are replayed through the loopback
+    * path, which replays each list on its own.
+    */
+   if (a->dangling_attr_ref || b->dangling_attr_ref ||
+       a->count == 0 || b->count == 0 ||
+       a->prim_count == 0 || b->prim_count == 0)
+      return ~0u;
+
+   /* The loopback path discards weak primitives inside Begin/End. */
+   for (i = 0; i < a->prim_count; i++) {
+      if (a->prim[i].weak)
+         return ~0u;
+   }
+   for (i = 0; i < b->prim_count; i++) {
+      if (b->prim[i].weak)
+         return ~0u;
+   }
+
+   pa = &a->prim[a->prim_count - 1];
+   pb = &b->prim[0];
+
+   if (pa->end)
+      return pb->begin && b->wrap_count == 0 ? 0 : ~0u;
+
+   /* The primitive was split because the vertex store filled up, and
+    * _save_copy_vertices() repeated its last vertices at the start of b.
+    */
+   if (pb->begin ||
+       pb->mode != pa->mode ||
+       pa->start + pa->count != a->count ||
+       pb->start > b->wrap_count ||
+       b->wrap_count > pb->start + pb->count)
+      return ~0u;
+
+   return b->wrap_count;
+}
+
+
+/**
+ * Called at EndList time for a run of vertex lists which follow each other
+ * in the display list with nothing in between.  Copy the vertices of as
+ * many of them as possible to one new buffer and replace data[0] with a
+ * vertex list drawing all of them, which saves binding the vertex arrays
+ * and validating state for each list on replay, and lets merge_prims()
+ * combine primitives across the old list boundaries.
+ *
+ * \return the number of lists merged into data[0], the others are
+ *         destroyed by the caller
+ */
+static GLuint
+vbo_merge_vertex_lists(struct gl_context *ctx, void **data, GLuint count)
+{
+   struct vbo_save_vertex_list **nodes =
+      (struct vbo_save_vertex_list **) data;
+   struct vbo_save_vertex_list *first = nodes[0], *last, merged;
+   struct vbo_save_vertex_store *vertex_store = NULL;
+   struct vbo_save_primitive_store *prim_store = NULL;
+   const GLuint vertex_size = first->vertex_size;
+   GLuint num_verts = first->count, num_prims = first->prim_count;
+   fi_type *buffer = NULL;
+   GLuint n, i, j;
+
+   for (n = 1; n < count; n++) {
+      const GLuint skip = vertex_list_join(nodes[n - 1], nodes[n]);
+
+      if (skip == ~0u ||
+          (num_verts + nodes[n]->count - skip) * vertex_size >
+          VBO_SAVE_MERGED_BUFFER_SIZE)
+         break;
+
+      num_verts += nodes[n]->count - skip;
+      num_prims += nodes[n]->prim_count;
+   }
+
+   if (n == 1)
+      return 1;
+
+   last = nodes[n - 1];
+
+   vertex_store = CALLOC_STRUCT(vbo_save_vertex_store);
+   prim_store = alloc_prim_store(ctx, num_prims);
+   buffer = malloc(num_verts * vertex_size * sizeof(GLfloat));
+   if (!vertex_store || !prim_store || !buffer)
+      goto fail;
+
+   num_verts = 0;
+   num_prims = 0;
+
+   for (i = 0; i < n; i++) {
+      const struct vbo_save_vertex_list *node = nodes[i];
+      const GLuint skip = i ? vertex_list_join(nodes[i - 1], node) : 0;
+
+      ctx->Driver.GetBufferSubData(ctx,
+                                   node->buffer_offset +
+                                   skip * vertex_size * sizeof(GLfloat),
+                                   (node->count - skip) * vertex_size *
+                                   sizeof(GLfloat),
+                                   buffer + num_verts * vertex_size,
+                                   node->vertex_store->bufferobj);
+
+      for (j = 0; j < node->prim_count; j++) {
+         struct _mesa_prim prim = node->prim[j];
+
+         if (i > 0 && j == 0 && !prim.begin) {
+            /* the rest of the previous list's last primitive */
+            struct _mesa_prim *prev = &prim_store->buffer[num_prims - 1];
+
+            prev->count += prim.start + prim.count - skip;
+            prev->end = prim.end;
+            continue;
+         }
+
+         prim.start = prim.start - skip + num_verts;
+         prim_store->buffer[num_prims++] = prim;
+      }
+
+      num_verts += node->count - skip;
+   }
+
+   merge_prims(prim_store->buffer, &num_prims);
+   prim_store->used = num_prims;
+
+   vertex_store->bufferobj = ctx->Driver.NewBufferObject(ctx, VBO_BUF_ID);
+   if (!vertex_store->bufferobj ||
+       !ctx->Driver.BufferData(ctx, GL_ARRAY_BUFFER_ARB,
+                               num_verts * vertex_size * sizeof(GLfloat),
+                               buffer, GL_STATIC_DRAW_ARB,
+                               GL_MAP_READ_BIT | GL_DYNAMIC_STORAGE_BIT,
+                               vertex_store->bufferobj))
+      goto fail;
+
+   vertex_store->buffer = NULL;
+   vertex_store->used = num_verts * vertex_size;
+   vertex_store->refcount = 1;
+   free(buffer);
+
+   /* The format and the final vertex are those of the last list. */
+   merged = *last;
+   merged.buffer_offset = 0;
+   merged.count = num_verts;
+   merged.wrap_count = first->wrap_count;
+   merged.prim = prim_store->buffer;
+   merged.prim_count = num_prims;
+   merged.vertex_store = vertex_store;
+   merged.prim_store = prim_store;
+   last->current_data = NULL;
+
+   vbo_destroy_vertex_list(ctx, first);
+   *first = merged;
+
+   return n;
+
+fail:
+   free(buffer);
+   if (prim_store)
+      vbo_save_free_prim_store(prim_store);
+   if (vertex_store) {
+      if (vertex_store->bufferobj)
+         _mesa_reference_buffer_object(ctx, &vertex_store->bufferobj, NULL);
+      free(vertex_store);
+   }
+   return 1;
+}
+
+
 static void
 vbo_print_vertex_list(struct gl_context *ctx, void *data, FILE *f)
 {
@@ -1662,7 +1865,8 @@ vbo_save_api_init(struct vbo_save_context *save)
                                sizeof(struct vbo_save_vertex_list),
                                vbo_save_playback_vertex_list,
                                vbo_destroy_vertex_list,
-                               vbo_print_vertex_list);
+                               vbo_print_vertex_list,
+                               vbo_merge_vertex_lists);
 
    _save_vtxfmt_init(ctx);
    _save_current_init(ctx);
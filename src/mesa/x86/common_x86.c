@@ -55,6 +55,15 @@
 #elif !defined(bit_SSE4_1) && !defined(bit_SSE41)
 #define bit_SSE4_1 0x00080000
 #endif
+#ifndef bit_OSXSAVE
+#define bit_OSXSAVE (1 << 27)
+#endif
+#ifndef bit_AVX
+#define bit_AVX (1 << 28)
+#endif
+#ifndef bit_AVX2
+#define bit_AVX2 (1 << 5)
+#endif
 #endif
 
 #include "main/imports.h"
@@ -354,6 +363,18 @@ _mesa_get_x86_features(void)
 
       if (ecx & bit_SSE4_1)
          _mesa_x86_cpu_features |= X86_FEATURE_SSE4_1;
+
+      /* AVX2 also needs the OS to save the YMM registers. */
+      if ((ecx & (bit_OSXSAVE | bit_AVX)) == (bit_OSXSAVE | bit_AVX) &&
+          __get_cpuid_max(0, NULL) >= 7) {
+         unsigned int xcr0_lo, xcr0_hi;
+
+         __asm__ ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+         __cpuid_count(7, 0, eax, ebx, ecx, edx);
+
+         if ((xcr0_lo & 0x6) == 0x6 && (ebx & bit_AVX2))
+            _mesa_x86_cpu_features |= X86_FEATURE_AVX2;
+      }
    }
 #endif /* USE_X86_64_ASM */
 
@@ -0,0 +1,948 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *
+ */
+
+/**
+ * \file astc.c
+ *
+ * ASTC LDR block decoder, following section C.2 of the Khronos Data Format
+ * Specification.
+ *
+ * A block is decoded in two steps.  parse_block() reads the header, the
+ * color endpoints and the weight grid, which is the bulk of the work and is
+ * shared by all texels.  decode_texel() then infills the weight of a single
+ * texel, picks its partition and interpolates the endpoints.  Fetching a
+ * single texel only does the second step once.
+ *
+ * Interpolated channels are returned as the top 8 bits of the 16-bit result,
+ * as for the UNORM8 decode mode of EXT_texture_compression_astc_decode_mode.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "astc.h"
+
+#define MAX_WEIGHTS 64
+#define MIN_WEIGHT_BITS 24
+#define MAX_WEIGHT_BITS 96
+#define MAX_COLOR_VALUES 18
+
+/** The error color of the LDR profile */
+static const uint8_t error_color[4] = { 0xff, 0x00, 0xff, 0xff };
+
+/**
+ * The integer sequence encodings, ordered by the number of values they can
+ * represent.
+ */
+static const struct ise_range {
+   uint8_t trits;
+   uint8_t quints;
+   uint8_t bits;
+} ise_ranges[] = {
+   { 0, 0, 1 },   /* 2 */
+   { 1, 0, 0 },   /* 3 */
+   { 0, 0, 2 },   /* 4 */
+   { 0, 1, 0 },   /* 5 */
+   { 1, 0, 1 },   /* 6 */
+   { 0, 0, 3 },   /* 8 */
+   { 0, 1, 1 },   /* 10 */
+   { 1, 0, 2 },   /* 12 */
+   { 0, 0, 4 },   /* 16 */
+   { 0, 1, 2 },   /* 20 */
+   { 1, 0, 3 },   /* 24 */
+   { 0, 0, 5 },   /* 32 */
+   { 0, 1, 3 },   /* 40 */
+   { 1, 0, 4 },   /* 48 */
+   { 0, 0, 6 },   /* 64 */
+   { 0, 1, 4 },   /* 80 */
+   { 1, 0, 5 },   /* 96 */
+   { 0, 0, 7 },   /* 128 */
+   { 0, 1, 5 },   /* 160 */
+   { 1, 0, 6 },   /* 192 */
+   { 0, 0, 8 },   /* 256 */
+};
+
+#define NUM_ISE_RANGES (sizeof(ise_ranges) / sizeof(ise_ranges[0]))
+
+/** The smallest range the color endpoints can be encoded with, 0..5 */
+#define MIN_COLOR_RANGE 4
+
+struct bit_reader {
+   const uint8_t *data;
+   unsigned pos;
+   unsigned end;
+};
+
+struct astc_block {
+   bool void_extent;
+
+   unsigned grid_width;
+   unsigned grid_height;
+   bool dual_plane;
+   /** The channel that uses the second weight plane */
+   unsigned ccs;
+
+   unsigned num_parts;
+   unsigned part_seed;
+
+   /** Endpoints per partition, expanded to 16 bits */
+   uint16_t endpoints[4][2][4];
+
+   /** Unquantized weights in [0, 64], interleaved for dual-plane blocks */
+   uint8_t weights[MAX_WEIGHTS + 2 * (UTIL_ASTC_MAX_BLOCK_WIDTH + 1)];
+};
+
+/**
+ * Read up to 24 bits of \p data starting at bit \p start.  \p data is
+ * padded with zeroes past the end of the block.
+ */
+static inline unsigned
+get_bits(const uint8_t *data, unsigned start, unsigned count)
+{
+   const uint8_t *p = data + (start >> 3);
+   uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+
+   return (v >> (start & 7)) & ((1u << count) - 1);
+}
+
+/**
+ * Read \p count bits of a sequence, which is zero-extended past its end.
+ */
+static inline unsigned
+read_bits(struct bit_reader *r, unsigned count)
+{
+   unsigned v = 0;
+
+   if (r->pos < r->end) {
+      unsigned n = r->end - r->pos < count ? r->end - r->pos : count;
+      v = get_bits(r->data, r->pos, n);
+   }
+   r->pos += count;
+
+   return v;
+}
+
+static unsigned
+ise_bit_count(unsigned count, unsigned range)
+{
+   const struct ise_range *ise = &ise_ranges[range];
+
+   return count * ise->bits +
+          (count * 8 * ise->trits + 4) / 5 +
+          (count * 7 * ise->quints + 2) / 3;
+}
+
+static void
+decode_trits(unsigned t, unsigned trits[5])
+{
+   unsigned c;
+
+   if (((t >> 2) & 7) == 7) {
+      c = ((t >> 3) & 0x1c) | (t & 3);
+      trits[4] = 2;
+      trits[3] = 2;
+   } else {
+      c = t & 0x1f;
+      if (((t >> 5) & 3) == 3) {
+         trits[4] = 2;
+         trits[3] = (t >> 7) & 1;
+      } else {
+         trits[4] = (t >> 7) & 1;
+         trits[3] = (t >> 5) & 3;
+      }
+   }
+
+   if ((c & 3) == 3) {
+      trits[2] = 2;
+      trits[1] = (c >> 4) & 1;
+      trits[0] = (((c >> 3) & 1) << 1) | (((c >> 2) & 1) & ~((c >> 3) & 1));
+   } else if (((c >> 2) & 3) == 3) {
+      trits[2] = 2;
+      trits[1] = 2;
+      trits[0] = c & 3;
+   } else {
+      trits[2] = (c >> 4) & 1;
+      trits[1] = (c >> 2) & 3;
+      trits[0] = (((c >> 1) & 1) << 1) | ((c & 1) & ~((c >> 1) & 1));
+   }
+}
+
+static void
+decode_quints(unsigned q, unsigned quints[3])
+{
+   unsigned c;
+
+   if (((q >> 1) & 3) == 3 && ((q >> 5) & 3) == 0) {
+      unsigned q0 = q & 1;
+      quints[2] = (q0 << 2) | ((((q >> 4) & 1) & ~q0) << 1) |
+                  (((q >> 3) & 1) & ~q0);
+      quints[1] = 4;
+      quints[0] = 4;
+      return;
+   }
+
+   if (((q >> 1) & 3) == 3) {
+      quints[2] = 4;
+      c = (((q >> 3) & 3) << 3) | ((~(q >> 5) & 3) << 1) | (q & 1);
+   } else {
+      quints[2] = (q >> 5) & 3;
+      c = q & 0x1f;
+   }
+
+   if ((c & 7) == 5) {
+      quints[1] = 4;
+      quints[0] = (c >> 3) & 3;
+   } else {
+      quints[1] = (c >> 3) & 3;
+      quints[0] = c & 7;
+   }
+}
+
+/**
+ * Decode \p count values of an integer sequence.  Every value holds the
+ * trit or quint in its high bits and the plain bits below them.
+ */
+static void
+decode_ise(struct bit_reader *r, unsigned count, unsigned range,
+           uint8_t *out)
+{
+   const struct ise_range *ise = &ise_ranges[range];
+   const unsigned b = ise->bits;
+   unsigned i, k;
+
+   if (ise->trits) {
+      static const uint8_t t_bits[5] = { 2, 2, 1, 2, 1 };
+
+      for (i = 0; i < count; i += 5) {
+         unsigned m[5], trits[5], t = 0, shift = 0;
+
+         for (k = 0; k < 5; k++) {
+            m[k] = read_bits(r, b);
+            t |= read_bits(r, t_bits[k]) << shift;
+            shift += t_bits[k];
+         }
+
+         decode_trits(t, trits);
+         for (k = 0; k < 5 && i + k < count; k++)
+            out[i + k] = (trits[k] << b) | m[k];
+      }
+   } else if (ise->quints) {
+      static const uint8_t q_bits[3] = { 3, 2, 2 };
+
+      for (i = 0; i < count; i += 3) {
+         unsigned m[3], quints[3], q = 0, shift = 0;
+
+         for (k = 0; k < 3; k++) {
+            m[k] = read_bits(r, b);
+            q |= read_bits(r, q_bits[k]) << shift;
+            shift += q_bits[k];
+         }
+
+         decode_quints(q, quints);
+         for (k = 0; k < 3 && i + k < count; k++)
+            out[i + k] = (quints[k] << b) | m[k];
+      }
+   } else {
+      for (i = 0; i < count; i++)
+         out[i] = read_bits(r, b);
+   }
+}
+
+/**
+ * Unquantize a color endpoint value to [0, 255].
+ */
+static unsigned
+unquantize_color(unsigned v, unsigned range)
+{
+   const struct ise_range *ise = &ise_ranges[range];
+   const unsigned b = ise->bits;
+   unsigned m, a, hi, A, B, C, D, t, n;
+
+   if (!ise->trits && !ise->quints) {
+      /* Replicate the bits to fill 8 bits. */
+      for (t = 0, n = 0; n < 8; n += b)
+         t = (t << b) | v;
+      return t >> (n - 8);
+   }
+
+   m = v & ((1 << b) - 1);
+   D = v >> b;
+   a = m & 1;
+   hi = m >> 1;
+   A = a ? 0x1ff : 0;
+
+   if (ise->trits) {
+      switch (b) {
+      case 1: B = 0; C = 204; break;
+      case 2: B = (hi << 8) | (hi << 4) | (hi << 2) | (hi << 1); C = 93; break;
+      case 3: B = (hi << 7) | (hi << 2) | hi; C = 44; break;
+      case 4: B = (hi << 6) | hi; C = 22; break;
+      case 5: B = (hi << 5) | (hi >> 2); C = 11; break;
+      default: B = (hi << 4) | (hi >> 4); C = 5; break;
+      }
+   } else {
+      switch (b) {
+      case 1: B = 0; C = 113; break;
+      case 2: B = (hi << 8) | (hi << 3) | (hi << 2); C = 54; break;
+      case 3: B = (hi << 7) | (hi << 1) | (hi >> 1); C = 26; break;
+      case 4: B = (hi << 6) | (hi >> 1); C = 13; break;
+      default: B = (hi << 5) | (hi >> 3); C = 6; break;
+      }
+   }
+
+   t = D * C + B;
+   t ^= A;
+   return (A & 0x80) | (t >> 2);
+}
+
+/**
+ * Unquantize a weight to [0, 64].
+ */
+static unsigned
+unquantize_weight(unsigned v, unsigned range)
+{
+   const struct ise_range *ise = &ise_ranges[range];
+   const unsigned b = ise->bits;
+   unsigned t;
+
+   if (!ise->trits && !ise->quints) {
+      switch (b) {
+      case 1: t = v ? 63 : 0; break;
+      case 2: t = (v << 4) | (v << 2) | v; break;
+      case 3: t = (v << 3) | v; break;
+      case 4: t = (v << 2) | (v >> 2); break;
+      default: t = (v << 1) | (v >> 4); break;
+      }
+   } else if (b == 0) {
+      static const uint8_t trit_weights[3] = { 0, 32, 63 };
+      static const uint8_t quint_weights[5] = { 0, 16, 32, 47, 63 };
+      t = ise->trits ? trit_weights[v] : quint_weights[v];
+   } else {
+      unsigned m = v & ((1 << b) - 1);
+      unsigned D = v >> b;
+      unsigned hi = m >> 1;
+      unsigned A = (m & 1) ? 0x7f : 0;
+      unsigned B, C;
+
+      if (ise->trits) {
+         switch (b) {
+         case 1: B = 0; C = 50; break;
+         case 2: B = (hi << 6) | (hi << 2) | hi; C = 23; break;
+         default: B = (hi << 5) | hi; C = 11; break;
+         }
+      } else {
+         switch (b) {
+         case 1: B = 0; C = 28; break;
+         default: B = (hi << 6) | (hi << 1); C = 13; break;
+         }
+      }
+
+      t = D * C + B;
+      t ^= A;
+      t = (A & 0x20) | (t >> 2);
+   }
+
+   return t > 32 ? t + 1 : t;
+}
+
+/**
+ * Decode the block mode into the weight grid size, the weight range and the
+ * dual-plane flag.
+ *
+ * \return false for reserved block modes.
+ */
+static bool
+decode_block_mode(unsigned mode, unsigned *width, unsigned *height,
+                  unsigned *range, bool *dual_plane)
+{
+   unsigned r = (mode >> 4) & 1;
+   unsigned a = (mode >> 5) & 3;
+   unsigned b;
+   bool h = (mode >> 9) & 1;
+   bool d = (mode >> 10) & 1;
+
+   if ((mode & 3) != 0) {
+      r |= (mode & 3) << 1;
+      b = (mode >> 7) & 3;
+
+      switch ((mode >> 2) & 3) {
+      case 0:
+         *width = b + 4;
+         *height = a + 2;
+         break;
+      case 1:
+         *width = b + 8;
+         *height = a + 2;
+         break;
+      case 2:
+         *width = a + 2;
+         *height = b + 8;
+         break;
+      default:
+         b &= 1;
+         if (mode & 0x100) {
+            *width = b + 2;
+            *height = a + 2;
+         } else {
+            *width = a + 2;
+            *height = b + 6;
+         }
+         break;
+      }
+   } else {
+      r |= ((mode >> 2) & 3) << 1;
+      if (((mode >> 2) & 3) == 0)
+         return false;
+
+      b = (mode >> 9) & 3;
+
+      switch ((mode >> 7) & 3) {
+      case 0:
+         *width = 12;
+         *height = a + 2;
+         break;
+      case 1:
+         *width = a + 2;
+         *height = 12;
+         break;
+      case 2:
+         *width = a + 6;
+         *height = b + 6;
+         h = false;
+         d = false;
+         break;
+      default:
+         if (a == 0) {
+            *width = 6;
+            *height = 10;
+         } else if (a == 1) {
+            *width = 10;
+            *height = 6;
+         } else {
+            return false;
+         }
+         break;
+      }
+   }
+
+   /* r is in [2, 7] and selects one of the first twelve ranges. */
+   *range = r - 2 + (h ? 6 : 0);
+   *dual_plane = d;
+   return true;
+}
+
+static inline unsigned
+clamp_byte(int v)
+{
+   return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+static void
+bit_transfer_signed(int *a, int *b)
+{
+   *b >>= 1;
+   *b |= *a & 0x80;
+   *a >>= 1;
+   *a &= 0x3f;
+   if (*a & 0x20)
+      *a -= 0x40;
+}
+
+static void
+blue_contract(int e[4])
+{
+   e[0] = (e[0] + e[2]) >> 1;
+   e[1] = (e[1] + e[2]) >> 1;
+}
+
+static void
+set_endpoint(int e[4], int r, int g, int b, int a)
+{
+   e[0] = r;
+   e[1] = g;
+   e[2] = b;
+   e[3] = a;
+}
+
+/**
+ * Decode the endpoints of an LDR color endpoint mode.
+ *
+ * \return false for HDR modes.
+ */
+static bool
+decode_endpoints(unsigned cem, const uint8_t *values, int e0[4], int e1[4])
+{
+   int v[8], i;
+
+   for (i = 0; i < 2 * ((int) (cem >> 2) + 1); i++)
+      v[i] = values[i];
+
+   switch (cem) {
+   case 0:
+      set_endpoint(e0, v[0], v[0], v[0], 0xff);
+      set_endpoint(e1, v[1], v[1], v[1], 0xff);
+      break;
+   case 1: {
+      int l0 = (v[0] >> 2) | (v[1] & 0xc0);
+      int l1 = clamp_byte(l0 + (v[1] & 0x3f));
+      set_endpoint(e0, l0, l0, l0, 0xff);
+      set_endpoint(e1, l1, l1, l1, 0xff);
+      break;
+   }
+   case 4:
+      set_endpoint(e0, v[0], v[0], v[0], v[2]);
+      set_endpoint(e1, v[1], v[1], v[1], v[3]);
+      break;
+   case 5:
+      bit_transfer_signed(&v[1], &v[0]);
+      bit_transfer_signed(&v[3], &v[2]);
+      set_endpoint(e0, v[0], v[0], v[0], v[2]);
+      set_endpoint(e1, v[0] + v[1], v[0] + v[1], v[0] + v[1], v[2] + v[3]);
+      break;
+   case 6:
+      set_endpoint(e0, (v[0] * v[3]) >> 8, (v[1] * v[3]) >> 8,
+                   (v[2] * v[3]) >> 8, 0xff);
+      set_endpoint(e1, v[0], v[1], v[2], 0xff);
+      break;
+   case 8:
+   case 12:
+      if (cem == 8)
+         v[6] = v[7] = 0xff;
+      if (v[1] + v[3] + v[5] >= v[0] + v[2] + v[4]) {
+         set_endpoint(e0, v[0], v[2], v[4], v[6]);
+         set_endpoint(e1, v[1], v[3], v[5], v[7]);
+      } else {
+         set_endpoint(e0, v[1], v[3], v[5], v[7]);
+         set_endpoint(e1, v[0], v[2], v[4], v[6]);
+         blue_contract(e0);
+         blue_contract(e1);
+      }
+      break;
+   case 9:
+   case 13:
+      bit_transfer_signed(&v[1], &v[0]);
+      bit_transfer_signed(&v[3], &v[2]);
+      bit_transfer_signed(&v[5], &v[4]);
+      if (cem == 13) {
+         bit_transfer_signed(&v[7], &v[6]);
+      } else {
+         v[6] = 0xff;
+         v[7] = 0;
+      }
+      if (v[1] + v[3] + v[5] >= 0) {
+         set_endpoint(e0, v[0], v[2], v[4], v[6]);
+         set_endpoint(e1, v[0] + v[1], v[2] + v[3], v[4] + v[5],
+                      v[6] + v[7]);
+      } else {
+         set_endpoint(e0, v[0] + v[1], v[2] + v[3], v[4] + v[5],
+                      v[6] + v[7]);
+         set_endpoint(e1, v[0], v[2], v[4], v[6]);
+         blue_contract(e0);
+         blue_contract(e1);
+      }
+      break;
+   case 10:
+      set_endpoint(e0, (v[0] * v[3]) >> 8, (v[1] * v[3]) >> 8,
+                   (v[2] * v[3]) >> 8, v[4]);
+      set_endpoint(e1, v[0], v[1], v[2], v[5]);
+      break;
+   default:
+      return false;
+   }
+
+   for (i = 0; i < 4; i++) {
+      e0[i] = clamp_byte(e0[i]);
+      e1[i] = clamp_byte(e1[i]);
+   }
+
+   return true;
+}
+
+static uint32_t
+hash52(uint32_t p)
+{
+   p ^= p >> 15;
+   p -= p << 17;
+   p += p << 7;
+   p += p << 4;
+   p ^= p >> 5;
+   p += p << 16;
+   p ^= p >> 7;
+   p ^= p >> 3;
+   p ^= p << 6;
+   p ^= p >> 17;
+   return p;
+}
+
+static unsigned
+select_partition(unsigned seed, unsigned x, unsigned y,
+                 unsigned num_parts, bool small_block)
+{
+   uint32_t rnum;
+   unsigned s[12], sh1, sh2, sh3, i;
+   int a, b, c, d;
+
+   if (small_block) {
+      x <<= 1;
+      y <<= 1;
+   }
+
+   seed += (num_parts - 1) * 1024;
+   rnum = hash52(seed);
+
+   s[0] = rnum & 0xf;
+   s[1] = (rnum >> 4) & 0xf;
+   s[2] = (rnum >> 8) & 0xf;
+   s[3] = (rnum >> 12) & 0xf;
+   s[4] = (rnum >> 16) & 0xf;
+   s[5] = (rnum >> 20) & 0xf;
+   s[6] = (rnum >> 24) & 0xf;
+   s[7] = (rnum >> 28) & 0xf;
+   s[8] = (rnum >> 18) & 0xf;
+   s[9] = (rnum >> 22) & 0xf;
+   s[10] = (rnum >> 26) & 0xf;
+   s[11] = ((rnum >> 30) | (rnum << 2)) & 0xf;
+
+   for (i = 0; i < 12; i++)
+      s[i] *= s[i];
+
+   if (seed & 1) {
+      sh1 = (seed & 2) ? 4 : 5;
+      sh2 = num_parts == 3 ? 6 : 5;
+   } else {
+      sh1 = num_parts == 3 ? 6 : 5;
+      sh2 = (seed & 2) ? 4 : 5;
+   }
+   sh3 = (seed & 0x10) ? sh1 : sh2;
+
+   for (i = 0; i < 8; i++)
+      s[i] >>= (i & 1) ? sh2 : sh1;
+   for (i = 8; i < 12; i++)
+      s[i] >>= sh3;
+
+   /* The z terms vanish for 2D blocks. */
+   a = (s[0] * x + s[1] * y + (rnum >> 14)) & 0x3f;
+   b = (s[2] * x + s[3] * y + (rnum >> 10)) & 0x3f;
+   c = (s[4] * x + s[5] * y + (rnum >> 6)) & 0x3f;
+   d = (s[6] * x + s[7] * y + (rnum >> 2)) & 0x3f;
+
+   if (num_parts < 4)
+      d = 0;
+   if (num_parts < 3)
+      c = 0;
+
+   if (a >= b && a >= c && a >= d)
+      return 0;
+   else if (b >= c && b >= d)
+      return 1;
+   else if (c >= d)
+      return 2;
+   else
+      return 3;
+}
+
+static void
+set_void_extent(struct astc_block *blk, uint16_t r, uint16_t g,
+                uint16_t b, uint16_t a)
+{
+   blk->void_extent = true;
+   blk->endpoints[0][0][0] = r;
+   blk->endpoints[0][0][1] = g;
+   blk->endpoints[0][0][2] = b;
+   blk->endpoints[0][0][3] = a;
+}
+
+static void
+set_error(struct astc_block *blk)
+{
+   set_void_extent(blk, error_color[0] << 8, error_color[1] << 8,
+                   error_color[2] << 8, error_color[3] << 8);
+}
+
+static void
+parse_void_extent(struct astc_block *blk, const uint8_t *data)
+{
+   unsigned min_s = get_bits(data, 12, 13), max_s = get_bits(data, 25, 13);
+   unsigned min_t = get_bits(data, 38, 13), max_t = get_bits(data, 51, 13);
+   bool all_ones = min_s == 0x1fff && max_s == 0x1fff &&
+                   min_t == 0x1fff && max_t == 0x1fff;
+
+   /* HDR void-extent blocks are errors in the LDR profile, and so are
+    * blocks with invalid extents.
+    */
+   if ((data[1] & 0x02) || get_bits(data, 10, 2) != 3 ||
+       (!all_ones && (min_s >= max_s || min_t >= max_t))) {
+      set_error(blk);
+      return;
+   }
+
+   set_void_extent(blk,
+                   get_bits(data, 64, 16), get_bits(data, 80, 16),
+                   get_bits(data, 96, 16), get_bits(data, 112, 16));
+}
+
+static void
+parse_block(struct astc_block *blk, const uint8_t *src,
+            unsigned bw, unsigned bh, bool srgb)
+{
+   uint8_t data[UTIL_ASTC_BLOCK_SIZE + 4], rev[UTIL_ASTC_BLOCK_SIZE + 4];
+   uint8_t values[MAX_COLOR_VALUES + 4], weights[MAX_WEIGHTS + 4];
+   unsigned cems[4], mode, weight_range, num_weights, weight_bits;
+   unsigned color_start, extra_cem_bits = 0, below_weights, color_bits;
+   unsigned num_values = 0, color_range, i, c;
+   struct bit_reader r;
+
+   memcpy(data, src, UTIL_ASTC_BLOCK_SIZE);
+   memset(data + UTIL_ASTC_BLOCK_SIZE, 0, 4);
+
+   blk->void_extent = false;
+
+   mode = get_bits(data, 0, 11);
+   if ((mode & 0x1ff) == 0x1fc) {
+      parse_void_extent(blk, data);
+      return;
+   }
+
+   if (!decode_block_mode(mode, &blk->grid_width, &blk->grid_height,
+                          &weight_range, &blk->dual_plane) ||
+       blk->grid_width > bw || blk->grid_height > bh) {
+      set_error(blk);
+      return;
+   }
+
+   num_weights = blk->grid_width * blk->grid_height * (blk->dual_plane + 1);
+   weight_bits = ise_bit_count(num_weights, weight_range);
+   blk->num_parts = get_bits(data, 11, 2) + 1;
+
+   if (num_weights > MAX_WEIGHTS ||
+       weight_bits < MIN_WEIGHT_BITS || weight_bits > MAX_WEIGHT_BITS ||
+       (blk->num_parts == 4 && blk->dual_plane)) {
+      set_error(blk);
+      return;
+   }
+
+   if (blk->num_parts == 1) {
+      cems[0] = get_bits(data, 13, 4);
+      color_start = 17;
+   } else {
+      unsigned cem_bits = get_bits(data, 23, 6);
+
+      blk->part_seed = get_bits(data, 13, 10);
+      color_start = 29;
+
+      if ((cem_bits & 3) == 0) {
+         for (i = 0; i < blk->num_parts; i++)
+            cems[i] = cem_bits >> 2;
+      } else {
+         /* One class bit per partition followed by two mode bits per
+          * partition.  The bits that do not fit in the header are stored
+          * right below the weights.
+          */
+         unsigned base = (cem_bits & 3) - 1;
+         unsigned bits;
+
+         extra_cem_bits = 3 * blk->num_parts - 4;
+         bits = (cem_bits >> 2) |
+                (get_bits(data, 128 - weight_bits - extra_cem_bits,
+                          extra_cem_bits) << 4);
+
+         for (i = 0; i < blk->num_parts; i++) {
+            unsigned class = base + ((bits >> i) & 1);
+            unsigned m = (bits >> (blk->num_parts + 2 * i)) & 3;
+            cems[i] = (class << 2) | m;
+         }
+      }
+   }
+
+   below_weights = extra_cem_bits + (blk->dual_plane ? 2 : 0);
+   if (blk->dual_plane)
+      blk->ccs = get_bits(data, 128 - weight_bits - below_weights, 2);
+
+   for (i = 0; i < blk->num_parts; i++)
+      num_values += 2 * ((cems[i] >> 2) + 1);
+
+   if (num_values > MAX_COLOR_VALUES ||
+       color_start + below_weights + weight_bits > 128) {
+      set_error(blk);
+      return;
+   }
+
+   /* The endpoints use the largest range that fits the remaining bits. */
+   color_bits = 128 - color_start - below_weights - weight_bits;
+   for (color_range = NUM_ISE_RANGES - 1;
+        color_range >= MIN_COLOR_RANGE; color_range--) {
+      if (ise_bit_count(num_values, color_range) <= color_bits)
+         break;
+   }
+   if (color_range < MIN_COLOR_RANGE) {
+      set_error(blk);
+      return;
+   }
+
+   r.data = data;
+   r.pos = color_start;
+   r.end = color_start + ise_bit_count(num_values, color_range);
+   decode_ise(&r, num_values, color_range, values);
+
+   for (i = 0; i < num_values; i++)
+      values[i] = unquantize_color(values[i], color_range);
+
+   for (i = 0, c = 0; i < blk->num_parts; i++) {
+      int e0[4], e1[4];
+      unsigned k;
+
+      if (!decode_endpoints(cems[i], values + c, e0, e1)) {
+         set_error(blk);
+         return;
+      }
+      c += 2 * ((cems[i] >> 2) + 1);
+
+      for (k = 0; k < 4; k++) {
+         if (srgb) {
+            blk->endpoints[i][0][k] = (e0[k] << 8) | 0x80;
+            blk->endpoints[i][1][k] = (e1[k] << 8) | 0x80;
+         } else {
+            blk->endpoints[i][0][k] = e0[k] * 257;
+            blk->endpoints[i][1][k] = e1[k] * 257;
+         }
+      }
+   }
+
+   /* The weights are stored bit-reversed from the top of the block. */
+   for (i = 0; i < UTIL_ASTC_BLOCK_SIZE; i++) {
+      uint8_t v = data[UTIL_ASTC_BLOCK_SIZE - 1 - i];
+      v = ((v & 0xf0) >> 4) | ((v & 0x0f) << 4);
+      v = ((v & 0xcc) >> 2) | ((v & 0x33) << 2);
+      v = ((v & 0xaa) >> 1) | ((v & 0x55) << 1);
+      rev[i] = v;
+   }
+   memset(rev + UTIL_ASTC_BLOCK_SIZE, 0, 4);
+
+   r.data = rev;
+   r.pos = 0;
+   r.end = weight_bits;
+   decode_ise(&r, num_weights, weight_range, weights);
+
+   for (i = 0; i < num_weights; i++)
+      blk->weights[i] = unquantize_weight(weights[i], weight_range);
+
+   /* Reads past the grid edge have a zero infill factor. */
+   memset(blk->weights + num_weights, 0,
+          sizeof(blk->weights) - num_weights);
+}
+
+/**
+ * Compute the infill factors of the weight grid for texel (s, t).
+ *
+ * \return the index of the top-left grid point.
+ */
+static inline unsigned
+infill(const struct astc_block *blk, unsigned bw, unsigned bh,
+       unsigned s, unsigned t, unsigned f[4])
+{
+   unsigned ds = (1024 + bw / 2) / (bw - 1);
+   unsigned dt = (1024 + bh / 2) / (bh - 1);
+   unsigned gs = (ds * s * (blk->grid_width - 1) + 32) >> 6;
+   unsigned gt = (dt * t * (blk->grid_height - 1) + 32) >> 6;
+   unsigned fs = gs & 0xf, ft = gt & 0xf;
+
+   f[3] = (fs * ft + 8) >> 4;
+   f[2] = ft - f[3];
+   f[1] = fs - f[3];
+   f[0] = 16 - fs - ft + f[3];
+
+   return (gs >> 4) + (gt >> 4) * blk->grid_width;
+}
+
+static inline unsigned
+grid_weight(const struct astc_block *blk, unsigned v, const unsigned f[4],
+            unsigned plane)
+{
+   const unsigned planes = blk->dual_plane ? 2 : 1;
+   const unsigned w = blk->grid_width;
+   const uint8_t *p = blk->weights + plane;
+
+   return (p[v * planes] * f[0] +
+           p[(v + 1) * planes] * f[1] +
+           p[(v + w) * planes] * f[2] +
+           p[(v + w + 1) * planes] * f[3] + 8) >> 4;
+}
+
+static inline void
+decode_texel(const struct astc_block *blk, unsigned bw, unsigned bh,
+             unsigned s, unsigned t, uint8_t *dst)
+{
+   const uint16_t (*ep)[4];
+   unsigned f[4], v, w0, w1, k;
+
+   if (blk->void_extent) {
+      for (k = 0; k < 4; k++)
+         dst[k] = blk->endpoints[0][0][k] >> 8;
+      return;
+   }
+
+   ep = blk->endpoints[0];
+   if (blk->num_parts > 1)
+      ep = blk->endpoints[select_partition(blk->part_seed, s, t,
+                                           blk->num_parts, bw * bh < 31)];
+
+   v = infill(blk, bw, bh, s, t, f);
+   w0 = grid_weight(blk, v, f, 0);
+   w1 = blk->dual_plane ? grid_weight(blk, v, f, 1) : w0;
+
+   for (k = 0; k < 4; k++) {
+      unsigned w = blk->dual_plane && k == blk->ccs ? w1 : w0;
+      unsigned c = (ep[0][k] * (64 - w) + ep[1][k] * w + 32) >> 6;
+      dst[k] = c >> 8;
+   }
+}
+
+void
+util_format_astc_decode_block(uint8_t *dst, unsigned dst_stride,
+                              const uint8_t *src,
+                              unsigned bw, unsigned bh, bool srgb)
+{
+   struct astc_block blk;
+   unsigned s, t;
+
+   parse_block(&blk, src, bw, bh, srgb);
+
+   for (t = 0; t < bh; t++) {
+      uint8_t *row = dst + t * dst_stride;
+
+      for (s = 0; s < bw; s++)
+         decode_texel(&blk, bw, bh, s, t, row + 4 * s);
+   }
+}
+
+void
+util_format_astc_fetch_texel(uint8_t *dst, const uint8_t *src,
+                             unsigned bw, unsigned bh, bool srgb,
+                             unsigned i, unsigned j)
+{
+   struct astc_block blk;
+
+   parse_block(&blk, src, bw, bh, srgb);
+   decode_texel(&blk, bw, bh, i, j, dst);
+}
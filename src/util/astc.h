@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *
+ */
+
+#ifndef _ASTC_H
+#define _ASTC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Decoder for 2D ASTC blocks of the LDR profile.
+ *
+ * The texels are returned as RGBA8.  For sRGB formats they are still
+ * sRGB-encoded; the caller converts them to linear.  Blocks that use HDR
+ * endpoint modes or are otherwise invalid in the LDR profile decode to the
+ * error color, opaque magenta.
+ */
+
+#define UTIL_ASTC_BLOCK_SIZE 16
+#define UTIL_ASTC_MAX_BLOCK_WIDTH 12
+#define UTIL_ASTC_MAX_BLOCK_HEIGHT 12
+
+/**
+ * Decode the \p bw x \p bh texels of the block at \p src into \p dst, whose
+ * rows are \p dst_stride bytes apart.
+ */
+void util_format_astc_decode_block(uint8_t *dst, unsigned dst_stride,
+                                   const uint8_t *src,
+                                   unsigned bw, unsigned bh, bool srgb);
+
+/**
+ * Decode the single texel (i, j) of the block at \p src.
+ */
+void util_format_astc_fetch_texel(uint8_t *dst, const uint8_t *src,
+                                  unsigned bw, unsigned bh, bool srgb,
+                                  unsigned i, unsigned j);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ASTC_H */
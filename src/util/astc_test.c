@@ -0,0 +1,144 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "astc.h"
+
+/* The error color of the LDR profile */
+static const uint8_t magenta[1][4] = { { 0xff, 0x00, 0xff, 0xff } };
+
+/* An LDR void-extent block with the color (0x8000, 0x4000, 0xc000, 0xffff)
+ * and all extent bits set.
+ */
+static const uint8_t void_extent[UTIL_ASTC_BLOCK_SIZE] = {
+   0xfc, 0xfd, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x00, 0x80, 0x00, 0x40, 0x00, 0xc0, 0xff, 0xff,
+};
+
+/* The same block with the HDR bit set, which is an error in the LDR
+ * profile.
+ */
+static const uint8_t hdr_void_extent[UTIL_ASTC_BLOCK_SIZE] = {
+   0xfc, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0x00, 0x80, 0x00, 0x40, 0x00, 0xc0, 0xff, 0xff,
+};
+
+/* Block mode 0, which is reserved. */
+static const uint8_t reserved_mode[UTIL_ASTC_BLOCK_SIZE] = { 0 };
+
+/* A single-partition block with a 4x4 grid of weights in the range 0..11,
+ * so that every texel of a 4x4 block gets exactly one grid weight.  The
+ * endpoints are RGB direct (mode 8) with 8-bit values, (0, 255, 64) and
+ * (255, 0, 192).  The weights are the twelve encoded values 0..11 in
+ * order followed by 6, 7, 2 and 3.
+ */
+static const uint8_t weights_12[UTIL_ASTC_BLOCK_SIZE] = {
+   0x51, 0x02, 0x01, 0xfe, 0xff, 0x01, 0x80, 0x80,
+   0x01, 0xcb, 0xd7, 0x55, 0xf9, 0x69, 0x58, 0x08,
+};
+
+/* The texels of weights_12.  The encoded weights unquantize to 0, 64, 17,
+ * 47, 5, 59, 23, 41, 11, 53, 28, 36, 23, 41, 17 and 47.
+ */
+static const uint8_t weights_12_texels[16][4] = {
+   {   0, 255,  64, 255 }, { 255,   0, 192, 255 },
+   {  68, 187,  98, 255 }, { 187,  68, 158, 255 },
+   {  20, 235,  74, 255 }, { 235,  20, 182, 255 },
+   {  92, 163, 110, 255 }, { 163,  92, 146, 255 },
+   {  44, 211,  86, 255 }, { 211,  44, 170, 255 },
+   { 112, 143, 120, 255 }, { 143, 112, 136, 255 },
+   {  92, 163, 110, 255 }, { 163,  92, 146, 255 },
+   {  68, 187,  98, 255 }, { 187,  68, 158, 255 },
+};
+
+static bool
+check_texel(const char *name, unsigned s, unsigned t,
+            const uint8_t *texel, const uint8_t *expected)
+{
+   if (memcmp(texel, expected, 4) == 0)
+      return false;
+
+   fprintf(stderr, "FAIL: %s texel (%u, %u) is (%u, %u, %u, %u), "
+           "expected (%u, %u, %u, %u)\n", name, s, t,
+           texel[0], texel[1], texel[2], texel[3],
+           expected[0], expected[1], expected[2], expected[3]);
+   return true;
+}
+
+/* Decodes the whole block and fetches every texel on its own, and compares
+ * both against \p expected, which is either one texel per block texel or a
+ * single texel for all of them.
+ */
+static bool
+test_block(const char *name, const uint8_t *block, unsigned bw,
+           unsigned bh, const uint8_t (*expected)[4], bool constant)
+{
+   uint8_t texels[UTIL_ASTC_MAX_BLOCK_HEIGHT][UTIL_ASTC_MAX_BLOCK_WIDTH][4];
+   bool failed = false;
+   unsigned s, t;
+
+   util_format_astc_decode_block(&texels[0][0][0], sizeof(texels[0]),
+                                 block, bw, bh, false);
+
+   for (t = 0; t < bh; t++) {
+      for (s = 0; s < bw; s++) {
+         const uint8_t *e = expected[constant ? 0 : t * bw + s];
+         uint8_t texel[4];
+
+         failed |= check_texel(name, s, t, texels[t][s], e);
+
+         util_format_astc_fetch_texel(texel, block, bw, bh, false, s, t);
+         failed |= check_texel(name, s, t, texel, e);
+      }
+   }
+
+   return failed;
+}
+
+int
+main(int argc, char *argv[])
+{
+   static const uint8_t void_extent_color[1][4] = { { 0x80, 0x40, 0xc0, 0xff } };
+   bool failed = false;
+
+   failed |= test_block("void extent", void_extent, 4, 4,
+                        void_extent_color, true);
+   failed |= test_block("void extent 12x12", void_extent, 12, 12,
+                        void_extent_color, true);
+   failed |= test_block("HDR void extent", hdr_void_extent, 4, 4,
+                        magenta, true);
+   failed |= test_block("reserved block mode", reserved_mode, 4, 4,
+                        magenta, true);
+   failed |= test_block("12-level weights", weights_12, 4, 4,
+                        weights_12_texels, false);
+
+   /* The weight grid may not be larger than the block. */
+   failed |= test_block("grid larger than block", weights_12, 4, 3,
+                        magenta, true);
+
+   return failed ? 1 : 0;
+}
@@ -0,0 +1,858 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifdef ENABLE_SHADER_CACHE
+
+#include <ctype.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/file.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pwd.h>
+#include <errno.h>
+#include <dirent.h>
+#ifdef HAVE_DLADDR
+#include <dlfcn.h>
+#endif
+
+#include "util/u_atomic.h"
+#include "util/mesa-sha1.h"
+#include "util/ralloc.h"
+
+#include "disk_cache.h"
+
+/* Number of bits to mask off from a cache key to get an index. */
+#define CACHE_INDEX_KEY_BITS 16
+
+/* Mask for computing an index from a key. */
+#define CACHE_INDEX_KEY_MASK ((1 << CACHE_INDEX_KEY_BITS) - 1)
+
+/* The number of keys that can be stored in the index. */
+#define CACHE_INDEX_MAX_KEYS (1 << CACHE_INDEX_KEY_BITS)
+
+/* When the cache grows past its limit, evict down to this percentage of the
+ * limit so that the next few writes don't have to scan the cache again.
+ */
+#define CACHE_EVICTION_TARGET_PERCENT 90
+
+#define CACHE_FILE_MAGIC 0x4d455343 /* "MESC" */
+
+/* Header written in front of every cache item. */
+struct cache_entry_header {
+   uint32_t magic;
+   uint32_t checksum;
+   uint64_t size;
+   cache_key key;
+};
+
+struct disk_cache {
+   /* The path to the cache directory. */
+   char *path;
+
+   /* A pointer to the mmapped index file within the cache directory. */
+   uint8_t *index_mmap;
+   size_t index_mmap_size;
+
+   /* Pointer to total size of all objects in cache (within index_mmap) */
+   uint64_t *size;
+
+   /* Pointer to stored keys, (within index_mmap). */
+   uint8_t *stored_keys;
+
+   /* Maximum size of all cached objects (in bytes). */
+   uint64_t max_size;
+
+   /* SHA-1 of the driver identity, mixed into every computed key. */
+   cache_key driver_key;
+};
+
+/* Create a directory named 'path' if it does not already exist.
+ *
+ * Returns: 0 if path already exists as a directory or if created.
+ *         -1 in all other cases.
+ */
+static int
+mkdir_if_needed(const char *path)
+{
+   struct stat sb;
+
+   /* If the path exists already, then our work is done if it's a
+    * directory, but it's an error if it is not.
+    */
+   if (stat(path, &sb) == 0) {
+      if (S_ISDIR(sb.st_mode)) {
+         return 0;
+      } else {
+         fprintf(stderr, "Cannot use %s for shader cache (not a directory)"
+                         "---disabling.\n", path);
+         return -1;
+      }
+   }
+
+   int ret = mkdir(path, 0755);
+   if (ret == 0 || (ret == -1 && errno == EEXIST))
+     return 0;
+
+   fprintf(stderr, "Failed to create %s for shader cache (%s)---disabling.\n",
+           path, strerror(errno));
+
+   return -1;
+}
+
+/* Concatenate an existing path and a new name to form a new path.  If the new
+ * path does not exist as a directory, create it then return the resulting
+ * name of the new path (ralloc'ed off of 'ctx').
+ *
+ * Returns NULL on any error, such as:
+ *
+ *      <path> does not exist or is not a directory
+ *      <path>/<name> exists but is not a directory
+ *      <path>/<name> cannot be created as a directory
+ */
+static char *
+concatenate_and_mkdir(void *ctx, const char *path, const char *name)
+{
+   char *new_path;
+   struct stat sb;
+
+   if (stat(path, &sb) != 0 || ! S_ISDIR(sb.st_mode))
+      return NULL;
+
+   new_path = ralloc_asprintf(ctx, "%s/%s", path, name);
+
+   if (mkdir_if_needed(new_path) == 0)
+      return new_path;
+   else
+      return NULL;
+}
+
+/* Parse $MESA_GLSL_CACHE_MAX_SIZE.  A bare number is in gigabytes. */
+static uint64_t
+parse_max_size(const char *max_size_str)
+{
+   char *end;
+   uint64_t max_size = strtoul(max_size_str, &end, 10);
+
+   if (end == max_size_str)
+      return 0;
+
+   switch (*end) {
+   case 'K':
+   case 'k':
+      max_size *= 1024;
+      break;
+   case 'M':
+   case 'm':
+      max_size *= 1024*1024;
+      break;
+   case '\0':
+   case 'G':
+   case 'g':
+   default:
+      max_size *= 1024*1024*1024;
+      break;
+   }
+
+   return max_size;
+}
+
+struct disk_cache *
+disk_cache_create(const char *gpu_name, const char *timestamp)
+{
+   void *local;
+   struct disk_cache *cache = NULL;
+   char *path, *max_size_str;
+   uint64_t max_size;
+   int fd = -1;
+   struct stat sb;
+   size_t size;
+
+   /* If running as a users other than the real user disable cache */
+   if (geteuid() != getuid())
+      return NULL;
+
+   /* A ralloc context for transient data during this invocation. */
+   local = ralloc_context(NULL);
+   if (local == NULL)
+      goto fail;
+
+   /* At user request, disable shader cache entirely. */
+   if (getenv("MESA_GLSL_CACHE_DISABLE"))
+      goto fail;
+
+   /* Determine path for cache based on the first defined name as follows:
+    *
+    *   $MESA_GLSL_CACHE_DIR
+    *   $XDG_CACHE_HOME/mesa
+    *   <pwd.pw_dir>/.cache/mesa
+    */
+   path = getenv("MESA_GLSL_CACHE_DIR");
+   if (path && mkdir_if_needed(path) == -1) {
+      goto fail;
+   }
+
+   if (path == NULL) {
+      char *xdg_cache_home = getenv("XDG_CACHE_HOME");
+
+      if (xdg_cache_home) {
+         if (mkdir_if_needed(xdg_cache_home) == -1)
+            goto fail;
+
+         path = concatenate_and_mkdir(local, xdg_cache_home, "mesa");
+         if (path == NULL)
+            goto fail;
+      }
+   }
+
+   if (path == NULL) {
+      char *buf;
+      size_t buf_size;
+      struct passwd pwd, *result;
+
+      buf_size = sysconf(_SC_GETPW_R_SIZE_MAX);
+      if (buf_size == -1)
+         buf_size = 512;
+
+      /* Loop until buf_size is large enough to query the directory */
+      while (1) {
+         buf = ralloc_size(local, buf_size);
+
+         getpwuid_r(getuid(), &pwd, buf, buf_size, &result);
+         if (result)
+            break;
+
+         if (errno == ERANGE) {
+            ralloc_free(buf);
+            buf = NULL;
+            buf_size *= 2;
+         } else {
+            goto fail;
+         }
+      }
+
+      path = concatenate_and_mkdir(local, pwd.pw_dir, ".cache");
+      if (path == NULL)
+         goto fail;
+
+      path = concatenate_and_mkdir(local, path, "mesa");
+      if (path == NULL)
+         goto fail;
+   }
+
+   cache = ralloc(NULL, struct disk_cache);
+   if (cache == NULL)
+      goto fail;
+
+   cache->path = ralloc_strdup(cache, path);
+   if (cache->path == NULL)
+      goto fail;
+
+   path = ralloc_asprintf(local, "%s/index", cache->path);
+   if (path == NULL)
+      goto fail;
+
+   fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+   if (fd == -1)
+      goto fail;
+
+   if (fstat(fd, &sb) == -1)
+      goto fail;
+
+   /* Force the index file to be the expected size. */
+   size = sizeof(*cache->size) + CACHE_INDEX_MAX_KEYS * CACHE_KEY_SIZE;
+   if (sb.st_size != size) {
+      if (ftruncate(fd, size) == -1)
+         goto fail;
+   }
+
+   /* We map this shared so that other processes see updates that we
+    * make.
+    *
+    * Note: We do use atomic addition to ensure that multiple
+    * processes don't scramble the cache size recorded in the
+    * index. But we don't use any locking to prevent multiple
+    * processes from updating the same entry simultaneously. The idea
+    * is that if either result lands entirely in the index, then
+    * that's equivalent to a well-ordered write followed by an
+    * eviction and a write. On the other hand, if the simultaneous
+    * writes result in a corrupt entry, that's not really any
+    * different than both entries being evicted, (since within the
+    * guarantees of the cryptographic hash, a corrupt entry is
+    * unlikely to ever match a real cache key).
+    */
+   cache->index_mmap = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED, fd, 0);
+   if (cache->index_mmap == MAP_FAILED)
+      goto fail;
+   cache->index_mmap_size = size;
+
+   close(fd);
+   fd = -1;
+
+   cache->size = (uint64_t *) cache->index_mmap;
+   cache->stored_keys = cache->index_mmap + sizeof(uint64_t);
+
+   max_size = 0;
+
+   max_size_str = getenv("MESA_GLSL_CACHE_MAX_SIZE");
+   if (max_size_str)
+      max_size = parse_max_size(max_size_str);
+
+   /* Default to 1GB for maximum cache size. */
+   if (max_size == 0)
+      max_size = 1024*1024*1024;
+
+   cache->max_size = max_size;
+
+   /* Identify the driver build in every key.  The pointer size is included
+    * because 32-bit and 64-bit builds of the same driver share the cache
+    * directory but not their binaries.
+    */
+   char *identity = ralloc_asprintf(local, "%s\n%s\n%u",
+                                    gpu_name ? gpu_name : "",
+                                    timestamp ? timestamp : "",
+                                    (unsigned) sizeof(void *));
+   _mesa_sha1_compute(identity, strlen(identity), cache->driver_key);
+
+   ralloc_free(local);
+
+   return cache;
+
+ fail:
+   if (fd != -1)
+      close(fd);
+   if (cache)
+      ralloc_free(cache);
+   ralloc_free(local);
+
+   return NULL;
+}
+
+void
+disk_cache_destroy(struct disk_cache *cache)
+{
+   if (cache == NULL)
+      return;
+
+   munmap(cache->index_mmap, cache->index_mmap_size);
+
+   ralloc_free(cache);
+}
+
+void
+disk_cache_compute_key(struct disk_cache *cache, const void *data,
+                       size_t size, cache_key key)
+{
+   struct mesa_sha1 *ctx = _mesa_sha1_init();
+
+   _mesa_sha1_update(ctx, cache->driver_key, sizeof(cache->driver_key));
+   _mesa_sha1_update(ctx, data, size);
+   _mesa_sha1_final(ctx, key);
+}
+
+/* Return a filename within the cache's directory corresponding to 'key'. The
+ * returned filename is malloc'ed and must be freed by the caller.  The
+ * cache's ralloc context isn't used, since this is called from the
+ * compiler threads as well.
+ *
+ * Returns NULL if out of memory.
+ */
+static char *
+get_cache_file(struct disk_cache *cache, const cache_key key)
+{
+   char buf[41];
+   char *filename;
+
+   _mesa_sha1_format(buf, key);
+   if (asprintf(&filename, "%s/%c%c/%s", cache->path, buf[0], buf[1],
+                buf + 2) == -1)
+      return NULL;
+
+   return filename;
+}
+
+/* Create the directory that will be needed for the cache file for \key.
+ *
+ * Obviously, the implementation here must closely match
+ * _get_cache_file above.
+*/
+static void
+make_cache_file_directory(struct disk_cache *cache, const cache_key key)
+{
+   char *dir;
+   char buf[41];
+
+   _mesa_sha1_format(buf, key);
+   if (asprintf(&dir, "%s/%c%c", cache->path, buf[0], buf[1]) == -1)
+      return;
+
+   mkdir_if_needed(dir);
+
+   free(dir);
+}
+
+/* Cheap checksum of the payload, to reject truncated or corrupted files. */
+static uint32_t
+compute_checksum(const void *data, size_t size)
+{
+   const uint8_t *bytes = data;
+   uint32_t hash = 2166136261u;
+
+   for (size_t i = 0; i < size; i++) {
+      hash ^= bytes[i];
+      hash *= 16777619u;
+   }
+
+   return hash;
+}
+
+struct cache_file_info {
+   char *path;
+   time_t mtime;
+   off_t size;
+};
+
+static int
+compare_file_info_mtime(const void *a, const void *b)
+{
+   const struct cache_file_info *fa = a;
+   const struct cache_file_info *fb = b;
+
+   if (fa->mtime < fb->mtime)
+      return -1;
+   return fa->mtime > fb->mtime;
+}
+
+static bool
+is_cache_subdir_name(const char *name)
+{
+   return strlen(name) == 2 && isxdigit(name[0]) && isxdigit(name[1]);
+}
+
+/* Collect every item in the cache, skipping files that are still being
+ * written by some process.
+ */
+static struct cache_file_info *
+list_cache_files(struct disk_cache *cache, void *mem_ctx, unsigned *count)
+{
+   struct cache_file_info *files = NULL;
+   unsigned num_files = 0, capacity = 0;
+   DIR *dir;
+   struct dirent *entry;
+
+   dir = opendir(cache->path);
+   if (dir == NULL)
+      return NULL;
+
+   while ((entry = readdir(dir)) != NULL) {
+      if (!is_cache_subdir_name(entry->d_name))
+         continue;
+
+      char *subdir_path = ralloc_asprintf(mem_ctx, "%s/%s", cache->path,
+                                          entry->d_name);
+      DIR *subdir = opendir(subdir_path);
+      if (subdir == NULL)
+         continue;
+
+      struct dirent *file;
+      while ((file = readdir(subdir)) != NULL) {
+         size_t len = strlen(file->d_name);
+         struct stat sb;
+
+         if (file->d_name[0] == '.' ||
+             (len > 4 && strcmp(file->d_name + len - 4, ".tmp") == 0))
+            continue;
+
+         char *path = ralloc_asprintf(mem_ctx, "%s/%s", subdir_path,
+                                      file->d_name);
+         if (stat(path, &sb) == -1 || !S_ISREG(sb.st_mode))
+            continue;
+
+         if (num_files == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            files = reralloc(mem_ctx, files, struct cache_file_info,
+                             capacity);
+         }
+
+         files[num_files].path = path;
+         files[num_files].mtime = sb.st_mtime;
+         files[num_files].size = sb.st_size;
+         num_files++;
+      }
+
+      closedir(subdir);
+   }
+
+   closedir(dir);
+
+   *count = num_files;
+   return files;
+}
+
+/* Evict least recently used items until the cache is back below
+ * CACHE_EVICTION_TARGET_PERCENT of its maximum size.
+ *
+ * Items are touched whenever they are read, so the modification time of a
+ * cache file is the time it was last used.
+ */
+static void
+evict_lru_items(struct disk_cache *cache, uint64_t incoming_size)
+{
+   void *mem_ctx = ralloc_context(NULL);
+   uint64_t target = cache->max_size / 100 * CACHE_EVICTION_TARGET_PERCENT;
+   unsigned count = 0;
+   struct cache_file_info *files;
+
+   files = list_cache_files(cache, mem_ctx, &count);
+   if (files == NULL) {
+      ralloc_free(mem_ctx);
+      return;
+   }
+
+   qsort(files, count, sizeof(*files), compare_file_info_mtime);
+
+   for (unsigned i = 0; i < count; i++) {
+      if (*cache->size + incoming_size <= target)
+         break;
+
+      if (unlink(files[i].path) == 0)
+         p_atomic_add(cache->size, - (uint64_t) files[i].size);
+   }
+
+   ralloc_free(mem_ctx);
+}
+
+void
+disk_cache_remove(struct disk_cache *cache, const cache_key key)
+{
+   struct stat sb;
+
+   char *filename = get_cache_file(cache, key);
+   if (filename == NULL) {
+      return;
+   }
+
+   if (stat(filename, &sb) == -1) {
+      free(filename);
+      return;
+   }
+
+   if (unlink(filename) == 0)
+      p_atomic_add(cache->size, - (uint64_t) sb.st_size);
+
+   free(filename);
+}
+
+/* Remove a cache file that failed to load, so that the next
+ * disk_cache_put() for its key can replace it.  The file is only removed
+ * if it is still the one described by \p sb, in case another process has
+ * renamed a good copy into place in the meantime.
+ */
+static void
+remove_bad_cache_file(struct disk_cache *cache, const char *filename,
+                      const struct stat *sb)
+{
+   struct stat current;
+
+   if (stat(filename, &current) == -1 ||
+       current.st_dev != sb->st_dev || current.st_ino != sb->st_ino)
+      return;
+
+   if (unlink(filename) == 0)
+      p_atomic_add(cache->size, - (uint64_t) sb->st_size);
+}
+
+static bool
+write_all(int fd, const void *data, size_t size)
+{
+   const uint8_t *bytes = data;
+
+   while (size) {
+      ssize_t ret = write(fd, bytes, size);
+      if (ret == -1) {
+         if (errno == EINTR)
+            continue;
+         return false;
+      }
+      bytes += ret;
+      size -= ret;
+   }
+
+   return true;
+}
+
+static bool
+read_all(int fd, void *data, size_t size)
+{
+   uint8_t *bytes = data;
+
+   while (size) {
+      ssize_t ret = read(fd, bytes, size);
+      if (ret == -1) {
+         if (errno == EINTR)
+            continue;
+         return false;
+      }
+      if (ret == 0)
+         return false;
+      bytes += ret;
+      size -= ret;
+   }
+
+   return true;
+}
+
+void
+disk_cache_put(struct disk_cache *cache,
+          const cache_key key,
+          const void *data,
+          size_t size)
+{
+   int fd = -1, fd_final, err, ret;
+   char *filename = NULL, *filename_tmp = NULL;
+   struct cache_entry_header header;
+   uint64_t file_size = sizeof(header) + size;
+
+   filename = get_cache_file(cache, key);
+   if (filename == NULL)
+      goto done;
+
+   /* Write to a temporary file to allow for an atomic rename to the
+    * final destination filename, (to prevent any readers from seeing
+    * a partially written file).  A writer that crashed may have left a
+    * longer temporary file behind, which is truncated once we hold the
+    * lock on it.
+    */
+   if (asprintf(&filename_tmp, "%s.tmp", filename) == -1) {
+      filename_tmp = NULL;
+      goto done;
+   }
+
+   fd = open(filename_tmp, O_WRONLY | O_CLOEXEC | O_CREAT, 0644);
+
+   /* Make the two-character subdirectory within the cache as needed. */
+   if (fd == -1) {
+      if (errno != ENOENT)
+         goto done;
+
+      make_cache_file_directory(cache, key);
+
+      fd = open(filename_tmp, O_WRONLY | O_CLOEXEC | O_CREAT, 0644);
+      if (fd == -1)
+         goto done;
+   }
+
+   /* With the temporary file open, we take an exclusive flock on
+    * it. If the flock fails, then another process still has the file
+    * open with the flock held. So just let that file be responsible
+    * for writing the file.
+    */
+   err = flock(fd, LOCK_EX | LOCK_NB);
+   if (err == -1)
+      goto done;
+
+   if (ftruncate(fd, 0) == -1)
+      goto done;
+
+   /* Now that we have the lock on the open temporary file, we can
+    * check to see if the destination file already exists. If so,
+    * another process won the race between when we saw that the file
+    * didn't exist and now. In this case, we don't do anything more,
+    * (to ensure the size accounting of the cache doesn't get off).
+    */
+   fd_final = open(filename, O_RDONLY | O_CLOEXEC);
+   if (fd_final != -1) {
+      close(fd_final);
+      unlink(filename_tmp);
+      goto done;
+   }
+
+   /* OK, we're now on the hook to write out a file that we know is
+    * not in the cache, and is also not being written out to the cache
+    * by some other process.
+    *
+    * Before we do that, if the cache is too large, evict something
+    * else first.
+    */
+   if (*cache->size + file_size > cache->max_size)
+      evict_lru_items(cache, file_size);
+
+   /* Now, finally, write out the contents to the temporary file, then
+    * rename them atomically to the destination filename, and also
+    * perform an atomic increment of the total cache size.
+    */
+   header.magic = CACHE_FILE_MAGIC;
+   header.checksum = compute_checksum(data, size);
+   header.size = size;
+   memcpy(header.key, key, sizeof(header.key));
+
+   if (!write_all(fd, &header, sizeof(header)) ||
+       !write_all(fd, data, size)) {
+      unlink(filename_tmp);
+      goto done;
+   }
+
+   ret = rename(filename_tmp, filename);
+   if (ret == -1) {
+      unlink(filename_tmp);
+      goto done;
+   }
+
+   p_atomic_add(cache->size, file_size);
+
+ done:
+   if (fd != -1)
+      close(fd);
+   free(filename_tmp);
+   free(filename);
+}
+
+void *
+disk_cache_get(struct disk_cache *cache, const cache_key key, size_t *size)
+{
+   int fd = -1;
+   struct stat sb;
+   char *filename = NULL;
+   uint8_t *data = NULL;
+   struct cache_entry_header header;
+
+   if (size)
+      *size = 0;
+
+   filename = get_cache_file(cache, key);
+   if (filename == NULL)
+      goto fail;
+
+   fd = open(filename, O_RDONLY | O_CLOEXEC);
+   if (fd == -1)
+      goto fail;
+
+   if (fstat(fd, &sb) == -1)
+      goto fail;
+
+   if (sb.st_size < sizeof(header))
+      goto bad_file;
+
+   if (!read_all(fd, &header, sizeof(header)))
+      goto bad_file;
+
+   /* The file name only encodes the key, so check the whole key as well as
+    * the size and checksum of the payload before trusting the contents.
+    */
+   if (header.magic != CACHE_FILE_MAGIC ||
+       header.size != sb.st_size - sizeof(header) ||
+       memcmp(header.key, key, sizeof(header.key)) != 0)
+      goto bad_file;
+
+   data = malloc(header.size ? header.size : 1);
+   if (data == NULL)
+      goto fail;
+
+   if (!read_all(fd, data, header.size))
+      goto bad_file;
+
+   if (compute_checksum(data, header.size) != header.checksum)
+      goto bad_file;
+
+   /* Mark the item as recently used for eviction purposes.  The access time
+    * can't be relied upon, since many file systems are mounted noatime.
+    */
+   futimens(fd, NULL);
+
+   free(filename);
+   close(fd);
+
+   if (size)
+      *size = header.size;
+
+   return data;
+
+ bad_file:
+   remove_bad_cache_file(cache, filename, &sb);
+
+ fail:
+   free(data);
+   free(filename);
+   if (fd != -1)
+      close(fd);
+
+   return NULL;
+}
+
+void
+disk_cache_put_key(struct disk_cache *cache, const cache_key key)
+{
+   uint32_t *key_chunk = (uint32_t *) key;
+   int i = *key_chunk & CACHE_INDEX_KEY_MASK;
+   unsigned char *entry;
+
+   entry = &cache->stored_keys[i * CACHE_KEY_SIZE];
+
+   memcpy(entry, key, CACHE_KEY_SIZE);
+}
+
+/* This function lets us test whether a given key was previously
+ * stored in the cache with disk_cache_put_key(). The implement is
+ * efficient by not using syscalls or hitting the disk. It's not
+ * race-free, but the races are benign. If we race with someone else
+ * calling disk_cache_put_key, then that's just an extra cache miss and an
+ * extra recompile.
+ */
+bool
+disk_cache_has_key(struct disk_cache *cache, const cache_key key)
+{
+   uint32_t *key_chunk = (uint32_t *) key;
+   int i = *key_chunk & CACHE_INDEX_KEY_MASK;
+   unsigned char *entry;
+
+   entry = &cache->stored_keys[i * CACHE_KEY_SIZE];
+
+   return memcmp(entry, key, CACHE_KEY_SIZE) == 0;
+}
+
+bool
+disk_cache_get_function_timestamp(void *ptr, uint32_t *timestamp)
+{
+#ifdef HAVE_DLADDR
+   Dl_info info;
+   struct stat st;
+
+   if (!dladdr(ptr, &info) || !info.dli_fname)
+      return false;
+
+   if (stat(info.dli_fname, &st))
+      return false;
+
+   *timestamp = st.st_mtime;
+   return true;
+#else
+   return false;
+#endif
+}
+
+#endif /* ENABLE_SHADER_CACHE */
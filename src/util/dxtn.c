@@ -0,0 +1,634 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *
+ */
+
+/**
+ * \file dxtn.c
+ *
+ * DXT1, DXT3 and DXT5 block encoder.
+ *
+ * The color endpoints start out as the pixels at both ends of the principal
+ * axis of the block's colors (a "range fit"), and are then refined with a
+ * least-squares fit to the indices they produced.  Choosing the index of
+ * every pixel is the bulk of the work and is done four pixels at a time with
+ * SSE2 where available.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "dxtn.h"
+
+/** Pixels with an alpha below this are transparent in DXT1 RGBA */
+#define DXT1_ALPHA_THRESHOLD 128
+
+unsigned
+util_format_dxtn_quality(void)
+{
+   static const unsigned levels[] = {
+      UTIL_DXTN_QUALITY_FAST,
+      UTIL_DXTN_QUALITY_DEFAULT,
+      UTIL_DXTN_QUALITY_MAX,
+   };
+   const char *env = getenv("MESA_TEXCOMPRESS_QUALITY");
+   unsigned preset;
+
+   if (env == NULL)
+      return UTIL_DXTN_QUALITY_DEFAULT;
+
+   preset = strtoul(env, NULL, 10);
+   return levels[preset < 2 ? preset : 2];
+}
+
+static inline uint16_t
+pack_565(const int rgb[3])
+{
+   return ((rgb[0] * 31 + 127) / 255) << 11 |
+          ((rgb[1] * 63 + 127) / 255) << 5 |
+          ((rgb[2] * 31 + 127) / 255);
+}
+
+static inline void
+unpack_565(uint16_t color, int rgb[3])
+{
+   const int r = color >> 11, g = (color >> 5) & 0x3f, b = color & 0x1f;
+
+   rgb[0] = (r << 3) | (r >> 2);
+   rgb[1] = (g << 2) | (g >> 4);
+   rgb[2] = (b << 3) | (b >> 2);
+}
+
+/**
+ * Compute the colors a decoder derives from the endpoints.  \p three selects
+ * the mode with three colors and transparent black.
+ */
+static void
+color_palette(uint16_t c0, uint16_t c1, bool three, int palette[4][3])
+{
+   int k;
+
+   unpack_565(c0, palette[0]);
+   unpack_565(c1, palette[1]);
+
+   for (k = 0; k < 3; k++) {
+      if (three) {
+         palette[2][k] = (palette[0][k] + palette[1][k]) / 2;
+         palette[3][k] = 0;
+      } else {
+         palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+         palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+      }
+   }
+}
+
+/**
+ * Find the closest of the first \p count palette colors for every pixel.
+ *
+ * Ties go to the lower index, in both implementations.
+ */
+#if defined(__SSE2__)
+
+static inline __m128i
+color_distance4(__m128i lo, __m128i hi, __m128i color)
+{
+   __m128i dl = _mm_sub_epi16(lo, color);
+   __m128i dh = _mm_sub_epi16(hi, color);
+
+   /* r*r + g*g and b*b for each pixel, then their sums in lanes 0 and 2 */
+   dl = _mm_madd_epi16(dl, dl);
+   dh = _mm_madd_epi16(dh, dh);
+   dl = _mm_add_epi32(dl, _mm_srli_epi64(dl, 32));
+   dh = _mm_add_epi32(dh, _mm_srli_epi64(dh, 32));
+
+   return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(dl),
+                                          _mm_castsi128_ps(dh),
+                                          _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+static void
+match_colors(const uint8_t px[16][4], const int palette[4][3],
+             unsigned count, uint8_t index[16], uint32_t error[16])
+{
+   const __m128i rgb_mask = _mm_set1_epi32(0x00ffffff);
+   const __m128i zero = _mm_setzero_si128();
+   __m128i colors[4];
+   unsigned g, k;
+
+   for (k = 0; k < count; k++) {
+      colors[k] = _mm_set_epi16(0, palette[k][2], palette[k][1], palette[k][0],
+                                0, palette[k][2], palette[k][1], palette[k][0]);
+   }
+
+   for (g = 0; g < 4; g++) {
+      const __m128i pixels =
+         _mm_and_si128(_mm_loadu_si128((const __m128i *) px[4 * g]), rgb_mask);
+      const __m128i lo = _mm_unpacklo_epi8(pixels, zero);
+      const __m128i hi = _mm_unpackhi_epi8(pixels, zero);
+      __m128i best = color_distance4(lo, hi, colors[0]);
+      __m128i best_index = zero;
+      uint32_t indices[4];
+
+      for (k = 1; k < count; k++) {
+         const __m128i dist = color_distance4(lo, hi, colors[k]);
+         const __m128i closer = _mm_cmplt_epi32(dist, best);
+
+         best = _mm_or_si128(_mm_and_si128(closer, dist),
+                             _mm_andnot_si128(closer, best));
+         best_index = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(k)),
+                                   _mm_andnot_si128(closer, best_index));
+      }
+
+      _mm_storeu_si128((__m128i *) &error[4 * g], best);
+      _mm_storeu_si128((__m128i *) indices, best_index);
+      for (k = 0; k < 4; k++)
+         index[4 * g + k] = indices[k];
+   }
+}
+
+#else
+
+static void
+match_colors(const uint8_t px[16][4], const int palette[4][3],
+             unsigned count, uint8_t index[16], uint32_t error[16])
+{
+   unsigned i, k;
+
+   for (i = 0; i < 16; i++) {
+      uint32_t best = ~0u;
+
+      for (k = 0; k < count; k++) {
+         const int dr = px[i][0] - palette[k][0];
+         const int dg = px[i][1] - palette[k][1];
+         const int db = px[i][2] - palette[k][2];
+         const uint32_t dist = dr * dr + dg * dg + db * db;
+
+         if (dist < best) {
+            best = dist;
+            index[i] = k;
+         }
+      }
+
+      error[i] = best;
+   }
+}
+
+#endif
+
+/**
+ * Choose the indices for the endpoints \p c0 and \p c1.
+ *
+ * \return the squared error of the pixels that are not transparent.
+ */
+static uint32_t
+fit_colors(const uint8_t px[16][4], uint16_t c0, uint16_t c1,
+           uint16_t transparent, uint8_t index[16])
+{
+   const bool three = transparent != 0;
+   int palette[4][3];
+   uint32_t error[16], total = 0;
+   unsigned i;
+
+   color_palette(c0, c1, three, palette);
+   match_colors(px, palette, three ? 3 : 4, index, error);
+
+   for (i = 0; i < 16; i++) {
+      if (transparent & (1 << i))
+         index[i] = 3;
+      else
+         total += error[i];
+   }
+
+   return total;
+}
+
+/**
+ * Order the endpoints for the decoder: c0 > c1 selects four colors, and
+ * c0 <= c1 three colors and transparent black.
+ */
+static inline void
+order_endpoints(uint16_t *c0, uint16_t *c1, bool three)
+{
+   if (three ? *c0 > *c1 : *c0 < *c1) {
+      const uint16_t tmp = *c0;
+      *c0 = *c1;
+      *c1 = tmp;
+   }
+}
+
+/**
+ * Return the pixels of \p mask with the lowest and the highest projection on
+ * the principal axis of their colors.
+ */
+static void
+range_fit(const uint8_t px[16][4], uint16_t mask, int lo[3], int hi[3])
+{
+   float mean[3] = { 0.0f, 0.0f, 0.0f };
+   float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+   float axis[3], min_dot, max_dot;
+   int min_c[3] = { 255, 255, 255 }, max_c[3] = { 0, 0, 0 };
+   unsigned i, k, n = 0, iter, min_i = 0, max_i = 0;
+
+   for (i = 0; i < 16; i++) {
+      if (!(mask & (1 << i)))
+         continue;
+
+      for (k = 0; k < 3; k++) {
+         mean[k] += px[i][k];
+         if (px[i][k] < min_c[k])
+            min_c[k] = px[i][k];
+         if (px[i][k] > max_c[k])
+            max_c[k] = px[i][k];
+      }
+      n++;
+   }
+
+   for (k = 0; k < 3; k++)
+      mean[k] /= n;
+
+   for (i = 0; i < 16; i++) {
+      float r, g, b;
+
+      if (!(mask & (1 << i)))
+         continue;
+
+      r = px[i][0] - mean[0];
+      g = px[i][1] - mean[1];
+      b = px[i][2] - mean[2];
+      cov[0] += r * r;
+      cov[1] += r * g;
+      cov[2] += r * b;
+      cov[3] += g * g;
+      cov[4] += g * b;
+      cov[5] += b * b;
+   }
+
+   /* Power iteration, starting from the diagonal of the bounding box */
+   for (k = 0; k < 3; k++)
+      axis[k] = max_c[k] - min_c[k];
+
+   for (iter = 0; iter < 4; iter++) {
+      const float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+      const float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+      const float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+      float m = x < 0.0f ? -x : x;
+
+      if ((y < 0.0f ? -y : y) > m)
+         m = y < 0.0f ? -y : y;
+      if ((z < 0.0f ? -z : z) > m)
+         m = z < 0.0f ? -z : z;
+      if (m == 0.0f)
+         break;
+
+      axis[0] = x / m;
+      axis[1] = y / m;
+      axis[2] = z / m;
+   }
+
+   min_dot = 1e30f;
+   max_dot = -1e30f;
+   for (i = 0; i < 16; i++) {
+      float dot;
+
+      if (!(mask & (1 << i)))
+         continue;
+
+      dot = px[i][0] * axis[0] + px[i][1] * axis[1] + px[i][2] * axis[2];
+      if (dot < min_dot) {
+         min_dot = dot;
+         min_i = i;
+      }
+      if (dot > max_dot) {
+         max_dot = dot;
+         max_i = i;
+      }
+   }
+
+   for (k = 0; k < 3; k++) {
+      lo[k] = px[min_i][k];
+      hi[k] = px[max_i][k];
+   }
+}
+
+/**
+ * Solve for the endpoints that reproduce the pixels of \p mask best with the
+ * given indices.
+ *
+ * \return false if the indices don't determine both endpoints.
+ */
+static bool
+least_squares_fit(const uint8_t px[16][4], const uint8_t index[16],
+                  uint16_t mask, bool three, uint16_t *c0, uint16_t *c1)
+{
+   /* The weight of c0 for each index; c1 gets the rest. */
+   static const float weights4[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+   static const float weights3[4] = { 1.0f, 0.0f, 0.5f, 0.0f };
+   const float *weights = three ? weights3 : weights4;
+   float aa = 0.0f, bb = 0.0f, ab = 0.0f, det;
+   float ax[3] = { 0.0f, 0.0f, 0.0f }, bx[3] = { 0.0f, 0.0f, 0.0f };
+   int e0[3], e1[3];
+   unsigned i, k;
+
+   for (i = 0; i < 16; i++) {
+      float a, b;
+
+      if (!(mask & (1 << i)))
+         continue;
+
+      a = weights[index[i]];
+      b = 1.0f - a;
+      aa += a * a;
+      bb += b * b;
+      ab += a * b;
+      for (k = 0; k < 3; k++) {
+         ax[k] += a * px[i][k];
+         bx[k] += b * px[i][k];
+      }
+   }
+
+   det = aa * bb - ab * ab;
+   if (det < 1e-4f)
+      return false;
+
+   for (k = 0; k < 3; k++) {
+      const float v0 = (ax[k] * bb - bx[k] * ab) / det;
+      const float v1 = (bx[k] * aa - ax[k] * ab) / det;
+
+      e0[k] = v0 <= 0.0f ? 0 : v0 >= 255.0f ? 255 : (int) (v0 + 0.5f);
+      e1[k] = v1 <= 0.0f ? 0 : v1 >= 255.0f ? 255 : (int) (v1 + 0.5f);
+   }
+
+   *c0 = pack_565(e0);
+   *c1 = pack_565(e1);
+   return true;
+}
+
+static void
+encode_color_block(uint8_t *blkaddr, const uint8_t px[16][4],
+                   uint16_t transparent, unsigned quality)
+{
+   const uint16_t opaque = ~transparent;
+   const bool three = transparent != 0;
+   uint16_t c0 = 0, c1 = 0;
+   uint8_t index[16];
+   uint32_t bits = 0;
+   unsigned i, q;
+
+   if (opaque == 0) {
+      memset(index, 3, sizeof(index));
+   } else {
+      uint8_t try_index[16];
+      uint32_t error;
+      int lo[3], hi[3];
+
+      range_fit(px, opaque, lo, hi);
+      c0 = pack_565(hi);
+      c1 = pack_565(lo);
+      order_endpoints(&c0, &c1, three);
+      error = fit_colors(px, c0, c1, transparent, index);
+
+      for (q = 0; q < quality && error > 0; q++) {
+         uint16_t t0, t1;
+         uint32_t try_error;
+
+         if (!least_squares_fit(px, index, opaque, three, &t0, &t1))
+            break;
+
+         order_endpoints(&t0, &t1, three);
+         if (t0 == c0 && t1 == c1)
+            break;
+
+         try_error = fit_colors(px, t0, t1, transparent, try_index);
+         if (try_error >= error)
+            break;
+
+         c0 = t0;
+         c1 = t1;
+         error = try_error;
+         memcpy(index, try_index, sizeof(index));
+      }
+   }
+
+   for (i = 0; i < 16; i++)
+      bits |= (uint32_t) index[i] << (2 * i);
+
+   blkaddr[0] = c0 & 0xff;
+   blkaddr[1] = c0 >> 8;
+   blkaddr[2] = c1 & 0xff;
+   blkaddr[3] = c1 >> 8;
+   blkaddr[4] = bits & 0xff;
+   blkaddr[5] = (bits >> 8) & 0xff;
+   blkaddr[6] = (bits >> 16) & 0xff;
+   blkaddr[7] = bits >> 24;
+}
+
+static void
+encode_dxt3_alpha_block(uint8_t *blkaddr, const uint8_t px[16][4])
+{
+   unsigned i;
+
+   for (i = 0; i < 16; i += 2) {
+      blkaddr[i / 2] = (px[i][3] * 15 + 127) / 255 |
+                       ((px[i + 1][3] * 15 + 127) / 255) << 4;
+   }
+}
+
+/**
+ * Choose the indices for the DXT5 alpha endpoints \p a0 and \p a1, the same
+ * way as for the colors.
+ */
+static uint32_t
+fit_alpha(const uint8_t px[16][4], int a0, int a1, uint8_t index[16])
+{
+   int palette[8];
+   uint32_t total = 0;
+   unsigned i, k;
+
+   palette[0] = a0;
+   palette[1] = a1;
+   if (a0 > a1) {
+      for (k = 2; k < 8; k++)
+         palette[k] = ((8 - k) * a0 + (k - 1) * a1) / 7;
+   } else {
+      for (k = 2; k < 6; k++)
+         palette[k] = ((6 - k) * a0 + (k - 1) * a1) / 5;
+      palette[6] = 0;
+      palette[7] = 255;
+   }
+
+   for (i = 0; i < 16; i++) {
+      uint32_t best = ~0u;
+
+      for (k = 0; k < 8; k++) {
+         const int d = px[i][3] - palette[k];
+
+         if ((uint32_t) (d * d) < best) {
+            best = d * d;
+            index[i] = k;
+         }
+      }
+
+      total += best;
+   }
+
+   return total;
+}
+
+static void
+encode_dxt5_alpha_block(uint8_t *blkaddr, const uint8_t px[16][4],
+                        unsigned quality)
+{
+   int min_a = 255, max_a = 0, min_inner = 255, max_inner = 0;
+   int a0, a1;
+   uint8_t index[16];
+   uint64_t bits = 0;
+   unsigned i;
+
+   for (i = 0; i < 16; i++) {
+      const int a = px[i][3];
+
+      if (a < min_a)
+         min_a = a;
+      if (a > max_a)
+         max_a = a;
+      if (a != 0 && a != 255) {
+         if (a < min_inner)
+            min_inner = a;
+         if (a > max_inner)
+            max_inner = a;
+      }
+   }
+
+   /* Eight interpolated values between the extremes */
+   a0 = max_a;
+   a1 = min_a;
+
+   if (max_a == min_a) {
+      memset(index, 0, sizeof(index));
+   } else {
+      uint32_t error = fit_alpha(px, a0, a1, index);
+
+      /* Six values between the other alphas, plus exact 0 and 255 */
+      if (quality > 0 && min_inner <= max_inner &&
+          (min_a == 0 || max_a == 255)) {
+         uint8_t try_index[16];
+
+         if (fit_alpha(px, min_inner, max_inner, try_index) < error) {
+            a0 = min_inner;
+            a1 = max_inner;
+            memcpy(index, try_index, sizeof(index));
+         }
+      }
+   }
+
+   for (i = 0; i < 16; i++)
+      bits |= (uint64_t) index[i] << (3 * i);
+
+   blkaddr[0] = a0;
+   blkaddr[1] = a1;
+   for (i = 0; i < 6; i++)
+      blkaddr[2 + i] = (bits >> (8 * i)) & 0xff;
+}
+
+/**
+ * Encode a block of 4x4 RGBA pixels, indexed [row][column][component].
+ */
+void
+util_format_encode_dxtn_block(uint8_t *blkaddr,
+                              uint8_t srccolors[4][4][4],
+                              enum util_dxtn_format format,
+                              unsigned quality)
+{
+   const uint8_t (*px)[4] = (const uint8_t (*)[4]) srccolors;
+   uint16_t transparent = 0;
+   unsigned i;
+
+   switch (format) {
+   case UTIL_DXTN_DXT1_RGBA:
+      for (i = 0; i < 16; i++) {
+         if (px[i][3] < DXT1_ALPHA_THRESHOLD)
+            transparent |= 1 << i;
+      }
+      encode_color_block(blkaddr, px, transparent, quality);
+      break;
+   case UTIL_DXTN_DXT1_RGB:
+      encode_color_block(blkaddr, px, 0, quality);
+      break;
+   case UTIL_DXTN_DXT3_RGBA:
+      encode_dxt3_alpha_block(blkaddr, px);
+      encode_color_block(blkaddr + 8, px, 0, quality);
+      break;
+   case UTIL_DXTN_DXT5_RGBA:
+      encode_dxt5_alpha_block(blkaddr, px, quality);
+      encode_color_block(blkaddr + 8, px, 0, quality);
+      break;
+   }
+}
+
+/**
+ * Encode an image of RGB or RGBA pixels.
+ *
+ * \p dst_stride is the distance between rows of blocks.  Blocks that extend
+ * past the right or bottom edge repeat the last column or row of pixels.
+ */
+void
+util_format_encode_dxtn(enum util_dxtn_format format, unsigned quality,
+                        const uint8_t *src, unsigned src_comps,
+                        int src_stride, unsigned width, unsigned height,
+                        uint8_t *dst, int dst_stride)
+{
+   const unsigned block_size =
+      format == UTIL_DXTN_DXT1_RGB || format == UTIL_DXTN_DXT1_RGBA ? 8 : 16;
+   unsigned x, y, i, j;
+
+   for (y = 0; y < height; y += 4) {
+      uint8_t *blkaddr = dst;
+
+      for (x = 0; x < width; x += 4) {
+         uint8_t srccolors[4][4][4];
+
+         for (j = 0; j < 4; j++) {
+            const unsigned row = y + j < height ? y + j : height - 1;
+
+            for (i = 0; i < 4; i++) {
+               const unsigned col = x + i < width ? x + i : width - 1;
+               const uint8_t *p = src + row * src_stride + col * src_comps;
+
+               srccolors[j][i][0] = p[0];
+               srccolors[j][i][1] = p[1];
+               srccolors[j][i][2] = p[2];
+               srccolors[j][i][3] = src_comps == 4 ? p[3] : 255;
+            }
+         }
+
+         util_format_encode_dxtn_block(blkaddr, srccolors, format, quality);
+         blkaddr += block_size;
+      }
+
+      dst += dst_stride;
+   }
+}
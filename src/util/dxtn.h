@@ -0,0 +1,74 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *
+ */
+
+#ifndef _DXTN_H
+#define _DXTN_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum util_dxtn_format {
+   UTIL_DXTN_DXT1_RGB,
+   UTIL_DXTN_DXT1_RGBA,
+   UTIL_DXTN_DXT3_RGBA,
+   UTIL_DXTN_DXT5_RGBA,
+};
+
+/**
+ * Encoder quality levels.
+ *
+ * Level 0 picks the color endpoints from the pixels at the ends of the
+ * principal axis of the block.  Each further level refines them once more
+ * with a least-squares fit to the chosen indices, and from level 1 on DXT5
+ * alpha also tries the endpoints that leave 0 and 255 to the fixed indices.
+ */
+#define UTIL_DXTN_QUALITY_FAST    0
+#define UTIL_DXTN_QUALITY_DEFAULT 1
+#define UTIL_DXTN_QUALITY_MAX     3
+
+/**
+ * Return the quality level for the preset in MESA_TEXCOMPRESS_QUALITY, which
+ * the BPTC and ETC2 encoders use as well: 0 selects the fast level, 1 the
+ * default one and 2 the maximum.
+ */
+unsigned util_format_dxtn_quality(void);
+
+void util_format_encode_dxtn_block(uint8_t *blkaddr,
+                                   uint8_t srccolors[4][4][4],
+                                   enum util_dxtn_format format,
+                                   unsigned quality);
+
+void util_format_encode_dxtn(enum util_dxtn_format format, unsigned quality,
+                             const uint8_t *src, unsigned src_comps,
+                             int src_stride, unsigned width, unsigned height,
+                             uint8_t *dst, int dst_stride);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DXTN_H */
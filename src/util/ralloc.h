@@ -407,6 +407,129 @@ bool ralloc_asprintf_append (char **str, const char *fmt, ...)
 bool ralloc_vasprintf_append(char **str, const char *fmt, va_list args);
 /// @}
 
+/**
+ * \name Linear allocator
+ *
+ * The linear allocator is a fast allocator for many small objects that all
+ * share the lifetime of one ralloc context.  Suballocations are carved out
+ * of large buffers which are themselves ralloc'd children of that context,
+ * so there is no per-object header with parent/sibling links and no
+ * per-object malloc.
+ *
+ * The linear parent is the first allocation and it identifies the whole
+ * pool.  Linear children are allocated from the parent and can't be freed,
+ * stolen or used as ralloc contexts individually.  They are all released
+ * together, either by \c linear_free_parent or by freeing the ralloc
+ * context the linear parent was allocated from.
+ *
+ * Destructors are never run for linear allocations.
+ *
+ * Typical usage:
+ * \code
+ * void *linctx = linear_alloc_parent(mem_ctx, 0);
+ * struct foo *f = linear_alloc_child(linctx, sizeof(struct foo));
+ * char *s = linear_strdup(linctx, "hello");
+ * ...
+ * ralloc_free(mem_ctx);   // frees linctx, f and s
+ * \endcode
+ */
+/// @{
+
+/**
+ * Allocate the linear parent node from \p ralloc_ctx.
+ *
+ * \p ralloc_ctx must not be \c NULL.  \p size can be 0, in which case the
+ * returned pointer is only useful as the parent of linear children.
+ */
+void *linear_alloc_parent(void *ralloc_ctx, unsigned size) MALLOCLIKE;
+
+/**
+ * Same as \c linear_alloc_parent, but zero the parent allocation.
+ */
+void *linear_zalloc_parent(void *ralloc_ctx, unsigned size) MALLOCLIKE;
+
+/**
+ * Allocate \p size bytes out of the pool identified by \p parent.
+ *
+ * The memory is not zeroed.
+ */
+void *linear_alloc_child(void *parent, unsigned size) MALLOCLIKE;
+
+/**
+ * Same as \c linear_alloc_child, but zero the allocation.
+ */
+void *linear_zalloc_child(void *parent, unsigned size) MALLOCLIKE;
+
+/**
+ * Free the linear parent and all of its children.
+ */
+void linear_free_parent(void *ptr);
+
+/**
+ * Move the linear parent and all of its children to \p new_ralloc_ctx.
+ */
+void ralloc_steal_linear_parent(void *new_ralloc_ctx, void *ptr);
+
+/**
+ * Return the ralloc context the linear parent was allocated from.
+ */
+void *ralloc_parent_of_linear_parent(void *ptr);
+
+/**
+ * Allocate a new linear child of \p new_size bytes and copy the contents
+ * of \p old into it.
+ *
+ * The old allocation is not released; it lives until the pool is freed.
+ */
+void *linear_realloc(void *parent, void *old, unsigned new_size);
+
+/**
+ * Duplicate a string, allocating the copy from the linear pool.
+ */
+char *linear_strdup(void *parent, const char *str);
+
+/**
+ * Print into a string allocated from the linear pool.
+ */
+char *linear_asprintf(void *parent, const char *fmt, ...) PRINTFLIKE(2, 3);
+
+/**
+ * va_list version of \c linear_asprintf.
+ */
+char *linear_vasprintf(void *parent, const char *fmt, va_list args);
+
+/**
+ * Linear pool versions of \c ralloc_asprintf_append,
+ * \c ralloc_asprintf_rewrite_tail, \c ralloc_strcat and
+ * \c ralloc_strncat.
+ *
+ * \p str must have been allocated from the same linear pool.  Since linear
+ * children can't grow in place, each call reallocates the string.
+ */
+bool linear_asprintf_append(void *parent, char **str, const char *fmt, ...)
+   PRINTFLIKE(3, 4);
+bool linear_vasprintf_append(void *parent, char **str, const char *fmt,
+                             va_list args);
+bool linear_asprintf_rewrite_tail(void *parent, char **str, size_t *start,
+                                  const char *fmt, ...) PRINTFLIKE(4, 5);
+bool linear_vasprintf_rewrite_tail(void *parent, char **str, size_t *start,
+                                   const char *fmt, va_list args);
+bool linear_strcat(void *parent, char **dest, const char *str);
+bool linear_strncat(void *parent, char **dest, const char *str, size_t n);
+
+/**
+ * Allocate an array of \p count objects of \p type from the linear pool.
+ */
+#define linear_alloc_child_array(parent, type, count) \
+   ((type *) linear_alloc_child(parent, sizeof(type) * (count)))
+
+/**
+ * Same as \c linear_alloc_child_array, but zero the array.
+ */
+#define linear_zalloc_child_array(parent, type, count) \
+   ((type *) linear_zalloc_child(parent, sizeof(type) * (count)))
+/// @}
+
 #ifdef __cplusplus
 } /* end of extern "C" */
 #endif
@@ -421,7 +544,7 @@ bool ralloc_vasprintf_append(char **str, const char *fmt, va_list args);
  *
  * which is more idiomatic in C++ than calling ralloc.
  */
-#define DECLARE_RALLOC_CXX_OPERATORS(TYPE)                               \
+#define DECLARE_ALLOC_CXX_OPERATORS_TEMPLATE(TYPE, ALLOC_FUNC)           \
 private:                                                                 \
    static void _ralloc_destructor(void *p)                               \
    {                                                                     \
@@ -430,7 +553,7 @@ private:                                                                 \
 public:                                                                  \
    static void* operator new(size_t size, void *mem_ctx)                 \
    {                                                                     \
-      void *p = ralloc_size(mem_ctx, size);                              \
+      void *p = ALLOC_FUNC(mem_ctx, size);                               \
       assert(p != NULL);                                                 \
       if (!HAS_TRIVIAL_DESTRUCTOR(TYPE))                                 \
          ralloc_set_destructor(p, _ralloc_destructor);                   \
@@ -448,5 +571,34 @@ public:                                                                  \
       ralloc_free(p);                                                    \
    }
 
+#define DECLARE_RALLOC_CXX_OPERATORS(type) \
+   DECLARE_ALLOC_CXX_OPERATORS_TEMPLATE(type, ralloc_size)
+
+/**
+ * Declare C++ new and delete operators which use the linear allocator.
+ *
+ * \c new takes the linear parent instead of a ralloc context.  Linear
+ * allocations can't be freed individually and their destructors are never
+ * run when the pool is released, so \c delete only runs the destructor.
+ */
+#define DECLARE_LINEAR_ALLOC_CXX_OPERATORS_TEMPLATE(TYPE, ALLOC_FUNC)    \
+public:                                                                  \
+   static void* operator new(size_t size, void *mem_ctx)                 \
+   {                                                                     \
+      void *p = ALLOC_FUNC(mem_ctx, size);                               \
+      assert(p != NULL);                                                 \
+      return p;                                                          \
+   }                                                                     \
+                                                                         \
+   static void operator delete(void *p)                                  \
+   {                                                                     \
+      /* The memory is released together with the linear parent. */     \
+   }
+
+#define DECLARE_LINEAR_ALLOC_CXX_OPERATORS(type) \
+   DECLARE_LINEAR_ALLOC_CXX_OPERATORS_TEMPLATE(type, linear_alloc_child)
+
+#define DECLARE_LINEAR_ZALLOC_CXX_OPERATORS(type) \
+   DECLARE_LINEAR_ALLOC_CXX_OPERATORS_TEMPLATE(type, linear_zalloc_child)
 
 #endif
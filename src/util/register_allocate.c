@@ -71,6 +71,7 @@
  */
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "ralloc.h"
 #include "main/imports.h"
@@ -81,6 +82,12 @@
 
 #define NO_REG ~0U
 
+/**
+ * Largest interference graph that gets an adjacency matrix.  A graph of this
+ * size takes 2MB for the matrix.
+ */
+#define RA_MAX_DENSE_NODES 4096
+
 struct ra_reg {
    BITSET_WORD *conflicts;
    unsigned int *conflict_list;
@@ -127,7 +134,6 @@ struct ra_node {
     * List of which nodes this node interferes with.  This should be
     * symmetric with the other node.
     */
-   BITSET_WORD *adjacency;
    unsigned int *adjacency_list;
    unsigned int adjacency_list_size;
    unsigned int adjacency_count;
@@ -156,6 +162,25 @@ struct ra_node {
     * approximate cost of spilling this node.
     */
    float spill_cost;
+
+   /**
+    * Position of the node in the optimistic heap during ra_simplify(), or
+    * NO_REG if it isn't in the heap.
+    */
+   unsigned int heap_index;
+};
+
+/**
+ * Set of the edges of an interference graph that is too large for an
+ * adjacency matrix.
+ *
+ * This is an open-addressing hash set of (n1 << 32 | n2) keys with n1 < n2,
+ * so 0 is never a valid key and marks an empty slot.
+ */
+struct ra_edge_set {
+   uint64_t *keys;
+   unsigned int size; /**< Number of slots, a power of two. */
+   unsigned int entries;
 };
 
 struct ra_graph {
@@ -166,6 +191,16 @@ struct ra_graph {
    struct ra_node *nodes;
    unsigned int count; /**< count of nodes. */
 
+   /**
+    * Adjacency matrix, with a row of BITSET_WORDS(count) words per node.
+    *
+    * It takes O(n^2) memory, so it is only used for graphs of up to
+    * RA_MAX_DENSE_NODES nodes.  Larger graphs record their edges in
+    * \c edges instead.
+    */
+   BITSET_WORD *adjacency;
+   struct ra_edge_set edges;
+
    unsigned int *stack;
    unsigned int stack_count;
 
@@ -390,8 +425,6 @@ ra_set_finalize(struct ra_regs *regs, unsigned int **q_values)
 static void
 ra_add_node_adjacency(struct ra_graph *g, unsigned int n1, unsigned int n2)
 {
-   BITSET_SET(g->nodes[n1].adjacency, n2);
-
    if (n1 != n2) {
       int n1_class = g->nodes[n1].class;
       int n2_class = g->nodes[n2].class;
@@ -410,6 +443,71 @@ ra_add_node_adjacency(struct ra_graph *g, unsigned int n1, unsigned int n2)
    g->nodes[n1].adjacency_count++;
 }
 
+static unsigned int
+ra_edge_set_slot(const struct ra_edge_set *set, uint64_t key)
+{
+   uint32_t hash = (key * 0x9e3779b97f4a7c15ull) >> 32;
+
+   return hash & (set->size - 1);
+}
+
+static void
+ra_edge_set_grow(struct ra_graph *g, unsigned int size)
+{
+   struct ra_edge_set *set = &g->edges;
+   uint64_t *old_keys = set->keys;
+   unsigned int old_size = set->size;
+   unsigned int i;
+
+   set->keys = rzalloc_array(g, uint64_t, size);
+   set->size = size;
+
+   for (i = 0; i < old_size; i++) {
+      unsigned int slot;
+
+      if (!old_keys[i])
+         continue;
+
+      slot = ra_edge_set_slot(set, old_keys[i]);
+      while (set->keys[slot])
+         slot = (slot + 1) & (size - 1);
+      set->keys[slot] = old_keys[i];
+   }
+
+   ralloc_free(old_keys);
+}
+
+/**
+ * Adds the edge between n1 and n2 to the edge set.
+ *
+ * Returns false if the edge was already there.
+ */
+static bool
+ra_edge_set_add(struct ra_graph *g, unsigned int n1, unsigned int n2)
+{
+   struct ra_edge_set *set = &g->edges;
+   uint64_t key;
+   unsigned int slot;
+
+   key = n1 < n2 ? (uint64_t)n1 << 32 | n2 : (uint64_t)n2 << 32 | n1;
+
+   /* Keep the load factor under one half so that probe sequences stay
+    * short.
+    */
+   if (set->entries * 2 >= set->size)
+      ra_edge_set_grow(g, set->size * 2);
+
+   for (slot = ra_edge_set_slot(set, key); set->keys[slot];
+        slot = (slot + 1) & (set->size - 1)) {
+      if (set->keys[slot] == key)
+         return false;
+   }
+
+   set->keys[slot] = key;
+   set->entries++;
+   return true;
+}
+
 struct ra_graph *
 ra_alloc_interference_graph(struct ra_regs *regs, unsigned int count)
 {
@@ -423,16 +521,23 @@ ra_alloc_interference_graph(struct ra_regs *regs, unsigned int count)
 
    g->stack = rzalloc_array(g, unsigned int, count);
 
-   for (i = 0; i < count; i++) {
-      int bitset_count = BITSET_WORDS(count);
-      g->nodes[i].adjacency = rzalloc_array(g, BITSET_WORD, bitset_count);
+   if (count <= RA_MAX_DENSE_NODES) {
+      g->adjacency = rzalloc_array(g, BITSET_WORD,
+                                   count * BITSET_WORDS(count));
+   } else {
+      /* Start out with room for a few edges per node. */
+      ra_edge_set_grow(g, util_next_power_of_two(count * 4));
+   }
 
+   for (i = 0; i < count; i++) {
       g->nodes[i].adjacency_list_size = 4;
       g->nodes[i].adjacency_list =
          ralloc_array(g, unsigned int, g->nodes[i].adjacency_list_size);
       g->nodes[i].adjacency_count = 0;
       g->nodes[i].q_total = 0;
 
+      if (g->adjacency)
+         BITSET_SET(g->adjacency + i * BITSET_WORDS(count), i);
       ra_add_node_adjacency(g, i, i);
       g->nodes[i].reg = NO_REG;
    }
@@ -451,10 +556,23 @@ void
 ra_add_node_interference(struct ra_graph *g,
                          unsigned int n1, unsigned int n2)
 {
-   if (!BITSET_TEST(g->nodes[n1].adjacency, n2)) {
-      ra_add_node_adjacency(g, n1, n2);
-      ra_add_node_adjacency(g, n2, n1);
+   if (g->adjacency) {
+      BITSET_WORD *row1 = g->adjacency + n1 * BITSET_WORDS(g->count);
+      BITSET_WORD *row2 = g->adjacency + n2 * BITSET_WORDS(g->count);
+
+      if (BITSET_TEST(row1, n2))
+         return;
+
+      BITSET_SET(row1, n2);
+      BITSET_SET(row2, n1);
+   } else {
+      /* Every node is already adjacent to itself. */
+      if (n1 == n2 || !ra_edge_set_add(g, n1, n2))
+         return;
    }
+
+   ra_add_node_adjacency(g, n1, n2);
+   ra_add_node_adjacency(g, n2, n1);
 }
 
 static bool
@@ -465,8 +583,166 @@ pq_test(struct ra_graph *g, unsigned int n)
    return g->nodes[n].q_total < g->regs->classes[n_class]->p;
 }
 
+/**
+ * Worklists for ra_simplify().
+ *
+ * Simplification used to make repeated passes over all of the nodes, from
+ * the highest numbered one down, pushing every trivially colorable node it
+ * came across, until a pass made no progress.  That is quadratic in the
+ * number of nodes when each pass only finds a few of them.  Instead, nodes
+ * are queued as soon as the pq test passes for them, in a way that still
+ * pushes them in the same order as the passes did.
+ */
+struct ra_simplify_state {
+   /**
+    * Max-heap of the colorable nodes that the current pass has yet to
+    * reach.
+    */
+   unsigned int *ready;
+   unsigned int ready_count;
+
+   /** Colorable nodes that the current pass is already past. */
+   unsigned int *next;
+   unsigned int next_count;
+
+   /** Node the current pass is at, or g->count at the start of a pass. */
+   unsigned int pass_node;
+
+   /**
+    * Min-heap of the nodes that aren't trivially colorable, ordered by
+    * q_total, to choose the optimistic node from.  It is only built once
+    * the first optimistic node is needed, as many shaders never need one.
+    */
+   unsigned int *heap;
+   unsigned int heap_count;
+};
+
 static void
-decrement_q(struct ra_graph *g, unsigned int n)
+ready_push(struct ra_simplify_state *s, unsigned int n)
+{
+   unsigned int i = s->ready_count++;
+
+   while (i > 0 && s->ready[(i - 1) / 2] < n) {
+      s->ready[i] = s->ready[(i - 1) / 2];
+      i = (i - 1) / 2;
+   }
+   s->ready[i] = n;
+}
+
+static unsigned int
+ready_pop(struct ra_simplify_state *s)
+{
+   unsigned int top = s->ready[0];
+   unsigned int last = s->ready[--s->ready_count];
+   unsigned int i = 0;
+
+   while (2 * i + 1 < s->ready_count) {
+      unsigned int child = 2 * i + 1;
+
+      if (child + 1 < s->ready_count && s->ready[child + 1] > s->ready[child])
+         child++;
+      if (s->ready[child] < last)
+         break;
+
+      s->ready[i] = s->ready[child];
+      i = child;
+   }
+   s->ready[i] = last;
+
+   return top;
+}
+
+/**
+ * Returns whether n1 is a better optimistic node than n2: the lowest q total
+ * wins, and ties go to the highest numbered node.
+ */
+static bool
+optimistic_node_before(struct ra_graph *g, unsigned int n1, unsigned int n2)
+{
+   return g->nodes[n1].q_total < g->nodes[n2].q_total ||
+          (g->nodes[n1].q_total == g->nodes[n2].q_total && n1 > n2);
+}
+
+static void
+heap_set(struct ra_graph *g, struct ra_simplify_state *s,
+         unsigned int i, unsigned int n)
+{
+   s->heap[i] = n;
+   g->nodes[n].heap_index = i;
+}
+
+static void
+heap_sift_up(struct ra_graph *g, struct ra_simplify_state *s, unsigned int i)
+{
+   unsigned int n = s->heap[i];
+
+   while (i > 0 && optimistic_node_before(g, n, s->heap[(i - 1) / 2])) {
+      heap_set(g, s, i, s->heap[(i - 1) / 2]);
+      i = (i - 1) / 2;
+   }
+   heap_set(g, s, i, n);
+}
+
+static void
+heap_sift_down(struct ra_graph *g, struct ra_simplify_state *s, unsigned int i)
+{
+   unsigned int n = s->heap[i];
+
+   while (2 * i + 1 < s->heap_count) {
+      unsigned int child = 2 * i + 1;
+
+      if (child + 1 < s->heap_count &&
+          optimistic_node_before(g, s->heap[child + 1], s->heap[child]))
+         child++;
+      if (!optimistic_node_before(g, s->heap[child], n))
+         break;
+
+      heap_set(g, s, i, s->heap[child]);
+      i = child;
+   }
+   heap_set(g, s, i, n);
+}
+
+/**
+ * Returns the best node to optimistically push on the stack, or NO_REG if
+ * every node has been pushed.
+ */
+static unsigned int
+pop_optimistic_node(struct ra_graph *g, struct ra_simplify_state *s)
+{
+   unsigned int i;
+
+   if (!s->heap) {
+      s->heap = ralloc_array(g, unsigned int, g->count);
+      for (i = 0; i < g->count; i++) {
+         if (!g->nodes[i].in_stack && g->nodes[i].reg == NO_REG)
+            heap_set(g, s, s->heap_count++, i);
+      }
+      for (i = s->heap_count / 2; i-- > 0;)
+         heap_sift_down(g, s, i);
+   }
+
+   while (s->heap_count) {
+      unsigned int n = s->heap[0];
+
+      g->nodes[n].heap_index = NO_REG;
+      if (--s->heap_count) {
+         heap_set(g, s, 0, s->heap[s->heap_count]);
+         heap_sift_down(g, s, 0);
+      }
+
+      /* Nodes that became colorable after the heap was built have been
+       * pushed already.
+       */
+      if (!g->nodes[n].in_stack)
+         return n;
+   }
+
+   return NO_REG;
+}
+
+static void
+decrement_q(struct ra_graph *g, struct ra_simplify_state *s, unsigned int n)
 {
    unsigned int i;
    int n_class = g->nodes[n].class;
@@ -474,11 +750,27 @@ decrement_q(struct ra_graph *g, unsigned int n)
    for (i = 0; i < g->nodes[n].adjacency_count; i++) {
       unsigned int n2 = g->nodes[n].adjacency_list[i];
       unsigned int n2_class = g->nodes[n2].class;
+      bool was_colorable;
+
+      if (n == n2 || g->nodes[n2].in_stack)
+         continue;
+
+      assert(g->nodes[n2].q_total >= g->regs->classes[n2_class]->q[n_class]);
+      was_colorable = pq_test(g, n2);
+      g->nodes[n2].q_total -= g->regs->classes[n2_class]->q[n_class];
 
-      if (n != n2 && !g->nodes[n2].in_stack) {
-         assert(g->nodes[n2].q_total >= g->regs->classes[n2_class]->q[n_class]);
-         g->nodes[n2].q_total -= g->regs->classes[n2_class]->q[n_class];
+      if (g->nodes[n2].reg != NO_REG)
+         continue;
+
+      if (!was_colorable && pq_test(g, n2)) {
+         if (n2 < s->pass_node)
+            ready_push(s, n2);
+         else
+            s->next[s->next_count++] = n2;
       }
+
+      if (g->nodes[n2].heap_index != NO_REG)
+         heap_sift_up(g, s, g->nodes[n2].heap_index);
    }
 }
 
@@ -495,50 +787,79 @@ decrement_q(struct ra_graph *g, unsigned int n)
 static void
 ra_simplify(struct ra_graph *g)
 {
-   bool progress = true;
+   struct ra_simplify_state s;
    unsigned int stack_optimistic_start = UINT_MAX;
    int i;
 
-   while (progress) {
-      unsigned int best_optimistic_node = ~0;
-      unsigned int lowest_q_total = ~0;
+   memset(&s, 0, sizeof(s));
+   s.ready = ralloc_array(g, unsigned int, g->count);
+   s.next = ralloc_array(g, unsigned int, g->count);
+   s.pass_node = g->count;
 
-      progress = false;
+   /* Descending order is a valid max-heap already. */
+   for (i = g->count - 1; i >= 0; i--) {
+      g->nodes[i].heap_index = NO_REG;
 
-      for (i = g->count - 1; i >= 0; i--) {
-	 if (g->nodes[i].in_stack || g->nodes[i].reg != NO_REG)
-	    continue;
+      if (!g->nodes[i].in_stack && g->nodes[i].reg == NO_REG &&
+          pq_test(g, i))
+         s.ready[s.ready_count++] = i;
+   }
 
-	 if (pq_test(g, i)) {
-	    decrement_q(g, i);
-	    g->stack[g->stack_count] = i;
-	    g->stack_count++;
-	    g->nodes[i].in_stack = true;
-	    progress = true;
-	 } else {
-	    unsigned int new_q_total = g->nodes[i].q_total;
-	    if (new_q_total < lowest_q_total) {
-	       best_optimistic_node = i;
-	       lowest_q_total = new_q_total;
-	    }
-	 }
-      }
+   while (true) {
+      unsigned int n;
+
+      if (s.ready_count) {
+         n = ready_pop(&s);
+         s.pass_node = n;
+      } else if (s.next_count) {
+         /* Start another pass. */
+         while (s.next_count)
+            ready_push(&s, s.next[--s.next_count]);
+         s.pass_node = g->count;
+         continue;
+      } else {
+         n = pop_optimistic_node(g, &s);
+         if (n == NO_REG)
+            break;
 
-      if (!progress && best_optimistic_node != ~0U) {
          if (stack_optimistic_start == UINT_MAX)
             stack_optimistic_start = g->stack_count;
 
-	 decrement_q(g, best_optimistic_node);
-	 g->stack[g->stack_count] = best_optimistic_node;
-	 g->stack_count++;
-	 g->nodes[best_optimistic_node].in_stack = true;
-	 progress = true;
+         /* Anything this makes colorable is found by the next pass. */
+         s.pass_node = g->count;
       }
+
+      decrement_q(g, &s, n);
+      g->stack[g->stack_count] = n;
+      g->stack_count++;
+      g->nodes[n].in_stack = true;
    }
 
+   ralloc_free(s.ready);
+   ralloc_free(s.next);
+   ralloc_free(s.heap);
+
    g->stack_optimistic_start = stack_optimistic_start;
 }
 
+/**
+ * Returns whether any of the registers set in \p regs conflicts with r.
+ */
+static bool
+ra_conflicts_with_any(struct ra_graph *g, unsigned int r,
+                      const BITSET_WORD *regs)
+{
+   const BITSET_WORD *conflicts = g->regs->regs[r].conflicts;
+   unsigned int i;
+
+   for (i = 0; i < BITSET_WORDS(g->regs->count); i++) {
+      if (conflicts[i] & regs[i])
+         return true;
+   }
+
+   return false;
+}
+
 /**
  * Pops nodes from the stack back into the graph, coloring them with
  * registers as they go.
@@ -550,6 +871,8 @@ static bool
 ra_select(struct ra_graph *g)
 {
    int start_search_reg = 0;
+   BITSET_WORD *neighbor_regs =
+      ralloc_array(g, BITSET_WORD, BITSET_WORDS(g->regs->count));
 
    while (g->stack_count != 0) {
       unsigned int i;
@@ -558,6 +881,25 @@ ra_select(struct ra_graph *g)
       int n = g->stack[g->stack_count - 1];
       struct ra_class *c = g->regs->classes[g->nodes[n].class];
 
+      /* For nodes with many neighbors, checking each candidate register
+       * against the set of registers the neighbors use is cheaper than
+       * walking the neighbors for each of them.
+       */
+      bool use_neighbor_regs =
+         g->nodes[n].adjacency_count > BITSET_WORDS(g->regs->count);
+
+      if (use_neighbor_regs) {
+         memset(neighbor_regs, 0,
+                BITSET_WORDS(g->regs->count) * sizeof(BITSET_WORD));
+
+         for (i = 0; i < g->nodes[n].adjacency_count; i++) {
+            unsigned int n2 = g->nodes[n].adjacency_list[i];
+
+            if (!g->nodes[n2].in_stack)
+               BITSET_SET(neighbor_regs, g->nodes[n2].reg);
+         }
+      }
+
       /* Find the lowest-numbered reg which is not used by a member
        * of the graph adjacent to us.
        */
@@ -566,6 +908,12 @@ ra_select(struct ra_graph *g)
          if (!reg_belongs_to_class(r, c))
 	    continue;
 
+         if (use_neighbor_regs) {
+            if (!ra_conflicts_with_any(g, r, neighbor_regs))
+               break;
+            continue;
+         }
+
 	 /* Check if any of our neighbors conflict with this register choice. */
 	 for (i = 0; i < g->nodes[n].adjacency_count; i++) {
 	    unsigned int n2 = g->nodes[n].adjacency_list[i];
@@ -584,8 +932,10 @@ ra_select(struct ra_graph *g)
        */
       g->nodes[n].in_stack = false;
 
-      if (ri == g->regs->count)
+      if (ri == g->regs->count) {
+         ralloc_free(neighbor_regs);
 	 return false;
+      }
 
       g->nodes[n].reg = r;
       g->stack_count--;
@@ -604,6 +954,7 @@ ra_select(struct ra_graph *g)
          start_search_reg = r + 1;
    }
 
+   ralloc_free(neighbor_regs);
    return true;
 }
 
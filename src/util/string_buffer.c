@@ -0,0 +1,130 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <stdio.h>
+
+#include "util/string_buffer.h"
+
+struct _mesa_string_buffer *
+_mesa_string_buffer_create(void *mem_ctx, uint32_t initial_capacity)
+{
+   struct _mesa_string_buffer *str;
+
+   str = ralloc(mem_ctx, struct _mesa_string_buffer);
+   if (str == NULL)
+      return NULL;
+
+   /* Keep room for the terminating null character. */
+   str->buf = ralloc_array(str, char, initial_capacity + 1);
+   if (str->buf == NULL) {
+      ralloc_free(str);
+      return NULL;
+   }
+
+   str->buf[0] = '\0';
+   str->length = 0;
+   str->capacity = initial_capacity;
+
+   return str;
+}
+
+static bool
+ensure_capacity(struct _mesa_string_buffer *str, uint32_t needed)
+{
+   uint32_t capacity;
+   char *buf;
+
+   if (needed <= str->capacity)
+      return true;
+
+   capacity = str->capacity ? str->capacity : 16;
+   while (capacity < needed)
+      capacity *= 2;
+
+   buf = reralloc_array_size(str, str->buf, 1, capacity + 1);
+   if (buf == NULL)
+      return false;
+
+   str->buf = buf;
+   str->capacity = capacity;
+   return true;
+}
+
+bool
+_mesa_string_buffer_append_len(struct _mesa_string_buffer *str,
+                               const char *c, uint32_t len)
+{
+   if (!ensure_capacity(str, str->length + len))
+      return false;
+
+   memcpy(str->buf + str->length, c, len);
+   str->length += len;
+   str->buf[str->length] = '\0';
+   return true;
+}
+
+bool
+_mesa_string_buffer_vprintf(struct _mesa_string_buffer *str,
+                            const char *format, va_list args)
+{
+   va_list args_copy;
+   int len;
+
+   /* Try to print into the free space first, which is usually enough. */
+   va_copy(args_copy, args);
+   len = vsnprintf(str->buf + str->length, str->capacity - str->length + 1,
+                   format, args_copy);
+   va_end(args_copy);
+
+   if (len < 0) {
+      str->buf[str->length] = '\0';
+      return false;
+   }
+
+   if (str->length + len > str->capacity) {
+      if (!ensure_capacity(str, str->length + len)) {
+         str->buf[str->length] = '\0';
+         return false;
+      }
+
+      va_copy(args_copy, args);
+      vsnprintf(str->buf + str->length, len + 1, format, args_copy);
+      va_end(args_copy);
+   }
+
+   str->length += len;
+   return true;
+}
+
+bool
+_mesa_string_buffer_printf(struct _mesa_string_buffer *str,
+                           const char *format, ...)
+{
+   bool ret;
+   va_list args;
+
+   va_start(args, format);
+   ret = _mesa_string_buffer_vprintf(str, format, args);
+   va_end(args);
+   return ret;
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+#ifndef STRING_BUFFER_H
+#define STRING_BUFFER_H
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ralloc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A null-terminated string that is built by appending to it.
+ *
+ * Unlike \c ralloc_strcat and friends, the allocation grows geometrically,
+ * so building a long string from many small pieces takes linear time.
+ */
+struct _mesa_string_buffer {
+   char *buf;
+   uint32_t length;
+   uint32_t capacity;
+};
+
+/**
+ * Create an empty string buffer allocated from \p mem_ctx, with room for
+ * \p initial_capacity characters before it has to grow.
+ */
+struct _mesa_string_buffer *
+_mesa_string_buffer_create(void *mem_ctx, uint32_t initial_capacity);
+
+static inline void
+_mesa_string_buffer_destroy(struct _mesa_string_buffer *str)
+{
+   ralloc_free(str);
+}
+
+/**
+ * Append \p len characters of \p c, which need not be null-terminated.
+ *
+ * \return True unless allocation failed.
+ */
+bool
+_mesa_string_buffer_append_len(struct _mesa_string_buffer *str,
+                               const char *c, uint32_t len);
+
+static inline bool
+_mesa_string_buffer_append(struct _mesa_string_buffer *str, const char *c)
+{
+   return _mesa_string_buffer_append_len(str, c, strlen(c));
+}
+
+static inline bool
+_mesa_string_buffer_append_char(struct _mesa_string_buffer *str, char c)
+{
+   return _mesa_string_buffer_append_len(str, &c, 1);
+}
+
+/**
+ * Append formatted text, see \c printf.
+ *
+ * \return True unless allocation failed.
+ */
+bool
+_mesa_string_buffer_printf(struct _mesa_string_buffer *str,
+                           const char *format, ...) PRINTFLIKE(2, 3);
+
+bool
+_mesa_string_buffer_vprintf(struct _mesa_string_buffer *str,
+                            const char *format, va_list args);
+
+/**
+ * Cut the string back to its first \p length characters.
+ */
+static inline void
+_mesa_string_buffer_truncate(struct _mesa_string_buffer *str,
+                             uint32_t length)
+{
+   if (length < str->length) {
+      str->length = length;
+      str->buf[length] = '\0';
+   }
+}
+
+static inline void
+_mesa_string_buffer_clear(struct _mesa_string_buffer *str)
+{
+   _mesa_string_buffer_truncate(str, 0);
+}
+
+#ifdef __cplusplus
+} /* extern C */
+#endif
+
+#endif /* STRING_BUFFER_H */
@@ -0,0 +1,347 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "c11/threads.h"
+#include "util/list.h"
+#include "util/thread_pool.h"
+
+struct thread_pool_job {
+   struct list_head link;
+   thread_pool_execute_func execute;
+   void *data;
+};
+
+struct thread_pool {
+   mtx_t mutex;
+   cnd_t has_jobs;
+   struct list_head jobs;
+   bool shutdown;
+
+   unsigned num_threads;
+   thrd_t *threads;
+};
+
+static int
+thread_pool_thread(void *data)
+{
+   struct thread_pool *pool = data;
+
+   mtx_lock(&pool->mutex);
+
+   for (;;) {
+      while (list_empty(&pool->jobs) && !pool->shutdown)
+         cnd_wait(&pool->has_jobs, &pool->mutex);
+
+      /* Finish the queued jobs before honoring a shutdown. */
+      if (list_empty(&pool->jobs))
+         break;
+
+      struct thread_pool_job *job =
+         LIST_ENTRY(struct thread_pool_job, pool->jobs.next, link);
+      list_del(&job->link);
+
+      mtx_unlock(&pool->mutex);
+      job->execute(job->data);
+      free(job);
+      mtx_lock(&pool->mutex);
+   }
+
+   mtx_unlock(&pool->mutex);
+   return 0;
+}
+
+struct thread_pool *
+thread_pool_create(unsigned num_threads)
+{
+   struct thread_pool *pool;
+
+   if (num_threads == 0)
+      return NULL;
+
+   pool = calloc(1, sizeof(*pool));
+   if (pool == NULL)
+      return NULL;
+
+   pool->threads = calloc(num_threads, sizeof(thrd_t));
+   if (pool->threads == NULL) {
+      free(pool);
+      return NULL;
+   }
+
+   mtx_init(&pool->mutex, mtx_plain);
+   cnd_init(&pool->has_jobs);
+   list_inithead(&pool->jobs);
+
+   for (unsigned i = 0; i < num_threads; i++) {
+      if (thrd_create(&pool->threads[i], thread_pool_thread,
+                      pool) != thrd_success)
+         break;
+      pool->num_threads++;
+   }
+
+   if (pool->num_threads == 0) {
+      thread_pool_destroy(pool);
+      return NULL;
+   }
+
+   return pool;
+}
+
+void
+thread_pool_destroy(struct thread_pool *pool)
+{
+   if (pool == NULL)
+      return;
+
+   mtx_lock(&pool->mutex);
+   pool->shutdown = true;
+   cnd_broadcast(&pool->has_jobs);
+   mtx_unlock(&pool->mutex);
+
+   for (unsigned i = 0; i < pool->num_threads; i++)
+      thrd_join(pool->threads[i], NULL);
+
+   cnd_destroy(&pool->has_jobs);
+   mtx_destroy(&pool->mutex);
+   free(pool->threads);
+   free(pool);
+}
+
+bool
+thread_pool_add_job(struct thread_pool *pool,
+                    thread_pool_execute_func execute, void *data)
+{
+   struct thread_pool_job *job = malloc(sizeof(*job));
+
+   if (job == NULL)
+      return false;
+
+   job->execute = execute;
+   job->data = data;
+
+   mtx_lock(&pool->mutex);
+   list_addtail(&job->link, &pool->jobs);
+   cnd_signal(&pool->has_jobs);
+   mtx_unlock(&pool->mutex);
+
+   return true;
+}
+
+struct parallel_for {
+   mtx_t mutex;
+   cnd_t done;
+
+   thread_pool_index_func func;
+   void *data;
+
+   unsigned count;
+   unsigned next;
+   unsigned completed;
+
+   /** The caller and the helper jobs that were queued */
+   unsigned refcount;
+};
+
+static bool
+parallel_for_run_one(struct parallel_for *pf)
+{
+   unsigned index;
+
+   mtx_lock(&pf->mutex);
+   if (pf->next == pf->count) {
+      mtx_unlock(&pf->mutex);
+      return false;
+   }
+   index = pf->next++;
+   mtx_unlock(&pf->mutex);
+
+   pf->func(pf->data, index);
+
+   mtx_lock(&pf->mutex);
+   if (++pf->completed == pf->count)
+      cnd_broadcast(&pf->done);
+   mtx_unlock(&pf->mutex);
+
+   return true;
+}
+
+static void
+parallel_for_unref(struct parallel_for *pf)
+{
+   bool last;
+
+   mtx_lock(&pf->mutex);
+   last = --pf->refcount == 0;
+   mtx_unlock(&pf->mutex);
+
+   if (last) {
+      cnd_destroy(&pf->done);
+      mtx_destroy(&pf->mutex);
+      free(pf);
+   }
+}
+
+static void
+parallel_for_helper(void *data)
+{
+   struct parallel_for *pf = data;
+
+   /* A helper that starts late finds nothing left to do, so the caller's
+    * data is never used after thread_pool_parallel_for() returned.
+    */
+   while (parallel_for_run_one(pf))
+      ;
+
+   parallel_for_unref(pf);
+}
+
+void
+thread_pool_parallel_for(struct thread_pool *pool, unsigned count,
+                         thread_pool_index_func func, void *data)
+{
+   struct parallel_for *pf = NULL;
+   unsigned i, num_helpers;
+
+   if (pool != NULL && count > 1)
+      pf = calloc(1, sizeof(*pf));
+
+   if (pf == NULL) {
+      for (i = 0; i < count; i++)
+         func(data, i);
+      return;
+   }
+
+   mtx_init(&pf->mutex, mtx_plain);
+   cnd_init(&pf->done);
+   pf->func = func;
+   pf->data = data;
+   pf->count = count;
+   pf->refcount = 1;
+
+   num_helpers = count - 1;
+   if (num_helpers > pool->num_threads)
+      num_helpers = pool->num_threads;
+
+   for (i = 0; i < num_helpers; i++) {
+      mtx_lock(&pf->mutex);
+      pf->refcount++;
+      mtx_unlock(&pf->mutex);
+
+      if (!thread_pool_add_job(pool, parallel_for_helper, pf)) {
+         mtx_lock(&pf->mutex);
+         pf->refcount--;
+         mtx_unlock(&pf->mutex);
+         break;
+      }
+   }
+
+   while (parallel_for_run_one(pf))
+      ;
+
+   mtx_lock(&pf->mutex);
+   while (pf->completed != pf->count)
+      cnd_wait(&pf->done, &pf->mutex);
+   mtx_unlock(&pf->mutex);
+
+   parallel_for_unref(pf);
+}
+
+/** A band of rows covers at least this many pixels... */
+#define MIN_BAND_PIXELS (16 * 1024)
+
+/** ...and a multiple of this many rows */
+#define BAND_ROW_ALIGN 32
+
+struct parallel_rows {
+   thread_pool_rows_func func;
+   void *data;
+   unsigned height;
+   unsigned band_rows;
+   unsigned bands_per_image;
+};
+
+static void
+parallel_rows_band(void *data, unsigned index)
+{
+   const struct parallel_rows *pr = data;
+   const unsigned image = index / pr->bands_per_image;
+   const unsigned y = index % pr->bands_per_image * pr->band_rows;
+   const unsigned rows = pr->height - y;
+
+   pr->func(pr->data, image, y, rows < pr->band_rows ? rows : pr->band_rows);
+}
+
+void
+thread_pool_parallel_rows(struct thread_pool *pool,
+                          unsigned width, unsigned height, unsigned depth,
+                          thread_pool_rows_func func, void *data)
+{
+   struct parallel_rows pr;
+   unsigned i;
+
+   if (width == 0 || height == 0)
+      return;
+
+   if (pool == NULL ||
+       (uint64_t) width * height * depth < THREAD_POOL_MIN_PARALLEL_PIXELS) {
+      for (i = 0; i < depth; i++)
+         func(data, i, 0, height);
+      return;
+   }
+
+   pr.func = func;
+   pr.data = data;
+   pr.height = height;
+   pr.band_rows = (MIN_BAND_PIXELS + width - 1) / width;
+   pr.band_rows = (pr.band_rows + BAND_ROW_ALIGN - 1) & ~(BAND_ROW_ALIGN - 1);
+   pr.bands_per_image = (height + pr.band_rows - 1) / pr.band_rows;
+
+   thread_pool_parallel_for(pool, depth * pr.bands_per_image,
+                            parallel_rows_band, &pr);
+}
+
+unsigned
+thread_pool_num_cpus(void)
+{
+#if defined(_WIN32)
+   SYSTEM_INFO system_info;
+
+   GetSystemInfo(&system_info);
+   if (system_info.dwNumberOfProcessors > 0)
+      return system_info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+   long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+   if (count > 0)
+      return count;
+#endif
+   return 1;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright © 2016 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#pragma once
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A fixed set of worker threads executing jobs in the order they were added.
+ *
+ * Jobs may be added from any thread.  A job that waits for the completion
+ * of another job must only wait for jobs that were added before it, or the
+ * pool can deadlock.
+ */
+struct thread_pool;
+
+typedef void (*thread_pool_execute_func)(void *data);
+typedef void (*thread_pool_index_func)(void *data, unsigned index);
+typedef void (*thread_pool_rows_func)(void *data, unsigned image,
+                                      unsigned y, unsigned rows);
+
+/** Images with fewer pixels than this are not worth splitting into bands */
+#define THREAD_POOL_MIN_PARALLEL_PIXELS (64 * 1024)
+
+/**
+ * Create a pool of \p num_threads worker threads.
+ *
+ * \return \c NULL if \p num_threads is zero or the threads could not be
+ * created.
+ */
+struct thread_pool *
+thread_pool_create(unsigned num_threads);
+
+/**
+ * Execute the jobs still in the queue, then join and free the threads.
+ */
+void
+thread_pool_destroy(struct thread_pool *pool);
+
+/**
+ * Queue \p execute to be called with \p data on one of the threads.
+ *
+ * \return \c false if the job could not be queued, in which case the caller
+ * should execute it itself.
+ */
+bool
+thread_pool_add_job(struct thread_pool *pool,
+                    thread_pool_execute_func execute, void *data);
+
+/**
+ * Call \p func(data, i) for every i in [0, count) and return when all calls
+ * are done.
+ *
+ * The calls are spread over the calling thread and the threads of \p pool,
+ * which may be \c NULL.  The calling thread never waits for a queued job
+ * to start, so this is safe to use while the pool is busy.
+ */
+void
+thread_pool_parallel_for(struct thread_pool *pool, unsigned count,
+                         thread_pool_index_func func, void *data);
+
+/**
+ * Call \p func(data, image, y, rows) for bands of rows that together cover
+ * the \p height rows of each of \p depth images \p width pixels wide, and
+ * return when all calls are done.
+ *
+ * If \p pool is not \c NULL and the images have at least
+ * THREAD_POOL_MIN_PARALLEL_PIXELS pixels, the bands are spread over the
+ * calling thread and the threads of \p pool like thread_pool_parallel_for().
+ * Otherwise \p func is called once per image on the calling thread.  A band
+ * always starts on a multiple of 32 rows, so it never splits a row of
+ * compressed blocks.
+ */
+void
+thread_pool_parallel_rows(struct thread_pool *pool,
+                          unsigned width, unsigned height, unsigned depth,
+                          thread_pool_rows_func func, void *data);
+
+/**
+ * Return the number of CPUs that are online, or 1 if that is unknown.
+ */
+unsigned
+thread_pool_num_cpus(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* THREAD_POOL_H */